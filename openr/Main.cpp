@@ -5,10 +5,16 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <syslog.h>
+#include <unistd.h>
 #include <fstream>
 #include <stdexcept>
 
+#include <fb303/ServiceData.h>
 #include <fbzmq/async/StopEventLoopSignalHandler.h>
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/FileUtil.h>
@@ -16,6 +22,7 @@
 #include <folly/IPAddress.h>
 #include <folly/Memory.h>
 #include <folly/Optional.h>
+#include <folly/String.h>
 #include <folly/gen/Base.h>
 #include <folly/gen/String.h>
 #include <folly/init/Init.h>
@@ -66,6 +73,20 @@ namespace {
 //
 
 const std::string inet6Path = "/proc/net/if_inet6";
+
+// Start time of process, modules report their startup time relative to it
+const auto kStartTime = std::chrono::steady_clock::now();
+
+// Export time elapsed since start of process as startup time of phase
+void
+exportStartupTime(const std::string& phase) {
+  const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - kStartTime)
+                             .count();
+  facebook::fb303::fbData->setCounter(
+      folly::sformat("main.startup.{}_ms", phase), elapsedMs);
+  LOG(INFO) << "Startup phase " << phase << " done in " << elapsedMs << " ms";
+}
 } // namespace
 
 // Disable background jemalloc background thread => new jemalloc-5 feature
@@ -95,15 +116,18 @@ waitForFibService(const fbzmq::ZmqEventLoop& evl) {
   folly::EventBase evb;
   std::shared_ptr<folly::AsyncSocket> socket;
   std::unique_ptr<openr::thrift::FibServiceAsyncClient> client;
-  while (evl.isRunning() &&
-         facebook::fb303::cpp2::fb303_status::ALIVE != fibStatus) {
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    LOG(INFO) << "Waiting for FibService to come up...";
+  while (evl.isRunning()) {
     openr::Fib::createFibClient(evb, socket, client, FLAGS_fib_handler_port);
     try {
       fibStatus = client->sync_getStatus();
     } catch (const std::exception& e) {
     }
+    if (facebook::fb303::cpp2::fb303_status::ALIVE == fibStatus) {
+      break;
+    }
+    // Retry after a while, service is often already up on first attempt
+    LOG(INFO) << "Waiting for FibService to come up...";
+    std::this_thread::sleep_for(std::chrono::seconds(1));
   }
 
   auto waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -112,6 +136,52 @@ waitForFibService(const fbzmq::ZmqEventLoop& evl) {
   LOG(INFO) << "FibService up. Waited for " << waitMs << " ms.";
 }
 
+/**
+ * Pin calling thread to CPUs and set its priority, if configured for thread
+ * with given name
+ */
+void
+setThreadScheduling(const Config& config, const std::string& name) {
+  auto const& threadConfigs =
+      config.getConfig().thread_scheduling_config_ref();
+  if (not threadConfigs.has_value()) {
+    return;
+  }
+  auto it = threadConfigs->find(name);
+  if (it == threadConfigs->end()) {
+    return;
+  }
+  auto const& threadConfig = it->second;
+
+  if (not threadConfig.cpus.empty()) {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (auto const cpu : threadConfig.cpus) {
+      CHECK(cpu >= 0 and cpu < CPU_SETSIZE) << "Invalid CPU " << cpu;
+      CPU_SET(cpu, &cpuSet);
+    }
+    const auto rc =
+        pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    if (rc != 0) {
+      LOG(ERROR) << "Failed to set CPU affinity of " << name
+                 << " thread: " << folly::errnoStr(rc);
+    } else {
+      LOG(INFO) << "Pinned " << name << " thread to CPUs "
+                << folly::join(",", threadConfig.cpus);
+    }
+  }
+
+  // On linux nice value applies to single thread identified by its id
+  if (auto nice = threadConfig.nice_ref()) {
+    if (setpriority(PRIO_PROCESS, syscall(SYS_gettid), *nice) != 0) {
+      LOG(ERROR) << "Failed to set nice value of " << name
+                 << " thread: " << folly::errnoStr(errno);
+    } else {
+      LOG(INFO) << "Set nice value of " << name << " thread to " << *nice;
+    }
+  }
+}
+
 /**
  * Start an EventBase in a thread, maintain order of thread creation and
  * returns raw pointer of Derived class.
@@ -121,6 +191,7 @@ T*
 startEventBase(
     std::vector<std::thread>& allThreads,
     std::vector<std::unique_ptr<OpenrEventBase>>& orderedEvbs,
+    const Config& config,
     Watchdog* watchdog,
     const std::string& name,
     std::unique_ptr<T> evbT) {
@@ -130,13 +201,16 @@ startEventBase(
       reinterpret_cast<OpenrEventBase*>(evbT.release()));
 
   // Start a thread
-  allThreads.emplace_back(std::thread([evb = evb.get(), name]() noexcept {
-    LOG(INFO) << "Starting " << name << " thread ...";
-    folly::setThreadName(name);
-    evb->run();
-    LOG(INFO) << name << " thread got stopped.";
-  }));
+  allThreads.emplace_back(
+      std::thread([evb = evb.get(), name, &config]() noexcept {
+        LOG(INFO) << "Starting " << name << " thread ...";
+        folly::setThreadName(name);
+        setThreadScheduling(config, name);
+        evb->run();
+        LOG(INFO) << name << " thread got stopped.";
+      }));
   evb->waitUntilRunning();
+  exportStartupTime(name);
 
   // Add to watchdog
   if (watchdog) {
@@ -236,14 +310,24 @@ main(int argc, char** argv) {
   // Set main thread name
   folly::setThreadName("openr");
 
-  // Queue for inter-module communication
-  ReplicateQueue<openr::thrift::RouteDatabaseDelta> routeUpdatesQueue;
-  ReplicateQueue<openr::thrift::InterfaceDatabase> interfaceUpdatesQueue;
-  ReplicateQueue<openr::thrift::SparkNeighborEvent> neighborUpdatesQueue;
-  ReplicateQueue<openr::thrift::PrefixUpdateRequest> prefixUpdatesQueue;
-  ReplicateQueue<openr::thrift::Publication> kvStoreUpdatesQueue;
-  ReplicateQueue<openr::thrift::PeerUpdateRequest> peerUpdatesQueue;
-  ReplicateQueue<openr::thrift::RouteDatabaseDelta> staticRoutesUpdateQueue;
+  // Queue for inter-module communication. Queues are named to export their
+  // depth and latency to fb303
+  ReplicateQueue<openr::thrift::RouteDatabaseDelta> routeUpdatesQueue{
+      "route_updates"};
+  ReplicateQueue<openr::thrift::InterfaceDatabase> interfaceUpdatesQueue{
+      "interface_updates"};
+  ReplicateQueue<openr::thrift::RouteDatabaseDelta> fibUpdatesQueue{
+      "fib_updates"};
+  ReplicateQueue<openr::thrift::SparkNeighborEvent> neighborUpdatesQueue{
+      "neighbor_updates"};
+  ReplicateQueue<openr::thrift::PrefixUpdateRequest> prefixUpdatesQueue{
+      "prefix_updates"};
+  ReplicateQueue<messaging::SharedValue<openr::thrift::Publication>>
+      kvStoreUpdatesQueue{"kvstore_updates"};
+  ReplicateQueue<openr::thrift::PeerUpdateRequest> peerUpdatesQueue{
+      "peer_updates"};
+  ReplicateQueue<openr::thrift::RouteDatabaseDelta> staticRoutesUpdateQueue{
+      "static_routes_updates"};
 
   // structures to organize our modules
   std::vector<std::thread> allThreads;
@@ -255,6 +339,7 @@ main(int argc, char** argv) {
     watchdog = startEventBase(
         allThreads,
         orderedEvbs,
+        *config,
         nullptr /* watchdog won't monitor itself */,
         "Watchdog",
         std::make_unique<Watchdog>(
@@ -276,6 +361,8 @@ main(int argc, char** argv) {
   std::unique_ptr<std::thread> netlinkFibServerThread{nullptr};
   std::unique_ptr<std::thread> netlinkSystemServerThread{nullptr};
   std::unique_ptr<PlatformPublisher> eventPublisher{nullptr};
+  std::shared_ptr<NetlinkFibHandler> netlinkFibHandler{nullptr};
+  std::shared_ptr<NetlinkSystemHandler> netlinkSystemHandler{nullptr};
 
   if (FLAGS_enable_netlink_fib_handler or FLAGS_enable_netlink_system_handler) {
     thriftThreadMgr = ThreadManager::newPriorityQueueThreadManager(
@@ -283,18 +370,17 @@ main(int argc, char** argv) {
     thriftThreadMgr->setNamePrefix("ThriftCpuPool");
     thriftThreadMgr->start();
 
-    // Create event publisher to handle event subscription
-    eventPublisher = std::make_unique<PlatformPublisher>(
-        context, PlatformPublisherUrl{FLAGS_platform_pub_url});
-
     // Create Netlink Protocol object in a new thread
     // ATTN: intentionally set evl capacity to be 1e5 instead of default 1e2
     nlProtocolSocketEventLoop = std::make_unique<fbzmq::ZmqEventLoop>(1e5);
     nlProtocolSocket = std::make_unique<openr::fbnl::NetlinkProtocolSocket>(
-        nlProtocolSocketEventLoop.get());
+        nlProtocolSocketEventLoop.get(),
+        false /* enableIPv6RouteReplaceSemantics */,
+        std::max(1, FLAGS_netlink_route_sockets));
     auto nlProtocolSocketThread = std::thread([&]() {
       LOG(INFO) << "Starting NetlinkProtolSocketEvl thread ...";
       folly::setThreadName("NetlinkProtolSocketEvl");
+      setThreadScheduling(*config, "NetlinkProtolSocketEvl");
       nlProtocolSocketEventLoop->run();
       LOG(INFO) << "NetlinkProtolSocketEvl thread got stopped.";
     });
@@ -303,14 +389,26 @@ main(int argc, char** argv) {
 
     // ATTN: intentionally set evl capacity to be 1e5 instead of default 1e2
     nlEventLoop = std::make_unique<fbzmq::ZmqEventLoop>(1e5);
+
+    // Create event publisher to handle event subscription. Events handled in
+    // one iteration of netlink event loop are published in one batch.
+    eventPublisher = std::make_unique<PlatformPublisher>(
+        context,
+        PlatformPublisherUrl{FLAGS_platform_pub_url},
+        nlEventLoop.get());
     nlSocket = std::make_shared<openr::fbnl::NetlinkSocket>(
-        nlEventLoop.get(), eventPublisher.get(), std::move(nlProtocolSocket));
+        nlEventLoop.get(),
+        eventPublisher.get(),
+        std::move(nlProtocolSocket),
+        std::chrono::milliseconds(
+            std::max(0, FLAGS_netlink_link_event_coalesce_ms)));
     // Subscribe selected network events
     nlSocket->subscribeEvent(openr::fbnl::LINK_EVENT);
     nlSocket->subscribeEvent(openr::fbnl::ADDR_EVENT);
-    auto nlEvlThread = std::thread([&nlEventLoop]() {
+    auto nlEvlThread = std::thread([&nlEventLoop, &config]() {
       LOG(INFO) << "Starting NetlinkEvl thread ...";
       folly::setThreadName("NetlinkEvl");
+      setThreadScheduling(*config, "NetlinkEvl");
       nlEventLoop->run();
       LOG(INFO) << "NetlinkEvl thread got stopped.";
     });
@@ -328,12 +426,13 @@ main(int argc, char** argv) {
       netlinkFibServer->setCpp2WorkerThreadName("FibTWorker");
       netlinkFibServer->setPort(FLAGS_fib_handler_port);
 
+      // Handler is shared with Fib, which calls it in-process if enabled
+      netlinkFibHandler =
+          std::make_shared<NetlinkFibHandler>(nlEventLoop.get(), nlSocket);
       netlinkFibServerThread = std::make_unique<std::thread>(
-          [&netlinkFibServer, &nlEventLoop, nlSocket]() {
+          [&netlinkFibServer, netlinkFibHandler]() {
             folly::setThreadName("FibService");
-            auto fibHandler = std::make_shared<NetlinkFibHandler>(
-                nlEventLoop.get(), nlSocket);
-            netlinkFibServer->setInterface(std::move(fibHandler));
+            netlinkFibServer->setInterface(netlinkFibHandler);
 
             LOG(INFO) << "Starting NetlinkFib server...";
             netlinkFibServer->serve();
@@ -352,12 +451,14 @@ main(int argc, char** argv) {
       netlinkSystemServer->setCpp2WorkerThreadName("SystemTWorker");
       netlinkSystemServer->setPort(FLAGS_system_agent_port);
 
+      // Handler is shared with LinkMonitor and PrefixAllocator, which call it
+      // in-process if enabled
+      netlinkSystemHandler =
+          std::make_shared<NetlinkSystemHandler>(nlSocket->getProtocolSocket());
       netlinkSystemServerThread = std::make_unique<std::thread>(
-          [&netlinkSystemServer, &mainEventLoop, nlSocket]() {
+          [&netlinkSystemServer, netlinkSystemHandler]() {
             folly::setThreadName("SystemService");
-            auto systemHandler = std::make_unique<NetlinkSystemHandler>(
-                nlSocket->getProtocolSocket());
-            netlinkSystemServer->setInterface(std::move(systemHandler));
+            netlinkSystemServer->setInterface(netlinkSystemHandler);
 
             LOG(INFO) << "Starting NetlinkSystem server...";
             netlinkSystemServer->serve();
@@ -366,6 +467,15 @@ main(int argc, char** argv) {
     }
   }
 
+  // Platform handlers of this process called in-process by modules, skipping
+  // thrift loopback
+  std::shared_ptr<thrift::FibServiceSvIf> inProcessFibHandler{nullptr};
+  std::shared_ptr<thrift::SystemServiceSvIf> inProcessSystemHandler{nullptr};
+  if (FLAGS_enable_in_process_platform_clients) {
+    inProcessFibHandler = netlinkFibHandler;
+    inProcessSystemHandler = netlinkSystemHandler;
+  }
+
   const MonitorSubmitUrl monitorSubmitUrl{
       folly::sformat("tcp://[::1]:{}", FLAGS_monitor_rep_port)};
 
@@ -378,8 +488,15 @@ main(int argc, char** argv) {
   });
   mainEventLoop.waitUntilRunning();
 
+  // Only Fib depends on FibService, other modules are brought up while waiting
+  // for it
+  std::thread fibServiceWaitThread;
   if (FLAGS_enable_fib_service_waiting) {
-    waitForFibService(mainEventLoop);
+    fibServiceWaitThread = std::thread([&mainEventLoop]() {
+      folly::setThreadName("FibServiceWait");
+      waitForFibService(mainEventLoop);
+      exportStartupTime("FibService");
+    });
   }
 
   // Starting openrCtrlEvb for thrift handler
@@ -387,6 +504,7 @@ main(int argc, char** argv) {
   std::thread ctrlEvbThread([&]() noexcept {
     LOG(INFO) << "Starting openrCtrl eventbase...";
     folly::setThreadName("openrCtrl");
+    setThreadScheduling(*config, "openrCtrl");
     ctrlEvb.run();
     LOG(INFO) << "OpenrCtrl eventbase stopped...";
   });
@@ -396,6 +514,7 @@ main(int argc, char** argv) {
   auto configStore = startEventBase(
       allThreads,
       orderedEvbs,
+      *config,
       watchdog,
       "ConfigStore",
       std::make_unique<PersistentStore>(
@@ -430,10 +549,16 @@ main(int argc, char** argv) {
     areas = nodeAreas;
   }
 
+  // Reader of Decision is created ahead of KvStore, so that keys KvStore
+  // loads from its snapshot on start are not missed
+  auto decisionKvStoreUpdatesReader =
+      kvStoreUpdatesQueue.getReader(KvStore::getKvStoreUpdatesReaderOptions());
+
   // Start KVStore
   auto kvStore = startEventBase(
       allThreads,
       orderedEvbs,
+      *config,
       watchdog,
       "KvStore",
       std::make_unique<KvStore>(
@@ -448,9 +573,26 @@ main(int argc, char** argv) {
           std::unordered_map<std::string, openr::thrift::PeerSpec>{},
           FLAGS_kvstore_zmq_hwm));
 
+  // Aggregates to summarize advertised prefixes into
+  std::vector<openr::thrift::IpPrefix> aggregatePrefixes;
+  try {
+    std::vector<std::string> aggregates;
+    folly::split(",", FLAGS_prefix_aggregates, aggregates, true);
+    for (auto const& aggregate : aggregates) {
+      aggregatePrefixes.emplace_back(
+          toIpPrefix(folly::IPAddress::createNetwork(aggregate)));
+    }
+  } catch (std::exception const& err) {
+    LOG(ERROR) << "Invalid aggregate string specified. Expected comma "
+               << "separated list of IP/CIDR format, got '"
+               << FLAGS_prefix_aggregates << "'";
+    return -1;
+  }
+
   auto prefixManager = startEventBase(
       allThreads,
       orderedEvbs,
+      *config,
       watchdog,
       "PrefixManager",
       std::make_unique<PrefixManager>(
@@ -463,7 +605,10 @@ main(int argc, char** argv) {
           FLAGS_enable_perf_measurement,
           kvHoldTime,
           std::chrono::milliseconds(FLAGS_kvstore_key_ttl_ms),
-          areas));
+          areas,
+          std::chrono::milliseconds(FLAGS_prefix_manager_persist_debounce_ms),
+          std::chrono::milliseconds(FLAGS_prefix_manager_persist_max_delay_ms),
+          aggregatePrefixes));
 
   // Prefix Allocator to automatically allocate prefixes for nodes
   if (FLAGS_enable_prefix_alloc) {
@@ -484,6 +629,7 @@ main(int argc, char** argv) {
     startEventBase(
         allThreads,
         orderedEvbs,
+        *config,
         watchdog,
         "PrefixAllocator",
         std::make_unique<PrefixAllocator>(
@@ -501,13 +647,15 @@ main(int argc, char** argv) {
             Constants::kPrefixAllocatorSyncInterval,
             configStore,
             context,
-            FLAGS_system_agent_port));
+            FLAGS_system_agent_port,
+            inProcessSystemHandler));
   }
 
   // Create Spark instance for neighbor discovery
   auto spark = startEventBase(
       allThreads,
       orderedEvbs,
+      *config,
       watchdog,
       "Spark",
       std::make_unique<Spark>(
@@ -625,6 +773,7 @@ main(int argc, char** argv) {
   auto linkMonitor = startEventBase(
       allThreads,
       orderedEvbs,
+      *config,
       watchdog,
       "LinkMonitor",
       std::make_unique<LinkMonitor>(
@@ -655,7 +804,13 @@ main(int argc, char** argv) {
           std::chrono::milliseconds(FLAGS_link_flap_initial_backoff_ms),
           std::chrono::milliseconds(FLAGS_link_flap_max_backoff_ms),
           std::chrono::milliseconds(FLAGS_kvstore_key_ttl_ms),
-          areas));
+          areas,
+          FLAGS_per_adjacency_keys,
+          std::chrono::milliseconds(
+              FLAGS_link_monitor_neighbor_down_coalesce_ms),
+          FLAGS_link_monitor_rtt_metric_bucket_size,
+          std::chrono::milliseconds(FLAGS_link_monitor_rtt_metric_hold_ms),
+          inProcessSystemHandler));
 
   // Wait for the above two threads to start and run before running
   // SPF in Decision module.  This is to make sure the Decision module
@@ -665,6 +820,7 @@ main(int argc, char** argv) {
   auto decision = startEventBase(
       allThreads,
       orderedEvbs,
+      *config,
       watchdog,
       "Decision",
       std::make_unique<Decision>(
@@ -673,10 +829,11 @@ main(int argc, char** argv) {
           not FLAGS_enable_bgp_route_programming,
           std::chrono::milliseconds(FLAGS_decision_debounce_min_ms),
           std::chrono::milliseconds(FLAGS_decision_debounce_max_ms),
-          kvStoreUpdatesQueue.getReader(),
+          std::move(decisionKvStoreUpdatesReader),
           staticRoutesUpdateQueue.getReader(),
           routeUpdatesQueue,
-          context));
+          context,
+          &prefixUpdatesQueue));
 
   // FIB ordering works only in single area configuration
   // verify 'default area' is configured and it's the only one configured
@@ -684,21 +841,28 @@ main(int argc, char** argv) {
     CHECK_EQ(areas.count(openr::thrift::KvStore_constants::kDefaultArea()), 1);
     CHECK_EQ(areas.size(), 1);
   }
+  if (fibServiceWaitThread.joinable()) {
+    fibServiceWaitThread.join();
+  }
+
   // Define and start Fib Module
   auto fib = startEventBase(
       allThreads,
       orderedEvbs,
+      *config,
       watchdog,
       "Fib",
       std::make_unique<Fib>(
           config,
           FLAGS_fib_handler_port,
           std::chrono::seconds(3 * FLAGS_spark_keepalive_time_s),
-          routeUpdatesQueue.getReader(),
+          routeUpdatesQueue.getReader(Fib::getRouteUpdatesReaderOptions()),
           interfaceUpdatesQueue.getReader(),
+          fibUpdatesQueue,
           monitorSubmitUrl,
           kvStore,
-          context));
+          context,
+          inProcessFibHandler));
 
   // Start OpenrCtrl thrift server
   apache::thrift::ThriftServer thriftCtrlServer;
@@ -754,11 +918,26 @@ main(int argc, char** argv) {
         prefixManager,
         config,
         monitorSubmitUrl,
-        context);
+        context,
+        spark);
   });
 
   CHECK(ctrlHandler);
   thriftCtrlServer.setInterface(ctrlHandler);
+
+  // Streams of ctrl subscribers can hold large backlog of publications. They
+  // are terminated in ctrl event-base, which publishes to them.
+  if (watchdog) {
+    std::weak_ptr<openr::OpenrCtrlHandler> weakCtrlHandler = ctrlHandler;
+    watchdog->addMemoryReliefCallback(
+        "ctrl_streams", [&ctrlEvb, weakCtrlHandler]() {
+          ctrlEvb.runInEventBaseThread([weakCtrlHandler]() {
+            if (auto handler = weakCtrlHandler.lock()) {
+              handler->terminateStreams();
+            }
+          });
+        });
+  }
   thriftCtrlServer.setNumIOWorkerThreads(1);
   // Intentionally kept this as (1). If you're changing to higher number please
   // address thread safety for private member variables in OpenrCtrlHandler
@@ -780,7 +959,8 @@ main(int argc, char** argv) {
                            staticRoutesUpdateQueue,
                            routeUpdatesQueue.getReader(),
                            config,
-                           sslContext});
+                           sslContext,
+                           decision});
   }
 
   // Wait for main-event loop to return
@@ -789,6 +969,7 @@ main(int argc, char** argv) {
   // Stop all threads (in reverse order of their creation)
   routeUpdatesQueue.close();
   interfaceUpdatesQueue.close();
+  fibUpdatesQueue.close();
   peerUpdatesQueue.close();
   neighborUpdatesQueue.close();
   prefixUpdatesQueue.close();
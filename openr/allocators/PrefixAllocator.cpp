@@ -15,6 +15,7 @@
 #include <folly/ScopeGuard.h>
 #include <folly/String.h>
 #include <folly/futures/Future.h>
+#include <folly/hash/SpookyHashV2.h>
 #include <thrift/lib/cpp/protocol/TProtocolTypes.h>
 #include <thrift/lib/cpp/transport/THeader.h>
 #include <thrift/lib/cpp2/async/HeaderClientChannel.h>
@@ -49,7 +50,8 @@ PrefixAllocator::PrefixAllocator(
     std::chrono::milliseconds syncInterval,
     PersistentStore* configStore,
     fbzmq::Context& zmqContext,
-    int32_t systemServicePort)
+    int32_t systemServicePort,
+    std::shared_ptr<thrift::SystemServiceSvIf> systemHandler)
     : myNodeName_(myNodeName),
       allocPrefixMarker_(allocPrefixMarker),
       setLoopbackAddress_(setLoopbackAddress),
@@ -60,8 +62,9 @@ PrefixAllocator::PrefixAllocator(
       syncInterval_(syncInterval),
       configStore_(configStore),
       prefixUpdatesQueue_(prefixUpdatesQueue),
-      zmqMonitorClient_(zmqContext, monitorSubmitUrl),
-      systemServicePort_(systemServicePort) {
+      eventLogger_(zmqContext, monitorSubmitUrl),
+      systemServicePort_(systemServicePort),
+      systemHandler_(std::move(systemHandler)) {
   // check non-empty module ptr
   CHECK(configStore_);
   CHECK(kvStore_);
@@ -462,10 +465,14 @@ PrefixAllocator::getInitPrefixIndex() {
     return kvstorePrefixIndex.value();
   }
 
-  // Generate a new random prefix index
+  // Generate a new prefix index from hash of node name. Use hash with stable
+  // output across platforms and library versions so that nodes of a cluster
+  // cold starting together spread over the range the same way every time.
   if (allocParams_.has_value()) {
     uint32_t hashPrefixIndex =
-        hasher(myNodeName_) % getPrefixCount(*allocParams_);
+        folly::hash::SpookyHashV2::Hash32(
+            myNodeName_.data(), myNodeName_.size(), 0 /* seed */) %
+        getPrefixCount(*allocParams_);
     LOG(INFO) << "Generate new initial prefix index: " << hashPrefixIndex;
     return hashPrefixIndex;
   }
@@ -530,9 +537,10 @@ PrefixAllocator::startAllocation(
       [this](std::optional<uint32_t> newPrefixIndex) noexcept {
         applyMyPrefixIndex(newPrefixIndex);
       },
-      syncInterval_,
+      // retry quickly after collision, retry values are spread by allocator
+      Constants::kPrefixAllocatorRetryInterval,
       // no need for randomness since "collision" is harmless
-      syncInterval_ + 1ms,
+      syncInterval_,
       // do not allow override
       false,
       [this](uint32_t allocIndex) noexcept->bool {
@@ -651,61 +659,57 @@ PrefixAllocator::updateMyPrefix(folly::CIDRNetwork prefix) {
   request.prefixes = {prefixEntry};
   prefixUpdatesQueue_.push(std::move(request));
 
+  if (!setLoopbackAddress_) {
+    return;
+  }
+
   // existing global prefixes
-  std::vector<folly::CIDRNetwork> oldPrefixes;
-  getIfacePrefixes(loopbackIfaceName_, prefix.first.family(), oldPrefixes);
+  const auto family = prefix.first.family();
+  const auto& oldPrefixes = getIfacePrefixes(family);
 
-  // desired global prefixes
-  auto loopbackPrefix = createLoopbackPrefix(prefix);
-  std::vector<folly::CIDRNetwork> toSyncPrefixes{loopbackPrefix};
+  // desired global prefix
+  const auto loopbackPrefix = createLoopbackPrefix(prefix);
 
   // get a list of prefixes need to be deleted
   std::vector<folly::CIDRNetwork> toDeletePrefixes;
-  std::set_difference(
-      oldPrefixes.begin(),
-      oldPrefixes.end(),
-      toSyncPrefixes.begin(),
-      toSyncPrefixes.end(),
-      std::inserter(toDeletePrefixes, toDeletePrefixes.begin()));
-
-  if (toDeletePrefixes.empty() && !oldPrefixes.empty()) {
-    LOG(INFO) << "Prefix not changed";
-    return;
-  }
-
-  // delete unwanted global prefixes
-  for (const auto& toDeletePrefix : toDeletePrefixes) {
+  for (const auto& oldPrefix : oldPrefixes) {
+    if (oldPrefix == loopbackPrefix) {
+      continue;
+    }
     bool needToDelete = false;
-    if (toDeletePrefix.first.inSubnet(
+    if (oldPrefix.first.inSubnet(
             allocParams_->first.first, allocParams_->first.second)) {
       // delete existing prefix in the subnet as seedPrefix
       needToDelete = true;
-    } else if (overrideGlobalAddress_ and !toDeletePrefix.first.isLinkLocal()) {
+    } else if (overrideGlobalAddress_ and !oldPrefix.first.isLinkLocal()) {
       // delete non-link-local addresses
       needToDelete = true;
     }
 
-    if (!needToDelete or !setLoopbackAddress_) {
-      toSyncPrefixes.emplace_back(toDeletePrefix);
-      continue;
+    if (needToDelete) {
+      LOG(INFO) << "Will delete address "
+                << folly::IPAddress::networkToString(oldPrefix)
+                << " on interface " << loopbackIfaceName_;
+      toDeletePrefixes.emplace_back(oldPrefix);
     }
+  }
 
-    LOG(INFO) << "Will delete address "
-              << folly::IPAddress::networkToString(toDeletePrefix)
-              << " on interface " << loopbackIfaceName_;
+  const bool needToAdd = oldPrefixes.count(loopbackPrefix) == 0;
+  if (!needToAdd and toDeletePrefixes.empty()) {
+    LOG(INFO) << "Prefix not changed";
+    return;
   }
 
-  // Assign new address to loopback
-  if (setLoopbackAddress_) {
+  // Assign new address to loopback before deleting old ones, so that loopback
+  // is never left without address while prefix changes
+  if (needToAdd) {
     LOG(INFO) << "Assigning address: "
               << folly::IPAddress::networkToString(loopbackPrefix)
               << " on interface " << loopbackIfaceName_;
-    toSyncPrefixes.emplace_back(loopbackPrefix);
-    syncIfaceAddrs(
-        loopbackIfaceName_,
-        prefix.first.family(),
-        RT_SCOPE_UNIVERSE,
-        toSyncPrefixes);
+    addIfaceAddrs(loopbackIfaceName_, family, {loopbackPrefix});
+  }
+  if (!toDeletePrefixes.empty()) {
+    delIfaceAddrs(loopbackIfaceName_, family, toDeletePrefixes);
   }
 }
 
@@ -716,13 +720,13 @@ PrefixAllocator::withdrawMyPrefix() {
     LOG(INFO) << "Flushing existing addresses from interface "
               << loopbackIfaceName_;
 
+    const auto& prefix = allocParams_->first;
     if (overrideGlobalAddress_) {
       std::vector<folly::CIDRNetwork> addrs;
-      const auto& prefix = allocParams_->first;
       syncIfaceAddrs(
           loopbackIfaceName_, prefix.first.family(), RT_SCOPE_UNIVERSE, addrs);
     } else {
-      delIfaceAddr(loopbackIfaceName_, allocParams_->first);
+      delIfaceAddrs(loopbackIfaceName_, prefix.first.family(), {prefix});
     }
   }
 
@@ -733,18 +737,21 @@ PrefixAllocator::withdrawMyPrefix() {
   prefixUpdatesQueue_.push(std::move(request));
 }
 
-void
-PrefixAllocator::getIfacePrefixes(
-    const std::string& iface,
-    int family,
-    std::vector<folly::CIDRNetwork>& addrs) {
-  createThriftClient(evb_, socket_, client_, systemServicePort_);
-  std::vector<thrift::IpPrefix> prefixes;
-  client_->sync_getIfaceAddresses(prefixes, iface, family, RT_SCOPE_UNIVERSE);
-  addrs.clear();
+const std::set<folly::CIDRNetwork>&
+PrefixAllocator::getIfacePrefixes(int family) {
+  auto it = ifaceAddrs_.find(family);
+  if (it != ifaceAddrs_.end()) {
+    return it->second;
+  }
+
+  createThriftClient();
+  const auto prefixes =
+      client_->getIfaceAddresses(loopbackIfaceName_, family, RT_SCOPE_UNIVERSE);
+  auto& addrs = ifaceAddrs_[family];
   for (const auto& prefix : prefixes) {
-    addrs.emplace_back(toIPNetwork(prefix));
+    addrs.emplace(toIPNetwork(prefix));
   }
+  return addrs;
 }
 
 void
@@ -753,36 +760,76 @@ PrefixAllocator::syncIfaceAddrs(
     int family,
     int scope,
     const std::vector<folly::CIDRNetwork>& prefixes) {
-  createThriftClient(evb_, socket_, client_, systemServicePort_);
+  createThriftClient();
 
   std::vector<thrift::IpPrefix> addrs;
   for (const auto& prefix : prefixes) {
     addrs.emplace_back(toIpPrefix(prefix));
   }
   try {
-    client_->sync_syncIfaceAddresses(ifName, family, scope, addrs);
+    client_->syncIfaceAddresses(ifName, family, scope, std::move(addrs));
   } catch (const std::exception& ex) {
     client_.reset();
+    ifaceAddrs_.erase(family);
     LOG(ERROR) << "PrefixAllocator sync IfAddress failed";
     throw;
   }
+  if (ifName == loopbackIfaceName_ and scope == RT_SCOPE_UNIVERSE) {
+    ifaceAddrs_[family] =
+        std::set<folly::CIDRNetwork>(prefixes.begin(), prefixes.end());
+  }
 }
 
 void
-PrefixAllocator::delIfaceAddr(
-    const std::string& ifName, const folly::CIDRNetwork& prefix) {
-  createThriftClient(evb_, socket_, client_, systemServicePort_);
+PrefixAllocator::addIfaceAddrs(
+    const std::string& ifName,
+    int family,
+    const std::vector<folly::CIDRNetwork>& prefixes) {
+  createThriftClient();
 
   std::vector<thrift::IpPrefix> addrs;
-  addrs.emplace_back(toIpPrefix(prefix));
+  for (const auto& prefix : prefixes) {
+    addrs.emplace_back(toIpPrefix(prefix));
+  }
+  try {
+    client_->addIfaceAddresses(ifName, std::move(addrs));
+  } catch (const std::exception& ex) {
+    client_.reset();
+    ifaceAddrs_.erase(family);
+    LOG(ERROR) << "PrefixAllocator add IfAddress failed";
+    throw;
+  }
+  auto it = ifaceAddrs_.find(family);
+  if (ifName == loopbackIfaceName_ and it != ifaceAddrs_.end()) {
+    it->second.insert(prefixes.begin(), prefixes.end());
+  }
+}
+
+void
+PrefixAllocator::delIfaceAddrs(
+    const std::string& ifName,
+    int family,
+    const std::vector<folly::CIDRNetwork>& prefixes) {
+  createThriftClient();
+
+  std::vector<thrift::IpPrefix> addrs;
+  for (const auto& prefix : prefixes) {
+    addrs.emplace_back(toIpPrefix(prefix));
+  }
   try {
-    client_->sync_removeIfaceAddresses(ifName, addrs);
+    client_->removeIfaceAddresses(ifName, std::move(addrs));
   } catch (const std::exception& ex) {
     client_.reset();
-    LOG(ERROR) << "PrefixAllocator del IfAddress failed: "
-               << folly::IPAddress::networkToString(prefix);
+    ifaceAddrs_.erase(family);
+    LOG(ERROR) << "PrefixAllocator del IfAddress failed";
     throw;
   }
+  auto it = ifaceAddrs_.find(family);
+  if (ifName == loopbackIfaceName_ and it != ifaceAddrs_.end()) {
+    for (const auto& prefix : prefixes) {
+      it->second.erase(prefix);
+    }
+  }
 }
 
 void
@@ -828,38 +875,38 @@ PrefixAllocator::logPrefixEvent(
     sample.addInt("new_alloc_len", newAllocParams->second);
   }
 
-  zmqMonitorClient_.addEventLog(fbzmq::thrift::EventLog(
-      apache::thrift::FRAGILE,
-      Constants::kEventLogCategory.toString(),
-      {sample.toJson()}));
+  eventLogger_.log(std::move(sample));
 }
 
 void
-PrefixAllocator::createThriftClient(
-    folly::EventBase& evb,
-    std::shared_ptr<folly::AsyncSocket>& socket,
-    std::unique_ptr<thrift::SystemServiceAsyncClient>& client,
-    int32_t port) {
+PrefixAllocator::createThriftClient() {
+  if (systemHandler_) {
+    if (not client_) {
+      client_ = std::make_unique<SystemServiceClient>(systemHandler_);
+    }
+    return;
+  }
+
   // Reset client if channel is not good
-  if (socket && (!socket->good() || socket->hangup())) {
-    client.reset();
-    socket.reset();
+  if (socket_ && (!socket_->good() || socket_->hangup())) {
+    client_.reset();
+    socket_.reset();
   }
 
   // Do not create new client if one exists already
-  if (client) {
+  if (client_) {
     return;
   }
 
   // Create socket to thrift server and set some connection parameters
-  socket = folly::AsyncSocket::newSocket(
-      &evb,
+  socket_ = folly::AsyncSocket::newSocket(
+      &evb_,
       Constants::kPlatformHost.toString(),
-      port,
+      systemServicePort_,
       Constants::kPlatformConnTimeout.count());
 
   // Create channel and set timeout
-  auto channel = apache::thrift::HeaderClientChannel::newChannel(socket);
+  auto channel = apache::thrift::HeaderClientChannel::newChannel(socket_);
   channel->setTimeout(Constants::kPlatformIntfProcTimeout.count());
 
   // Set BinaryProtocol and Framed client type for talkiing with thrift1 server
@@ -867,8 +914,8 @@ PrefixAllocator::createThriftClient(
   channel->setClientType(THRIFT_FRAMED_DEPRECATED);
 
   // Reset client_
-  client =
-      std::make_unique<thrift::SystemServiceAsyncClient>(std::move(channel));
+  client_ = std::make_unique<SystemServiceClient>(
+      std::make_unique<thrift::SystemServiceAsyncClient>(std::move(channel)));
 }
 
 } // namespace openr
@@ -9,10 +9,10 @@
 
 #include <chrono>
 #include <functional>
+#include <set>
 #include <string>
 
 #include <fbzmq/async/ZmqTimeout.h>
-#include <fbzmq/service/monitor/ZmqMonitorClient.h>
 #include <folly/IPAddress.h>
 #include <folly/Optional.h>
 #include <folly/io/async/AsyncSocket.h>
@@ -20,6 +20,7 @@
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include <openr/common/Constants.h>
+#include <openr/common/EventLogger.h>
 #include <openr/common/NetworkUtil.h>
 #include <openr/common/OpenrEventBase.h>
 #include <openr/common/Util.h>
@@ -32,6 +33,7 @@
 #include <openr/kvstore/KvStore.h>
 #include <openr/kvstore/KvStoreClientInternal.h>
 #include <openr/messaging/ReplicateQueue.h>
+#include <openr/platform/PlatformClients.h>
 
 #include "RangeAllocator.h"
 
@@ -82,7 +84,10 @@ class PrefixAllocator : public OpenrEventBase {
       std::chrono::milliseconds syncInterval,
       PersistentStore* configStore,
       fbzmq::Context& zmqContext,
-      int32_t systemServicePort);
+      int32_t systemServicePort,
+      // SystemService handler running in-process, called directly instead of
+      // over thrift on systemServicePort if set
+      std::shared_ptr<thrift::SystemServiceSvIf> systemHandler = nullptr);
 
   PrefixAllocator(PrefixAllocator const&) = delete;
   PrefixAllocator& operator=(PrefixAllocator const&) = delete;
@@ -166,20 +171,22 @@ class PrefixAllocator : public OpenrEventBase {
       int scope,
       const std::vector<folly::CIDRNetwork>& prefixes);
 
-  void delIfaceAddr(
-      const std::string& ifName, const folly::CIDRNetwork& prefix);
+  void addIfaceAddrs(
+      const std::string& ifName,
+      int family,
+      const std::vector<folly::CIDRNetwork>& prefixes);
 
-  void getIfacePrefixes(
-      const std::string& iface,
+  void delIfaceAddrs(
+      const std::string& ifName,
       int family,
-      std::vector<folly::CIDRNetwork>& addrs);
+      const std::vector<folly::CIDRNetwork>& prefixes);
+
+  // global addresses on loopback interface. Fetched from system service on
+  // first use and tracked locally afterwards as we program them.
+  const std::set<folly::CIDRNetwork>& getIfacePrefixes(int family);
 
   // Create client when necessary
-  void createThriftClient(
-      folly::EventBase& evb,
-      std::shared_ptr<folly::AsyncSocket>& socket,
-      std::unique_ptr<thrift::SystemServiceAsyncClient>& client,
-      int32_t port);
+  void createThriftClient();
 
   //
   // Const private variables
@@ -201,9 +208,6 @@ class PrefixAllocator : public OpenrEventBase {
   // Sync interval for range allocator
   const std::chrono::milliseconds syncInterval_;
 
-  // hash node ID into prefix space
-  const std::hash<std::string> hasher{};
-
   //
   // Non-const private variables
   //
@@ -232,14 +236,16 @@ class PrefixAllocator : public OpenrEventBase {
   // Queue to send prefix update request to PrefixManager
   messaging::ReplicateQueue<thrift::PrefixUpdateRequest>& prefixUpdatesQueue_;
 
-  // Monitor client for submitting counters/logs
-  fbzmq::ZmqMonitorClient zmqMonitorClient_;
+  // Batched logger of events, submitting them to monitor
+  EventLogger eventLogger_;
 
-  // Thriftclient for system service
+  // Client for system service, calling its handler directly when it runs
+  // in-process
   int32_t systemServicePort_{0};
   folly::EventBase evb_;
   std::shared_ptr<folly::AsyncSocket> socket_{nullptr};
-  std::unique_ptr<thrift::SystemServiceAsyncClient> client_{nullptr};
+  std::shared_ptr<thrift::SystemServiceSvIf> systemHandler_{nullptr};
+  std::unique_ptr<SystemServiceClient> client_{nullptr};
 
   // AsyncTimeout for initialization
   std::unique_ptr<folly::AsyncTimeout> initTimer_;
@@ -252,6 +258,11 @@ class PrefixAllocator : public OpenrEventBase {
    */
   std::pair<bool, std::optional<folly::CIDRNetwork>> applyState_;
 
+  // global addresses programmed on loopback interface per address family.
+  // Entry is dropped if programming fails, as state of interface is unknown.
+  std::unordered_map<int /* family */, std::set<folly::CIDRNetwork>>
+      ifaceAddrs_;
+
   // save alloc index from e2e-network-alllocation <value version, indices set>
   std::pair<int64_t, std::unordered_set<uint32_t>> e2eAllocIndex_{-1, {}};
 
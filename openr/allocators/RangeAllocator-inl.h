@@ -76,6 +76,9 @@ RangeAllocator<T>::~RangeAllocator() {
   }
 
   // Unsubscribe from KvStoreClientInternal if we have been to
+  if (isMirrored_) {
+    kvStoreClient_->unsubscribeKeyPrefix(keyPrefix_, area_);
+  }
   if (myValue_) {
     const auto myKey = createKey(*myValue_);
     kvStoreClient_->unsubscribeKey(myKey);
@@ -119,6 +122,15 @@ RangeAllocator<T>::startAllocator(
   }
   allocRangeSize_ = allocRange_.second - allocRange_.first + 1;
 
+  // Build occupancy bitmap from mirrored KvStore content. Bitmap is kept
+  // updated along with mirror afterwards.
+  mirrorKeys();
+  for (const auto& [val, owner] : owners_) {
+    if (val >= allocRange_.first and val <= allocRange_.second) {
+      setOccupied(val, isOccupiedBy(owner));
+    }
+  }
+
   // Subscribe to changes in KvStore
   VLOG(2) << "RangeAllocator: Created. Scheduling first tryAllocate. "
           << "Node: " << nodeName_ << ", Prefix: " << keyPrefix_;
@@ -127,40 +139,62 @@ RangeAllocator<T>::startAllocator(
 }
 
 template <typename T>
-bool
-RangeAllocator<T>::isRangeConsumed() const {
+void
+RangeAllocator<T>::mirrorKeys() {
+  if (isMirrored_) {
+    return;
+  }
+  isMirrored_ = true;
+
+  // Subscribe first and dump afterwards. Both happen in our event loop so no
+  // update can be missed in between.
+  kvStoreClient_->subscribeKeyPrefix(
+      keyPrefix_,
+      [this](
+          const std::string& key,
+          std::optional<thrift::Value> thriftVal) noexcept {
+        keyUpdated(key, thriftVal);
+      },
+      area_);
   const auto maybeKeyMap = kvStoreClient_->dumpAllWithPrefix(keyPrefix_, area_);
   CHECK(maybeKeyMap.has_value())
       << "Failed to dump keys with prefix: " << keyPrefix_
       << " from kvstore in area: " << area_;
-  T count = 0;
   for (const auto& kv : *maybeKeyMap) {
-    const auto val =
-        details::binaryToPrimitive<T>(kv.second.value_ref().value());
-    if (val >= allocRange_.first && val <= allocRange_.second) {
-      ++count;
-    }
+    keyUpdated(kv.first, kv.second);
   }
+}
+
+template <typename T>
+bool
+RangeAllocator<T>::isRangeConsumed() {
+  T count = 0;
+  eventBase_->getEvb()->runImmediatelyOrRunInEventBaseThreadAndWait([&]() {
+    mirrorKeys();
+    for (const auto& kv : owners_) {
+      if (kv.first >= allocRange_.first && kv.first <= allocRange_.second) {
+        ++count;
+      }
+    }
+  });
   CHECK(count <= allocRangeSize_);
   return (count == allocRangeSize_);
 }
 
 template <typename T>
 std::optional<T>
-RangeAllocator<T>::getValueFromKvStore() const {
-  const auto maybeKeyMap = kvStoreClient_->dumpAllWithPrefix(keyPrefix_, area_);
-  CHECK(maybeKeyMap.has_value())
-      << "Failed to dump keys with prefix: " << keyPrefix_
-      << " from kvstore in area: " << area_;
-  for (const auto& kv : *maybeKeyMap) {
-    if (kv.second.originatorId == nodeName_) {
-      const auto val =
-          details::binaryToPrimitive<T>(kv.second.value_ref().value());
-      CHECK_EQ(kv.first, createKey(val));
-      return val;
+RangeAllocator<T>::getValueFromKvStore() {
+  std::optional<T> val;
+  eventBase_->getEvb()->runImmediatelyOrRunInEventBaseThreadAndWait([&]() {
+    mirrorKeys();
+    for (const auto& kv : owners_) {
+      if (kv.second == nodeName_) {
+        val = kv.first;
+        break;
+      }
     }
-  }
-  return std::nullopt;
+  });
+  return val;
 }
 
 template <typename T>
@@ -258,40 +292,41 @@ RangeAllocator<T>::scheduleAllocate(const T seedVal) noexcept {
   // Apply exponential backoff
   backoff_.reportError();
 
-  // Use random value selection logic based on seedVal
-  std::mt19937_64 gen(seedVal + folly::Random::rand64());
-  std::uniform_int_distribution<T> dist(allocRange_.first, allocRange_.second);
-  auto newVal = dist(gen);
-
-  const auto maybeKeyMap = kvStoreClient_->dumpAllWithPrefix(keyPrefix_, area_);
-  CHECK(maybeKeyMap.has_value())
-      << "Failed to dump keys with prefix: " << keyPrefix_
-      << " from kvstore in area: " << area_;
-  const auto valOwners =
-      folly::gen::from(*maybeKeyMap) |
-      folly::gen::map([](std::pair<std::string, thrift::Value> const& kv) {
-        return std::make_pair(
-            details::binaryToPrimitive<T>(kv.second.value_ref().value()),
-            kv.second.originatorId);
-      }) |
-      folly::gen::as<
-          std::unordered_map<T /* value */, std::string /* owner */>>();
-
-  // look for a value I can own
-  T i;
-  for (i = 0; i < allocRangeSize_; ++i) {
-    const auto it = valOwners.find(newVal);
-    // not owned yet or owned by higher originator if override is allowed
-    if (it == valOwners.end() or (overrideOwner_ and nodeName_ >= it->second)) {
-      if (!checkValueInUseCb_ or !checkValueInUseCb_(newVal)) {
-        // found
+  // Pick candidate from our own probe sequence. It is deterministic so that
+  // retries are reproducible, yet differs across nodes so that nodes which
+  // collided on seedVal spread over the range instead of racing again.
+  ++numCollisions_;
+  const uint64_t rangeSize = allocRangeSize_;
+  const uint64_t hash = folly::hash::SpookyHashV2::Hash64(
+      nodeName_.data(),
+      nodeName_.size(),
+      static_cast<uint64_t>(seedVal) + numCollisions_);
+  T newVal = allocRange_.first + hash % rangeSize;
+
+  // look for a value I can own, starting from candidate value and wrapping
+  // around at the end of range
+  const uint64_t seedOffset = newVal - allocRange_.first;
+  std::optional<T> freeVal;
+  for (const auto& [fromOffset, toOffset] :
+       {std::make_pair(seedOffset, rangeSize),
+        std::make_pair(uint64_t{0}, seedOffset)}) {
+    auto offset = fromOffset;
+    while (not freeVal.has_value()) {
+      const auto maybeVal = findFirstFree(offset, toOffset);
+      if (not maybeVal.has_value()) {
         break;
       }
+      if (!checkValueInUseCb_ or !checkValueInUseCb_(*maybeVal)) {
+        // found
+        freeVal = maybeVal;
+      }
+      // try next
+      offset = static_cast<uint64_t>(*maybeVal - allocRange_.first) + 1;
     }
-    // try next
-    newVal = (newVal < allocRange_.second) ? (newVal + 1) : allocRange_.first;
   }
-  if (i == allocRangeSize_) {
+  if (freeVal.has_value()) {
+    newVal = *freeVal;
+  } else {
     LOG(ERROR) << "All values are owned by higher originatorIds";
   }
 
@@ -300,6 +335,78 @@ RangeAllocator<T>::scheduleAllocate(const T seedVal) noexcept {
   timeout_->scheduleTimeout(backoff_.getTimeRemainingUntilRetry());
 }
 
+template <typename T>
+void
+RangeAllocator<T>::keyUpdated(
+    const std::string& key,
+    const std::optional<thrift::Value>& thriftVal) noexcept {
+  const auto maybeVal =
+      folly::tryTo<T>(folly::StringPiece(key).subpiece(keyPrefix_.size()));
+  if (maybeVal.hasError()) {
+    return;
+  }
+  const T val = *maybeVal;
+  if (thriftVal.has_value()) {
+    owners_[val] = thriftVal->originatorId;
+  } else {
+    owners_.erase(val);
+  }
+
+  if (hasStarted_ and val >= allocRange_.first and val <= allocRange_.second) {
+    setOccupied(val, thriftVal.has_value() and isOccupiedBy(owners_.at(val)));
+  }
+}
+
+template <typename T>
+bool
+RangeAllocator<T>::isOccupiedBy(const std::string& originatorId) const
+    noexcept {
+  // value owned by us or by lower originator (if override is allowed) is
+  // still available for us to own
+  return not(overrideOwner_ and nodeName_ >= originatorId);
+}
+
+template <typename T>
+void
+RangeAllocator<T>::setOccupied(const T val, const bool occupied) noexcept {
+  const uint64_t offset = val - allocRange_.first;
+  const uint64_t mask = uint64_t{1} << (offset % 64);
+  if (occupied) {
+    occupied_[offset / 64] |= mask;
+    return;
+  }
+  auto it = occupied_.find(offset / 64);
+  if (it != occupied_.end()) {
+    it->second &= ~mask;
+    if (it->second == 0) {
+      occupied_.erase(it);
+    }
+  }
+}
+
+template <typename T>
+std::optional<T>
+RangeAllocator<T>::findFirstFree(
+    uint64_t fromOffset, const uint64_t toOffset) const noexcept {
+  while (fromOffset < toOffset) {
+    const auto it = occupied_.find(fromOffset / 64);
+    // treat bits below fromOffset in this word as occupied
+    const uint64_t bits = (it == occupied_.end() ? 0 : it->second) |
+        ((uint64_t{1} << (fromOffset % 64)) - 1);
+    if (~bits != 0) {
+      const uint64_t offset =
+          (fromOffset / 64) * 64 + folly::findFirstSet(~bits) - 1;
+      if (offset >= toOffset) {
+        break;
+      }
+      return static_cast<T>(allocRange_.first + offset);
+    }
+    // whole word is occupied, jump to next one
+    fromOffset = (fromOffset / 64 + 1) * 64;
+  }
+  return std::nullopt;
+}
+
 template <typename T>
 void
 RangeAllocator<T>::keyValUpdated(
@@ -331,6 +438,7 @@ RangeAllocator<T>::keyValUpdated(
 
     // Clear backoff
     backoff_.reportSuccess();
+    numCollisions_ = 0;
   } else {
     // We lost the currently trying value or allocated value
     VLOG(3) << "RangeAllocator " << nodeName_ << ": Lost " << val
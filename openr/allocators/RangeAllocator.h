@@ -8,14 +8,16 @@
 #pragma once
 
 #include <chrono>
-#include <random>
 #include <string>
+#include <unordered_map>
 
 #include <fbzmq/async/ZmqTimeout.h>
+#include <folly/Conv.h>
 #include <folly/Format.h>
 #include <folly/Optional.h>
-#include <folly/Random.h>
 #include <folly/gen/Base.h>
+#include <folly/hash/SpookyHashV2.h>
+#include <folly/lang/Bits.h>
 
 #include <openr/common/ExponentialBackoff.h>
 #include <openr/common/OpenrEventBase.h>
@@ -38,8 +40,14 @@ class RangeAllocator {
    * Idea:
    * - Generate a random value to be claimed
    * - Try electing it via KvStore. Higher originatorId wins.
-   * - If we fail we should try again with another random number
+   * - If we fail we should try again with another value. Retry values are
+   *   derived from hash of our name and number of collisions so far, so each
+   *   node follows its own deterministic probe sequence and nodes which
+   *   collided once don't keep colliding
    * - To ease up re-tries we use ExponentialBackoff
+   * - Values we can't own are tracked in a local bitmap, kept up to date from
+   *   KvStore publications, so that a retry jumps directly to a free value
+   *   even when range is almost fully allocated
    *
    * callback: tells you of new allocated value.
    * overrideOwner:  allow a higher originator ID to grab a key from an existing
@@ -84,10 +92,10 @@ class RangeAllocator {
   }
 
   // Allocated value stored in kvstore if any
-  std::optional<T> getValueFromKvStore() const;
+  std::optional<T> getValueFromKvStore();
 
   // check if the whole range has been allocated
-  bool isRangeConsumed() const;
+  bool isRangeConsumed();
 
  private:
   /**
@@ -106,8 +114,8 @@ class RangeAllocator {
   void tryAllocate(const T newVal) noexcept;
 
   /**
-   * Schedule allocation of a new value. A new random value will be chosen
-   * based on the seed value.
+   * Schedule allocation of a new value. A new value will be chosen based on
+   * the seed value, our name and number of collisions so far.
    */
   void scheduleAllocate(const T seedVal) noexcept;
 
@@ -116,6 +124,37 @@ class RangeAllocator {
   void keyValUpdated(
       const std::string& key, const thrift::Value& thriftVal) noexcept;
 
+  /**
+   * Dump keys with our key prefix once and subscribe to their updates. All
+   * later reads of allocation state are served from local mirror.
+   */
+  void mirrorKeys();
+
+  /**
+   * Invoked for every update of a key with our key prefix. Keeps local mirror
+   * and occupancy bitmap in sync with KvStore.
+   */
+  void keyUpdated(
+      const std::string& key,
+      const std::optional<thrift::Value>& thriftVal) noexcept;
+
+  /**
+   * Whether value owned by given originator is unavailable for us to own
+   */
+  bool isOccupiedBy(const std::string& originatorId) const noexcept;
+
+  /**
+   * Mark value as (not) available for us to own in occupancy bitmap
+   */
+  void setOccupied(const T val, const bool occupied) noexcept;
+
+  /**
+   * Find first value not marked in occupancy bitmap, with offset from start
+   * of range in [fromOffset, toOffset)
+   */
+  std::optional<T> findFirstFree(
+      uint64_t fromOffset, const uint64_t toOffset) const noexcept;
+
   /**
    * Utility function to create KvStore key for the value.
    */
@@ -161,6 +200,19 @@ class RangeAllocator {
   // Currently requested value
   std::optional<T> myRequestedValue_;
 
+  // Mirror of values with key in KvStore to their owners, kept up to date from
+  // key prefix subscription once mirrored
+  std::unordered_map<T /* value */, std::string /* owner */> owners_;
+  bool isMirrored_{false};
+
+  // Occupancy bitmap of values owned by others which we can't take over,
+  // indexed by offset from start of range. Only non-zero words are stored so
+  // memory is bounded by number of keys rather than size of range.
+  std::unordered_map<uint64_t /* word */, uint64_t /* bits */> occupied_;
+
+  // Number of failed attempts since last successful allocation
+  uint64_t numCollisions_{0};
+
   // Exponential backoff to avoid frequent allocation retries
   ExponentialBackoff<std::chrono::milliseconds> backoff_;
 
@@ -0,0 +1,249 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+#include <folly/synchronization/Baton.h>
+
+#include <openr/allocators/RangeAllocator.h>
+#include <openr/common/Constants.h>
+#include <openr/common/Util.h>
+#include <openr/common/tests/BenchmarkUtils.h>
+#include <openr/config/Config.h>
+#include <openr/config/tests/Utils.h>
+#include <openr/kvstore/KvStoreWrapper.h>
+
+namespace openr {
+
+namespace {
+
+const std::string kKeyPrefix("allocprefix:");
+
+// Originator of pre-filled values. Higher than any allocator so that its
+// values can't be taken over.
+const std::string kFillerName("zz-filler");
+
+std::string
+getAllocatorName(size_t id) {
+  return folly::sformat("node-{:06d}", id);
+}
+
+} // namespace
+
+/**
+ * Simulation of many RangeAllocator instances, each with its own
+ * KvStoreClientInternal, electing values from a partially pre-filled range of
+ * a shared KvStore. Tracks allocations until every allocator holds a distinct
+ * value and counts key-values published by KvStore meanwhile.
+ */
+class RangeAllocatorBenchmarkFixture {
+ public:
+  RangeAllocatorBenchmarkFixture(
+      size_t numAllocators, uint32_t rangeSize, uint32_t numPrefilled)
+      : numAllocators_(numAllocators) {
+    CHECK_LE(numAllocators + numPrefilled, rangeSize) << "Range too small";
+
+    auto tConfig = getBasicOpenrConfig("store");
+    config_ = std::make_shared<Config>(tConfig);
+    kvStoreWrapper_ = std::make_unique<KvStoreWrapper>(
+        context_, config_, std::unordered_map<std::string, thrift::PeerSpec>{});
+    kvStoreWrapper_->run();
+
+    // Pre-fill every n-th value of range, so that free values are spread
+    // over the range
+    std::vector<std::pair<std::string, thrift::Value>> keyVals;
+    for (uint32_t i = 0; i < numPrefilled; ++i) {
+      const uint32_t val =
+          static_cast<uint64_t>(i) * rangeSize / std::max(numPrefilled, 1u);
+      keyVals.emplace_back(
+          folly::sformat("{}{}", kKeyPrefix, val),
+          createThriftValue(
+              1,
+              kFillerName,
+              std::string(reinterpret_cast<const char*>(&val), sizeof(val)),
+              Constants::kRangeAllocTtl.count()));
+    }
+    if (not keyVals.empty()) {
+      CHECK(kvStoreWrapper_->setKeys(keyVals));
+    }
+
+    // Observe every key-value published by KvStore
+    observer_ = std::make_unique<KvStoreClientInternal>(
+        &evb_, "observer", kvStoreWrapper_->getKvStore());
+    observer_->setKvCallback(
+        [this](
+            const std::string& key,
+            std::optional<thrift::Value> value) noexcept {
+          if (key.find(kKeyPrefix) != 0 or not value.has_value()) {
+            return;
+          }
+          ++numKeyVals_;
+          if (value->originatorId != kFillerName) {
+            ++numAttempts_;
+          }
+        });
+
+    for (size_t i = 0; i < numAllocators; ++i) {
+      clients_.emplace_back(std::make_unique<KvStoreClientInternal>(
+          &evb_, getAllocatorName(i), kvStoreWrapper_->getKvStore()));
+      allocators_.emplace_back(std::make_unique<RangeAllocator<uint32_t>>(
+          getAllocatorName(i),
+          kKeyPrefix,
+          clients_.back().get(),
+          [this, i](std::optional<uint32_t> newVal) noexcept {
+            processAllocation(i, newVal);
+          },
+          std::chrono::milliseconds(10) /* min backoff */,
+          std::chrono::milliseconds(100) /* max backoff */));
+      allocators_.back()->startAllocator({0, rangeSize - 1}, std::nullopt);
+    }
+  }
+
+  ~RangeAllocatorBenchmarkFixture() {
+    evb_.getEvb()->runInEventBaseThreadAndWait([this]() {
+      allocators_.clear();
+      observer_->setKvCallback(nullptr);
+    });
+    kvStoreWrapper_->stop();
+    clients_.clear();
+    observer_.reset();
+    evb_.stop();
+    evb_.waitUntilStopped();
+    evbThread_.join();
+  }
+
+  // Run allocators until each of them holds a distinct value
+  void
+  run() {
+    evbThread_ = std::thread([this]() { evb_.run(); });
+    evb_.waitUntilRunning();
+    allocatedBaton_.wait();
+  }
+
+  // Number of key-values with allocation prefix published by KvStore
+  size_t
+  getNumKeyVals() const {
+    return numKeyVals_;
+  }
+
+  // Number of values claimed by allocators in excess of one per allocator
+  size_t
+  getNumCollisions() const {
+    return numAttempts_ > numAllocators_ ? numAttempts_ - numAllocators_ : 0;
+  }
+
+ private:
+  void
+  processAllocation(size_t id, std::optional<uint32_t> newVal) {
+    auto it = allocation_.find(id);
+    if (it != allocation_.end()) {
+      auto& owners = allocationOwners_[it->second];
+      owners.erase(id);
+      if (owners.empty()) {
+        allocationOwners_.erase(it->second);
+      }
+      allocation_.erase(it);
+    }
+    if (newVal.has_value()) {
+      allocation_.emplace(id, *newVal);
+      allocationOwners_[*newVal].emplace(id);
+    }
+
+    // Every allocator holds a value and no value has more than one owner
+    if (not isAllocated_ and allocation_.size() == numAllocators_ and
+        allocationOwners_.size() == numAllocators_) {
+      isAllocated_ = true;
+      allocatedBaton_.post();
+    }
+  }
+
+  const size_t numAllocators_{0};
+
+  fbzmq::Context context_;
+  std::shared_ptr<Config> config_;
+  std::unique_ptr<KvStoreWrapper> kvStoreWrapper_;
+
+  // All clients and allocators loop in same event-loop
+  OpenrEventBase evb_;
+  std::thread evbThread_;
+
+  std::unique_ptr<KvStoreClientInternal> observer_;
+  std::vector<std::unique_ptr<KvStoreClientInternal>> clients_;
+  std::vector<std::unique_ptr<RangeAllocator<uint32_t>>> allocators_;
+
+  // Allocated value of every allocator, and allocators of every value
+  std::unordered_map<size_t, uint32_t> allocation_;
+  std::unordered_map<uint32_t, std::unordered_set<size_t>> allocationOwners_;
+  bool isAllocated_{false};
+  folly::Baton<> allocatedBaton_;
+
+  size_t numKeyVals_{0};
+  size_t numAttempts_{0};
+};
+
+/**
+ * Measure time until numAllocators allocators starting together hold
+ * distinct values of range with numPrefilled values already taken, along with
+ * number of collisions and key-values published by KvStore meanwhile
+ */
+static void
+BM_RangeAllocator(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numAllocators,
+    uint32_t rangeSize,
+    uint32_t numPrefilled) {
+  for (uint32_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    RangeAllocatorBenchmarkFixture fixture(
+        numAllocators, rangeSize, numPrefilled);
+
+    suspender.dismiss();
+    const auto startTime = std::chrono::steady_clock::now();
+    fixture.run();
+    const auto elapsedMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime)
+            .count();
+    suspender.rehire();
+
+    counters["e2e_ms"] = elapsedMs;
+    counters["collisions"] = fixture.getNumCollisions();
+    counters["kvstore_key_vals"] = fixture.getNumKeyVals();
+  }
+}
+
+// The parameters are number of allocators, size of range and number of
+// pre-filled values in range
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RangeAllocator, counters, 100_1000_0, 100, 1000, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RangeAllocator, counters, 1000_10000_0, 1000, 10000, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RangeAllocator, counters, 1000_10000_5000, 1000, 10000, 5000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RangeAllocator, counters, 1000_10000_8900, 1000, 10000, 8900);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RangeAllocator, counters, 1000_1100_0, 1000, 1100, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RangeAllocator, counters, 5000_10000_0, 5000, 10000, 0);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -387,6 +387,60 @@ TEST_P(RangeAllocatorFixture, InsufficentRange) {
   }
 }
 
+/**
+ * Pre-populate all but one value of range with keys from a higher originator
+ * and make sure that allocator finds the only free value after a single
+ * collision.
+ */
+TEST_P(RangeAllocatorFixture, NearlyFullRange) {
+  const uint32_t start = 1;
+  const uint32_t end = 1000;
+  const uint32_t freeVal = 777;
+
+  std::vector<std::pair<std::string, thrift::Value>> keyVals;
+  for (uint32_t val = start; val <= end; ++val) {
+    if (val == freeVal) {
+      continue;
+    }
+    keyVals.emplace_back(
+        folly::sformat("value:{}", val),
+        createThriftValue(
+            1,
+            "zz-owner",
+            std::string(reinterpret_cast<const char*>(&val), sizeof(val)),
+            Constants::kRangeAllocTtl.count()));
+  }
+  ASSERT_TRUE(stores[0]->setKeys(keyVals));
+
+  folly::Baton waitBaton;
+  std::vector<uint32_t> allocatedVals;
+  auto allocator = std::make_unique<RangeAllocator<uint32_t>>(
+      createClientName(0),
+      "value:",
+      clients[0].get(),
+      [&](std::optional<uint32_t> newVal) noexcept {
+        ASSERT_TRUE(newVal.has_value());
+        allocatedVals.emplace_back(*newVal);
+        waitBaton.post();
+      },
+      10ms /* min backoff */,
+      100ms /* max backoff */,
+      overrideOwner /* override allowed */);
+  allocator->startAllocator({start, end}, start);
+
+  // Start the event loop and wait until it is finished execution.
+  evbThread = std::thread([&]() { evb.run(); });
+  evb.waitUntilRunning();
+
+  // Synchronization primitive
+  waitBaton.wait();
+
+  EXPECT_EQ(std::vector<uint32_t>{freeVal}, allocatedVals);
+  EXPECT_TRUE(allocator->isRangeConsumed());
+
+  allocator.reset();
+}
+
 } // namespace openr
 
 int
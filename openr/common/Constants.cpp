@@ -44,15 +44,35 @@ constexpr int32_t Constants::kSparkMcastPort;
 constexpr int32_t Constants::kSystemAgentPort;
 constexpr int64_t Constants::kDefaultAdjWeight;
 constexpr int64_t Constants::kTtlInfinity;
+constexpr size_t Constants::kKvStoreUpdatesQueueMaxSize;
 constexpr size_t Constants::kNumTimeSeries;
+constexpr size_t Constants::kDecisionPublicationsBatchSize;
+constexpr size_t Constants::kDecisionSnapshotThreads;
+constexpr size_t Constants::kFibRouteUpdatesBatchSize;
+constexpr size_t Constants::kFibRouteProgrammingChunkSize;
+constexpr int32_t Constants::kFibRouteProgrammingWindow;
+constexpr size_t Constants::kFibSnapshotChunkRoutes;
+constexpr std::chrono::milliseconds Constants::kEventLogFlushInterval;
+constexpr std::chrono::milliseconds Constants::kStatCounterFlushInterval;
+constexpr std::chrono::milliseconds Constants::kFibLatencyBucketWidth;
+constexpr std::chrono::milliseconds Constants::kFibLatencyMax;
+constexpr size_t Constants::kFibRoutesPerCallBucketWidth;
+constexpr size_t Constants::kFibRouteUpdatesQueueMaxSize;
 constexpr std::chrono::milliseconds Constants::kFloodPendingPublication;
+constexpr int32_t Constants::kFloodRateAdaptiveSteps;
 constexpr std::chrono::milliseconds Constants::kInitialBackoff;
 constexpr std::chrono::milliseconds Constants::kKeepAliveCheckInterval;
 constexpr std::chrono::milliseconds Constants::kKvStoreDbTtl;
 constexpr std::chrono::milliseconds Constants::kLinkImmediateTimeout;
 constexpr std::chrono::milliseconds Constants::kLinkThrottleTimeout;
+constexpr std::chrono::microseconds
+    Constants::kLinkProcessingLatencyBucketWidth;
+constexpr std::chrono::microseconds Constants::kLinkProcessingLatencyMax;
+constexpr std::chrono::milliseconds Constants::kLinkLatencyBucketWidth;
+constexpr std::chrono::milliseconds Constants::kLinkLatencyMax;
 constexpr std::chrono::milliseconds Constants::kMaxBackoff;
 constexpr std::chrono::milliseconds Constants::kMaxTtlUpdateInterval;
+constexpr std::chrono::milliseconds Constants::kTtlRefreshBucketWidth;
 constexpr std::chrono::milliseconds Constants::kPersistentStoreInitialBackoff;
 constexpr std::chrono::milliseconds Constants::kPersistentStoreMaxBackoff;
 constexpr std::chrono::milliseconds Constants::kPlatformConnTimeout;
@@ -66,10 +86,19 @@ constexpr std::chrono::milliseconds Constants::kRangeAllocTtl;
 constexpr std::chrono::milliseconds Constants::kReadTimeout;
 constexpr std::chrono::milliseconds Constants::kServiceConnTimeout;
 constexpr std::chrono::milliseconds Constants::kServiceProcTimeout;
+constexpr std::chrono::milliseconds Constants::kSlowEvbCallbackThreshold;
 constexpr std::chrono::milliseconds Constants::kTtlDecrement;
 constexpr std::chrono::milliseconds Constants::kTtlInfInterval;
 constexpr std::chrono::milliseconds Constants::kTtlThreshold;
 constexpr std::chrono::milliseconds Constants::kLongPollReqHoldTime;
+constexpr std::chrono::milliseconds Constants::kCtrlKvStoreCacheMaxAge;
+constexpr size_t Constants::kCtrlKvStoreCacheMaxEntries;
+constexpr size_t Constants::kCtrlMaxRunningDumps;
+constexpr size_t Constants::kCtrlMaxQueuedDumps;
+constexpr std::chrono::milliseconds Constants::kCtrlCounterSnapshotTtl;
+constexpr size_t Constants::kCtrlMaxCachedRegexes;
+constexpr uint32_t Constants::kCtrlCpuProfileSamplingHz;
+constexpr std::chrono::milliseconds Constants::kCtrlCpuProfileMaxDuration;
 constexpr std::chrono::seconds Constants::kConvergenceMaxDuration;
 constexpr std::chrono::seconds Constants::kKeepAliveIntvl;
 constexpr std::chrono::seconds Constants::kKeepAliveTime;
@@ -77,13 +106,36 @@ constexpr std::chrono::seconds Constants::kMemoryThresholdTime;
 constexpr std::chrono::seconds Constants::kMonitorSubmitInterval;
 constexpr std::chrono::seconds Constants::kNetlinkSyncThrottleInterval;
 constexpr std::chrono::seconds Constants::kPlatformSyncInterval;
+constexpr size_t Constants::kPlatformEventBatchMaxSize;
+constexpr size_t Constants::kEventLogMaxSamplesPerFlush;
 constexpr std::chrono::seconds Constants::kPlatformThriftIdleTimeout;
 constexpr std::chrono::seconds Constants::kStoreSyncInterval;
+constexpr std::chrono::seconds Constants::kKvStoreSnapshotInterval;
+constexpr size_t Constants::kKvStoreThriftFloodMaxInFlight;
+constexpr size_t Constants::kKvStoreThriftFloodMaxPending;
+constexpr size_t Constants::kKvStoreCompactFloodPathLen;
+constexpr std::chrono::milliseconds Constants::kKvStoreFloodDelayBucketWidth;
+constexpr std::chrono::milliseconds Constants::kKvStoreFloodDelayMax;
+constexpr std::chrono::milliseconds Constants::kKvStoreTtlExpiryBatchWindow;
 constexpr size_t Constants::kMaxFullSyncPendingCountThreshold;
+constexpr int32_t Constants::kKvStoreSyncKeyBuckets;
+constexpr size_t Constants::kKvStoreMergeChunkSize;
+constexpr size_t Constants::kKvStoreValueDeltaMinSize;
+constexpr size_t Constants::kKvStoreSyncCompressionMinSize;
+constexpr int32_t Constants::kKvStoreSyncChunkKeyVals;
+constexpr size_t Constants::kMaxTopologyChangeLogSize;
+constexpr size_t Constants::kMaxSpfCacheSize;
+constexpr std::chrono::milliseconds Constants::kDecisionLatencyBucketWidth;
+constexpr std::chrono::milliseconds Constants::kDecisionLatencyMax;
+constexpr std::chrono::milliseconds Constants::kDecisionWhatIfTimeBudget;
+constexpr std::chrono::milliseconds Constants::kDecisionWhatIfMaxTimeBudget;
+constexpr std::chrono::milliseconds Constants::kDecisionRouteEngineTimeout;
 constexpr std::pair<int32_t, int32_t> Constants::kSrGlobalRange;
 constexpr std::pair<int32_t, int32_t> Constants::kSrLocalRange;
 constexpr uint16_t Constants::kPerfBufferSize;
 constexpr uint32_t Constants::kMaxAllowedPps;
+constexpr std::chrono::microseconds Constants::kSparkLatencyBucketWidth;
+constexpr std::chrono::microseconds Constants::kSparkLatencyMax;
 constexpr uint64_t Constants::kOverloadNodeMetric;
 constexpr uint8_t Constants::kAqRouteProtoId;
 
@@ -73,6 +73,14 @@ class Constants {
   // event log category
   static constexpr folly::StringPiece kEventLogCategory{"perfpipe_aquaman"};
 
+  // Interval at which EventLogger submits buffered event logs, and max number
+  // of event logs it submits per interval. Event logs over limit are dropped
+  static constexpr std::chrono::milliseconds kEventLogFlushInterval{500};
+  static constexpr size_t kEventLogMaxSamplesPerFlush{1000};
+
+  // Interval at which values of StatCounters are flushed to fb303
+  static constexpr std::chrono::milliseconds kStatCounterFlushInterval{1000};
+
   // ExponentialBackoff durations
   static constexpr std::chrono::milliseconds kInitialBackoff{64};
   static constexpr std::chrono::milliseconds kMaxBackoff{8192};
@@ -82,6 +90,39 @@ class Constants {
       100};
   static constexpr std::chrono::milliseconds kPersistentStoreMaxBackoff{5000};
 
+  //
+  // Decision specific
+  //
+
+  // max number of link changes remembered by LinkState for incremental SPF.
+  // SPF results older than the log are recomputed from scratch
+  static constexpr size_t kMaxTopologyChangeLogSize{10000};
+
+  // number of SPF results cached by Decision after which the ones not needed
+  // for the current route computation are dropped
+  static constexpr size_t kMaxSpfCacheSize{128};
+
+  // bucket width and range of the latency histograms of the route computation
+  // stages. Larger latencies are accounted to the last bucket
+  static constexpr std::chrono::milliseconds kDecisionLatencyBucketWidth{10};
+  static constexpr std::chrono::milliseconds kDecisionLatencyMax{2000};
+
+  // Max number of pending KvStore publications applied in one wakeup
+  static constexpr size_t kDecisionPublicationsBatchSize{64};
+
+  // Default and max time budget of a what-if route computation
+  static constexpr std::chrono::milliseconds kDecisionWhatIfTimeBudget{5000};
+  static constexpr std::chrono::milliseconds kDecisionWhatIfMaxTimeBudget{
+      30000};
+
+  // Threads computing routes of copies of Decision databases, for what-if and
+  // batch route dumps
+  static constexpr size_t kDecisionSnapshotThreads{4};
+
+  // Default time to wait for routes of an external route computation engine
+  // before falling back to SpfSolver
+  static constexpr std::chrono::milliseconds kDecisionRouteEngineTimeout{1000};
+
   //
   // KvStore specific
 
@@ -92,6 +133,52 @@ class Constants {
   // kMaxBackoff to send the next sync request
   static constexpr size_t kMaxFullSyncPendingCountThreshold{32};
 
+  // Number of key buckets digests are exchanged for in kvstore full-sync.
+  // NOTE: must be same across all nodes of the network
+  static constexpr int32_t kKvStoreSyncKeyBuckets{4096};
+
+  // Number of received key-values merged by one task when kvstore merges
+  // large publications in parallel. Publications of at most this many keys
+  // are merged on kvstore event base alone
+  static constexpr size_t kKvStoreMergeChunkSize{1024};
+
+  // Minimum size of value which kvstore floods as delta against its previous
+  // version, if value delta encoding is enabled
+  static constexpr size_t kKvStoreValueDeltaMinSize{1024};
+
+  // Minimum size of serialized full-sync response which kvstore compresses,
+  // if requester accepts compression
+  static constexpr size_t kKvStoreSyncCompressionMinSize{4096};
+
+  // Max number of key-vals per message of full-sync response. Requester
+  // merges chunks as they arrive instead of one large response.
+  static constexpr int32_t kKvStoreSyncChunkKeyVals{1024};
+
+  // High-water mark of pending publications per local reader. Publications
+  // beyond it are coalesced into the latest pending one.
+  static constexpr size_t kKvStoreUpdatesQueueMaxSize{1024};
+
+  // Default interval at which kvstore is snapshot to disk, if enabled
+  static constexpr std::chrono::seconds kKvStoreSnapshotInterval{60};
+
+  // Max flood requests in flight to a peer over thrift. Further ones are
+  // queued, up to kKvStoreThriftFloodMaxPending
+  static constexpr size_t kKvStoreThriftFloodMaxInFlight{8};
+  static constexpr size_t kKvStoreThriftFloodMaxPending{1024};
+
+  // Number of last hops of flood path carried by publications, if compact
+  // flood path is enabled. Sender of publication is last of them
+  static constexpr size_t kKvStoreCompactFloodPathLen{4};
+
+  // Histograms of flood delays of traced publications, see
+  // KvstoreConfig.flood_tracing_sample_rate
+  static constexpr std::chrono::milliseconds kKvStoreFloodDelayBucketWidth{10};
+  static constexpr std::chrono::milliseconds kKvStoreFloodDelayMax{5000};
+
+  // Min interval between two key expiry passes of KvStore. Keys expiring
+  // within it, e.g. all keys of a node gone down, go out in one publication
+  static constexpr std::chrono::milliseconds kKvStoreTtlExpiryBatchWindow{50};
+
   //
   // PrefixAllocator specific
 
@@ -118,6 +205,15 @@ class Constants {
   static constexpr std::chrono::milliseconds kLinkThrottleTimeout{1000};
   static constexpr std::chrono::milliseconds kLinkImmediateTimeout{1};
 
+  // bucket width and range of the latency histograms of LinkMonitor, for
+  // processing stages and from neighbor event to adjacency db in KvStore.
+  // Larger latencies are accounted to the last bucket
+  static constexpr std::chrono::microseconds kLinkProcessingLatencyBucketWidth{
+      100};
+  static constexpr std::chrono::microseconds kLinkProcessingLatencyMax{50000};
+  static constexpr std::chrono::milliseconds kLinkLatencyBucketWidth{10};
+  static constexpr std::chrono::milliseconds kLinkLatencyMax{5000};
+
   // overloaded note metric value
   static constexpr uint64_t kOverloadNodeMetric{1ull << 32};
 
@@ -136,6 +232,11 @@ class Constants {
   // fixed size list of BucketedTimeSeries
   static constexpr uint32_t kMaxAllowedPps{50};
 
+  // bucket width and range of the latency histograms of Spark packets, from
+  // arrival to processed and to neighbor state transition
+  static constexpr std::chrono::microseconds kSparkLatencyBucketWidth{100};
+  static constexpr std::chrono::microseconds kSparkLatencyMax{50000};
+
   // Number of BucketedTimeSeries to spread potential neighbors across
   // for the purpose of limiting the number of packets per second processed
   static constexpr size_t kNumTimeSeries{1024};
@@ -155,9 +256,35 @@ class Constants {
   // time interval to sync between Open/R and Platform
   static constexpr std::chrono::seconds kPlatformSyncInterval{60};
 
+  // Max number of platform events published in one PlatformEventBatch
+  static constexpr size_t kPlatformEventBatchMaxSize{512};
+
   // time interval for keep alive check between fib and switch agent
   static constexpr std::chrono::milliseconds kKeepAliveCheckInterval{1000};
 
+  // Max number of pending route updates coalesced into one programming call
+  static constexpr size_t kFibRouteUpdatesBatchSize{64};
+
+  // Max number of routes per programming call from Fib to agent, and default
+  // number of such calls in flight
+  static constexpr size_t kFibRouteProgrammingChunkSize{1000};
+  static constexpr int32_t kFibRouteProgrammingWindow{4};
+
+  // Default max number of routes per chunk of route snapshot streamed to
+  // subscribers of Fib
+  static constexpr size_t kFibSnapshotChunkRoutes{1000};
+
+  // bucket width and range of the Fib histograms of route programming latency
+  // and of routes per programming call. Larger values are accounted to the
+  // last bucket
+  static constexpr std::chrono::milliseconds kFibLatencyBucketWidth{10};
+  static constexpr std::chrono::milliseconds kFibLatencyMax{5000};
+  static constexpr size_t kFibRoutesPerCallBucketWidth{50};
+
+  // High-water mark of pending route updates. Route updates beyond it are
+  // coalesced into the latest pending one.
+  static constexpr size_t kFibRouteUpdatesQueueMaxSize{256};
+
   // Timeout duration for which if a client connection has no activity, then it
   // will be dropped. We keep it 3 * kPlatformSyncInterval so that thrift
   // connection between OpenR and platform service remains up forever under
@@ -181,6 +308,10 @@ class Constants {
   // Kvstore timer for flooding pending publication
   static constexpr std::chrono::milliseconds kFloodPendingPublication{100};
 
+  // Adaptive kvstore flood rate moves between configured rate and its
+  // 1/kFloodRateAdaptiveSteps, in steps of the latter
+  static constexpr int32_t kFloodRateAdaptiveSteps{16};
+
   // KvStore database TTLs
   static constexpr std::chrono::milliseconds kKvStoreDbTtl{5min};
 
@@ -212,6 +343,10 @@ class Constants {
 
   // max interval to update TTL for each key in kvstore w/ finite TTL
   static constexpr std::chrono::milliseconds kMaxTtlUpdateInterval{2h};
+
+  // width of time buckets TTL refreshes of keys with finite TTL are aligned
+  // to, so that refreshes due within a bucket are advertised together
+  static constexpr std::chrono::milliseconds kTtlRefreshBucketWidth{100};
   // TTL infinity, never expires
   // int version
   static constexpr int64_t kTtlInfinity{INT32_MIN};
@@ -232,6 +367,27 @@ class Constants {
   // hold time for longPoll requests in openrCtrl thrift server
   static constexpr std::chrono::milliseconds kLongPollReqHoldTime{20000};
 
+  // max age of cached KvStore responses of openrCtrl thrift server, as TTL
+  // refreshes don't invalidate them. Also bound on number of cached ones
+  static constexpr std::chrono::milliseconds kCtrlKvStoreCacheMaxAge{10000};
+  static constexpr size_t kCtrlKvStoreCacheMaxEntries{64};
+
+  // max number of running and queued dumps of every heavy read API of
+  // openrCtrl thrift server, so that burst of them doesn't stall modules
+  static constexpr size_t kCtrlMaxRunningDumps{2};
+  static constexpr size_t kCtrlMaxQueuedDumps{128};
+
+  // counters snapshot of openrCtrl thrift server is shared by scrapes within
+  // this duration. Also bound on number of regexes whose matches are kept
+  static constexpr std::chrono::milliseconds kCtrlCounterSnapshotTtl{1000};
+  static constexpr size_t kCtrlMaxCachedRegexes{32};
+
+  // CPU profiles served by openrCtrl thrift server sample at this frequency,
+  // off beat of periodic timers, and last up to max duration
+  static constexpr uint32_t kCtrlCpuProfileSamplingHz{99};
+  static constexpr std::chrono::milliseconds kCtrlCpuProfileMaxDuration{
+      60000};
+
   //
   // Prefix manager specific
   //
@@ -274,6 +430,9 @@ class Constants {
   // Threshold time in secs to crash after reaching critical memory
   static constexpr std::chrono::seconds kMemoryThresholdTime{600};
 
+  // Duration of event-base callback above which it is logged as slow
+  static constexpr std::chrono::milliseconds kSlowEvbCallbackThreshold{500};
+
   static const std::list<std::string>&
   getNextProtocolsForThriftServers() {
     static const std::list<std::string> result{
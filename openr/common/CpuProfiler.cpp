@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "CpuProfiler.h"
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <folly/Demangle.h>
+#include <folly/FileUtil.h>
+#include <folly/Format.h>
+#include <folly/String.h>
+#include <glog/logging.h>
+
+namespace openr {
+
+namespace {
+
+// Deepest frames kept of sampled stacks, and bound on samples of a profile
+constexpr int kMaxDepth{48};
+constexpr size_t kMaxSamples{1 << 15};
+
+// Frames of signal handler and of signal trampoline atop sampled stacks
+constexpr int kSkippedFrames{2};
+
+struct Sample {
+  pid_t tid{0};
+  int depth{0};
+  void* frames[kMaxDepth];
+};
+
+// State shared with signal handler, which may only touch lock-free atomics
+std::atomic<Sample*> gSamples{nullptr};
+std::atomic<size_t> gNumSamples{0};
+std::atomic<size_t> gNumInFlight{0};
+
+// Serializes profiles, and installation of signal handler
+std::mutex gProfileMutex;
+bool gHandlerInstalled{false};
+
+void
+handleSigprof(int /* signum */, siginfo_t* /* info */, void* /* context */) {
+  const int savedErrno = errno;
+  // Announce handler before looking at buffer, so that profile can't release
+  // buffer under us
+  ++gNumInFlight;
+  auto samples = gSamples.load();
+  if (samples) {
+    const auto idx = gNumSamples++;
+    if (idx < kMaxSamples) {
+      void* frames[kMaxDepth + kSkippedFrames];
+      const int depth = backtrace(frames, kMaxDepth + kSkippedFrames);
+      auto& sample = samples[idx];
+      sample.tid = static_cast<pid_t>(syscall(SYS_gettid));
+      sample.depth = std::max(0, depth - kSkippedFrames);
+      std::memcpy(
+          sample.frames, frames + kSkippedFrames, sample.depth * sizeof(void*));
+    }
+  }
+  --gNumInFlight;
+  errno = savedErrno;
+}
+
+// Set profiling timer of process, zero interval disarms it
+void
+setProfilingTimer(std::chrono::microseconds interval) {
+  struct itimerval timer;
+  timer.it_interval.tv_sec = interval.count() / 1000000;
+  timer.it_interval.tv_usec = interval.count() % 1000000;
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    throw std::runtime_error(folly::sformat(
+        "Failed to set profiling timer: {}", folly::errnoStr(errno)));
+  }
+}
+
+std::string
+getThreadName(pid_t tid) {
+  std::string name;
+  if (folly::readFile(
+          folly::sformat("/proc/self/task/{}/comm", tid).c_str(), name)) {
+    name = folly::rtrimWhitespace(name).str();
+  }
+  return name.empty() ? folly::sformat("thread-{}", tid) : name;
+}
+
+// Name of function of frame, or of its module with offset when symbol isn't
+// exported. Return addresses point after call, so that look up is done just
+// before them
+std::string
+getFrameName(void* frame, bool isReturnAddress) {
+  auto addr = static_cast<char*>(frame) - (isReturnAddress ? 1 : 0);
+  Dl_info info;
+  if (dladdr(addr, &info) == 0) {
+    return folly::sformat("{}", static_cast<void*>(addr));
+  }
+  if (info.dli_sname) {
+    return folly::demangle(info.dli_sname).toStdString();
+  }
+  if (info.dli_fname) {
+    const char* slash = std::strrchr(info.dli_fname, '/');
+    return folly::sformat(
+        "{}+{:#x}",
+        slash ? slash + 1 : info.dli_fname,
+        addr - static_cast<char*>(info.dli_fbase));
+  }
+  return folly::sformat("{}", static_cast<void*>(addr));
+}
+
+} // namespace
+
+CpuProfiler::Profile
+CpuProfiler::profile(
+    std::chrono::milliseconds duration,
+    uint32_t samplingHz,
+    std::string const& threadNamePrefix) {
+  std::unique_lock<std::mutex> lock(gProfileMutex, std::try_to_lock);
+  if (not lock.owns_lock()) {
+    throw std::runtime_error("CPU profile is already running");
+  }
+  if (samplingHz == 0 or samplingHz > 1000000) {
+    throw std::runtime_error(
+        folly::sformat("Invalid sampling frequency {}Hz", samplingHz));
+  }
+
+  // Handler stays installed once profiled, inert between profiles, so that
+  // signals still pending at end of profile don't kill process
+  if (not gHandlerInstalled) {
+    // First call to backtrace may allocate, it must not happen in handler
+    void* frame{nullptr};
+    backtrace(&frame, 1);
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = handleSigprof;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+      throw std::runtime_error(folly::sformat(
+          "Failed to install SIGPROF handler: {}", folly::errnoStr(errno)));
+    }
+    gHandlerInstalled = true;
+  }
+
+  std::vector<Sample> samples(kMaxSamples);
+  gNumSamples = 0;
+  gSamples = samples.data();
+  try {
+    setProfilingTimer(std::chrono::microseconds(1000000 / samplingHz));
+  } catch (std::exception const&) {
+    gSamples = nullptr;
+    throw;
+  }
+
+  std::this_thread::sleep_for(duration);
+
+  setProfilingTimer(std::chrono::microseconds(0));
+  gSamples = nullptr;
+  while (gNumInFlight.load()) {
+    std::this_thread::yield();
+  }
+
+  Profile profile;
+  const size_t numSamples = std::min(gNumSamples.load(), kMaxSamples);
+  profile.numDroppedSamples = gNumSamples.load() - numSamples;
+
+  // Fold stacks, caching names of threads and frames as they repeat a lot
+  std::unordered_map<pid_t, std::string> threadNames;
+  std::unordered_map<void*, std::string> frameNames;
+  for (size_t i = 0; i < numSamples; ++i) {
+    auto const& sample = samples[i];
+    auto threadIt = threadNames.find(sample.tid);
+    if (threadIt == threadNames.end()) {
+      threadIt =
+          threadNames.emplace(sample.tid, getThreadName(sample.tid)).first;
+    }
+    if (threadIt->second.compare(
+            0, threadNamePrefix.size(), threadNamePrefix) != 0) {
+      continue;
+    }
+
+    std::string stack = threadIt->second;
+    for (int depth = sample.depth - 1; depth >= 0; --depth) {
+      auto frame = sample.frames[depth];
+      auto frameIt = frameNames.find(frame);
+      if (frameIt == frameNames.end()) {
+        // every frame but the interrupted one is a return address
+        frameIt =
+            frameNames.emplace(frame, getFrameName(frame, depth > 0)).first;
+      }
+      stack.append(";").append(frameIt->second);
+    }
+    ++profile.foldedStacks[stack];
+    ++profile.numSamples;
+  }
+
+  LOG(INFO) << "CPU profile of " << duration.count() << "ms took "
+            << profile.numSamples << " samples, dropped "
+            << profile.numDroppedSamples;
+  return profile;
+}
+
+} // namespace openr
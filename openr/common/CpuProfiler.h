@@ -0,0 +1,48 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+
+namespace openr {
+
+/**
+ * Sampling CPU profiler of the whole process. SIGPROF is delivered to threads
+ * consuming CPU at the given frequency, and their stacks are recorded from the
+ * signal handler. Samples are tagged by name of the thread they were taken
+ * on, as set by folly::setThreadName.
+ *
+ * Only one profile can be running at a time in the process. SIGPROF handler
+ * and profiling timer of process are borrowed for duration of profile.
+ */
+class CpuProfiler {
+ public:
+  struct Profile {
+    // folded stacks as "<thread>;<outermost frame>;...;<innermost frame>",
+    // to number of samples taken in them
+    std::map<std::string, int64_t> foldedStacks;
+    int64_t numSamples{0};
+    // samples lost as sample buffer is full
+    int64_t numDroppedSamples{0};
+  };
+
+  /**
+   * Profile process for duration, blocking calling thread meanwhile. Keeps
+   * only samples of threads whose name starts with threadNamePrefix, every
+   * thread if it is empty. Throws std::runtime_error if a profile is already
+   * running or profiling can't be started.
+   */
+  static Profile profile(
+      std::chrono::milliseconds duration,
+      uint32_t samplingHz,
+      std::string const& threadNamePrefix = "");
+};
+
+} // namespace openr
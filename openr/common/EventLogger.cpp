@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "EventLogger.h"
+
+#include <memory>
+
+#include <fb303/ServiceData.h>
+#include <folly/system/ThreadName.h>
+#include <glog/logging.h>
+
+namespace fb303 = facebook::fb303;
+
+namespace openr {
+
+EventLogger::EventLogger(
+    fbzmq::Context& zmqContext,
+    const MonitorSubmitUrl& monitorSubmitUrl,
+    std::chrono::milliseconds flushInterval,
+    size_t maxSamplesPerFlush)
+    : EventLogger(
+          [client = std::make_shared<fbzmq::ZmqMonitorClient>(
+               zmqContext, monitorSubmitUrl)](
+              fbzmq::thrift::EventLog eventLog) {
+            client->addEventLog(std::move(eventLog));
+          },
+          flushInterval,
+          maxSamplesPerFlush) {}
+
+EventLogger::EventLogger(
+    SubmitCallback submitCb,
+    std::chrono::milliseconds flushInterval,
+    size_t maxSamplesPerFlush)
+    : flushInterval_(flushInterval),
+      maxSamplesPerFlush_(maxSamplesPerFlush),
+      submitCb_(std::move(submitCb)) {
+  CHECK(submitCb_);
+  CHECK_GT(maxSamplesPerFlush_, 0);
+  fb303::fbData->addStatExportType(
+      "event_logger.dropped_samples", fb303::SUM);
+  thread_ = std::thread([this]() {
+    folly::setThreadName("EventLogger");
+    run();
+  });
+}
+
+EventLogger::~EventLogger() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+void
+EventLogger::log(fbzmq::LogSample sample) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pendingSamples_.size() >= maxSamplesPerFlush_) {
+    ++numDroppedSamples_;
+    return;
+  }
+  pendingSamples_.emplace_back(std::move(sample));
+}
+
+size_t
+EventLogger::getNumDroppedSamples() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return numDroppedSamples_;
+}
+
+void
+EventLogger::run() {
+  size_t numReportedDrops{0};
+  bool stopped{false};
+  while (not stopped) {
+    std::vector<fbzmq::LogSample> samples;
+    size_t numDrops{0};
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait_for(lock, flushInterval_, [this]() { return stopped_; });
+      stopped = stopped_;
+      samples.swap(pendingSamples_);
+      numDrops = numDroppedSamples_ - numReportedDrops;
+      numReportedDrops = numDroppedSamples_;
+    }
+
+    if (numDrops) {
+      LOG(WARNING) << "Dropped " << numDrops << " event logs over limit of "
+                   << maxSamplesPerFlush_ << " per " << flushInterval_.count()
+                   << "ms";
+      fb303::fbData->addStatValue(
+          "event_logger.dropped_samples", numDrops, fb303::SUM);
+    }
+    if (not samples.empty()) {
+      submit(std::move(samples));
+    }
+  }
+}
+
+void
+EventLogger::submit(std::vector<fbzmq::LogSample> samples) {
+  std::vector<std::string> jsonSamples;
+  jsonSamples.reserve(samples.size());
+  for (auto const& sample : samples) {
+    jsonSamples.emplace_back(sample.toJson());
+  }
+  submitCb_(fbzmq::thrift::EventLog(
+      apache::thrift::FRAGILE,
+      Constants::kEventLogCategory.toString(),
+      std::move(jsonSamples)));
+}
+
+} // namespace openr
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fbzmq/service/logging/LogSample.h>
+#include <fbzmq/service/monitor/ZmqMonitorClient.h>
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/Function.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/Types.h>
+
+namespace openr {
+
+/**
+ * Buffers event log samples of a module and submits them in batches, one
+ * EventLog per flush interval, from a thread of its own. Module threads only
+ * hand samples over, while JSON serialization and submission to monitor
+ * happen on logger thread. At most maxSamplesPerFlush samples are submitted
+ * per interval, and samples logged over that are dropped and counted.
+ *
+ * log() is thread safe. Pending samples are submitted on destruction.
+ */
+class EventLogger {
+ public:
+  using SubmitCallback = folly::Function<void(fbzmq::thrift::EventLog)>;
+
+  EventLogger(
+      fbzmq::Context& zmqContext,
+      const MonitorSubmitUrl& monitorSubmitUrl,
+      std::chrono::milliseconds flushInterval =
+          Constants::kEventLogFlushInterval,
+      size_t maxSamplesPerFlush = Constants::kEventLogMaxSamplesPerFlush);
+
+  EventLogger(
+      SubmitCallback submitCb,
+      std::chrono::milliseconds flushInterval =
+          Constants::kEventLogFlushInterval,
+      size_t maxSamplesPerFlush = Constants::kEventLogMaxSamplesPerFlush);
+
+  ~EventLogger();
+
+  EventLogger(EventLogger const&) = delete;
+  EventLogger& operator=(EventLogger const&) = delete;
+
+  /**
+   * Queue sample for submission with next batch
+   */
+  void log(fbzmq::LogSample sample);
+
+  /**
+   * Number of samples dropped as they were over rate limit
+   */
+  size_t getNumDroppedSamples() const;
+
+ private:
+  // Loop of logger thread, submitting pending samples every flush interval
+  void run();
+
+  // Serialize samples to JSON and submit them as one EventLog
+  void submit(std::vector<fbzmq::LogSample> samples);
+
+  const std::chrono::milliseconds flushInterval_{0};
+  const size_t maxSamplesPerFlush_{0};
+
+  // Called on logger thread only
+  SubmitCallback submitCb_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<fbzmq::LogSample> pendingSamples_;
+  size_t numDroppedSamples_{0};
+  bool stopped_{false};
+
+  std::thread thread_;
+};
+
+} // namespace openr
@@ -81,6 +81,25 @@ DEFINE_bool(enable_prefix_alloc, false, "Enable automatic prefix allocation");
 DEFINE_int32(alloc_prefix_len, 128, "Allocated prefix length");
 DEFINE_bool(static_prefix_alloc, false, "Perform static prefix allocation");
 DEFINE_bool(per_prefix_keys, false, "Create per IP prefix keys in Kvstore");
+DEFINE_int32(
+    prefix_manager_persist_debounce_ms,
+    100,
+    "Persist prefixes to disk once they haven't changed for this time (in "
+    "milliseconds). 0 persists on every change.");
+DEFINE_int32(
+    prefix_manager_persist_max_delay_ms,
+    1000,
+    "Maximum delay of persisting changed prefixes to disk (in milliseconds)");
+DEFINE_string(
+    prefix_aggregates,
+    "",
+    "Comma separated list of aggregates in IP/CIDR format. Advertised "
+    "prefixes covered by an aggregate are replaced by a summary of it.");
+DEFINE_bool(
+    per_adjacency_keys,
+    false,
+    "Create per adjacency keys in KvStore. Enable only after every node of "
+    "the network can receive them.");
 DEFINE_bool(
     set_loopback_address,
     false,
@@ -198,6 +217,22 @@ DEFINE_bool(
     enable_netlink_system_handler,
     true,
     "If set, netlink system handler will be started");
+DEFINE_bool(
+    enable_in_process_platform_clients,
+    true,
+    "If set, Fib, LinkMonitor and PrefixAllocator call netlink fib and "
+    "system handlers started by this process directly, instead of over "
+    "thrift on loopback. Their thrift servers still serve other clients.");
+DEFINE_int32(
+    netlink_route_sockets,
+    1,
+    "Number of netlink sockets, each with a thread of its own, to spread "
+    "route programming over. Routes are sharded by destination.");
+DEFINE_int32(
+    netlink_link_event_coalesce_ms,
+    50,
+    "Link events of an interface within this window are coalesced to the "
+    "latest state before published to LinkMonitor. 0 disables coalescing.");
 DEFINE_int32(
     ip_tos,
     openr::Constants::kIpTos,
@@ -215,6 +250,21 @@ DEFINE_int32(
     link_flap_max_backoff_ms,
     60000,
     "Max backoff to dampen link flaps (in millseconds)");
+DEFINE_int32(
+    link_monitor_neighbor_down_coalesce_ms,
+    0,
+    "Window over which neighbor down events are coalesced into one adjacency "
+    "advertisement per area (in milliseconds). 0 advertises on every event.");
+DEFINE_int32(
+    link_monitor_rtt_metric_bucket_size,
+    1,
+    "RTT based metrics are rounded to a multiple of this value, so that "
+    "small RTT variations don't change metric of adjacencies");
+DEFINE_int32(
+    link_monitor_rtt_metric_hold_ms,
+    0,
+    "Minimum time between two RTT based metric changes of an adjacency (in "
+    "milliseconds). Changes within this time are applied once it expires.");
 DEFINE_bool(
     enable_perf_measurement,
     true,
@@ -229,6 +279,53 @@ DEFINE_int32(
     250,
     "Decision debounce time to update spf in frequent adj db update "
     "(in milliseconds)");
+DEFINE_int32(
+    decision_lfa_spf_threads,
+    0,
+    "Number of threads used to compute SPF from neighbors for LFA. Computed "
+    "on decision thread if 0");
+DEFINE_int32(
+    decision_area_threads,
+    0,
+    "Number of threads used to compute routes of areas in parallel. Computed "
+    "on decision thread if 0");
+DEFINE_int32(
+    decision_max_prefixes_per_node,
+    0,
+    "Max number of prefixes Decision takes from a single node. Unlimited if "
+    "0");
+DEFINE_bool(
+    decision_prefix_limit_ignore_all,
+    false,
+    "Take no prefix of a node over decision_max_prefixes_per_node, instead "
+    "of prefixes up to limit");
+DEFINE_int32(
+    fib_route_programming_window,
+    0,
+    "Number of route programming calls Fib keeps in flight to platform agent. "
+    "Default is used if 0");
+DEFINE_bool(
+    enable_fib_route_priority,
+    false,
+    "Program host routes ahead of other routes, and deletes after adds");
+DEFINE_bool(
+    enable_fib_chunked_sync,
+    false,
+    "Send full sync of unicast routes to platform agent in pipelined chunks");
+DEFINE_bool(
+    enable_fib_warm_sync,
+    false,
+    "Sync routes with platform agent by programming difference to its "
+    "current routes, instead of replacing its route table");
+DEFINE_bool(
+    enable_decision_background_computation,
+    false,
+    "Compute routes of pending updates off decision thread");
+DEFINE_int32(
+    fib_perf_event_sample_rate,
+    0,
+    "Fib logs one in every N perf event chains of programmed routes. Every "
+    "chain is logged if 0");
 DEFINE_bool(
     enable_watchdog,
     true,
@@ -236,6 +333,16 @@ DEFINE_bool(
     "openr thread, if unhealthy thread is detected, force crash openr");
 DEFINE_int32(watchdog_interval_s, 20, "Watchdog thread healthcheck interval");
 DEFINE_int32(watchdog_threshold_s, 300, "Watchdog thread aliveness threshold");
+DEFINE_string(
+    thread_cpu_affinity,
+    "",
+    "CPUs of module threads to pin them to, as <thread>=<cpu>[,<cpu>...] "
+    "separated by semicolon. e.g. Spark=2,3;Fib=4");
+DEFINE_string(
+    thread_nice,
+    "",
+    "Nice values of module threads, as <thread>=<nice> separated by "
+    "semicolon. e.g. Spark=-10;Fib=-5");
 DEFINE_bool(
     enable_segment_routing, false, "Flag to disable/enable segment routing");
 DEFINE_bool(set_leaf_node, false, "Flag to enable/disable node as a leaf node");
@@ -262,6 +369,17 @@ DEFINE_int32(
     kvstore_flood_msg_burst_size,
     0,
     "Burst size of Kvstore flooding in number of messages");
+DEFINE_bool(
+    kvstore_flood_rate_adaptive,
+    false,
+    "Adapt Kvstore flooding rate to failures of flooding to peers, up to "
+    "configured rate, and flood every priority class of pending keys with "
+    "a token of its own");
+DEFINE_string(
+    kvstore_key_priority_prefixes,
+    "",
+    "Comma separated key prefixes of kvstore priority classes, highest "
+    "priority first. Adjacency keys followed by prefix keys if empty");
 DEFINE_int32(
     kvstore_key_ttl_ms,
     openr::Constants::kKvStoreDbTtl.count(), // 5 min
@@ -274,6 +392,21 @@ DEFINE_int32(
     kvstore_ttl_decrement_ms,
     openr::Constants::kTtlDecrement.count(),
     "Amount of time to decrement TTL when flooding updates");
+DEFINE_int32(
+    kvstore_merge_threads,
+    0,
+    "Number of threads used to merge large publications in parallel. Merged "
+    "on kvstore thread if 0");
+DEFINE_bool(
+    kvstore_enable_ttl_update_batching,
+    false,
+    "Flood TTL refreshes batched per originator. Enable only once all nodes "
+    "of the network understand batched TTL updates");
+DEFINE_bool(
+    kvstore_enable_value_delta_encoding,
+    false,
+    "Flood updates of large values as delta against their previous version. "
+    "Enable only once all nodes of the network understand value deltas");
 DEFINE_bool(
     enable_secure_thrift_server,
     false,
@@ -312,6 +445,38 @@ DEFINE_string(
     "will accept connections from any authenticated peer.");
 DEFINE_bool(enable_flood_optimization, false, "Enable flooding optimization");
 DEFINE_bool(is_flood_root, false, "set myself as flooding root or not");
+DEFINE_bool(
+    enable_flood_root_load_balancing,
+    false,
+    "Spread originated keys over spanning trees of all flooding roots by key "
+    "hash");
+DEFINE_string(
+    kvstore_snapshot_filepath,
+    "",
+    "File to periodically snapshot KvStore to, and reload it from on restart. "
+    "One file per area, suffixed with area name. Disabled if empty");
+DEFINE_int32(
+    kvstore_snapshot_interval_s,
+    60,
+    "Interval in seconds at which KvStore is snapshot to disk");
+DEFINE_bool(
+    kvstore_enable_thrift_flooding,
+    false,
+    "Flood KvStore updates over thrift to peers advertising their OpenrCtrl "
+    "port, instead of ZMQ");
+DEFINE_bool(
+    kvstore_enable_compact_flood_path,
+    false,
+    "Flood only the last hops of the flood path of KvStore publications");
+DEFINE_bool(
+    kvstore_enable_flood_tracing,
+    false,
+    "Stamp flood time on every hop of KvStore publications, for tracing "
+    "convergence across nodes");
+DEFINE_int32(
+    kvstore_flood_tracing_sample_rate,
+    1,
+    "With flood tracing, trace one in this many KvStore publications only");
 // TODO this option will be deprecated in near future, this is just for safely
 // rollout purpose
 DEFINE_bool(
@@ -323,6 +488,39 @@ DEFINE_bool(
     spark2_increase_hello_interval,
     false,
     "Increase Spark2 hello msg interval");
+DEFINE_bool(
+    spark2_compact_heartbeat,
+    false,
+    "Send Spark2 heartbeat msg in compact format. Enable only after every "
+    "node of the network can receive it.");
+DEFINE_bool(
+    spark2_compact_hello,
+    false,
+    "Send Spark2 hello msg in compact format. Enable only after every "
+    "node of the network can receive it.");
+DEFINE_bool(
+    spark2_enable_adaptive_heartbeat,
+    false,
+    "Send Spark2 heartbeat msg faster, with shorter hold time, on interfaces "
+    "with RTT change or late heartbeats");
+DEFINE_int32(
+    spark2_adaptive_heartbeat_time_ms,
+    100,
+    "Adaptive heartbeat msg interval (in milliseconds)");
+DEFINE_int32(
+    spark2_adaptive_heartbeat_hold_time_ms,
+    500,
+    "Adaptive heartbeat hold time (in milliseconds)");
+DEFINE_bool(
+    spark2_enable_io_thread,
+    false,
+    "Receive Spark2 packets on dedicated I/O thread, separate from neighbor "
+    "state machine");
+DEFINE_bool(
+    spark2_enable_hw_timestamping,
+    false,
+    "Use NIC hardware receive timestamps for Spark2 RTT measurement. NIC "
+    "clock must be synced to system clock.");
 DEFINE_bool(
     prefix_fwd_type_mpls,
     false,
@@ -39,6 +39,10 @@ DECLARE_bool(enable_prefix_alloc);
 DECLARE_int32(alloc_prefix_len);
 DECLARE_bool(static_prefix_alloc);
 DECLARE_bool(per_prefix_keys);
+DECLARE_int32(prefix_manager_persist_debounce_ms);
+DECLARE_int32(prefix_manager_persist_max_delay_ms);
+DECLARE_string(prefix_aggregates);
+DECLARE_bool(per_adjacency_keys);
 
 DECLARE_bool(set_loopback_address);
 DECLARE_bool(override_loopback_addr);
@@ -69,21 +73,39 @@ DECLARE_string(spark_cmd_url);
 
 DECLARE_bool(enable_netlink_fib_handler);
 DECLARE_bool(enable_netlink_system_handler);
+DECLARE_bool(enable_in_process_platform_clients);
+DECLARE_int32(netlink_route_sockets);
+DECLARE_int32(netlink_link_event_coalesce_ms);
 
 DECLARE_int32(ip_tos);
 DECLARE_int32(zmq_context_threads);
 
 DECLARE_int32(link_flap_initial_backoff_ms);
 DECLARE_int32(link_flap_max_backoff_ms);
+DECLARE_int32(link_monitor_neighbor_down_coalesce_ms);
+DECLARE_int32(link_monitor_rtt_metric_bucket_size);
+DECLARE_int32(link_monitor_rtt_metric_hold_ms);
 
 DECLARE_bool(enable_perf_measurement);
 
 DECLARE_int32(decision_debounce_min_ms);
 DECLARE_int32(decision_debounce_max_ms);
+DECLARE_int32(decision_lfa_spf_threads);
+DECLARE_int32(decision_area_threads);
+DECLARE_int32(decision_max_prefixes_per_node);
+DECLARE_bool(decision_prefix_limit_ignore_all);
+DECLARE_int32(fib_route_programming_window);
+DECLARE_bool(enable_fib_route_priority);
+DECLARE_bool(enable_fib_chunked_sync);
+DECLARE_bool(enable_fib_warm_sync);
+DECLARE_bool(enable_decision_background_computation);
+DECLARE_int32(fib_perf_event_sample_rate);
 
 DECLARE_bool(enable_watchdog);
 DECLARE_int32(watchdog_interval_s);
 DECLARE_int32(watchdog_threshold_s);
+DECLARE_string(thread_cpu_affinity);
+DECLARE_string(thread_nice);
 
 DECLARE_bool(enable_segment_routing);
 DECLARE_bool(set_leaf_node);
@@ -96,9 +118,14 @@ DECLARE_int32(memory_limit_mb);
 DECLARE_int32(kvstore_zmq_hwm);
 DECLARE_int32(kvstore_flood_msg_per_sec);
 DECLARE_int32(kvstore_flood_msg_burst_size);
+DECLARE_bool(kvstore_flood_rate_adaptive);
+DECLARE_string(kvstore_key_priority_prefixes);
 DECLARE_int32(kvstore_key_ttl_ms);
 DECLARE_int32(kvstore_sync_interval_s);
 DECLARE_int32(kvstore_ttl_decrement_ms);
+DECLARE_int32(kvstore_merge_threads);
+DECLARE_bool(kvstore_enable_ttl_update_batching);
+DECLARE_bool(kvstore_enable_value_delta_encoding);
 
 DECLARE_bool(enable_secure_thrift_server);
 DECLARE_string(x509_cert_path);
@@ -110,10 +137,24 @@ DECLARE_string(tls_acceptable_peers);
 
 DECLARE_bool(enable_flood_optimization);
 DECLARE_bool(is_flood_root);
+DECLARE_bool(enable_flood_root_load_balancing);
+DECLARE_string(kvstore_snapshot_filepath);
+DECLARE_int32(kvstore_snapshot_interval_s);
+DECLARE_bool(kvstore_enable_thrift_flooding);
+DECLARE_bool(kvstore_enable_compact_flood_path);
+DECLARE_bool(kvstore_enable_flood_tracing);
+DECLARE_int32(kvstore_flood_tracing_sample_rate);
 DECLARE_bool(use_flood_optimization);
 
 DECLARE_bool(enable_spark2);
 DECLARE_bool(spark2_increase_hello_interval);
+DECLARE_bool(spark2_compact_heartbeat);
+DECLARE_bool(spark2_compact_hello);
+DECLARE_bool(spark2_enable_adaptive_heartbeat);
+DECLARE_int32(spark2_adaptive_heartbeat_time_ms);
+DECLARE_int32(spark2_adaptive_heartbeat_hold_time_ms);
+DECLARE_bool(spark2_enable_io_thread);
+DECLARE_bool(spark2_enable_hw_timestamping);
 DECLARE_int32(spark2_hello_time_s);
 DECLARE_int32(spark2_hello_fastinit_time_ms);
 DECLARE_int32(spark2_heartbeat_time_s);
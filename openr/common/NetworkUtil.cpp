@@ -7,6 +7,30 @@
 
 #include "openr/common/NetworkUtil.h"
 
+#include <cstring>
+
+#include <folly/hash/Hash.h>
+
+namespace {
+
+// Hash address bytes as a fixed size 16 byte value (two 64 bit words), which
+// for v4 and v6 addresses is cheaper than hashing them as variable length
+// string. Length of address is mixed in along with seed, so that zero padding
+// doesn't collide with actual zero bytes.
+size_t
+hashAddressBytes(std::string const& bytes, uint64_t seed) {
+  uint64_t words[2] = {0, 0};
+  if (bytes.size() > sizeof(words)) {
+    return folly::hash::hash_combine(seed, std::hash<std::string>()(bytes));
+  }
+  std::memcpy(words, bytes.data(), bytes.size());
+  return folly::hash::hash_128_to_64(
+      folly::hash::hash_128_to_64(words[0], words[1]),
+      (seed << 8) | bytes.size());
+}
+
+} // namespace
+
 namespace std {
 
 /**
@@ -15,7 +39,9 @@ namespace std {
 size_t
 hash<openr::thrift::IpPrefix>::operator()(
     openr::thrift::IpPrefix const& ipPrefix) const {
-  return hash<string>()(ipPrefix.prefixAddress.addr) + ipPrefix.prefixLength;
+  return hashAddressBytes(
+      ipPrefix.prefixAddress.addr,
+      static_cast<uint16_t>(ipPrefix.prefixLength));
 }
 
 /**
@@ -24,7 +50,7 @@ hash<openr::thrift::IpPrefix>::operator()(
 size_t
 hash<openr::thrift::BinaryAddress>::operator()(
     openr::thrift::BinaryAddress const& addr) const {
-  size_t res = hash<string>()(addr.addr);
+  size_t res = hashAddressBytes(addr.addr, 0);
   if (addr.ifName_ref().has_value()) {
     res += hash<string>()(addr.ifName_ref().value());
   }
@@ -81,4 +107,17 @@ hash<openr::thrift::UnicastRoute>::operator()(
   return res;
 }
 
+/**
+ * Make MplsRoute hashable
+ */
+size_t
+hash<openr::thrift::MplsRoute>::operator()(
+    openr::thrift::MplsRoute const& route) const {
+  size_t res = hash<int32_t>()(route.topLabel);
+  for (const auto& nh : route.nextHops) {
+    res += hash<openr::thrift::NextHopThrift>()(nh);
+  }
+  return res;
+}
+
 } // namespace std
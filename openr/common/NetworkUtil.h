@@ -59,6 +59,14 @@ struct hash<openr::thrift::UnicastRoute> {
   size_t operator()(openr::thrift::UnicastRoute const&) const;
 };
 
+/**
+ * Make MplsRoute hashable
+ */
+template <>
+struct hash<openr::thrift::MplsRoute> {
+  size_t operator()(openr::thrift::MplsRoute const&) const;
+};
+
 } // namespace std
 
 namespace openr {
@@ -9,6 +9,8 @@
 
 #include <folly/fibers/FiberManagerMap.h>
 
+#include <openr/common/Constants.h>
+
 namespace openr {
 
 namespace {
@@ -35,6 +37,16 @@ getFmOptions() {
   options.stackSize = 256 * 1024;
   return options;
 }
+
+// Raise max to value if value is larger
+void
+updateMax(
+    std::atomic<std::chrono::milliseconds>& max,
+    std::chrono::milliseconds value) {
+  auto curr = max.load();
+  while (value > curr and not max.compare_exchange_weak(curr, value)) {
+  }
+}
 } // namespace
 
 EventBaseStopSignalHandler::EventBaseStopSignalHandler(folly::EventBase* evb)
@@ -51,11 +63,13 @@ OpenrEventBase::ZmqEventHandler::ZmqEventHandler(
     int fd,
     uintptr_t socketPtr,
     int zmqEvents,
-    fbzmq::SocketCallback callback)
+    fbzmq::SocketCallback callback,
+    std::atomic<std::chrono::milliseconds>& maxCallbackDuration)
     : folly::EventHandler(evb, folly::NetworkSocket::fromFd(fd)),
       callback_(std::move(callback)),
       zmqEvents_(zmqEvents),
-      ptr_(reinterpret_cast<void*>(socketPtr)) {
+      ptr_(reinterpret_cast<void*>(socketPtr)),
+      maxCallbackDuration_(maxCallbackDuration) {
   CHECK(evb);
   // Register handler
   uint16_t events{folly::EventHandler::PERSIST};
@@ -107,7 +121,16 @@ OpenrEventBase::ZmqEventHandler::handlerReady(uint16_t events) noexcept {
   do {
     // Invoke callback if there is an overlap
     if (zmqEvents_ & zmqEvents) {
+      const auto startTime = std::chrono::steady_clock::now();
       callback_(zmqEvents);
+      const auto duration =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::steady_clock::now() - startTime);
+      updateMax(maxCallbackDuration_, duration);
+      if (duration > Constants::kSlowEvbCallbackThreshold) {
+        LOG(WARNING) << "Callback of fd " << getNetworkSocket().toFd()
+                     << " took " << duration.count() << "ms";
+      }
     }
 
     if (ptr_ and (zmqEvents & ZMQ_POLLIN)) {
@@ -121,15 +144,24 @@ OpenrEventBase::ZmqEventHandler::handlerReady(uint16_t events) noexcept {
   } while (zmqEvents & ZMQ_POLLIN);
 }
 
-OpenrEventBase::OpenrEventBase()
-    : fiberManager_(folly::fibers::getFiberManager(evb_, getFmOptions())) {
+OpenrEventBase::OpenrEventBase(std::chrono::milliseconds healthCheckInterval)
+    : fiberManager_(folly::fibers::getFiberManager(evb_, getFmOptions())),
+      healthCheckInterval_(healthCheckInterval) {
   // Periodic timer to update eventbase's timestamp. This is used by Watchdog to
-  // identify stuck threads.
+  // identify stuck threads. Lag of timer is recorded as well, which tells how
+  // long the loop was kept busy by other callbacks.
   timestamp_ = getElapsedSeconds();
   timeout_ = folly::AsyncTimeout::make(evb_, [this]() noexcept {
+    const auto now = std::chrono::steady_clock::now();
+    updateMax(
+        maxLoopLag_,
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - timeoutScheduleTime_));
     timestamp_ = getElapsedSeconds();
-    timeout_->scheduleTimeout(std::chrono::seconds(1));
+    timeoutScheduleTime_ = now + healthCheckInterval_;
+    timeout_->scheduleTimeout(healthCheckInterval_);
   });
+  timeoutScheduleTime_ = std::chrono::steady_clock::now();
   timeout_->scheduleTimeout(0);
 }
 
@@ -145,6 +177,9 @@ OpenrEventBase::stop() {
   for (auto& future : fiberTaskFutures_) {
     future.wait();
   }
+  for (auto& future : coroTaskFutures_) {
+    future.wait();
+  }
   evb_.terminateLoopSoon();
 }
 
@@ -193,7 +228,8 @@ OpenrEventBase::addSocketFd(
           socketFd,
           reinterpret_cast<uintptr_t>(nullptr),
           events,
-          std::move(callback)));
+          std::move(callback),
+          maxCallbackDuration_));
 }
 
 void
@@ -207,7 +243,12 @@ OpenrEventBase::addSocket(
       std::piecewise_construct,
       std::forward_as_tuple(socketFd),
       std::forward_as_tuple(
-          &evb_, socketFd, socketPtr, events, std::move(callback)));
+          &evb_,
+          socketFd,
+          socketPtr,
+          events,
+          std::move(callback),
+          maxCallbackDuration_));
 }
 
 void
@@ -12,6 +12,9 @@
 #include <fbzmq/async/ZmqEventLoop.h>
 #include <fbzmq/zmq/Socket.h>
 #include <folly/fibers/FiberManager.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/Task.h>
+#endif
 #include <folly/io/async/AsyncSignalHandler.h>
 #include <folly/io/async/EventHandler.h>
 
@@ -27,7 +30,9 @@ class EventBaseStopSignalHandler : public folly::AsyncSignalHandler {
 
 class OpenrEventBase {
  public:
-  OpenrEventBase();
+  // healthCheckInterval is the period of timer updating timestamp and loop lag
+  explicit OpenrEventBase(
+      std::chrono::milliseconds healthCheckInterval = std::chrono::seconds(1));
 
   virtual ~OpenrEventBase();
 
@@ -60,6 +65,18 @@ class OpenrEventBase {
     return fiberManager_.addTaskFuture(std::move(func));
   }
 
+#if FOLLY_HAS_COROUTINES
+  /**
+   * Add a co-routine task to be run on event-base. Unlike fibers, co-routines
+   * are stackless and only allocate their frames. All tasks will be awaited in
+   * `stop()`.
+   */
+  void
+  addCoroTask(folly::coro::Task<void>&& task) {
+    coroTaskFutures_.emplace_back(std::move(task).scheduleOn(&evb_).start());
+  }
+#endif
+
   /**
    * EventBase API aliases
    */
@@ -76,6 +93,24 @@ class OpenrEventBase {
     return timestamp_.load();
   }
 
+  /**
+   * Get maximum lag of event loop since last call, i.e. how late the health
+   * check timer fired compared to its schedule, and reset it
+   */
+  std::chrono::milliseconds
+  getAndResetMaxLoopLag() {
+    return maxLoopLag_.exchange(std::chrono::milliseconds(0));
+  }
+
+  /**
+   * Get maximum duration of a single socket/fd callback since last call, and
+   * reset it
+   */
+  std::chrono::milliseconds
+  getAndResetMaxCallbackDuration() {
+    return maxCallbackDuration_.exchange(std::chrono::milliseconds(0));
+  }
+
   /**
    * Runnable interface APIs
    */
@@ -123,7 +158,8 @@ class OpenrEventBase {
         int fd,
         uintptr_t socketPtr,
         int zmqEvents,
-        fbzmq::SocketCallback callback);
+        fbzmq::SocketCallback callback,
+        std::atomic<std::chrono::milliseconds>& maxCallbackDuration);
 
     virtual ~ZmqEventHandler() {}
 
@@ -140,6 +176,9 @@ class OpenrEventBase {
     // fbzmq socket pointer if fd is socket
     void* ptr_{nullptr};
 
+    // Maximum callback duration of owning event-base
+    std::atomic<std::chrono::milliseconds>& maxCallbackDuration_;
+
     // AsyncTimeout for reading first set of events
     std::unique_ptr<folly::AsyncTimeout> timeout_;
   };
@@ -151,12 +190,25 @@ class OpenrEventBase {
   folly::fibers::FiberManager& fiberManager_;
   std::vector<folly::Future<folly::Unit>> fiberTaskFutures_;
 
+  // Co-routine tasks scheduled on evb_
+  std::vector<folly::SemiFuture<folly::Unit>> coroTaskFutures_;
+
   // Data structure to hold fd and their handlers
   std::unordered_map<int /* fd */, ZmqEventHandler> fdHandlers_;
 
-  // Timestamp
+  // Timestamp, updated by health check timer
+  const std::chrono::milliseconds healthCheckInterval_;
   std::atomic<std::chrono::seconds> timestamp_{std::chrono::seconds(0)};
   std::unique_ptr<folly::AsyncTimeout> timeout_;
+
+  // Scheduled time of next health check timer, and maximum lag of it
+  std::chrono::steady_clock::time_point timeoutScheduleTime_;
+  std::atomic<std::chrono::milliseconds> maxLoopLag_{
+      std::chrono::milliseconds(0)};
+
+  // Maximum duration of socket/fd callbacks
+  std::atomic<std::chrono::milliseconds> maxCallbackDuration_{
+      std::chrono::milliseconds(0)};
 };
 
 } // namespace openr
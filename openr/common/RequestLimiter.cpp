@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "RequestLimiter.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include <glog/logging.h>
+
+namespace openr {
+
+RequestLimiter::Permit::Permit(RequestLimiter* limiter) : limiter_(limiter) {}
+
+RequestLimiter::Permit::~Permit() {
+  if (limiter_) {
+    limiter_->release();
+  }
+}
+
+RequestLimiter::Permit::Permit(Permit&& other) noexcept
+    : limiter_(std::exchange(other.limiter_, nullptr)) {}
+
+RequestLimiter::Permit&
+RequestLimiter::Permit::operator=(Permit&& other) noexcept {
+  if (this != &other) {
+    if (limiter_) {
+      limiter_->release();
+    }
+    limiter_ = std::exchange(other.limiter_, nullptr);
+  }
+  return *this;
+}
+
+RequestLimiter::RequestLimiter(size_t maxRunning, size_t maxQueued)
+    : maxRunning_(maxRunning), maxQueued_(maxQueued) {
+  CHECK_GT(maxRunning_, 0);
+}
+
+folly::SemiFuture<RequestLimiter::Permit>
+RequestLimiter::acquire() {
+  auto state = state_.wlock();
+  if (state->numRunning < maxRunning_) {
+    ++state->numRunning;
+    return folly::makeSemiFuture(Permit(this));
+  }
+  if (state->queue.size() >= maxQueued_) {
+    return folly::makeSemiFuture<Permit>(
+        std::runtime_error("Too many pending requests"));
+  }
+  state->queue.emplace_back();
+  return state->queue.back().getSemiFuture();
+}
+
+void
+RequestLimiter::release() {
+  folly::Promise<Permit> next;
+  {
+    auto state = state_.wlock();
+    if (state->queue.empty()) {
+      --state->numRunning;
+      return;
+    }
+    next = std::move(state->queue.front());
+    state->queue.pop_front();
+  }
+  // Fulfilled outside of lock, as abandoned request releases its permit
+  // right away
+  next.setValue(Permit(this));
+}
+
+size_t
+RequestLimiter::getNumRunning() const {
+  return state_.rlock()->numRunning;
+}
+
+size_t
+RequestLimiter::getNumQueued() const {
+  return state_.rlock()->queue.size();
+}
+
+} // namespace openr
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <deque>
+
+#include <folly/Function.h>
+#include <folly/Synchronized.h>
+#include <folly/futures/Future.h>
+
+namespace openr {
+
+/**
+ * Bounds number of concurrently running asynchronous requests, e.g. dumps
+ * served from event base of a module. Requests over the limit are queued and
+ * started in FIFO order as running ones complete. Requests over the limit of
+ * queue fail right away.
+ *
+ * Thread safe. Limiter must outlive its permits.
+ */
+class RequestLimiter {
+ public:
+  /**
+   * Slot of a running request, handed back to limiter on destruction
+   */
+  class Permit {
+   public:
+    ~Permit();
+
+    Permit(Permit&& other) noexcept;
+    Permit& operator=(Permit&& other) noexcept;
+
+    Permit(Permit const&) = delete;
+    Permit& operator=(Permit const&) = delete;
+
+   private:
+    friend class RequestLimiter;
+
+    explicit Permit(RequestLimiter* limiter);
+
+    RequestLimiter* limiter_{nullptr};
+  };
+
+  RequestLimiter(size_t maxRunning, size_t maxQueued);
+
+  /**
+   * Get permit as soon as number of running requests is below limit. Fails
+   * with std::runtime_error if queue is full
+   */
+  folly::SemiFuture<Permit> acquire();
+
+  /**
+   * Run request under a permit, which is held till returned future completes
+   */
+  template <typename T>
+  folly::SemiFuture<T>
+  run(folly::Function<folly::SemiFuture<T>()> fn) {
+    return acquire().deferValue([fn = std::move(fn)](Permit permit) mutable {
+      return folly::makeSemiFutureWith(std::move(fn))
+          .defer([permit = std::move(permit)](folly::Try<T>&& result) {
+            return std::move(result).value();
+          });
+    });
+  }
+
+  size_t getNumRunning() const;
+
+  size_t getNumQueued() const;
+
+ private:
+  // Hand slot over to first queued request, if any
+  void release();
+
+  const size_t maxRunning_{0};
+  const size_t maxQueued_{0};
+
+  struct State {
+    size_t numRunning{0};
+    std::deque<folly::Promise<Permit>> queue;
+  };
+  folly::Synchronized<State> state_;
+};
+
+} // namespace openr
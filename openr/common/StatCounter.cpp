@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "StatCounter.h"
+
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include <fb303/ServiceData.h>
+#include <folly/system/ThreadName.h>
+
+#include <openr/common/Constants.h>
+
+namespace fb303 = facebook::fb303;
+
+namespace openr {
+
+namespace {
+
+// Live counters, and thread flushing them periodically. Started with first
+// counter and never destroyed, so that counters can be destroyed in any order
+// on exit. Thread only touches registered counters
+class StatCounterRegistry {
+ public:
+  static StatCounterRegistry&
+  get() {
+    static auto* registry = new StatCounterRegistry();
+    return *registry;
+  }
+
+  void
+  add(StatCounter* counter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counters_.emplace(counter);
+    if (not isRunning_) {
+      isRunning_ = true;
+      std::thread([this]() {
+        folly::setThreadName("StatCounter");
+        run();
+      }).detach();
+    }
+  }
+
+  // Waits for flush in progress, if any
+  void
+  remove(StatCounter* counter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counters_.erase(counter);
+  }
+
+  void
+  flushAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto* counter : counters_) {
+      counter->flush();
+    }
+  }
+
+ private:
+  StatCounterRegistry() = default;
+
+  void
+  run() {
+    while (true) {
+      std::this_thread::sleep_for(Constants::kStatCounterFlushInterval);
+      flushAll();
+    }
+  }
+
+  std::mutex mutex_;
+  std::unordered_set<StatCounter*> counters_;
+  bool isRunning_{false};
+};
+
+} // namespace
+
+StatCounter::StatCounter(std::string key, fb303::ExportType exportType)
+    : key_(std::move(key)), slots_([this]() { return new Slot(this); }) {
+  fb303::fbData->addStatExportType(key_, exportType);
+  StatCounterRegistry::get().add(this);
+}
+
+StatCounter::~StatCounter() {
+  // slots flush remaining values as they are destroyed along with counter
+  StatCounterRegistry::get().remove(this);
+}
+
+void
+StatCounter::flush() {
+  for (auto& slot : slots_.accessAllThreads()) {
+    slot.flush();
+  }
+}
+
+void
+StatCounter::flushAll() {
+  StatCounterRegistry::get().flushAll();
+}
+
+void
+StatCounter::Slot::flush() {
+  const auto numFlushedSamples =
+      numSamples.exchange(0, std::memory_order_relaxed);
+  if (numFlushedSamples == 0) {
+    return;
+  }
+  fb303::fbData->addStatValueAggregated(
+      counter->getKey(),
+      sum.exchange(0, std::memory_order_relaxed),
+      numFlushedSamples);
+}
+
+} // namespace openr
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include <fb303/ExportType.h>
+#include <folly/ThreadLocal.h>
+
+namespace openr {
+
+/**
+ * fb303 stat for hot paths, e.g. per publication, packet, key or route.
+ * Values are added to a slot of the calling thread, without locking nor
+ * lookup of the stat by key, and flushed to fb303 as one aggregated value per
+ * thread every kStatCounterFlushInterval, from a thread shared by all
+ * counters. Values of threads exiting are flushed right away, and so are all
+ * values on destruction.
+ *
+ * Meant to be a member of the module owning the stat, outliving threads
+ * adding to it. Counters of same key add up. add() is thread safe.
+ */
+class StatCounter {
+ public:
+  StatCounter(std::string key, facebook::fb303::ExportType exportType);
+
+  ~StatCounter();
+
+  StatCounter(StatCounter const&) = delete;
+  StatCounter& operator=(StatCounter const&) = delete;
+
+  /**
+   * Add one sample of value. Slot is owned by calling thread, atomics are
+   * only shared with flushing thread
+   */
+  void
+  add(int64_t value = 1) const {
+    auto& slot = *slots_;
+    slot.sum.fetch_add(value, std::memory_order_relaxed);
+    slot.numSamples.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Flush values of all threads to fb303
+   */
+  void flush();
+
+  /**
+   * Flush values of all counters to fb303, e.g. before reading counters
+   */
+  static void flushAll();
+
+  const std::string&
+  getKey() const {
+    return key_;
+  }
+
+ private:
+  struct Slot {
+    explicit Slot(StatCounter const* counter) : counter(counter) {}
+
+    ~Slot() {
+      flush();
+    }
+
+    // move pending values to fb303
+    void flush();
+
+    StatCounter const* const counter{nullptr};
+    std::atomic<int64_t> sum{0};
+    std::atomic<int64_t> numSamples{0};
+  };
+
+  // tag of slots, needed to access slots of all threads
+  struct SlotTag {};
+
+  const std::string key_;
+  folly::ThreadLocal<Slot, SlotTag> slots_;
+};
+
+} // namespace openr
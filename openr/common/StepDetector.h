@@ -7,14 +7,94 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
 #include <stdexcept>
+#include <vector>
 
-#include <folly/stats/BucketedTimeSeries.h>
+#include <glog/logging.h>
 
 namespace openr {
 
+namespace detail {
+
+/*
+ * Sliding window over last numBuckets sample periods of a time series, kept
+ * as ring buffer of per period buckets along with running sum and count of
+ * whole window. Ring is sized once on construction, so adding values neither
+ * allocates nor walks the window, except for clearing buckets of periods
+ * that passed without values.
+ */
+template <typename ValueType, typename TimeType>
+class StepDetectorWindow {
+ public:
+  StepDetectorWindow(TimeType bucketPeriod, size_t numBuckets)
+      : bucketPeriod_(bucketPeriod), buckets_(numBuckets) {
+    CHECK_GT(bucketPeriod.count(), 0);
+    CHECK_GT(numBuckets, 0);
+  }
+
+  // add value at time 'now'. Values older than window are rejected
+  bool
+  addValue(TimeType now, const ValueType& val) {
+    const int64_t period = now.count() / bucketPeriod_.count();
+    const int64_t numBuckets = buckets_.size();
+    if (period <= latestPeriod_ - numBuckets) {
+      return false;
+    }
+
+    // expire buckets of periods which fell out of window
+    if (period > latestPeriod_) {
+      const int64_t numExpired = std::min(period - latestPeriod_, numBuckets);
+      for (int64_t i = 1; i <= numExpired; ++i) {
+        auto& bucket = buckets_[(latestPeriod_ + i) % numBuckets];
+        sum_ -= bucket.sum;
+        count_ -= bucket.count;
+        bucket = Bucket{};
+      }
+      latestPeriod_ = period;
+    }
+
+    auto& bucket = buckets_[period % numBuckets];
+    bucket.sum += val;
+    ++bucket.count;
+    sum_ += val;
+    ++count_;
+    return true;
+  }
+
+  size_t
+  count() const {
+    return count_;
+  }
+
+  double
+  avg() const {
+    return count_ ? static_cast<double>(sum_) / count_ : 0.0;
+  }
+
+ private:
+  struct Bucket {
+    ValueType sum{0};
+    size_t count{0};
+  };
+
+  const TimeType bucketPeriod_;
+
+  // bucket of period p is at index p % numBuckets
+  std::vector<Bucket> buckets_;
+
+  // latest period values were added for, -1 till first value
+  int64_t latestPeriod_{-1};
+
+  // sum and count of values in all buckets
+  ValueType sum_{0};
+  size_t count_{0};
+};
+
+} // namespace detail
+
 /*
  * This class detects abrupt changes, i.e., steps, in the mean level of a time
  * series or signal. Often, the step is small and the time series is corrupted
@@ -52,8 +132,8 @@ class StepDetector {
       // callback when step is detected
       std::function<void(const ValueType&)> stepCb)
       : slowWndSize_(slowWndSize),
-        fastSlideWindow_(fastWndSize, samplePeriod * fastWndSize),
-        slowSlideWindow_(slowWndSize, samplePeriod * slowWndSize),
+        fastSlideWindow_(samplePeriod, fastWndSize),
+        slowSlideWindow_(samplePeriod, slowWndSize),
         loThreshold_(loThreshold),
         hiThreshold_(hiThreshold),
         absThreshold_(absThreshold),
@@ -129,12 +209,10 @@ class StepDetector {
   size_t slowWndSize_{0};
 
   // fast sliding window
-  folly::BucketedTimeSeries<ValueType, folly::LegacyStatsClock<TimeType>>
-      fastSlideWindow_;
+  detail::StepDetectorWindow<ValueType, TimeType> fastSlideWindow_;
 
-  // slow sliding window size
-  folly::BucketedTimeSeries<ValueType, folly::LegacyStatsClock<TimeType>>
-      slowSlideWindow_;
+  // slow sliding window
+  detail::StepDetectorWindow<ValueType, TimeType> slowSlideWindow_;
 
   // lower threshold, in percentage
   const uint8_t loThreshold_{0};
@@ -28,4 +28,51 @@ setupThriftServerTls(
   return;
 }
 
+std::vector<thrift::RouteDatabaseDelta>
+splitRouteDatabaseDelta(
+    thrift::RouteDatabaseDelta&& delta, size_t maxChunkRoutes) {
+  CHECK_GT(maxChunkRoutes, 0);
+  const size_t numRoutes = delta.unicastRoutesToDelete.size() +
+      delta.mplsRoutesToDelete.size() + delta.unicastRoutesToUpdate.size() +
+      delta.mplsRoutesToUpdate.size();
+
+  std::vector<thrift::RouteDatabaseDelta> chunks;
+  if (numRoutes <= maxChunkRoutes) {
+    chunks.emplace_back(std::move(delta));
+    return chunks;
+  }
+
+  chunks.reserve((numRoutes + maxChunkRoutes - 1) / maxChunkRoutes);
+  size_t numChunkRoutes{0};
+  auto getChunk = [&]() -> thrift::RouteDatabaseDelta& {
+    if (chunks.empty() or numChunkRoutes >= maxChunkRoutes) {
+      chunks.emplace_back();
+      chunks.back().thisNodeName = delta.thisNodeName;
+      numChunkRoutes = 0;
+    }
+    ++numChunkRoutes;
+    return chunks.back();
+  };
+  for (auto& prefix : delta.unicastRoutesToDelete) {
+    getChunk().unicastRoutesToDelete.emplace_back(std::move(prefix));
+  }
+  for (auto label : delta.mplsRoutesToDelete) {
+    getChunk().mplsRoutesToDelete.emplace_back(label);
+  }
+  for (auto& route : delta.unicastRoutesToUpdate) {
+    getChunk().unicastRoutesToUpdate.emplace_back(std::move(route));
+  }
+  for (auto& route : delta.mplsRoutesToUpdate) {
+    getChunk().mplsRoutesToUpdate.emplace_back(std::move(route));
+  }
+
+  for (size_t i = 0; i + 1 < chunks.size(); ++i) {
+    chunks[i].hasMoreChunks_ref() = true;
+  }
+  if (auto perfEvents = delta.perfEvents_ref()) {
+    chunks.back().perfEvents_ref() = std::move(*perfEvents);
+  }
+  return chunks;
+}
+
 } // namespace openr
@@ -6,9 +6,13 @@
  */
 #pragma once
 
+#include <vector>
+
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 #include <wangle/ssl/SSLContextConfig.h>
 
+#include <openr/if/gen-cpp2/Fib_types.h>
+
 namespace openr {
 
 // Setup thrift server for TLS
@@ -18,4 +22,12 @@ void setupThriftServerTls(
     std::string const& ticketSeedPath,
     std::shared_ptr<wangle::SSLContextConfig> sslContext);
 
+// Split route delta into chunks of at most maxChunkRoutes routes (deletes
+// ahead of updates), so that every message sent out of it is serialized and
+// written on its own instead of blocking thread for the whole delta. Every
+// chunk except the last has hasMoreChunks set, and perfEvents travel with
+// the last one. Always returns at least one chunk.
+std::vector<thrift::RouteDatabaseDelta> splitRouteDatabaseDelta(
+    thrift::RouteDatabaseDelta&& delta, size_t maxChunkRoutes);
+
 } // namespace openr
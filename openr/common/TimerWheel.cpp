@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "TimerWheel.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+namespace openr {
+
+TimerWheel::Timeout::Timeout(TimerWheel& wheel, std::function<void()> callback)
+    : wheel_(wheel), callback_(std::move(callback)) {}
+
+TimerWheel::Timeout::~Timeout() {
+  cancelTimeout();
+}
+
+void
+TimerWheel::Timeout::scheduleTimeout(
+    std::chrono::milliseconds timeout, bool isPeriodic) {
+  period_ = isPeriodic ? timeout : std::chrono::milliseconds(0);
+  wheel_.schedule(*this, timeout);
+}
+
+void
+TimerWheel::Timeout::cancelTimeout() {
+  period_ = std::chrono::milliseconds(0);
+  wheel_.cancel(*this);
+}
+
+TimerWheel::TimerWheel(
+    folly::EventBase* evb,
+    std::chrono::milliseconds tickInterval,
+    size_t numSlots)
+    : tickInterval_(tickInterval),
+      startTime_(std::chrono::steady_clock::now()),
+      slots_(numSlots) {
+  CHECK_GT(tickInterval_.count(), 0) << "Tick interval can't be 0";
+  CHECK_GT(numSlots, 0) << "Number of slots can't be 0";
+  tickTimeout_ = folly::AsyncTimeout::make(*evb, [this]() noexcept {
+    advance();
+    if (numScheduled_) {
+      tickTimeout_->scheduleTimeout(tickInterval_);
+    }
+  });
+}
+
+TimerWheel::~TimerWheel() {
+  DCHECK_EQ(0, numScheduled_) << "Timers must not outlive timer wheel";
+}
+
+std::unique_ptr<TimerWheel::Timeout>
+TimerWheel::makeTimeout(std::function<void()> callback) {
+  return std::unique_ptr<Timeout>(new Timeout(*this, std::move(callback)));
+}
+
+void
+TimerWheel::schedule(Timeout& timeout, std::chrono::milliseconds delay) {
+  cancel(timeout);
+
+  // Nothing to expire. Catch up with clock, so that advance doesn't have to
+  // walk over ticks passed while wheel was idle.
+  if (numScheduled_ == 0) {
+    currentTick_ = std::max(currentTick_, getNowTick());
+  }
+
+  // Round up, so that timer never fires early
+  const int64_t tickNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(tickInterval_)
+          .count();
+  const int64_t expiryNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - startTime_ + delay)
+          .count();
+  timeout.expiryTick_ = std::max<uint64_t>(
+      (std::max<int64_t>(expiryNs, 0) + tickNs - 1) / tickNs,
+      currentTick_ + 1);
+  slots_.at(timeout.expiryTick_ % slots_.size()).push_back(timeout);
+
+  if (++numScheduled_ == 1 and not tickTimeout_->isScheduled()) {
+    tickTimeout_->scheduleTimeout(tickInterval_);
+  }
+}
+
+void
+TimerWheel::cancel(Timeout& timeout) {
+  if (not timeout.isScheduled()) {
+    return;
+  }
+  timeout.hook_.unlink();
+  --numScheduled_;
+}
+
+void
+TimerWheel::advance() {
+  const auto nowTick = getNowTick();
+
+  // Far behind clock, every slot needs to be looked at only once
+  if (nowTick > currentTick_ + slots_.size()) {
+    currentTick_ = nowTick - slots_.size();
+  }
+
+  while (currentTick_ < nowTick) {
+    ++currentTick_;
+
+    // Collect due timers first, as callbacks may modify any of timers
+    TimeoutList expired;
+    auto& slot = slots_.at(currentTick_ % slots_.size());
+    for (auto it = slot.begin(); it != slot.end();) {
+      auto& timeout = *it++;
+      if (timeout.expiryTick_ <= currentTick_) {
+        timeout.hook_.unlink();
+        expired.push_back(timeout);
+      }
+    }
+
+    while (not expired.empty()) {
+      auto& timeout = expired.front();
+      cancel(timeout);
+      if (timeout.period_.count() > 0) {
+        schedule(timeout, timeout.period_);
+      }
+      // Callback may destroy its timer
+      auto callback = timeout.callback_;
+      callback();
+    }
+  }
+}
+
+uint64_t
+TimerWheel::getNowTick() const {
+  return (std::chrono::steady_clock::now() - startTime_) / tickInterval_;
+}
+
+} // namespace openr
@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <folly/IntrusiveList.h>
+#include <folly/io/async/AsyncTimeout.h>
+#include <folly/io/async/EventBase.h>
+
+namespace openr {
+
+/**
+ * Hashed timing wheel running many timers off a single timeout of the event
+ * base. Scheduling, re-scheduling and cancelling a timer are O(1), which
+ * makes it suitable for large number of timers which are re-armed often,
+ * e.g. hold timers of neighbors.
+ *
+ * Time is kept in ticks of `tickInterval`. Timer expires on the first tick
+ * at or after its expiry, so it is late by at most one tick and never early.
+ * Timers farther out than one rotation of the wheel stay in their slot for
+ * multiple rotations.
+ *
+ * NOTE: Not thread safe. Timers must be used from event base thread only and
+ * must not outlive the wheel.
+ */
+class TimerWheel {
+ public:
+  /**
+   * Timer handle owned by user, with API alike fbzmq::ZmqTimeout. Destroying
+   * it cancels the timer.
+   */
+  class Timeout {
+   public:
+    ~Timeout();
+
+    Timeout(Timeout const&) = delete;
+    Timeout& operator=(Timeout const&) = delete;
+
+    /**
+     * Schedule (or re-schedule) timer to fire after `timeout`, and repeatedly
+     * every `timeout` afterwards if periodic
+     */
+    void scheduleTimeout(
+        std::chrono::milliseconds timeout, bool isPeriodic = false);
+
+    void cancelTimeout();
+
+    bool
+    isScheduled() const {
+      return hook_.is_linked();
+    }
+
+   private:
+    friend class TimerWheel;
+
+    Timeout(TimerWheel& wheel, std::function<void()> callback);
+
+    TimerWheel& wheel_;
+    const std::function<void()> callback_;
+    std::chrono::milliseconds period_{0};
+    uint64_t expiryTick_{0};
+    folly::IntrusiveListHook hook_;
+  };
+
+  TimerWheel(
+      folly::EventBase* evb,
+      std::chrono::milliseconds tickInterval,
+      size_t numSlots);
+
+  ~TimerWheel();
+
+  TimerWheel(TimerWheel const&) = delete;
+  TimerWheel& operator=(TimerWheel const&) = delete;
+
+  /**
+   * Create a timer which is not scheduled yet
+   */
+  std::unique_ptr<Timeout> makeTimeout(std::function<void()> callback);
+
+  // Number of scheduled timers
+  size_t
+  size() const {
+    return numScheduled_;
+  }
+
+ private:
+  using TimeoutList = folly::IntrusiveList<Timeout, &Timeout::hook_>;
+
+  void schedule(Timeout& timeout, std::chrono::milliseconds delay);
+
+  void cancel(Timeout& timeout);
+
+  // Expire timers of all ticks which have passed
+  void advance();
+
+  // Current tick as per clock. Timers of ticks before it are due.
+  uint64_t getNowTick() const;
+
+  const std::chrono::milliseconds tickInterval_;
+
+  const std::chrono::steady_clock::time_point startTime_;
+
+  // Every tick up to currentTick_ has been expired
+  uint64_t currentTick_{0};
+
+  // Timers by slot of their expiry tick
+  std::vector<TimeoutList> slots_;
+
+  size_t numScheduled_{0};
+
+  // Timeout on event base to advance wheel, scheduled while there are timers
+  std::unique_ptr<folly::AsyncTimeout> tickTimeout_;
+};
+
+} // namespace openr
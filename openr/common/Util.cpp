@@ -7,6 +7,7 @@
 
 #include "Util.h"
 
+#include <cctype>
 #include <ifaddrs.h>
 #include <net/if.h>
 #include <netinet/in.h>
@@ -16,18 +17,34 @@
 
 namespace openr {
 
-// create RE2 set for the list of key prefixes
+// create RE2 set for the list of key prefixes. Plain strings are kept aside
+// and matched as such, RE2 is only needed for actual regexes.
 KeyPrefix::KeyPrefix(std::vector<std::string> const& keyPrefixList) {
   if (keyPrefixList.empty()) {
     return;
   }
+  matchAll_ = false;
+
+  std::vector<std::string const*> regexKeyPrefixes;
+  for (auto const& keyPrefix : keyPrefixList) {
+    if (isLiteral(keyPrefix)) {
+      literalKeyPrefixes_.emplace_back(keyPrefix);
+    } else {
+      regexKeyPrefixes.emplace_back(&keyPrefix);
+    }
+  }
+  if (regexKeyPrefixes.empty()) {
+    return;
+  }
+
   re2::RE2::Options re2Options;
   re2Options.set_case_sensitive(true);
   keyPrefix_ =
       std::make_unique<re2::RE2::Set>(re2Options, re2::RE2::ANCHOR_START);
   std::string re2AddError{};
 
-  for (auto const& keyPrefix : keyPrefixList) {
+  for (auto const* keyPrefixPtr : regexKeyPrefixes) {
+    auto const& keyPrefix = *keyPrefixPtr;
     if (keyPrefix_->Add(keyPrefix, &re2AddError) < 0) {
       LOG(FATAL) << "Failed to add prefixes to RE2 set: '" << keyPrefix << "', "
                  << "error: '" << re2AddError << "'";
@@ -43,11 +60,22 @@ KeyPrefix::KeyPrefix(std::vector<std::string> const& keyPrefixList) {
 // match the key with the list of prefixes
 bool
 KeyPrefix::keyMatch(std::string const& key) const {
-  if (!keyPrefix_) {
+  if (matchAll_) {
     return true;
   }
-  std::vector<int> matches;
-  return keyPrefix_->Match(key, &matches);
+  for (auto const& keyPrefix : literalKeyPrefixes_) {
+    if (key.compare(0, keyPrefix.size(), keyPrefix) == 0) {
+      return true;
+    }
+  }
+  // indices of matching regexes are not needed
+  return keyPrefix_ and keyPrefix_->Match(key, nullptr);
+}
+
+bool
+KeyPrefix::isLiteral(folly::StringPiece keyPrefix) {
+  return keyPrefix.find_first_of(".^$*+?()[]{}|\\") ==
+      folly::StringPiece::npos;
 }
 
 PrefixKey::PrefixKey(
@@ -65,26 +93,113 @@ PrefixKey::PrefixKey(
           prefix_.first.str(),
           prefix_.second)) {}
 
+namespace {
+
+// Consume leading characters of str accepted by isValid, and return them
+folly::StringPiece
+takeWhile(folly::StringPiece& str, bool (*isValid)(char)) {
+  size_t len{0};
+  while (len < str.size() and isValid(str[len])) {
+    ++len;
+  }
+  auto token = str.subpiece(0, len);
+  str.advance(len);
+  return token;
+}
+
+bool
+isNodeNameChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) or c == '.' or
+      c == '-' or c == '_';
+}
+
+bool
+isAreaChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c));
+}
+
+bool
+isIpAddressChar(char c) {
+  return std::isxdigit(static_cast<unsigned char>(c)) or c == '.' or c == ':';
+}
+
+bool
+isDigitChar(char c) {
+  return std::isdigit(static_cast<unsigned char>(c));
+}
+
+// Diff two route lists sorted by their keys in a single pass. Routes are
+// compared only against the route with same key, and routes not equal to it are
+// updated while keys missing from newRoutes are deleted.
+template <typename Route, typename Key, typename GetKey>
+void
+diffSortedRoutes(
+    const std::vector<Route>& newRoutes,
+    const std::vector<Route>& oldRoutes,
+    GetKey getKey,
+    std::vector<Route>& routesToUpdate,
+    std::vector<Key>& keysToDelete) {
+  auto newIt = newRoutes.begin();
+  auto oldIt = oldRoutes.begin();
+  while (newIt != newRoutes.end() or oldIt != oldRoutes.end()) {
+    if (oldIt == oldRoutes.end() or
+        (newIt != newRoutes.end() and getKey(*newIt) < getKey(*oldIt))) {
+      routesToUpdate.emplace_back(*newIt++);
+    } else if (
+        newIt == newRoutes.end() or getKey(*oldIt) < getKey(*newIt)) {
+      keysToDelete.emplace_back(getKey(*oldIt++));
+    } else {
+      if (not(*newIt == *oldIt)) {
+        routesToUpdate.emplace_back(*newIt);
+      }
+      ++newIt;
+      ++oldIt;
+    }
+  }
+}
+
+} // namespace
+
+// Parses the format of getPrefixRE2() by hand, as this is done for every
+// per prefix key received
 folly::Expected<PrefixKey, std::string>
 PrefixKey::fromStr(const std::string& key) {
-  int plen{0};
-  std::string area{};
-  std::string node{};
-  std::string ipstr{};
-  folly::CIDRNetwork ipaddress;
-  auto patt = RE2::FullMatch(key, getPrefixRE2(), &node, &area, &ipstr, &plen);
-  if (!patt) {
+  auto invalidKey = [&key]() {
     return folly::makeUnexpected(folly::sformat("Invalid key format {}", key));
+  };
+
+  folly::StringPiece str(key);
+  if (not str.removePrefix(Constants::kPrefixDbMarker)) {
+    return invalidKey();
+  }
+  const auto node = takeWhile(str, isNodeNameChar);
+  if (node.empty() or not str.removePrefix(':')) {
+    return invalidKey();
+  }
+  const auto area = takeWhile(str, isAreaChar);
+  if (area.empty() or not str.removePrefix(":[")) {
+    return invalidKey();
+  }
+  const auto ipstr = takeWhile(str, isIpAddressChar);
+  if (ipstr.empty() or not str.removePrefix('/')) {
+    return invalidKey();
+  }
+  const auto plenStr = takeWhile(str, isDigitChar);
+  if (plenStr.empty() or plenStr.size() > 3 or str != "]") {
+    return invalidKey();
+  }
+  int plen{0};
+  for (char c : plenStr) {
+    plen = plen * 10 + (c - '0');
   }
 
-  try {
-    ipaddress =
-        folly::IPAddress::createNetwork(folly::sformat("{}/{}", ipstr, plen));
-  } catch (const folly::IPAddressFormatException& e) {
-    LOG(INFO) << "Exception in converting to Prefix. " << e.what();
+  auto maybeIp = folly::IPAddress::tryFromString(ipstr);
+  if (maybeIp.hasError() or static_cast<size_t>(plen) > maybeIp->bitCount()) {
+    LOG(INFO) << "Invalid prefix " << ipstr << "/" << plen << " in key";
     return folly::makeUnexpected(std::string("Invalid IP address in key"));
   }
-  return PrefixKey(node, ipaddress, area);
+  folly::CIDRNetwork ipaddress{maybeIp->mask(plen), plen};
+  return PrefixKey(node.str(), ipaddress, area.str());
 }
 
 std::string
@@ -547,65 +662,75 @@ findDeltaRoutes(
       std::is_sorted(
           oldRouteDb.mplsRoutes.begin(), oldRouteDb.mplsRoutes.end()));
 
-  // Find unicast routes to be added/updated or removed
-  std::vector<thrift::UnicastRoute> unicastRoutesToUpdate;
-  std::set_difference(
-      newRouteDb.unicastRoutes.begin(),
-      newRouteDb.unicastRoutes.end(),
-      oldRouteDb.unicastRoutes.begin(),
-      oldRouteDb.unicastRoutes.end(),
-      std::inserter(unicastRoutesToUpdate, unicastRoutesToUpdate.begin()));
-  std::vector<thrift::UnicastRoute> unicastRoutesToDelete;
-  std::set_difference(
-      oldRouteDb.unicastRoutes.begin(),
-      oldRouteDb.unicastRoutes.end(),
-      newRouteDb.unicastRoutes.begin(),
-      newRouteDb.unicastRoutes.end(),
-      std::inserter(unicastRoutesToDelete, unicastRoutesToDelete.begin()));
-
-  // Find mpls routes to be added/updated or removed
-  std::vector<thrift::MplsRoute> mplsRoutesToUpdate;
-  std::set_difference(
-      newRouteDb.mplsRoutes.begin(),
-      newRouteDb.mplsRoutes.end(),
-      oldRouteDb.mplsRoutes.begin(),
-      oldRouteDb.mplsRoutes.end(),
-      std::inserter(mplsRoutesToUpdate, mplsRoutesToUpdate.begin()));
-  std::vector<thrift::MplsRoute> mplsRoutesToDelete;
-  std::set_difference(
-      oldRouteDb.mplsRoutes.begin(),
-      oldRouteDb.mplsRoutes.end(),
-      newRouteDb.mplsRoutes.begin(),
-      newRouteDb.mplsRoutes.end(),
-      std::inserter(mplsRoutesToDelete, mplsRoutesToDelete.begin()));
-
-  // Find entry of prefix to be removed
-  std::set<thrift::IpPrefix> prefixesToRemove;
-  for (const auto& route : unicastRoutesToDelete) {
-    prefixesToRemove.emplace(route.dest);
-  }
-  for (const auto& route : unicastRoutesToUpdate) {
-    prefixesToRemove.erase(route.dest);
-  }
-
-  // Find labels to be removed
-  std::set<int32_t> labelsToRemove;
-  for (const auto& route : mplsRoutesToDelete) {
-    labelsToRemove.emplace(route.topLabel);
-  }
-  for (const auto& route : mplsRoutesToUpdate) {
-    labelsToRemove.erase(route.topLabel);
-  }
-
-  // Build routes to be programmed.
+  // Routes are sorted by their destination and label, hence both lists can be
+  // walked together and each pair of routes with same key is compared once
   thrift::RouteDatabaseDelta routeDbDelta;
   routeDbDelta.thisNodeName = newRouteDb.thisNodeName;
-  routeDbDelta.unicastRoutesToUpdate = std::move(unicastRoutesToUpdate);
-  routeDbDelta.unicastRoutesToDelete = {prefixesToRemove.begin(),
-                                        prefixesToRemove.end()};
-  routeDbDelta.mplsRoutesToUpdate = std::move(mplsRoutesToUpdate);
-  routeDbDelta.mplsRoutesToDelete = {labelsToRemove.begin(),
-                                     labelsToRemove.end()};
+  diffSortedRoutes(
+      newRouteDb.unicastRoutes,
+      oldRouteDb.unicastRoutes,
+      [](const thrift::UnicastRoute& route) -> const thrift::IpPrefix& {
+        return route.dest;
+      },
+      routeDbDelta.unicastRoutesToUpdate,
+      routeDbDelta.unicastRoutesToDelete);
+  diffSortedRoutes(
+      newRouteDb.mplsRoutes,
+      oldRouteDb.mplsRoutes,
+      [](const thrift::MplsRoute& route) { return route.topLabel; },
+      routeDbDelta.mplsRoutesToUpdate,
+      routeDbDelta.mplsRoutesToDelete);
+
+  return routeDbDelta;
+}
+
+thrift::RouteDatabaseDelta
+mergeRouteDeltas(std::vector<thrift::RouteDatabaseDelta>&& routeDeltas) {
+  CHECK(not routeDeltas.empty());
+  if (routeDeltas.size() == 1) {
+    return std::move(routeDeltas.front());
+  }
+
+  std::map<thrift::IpPrefix, thrift::UnicastRoute> unicastRoutesToUpdate;
+  std::set<thrift::IpPrefix> unicastRoutesToDelete;
+  std::map<int32_t, thrift::MplsRoute> mplsRoutesToUpdate;
+  std::set<int32_t> mplsRoutesToDelete;
+
+  for (auto& routeDelta : routeDeltas) {
+    DCHECK(routeDelta.thisNodeName == routeDeltas.back().thisNodeName);
+    for (auto& route : routeDelta.unicastRoutesToUpdate) {
+      unicastRoutesToDelete.erase(route.dest);
+      auto dest = route.dest;
+      unicastRoutesToUpdate.insert_or_assign(std::move(dest), std::move(route));
+    }
+    for (auto& route : routeDelta.mplsRoutesToUpdate) {
+      mplsRoutesToDelete.erase(route.topLabel);
+      mplsRoutesToUpdate.insert_or_assign(route.topLabel, std::move(route));
+    }
+    for (auto& dest : routeDelta.unicastRoutesToDelete) {
+      unicastRoutesToUpdate.erase(dest);
+      unicastRoutesToDelete.emplace(std::move(dest));
+    }
+    for (auto topLabel : routeDelta.mplsRoutesToDelete) {
+      mplsRoutesToUpdate.erase(topLabel);
+      mplsRoutesToDelete.emplace(topLabel);
+    }
+  }
+
+  // Node name and perf events of the latest delta describe merged delta
+  thrift::RouteDatabaseDelta routeDbDelta;
+  routeDbDelta.thisNodeName = std::move(routeDeltas.back().thisNodeName);
+  routeDbDelta.perfEvents = std::move(routeDeltas.back().perfEvents);
+  for (auto& kv : unicastRoutesToUpdate) {
+    routeDbDelta.unicastRoutesToUpdate.emplace_back(std::move(kv.second));
+  }
+  routeDbDelta.unicastRoutesToDelete = {unicastRoutesToDelete.begin(),
+                                        unicastRoutesToDelete.end()};
+  for (auto& kv : mplsRoutesToUpdate) {
+    routeDbDelta.mplsRoutesToUpdate.emplace_back(std::move(kv.second));
+  }
+  routeDbDelta.mplsRoutesToDelete = {mplsRoutesToDelete.begin(),
+                                     mplsRoutesToDelete.end()};
 
   return routeDbDelta;
 }
@@ -1036,6 +1161,29 @@ getNodeNameFromKey(const std::string& key) {
   return split[1];
 }
 
+std::string
+getPerAdjacencyKey(
+    const std::string& adjDbMarker,
+    const std::string& nodeName,
+    const std::string& otherNodeName,
+    const std::string& ifName) {
+  return folly::sformat(
+      "{}{}{}{}{}{}",
+      adjDbMarker,
+      nodeName,
+      Constants::kPrefixNameSeparator,
+      otherNodeName,
+      Constants::kPrefixNameSeparator,
+      ifName);
+}
+
+bool
+isPerAdjacencyKey(const std::string& key) {
+  std::vector<folly::StringPiece> split;
+  folly::split(Constants::kPrefixNameSeparator.toString(), key, split);
+  return split.size() >= 4;
+}
+
 std::string
 createPeerSyncId(const std::string& node, const std::string& area) {
   return folly::to<std::string>(node, "::TCP::SYNC::", area);
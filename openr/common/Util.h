@@ -71,7 +71,17 @@ class KeyPrefix {
   explicit KeyPrefix(std::vector<std::string> const& keyPrefixList);
   bool keyMatch(std::string const& key) const;
 
+  // check if key prefix is a plain string, i.e. has no regex syntax
+  static bool isLiteral(folly::StringPiece keyPrefix);
+
  private:
+  // empty list of key prefixes matches all keys
+  bool matchAll_{true};
+
+  // plain string key prefixes, matched without regex
+  std::vector<std::string> literalKeyPrefixes_;
+
+  // RE2 set of the remaining key prefixes, if any
   std::unique_ptr<re2::RE2::Set> keyPrefix_;
 };
 
@@ -274,6 +284,13 @@ thrift::RouteDatabaseDelta findDeltaRoutes(
     const thrift::RouteDatabase& newRouteDb,
     const thrift::RouteDatabase& oldRouteDb);
 
+/**
+ * Coalesce consecutive route deltas into one with the same net effect when
+ * applied in order. Within each delta, deletes take effect after updates.
+ */
+thrift::RouteDatabaseDelta mergeRouteDeltas(
+    std::vector<thrift::RouteDatabaseDelta>&& routeDeltas);
+
 thrift::BuildInfo getBuildInfoThrift() noexcept;
 
 /**
@@ -512,6 +529,17 @@ std::vector<thrift::MplsRoute> createMplsRoutesWithBestNextHopsMap(
 
 std::string getNodeNameFromKey(const std::string& key);
 
+// Key of a single adjacency of a node, i.e.
+// `<adjDbMarker><node>:<otherNode>:<ifName>`, as opposed to the key of whole
+// adjacency database `<adjDbMarker><node>`
+std::string getPerAdjacencyKey(
+    const std::string& adjDbMarker,
+    const std::string& nodeName,
+    const std::string& otherNodeName,
+    const std::string& ifName);
+
+bool isPerAdjacencyKey(const std::string& key);
+
 std::string createPeerSyncId(const std::string& node, const std::string& area);
 
 namespace MetricVectorUtils {
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include <folly/init/Init.h>
+#include <folly/system/ThreadName.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/CpuProfiler.h>
+
+namespace openr {
+
+namespace {
+
+// Thread named for profile, spinning on CPU till stopped
+class BusyThread {
+ public:
+  explicit BusyThread(std::string const& name)
+      : thread_([this, name]() {
+          folly::setThreadName(name);
+          uint64_t value{0};
+          while (not stop_.load(std::memory_order_relaxed)) {
+            value = value * 31 + 7;
+          }
+          result_ = value;
+        }) {}
+
+  ~BusyThread() {
+    stop_ = true;
+    thread_.join();
+  }
+
+ private:
+  std::atomic<bool> stop_{false};
+  uint64_t result_{0};
+  std::thread thread_;
+};
+
+} // namespace
+
+TEST(CpuProfilerTest, SamplesByThreadName) {
+  BusyThread busyThread("busy-loop");
+  auto profile = CpuProfiler::profile(
+      std::chrono::milliseconds(1000), 99 /* samplingHz */, "busy");
+  EXPECT_LT(0, profile.numSamples);
+  EXPECT_EQ(0, profile.numDroppedSamples);
+
+  int64_t numSamples{0};
+  for (auto const& kv : profile.foldedStacks) {
+    EXPECT_EQ(0, kv.first.find("busy-loop;"));
+    numSamples += kv.second;
+  }
+  EXPECT_EQ(profile.numSamples, numSamples);
+}
+
+TEST(CpuProfilerTest, SingleProfileAtATime) {
+  BusyThread busyThread("busy-loop");
+  std::thread runningThread([]() {
+    CpuProfiler::profile(std::chrono::milliseconds(1000), 99 /* samplingHz */);
+  });
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  EXPECT_THROW(
+      CpuProfiler::profile(std::chrono::milliseconds(100), 99),
+      std::runtime_error);
+  runningThread.join();
+
+  // Profiling again succeeds once previous profile is done
+  EXPECT_NO_THROW(CpuProfiler::profile(std::chrono::milliseconds(100), 99));
+}
+
+TEST(CpuProfilerTest, InvalidSamplingHz) {
+  EXPECT_THROW(
+      CpuProfiler::profile(std::chrono::milliseconds(100), 0),
+      std::runtime_error);
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::init(&argc, &argv);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  auto rc = RUN_ALL_TESTS();
+
+  return rc;
+}
@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Synchronized.h>
+#include <folly/init/Init.h>
+#include <folly/synchronization/Baton.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/EventLogger.h>
+
+namespace openr {
+
+namespace {
+
+fbzmq::LogSample
+createSample(int64_t id) {
+  fbzmq::LogSample sample{};
+  sample.addString("event", "TEST");
+  sample.addInt("id", id);
+  return sample;
+}
+
+} // namespace
+
+TEST(EventLoggerTest, BatchPerFlushInterval) {
+  folly::Synchronized<std::vector<fbzmq::thrift::EventLog>> eventLogs;
+  folly::Baton<> submitted;
+  {
+    EventLogger logger(
+        [&](fbzmq::thrift::EventLog eventLog) {
+          eventLogs.wlock()->emplace_back(std::move(eventLog));
+          submitted.post();
+        },
+        std::chrono::milliseconds(50));
+    for (int64_t i = 0; i < 3; ++i) {
+      logger.log(createSample(i));
+    }
+    submitted.wait();
+  }
+
+  // All samples go out in one event log, in order
+  auto logs = eventLogs.copy();
+  ASSERT_EQ(1, logs.size());
+  EXPECT_EQ(Constants::kEventLogCategory.toString(), logs.at(0).category);
+  ASSERT_EQ(3, logs.at(0).samples.size());
+  for (int64_t i = 0; i < 3; ++i) {
+    auto sample = fbzmq::LogSample::fromJson(logs.at(0).samples.at(i));
+    EXPECT_EQ("TEST", sample.getString("event"));
+    EXPECT_EQ(i, sample.getInt("id"));
+  }
+}
+
+TEST(EventLoggerTest, DropOverLimitAndFlushOnDestruction) {
+  std::vector<fbzmq::thrift::EventLog> eventLogs;
+  {
+    // Long interval, samples are only submitted on destruction
+    EventLogger logger(
+        [&](fbzmq::thrift::EventLog eventLog) {
+          eventLogs.emplace_back(std::move(eventLog));
+        },
+        std::chrono::seconds(60),
+        2 /* maxSamplesPerFlush */);
+    for (int64_t i = 0; i < 5; ++i) {
+      logger.log(createSample(i));
+    }
+    EXPECT_EQ(3, logger.getNumDroppedSamples());
+  }
+
+  // Oldest samples are kept
+  ASSERT_EQ(1, eventLogs.size());
+  ASSERT_EQ(2, eventLogs.at(0).samples.size());
+  auto sample = fbzmq::LogSample::fromJson(eventLogs.at(0).samples.at(1));
+  EXPECT_EQ(1, sample.getInt("id"));
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::init(&argc, &argv);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  auto rc = RUN_ALL_TESTS();
+
+  return rc;
+}
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/executors/InlineExecutor.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/RequestLimiter.h>
+
+namespace openr {
+
+TEST(RequestLimiterTest, QueueOverLimit) {
+  RequestLimiter limiter(2 /* maxRunning */, 1 /* maxQueued */);
+  std::vector<folly::Promise<int>> requests(4);
+
+  std::vector<folly::Future<int>> results;
+  for (auto& request : requests) {
+    results.emplace_back(
+        limiter
+            .run<int>([&request]() { return request.getSemiFuture(); })
+            .via(&folly::InlineExecutor::instance()));
+  }
+
+  // Two running, one queued, last one rejected
+  EXPECT_EQ(2, limiter.getNumRunning());
+  EXPECT_EQ(1, limiter.getNumQueued());
+  ASSERT_TRUE(results.at(3).isReady());
+  EXPECT_TRUE(results.at(3).hasException());
+
+  // Completion of running request starts queued one
+  requests.at(0).setValue(0);
+  EXPECT_EQ(0, results.at(0).value());
+  EXPECT_EQ(2, limiter.getNumRunning());
+  EXPECT_EQ(0, limiter.getNumQueued());
+
+  // Failed request releases its permit as well
+  requests.at(1).setException(std::runtime_error("failed"));
+  EXPECT_TRUE(results.at(1).hasException());
+  EXPECT_EQ(1, limiter.getNumRunning());
+
+  requests.at(2).setValue(2);
+  EXPECT_EQ(2, results.at(2).value());
+  EXPECT_EQ(0, limiter.getNumRunning());
+}
+
+TEST(RequestLimiterTest, AbandonedRequest) {
+  RequestLimiter limiter(1 /* maxRunning */, 2 /* maxQueued */);
+
+  auto running = limiter.acquire();
+  ASSERT_TRUE(running.isReady());
+  {
+    // Queued request dropped before getting its permit
+    auto abandoned = limiter.acquire();
+    EXPECT_FALSE(abandoned.isReady());
+  }
+  auto queued = limiter.acquire();
+  EXPECT_EQ(2, limiter.getNumQueued());
+
+  // Permit skips over abandoned request
+  { auto permit = std::move(running).get(); }
+  ASSERT_TRUE(queued.isReady());
+  EXPECT_EQ(1, limiter.getNumRunning());
+  EXPECT_EQ(0, limiter.getNumQueued());
+
+  { auto permit = std::move(queued).get(); }
+  EXPECT_EQ(0, limiter.getNumRunning());
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::init(&argc, &argv);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  auto rc = RUN_ALL_TESTS();
+
+  return rc;
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <thread>
+#include <vector>
+
+#include <fb303/ServiceData.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/StatCounter.h>
+
+namespace fb303 = facebook::fb303;
+
+namespace openr {
+
+TEST(StatCounterTest, ExportType) {
+  StatCounter packets("stat_counter_test.packets", fb303::COUNT);
+  StatCounter bytes("stat_counter_test.bytes", fb303::SUM);
+  StatCounter latency("stat_counter_test.latency", fb303::AVG);
+
+  // stats are exported before any value is added
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(0, counters.at("stat_counter_test.packets.count"));
+  EXPECT_EQ(0, counters.at("stat_counter_test.bytes.sum"));
+
+  for (int64_t i = 1; i <= 4; ++i) {
+    packets.add();
+    bytes.add(100 * i);
+    latency.add(i);
+  }
+
+  // as many samples are added as were added to counter
+  StatCounter::flushAll();
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(4, counters.at("stat_counter_test.packets.count"));
+  EXPECT_EQ(1000, counters.at("stat_counter_test.bytes.sum"));
+  EXPECT_EQ(2, counters.at("stat_counter_test.latency.avg"));
+
+  // nothing more is added by flush without new values
+  StatCounter::flushAll();
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(4, counters.at("stat_counter_test.packets.count"));
+}
+
+TEST(StatCounterTest, MultipleThreads) {
+  const int kNumThreads = 4;
+  const int kNumValues = 1000;
+  StatCounter bytes("stat_counter_test.threads.bytes", fb303::SUM);
+
+  // values of threads are flushed as they exit
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&bytes]() {
+      for (int j = 0; j < kNumValues; ++j) {
+        bytes.add(2);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(
+      2 * kNumThreads * kNumValues,
+      counters.at("stat_counter_test.threads.bytes.sum"));
+
+  // counters of same key add up, and flush on destruction
+  {
+    StatCounter moreBytes("stat_counter_test.threads.bytes", fb303::SUM);
+    moreBytes.add(5);
+    bytes.add(5);
+  }
+  bytes.flush();
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(
+      2 * kNumThreads * kNumValues + 10,
+      counters.at("stat_counter_test.threads.bytes.sum"));
+}
+
+TEST(StatCounterTest, PeriodicFlush) {
+  StatCounter packets("stat_counter_test.periodic.packets", fb303::COUNT);
+  packets.add();
+
+  // flushed from background thread within flush interval
+  /* sleep override */
+  std::this_thread::sleep_for(2 * Constants::kStatCounterFlushInterval);
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(1, counters.at("stat_counter_test.periodic.packets.count"));
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::init(&argc, &argv);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  auto rc = RUN_ALL_TESTS();
+
+  return rc;
+}
@@ -161,6 +161,36 @@ TEST(StepDetectorTest, SlowBoiling) {
   }
 }
 
+// window keeps values of last sample periods only
+TEST(StepDetectorTest, Window) {
+  openr::detail::StepDetectorWindow<int64_t, std::chrono::milliseconds> window(
+      std::chrono::milliseconds(100) /* bucket period */, 3 /* num buckets */);
+  EXPECT_EQ(0, window.count());
+  EXPECT_EQ(0, window.avg());
+
+  EXPECT_TRUE(window.addValue(std::chrono::milliseconds(1000), 10));
+  EXPECT_TRUE(window.addValue(std::chrono::milliseconds(1050), 20));
+  EXPECT_TRUE(window.addValue(std::chrono::milliseconds(1100), 30));
+  EXPECT_EQ(3, window.count());
+  EXPECT_EQ(20, window.avg());
+
+  // first period falls out of window
+  EXPECT_TRUE(window.addValue(std::chrono::milliseconds(1300), 60));
+  EXPECT_EQ(2, window.count());
+  EXPECT_EQ(45, window.avg());
+
+  // values older than window are rejected, in window ones accepted
+  EXPECT_FALSE(window.addValue(std::chrono::milliseconds(1000), 100));
+  EXPECT_TRUE(window.addValue(std::chrono::milliseconds(1200), 0));
+  EXPECT_EQ(3, window.count());
+  EXPECT_EQ(30, window.avg());
+
+  // long gap drains whole window
+  EXPECT_TRUE(window.addValue(std::chrono::milliseconds(5000), 5));
+  EXPECT_EQ(1, window.count());
+  EXPECT_EQ(5, window.avg());
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
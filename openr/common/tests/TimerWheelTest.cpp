@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/init/Init.h>
+#include <folly/io/async/EventBase.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/TimerWheel.h>
+
+using namespace std::chrono;
+
+namespace openr {
+
+namespace {
+
+// Loop event base till condition holds or timeout
+template <typename Cond>
+bool
+loopUntil(folly::EventBase& evb, Cond cond, milliseconds timeout = 5s) {
+  const auto deadline = steady_clock::now() + timeout;
+  while (not cond() and steady_clock::now() < deadline) {
+    evb.loopOnce(EVLOOP_NONBLOCK);
+  }
+  return cond();
+}
+
+} // namespace
+
+TEST(TimerWheelTest, FireNotEarly) {
+  folly::EventBase evb;
+  TimerWheel wheel(&evb, 5ms, 8);
+
+  // Delays within and beyond single rotation of wheel
+  std::vector<steady_clock::time_point> firedTimes(3);
+  std::vector<milliseconds> delays{7ms, 30ms, 100ms};
+  std::vector<std::unique_ptr<TimerWheel::Timeout>> timers;
+  const auto startTime = steady_clock::now();
+  for (size_t i = 0; i < delays.size(); ++i) {
+    timers.emplace_back(wheel.makeTimeout(
+        [&firedTimes, i]() { firedTimes.at(i) = steady_clock::now(); }));
+    timers.back()->scheduleTimeout(delays.at(i));
+  }
+  EXPECT_EQ(3, wheel.size());
+
+  EXPECT_TRUE(loopUntil(evb, [&]() { return wheel.size() == 0; }));
+  for (size_t i = 0; i < delays.size(); ++i) {
+    EXPECT_GE(firedTimes.at(i), startTime + delays.at(i));
+    EXPECT_FALSE(timers.at(i)->isScheduled());
+  }
+}
+
+TEST(TimerWheelTest, RescheduleAndCancel) {
+  folly::EventBase evb;
+  TimerWheel wheel(&evb, 1ms, 16);
+
+  int numFired{0};
+  auto timer1 = wheel.makeTimeout([&numFired]() { ++numFired; });
+  auto timer2 = wheel.makeTimeout([&numFired]() { ++numFired; });
+  timer1->scheduleTimeout(10ms);
+  timer2->scheduleTimeout(10ms);
+
+  // Re-arming keeps single entry, cancel removes it
+  const auto startTime = steady_clock::now();
+  timer1->scheduleTimeout(50ms);
+  timer2->cancelTimeout();
+  EXPECT_TRUE(timer1->isScheduled());
+  EXPECT_FALSE(timer2->isScheduled());
+  EXPECT_EQ(1, wheel.size());
+
+  EXPECT_TRUE(loopUntil(evb, [&]() { return numFired == 1; }));
+  EXPECT_GE(steady_clock::now(), startTime + 50ms);
+  EXPECT_EQ(0, wheel.size());
+
+  // Destroying scheduled timer cancels it
+  timer2->scheduleTimeout(1ms);
+  timer2.reset();
+  EXPECT_EQ(0, wheel.size());
+}
+
+TEST(TimerWheelTest, Periodic) {
+  folly::EventBase evb;
+  TimerWheel wheel(&evb, 1ms, 4);
+
+  int numFired{0};
+  auto timer = wheel.makeTimeout([&numFired]() { ++numFired; });
+  timer->scheduleTimeout(2ms, true /* isPeriodic */);
+  EXPECT_TRUE(loopUntil(evb, [&]() { return numFired >= 5; }));
+  EXPECT_TRUE(timer->isScheduled());
+
+  timer->cancelTimeout();
+  EXPECT_EQ(0, wheel.size());
+}
+
+TEST(TimerWheelTest, CallbackModifiesTimers) {
+  folly::EventBase evb;
+  TimerWheel wheel(&evb, 1ms, 4);
+
+  // Timers due on same tick. Whichever fires first destroys both.
+  std::unique_ptr<TimerWheel::Timeout> timer1;
+  std::unique_ptr<TimerWheel::Timeout> timer2;
+  int numFired{0};
+  auto destroyAll = [&]() {
+    ++numFired;
+    timer1.reset();
+    timer2.reset();
+  };
+  timer1 = wheel.makeTimeout(destroyAll);
+  timer2 = wheel.makeTimeout(destroyAll);
+  timer1->scheduleTimeout(3ms);
+  timer2->scheduleTimeout(3ms);
+
+  EXPECT_TRUE(loopUntil(evb, [&]() { return wheel.size() == 0; }));
+  EXPECT_EQ(1, numFired);
+
+  // Timer re-scheduling itself from callback
+  int numRearmed{0};
+  std::unique_ptr<TimerWheel::Timeout> timer3;
+  timer3 = wheel.makeTimeout([&]() {
+    if (++numRearmed < 3) {
+      timer3->scheduleTimeout(1ms);
+    }
+  });
+  timer3->scheduleTimeout(1ms);
+  EXPECT_TRUE(loopUntil(evb, [&]() { return numRearmed == 3; }));
+  EXPECT_FALSE(timer3->isScheduled());
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::init(&argc, &argv);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  auto rc = RUN_ALL_TESTS();
+
+  return rc;
+}
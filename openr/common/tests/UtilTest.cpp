@@ -15,6 +15,7 @@
 #include <sodium.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
+#include <openr/common/ThriftUtil.h>
 #include <openr/common/Util.h>
 
 using namespace std;
@@ -123,6 +124,37 @@ TEST(UtilTest, NetworkUtilTest) {
 
   thrift::BinaryAddress empty;
   EXPECT_EQ("", toString(empty));
+
+  // hashing takes length of address and prefix into account
+  std::hash<thrift::IpPrefix> prefixHash;
+  EXPECT_NE(
+      prefixHash(toIpPrefix("10.0.0.0/8")),
+      prefixHash(toIpPrefix("10.0.0.0/16")));
+  EXPECT_NE(
+      prefixHash(toIpPrefix("0.0.0.0/0")), prefixHash(toIpPrefix("::/0")));
+  EXPECT_EQ(
+      prefixHash(toIpPrefix("fe80::1/128")),
+      prefixHash(toIpPrefix("fe80::1/128")));
+  std::hash<thrift::BinaryAddress> addrHash;
+  EXPECT_NE(addrHash(toBinaryAddress(v4)), addrHash(toBinaryAddress(v6)));
+  EXPECT_NE(addrHash(empty), addrHash(toBinaryAddress("0.0.0.0")));
+}
+
+TEST(UtilTest, KeyPrefixTest) {
+  // empty list matches all keys
+  EXPECT_TRUE(KeyPrefix({}).keyMatch("adj:node1"));
+
+  // plain strings and regexes, matched at start of key
+  KeyPrefix keyPrefix({"adj:", "prefix:node[0-9]+:"});
+  EXPECT_TRUE(keyPrefix.keyMatch("adj:node1"));
+  EXPECT_TRUE(keyPrefix.keyMatch("prefix:node12:0:[::/0]"));
+  EXPECT_FALSE(keyPrefix.keyMatch("prefix:nodeA:0:[::/0]"));
+  EXPECT_FALSE(keyPrefix.keyMatch("ad"));
+  EXPECT_FALSE(keyPrefix.keyMatch("x-adj:node1"));
+
+  EXPECT_TRUE(KeyPrefix::isLiteral("prefix:node_1-a"));
+  EXPECT_FALSE(KeyPrefix::isLiteral("prefix:node."));
+  EXPECT_FALSE(KeyPrefix::isLiteral("^adj:"));
 }
 
 TEST(UtilTest, PrefixKeyTest) {
@@ -223,6 +255,25 @@ TEST(UtilTest, PrefixKeyTest) {
   k1.shouldPass = false;
   strToItems.push_back(k1);
 
+  // this should fail, trailing characters
+  k1.pkey = "prefix:nodename.0.0:10:[0.0.0.0/19]x";
+  k1.shouldPass = false;
+  strToItems.push_back(k1);
+
+  // this should fail, invalid address
+  k1.pkey = "prefix:nodename.0.0:10:[0.0.0/19]";
+  k1.shouldPass = false;
+  strToItems.push_back(k1);
+
+  // this should pass, address is masked to prefix length
+  k1.pkey = "prefix:nodename.0.0:10:[10.1.2.3/8]";
+  k1.node = "nodename.0.0";
+  k1.ipaddr = folly::IPAddress::createNetwork("10.0.0.0/8");
+  k1.area = "10";
+  k1.ipPrefix = toIpPrefix("10.0.0.0/8");
+  k1.shouldPass = true;
+  strToItems.push_back(k1);
+
   for (const auto& keys : strToItems) {
     auto prefixStr = PrefixKey::fromStr(keys.pkey);
     if (keys.shouldPass) {
@@ -713,6 +764,69 @@ TEST(UtilTest, findDeltaRoutes) {
   EXPECT_EQ(res3.mplsRoutesToUpdate.size(), 0);
   EXPECT_EQ(res3.mplsRoutesToDelete.size(), 1);
   EXPECT_EQ(res3.mplsRoutesToDelete.at(0), 2);
+
+  // interleaved routes: unchanged, updated, added and removed ones
+  oldRouteDb.unicastRoutes = {
+      createUnicastRoute(prefix1, {path1_2_1}),
+      createUnicastRoute(prefix2, {path1_2_1, path1_2_2})};
+  oldRouteDb.mplsRoutes = {
+      createMplsRoute(1, {path1_2_1_swap}),
+      createMplsRoute(2, {path1_2_1_swap}),
+      createMplsRoute(4, {path1_3_1_swap})};
+  newRouteDb.unicastRoutes = {
+      createUnicastRoute(prefix2, {path1_2_1}),
+      createUnicastRoute(prefix3, {path1_3_1})};
+  newRouteDb.mplsRoutes = {
+      createMplsRoute(2, {path1_2_1_swap}),
+      createMplsRoute(3, {path1_3_1_swap}),
+      createMplsRoute(4, {path1_3_2_swap})};
+  std::sort(oldRouteDb.unicastRoutes.begin(), oldRouteDb.unicastRoutes.end());
+  std::sort(newRouteDb.unicastRoutes.begin(), newRouteDb.unicastRoutes.end());
+  const auto& res4 = findDeltaRoutes(newRouteDb, oldRouteDb);
+  EXPECT_EQ(res4.unicastRoutesToUpdate, newRouteDb.unicastRoutes);
+  EXPECT_EQ(
+      res4.unicastRoutesToDelete, std::vector<thrift::IpPrefix>({prefix1}));
+  EXPECT_EQ(
+      res4.mplsRoutesToUpdate,
+      std::vector<thrift::MplsRoute>(
+          {createMplsRoute(3, {path1_3_1_swap}),
+           createMplsRoute(4, {path1_3_2_swap})}));
+  EXPECT_EQ(res4.mplsRoutesToDelete, std::vector<int32_t>({1}));
+}
+
+TEST(UtilTest, mergeRouteDeltas) {
+  const auto route1 = createUnicastRoute(prefix1, {path1_2_1});
+  const auto route2 = createUnicastRoute(prefix2, {path1_2_1});
+  const auto route2New = createUnicastRoute(prefix2, {path1_2_2});
+  const auto mplsRoute2 = createMplsRoute(2, {path1_2_1_swap});
+
+  std::vector<thrift::RouteDatabaseDelta> deltas(3);
+  for (auto& delta : deltas) {
+    delta.thisNodeName = "node-1";
+  }
+  // add prefix1, prefix2 and label 2
+  deltas[0].unicastRoutesToUpdate = {route1, route2};
+  deltas[0].mplsRoutesToUpdate = {mplsRoute2};
+  // withdraw prefix1 and label 2, update prefix2
+  deltas[1].unicastRoutesToUpdate = {route2New};
+  deltas[1].unicastRoutesToDelete = {prefix1};
+  deltas[1].mplsRoutesToDelete = {2};
+  // re-add label 2, withdraw prefix3 with update & delete in same delta
+  deltas[2].mplsRoutesToUpdate = {mplsRoute2};
+  deltas[2].unicastRoutesToUpdate = {createUnicastRoute(prefix3, {})};
+  deltas[2].unicastRoutesToDelete = {prefix3};
+
+  const auto res = mergeRouteDeltas(std::move(deltas));
+  EXPECT_EQ("node-1", res.thisNodeName);
+  EXPECT_EQ(
+      std::vector<thrift::UnicastRoute>({route2New}),
+      res.unicastRoutesToUpdate);
+  EXPECT_EQ(
+      std::vector<thrift::IpPrefix>({prefix1, prefix3}),
+      res.unicastRoutesToDelete);
+  EXPECT_EQ(
+      std::vector<thrift::MplsRoute>({mplsRoute2}), res.mplsRoutesToUpdate);
+  EXPECT_EQ(0, res.mplsRoutesToDelete.size());
 }
 
 TEST(UtilTest, MplsLabelValidate) {
@@ -970,6 +1084,39 @@ TEST(UtilTest, FunctionExecutionTime) {
   LOG_FN_EXECUTION_TIME;
 }
 
+TEST(ThriftUtilTest, SplitRouteDatabaseDelta) {
+  thrift::RouteDatabaseDelta delta;
+  delta.thisNodeName = "node1";
+  delta.unicastRoutesToDelete = {prefix1};
+  delta.mplsRoutesToDelete = {100};
+  delta.unicastRoutesToUpdate = {
+      createUnicastRoute(prefix2, {path1_2_1}),
+      createUnicastRoute(prefix3, {path1_2_2})};
+  delta.mplsRoutesToUpdate = {createMplsRoute(200, {path1_2_3})};
+  delta.perfEvents_ref() = thrift::PerfEvents{};
+
+  // Small enough delta is kept as is
+  {
+    auto chunks = splitRouteDatabaseDelta(thrift::RouteDatabaseDelta(delta), 5);
+    ASSERT_EQ(1, chunks.size());
+    EXPECT_EQ(delta, chunks.at(0));
+  }
+
+  // Chunks of at most 2 routes, deletes go first
+  auto chunks = splitRouteDatabaseDelta(thrift::RouteDatabaseDelta(delta), 2);
+  ASSERT_EQ(3, chunks.size());
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    EXPECT_EQ("node1", chunks.at(i).thisNodeName);
+    const bool isLast = i + 1 == chunks.size();
+    EXPECT_EQ(not isLast, chunks.at(i).hasMoreChunks_ref().has_value());
+    EXPECT_EQ(isLast, chunks.at(i).perfEvents_ref().has_value());
+  }
+  EXPECT_EQ(delta.unicastRoutesToDelete, chunks.at(0).unicastRoutesToDelete);
+  EXPECT_EQ(delta.mplsRoutesToDelete, chunks.at(0).mplsRoutesToDelete);
+  EXPECT_EQ(delta.unicastRoutesToUpdate, chunks.at(1).unicastRoutesToUpdate);
+  EXPECT_EQ(delta.mplsRoutesToUpdate, chunks.at(2).mplsRoutesToUpdate);
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -7,10 +7,15 @@
 
 #include "PersistentStore.h"
 
+#include <algorithm>
 #include <chrono>
 
+#include <folly/Exception.h>
 #include <folly/FileUtil.h>
+#include <folly/ScopeGuard.h>
+#include <folly/container/F14Map.h>
 #include <folly/io/IOBuf.h>
+#include <folly/system/MemoryMapping.h>
 
 #include <openr/common/Util.h>
 
@@ -18,7 +23,53 @@ using std::exception;
 
 namespace {
 
-static const long kDbFlushRatio = 10000;
+// Journal of records appended to file is compacted into a snapshot of
+// database once file grows beyond kCompactionRatio times the size of
+// database, and beyond kMinCompactionBytes. Bounds file size as well as
+// amount of data rewritten per appended record.
+const uint64_t kCompactionRatio = 2;
+const uint64_t kMinCompactionBytes = 1024 * 1024;
+
+// PersistentObject referring to key and data in buffer it is decoded from
+struct PersistentObjectRange {
+  openr::ActionType type;
+  folly::StringPiece key;
+  folly::StringPiece data;
+};
+
+// Read given number of bytes from cursor of a single contiguous buffer
+// without copying them
+folly::StringPiece
+readRange(folly::io::Cursor& cursor, uint32_t length) {
+  if (not cursor.canAdvance(length)) {
+    throw std::out_of_range("read beyond end of buffer");
+  }
+  const auto bytes = cursor.peekBytes();
+  CHECK_GE(bytes.size(), length) << "buffer is not contiguous";
+  cursor.skip(length);
+  return folly::StringPiece(folly::ByteRange(bytes.data(), length));
+}
+
+// Decode a PersistentObject just as PersistentStore::decodePersistentObject,
+// except that key and data are not copied out of buffer
+folly::Expected<std::optional<PersistentObjectRange>, std::string>
+decodePersistentObjectRange(folly::io::Cursor& cursor) noexcept {
+  // If nothing can be read, return
+  if (not cursor.canAdvance(1)) {
+    return std::nullopt;
+  }
+
+  PersistentObjectRange pObject;
+  try {
+    pObject.type = openr::ActionType(cursor.readBE<uint8_t>());
+    pObject.key = readRange(cursor, cursor.readBE<uint32_t>());
+    pObject.data = readRange(cursor, cursor.readBE<uint32_t>());
+    return pObject;
+  } catch (std::out_of_range& e) {
+    return folly::makeUnexpected<std::string>(
+        folly::exceptionStr(e).toStdString());
+  }
+}
 
 } // anonymous namespace
 
@@ -72,18 +123,51 @@ PersistentStore::store(std::string key, std::string value) {
     key = std::move(key),
     value = std::move(value)
   ]() mutable noexcept {
-    SYSLOG(INFO) << "Store key: " << key << ", value: " << value
-                 << " to config-store";
-    // Override previous value if any
-    database_.keyVals[key] = value;
-    auto pObject = toPersistentObject(ActionType::ADD, key, value);
-    pObjects_.emplace_back(std::move(pObject));
+    storeKeyValue(key, value);
     maybeSaveObjectToDisk();
     p.setValue();
   });
   return sf;
 }
 
+folly::SemiFuture<folly::Unit>
+PersistentStore::storeBatch(
+    std::vector<std::pair<std::string, std::string>> keyVals) {
+  folly::Promise<folly::Unit> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread([
+    this,
+    p = std::move(p),
+    keyVals = std::move(keyVals)
+  ]() mutable noexcept {
+    for (const auto& kv : keyVals) {
+      storeKeyValue(kv.first, kv.second);
+    }
+    // Objects of batch are saved together
+    if (not keyVals.empty()) {
+      maybeSaveObjectToDisk();
+    }
+    p.setValue();
+  });
+  return sf;
+}
+
+void
+PersistentStore::storeKeyValue(
+    const std::string& key, const std::string& value) {
+  SYSLOG(INFO) << "Store key: " << key << ", value: " << value
+               << " to config-store";
+  // Override previous value if any
+  auto it = database_.keyVals.find(key);
+  if (it != database_.keyVals.end()) {
+    databaseSize_ -= getEncodedSize(it->first, it->second);
+  }
+  database_.keyVals[key] = value;
+  databaseSize_ += getEncodedSize(key, value);
+  auto pObject = toPersistentObject(ActionType::ADD, key, value);
+  pObjects_.emplace_back(std::move(pObject));
+}
+
 folly::SemiFuture<bool>
 PersistentStore::erase(std::string key) {
   folly::Promise<bool> p;
@@ -91,7 +175,10 @@ PersistentStore::erase(std::string key) {
   runInEventBaseThread(
       [this, p = std::move(p), key = std::move(key)]() mutable noexcept {
         SYSLOG(INFO) << "Erase key: " << key << " from config-store";
-        if (database_.keyVals.erase(key) > 0) {
+        auto it = database_.keyVals.find(key);
+        if (it != database_.keyVals.end()) {
+          databaseSize_ -= getEncodedSize(it->first, it->second);
+          database_.keyVals.erase(it);
           auto pObject = toPersistentObject(ActionType::DEL, key, "");
           pObjects_.emplace_back(std::move(pObject));
           maybeSaveObjectToDisk();
@@ -134,7 +221,13 @@ PersistentStore::maybeSaveObjectToDisk() noexcept {
 
 bool
 PersistentStore::savePersistentObjectToDisk() noexcept {
-  if (not dryrun_) {
+  if (not dryrun_ and fileSize_ == 0) {
+    // Start file with a snapshot of database, which covers new objects
+    pObjects_.clear();
+    if (not saveDatabaseToDisk()) {
+      return false;
+    }
+  } else if (not dryrun_) {
     // Write PersistentObject to ioBuf
     std::vector<PersistentObject> newObjects;
     newObjects = std::move(pObjects_);
@@ -153,6 +246,7 @@ PersistentStore::savePersistentObjectToDisk() noexcept {
 
     // Append IoBuf to disk
     auto ioBuf = queue.move();
+    const auto numBytes = ioBuf ? ioBuf->computeChainDataLength() : 0;
     auto success = writeIoBufToDisk(ioBuf, WriteType::APPEND);
     if (success.hasError()) {
       LOG(ERROR) << "Failed to write PersistentObject to file '"
@@ -161,11 +255,13 @@ PersistentStore::savePersistentObjectToDisk() noexcept {
       return false;
     }
 
-    numOfNewWritesToDisk_++;
+    fileSize_ += numBytes;
 
-    // Write the whole database to disk periodically
-    if (numOfNewWritesToDisk_ >= kDbFlushRatio) {
-      numOfNewWritesToDisk_ = 0;
+    // Compact journal into the whole database once it outgrows database
+    if (fileSize_ > std::max(
+                        kMinCompactionBytes,
+                        kCompactionRatio *
+                            (kTlvFormatMarker.size() + databaseSize_))) {
       const auto startTs = std::chrono::steady_clock::now();
       if (not saveDatabaseToDisk()) {
         return false;
@@ -214,12 +310,14 @@ PersistentStore::saveDatabaseToDisk() noexcept {
     ioBuf = queue.move();
   }
 
+  const auto numBytes = ioBuf->computeChainDataLength();
   auto success = writeIoBufToDisk(ioBuf, WriteType::WRITE);
   if (success.hasError()) {
     LOG(ERROR) << "Failed to write database to file '" << storageFilePath_
                << "'. Error: " << folly::exceptionStr(success.error());
     return false;
   }
+  fileSize_ = numBytes;
   return true;
 }
 
@@ -232,16 +330,22 @@ PersistentStore::loadDatabaseFromDisk() noexcept {
     return true;
   }
 
-  // Read data from file
-  std::string fileData{""};
-  if (not folly::readFile(storageFilePath_.c_str(), fileData)) {
-    LOG(ERROR) << "Failed to read file contents from '" << storageFilePath_
-               << "'. Error (" << errno << "): " << folly::errnoStr(errno);
+  // Map file into memory instead of reading it. Records are decoded in
+  // place, and only values of live keys are copied out
+  std::unique_ptr<folly::MemoryMapping> mapping;
+  try {
+    mapping = std::make_unique<folly::MemoryMapping>(storageFilePath_.c_str());
+  } catch (std::exception const& e) {
+    LOG(ERROR) << "Failed to map file contents from '" << storageFilePath_
+               << "'. Error: " << folly::exceptionStr(e);
     return false;
   }
+  const auto fileData = mapping->range();
+
+  fileSize_ = fileData.size();
 
   // Create IoBuf and cursor for loading data from disk
-  auto ioBuf = folly::IOBuf::wrapBuffer(fileData.c_str(), fileData.size());
+  auto ioBuf = folly::IOBuf::wrapBuffer(fileData.data(), fileData.size());
   folly::io::Cursor cursor(ioBuf.get());
 
   // Read 'kTlvFormatMarker' from ioBuf
@@ -276,6 +380,7 @@ PersistentStore::loadDatabaseOldFormat(
     thrift::StoreDatabase newDatabase;
     serializer_.deserialize(ioBuf.get(), newDatabase);
     database_ = std::move(newDatabase);
+    updateDatabaseSize();
     // Write Tlv format to disk
     saveDatabaseToDisk();
   } catch (std::exception const& e) {
@@ -290,7 +395,9 @@ PersistentStore::loadDatabaseTlvFormat(
     const std::unique_ptr<folly::IOBuf>& ioBuf) noexcept {
   // Parse ioBuf to persistentObject and then to `database_`
   folly::io::Cursor cursor(ioBuf.get());
-  thrift::StoreDatabase newDatabase;
+  // Index of latest data of each key. Journal may hold many records per key,
+  // only data of live keys is copied into database
+  folly::F14FastMap<folly::StringPiece, folly::StringPiece> index;
   // Read 'kTlvFormatMarker'
   try {
     cursor.readFixedString(kTlvFormatMarker.size());
@@ -301,7 +408,7 @@ PersistentStore::loadDatabaseTlvFormat(
   // Iteratively read persistentObject from disk
   while (true) {
     // Read and decode into persistentObject
-    auto optionalObject = decodePersistentObject(cursor);
+    auto optionalObject = decodePersistentObjectRange(cursor);
     if (optionalObject.hasError()) {
       return folly::makeUnexpected(optionalObject.error());
     }
@@ -310,17 +417,22 @@ PersistentStore::loadDatabaseTlvFormat(
     if (not optionalObject->has_value()) {
       break;
     }
-    auto pObject = std::move(optionalObject->value());
+    const auto& pObject = optionalObject->value();
 
-    // Add/Delete persistentObject to/from 'newDatabase'
+    // Add/Delete persistentObject to/from 'index'
     if (pObject.type == ActionType::ADD) {
-      newDatabase.keyVals[pObject.key] =
-          pObject.data.has_value() ? pObject.data.value() : "";
+      index[pObject.key] = pObject.data;
     } else if (pObject.type == ActionType::DEL) {
-      newDatabase.keyVals.erase(pObject.key);
+      index.erase(pObject.key);
     }
   }
+
+  thrift::StoreDatabase newDatabase;
+  for (const auto& kv : index) {
+    newDatabase.keyVals.emplace(kv.first.str(), kv.second.str());
+  }
   database_ = std::move(newDatabase);
+  updateDatabaseSize();
   return folly::Unit();
 }
 
@@ -337,12 +449,22 @@ PersistentStore::writeIoBufToDisk(
       // Write over
       folly::writeFileAtomic(storageFilePath_, fileData, 0666);
     } else {
-      // Append to file
-      folly::writeFile(
-          fileData,
-          storageFilePath_.c_str(),
-          O_WRONLY | O_APPEND | O_CREAT,
-          0666);
+      // Append to file with a single write, synced before returning
+      const int fd = folly::openNoInt(
+          storageFilePath_.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0666);
+      if (fd == -1) {
+        folly::throwSystemError("open failed");
+      }
+      SCOPE_EXIT {
+        folly::closeNoInt(fd);
+      };
+      if (folly::writeFull(fd, fileData.data(), fileData.size()) !=
+          static_cast<ssize_t>(fileData.size())) {
+        folly::throwSystemError("write failed");
+      }
+      if (folly::fsyncNoInt(fd) != 0) {
+        folly::throwSystemError("fsync failed");
+      }
     }
   } catch (std::exception const& e) {
     return folly::makeUnexpected<std::string>(
@@ -413,6 +535,21 @@ PersistentStore::decodePersistentObject(folly::io::Cursor& cursor) noexcept {
   }
 }
 
+void
+PersistentStore::updateDatabaseSize() noexcept {
+  databaseSize_ = 0;
+  for (const auto& kv : database_.keyVals) {
+    databaseSize_ += getEncodedSize(kv.first, kv.second);
+  }
+}
+
+size_t
+PersistentStore::getEncodedSize(
+    const std::string& key, const std::string& data) noexcept {
+  return sizeof(uint8_t) + sizeof(uint32_t) + key.size() + sizeof(uint32_t) +
+      data.size();
+}
+
 // Create a PersistentObject and assign value to it.
 PersistentObject
 PersistentStore::toPersistentObject(
@@ -9,6 +9,8 @@
 
 #include <chrono>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <fbzmq/async/ZmqTimeout.h>
 #include <fbzmq/zmq/Zmq.h>
@@ -83,6 +85,11 @@ class PersistentStore : public OpenrEventBase {
   // Store key-value
   folly::SemiFuture<folly::Unit> store(std::string key, std::string value);
 
+  // Store multiple key-values. All of them are appended to disk together in
+  // a single write
+  folly::SemiFuture<folly::Unit> storeBatch(
+      std::vector<std::pair<std::string, std::string>> keyVals);
+
   // Get value for a key. `nullptr` will be returned if key doesn't exists
   folly::SemiFuture<std::optional<std::string>> load(std::string key);
 
@@ -131,6 +138,9 @@ class PersistentStore : public OpenrEventBase {
   folly::Expected<folly::Unit, std::string> loadDatabaseTlvFormat(
       const std::unique_ptr<folly::IOBuf>& ioBuf) noexcept;
 
+  // Update key-value in database_ and queue PersistentObject for disk
+  void storeKeyValue(const std::string& key, const std::string& value);
+
   // Wrapper function to save persistent object to disk immediately or later
   void maybeSaveObjectToDisk() noexcept;
 
@@ -141,6 +151,13 @@ class PersistentStore : public OpenrEventBase {
   folly::Expected<folly::Unit, std::string> writeIoBufToDisk(
       const std::unique_ptr<folly::IOBuf>& ioBuf, WriteType writeType) noexcept;
 
+  // Recompute databaseSize_ from database_
+  void updateDatabaseSize() noexcept;
+
+  // Size of encoded PersistentObject adding given key-value
+  static size_t getEncodedSize(
+      const std::string& key, const std::string& data) noexcept;
+
   // Function to create a PersistentObject.
   PersistentObject toPersistentObject(
       const ActionType type, const std::string& key, const std::string& data);
@@ -148,8 +165,12 @@ class PersistentStore : public OpenrEventBase {
   // Keeps track of number of writes of Database to disk
   std::atomic<std::uint64_t> numOfWritesToDisk_{0};
 
-  // Keeps track of number of writes of PersistentObject to disk
-  std::atomic<std::uint64_t> numOfNewWritesToDisk_{0};
+  // Size of file on disk, snapshot of database followed by journal of
+  // PersistentObjects appended since
+  uint64_t fileSize_{0};
+
+  // Size of database_ if encoded as PersistentObjects
+  uint64_t databaseSize_{0};
 
   // Location on disk where data will be synced up. A file will be created
   // if doesn't exists.
@@ -5,15 +5,28 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
 #include <folly/Benchmark.h>
+#include <folly/FileUtil.h>
 #include <folly/Random.h>
 #include <folly/init/Init.h>
+#include <folly/io/IOBufQueue.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <openr/common/tests/BenchmarkUtils.h>
 #include <openr/config-store/PersistentStoreWrapper.h>
 
 namespace {
 // kIterations <= n: change this to 10 singce n starts from 10,
 // n is in BENCHMARK_PARAM(BM_PersistentStoreWrite, n)
 uint32_t kIterations = 10;
+
+// Size of values written by file size and startup benchmarks
+const size_t kValueSize = 100;
 } // namespace
 
 namespace openr {
@@ -127,6 +140,184 @@ BM_PersistentStoreLoad(uint32_t iters, size_t numOfStringKeys) {
   eraseKeyFromStore(stringKeys, *store);
 }
 
+/**
+ * Size of file on disk, 0 if it doesn't exist
+ */
+static size_t
+getFileSize(const std::string& filePath) {
+  struct stat st;
+  if (::stat(filePath.c_str(), &st) != 0) {
+    return 0;
+  }
+  return st.st_size;
+}
+
+/**
+ * Write a database of numOfStringKeys keys to file directly, in old format or
+ * in TLV format. TLV format file is followed by a journal of numOfOverwrites
+ * values overwriting random keys.
+ */
+static void
+writeDatabaseFile(
+    const std::string& filePath,
+    size_t numOfStringKeys,
+    size_t numOfOverwrites,
+    bool oldFormat) {
+  auto stringKeys = constructRandomVector(numOfStringKeys);
+  std::string fileData;
+
+  if (oldFormat) {
+    thrift::StoreDatabase database;
+    for (const auto& key : stringKeys) {
+      database.keyVals[key] = std::string(kValueSize, 'v');
+    }
+    apache::thrift::CompactSerializer serializer;
+    serializer.serialize(database, &fileData);
+    CHECK(folly::writeFile(fileData, filePath.c_str()));
+    return;
+  }
+
+  auto queue = folly::IOBufQueue(folly::IOBufQueue::cacheChainLength());
+  queue.append(kTlvFormatMarker.data(), kTlvFormatMarker.size());
+  auto appendObject = [&queue](const std::string& key) {
+    PersistentObject pObject;
+    pObject.type = ActionType::ADD;
+    pObject.key = key;
+    pObject.data = std::string(kValueSize, 'v');
+    queue.append(std::move(*PersistentStore::encodePersistentObject(pObject)));
+  };
+  for (const auto& key : stringKeys) {
+    appendObject(key);
+  }
+  for (size_t i = 0; i < numOfOverwrites; ++i) {
+    appendObject(stringKeys[folly::Random::rand32(stringKeys.size())]);
+  }
+  auto ioBuf = queue.move();
+  ioBuf->coalesce();
+  CHECK(folly::writeFile(ioBuf->moveToFbString(), filePath.c_str()));
+}
+
+/**
+ * Benchmark for erasing keys from store
+ * 1. Generate random keys
+ * 2. Write keys to store
+ * 3. Erase keys
+ */
+void
+BM_PersistentStoreErase(uint32_t iters, size_t numOfStringKeys) {
+  auto suspender = folly::BenchmarkSuspender();
+  fbzmq::Context context;
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+  // Create new storeWrapper and perform some operations on it
+  auto store = std::make_unique<PersistentStoreWrapper>(context, tid);
+  store->run();
+
+  auto stringKeys = constructRandomVector(numOfStringKeys);
+  for (uint32_t i = 0; i < iters; i++) {
+    writeKeyValueToStore(stringKeys, *store, 1);
+
+    suspender.dismiss(); // Start measuring benchmark time
+    eraseKeyFromStore(stringKeys, *store);
+    suspender.rehire(); // Stop measuring time again
+  }
+}
+
+/**
+ * Benchmark for file size evolution while keys are overwritten
+ * 1. Write numOfStringKeys keys to a store saving every write to disk
+ * 2. Overwrite random keys numOfOverwrites times
+ * Reports bytes written to disk as well as maximum and final file size
+ */
+static void
+BM_PersistentStoreFileSize(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numOfStringKeys,
+    size_t numOfOverwrites) {
+  auto suspender = folly::BenchmarkSuspender();
+  fbzmq::Context context;
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  const auto filePath =
+      folly::sformat("/tmp/aq_persistent_store_benchmark_{}", tid);
+  auto stringKeys = constructRandomVector(numOfStringKeys);
+
+  for (uint32_t i = 0; i < iters; i++) {
+    std::remove(filePath.c_str());
+    auto store = std::make_unique<PersistentStore>(
+        "1", filePath, context, false /* dryrun */, false /* periodic */);
+    std::thread storeThread([&store]() { store->run(); });
+    store->waitUntilRunning();
+    for (const auto& key : stringKeys) {
+      store->store(key, std::string(kValueSize, 'v')).get();
+    }
+
+    suspender.dismiss(); // Start measuring benchmark time
+    size_t bytesWritten{0};
+    size_t maxFileSize{0};
+    size_t prevFileSize = getFileSize(filePath);
+    for (size_t j = 0; j < numOfOverwrites; j++) {
+      store
+          ->store(
+              stringKeys[folly::Random::rand32(stringKeys.size())],
+              std::string(kValueSize, 'v'))
+          .get();
+
+      suspender.rehire();
+      // Appended records grow file, while compaction rewrites it all. Bytes
+      // written are approximated from file size
+      const auto fileSize = getFileSize(filePath);
+      bytesWritten +=
+          fileSize > prevFileSize ? fileSize - prevFileSize : fileSize;
+      maxFileSize = std::max(maxFileSize, fileSize);
+      prevFileSize = fileSize;
+      suspender.dismiss();
+    }
+    suspender.rehire(); // Stop measuring time again
+
+    counters["bytes_written"] = bytesWritten;
+    counters["max_file_bytes"] = maxFileSize;
+    counters["file_bytes"] = prevFileSize;
+
+    store->stop();
+    storeThread.join();
+    store.reset();
+  }
+  std::remove(filePath.c_str());
+}
+
+/**
+ * Benchmark for startup of a store, loading its database from disk
+ * 1. Write database file in old or TLV format, with a journal of overwrites
+ * 2. Create store, loading the file
+ */
+static void
+BM_PersistentStoreStartup(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numOfStringKeys,
+    size_t numOfOverwrites,
+    bool oldFormat) {
+  auto suspender = folly::BenchmarkSuspender();
+  fbzmq::Context context;
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  const auto filePath =
+      folly::sformat("/tmp/aq_persistent_store_benchmark_{}", tid);
+
+  for (uint32_t i = 0; i < iters; i++) {
+    // Old format file is converted on load, so write it every time
+    writeDatabaseFile(filePath, numOfStringKeys, numOfOverwrites, oldFormat);
+    counters["file_bytes"] = getFileSize(filePath);
+
+    suspender.dismiss(); // Start measuring benchmark time
+    auto store = std::make_unique<PersistentStore>("1", filePath, context);
+    suspender.rehire(); // Stop measuring time again
+
+    store.reset();
+  }
+  std::remove(filePath.c_str());
+}
+
 /**
  * Benchmark for Creating/Destroing a store
  * 1. Generate random keys
@@ -176,6 +367,37 @@ BENCHMARK_PARAM(BM_PersistentStoreCreateDestroy, 100);
 BENCHMARK_PARAM(BM_PersistentStoreCreateDestroy, 1000);
 BENCHMARK_PARAM(BM_PersistentStoreCreateDestroy, 10000);
 
+BENCHMARK_PARAM(BM_PersistentStoreErase, 10);
+BENCHMARK_PARAM(BM_PersistentStoreErase, 100);
+BENCHMARK_PARAM(BM_PersistentStoreErase, 1000);
+
+// The parameters are number of keys and number of overwrites of random keys
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreFileSize, counters, 100_10000, 100, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreFileSize, counters, 1000_10000, 1000, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreFileSize, counters, 10000_10000, 10000, 10000);
+
+// The parameters are number of keys, number of overwrites of random keys
+// journaled after them and whether file is in old format
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreStartup, counters, 1000_0_old, 1000, 0, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreStartup, counters, 1000_0_tlv, 1000, 0, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreStartup, counters, 1000_10000_tlv, 1000, 10000, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreStartup, counters, 10000_0_old, 10000, 0, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreStartup, counters, 10000_0_tlv, 10000, 0, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreStartup, counters, 10000_10000_tlv, 10000, 10000, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreStartup, counters, 100000_0_old, 100000, 0, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreStartup, counters, 100000_0_tlv, 100000, 0, false);
+
 } // namespace openr
 
 int
@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <cstdio>
 #include <thread>
 #include <utility>
 
@@ -218,6 +219,100 @@ TEST(PersistentStoreTest, BulkStoreLoad) {
   }
 }
 
+TEST(PersistentStoreTest, StoreBatch) {
+  fbzmq::Context context;
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  const auto filePath =
+      folly::sformat("/tmp/aq_persistent_store_batch_test_{}", tid);
+  std::remove(filePath.c_str());
+
+  thrift::StoreDatabase database;
+  std::vector<std::pair<std::string, std::string>> keyVals;
+  for (auto index = 0; index < 10; index++) {
+    keyVals.emplace_back(
+        folly::sformat("key-{}", index),
+        folly::sformat("val-{}", folly::Random::rand32()));
+    database.keyVals[keyVals.back().first] = keyVals.back().second;
+  }
+
+  {
+    // Save objects to disk as soon as they are stored
+    auto store = std::make_unique<PersistentStore>(
+        "1", filePath, context, false /* dryrun */, false /* periodic */);
+    std::thread storeThread([&store]() { store->run(); });
+    store->waitUntilRunning();
+
+    // Empty batch doesn't write anything
+    store->storeBatch({}).get();
+    EXPECT_EQ(0, store->getNumOfDbWritesToDisk());
+
+    // Whole batch is saved to disk with a single write
+    store->storeBatch(keyVals).get();
+    EXPECT_EQ(1, store->getNumOfDbWritesToDisk());
+    EXPECT_EQ(database, loadDatabaseFromDisk(filePath));
+
+    // Overwrite some of keys in another batch, appended to journal
+    keyVals.resize(3);
+    for (auto& kv : keyVals) {
+      kv.second = "new-" + kv.second;
+      database.keyVals[kv.first] = kv.second;
+    }
+    store->storeBatch(keyVals).get();
+    EXPECT_EQ(2, store->getNumOfDbWritesToDisk());
+    EXPECT_EQ(database, loadDatabaseFromDisk(filePath));
+    for (const auto& kv : keyVals) {
+      EXPECT_EQ(kv.second, store->load(kv.first).get());
+    }
+
+    store->stop();
+    storeThread.join();
+  }
+
+  std::remove(filePath.c_str());
+}
+
+TEST(PersistentStoreTest, JournalCompaction) {
+  fbzmq::Context context;
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  const auto filePath =
+      folly::sformat("/tmp/aq_persistent_store_compaction_test_{}", tid);
+  std::remove(filePath.c_str());
+
+  // Journal is compacted once it grows beyond 1MB for a small database
+  const size_t kMaxFileSize = 1024 * 1024 + 1024;
+  const std::string value(512, 'v');
+  {
+    PersistentStore store(
+        "1", filePath, context, false /* dryrun */, false /* periodic */);
+    std::thread storeThread([&store]() { store.run(); });
+    store.waitUntilRunning();
+
+    // Overwrite same key well beyond max file size
+    size_t numBytesStored{0};
+    for (int i = 0; numBytesStored < 4 * kMaxFileSize; ++i) {
+      const auto val = folly::sformat("{}-{}", value, i);
+      store.store("key", val).get();
+      numBytesStored += val.size();
+      if (i % 100) {
+        continue;
+      }
+
+      // File stays bounded and holds latest value
+      std::string fileData;
+      ASSERT_TRUE(folly::readFile(filePath.c_str(), fileData));
+      EXPECT_GE(kMaxFileSize, fileData.size());
+
+      thrift::StoreDatabase database;
+      database.keyVals["key"] = val;
+      EXPECT_EQ(database, loadDatabaseFromDisk(filePath));
+    }
+
+    store.stop();
+    storeThread.join();
+  }
+  std::remove(filePath.c_str());
+}
+
 } // namespace openr
 
 int
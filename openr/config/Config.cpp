@@ -1,8 +1,12 @@
 // Copyright 2004-present Facebook. All Rights Reserved.
 
+#include <stdexcept>
+
 #include <folly/FileUtil.h>
+#include <folly/IPAddress.h>
 #include <glog/logging.h>
 #include <openr/if/gen-cpp2/KvStore_constants.h>
+#include <re2/re2.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include "Config.h"
@@ -38,6 +42,98 @@ Config::getRunningConfig() const {
   return contents;
 }
 
+namespace {
+
+void
+checkRegexes(
+    const std::string& areaId, const std::vector<std::string>& regexes) {
+  for (const auto& regexStr : regexes) {
+    re2::RE2 regex(regexStr);
+    if (not regex.ok()) {
+      throw std::invalid_argument(folly::sformat(
+          "Invalid regex {} of area {}: {}", regexStr, areaId, regex.error()));
+    }
+  }
+}
+
+} // namespace
+
+void
+Config::checkReloadable(const thrift::OpenrConfig& newConfig) const {
+  // reloadable fields of newConfig are validated and then reset to their
+  // running values, anything else left over is a structural change
+  auto config = newConfig;
+
+  // areas themselves are structural, only their regexes may change
+  if (config.areas.size() != config_.areas.size()) {
+    throw std::invalid_argument("Areas can't be added or removed on reload");
+  }
+  for (size_t i = 0; i < config.areas.size(); ++i) {
+    auto& area = config.areas[i];
+    const auto& runningArea = config_.areas[i];
+    if (area.area_id != runningArea.area_id) {
+      throw std::invalid_argument(folly::sformat(
+          "Area {} can't be replaced by area {} on reload",
+          runningArea.area_id,
+          area.area_id));
+    }
+    if (area.neighbor_regexes == runningArea.neighbor_regexes and
+        area.interface_regexes == runningArea.interface_regexes) {
+      continue;
+    }
+    if (area.neighbor_regexes.empty() and area.interface_regexes.empty()) {
+      throw std::invalid_argument(folly::sformat(
+          "Area {} needs neighbor or interface regexes", area.area_id));
+    }
+    checkRegexes(area.area_id, area.neighbor_regexes);
+    checkRegexes(area.area_id, area.interface_regexes);
+    area.neighbor_regexes = runningArea.neighbor_regexes;
+    area.interface_regexes = runningArea.interface_regexes;
+  }
+
+  // flood rate can be tuned, but not turned on or off
+  auto& kvConf = config.kvstore_config;
+  const auto& runningKvConf = config_.kvstore_config;
+  if (kvConf.flood_rate_ref().has_value() !=
+      runningKvConf.flood_rate_ref().has_value()) {
+    throw std::invalid_argument(
+        "Kvstore flood rate can't be enabled or disabled on reload");
+  }
+  if (const auto& floodRate = kvConf.flood_rate_ref()) {
+    if (floodRate->flood_msg_per_sec <= 0 or
+        floodRate->flood_msg_burst_size <= 0) {
+      throw std::invalid_argument(
+          "Kvstore flood_msg_per_sec and flood_msg_burst_size should be > 0");
+    }
+  }
+  kvConf.flood_rate_ref().copy_from(runningKvConf.flood_rate_ref());
+  kvConf.set_leaf_node_ref().copy_from(runningKvConf.set_leaf_node_ref());
+  kvConf.key_prefix_filters_ref().copy_from(
+      runningKvConf.key_prefix_filters_ref());
+  kvConf.key_originator_id_filters_ref().copy_from(
+      runningKvConf.key_originator_id_filters_ref());
+
+  // decision debounce
+  const auto debounceMin = config.decision_debounce_min_ms_ref().value_or(0);
+  const auto debounceMax = config.decision_debounce_max_ms_ref().value_or(0);
+  if (config.decision_debounce_min_ms_ref().has_value() !=
+          config.decision_debounce_max_ms_ref().has_value() or
+      debounceMin < 0 or debounceMin > debounceMax) {
+    throw std::invalid_argument(
+        "Decision debounce needs both 0 <= min <= max to be set");
+  }
+  config.decision_debounce_min_ms_ref().copy_from(
+      config_.decision_debounce_min_ms_ref());
+  config.decision_debounce_max_ms_ref().copy_from(
+      config_.decision_debounce_max_ms_ref());
+
+  if (config != config_) {
+    throw std::invalid_argument(
+        "Config changes other than area regexes, kvstore key filters and "
+        "flood rate, and decision debounce timers require restart");
+  }
+}
+
 void
 Config::populateInternalDb() {
   // areas
@@ -52,6 +148,11 @@ Config::populateInternalDb() {
   for (const auto& area : areas) {
     CHECK(areaIds_.emplace(area.area_id).second)
         << folly::sformat("Duplicate area config: area_id {}", area.area_id);
+    for (const auto& summary : area.summary_prefixes) {
+      CHECK(folly::IPAddress::tryCreateNetwork(summary).hasValue())
+          << folly::sformat(
+                 "Invalid summary prefix {} of area {}", summary, area.area_id);
+    }
   }
 
   // Kvstore
@@ -62,5 +163,14 @@ Config::populateInternalDb() {
     CHECK_GT(floodRate->flood_msg_burst_size, 0)
         << "kvstore flood_msg_burst_size should be > 0";
   }
+  if (auto sampleRate = kvConf.flood_tracing_sample_rate_ref()) {
+    CHECK_GT(*sampleRate, 0)
+        << "kvstore flood_tracing_sample_rate should be > 0";
+  }
+
+  // Decision
+  if (auto maxPrefixes = config_.decision_max_prefixes_per_node_ref()) {
+    CHECK_GT(*maxPrefixes, 0) << "decision_max_prefixes_per_node should be > 0";
+  }
 }
 } // namespace openr
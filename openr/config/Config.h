@@ -40,6 +40,12 @@ class Config {
     return areaIds_;
   }
 
+  // Check if running config can be replaced by newConfig without restart.
+  // Only neighbor and interface regexes of areas, kvstore key filters and
+  // flood rate, and decision debounce timers may differ. Throws
+  // std::invalid_argument describing the offending change otherwise
+  void checkReloadable(const thrift::OpenrConfig& newConfig) const;
+
  private:
   // thrift config
 
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <folly/Conv.h>
+#include <folly/Format.h>
+#include <folly/String.h>
 #include <folly/gen/Base.h>
 #include <folly/gen/String.h>
 
@@ -101,12 +104,30 @@ class GflagConfig final {
       thrift::KvstoreFloodRate rate;
       rate.flood_msg_per_sec = FLAGS_kvstore_flood_msg_per_sec;
       rate.flood_msg_burst_size = FLAGS_kvstore_flood_msg_burst_size;
+      if (FLAGS_kvstore_flood_rate_adaptive) {
+        rate.adaptive_ref() = true;
+      }
       kvstoreConf.flood_rate_ref() = rate;
     }
 
     kvstoreConf.key_ttl_ms = FLAGS_kvstore_key_ttl_ms;
     kvstoreConf.sync_interval_s = FLAGS_kvstore_sync_interval_s;
     kvstoreConf.ttl_decrement_ms = FLAGS_kvstore_ttl_decrement_ms;
+    if (auto v = FLAGS_kvstore_merge_threads) {
+      kvstoreConf.merge_threads_ref() = v;
+    }
+    if (auto v = FLAGS_kvstore_enable_ttl_update_batching) {
+      kvstoreConf.enable_ttl_update_batching_ref() = v;
+    }
+    if (auto v = FLAGS_kvstore_enable_value_delta_encoding) {
+      kvstoreConf.enable_value_delta_encoding_ref() = v;
+    }
+    if (not FLAGS_kvstore_key_priority_prefixes.empty()) {
+      std::vector<std::string> priorityPrefixes;
+      folly::split(
+          ",", FLAGS_kvstore_key_priority_prefixes, priorityPrefixes, true);
+      kvstoreConf.key_priority_prefixes_ref() = std::move(priorityPrefixes);
+    }
     if (FLAGS_set_leaf_node) {
       kvstoreConf.set_leaf_node_ref() = FLAGS_set_leaf_node;
       // prefix filters
@@ -127,6 +148,26 @@ class GflagConfig final {
     if (auto v = FLAGS_is_flood_root) {
       kvstoreConf.is_flood_root_ref() = v;
     }
+    if (auto v = FLAGS_enable_flood_root_load_balancing) {
+      kvstoreConf.enable_flood_root_load_balancing_ref() = v;
+    }
+    if (not FLAGS_kvstore_snapshot_filepath.empty()) {
+      kvstoreConf.snapshot_filepath_ref() = FLAGS_kvstore_snapshot_filepath;
+      kvstoreConf.snapshot_interval_s_ref() = FLAGS_kvstore_snapshot_interval_s;
+    }
+    if (auto v = FLAGS_kvstore_enable_thrift_flooding) {
+      kvstoreConf.enable_thrift_flooding_ref() = v;
+    }
+    if (auto v = FLAGS_kvstore_enable_compact_flood_path) {
+      kvstoreConf.enable_compact_flood_path_ref() = v;
+    }
+    if (auto v = FLAGS_kvstore_enable_flood_tracing) {
+      kvstoreConf.enable_flood_tracing_ref() = v;
+    }
+    if (FLAGS_kvstore_flood_tracing_sample_rate != 1) {
+      kvstoreConf.flood_tracing_sample_rate_ref() =
+          FLAGS_kvstore_flood_tracing_sample_rate;
+    }
 
     // LinkMonitor
     auto& lmConf = config.link_monitor_config;
@@ -151,6 +192,16 @@ class GflagConfig final {
     sparkConf.keepalive_time_s = FLAGS_spark2_heartbeat_time_s;
     sparkConf.hold_time_s = FLAGS_spark2_heartbeat_hold_time_s;
     sparkConf.graceful_restart_time_s = FLAGS_spark_hold_time_s;
+    sparkConf.compact_heartbeat = FLAGS_spark2_compact_heartbeat;
+    sparkConf.compact_hello = FLAGS_spark2_compact_hello;
+    sparkConf.enable_adaptive_heartbeat =
+        FLAGS_spark2_enable_adaptive_heartbeat;
+    sparkConf.adaptive_heartbeat_time_ms =
+        FLAGS_spark2_adaptive_heartbeat_time_ms;
+    sparkConf.adaptive_heartbeat_hold_time_ms =
+        FLAGS_spark2_adaptive_heartbeat_hold_time_ms;
+    sparkConf.enable_io_thread = FLAGS_spark2_enable_io_thread;
+    sparkConf.enable_hw_timestamping = FLAGS_spark2_enable_hw_timestamping;
 
     // Watchdog
     if (FLAGS_enable_watchdog) {
@@ -182,6 +233,66 @@ class GflagConfig final {
       config.enable_ordered_fib_programming_ref() = v;
     }
 
+    if (auto v = FLAGS_decision_lfa_spf_threads) {
+      config.decision_lfa_spf_threads_ref() = v;
+    }
+
+    if (auto v = FLAGS_decision_area_threads) {
+      config.decision_area_threads_ref() = v;
+    }
+
+    if (auto v = FLAGS_decision_max_prefixes_per_node) {
+      config.decision_max_prefixes_per_node_ref() = v;
+    }
+
+    if (FLAGS_decision_prefix_limit_ignore_all) {
+      config.decision_prefix_limit_action =
+          thrift::PrefixLimitAction::IGNORE_ALL;
+    }
+
+    if (auto v = FLAGS_fib_route_programming_window) {
+      config.fib_route_programming_window_ref() = v;
+    }
+
+    if (auto v = FLAGS_enable_fib_route_priority) {
+      config.enable_fib_route_priority_ref() = v;
+    }
+
+    if (auto v = FLAGS_fib_perf_event_sample_rate) {
+      config.fib_perf_event_sample_rate_ref() = v;
+    }
+
+    if (auto v = FLAGS_enable_fib_chunked_sync) {
+      config.enable_fib_chunked_sync_ref() = v;
+    }
+
+    if (auto v = FLAGS_enable_fib_warm_sync) {
+      config.enable_fib_warm_sync_ref() = v;
+    }
+
+    if (auto v = FLAGS_enable_decision_background_computation) {
+      config.enable_decision_background_computation_ref() = v;
+    }
+
+    config.decision_debounce_min_ms_ref() = FLAGS_decision_debounce_min_ms;
+    config.decision_debounce_max_ms_ref() = FLAGS_decision_debounce_max_ms;
+
+    std::map<std::string, thrift::ThreadSchedulingConfig> threadConfigs;
+    for (auto const& entry : splitThreadValues(FLAGS_thread_cpu_affinity)) {
+      folly::splitTo<int32_t>(
+          ",",
+          entry.second,
+          std::back_inserter(threadConfigs[entry.first].cpus),
+          true);
+    }
+    for (auto const& entry : splitThreadValues(FLAGS_thread_nice)) {
+      threadConfigs[entry.first].nice_ref() =
+          folly::to<int32_t>(entry.second);
+    }
+    if (not threadConfigs.empty()) {
+      config.thread_scheduling_config_ref() = std::move(threadConfigs);
+    }
+
     // SPR
     if (FLAGS_enable_plugin) {
       config.enable_spr_ref() = FLAGS_enable_plugin;
@@ -193,6 +304,23 @@ class GflagConfig final {
     return std::make_shared<Config>(config);
   }
 
+  // Split semicolon separated <thread>=<value> entries of flag
+  static std::vector<std::pair<std::string, std::string>>
+  splitThreadValues(const std::string& flag) {
+    std::vector<folly::StringPiece> entries;
+    folly::split(";", flag, entries, true);
+    std::vector<std::pair<std::string, std::string>> threadValues;
+    for (auto const& entry : entries) {
+      folly::StringPiece name, value;
+      if (not folly::split('=', entry, name, value)) {
+        throw std::invalid_argument(
+            folly::sformat("Invalid thread entry '{}' in flag", entry));
+      }
+      threadValues.emplace_back(name.str(), value.str());
+    }
+    return threadValues;
+  }
+
   // Generate Bgp configuration based on input arguments
   static thrift::BgpConfig
   getBgpArgConfig() {
@@ -74,4 +74,87 @@ TEST_F(ConfigTestFixture, getBgpAutoConfig) {
   }
 }
 
+TEST_F(ConfigTestFixture, ThreadSchedulingFromGflag) {
+  FLAGS_thread_cpu_affinity = "Spark=2,3;Fib=4";
+  FLAGS_thread_nice = "Spark=-10";
+  auto config = GflagConfig::createConfigFromGflag();
+  auto const& threadConfigs =
+      config->getConfig().thread_scheduling_config_ref();
+  ASSERT_TRUE(threadConfigs.has_value());
+  EXPECT_EQ(2, threadConfigs->size());
+  EXPECT_EQ(std::vector<int32_t>({2, 3}), threadConfigs->at("Spark").cpus);
+  EXPECT_EQ(-10, threadConfigs->at("Spark").nice_ref().value_or(0));
+  EXPECT_EQ(std::vector<int32_t>({4}), threadConfigs->at("Fib").cpus);
+  EXPECT_FALSE(threadConfigs->at("Fib").nice_ref().has_value());
+
+  // entry without thread name is rejected
+  FLAGS_thread_nice = "-10";
+  EXPECT_THROW(GflagConfig::createConfigFromGflag(), std::invalid_argument);
+
+  FLAGS_thread_cpu_affinity = "";
+  FLAGS_thread_nice = "";
+}
+
+TEST_F(ConfigTestFixture, CheckReloadable) {
+  thrift::AreaConfig area;
+  area.area_id = "area1";
+  area.neighbor_regexes.emplace_back("rsw.*");
+  validConfig_.areas.emplace_back(area);
+  validConfig_.decision_debounce_min_ms_ref() = 10;
+  validConfig_.decision_debounce_max_ms_ref() = 250;
+  const Config config(validConfig_);
+  EXPECT_NO_THROW(config.checkReloadable(validConfig_));
+
+  // tuning of regexes, filters, flood rate and timers
+  {
+    auto newConfig = validConfig_;
+    newConfig.areas.at(0).neighbor_regexes = {"fsw.*", "rsw.*"};
+    newConfig.areas.at(0).interface_regexes = {"po.*"};
+    newConfig.kvstore_config.set_leaf_node_ref() = true;
+    newConfig.kvstore_config.key_prefix_filters_ref() =
+        std::vector<std::string>{"adj:"};
+    newConfig.decision_debounce_min_ms_ref() = 50;
+    newConfig.decision_debounce_max_ms_ref() = 1000;
+    EXPECT_NO_THROW(config.checkReloadable(newConfig));
+  }
+
+  // areas can't come or go, and need valid regexes
+  {
+    auto newConfig = validConfig_;
+    newConfig.areas.emplace_back(area);
+    EXPECT_THROW(config.checkReloadable(newConfig), std::invalid_argument);
+    newConfig.areas.pop_back();
+    newConfig.areas.at(0).area_id = "area2";
+    EXPECT_THROW(config.checkReloadable(newConfig), std::invalid_argument);
+    newConfig.areas.at(0).area_id = "area1";
+    newConfig.areas.at(0).neighbor_regexes = {"rsw["};
+    EXPECT_THROW(config.checkReloadable(newConfig), std::invalid_argument);
+    newConfig.areas.at(0).neighbor_regexes.clear();
+    EXPECT_THROW(config.checkReloadable(newConfig), std::invalid_argument);
+  }
+
+  // flood rate can't be turned on, timers need to be consistent
+  {
+    auto newConfig = validConfig_;
+    thrift::KvstoreFloodRate floodRate;
+    floodRate.flood_msg_per_sec = 100;
+    floodRate.flood_msg_burst_size = 10;
+    newConfig.kvstore_config.flood_rate_ref() = floodRate;
+    EXPECT_THROW(config.checkReloadable(newConfig), std::invalid_argument);
+    newConfig = validConfig_;
+    newConfig.decision_debounce_min_ms_ref() = 2000;
+    EXPECT_THROW(config.checkReloadable(newConfig), std::invalid_argument);
+  }
+
+  // anything else requires restart
+  {
+    auto newConfig = validConfig_;
+    newConfig.domain = "other";
+    EXPECT_THROW(config.checkReloadable(newConfig), std::invalid_argument);
+    newConfig = validConfig_;
+    newConfig.kvstore_config.sync_interval_s = 5;
+    EXPECT_THROW(config.checkReloadable(newConfig), std::invalid_argument);
+  }
+}
+
 } // namespace openr
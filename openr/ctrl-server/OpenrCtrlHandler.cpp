@@ -10,11 +10,16 @@
 #include <re2/re2.h>
 
 #include <folly/ExceptionString.h>
+#include <folly/String.h>
 #include <folly/io/async/SSLContext.h>
 #include <folly/io/async/ssl/OpenSSLUtils.h>
+#include <folly/system/ThreadName.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 
 #include <openr/common/Constants.h>
+#include <openr/common/CpuProfiler.h>
+#include <openr/common/ThriftUtil.h>
 #include <openr/common/Util.h>
 #include <openr/config-store/PersistentStore.h>
 #include <openr/decision/Decision.h>
@@ -26,6 +31,36 @@
 
 namespace openr {
 
+namespace {
+
+// Key-values and expired keys of publication matching filters of subscriber.
+// Returns none if nothing matches.
+std::optional<thrift::Publication>
+filterPublication(
+    thrift::Publication const& publication, KvStoreFilters const& filters) {
+  thrift::Publication filteredPublication;
+  if (publication.area_ref().has_value()) {
+    filteredPublication.area_ref() = publication.area_ref().value();
+  }
+  for (auto const& kv : publication.keyVals) {
+    if (filters.keyMatch(kv.first, kv.second)) {
+      filteredPublication.keyVals.emplace(kv);
+    }
+  }
+  for (auto const& key : publication.expiredKeys) {
+    if (filters.keyPrefixMatch(key)) {
+      filteredPublication.expiredKeys.emplace_back(key);
+    }
+  }
+  if (filteredPublication.keyVals.empty() and
+      filteredPublication.expiredKeys.empty()) {
+    return std::nullopt;
+  }
+  return filteredPublication;
+}
+
+} // namespace
+
 OpenrCtrlHandler::OpenrCtrlHandler(
     const std::string& nodeName,
     const std::unordered_set<std::string>& acceptablePeerCommonNames,
@@ -38,16 +73,19 @@ OpenrCtrlHandler::OpenrCtrlHandler(
     PrefixManager* prefixManager,
     std::shared_ptr<const Config> config,
     MonitorSubmitUrl const& monitorSubmitUrl,
-    fbzmq::Context& context)
+    fbzmq::Context& context,
+    Spark* spark)
     : facebook::fb303::BaseService("openr"),
       nodeName_(nodeName),
       acceptablePeerCommonNames_(acceptablePeerCommonNames),
+      ctrlEvb_(ctrlEvb),
       decision_(decision),
       fib_(fib),
       kvStore_(kvStore),
       linkMonitor_(linkMonitor),
       configStore_(configStore),
       prefixManager_(prefixManager),
+      spark_(spark),
       config_(config) {
   // Create monitor client
   zmqMonitorClient_ =
@@ -68,15 +106,37 @@ OpenrCtrlHandler::OpenrCtrlHandler(
           break;
         }
 
-        SYNCHRONIZED(kvStorePublishers_) {
-          for (auto& kv : kvStorePublishers_) {
-            kv.second.next(maybePublication.value());
+        // Take references of subscribers and feed them outside of lock, so
+        // that subscribing or unsubscribing doesn't wait for filtering
+        std::vector<std::shared_ptr<KvStoreSubscriber>> subscribers;
+        kvStorePublishers_.withRLock([&](auto const& kvStorePublishers) {
+          subscribers.reserve(kvStorePublishers.size());
+          for (auto const& kv : kvStorePublishers) {
+            subscribers.emplace_back(kv.second);
+          }
+        });
+
+        auto const& publication = *maybePublication.value();
+        const std::string area = publication.area_ref().value_or(
+            thrift::KvStore_constants::kDefaultArea());
+        for (auto& subscriber : subscribers) {
+          if (subscriber->area.has_value() and *subscriber->area != area) {
+            continue;
+          }
+          if (not subscriber->filters.has_value()) {
+            publish(*subscriber, publication);
+            continue;
+          }
+          auto filteredPublication =
+              filterPublication(publication, *subscriber->filters);
+          if (filteredPublication.has_value()) {
+            publish(*subscriber, std::move(*filteredPublication));
           }
         }
 
         bool isAdjChanged = false;
         // check if any of KeyVal has 'adj' update
-        for (auto& kv : maybePublication.value().keyVals) {
+        for (auto& kv : maybePublication.value()->keyVals) {
           auto& key = kv.first;
           auto& val = kv.second;
           // check if we have any value update.
@@ -92,50 +152,120 @@ OpenrCtrlHandler::OpenrCtrlHandler(
             break;
           }
         }
+        // expiry of "adj:*" key is a change as well
+        for (auto const& key : maybePublication.value()->expiredKeys) {
+          if (isAdjChanged) {
+            break;
+          }
+          if (key.find(Constants::kAdjDbMarker.toString()) == 0) {
+            VLOG(3) << "Adj key: " << key << " expiry received";
+            isAdjChanged = true;
+          }
+        }
+
+        // Only pending requests of publication area are looked at. Nobody
+        // has seen generation of an area without entry, no need to bump it.
+        longPollReqs_.withWLock([&](auto& longPollReqs) {
+          auto it = longPollReqs.find(area);
+          if (it == longPollReqs.end()) {
+            return;
+          }
+          auto& areaReqs = it->second;
 
-        if (isAdjChanged) {
-          // thrift::Publication contains "adj:*" key change.
-          // Clean ALL pending promises
-          longPollReqs_.withWLock([&](auto& longPollReqs) {
-            for (auto& kv : longPollReqs) {
+          if (isAdjChanged) {
+            // thrift::Publication contains "adj:*" key change.
+            // Clean ALL pending promises of area
+            ++areaReqs.generation;
+            for (auto& kv : areaReqs.reqs) {
               auto& p = kv.second.first;
-              p.setValue(true);
-            }
-            longPollReqs.clear();
-          });
-        } else {
-          longPollReqs_.withWLock([&](auto& longPollReqs) {
-            auto now = getUnixTimeStampMs();
-            std::vector<int64_t> reqsToClean;
-            for (auto& kv : longPollReqs) {
-              auto& clientId = kv.first;
-              auto& req = kv.second;
-
-              auto& p = req.first;
-              auto& timeStamp = req.second;
-              if (now - timeStamp >= Constants::kLongPollReqHoldTime.count()) {
-                LOG(INFO) << "Elapsed time: " << now - timeStamp
-                          << " is over hold limit: "
-                          << Constants::kLongPollReqHoldTime.count();
-                reqsToClean.emplace_back(clientId);
-                p.setValue(false);
-              }
+              p.setValue(areaReqs.generation);
             }
+            areaReqs.reqs.clear();
+            return;
+          }
 
-            // cleanup expired requests since no ADJ change observed
-            for (auto& clientId : reqsToClean) {
-              longPollReqs.erase(clientId);
+          auto now = getUnixTimeStampMs();
+          std::vector<int64_t> reqsToClean;
+          for (auto& kv : areaReqs.reqs) {
+            auto& clientId = kv.first;
+            auto& req = kv.second;
+
+            auto& p = req.first;
+            auto& timeStamp = req.second;
+            if (now - timeStamp >= Constants::kLongPollReqHoldTime.count()) {
+              LOG(INFO) << "Elapsed time: " << now - timeStamp
+                        << " is over hold limit: "
+                        << Constants::kLongPollReqHoldTime.count();
+              reqsToClean.emplace_back(clientId);
+              p.setValue(areaReqs.generation);
             }
-          });
-        }
+          }
+
+          // cleanup expired requests since no ADJ change observed
+          for (auto& clientId : reqsToClean) {
+            areaReqs.reqs.erase(clientId);
+          }
+        });
       }
     });
   }
+
+  // Add fiber task to receive route updates from Fib
+  if (fib_) {
+    fibTaskFuture_ = ctrlEvb->addFiberTaskFuture(
+        [q = fib_->getFibUpdatesReader(), this]() mutable noexcept {
+          LOG(INFO) << "Starting Fib updates processing fiber";
+          while (true) {
+            auto maybeDelta = q.get(); // perform read
+            VLOG(2) << "Received route update from Fib";
+            if (maybeDelta.hasError()) {
+              LOG(INFO) << "Terminating Fib updates processing fiber";
+              break;
+            }
+
+            std::vector<std::shared_ptr<FibSubscriber>> subscribers;
+            fibPublishers_.withRLock([&](auto const& fibPublishers) {
+              subscribers.reserve(fibPublishers.size());
+              for (auto const& kv : fibPublishers) {
+                subscribers.emplace_back(kv.second);
+              }
+            });
+            for (auto& subscriber : subscribers) {
+              // Large deltas (e.g. initial route computation) are sent in
+              // chunks, same as snapshot, so that no single message holds
+              // up ctrl event-base while being serialized
+              auto chunks = splitRouteDatabaseDelta(
+                  thrift::RouteDatabaseDelta(maybeDelta.value()),
+                  subscriber->maxChunkRoutes);
+              for (auto& chunk : chunks) {
+                if (subscriber->isSnapshotPending) {
+                  subscriber->pendingDeltas.emplace_back(std::move(chunk));
+                } else {
+                  subscriber->publisher.next(std::move(chunk));
+                }
+              }
+            }
+          }
+        });
+  }
 }
 
 OpenrCtrlHandler::~OpenrCtrlHandler() {
-  std::vector<apache::thrift::ServerStreamPublisher<thrift::Publication>>
-      publishers;
+  terminateStreams();
+
+  LOG(INFO) << "Cleanup all pending request(s).";
+  longPollReqs_.withWLock([&](auto& longPollReqs) { longPollReqs.clear(); });
+
+  LOG(INFO) << "Waiting for termination of kvStoreUpdatesQueue.";
+  taskFuture_.wait();
+
+  LOG(INFO) << "Waiting for termination of fibUpdatesQueue.";
+  fibTaskFuture_.wait();
+}
+
+void
+OpenrCtrlHandler::terminateStreams() {
+  std::vector<std::shared_ptr<KvStoreSubscriber>> subscribers;
   // NOTE: We're intentionally creating list of publishers to and then invoke
   // `complete()` on them.
   // Reason => `complete()` returns only when callback `onComplete` associated
@@ -144,20 +274,27 @@ OpenrCtrlHandler::~OpenrCtrlHandler() {
   // SYNCHRONIZED block
   SYNCHRONIZED(kvStorePublishers_) {
     for (auto& kv : kvStorePublishers_) {
-      publishers.emplace_back(std::move(kv.second));
+      subscribers.emplace_back(kv.second);
     }
   }
-  LOG(INFO) << "Terminating " << publishers.size()
+  LOG(INFO) << "Terminating " << subscribers.size()
             << " active KvStore snoop stream(s).";
-  for (auto& publisher : publishers) {
-    std::move(publisher).complete();
+  for (auto& subscriber : subscribers) {
+    std::move(subscriber->publisher).complete();
   }
 
-  LOG(INFO) << "Cleanup all pending request(s).";
-  longPollReqs_.withWLock([&](auto& longPollReqs) { longPollReqs.clear(); });
-
-  LOG(INFO) << "Waiting for termination of kvStoreUpdatesQueue.";
-  taskFuture_.wait();
+  // Same for route streams
+  std::vector<std::shared_ptr<FibSubscriber>> fibSubscribers;
+  SYNCHRONIZED(fibPublishers_) {
+    for (auto& kv : fibPublishers_) {
+      fibSubscribers.emplace_back(kv.second);
+    }
+  }
+  LOG(INFO) << "Terminating " << fibSubscribers.size()
+            << " active Fib route stream(s).";
+  for (auto& subscriber : fibSubscribers) {
+    std::move(subscriber->publisher).complete();
+  }
 }
 
 void
@@ -221,34 +358,76 @@ OpenrCtrlHandler::semifuture_getEventLogs() {
   return p.getSemiFuture();
 }
 
-void
-OpenrCtrlHandler::getCounters(std::map<std::string, int64_t>& _return) {
-  BaseService::getCounters(_return);
+std::shared_ptr<const std::map<std::string, int64_t>>
+OpenrCtrlHandler::getCounterSnapshot() {
+  const auto now = std::chrono::steady_clock::now();
+  {
+    auto snapshot = counterSnapshot_.rlock();
+    if (snapshot->counters and
+        now - snapshot->timestamp < Constants::kCtrlCounterSnapshotTtl) {
+      return snapshot->counters;
+    }
+  }
+
+  auto counters = std::make_shared<std::map<std::string, int64_t>>();
+  BaseService::getCounters(*counters);
   for (auto const& kv : zmqMonitorClient_->dumpCounters()) {
-    _return.emplace(kv.first, static_cast<int64_t>(kv.second.value));
+    counters->emplace(kv.first, static_cast<int64_t>(kv.second.value));
   }
+  counterSnapshot_.withWLock([&](auto& snapshot) {
+    snapshot.timestamp = now;
+    snapshot.counters = counters;
+  });
+  return counters;
+}
+
+void
+OpenrCtrlHandler::getCounters(std::map<std::string, int64_t>& _return) {
+  _return = *getCounterSnapshot();
 }
 
 void
 OpenrCtrlHandler::getRegexCounters(
     std::map<std::string, int64_t>& _return,
     std::unique_ptr<std::string> regex) {
-  // Compile regex
-  re2::RE2 compiledRegex(*regex);
-  if (not compiledRegex.ok()) {
-    return;
-  }
-
   // Get all counters
-  std::map<std::string, int64_t> counters;
-  getCounters(counters);
+  auto counters = getCounterSnapshot();
+
+  regexMatchers_.withWLock([&](auto& regexMatchers) {
+    // Compile regex, if not seen yet
+    auto it = regexMatchers.find(*regex);
+    if (it == regexMatchers.end()) {
+      auto regexMatcher = std::make_unique<RegexMatcher>(*regex);
+      if (not regexMatcher->regex.ok()) {
+        return;
+      }
+      if (regexMatchers.size() >= Constants::kCtrlMaxCachedRegexes) {
+        regexMatchers.clear();
+      }
+      it = regexMatchers.emplace(*regex, std::move(regexMatcher)).first;
+    }
+    auto& regexMatcher = *it->second;
 
-  // Filter counters
-  for (auto const& kv : counters) {
-    if (RE2::PartialMatch(kv.first, compiledRegex)) {
-      _return.emplace(kv);
+    // Forget names of counters which are mostly gone
+    if (regexMatcher.matches.size() > 2 * counters->size()) {
+      regexMatcher.matches.clear();
     }
-  }
+
+    // Filter counters, evaluating only names not seen before
+    for (auto const& kv : *counters) {
+      auto matchIt = regexMatcher.matches.find(kv.first);
+      if (matchIt == regexMatcher.matches.end()) {
+        matchIt = regexMatcher.matches
+                      .emplace(
+                          kv.first,
+                          RE2::PartialMatch(kv.first, regexMatcher.regex))
+                      .first;
+      }
+      if (matchIt->second) {
+        _return.emplace(kv);
+      }
+    }
+  });
 }
 
 void
@@ -256,13 +435,12 @@ OpenrCtrlHandler::getSelectedCounters(
     std::map<std::string, int64_t>& _return,
     std::unique_ptr<std::vector<std::string>> keys) {
   // Get all counters
-  std::map<std::string, int64_t> counters;
-  getCounters(counters);
+  auto counters = getCounterSnapshot();
 
   // Filter counters
   for (auto const& key : *keys) {
-    auto it = counters.find(key);
-    if (it != counters.end()) {
+    auto it = counters->find(key);
+    if (it != counters->end()) {
       _return.emplace(*it);
     }
   }
@@ -295,12 +473,53 @@ OpenrCtrlHandler::getBuildInfo(thrift::BuildInfo& _buildInfo) {
 
 void
 OpenrCtrlHandler::getRunningConfig(std::string& _return) {
-  _return = config_->getRunningConfig();
+  _return = (*config_.rlock())->getRunningConfig();
 }
 
 void
 OpenrCtrlHandler::getRunningConfigThrift(thrift::OpenrConfig& _config) {
-  _config = config_->getConfig();
+  _config = (*config_.rlock())->getConfig();
+}
+
+folly::SemiFuture<folly::Unit>
+OpenrCtrlHandler::semifuture_reloadConfig(std::unique_ptr<std::string> config) {
+  thrift::OpenrConfig newConfig;
+  try {
+    apache::thrift::SimpleJSONSerializer::deserialize(*config, newConfig);
+  } catch (std::exception const& ex) {
+    return folly::makeSemiFuture<folly::Unit>(thrift::OpenrError(
+        folly::sformat("Could not parse config: {}", ex.what())));
+  }
+
+  // validate and swap config at once, so concurrent reloads are ordered
+  std::shared_ptr<const Config> reloadedConfig;
+  bool areasChanged{false};
+  {
+    auto runningConfig = config_.wlock();
+    try {
+      (*runningConfig)->checkReloadable(newConfig);
+    } catch (std::invalid_argument const& ex) {
+      return folly::makeSemiFuture<folly::Unit>(thrift::OpenrError(ex.what()));
+    }
+    areasChanged = newConfig.areas != (*runningConfig)->getConfig().areas;
+    reloadedConfig = std::make_shared<const Config>(std::move(newConfig));
+    *runningConfig = reloadedConfig;
+  }
+  LOG(INFO) << "Reloading config";
+
+  std::vector<folly::SemiFuture<folly::Unit>> futures;
+  if (kvStore_) {
+    futures.emplace_back(kvStore_->reloadConfig(reloadedConfig));
+  }
+  if (decision_) {
+    futures.emplace_back(decision_->reloadConfig(reloadedConfig));
+  }
+  if (spark_ and areasChanged) {
+    futures.emplace_back(
+        spark_->reloadAreaConfig(reloadedConfig->getConfig().areas));
+  }
+  return folly::collect(std::move(futures))
+      .deferValue([](std::vector<folly::Unit>&&) {});
 }
 
 //
@@ -354,10 +573,185 @@ OpenrCtrlHandler::semifuture_getPrefixesByType(thrift::PrefixType prefixType) {
 //
 // Fib APIs
 //
+template <typename T>
+folly::SemiFuture<std::unique_ptr<T>>
+OpenrCtrlHandler::getCachedResponse(
+    folly::Synchronized<CachedResponse<T>>& cache,
+    RequestLimiter& limiter,
+    int64_t generation,
+    folly::Function<folly::SemiFuture<std::unique_ptr<T>>()> fetch) {
+  auto getCached = [&cache, generation]() -> std::unique_ptr<T> {
+    auto cached = cache.withRLock([&](auto const& cachedResponse) {
+      return cachedResponse.generation == generation ? cachedResponse.response
+                                                     : nullptr;
+    });
+    return cached ? std::make_unique<T>(*cached) : nullptr;
+  };
+  if (auto response = getCached()) {
+    return folly::makeSemiFuture(std::move(response));
+  }
+
+  // Requests queued behind a running fetch are likely served by its response
+  return limiter.acquire().deferValue(
+      [&cache, generation, getCached, fetch = std::move(fetch)](
+          RequestLimiter::Permit permit) mutable
+      -> folly::SemiFuture<std::unique_ptr<T>> {
+        if (auto response = getCached()) {
+          return folly::makeSemiFuture(std::move(response));
+        }
+        // Response is at least as recent as generation taken before
+        // fetching it
+        return fetch().deferValue(
+            [&cache, generation, permit = std::move(permit)](
+                std::unique_ptr<T> response) {
+              auto toCache = std::make_shared<const T>(*response);
+              cache.withWLock([&](auto& cachedResponse) {
+                if (generation >= cachedResponse.generation) {
+                  cachedResponse.generation = generation;
+                  cachedResponse.timestamp = std::chrono::steady_clock::now();
+                  cachedResponse.response = std::move(toCache);
+                }
+              });
+              return response;
+            });
+      });
+}
+
+folly::SemiFuture<std::unique_ptr<thrift::Publication>>
+OpenrCtrlHandler::dumpKvStoreKeys(
+    thrift::KeyDumpParams params, std::string area) {
+  return kvStoreKeyValsLimiter_.run<std::unique_ptr<thrift::Publication>>(
+      [this, params = std::move(params), area = std::move(area)]() mutable {
+        return kvStore_->dumpKvStoreKeys(std::move(params), std::move(area));
+      });
+}
+
+folly::SemiFuture<std::unique_ptr<thrift::Publication>>
+OpenrCtrlHandler::dumpKvStoreHashes(
+    thrift::KeyDumpParams params, std::string area) {
+  return kvStoreHashesLimiter_.run<std::unique_ptr<thrift::Publication>>(
+      [this, params = std::move(params), area = std::move(area)]() mutable {
+        return kvStore_->dumpKvStoreHashes(std::move(params), std::move(area));
+      });
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
 OpenrCtrlHandler::semifuture_getRouteDb() {
   CHECK(fib_);
-  return fib_->getRouteDb();
+  return getCachedResponse<thrift::RouteDatabase>(
+      routeDbCache_, routeDbLimiter_, fib_->getRouteDbGeneration(), [this]() {
+        return fib_->getRouteDb();
+      });
+}
+
+apache::thrift::ServerStream<thrift::RouteDatabaseDelta>
+OpenrCtrlHandler::subscribeFib(int32_t maxChunkRoutes) {
+  CHECK(fib_);
+  const size_t chunkRoutes = maxChunkRoutes > 0
+      ? maxChunkRoutes
+      : Constants::kFibSnapshotChunkRoutes;
+
+  // Get new client-ID (monotonically increasing)
+  auto clientToken = publisherToken_++;
+
+  auto streamAndPublisher =
+      apache::thrift::ServerStream<thrift::RouteDatabaseDelta>::
+          createPublisher([this, clientToken]() {
+            SYNCHRONIZED(fibPublishers_) {
+              if (fibPublishers_.erase(clientToken)) {
+                LOG(INFO) << "Fib route stream-" << clientToken << " ended.";
+              } else {
+                LOG(ERROR) << "Can't remove unknown Fib route stream-"
+                           << clientToken;
+              }
+            }
+          });
+
+  // Subscribe before taking snapshot, so that no update is missed. Updates
+  // are held back in subscriber till snapshot is sent.
+  auto subscriber = std::make_shared<FibSubscriber>(
+      FibSubscriber{std::move(streamAndPublisher.second), chunkRoutes});
+  SYNCHRONIZED(fibPublishers_) {
+    LOG(INFO) << "Fib route stream-" << clientToken << " started.";
+    fibPublishers_.emplace(clientToken, subscriber);
+  }
+
+  fib_->getRouteDb()
+      .via(ctrlEvb_->getEvb())
+      .thenValue([subscriber,
+                  chunkRoutes](std::unique_ptr<thrift::RouteDatabase> routeDb) {
+        publishFibSnapshot(*subscriber, std::move(*routeDb), chunkRoutes);
+      })
+      .thenError([subscriber](folly::exception_wrapper const& ew) {
+        LOG(ERROR) << "Failed to take route snapshot for Fib route stream. "
+                   << folly::exceptionStr(ew);
+        std::move(subscriber->publisher).complete(ew);
+      });
+  return std::move(streamAndPublisher.first);
+}
+
+apache::thrift::ServerStream<thrift::RouteDatabase>
+OpenrCtrlHandler::getRouteDbComputedStream(
+    std::unique_ptr<std::vector<std::string>> nodeNames) {
+  CHECK(decision_);
+  auto streamAndPublisher =
+      apache::thrift::ServerStream<thrift::RouteDatabase>::createPublisher(
+          []() {});
+  auto publisher = std::make_shared<
+      apache::thrift::ServerStreamPublisher<thrift::RouteDatabase>>(
+      std::move(streamAndPublisher.second));
+
+  // Route databases are computed concurrently, and published one at a time
+  // from ctrl evb. Completion is queued on it after all of them
+  auto evb = ctrlEvb_->getEvb();
+  routeDbComputedLimiter_
+      .run<folly::Unit>(
+          [this, nodeNames = std::move(nodeNames), publisher, evb]() {
+            return decision_->getDecisionRouteDbs(
+                std::move(*nodeNames),
+                [publisher, evb](thrift::RouteDatabase routeDb) {
+                  evb->runInEventBaseThread(
+                      [publisher, routeDb = std::move(routeDb)]() mutable {
+                        publisher->next(std::move(routeDb));
+                      });
+                });
+          })
+      .via(evb)
+      .thenTry([publisher](folly::Try<folly::Unit>&& result) {
+        if (result.hasException()) {
+          LOG(ERROR) << "Failed to compute route databases for stream. "
+                     << folly::exceptionStr(result.exception());
+          std::move(*publisher).complete(result.exception());
+          return;
+        }
+        std::move(*publisher).complete();
+      });
+  return std::move(streamAndPublisher.first);
+}
+
+void
+OpenrCtrlHandler::publishFibSnapshot(
+    FibSubscriber& subscriber,
+    thrift::RouteDatabase routeDb,
+    size_t maxChunkRoutes) {
+  // Always send at least one chunk, so that end of snapshot is known
+  thrift::RouteDatabaseDelta snapshot;
+  snapshot.thisNodeName = std::move(routeDb.thisNodeName);
+  snapshot.unicastRoutesToUpdate = std::move(routeDb.unicastRoutes);
+  snapshot.mplsRoutesToUpdate = std::move(routeDb.mplsRoutes);
+  auto chunks = splitRouteDatabaseDelta(std::move(snapshot), maxChunkRoutes);
+
+  subscriber.isSnapshotPending = false;
+  for (auto& chunk : chunks) {
+    subscriber.publisher.next(std::move(chunk));
+  }
+
+  // Updates received meanwhile
+  auto pendingDeltas = std::move(subscriber.pendingDeltas);
+  subscriber.pendingDeltas.clear();
+  for (auto& delta : pendingDeltas) {
+    subscriber.publisher.next(std::move(delta));
+  }
 }
 
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::UnicastRoute>>>
@@ -393,6 +787,37 @@ OpenrCtrlHandler::semifuture_getPerfDb() {
   return fib_->getPerfDb();
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::CpuProfile>>
+OpenrCtrlHandler::semifuture_getCpuProfile(
+    int32_t durationMs, std::unique_ptr<std::string> threadNamePrefix) {
+  const auto duration = std::min(
+      std::chrono::milliseconds(std::max(durationMs, 0)),
+      Constants::kCtrlCpuProfileMaxDuration);
+
+  folly::Promise<std::unique_ptr<thrift::CpuProfile>> p;
+  auto sf = p.getSemiFuture();
+  // Profile blocks for its whole duration, keep it off thrift threads
+  std::thread([p = std::move(p),
+               duration,
+               threadNamePrefix = std::move(threadNamePrefix)]() mutable {
+    folly::setThreadName("CpuProfiler");
+    try {
+      auto profile = CpuProfiler::profile(
+          duration, Constants::kCtrlCpuProfileSamplingHz, *threadNamePrefix);
+      auto res = std::make_unique<thrift::CpuProfile>();
+      res->foldedStacks = std::move(profile.foldedStacks);
+      res->numSamples = profile.numSamples;
+      res->numDroppedSamples = profile.numDroppedSamples;
+      res->durationMs = duration.count();
+      res->samplingHz = Constants::kCtrlCpuProfileSamplingHz;
+      p.setValue(std::move(res));
+    } catch (std::exception const& e) {
+      p.setException(thrift::OpenrError(folly::exceptionStr(e).toStdString()));
+    }
+  }).detach();
+  return sf;
+}
+
 //
 // Decision APIs
 //
@@ -400,19 +825,44 @@ folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
 OpenrCtrlHandler::semifuture_getRouteDbComputed(
     std::unique_ptr<std::string> nodeName) {
   CHECK(decision_);
-  return decision_->getDecisionRouteDb(*nodeName);
+  return routeDbComputedLimiter_.run<std::unique_ptr<thrift::RouteDatabase>>(
+      [this, nodeName = std::move(nodeName)]() {
+        return decision_->getDecisionRouteDb(*nodeName);
+      });
+}
+
+folly::SemiFuture<std::unique_ptr<thrift::RouteDatabaseDelta>>
+OpenrCtrlHandler::semifuture_getRouteDbWhatIf(
+    std::unique_ptr<thrift::RouteDbWhatIfRequest> request) {
+  CHECK(decision_);
+  return routeDbWhatIfLimiter_
+      .run<std::unique_ptr<thrift::RouteDatabaseDelta>>(
+          [this, request = std::move(request)]() mutable {
+            return decision_->getRouteDbWhatIf(std::move(*request));
+          })
+      .deferError([](folly::exception_wrapper&& ew)
+                      -> std::unique_ptr<thrift::RouteDatabaseDelta> {
+        throw thrift::OpenrError(ew.what().toStdString());
+      });
 }
 
 folly::SemiFuture<std::unique_ptr<thrift::AdjDbs>>
 OpenrCtrlHandler::semifuture_getDecisionAdjacencyDbs() {
   CHECK(decision_);
-  return decision_->getDecisionAdjacencyDbs();
+  return getCachedResponse<thrift::AdjDbs>(
+      adjDbsCache_, adjDbsLimiter_, decision_->getLsdbGeneration(), [this]() {
+        return decision_->getDecisionAdjacencyDbs();
+      });
 }
 
 folly::SemiFuture<std::unique_ptr<thrift::PrefixDbs>>
 OpenrCtrlHandler::semifuture_getDecisionPrefixDbs() {
   CHECK(decision_);
-  return decision_->getDecisionPrefixDbs();
+  return getCachedResponse<thrift::PrefixDbs>(
+      prefixDbsCache_,
+      prefixDbsLimiter_,
+      decision_->getLsdbGeneration(),
+      [this]() { return decision_->getDecisionPrefixDbs(); });
 }
 
 //
@@ -449,7 +899,62 @@ folly::SemiFuture<std::unique_ptr<thrift::Publication>>
 OpenrCtrlHandler::semifuture_getKvStoreKeyValsFiltered(
     std::unique_ptr<thrift::KeyDumpParams> filter) {
   CHECK(kvStore_);
-  return kvStore_->dumpKvStoreKeys(std::move(*filter));
+  // Difference against hashes of a client is of no use to others
+  const auto generation = kvStore_->getKvStoreGeneration();
+  if (not generation.has_value() or filter->keyValHashes_ref().has_value()) {
+    return dumpKvStoreKeys(std::move(*filter));
+  }
+
+  auto cacheKey =
+      apache::thrift::CompactSerializer::serialize<std::string>(*filter);
+  std::shared_ptr<const thrift::Publication> cached;
+  std::chrono::milliseconds age{0};
+  kvStoreKeyValsCache_.withRLock([&](auto const& cache) {
+    auto it = cache.find(cacheKey);
+    if (it == cache.end() or it->second.generation != *generation) {
+      return;
+    }
+    age = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - it->second.timestamp);
+    if (age < Constants::kCtrlKvStoreCacheMaxAge) {
+      cached = it->second.response;
+    }
+  });
+
+  if (cached) {
+    // TTL refreshes aren't accounted in generation. Count down TTLs since
+    // response got cached, they are never reported longer than they are
+    auto response = std::make_unique<thrift::Publication>(*cached);
+    for (auto& kv : response->keyVals) {
+      auto& ttl = kv.second.ttl;
+      if (ttl != Constants::kTtlInfinity) {
+        ttl = std::max<int64_t>(ttl - age.count(), 1);
+      }
+    }
+    return folly::makeSemiFuture(std::move(response));
+  }
+
+  return dumpKvStoreKeys(std::move(*filter))
+      .deferValue([this,
+                   generation = *generation,
+                   cacheKey = std::move(cacheKey)](
+                      std::unique_ptr<thrift::Publication> response) mutable {
+        auto toCache = std::make_shared<const thrift::Publication>(*response);
+        kvStoreKeyValsCache_.withWLock([&](auto& cache) {
+          // Entries of past generations are of no use, drop them all
+          if (cache.size() >= Constants::kCtrlKvStoreCacheMaxEntries and
+              not cache.count(cacheKey)) {
+            cache.clear();
+          }
+          auto& cachedResponse = cache[std::move(cacheKey)];
+          if (generation >= cachedResponse.generation) {
+            cachedResponse.generation = generation;
+            cachedResponse.timestamp = std::chrono::steady_clock::now();
+            cachedResponse.response = std::move(toCache);
+          }
+        });
+        return response;
+      });
 }
 
 folly::SemiFuture<std::unique_ptr<thrift::Publication>>
@@ -457,14 +962,14 @@ OpenrCtrlHandler::semifuture_getKvStoreKeyValsFilteredArea(
     std::unique_ptr<thrift::KeyDumpParams> filter,
     std::unique_ptr<std::string> area) {
   CHECK(kvStore_);
-  return kvStore_->dumpKvStoreKeys(std::move(*filter), std::move(*area));
+  return dumpKvStoreKeys(std::move(*filter), std::move(*area));
 }
 
 folly::SemiFuture<std::unique_ptr<thrift::Publication>>
 OpenrCtrlHandler::semifuture_getKvStoreHashFiltered(
     std::unique_ptr<thrift::KeyDumpParams> filter) {
   CHECK(kvStore_);
-  return kvStore_->dumpKvStoreHashes(std::move(*filter));
+  return dumpKvStoreHashes(std::move(*filter));
 }
 
 folly::SemiFuture<std::unique_ptr<thrift::Publication>>
@@ -472,7 +977,7 @@ OpenrCtrlHandler::semifuture_getKvStoreHashFilteredArea(
     std::unique_ptr<thrift::KeyDumpParams> filter,
     std::unique_ptr<std::string> area) {
   CHECK(kvStore_);
-  return kvStore_->dumpKvStoreHashes(std::move(*filter), std::move(*area));
+  return dumpKvStoreHashes(std::move(*filter), std::move(*area));
 }
 
 folly::SemiFuture<folly::Unit>
@@ -486,11 +991,14 @@ OpenrCtrlHandler::semifuture_setKvStoreKeyVals(
 folly::SemiFuture<bool>
 OpenrCtrlHandler::semifuture_longPollKvStoreAdj(
     std::unique_ptr<thrift::KeyVals> snapshot) {
-  folly::Promise<bool> p;
-  auto sf = p.getSemiFuture();
-
-  auto timeStamp = getUnixTimeStampMs();
-  auto requestId = pendingRequestId_++;
+  // Take generation before comparing snapshot, so that change of "adj:" key
+  // in between wakes up request right away instead of being missed
+  auto area = std::make_unique<std::string>(
+      thrift::KvStore_constants::kDefaultArea());
+  const auto generation = longPollReqs_.withWLock([&](auto& longPollReqs) {
+    return longPollReqs.try_emplace(*area, AdjLongPollReqs{adjGenerationBase_})
+        .first->second.generation;
+  });
 
   thrift::KeyDumpParams params;
 
@@ -515,27 +1023,50 @@ OpenrCtrlHandler::semifuture_longPollKvStoreAdj(
                     std::make_unique<thrift::KeyDumpParams>(params))
                     .get();
   } catch (std::exception const& ex) {
-    p.setException(thrift::OpenrError(ex.what()));
-    return sf;
+    return folly::makeSemiFuture<bool>(thrift::OpenrError(ex.what()));
   }
 
   if (thriftPub->keyVals.size() > 0) {
     VLOG(3) << "AdjKey has been added/modified. Notify immediately";
-    p.setValue(true);
-  } else if (
-      thriftPub->tobeUpdatedKeys_ref().has_value() &&
+    return folly::makeSemiFuture(true);
+  }
+  if (thriftPub->tobeUpdatedKeys_ref().has_value() &&
       thriftPub->tobeUpdatedKeys_ref().value().size() > 0) {
     VLOG(3) << "AdjKey has been deleted/expired. Notify immediately";
-    p.setValue(true);
-  } else {
-    // Client provided data is consistent with KvStore.
-    // Store req for future processing when there is publication
-    // from KvStore.
-    VLOG(3) << "No adj change detected. Store req as pending request";
-    longPollReqs_.withWLock([&](auto& longPollReq) {
-      longPollReq.emplace(requestId, std::make_pair(std::move(p), timeStamp));
-    });
+    return folly::makeSemiFuture(true);
   }
+
+  // Client provided data is consistent with KvStore.
+  // Store req for future processing when there is publication
+  // from KvStore. Unchanged generation means request has expired.
+  VLOG(3) << "No adj change detected. Store req as pending request";
+  return semifuture_longPollKvStoreAdjArea(std::move(area), generation)
+      .deferValue([generation](int64_t newGeneration) {
+        return newGeneration != generation;
+      });
+}
+
+folly::SemiFuture<int64_t>
+OpenrCtrlHandler::semifuture_longPollKvStoreAdjArea(
+    std::unique_ptr<std::string> area, int64_t generation) {
+  folly::Promise<int64_t> p;
+  auto sf = p.getSemiFuture();
+
+  longPollReqs_.withWLock([&](auto& longPollReqs) {
+    auto& areaReqs =
+        longPollReqs.try_emplace(*area, AdjLongPollReqs{adjGenerationBase_})
+            .first->second;
+    if (areaReqs.generation != generation) {
+      VLOG(3) << "Generation " << generation << " of area " << *area
+              << " is behind " << areaReqs.generation << ". Notify immediately";
+      p.setValue(areaReqs.generation);
+      return;
+    }
+    VLOG(3) << "Store req as pending request of area " << *area;
+    auto requestId = pendingRequestId_++;
+    areaReqs.reqs.emplace(
+        requestId, std::make_pair(std::move(p), getUnixTimeStampMs()));
+  });
   return sf;
 }
 
@@ -579,6 +1110,28 @@ OpenrCtrlHandler::semifuture_getKvStorePeersArea(
 
 apache::thrift::ServerStream<thrift::Publication>
 OpenrCtrlHandler::subscribeKvStore() {
+  return subscribeKvStoreImpl(std::nullopt, std::nullopt).first;
+}
+
+apache::thrift::ServerStream<thrift::Publication>
+OpenrCtrlHandler::subscribeKvStoreFilter(
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::string> area) {
+  std::vector<std::string> keyPrefixList;
+  folly::split(",", filter->prefix, keyPrefixList, true);
+  return subscribeKvStoreImpl(
+             std::move(*area),
+             KvStoreFilters(keyPrefixList, filter->originatorIds))
+      .first;
+}
+
+std::pair<
+    apache::thrift::ServerStream<thrift::Publication>,
+    std::shared_ptr<OpenrCtrlHandler::KvStoreSubscriber>>
+OpenrCtrlHandler::subscribeKvStoreImpl(
+    std::optional<std::string> area,
+    std::optional<KvStoreFilters> filters,
+    bool withSnapshot) {
   // Get new client-ID (monotonically increasing)
   auto clientToken = publisherToken_++;
 
@@ -596,13 +1149,21 @@ OpenrCtrlHandler::subscribeKvStore() {
             }
           });
 
+  std::shared_ptr<KvStoreSubscriber> subscriber;
   SYNCHRONIZED(kvStorePublishers_) {
     assert(kvStorePublishers_.count(clientToken) == 0);
     LOG(INFO) << "KvStore snoop stream-" << clientToken << " started.";
-    kvStorePublishers_.emplace(
-        clientToken, std::move(streamAndPublisher.second));
+    subscriber = std::make_shared<KvStoreSubscriber>(KvStoreSubscriber{
+        std::move(streamAndPublisher.second),
+        std::move(area),
+        std::move(filters)});
+    if (withSnapshot) {
+      subscriber->nextSeqNum = 0;
+      subscriber->isSnapshotPending = true;
+    }
+    kvStorePublishers_.emplace(clientToken, subscriber);
   }
-  return std::move(streamAndPublisher.first);
+  return {std::move(streamAndPublisher.first), std::move(subscriber)};
 }
 
 folly::SemiFuture<apache::thrift::ResponseAndServerStream<
@@ -622,6 +1183,104 @@ OpenrCtrlHandler::semifuture_subscribeAndGetKvStore() {
           });
 }
 
+folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+    thrift::Publication,
+    thrift::Publication>>
+OpenrCtrlHandler::semifuture_subscribeAndGetKvStoreFiltered(
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::string> area) {
+  return semifuture_getKvStoreKeyValsFilteredArea(
+             std::make_unique<thrift::KeyDumpParams>(*filter),
+             std::make_unique<std::string>(*area))
+      .defer(
+          [stream = subscribeKvStoreFilter(std::move(filter), std::move(area))](
+              folly::Try<std::unique_ptr<thrift::Publication>>&& pub) mutable {
+            pub.throwIfFailed();
+            return apache::thrift::ResponseAndServerStream<
+                thrift::Publication,
+                thrift::Publication>{std::move(*pub.value()),
+                                     std::move(stream)};
+          });
+}
+
+apache::thrift::ServerStream<thrift::Publication>
+OpenrCtrlHandler::subscribeAndGetKvStoreChunked(
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::string> area) {
+  CHECK(kvStore_);
+  const size_t maxChunkKeyVals = std::max(
+      filter->maxChunkKeyVals_ref().value_or(
+          Constants::kKvStoreSyncChunkKeyVals),
+      1);
+
+  // Subscribe before taking snapshot, so that no update is missed. Updates
+  // are held back in subscriber till snapshot is sent.
+  std::vector<std::string> keyPrefixList;
+  folly::split(",", filter->prefix, keyPrefixList, true);
+  auto streamAndSubscriber = subscribeKvStoreImpl(
+      *area, KvStoreFilters(keyPrefixList, filter->originatorIds), true);
+
+  auto subscriber = std::move(streamAndSubscriber.second);
+  thrift::KeyDumpParams dumpParams;
+  dumpParams.prefix = filter->prefix;
+  dumpParams.originatorIds = filter->originatorIds;
+  kvStore_->dumpKvStoreKeys(std::move(dumpParams), *area)
+      .via(ctrlEvb_->getEvb())
+      .thenValue([subscriber, area = std::move(*area), maxChunkKeyVals](
+                     std::unique_ptr<thrift::Publication> snapshot) {
+        snapshot->area_ref() = area;
+        publishSnapshot(*subscriber, std::move(*snapshot), maxChunkKeyVals);
+      })
+      .thenError([subscriber](folly::exception_wrapper const& ew) {
+        LOG(ERROR) << "Failed to take KvStore snapshot for snoop stream. "
+                   << folly::exceptionStr(ew);
+        std::move(subscriber->publisher).complete(ew);
+      });
+  return std::move(streamAndSubscriber.first);
+}
+
+void
+OpenrCtrlHandler::publish(
+    KvStoreSubscriber& subscriber, thrift::Publication publication) {
+  if (subscriber.isSnapshotPending) {
+    subscriber.pendingPublications.emplace_back(std::move(publication));
+    return;
+  }
+  if (subscriber.nextSeqNum.has_value()) {
+    publication.seqNum_ref() = (*subscriber.nextSeqNum)++;
+  }
+  subscriber.publisher.next(std::move(publication));
+}
+
+void
+OpenrCtrlHandler::publishSnapshot(
+    KvStoreSubscriber& subscriber,
+    thrift::Publication snapshot,
+    size_t maxChunkKeyVals) {
+  // Peel off chunks till the rest fits into one. Values are moved out of
+  // snapshot, so that memory is released as chunks are sent out.
+  subscriber.isSnapshotPending = false;
+  while (snapshot.keyVals.size() > maxChunkKeyVals) {
+    thrift::Publication chunk;
+    chunk.area_ref() = snapshot.area_ref().value();
+    chunk.hasMoreChunks_ref() = true;
+    auto it = snapshot.keyVals.begin();
+    for (size_t i = 0; i < maxChunkKeyVals; ++i) {
+      chunk.keyVals.emplace(it->first, std::move(it->second));
+      it = snapshot.keyVals.erase(it);
+    }
+    publish(subscriber, std::move(chunk));
+  }
+  publish(subscriber, std::move(snapshot));
+
+  // Updates received meanwhile
+  auto pendingPublications = std::move(subscriber.pendingPublications);
+  subscriber.pendingPublications.clear();
+  for (auto& publication : pendingPublications) {
+    publish(subscriber, std::move(publication));
+  }
+}
+
 //
 // LinkMonitor APIs
 //
@@ -10,6 +10,9 @@
 #include <fb303/BaseService.h>
 #include <fbzmq/service/monitor/ZmqMonitorClient.h>
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/Synchronized.h>
+#include <openr/common/Constants.h>
+#include <openr/common/RequestLimiter.h>
 #include <openr/common/Types.h>
 #include <openr/config-store/PersistentStore.h>
 #include <openr/config/Config.h>
@@ -19,6 +22,8 @@
 #include <openr/kvstore/KvStore.h>
 #include <openr/link-monitor/LinkMonitor.h>
 #include <openr/prefix-manager/PrefixManager.h>
+#include <openr/spark/Spark.h>
+#include <re2/re2.h>
 
 namespace openr {
 class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
@@ -40,10 +45,17 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       PrefixManager* prefixManager,
       std::shared_ptr<const Config> config,
       MonitorSubmitUrl const& monitorSubmitUrl,
-      fbzmq::Context& context);
+      fbzmq::Context& context,
+      Spark* spark = nullptr);
 
   ~OpenrCtrlHandler() override;
 
+  /**
+   * Complete all active KvStore snoop and Fib route streams. Subscribers can
+   * subscribe again afterwards. Thread safe.
+   */
+  void terminateStreams();
+
   //
   // fb303 service APIs
   //
@@ -66,6 +78,10 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   void getRunningConfig(std::string& _return) override;
   void getRunningConfigThrift(thrift::OpenrConfig& _config) override;
 
+  // Reload non-structural fields of config in modules without restart
+  folly::SemiFuture<folly::Unit> semifuture_reloadConfig(
+      std::unique_ptr<std::string> config) override;
+
   //
   // ZMQ Monitor APIs
   //
@@ -124,6 +140,11 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   folly::SemiFuture<std::unique_ptr<thrift::PerfDatabase>>
   semifuture_getPerfDb() override;
 
+  folly::SemiFuture<std::unique_ptr<thrift::CpuProfile>>
+  semifuture_getCpuProfile(
+      int32_t durationMs,
+      std::unique_ptr<std::string> threadNamePrefix) override;
+
   //
   // Decision APIs
   //
@@ -137,6 +158,10 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
   semifuture_getRouteDbComputed(std::unique_ptr<std::string> nodeName) override;
 
+  folly::SemiFuture<std::unique_ptr<thrift::RouteDatabaseDelta>>
+  semifuture_getRouteDbWhatIf(
+      std::unique_ptr<thrift::RouteDbWhatIfRequest> request) override;
+
   //
   // KvStore APIs
   //
@@ -200,10 +225,35 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       thrift::Publication>>
   semifuture_subscribeAndGetKvStore() override;
 
+  apache::thrift::ServerStream<thrift::Publication> subscribeKvStoreFilter(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::string> area) override;
+
+  folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+      thrift::Publication,
+      thrift::Publication>>
+  semifuture_subscribeAndGetKvStoreFiltered(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::string> area) override;
+
+  apache::thrift::ServerStream<thrift::Publication>
+  subscribeAndGetKvStoreChunked(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::string> area) override;
+
+  apache::thrift::ServerStream<thrift::RouteDatabaseDelta> subscribeFib(
+      int32_t maxChunkRoutes) override;
+
+  apache::thrift::ServerStream<thrift::RouteDatabase> getRouteDbComputedStream(
+      std::unique_ptr<std::vector<std::string>> nodeNames) override;
+
   // Long poll support
   folly::SemiFuture<bool> semifuture_longPollKvStoreAdj(
       std::unique_ptr<thrift::KeyVals> snapshot) override;
 
+  folly::SemiFuture<int64_t> semifuture_longPollKvStoreAdjArea(
+      std::unique_ptr<std::string> area, int64_t generation) override;
+
   //
   // LinkMonitor APIs
   //
@@ -262,9 +312,18 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
     return kvStorePublishers_.wlock()->size();
   }
 
+  inline size_t
+  getNumFibPublishers() {
+    return fibPublishers_.wlock()->size();
+  }
+
   inline size_t
   getNumPendingLongPollReqs() {
-    return longPollReqs_->size();
+    size_t numReqs{0};
+    for (auto const& kv : *longPollReqs_.rlock()) {
+      numReqs += kv.second.reqs.size();
+    }
+    return numReqs;
   }
 
   //
@@ -272,15 +331,115 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   //
   inline void
   cleanupPendingLongPollReqs() {
-    longPollReqs_->clear();
+    for (auto& kv : *longPollReqs_.wlock()) {
+      kv.second.reqs.clear();
+    }
   }
 
  private:
+  // KvStore snoop stream, along with area and filters of publications to send
+  // on it. Everything is sent if they aren't set.
+  // Response of read API, kept along with generation of module state it was
+  // built from. Served to further requests as long as generation holds.
+  template <typename T>
+  struct CachedResponse {
+    int64_t generation{-1};
+    std::chrono::steady_clock::time_point timestamp;
+    std::shared_ptr<const T> response;
+  };
+
+  // Serve response from cache if it is of given generation. Fetch it from
+  // module under limiter otherwise and cache it for further requests
+  template <typename T>
+  folly::SemiFuture<std::unique_ptr<T>> getCachedResponse(
+      folly::Synchronized<CachedResponse<T>>& cache,
+      RequestLimiter& limiter,
+      int64_t generation,
+      folly::Function<folly::SemiFuture<std::unique_ptr<T>>()> fetch);
+
+  // All counters, re-collected when snapshot is older than
+  // kCtrlCounterSnapshotTtl
+  std::shared_ptr<const std::map<std::string, int64_t>> getCounterSnapshot();
+
+  // Dump KvStore under limiter of respective API
+  folly::SemiFuture<std::unique_ptr<thrift::Publication>> dumpKvStoreKeys(
+      thrift::KeyDumpParams params,
+      std::string area = thrift::KvStore_constants::kDefaultArea());
+  folly::SemiFuture<std::unique_ptr<thrift::Publication>> dumpKvStoreHashes(
+      thrift::KeyDumpParams params,
+      std::string area = thrift::KvStore_constants::kDefaultArea());
+
+  // Pending longPoll requests of an area, woken up only by changes of "adj:"
+  // keys in that area. Generation is bumped on every such change so that
+  // clients can resume from the one they have seen last.
+  struct AdjLongPollReqs {
+    int64_t generation{0};
+    // 1). promise; 2). timestamp when req received on server
+    std::unordered_map<int64_t, std::pair<folly::Promise<int64_t>, int64_t>>
+        reqs;
+  };
+
+  struct KvStoreSubscriber {
+    apache::thrift::ServerStreamPublisher<thrift::Publication> publisher;
+    std::optional<std::string> area;
+    std::optional<KvStoreFilters> filters;
+
+    // State of streams with snapshot, only accessed in ctrl event-base.
+    // Sequence number of next publication, and updates held back till
+    // snapshot is sent.
+    std::optional<int64_t> nextSeqNum;
+    bool isSnapshotPending{false};
+    std::vector<thrift::Publication> pendingPublications;
+  };
+
+  // Fib route stream, along with route updates held back till snapshot of
+  // routes is sent. Only accessed in ctrl event-base.
+  struct FibSubscriber {
+    apache::thrift::ServerStreamPublisher<thrift::RouteDatabaseDelta>
+        publisher;
+    // max number of routes per message, for snapshot and updates alike
+    size_t maxChunkRoutes{Constants::kFibSnapshotChunkRoutes};
+    bool isSnapshotPending{true};
+    std::vector<thrift::RouteDatabaseDelta> pendingDeltas;
+  };
+
   void authorizeConnection();
 
+  // Create KvStore snoop stream with given area and filters, along with its
+  // subscriber
+  std::pair<
+      apache::thrift::ServerStream<thrift::Publication>,
+      std::shared_ptr<KvStoreSubscriber>>
+  subscribeKvStoreImpl(
+      std::optional<std::string> area,
+      std::optional<KvStoreFilters> filters,
+      bool withSnapshot = false);
+
+  // Send publication on stream of subscriber, or hold it back if snapshot is
+  // yet to be sent
+  static void publish(
+      KvStoreSubscriber& subscriber, thrift::Publication publication);
+
+  // Send snapshot in chunks of maxChunkKeyVals keys, followed by updates held
+  // back meanwhile
+  static void publishSnapshot(
+      KvStoreSubscriber& subscriber,
+      thrift::Publication snapshot,
+      size_t maxChunkKeyVals);
+
+  // Send route snapshot as route deltas of maxChunkRoutes routes, followed by
+  // route updates held back meanwhile
+  static void publishFibSnapshot(
+      FibSubscriber& subscriber,
+      thrift::RouteDatabase routeDb,
+      size_t maxChunkRoutes);
+
   const std::string nodeName_;
   const std::unordered_set<std::string> acceptablePeerCommonNames_;
 
+  // Event-base feeding KvStore snoop streams
+  OpenrEventBase* ctrlEvb_{nullptr};
+
   // Pointers to Open/R modules
   Decision* decision_{nullptr};
   Fib* fib_{nullptr};
@@ -288,27 +447,82 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   LinkMonitor* linkMonitor_{nullptr};
   PersistentStore* configStore_{nullptr};
   PrefixManager* prefixManager_{nullptr};
-  std::shared_ptr<const Config> config_;
+  Spark* spark_{nullptr};
+
+  // running config, replaced on reload
+  folly::Synchronized<std::shared_ptr<const Config>> config_;
 
   // client to interact with monitor
   std::unique_ptr<fbzmq::ZmqMonitorClient> zmqMonitorClient_;
 
-  // Active kvstore snoop publishers
+  // Active kvstore snoop publishers. Shared so that publications can be sent
+  // without holding lock.
   std::atomic<int64_t> publisherToken_{0};
-  folly::Synchronized<std::unordered_map<
-      int64_t,
-      apache::thrift::ServerStreamPublisher<thrift::Publication>>>
+  folly::Synchronized<
+      std::unordered_map<int64_t, std::shared_ptr<KvStoreSubscriber>>>
       kvStorePublishers_;
 
-  // pending longPoll requests from clients, which consists of
-  // 1). promise; 2). timestamp when req received on server
-  std::atomic<int64_t> pendingRequestId_{0};
+  // Active Fib route stream publishers
   folly::Synchronized<
-      std::unordered_map<int64_t, std::pair<folly::Promise<bool>, int64_t>>>
+      std::unordered_map<int64_t, std::shared_ptr<FibSubscriber>>>
+      fibPublishers_;
+
+  // pending longPoll requests from clients, indexed by area. Generations
+  // start from time of creation of handler, so that generation seen from a
+  // previous instance doesn't match the current one.
+  const int64_t adjGenerationBase_{getUnixTimeStampMs()};
+  std::atomic<int64_t> pendingRequestId_{0};
+  folly::Synchronized<std::unordered_map<std::string, AdjLongPollReqs>>
       longPollReqs_;
 
+  // Snapshot of counters shared by scrapes
+  struct CounterSnapshot {
+    std::chrono::steady_clock::time_point timestamp;
+    std::shared_ptr<const std::map<std::string, int64_t>> counters;
+  };
+  folly::Synchronized<CounterSnapshot> counterSnapshot_;
+
+  // Compiled regex of getRegexCounters along with memoized match of every
+  // counter name seen, so that a name is evaluated once instead of on every
+  // scrape
+  struct RegexMatcher {
+    explicit RegexMatcher(std::string const& pattern) : regex(pattern) {}
+
+    re2::RE2 regex;
+    std::unordered_map<std::string, bool> matches;
+  };
+  folly::Synchronized<
+      std::unordered_map<std::string, std::unique_ptr<RegexMatcher>>>
+      regexMatchers_;
+
+  // Limits on in-flight dumps of heavy read APIs, one per API
+  RequestLimiter adjDbsLimiter_{
+      Constants::kCtrlMaxRunningDumps, Constants::kCtrlMaxQueuedDumps};
+  RequestLimiter prefixDbsLimiter_{
+      Constants::kCtrlMaxRunningDumps, Constants::kCtrlMaxQueuedDumps};
+  RequestLimiter routeDbLimiter_{
+      Constants::kCtrlMaxRunningDumps, Constants::kCtrlMaxQueuedDumps};
+  RequestLimiter routeDbComputedLimiter_{
+      Constants::kCtrlMaxRunningDumps, Constants::kCtrlMaxQueuedDumps};
+  RequestLimiter routeDbWhatIfLimiter_{
+      Constants::kCtrlMaxRunningDumps, Constants::kCtrlMaxQueuedDumps};
+  RequestLimiter kvStoreKeyValsLimiter_{
+      Constants::kCtrlMaxRunningDumps, Constants::kCtrlMaxQueuedDumps};
+  RequestLimiter kvStoreHashesLimiter_{
+      Constants::kCtrlMaxRunningDumps, Constants::kCtrlMaxQueuedDumps};
+
+  // Cached responses of hot read APIs. KvStore ones are keyed by serialized
+  // dump params.
+  folly::Synchronized<CachedResponse<thrift::AdjDbs>> adjDbsCache_;
+  folly::Synchronized<CachedResponse<thrift::PrefixDbs>> prefixDbsCache_;
+  folly::Synchronized<CachedResponse<thrift::RouteDatabase>> routeDbCache_;
+  folly::Synchronized<
+      std::unordered_map<std::string, CachedResponse<thrift::Publication>>>
+      kvStoreKeyValsCache_;
+
   // fiber task future hold
   folly::Future<folly::Unit> taskFuture_;
+  folly::Future<folly::Unit> fibTaskFuture_;
 
 }; // class OpenrCtrlHandler
 } // namespace openr
@@ -0,0 +1,538 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/executors/GlobalExecutor.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/EventBase.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/OpenrClient.h>
+#include <openr/common/Util.h>
+#include <openr/common/tests/BenchmarkUtils.h>
+#include <openr/config/Config.h>
+#include <openr/config/tests/Utils.h>
+#include <openr/decision/Decision.h>
+#include <openr/fib/Fib.h>
+#include <openr/kvstore/KvStoreWrapper.h>
+#include <openr/messaging/ReplicateQueue.h>
+#include <openr/tests/OpenrThriftServerWrapper.h>
+
+namespace openr {
+
+namespace {
+
+// Nodes of ring topology, local node being the first one
+const size_t kNumNodes(100);
+const std::string kNodeName("node-0");
+
+// Metric of link between node-0 and node-1 when it is flipped away from 1.
+// Higher than ring around, so that routes to node-1 change.
+const int32_t kHighMetric(1000);
+
+// Number of requests made by every client while measuring read APIs
+const size_t kNumRequestsPerClient(100);
+
+// Number of link metric flips while measuring convergence
+const size_t kNumMetricFlips(10);
+
+enum class CtrlApi {
+  KVSTORE_KEY_VALS,
+  KVSTORE_KEY_VALS_AREA,
+  DECISION_ADJ_DBS,
+  DECISION_PREFIX_DBS,
+  FIB_ROUTE_DB,
+};
+
+std::string
+getNodeName(size_t id) {
+  return folly::sformat("node-{}", id);
+}
+
+std::string
+getIfName(size_t id, size_t peerId) {
+  return folly::sformat("if_{}_{}", id, peerId);
+}
+
+// Value of percentile of latencies, sorting them
+int64_t
+getPercentileUs(std::vector<std::chrono::microseconds>& latencies, size_t pct) {
+  if (latencies.empty()) {
+    return 0;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  return latencies.at((latencies.size() - 1) * pct / 100).count();
+}
+
+} // namespace
+
+/**
+ * KvStore, Decision and Fib along with OpenrCtrl thrift server on top of
+ * them. KvStore is populated with a ring topology of kNumNodes nodes and
+ * numKeys other keys, and Fib holds routes towards every other node.
+ */
+class OpenrCtrlBenchmarkFixture {
+ public:
+  explicit OpenrCtrlBenchmarkFixture(size_t numKeys)
+      : config_(std::make_shared<Config>(getBasicOpenrConfig(kNodeName))) {
+    kvStoreWrapper_ = std::make_unique<KvStoreWrapper>(
+        context_, config_, std::unordered_map<std::string, thrift::PeerSpec>{});
+    kvStoreWrapper_->run();
+
+    decision_ = std::make_unique<Decision>(
+        config_,
+        false, /* computeLfaPaths */
+        false, /* bgpDryRun */
+        std::chrono::milliseconds(10),
+        std::chrono::milliseconds(500),
+        kvStoreWrapper_->getReader(),
+        staticRoutesUpdatesQueue_.getReader(),
+        routeUpdatesQueue_,
+        context_);
+    decisionThread_ = std::thread([this]() { decision_->run(); });
+    decision_->waitUntilRunning();
+
+    fib_ = std::make_unique<Fib>(
+        config_,
+        -1, /* thrift port */
+        std::chrono::seconds(0), /* coldStartDuration */
+        routeUpdatesQueue_.getReader(),
+        interfaceUpdatesQueue_.getReader(),
+        fibUpdatesQueue_,
+        MonitorSubmitUrl{"inproc://monitor-sub"},
+        kvStoreWrapper_->getKvStore(),
+        context_);
+    fibThread_ = std::thread([this]() { fib_->run(); });
+    fib_->waitUntilRunning();
+
+    openrThriftServerWrapper_ = std::make_shared<OpenrThriftServerWrapper>(
+        kNodeName,
+        decision_.get() /* decision */,
+        fib_.get() /* fib */,
+        kvStoreWrapper_->getKvStore() /* kvStore */,
+        nullptr /* linkMonitor */,
+        nullptr /* configStore */,
+        nullptr /* prefixManager */,
+        nullptr /* config */,
+        MonitorSubmitUrl{"inproc://monitor-submit-url"},
+        context_);
+    openrThriftServerWrapper_->run();
+
+    // Populate KvStore and wait for routes towards every other node
+    std::vector<std::pair<std::string, thrift::Value>> keyVals;
+    for (size_t i = 0; i < kNumNodes; ++i) {
+      keyVals.emplace_back(getAdjKeyVal(i));
+      keyVals.emplace_back(
+          folly::sformat("{}{}", Constants::kPrefixDbMarker, getNodeName(i)),
+          createThriftValue(
+              1,
+              getNodeName(i),
+              apache::thrift::CompactSerializer::serialize<std::string>(
+                  createPrefixDb(
+                      getNodeName(i),
+                      {createPrefixEntry(toIpPrefix(
+                          folly::sformat("fc00:{:x}::/64", i + 1)))}))));
+    }
+    for (size_t i = 0; i < numKeys; ++i) {
+      keyVals.emplace_back(
+          folly::sformat("key-{:08d}", i),
+          createThriftValue(1, getNodeName(1), std::string("value")));
+    }
+    kvStoreWrapper_->setKeys(keyVals);
+    while (fib_->getRouteDb().get()->unicastRoutes.size() < kNumNodes - 1) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  ~OpenrCtrlBenchmarkFixture() {
+    routeUpdatesQueue_.close();
+    staticRoutesUpdatesQueue_.close();
+    interfaceUpdatesQueue_.close();
+    fibUpdatesQueue_.close();
+    kvStoreWrapper_->closeQueue();
+
+    openrThriftServerWrapper_->stop();
+
+    fib_->stop();
+    fibThread_.join();
+
+    decision_->stop();
+    decisionThread_.join();
+
+    kvStoreWrapper_->stop();
+  }
+
+  // Make numRequests calls of api from each of numClients clients in
+  // parallel. Returns latency of every call
+  std::vector<std::chrono::microseconds>
+  runClients(CtrlApi api, size_t numClients, size_t numRequests) {
+    std::vector<std::vector<std::chrono::microseconds>> latencies(numClients);
+    std::vector<std::thread> clientThreads;
+    for (size_t i = 0; i < numClients; ++i) {
+      clientThreads.emplace_back([this, api, numRequests, &latencies, i]() {
+        folly::EventBase evb;
+        auto client = getClient(evb);
+        for (size_t j = 0; j < numRequests; ++j) {
+          const auto startTime = std::chrono::steady_clock::now();
+          callApi(*client, api);
+          latencies.at(i).emplace_back(
+              std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - startTime));
+        }
+      });
+    }
+    for (auto& clientThread : clientThreads) {
+      clientThread.join();
+    }
+
+    std::vector<std::chrono::microseconds> allLatencies;
+    for (auto const& clientLatencies : latencies) {
+      allLatencies.insert(
+          allLatencies.end(), clientLatencies.begin(), clientLatencies.end());
+    }
+    return allLatencies;
+  }
+
+  // Keep numClients clients calling api till stopped
+  void
+  startLoad(CtrlApi api, size_t numClients) {
+    for (size_t i = 0; i < numClients; ++i) {
+      loadThreads_.emplace_back([this, api]() {
+        folly::EventBase evb;
+        auto client = getClient(evb);
+        while (not stopLoad_) {
+          callApi(*client, api);
+        }
+      });
+    }
+  }
+
+  void
+  stopLoad() {
+    stopLoad_ = true;
+    for (auto& loadThread : loadThreads_) {
+      loadThread.join();
+    }
+    loadThreads_.clear();
+  }
+
+  // Flip metric of link between node-0 and node-1, and wait for resulting
+  // route update of Fib. Returns time it took
+  std::chrono::microseconds
+  flipLinkMetric() {
+    while (fibUpdatesReader_.size()) {
+      fibUpdatesReader_.get();
+    }
+
+    linkMetric_ = linkMetric_ == 1 ? kHighMetric : 1;
+    ++adjDbVersion_;
+    const auto startTime = std::chrono::steady_clock::now();
+    kvStoreWrapper_->setKeys({getAdjKeyVal(0), getAdjKeyVal(1)});
+    while (true) {
+      auto maybeDelta = fibUpdatesReader_.get();
+      CHECK(maybeDelta.hasValue());
+      if (not maybeDelta->unicastRoutesToUpdate.empty()) {
+        break;
+      }
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime);
+  }
+
+  KvStoreWrapper*
+  getKvStoreWrapper() {
+    return kvStoreWrapper_.get();
+  }
+
+  std::shared_ptr<OpenrCtrlHandler>&
+  getHandler() {
+    return openrThriftServerWrapper_->getOpenrCtrlHandler();
+  }
+
+ private:
+  // Adjacency database of node in ring topology, as key-value
+  std::pair<std::string, thrift::Value>
+  getAdjKeyVal(size_t id) {
+    std::vector<thrift::Adjacency> adjs;
+    const auto prevId = (id + kNumNodes - 1) % kNumNodes;
+    const auto nextId = (id + 1) % kNumNodes;
+    for (auto peerId : {prevId, nextId}) {
+      const bool isFlippedLink =
+          (id == 0 and peerId == 1) or (id == 1 and peerId == 0);
+      adjs.emplace_back(createAdjacency(
+          getNodeName(peerId),
+          getIfName(id, peerId),
+          getIfName(peerId, id),
+          folly::sformat("fe80::{:x}", peerId + 1),
+          folly::sformat("10.0.{}.{}", peerId / 256, peerId % 256),
+          isFlippedLink ? linkMetric_ : 1,
+          0 /* adjLabel */));
+    }
+    return {folly::sformat("{}{}", Constants::kAdjDbMarker, getNodeName(id)),
+            createThriftValue(
+                adjDbVersion_,
+                getNodeName(id),
+                apache::thrift::CompactSerializer::serialize<std::string>(
+                    createAdjDb(getNodeName(id), adjs, id + 1)))};
+  }
+
+  std::unique_ptr<thrift::OpenrCtrlCppAsyncClient>
+  getClient(folly::EventBase& evb) {
+    return getOpenrCtrlPlainTextClient<apache::thrift::HeaderClientChannel>(
+        evb,
+        folly::IPAddress("::1"),
+        openrThriftServerWrapper_->getOpenrCtrlThriftPort());
+  }
+
+  static void
+  callApi(thrift::OpenrCtrlCppAsyncClient& client, CtrlApi api) {
+    thrift::KeyDumpParams params;
+    params.prefix = "key-";
+    switch (api) {
+    case CtrlApi::KVSTORE_KEY_VALS: {
+      thrift::Publication pub;
+      client.sync_getKvStoreKeyValsFiltered(pub, params);
+      break;
+    }
+    case CtrlApi::KVSTORE_KEY_VALS_AREA: {
+      thrift::Publication pub;
+      client.sync_getKvStoreKeyValsFilteredArea(
+          pub, params, thrift::KvStore_constants::kDefaultArea());
+      break;
+    }
+    case CtrlApi::DECISION_ADJ_DBS: {
+      thrift::AdjDbs adjDbs;
+      client.sync_getDecisionAdjacencyDbs(adjDbs);
+      break;
+    }
+    case CtrlApi::DECISION_PREFIX_DBS: {
+      thrift::PrefixDbs prefixDbs;
+      client.sync_getDecisionPrefixDbs(prefixDbs);
+      break;
+    }
+    case CtrlApi::FIB_ROUTE_DB: {
+      thrift::RouteDatabase routeDb;
+      client.sync_getRouteDb(routeDb);
+      break;
+    }
+    }
+  }
+
+  fbzmq::Context context_;
+  std::shared_ptr<Config> config_;
+
+  messaging::ReplicateQueue<thrift::RouteDatabaseDelta> routeUpdatesQueue_;
+  messaging::ReplicateQueue<thrift::RouteDatabaseDelta>
+      staticRoutesUpdatesQueue_;
+  messaging::ReplicateQueue<thrift::InterfaceDatabase> interfaceUpdatesQueue_;
+  messaging::ReplicateQueue<thrift::RouteDatabaseDelta> fibUpdatesQueue_;
+  messaging::RQueue<thrift::RouteDatabaseDelta> fibUpdatesReader_{
+      fibUpdatesQueue_.getReader()};
+
+  std::unique_ptr<KvStoreWrapper> kvStoreWrapper_;
+  std::unique_ptr<Decision> decision_;
+  std::thread decisionThread_;
+  std::unique_ptr<Fib> fib_;
+  std::thread fibThread_;
+  std::shared_ptr<OpenrThriftServerWrapper> openrThriftServerWrapper_;
+
+  // Current metric of link between node-0 and node-1
+  int32_t linkMetric_{1};
+  int64_t adjDbVersion_{1};
+
+  std::atomic<bool> stopLoad_{false};
+  std::vector<std::thread> loadThreads_;
+};
+
+/**
+ * Measure throughput and latency of read API called numClients clients in
+ * parallel, with KvStore holding numKeys keys besides topology
+ */
+static void
+BM_OpenrCtrlRead(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    CtrlApi api,
+    size_t numClients,
+    size_t numKeys) {
+  for (uint32_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    OpenrCtrlBenchmarkFixture fixture(numKeys);
+
+    suspender.dismiss();
+    const auto startTime = std::chrono::steady_clock::now();
+    auto latencies =
+        fixture.runClients(api, numClients, kNumRequestsPerClient);
+    const auto elapsedUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startTime)
+            .count();
+    suspender.rehire();
+
+    counters["qps"] =
+        latencies.size() * 1000000 / std::max<int64_t>(elapsedUs, 1);
+    counters["p50_us"] = getPercentileUs(latencies, 50);
+    counters["p99_us"] = getPercentileUs(latencies, 99);
+  }
+}
+
+/**
+ * Measure time from a KvStore update until all of numSubscribers KvStore
+ * snoop streams received it
+ */
+static void
+BM_OpenrCtrlStreamFanout(
+    folly::UserCounters& counters, uint32_t iters, size_t numSubscribers) {
+  const std::string key("fanout-key");
+  for (uint32_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    OpenrCtrlBenchmarkFixture fixture(0 /* numKeys */);
+    auto& handler = fixture.getHandler();
+
+    std::atomic<size_t> received{0};
+    std::vector<folly::Function<void()>> cancelSubscriptions;
+    for (size_t j = 0; j < numSubscribers; ++j) {
+      auto subscription =
+          handler->subscribeKvStore().toClientStream().subscribeExTry(
+              folly::getEventBase(), [&received, &key](auto&& t) {
+                if (t.hasValue() and t->keyVals.count(key)) {
+                  ++received;
+                }
+              });
+      cancelSubscriptions.emplace_back(
+          [subscription = std::move(subscription)]() mutable {
+            subscription.cancel();
+            std::move(subscription).detach();
+          });
+    }
+    while (handler->getNumKvStorePublishers() != numSubscribers) {
+      std::this_thread::yield();
+    }
+
+    suspender.dismiss();
+    fixture.getKvStoreWrapper()->setKey(
+        key, createThriftValue(1, kNodeName, std::string("value")));
+    while (received < numSubscribers) {
+      std::this_thread::yield();
+    }
+    suspender.rehire();
+
+    counters["subscribers"] = numSubscribers;
+    for (auto& cancelSubscription : cancelSubscriptions) {
+      cancelSubscription();
+    }
+    while (handler->getNumKvStorePublishers() != 0) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+/**
+ * Measure route convergence on link metric change, i.e. time until Fib
+ * applied resulting route update, while numClients clients keep dumping
+ * numKeys keys of KvStore
+ */
+static void
+BM_OpenrCtrlLoadConvergence(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numClients,
+    size_t numKeys) {
+  for (uint32_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    OpenrCtrlBenchmarkFixture fixture(numKeys);
+    fixture.startLoad(CtrlApi::KVSTORE_KEY_VALS_AREA, numClients);
+
+    std::vector<std::chrono::microseconds> convergenceTimes;
+    suspender.dismiss();
+    for (size_t j = 0; j < kNumMetricFlips; ++j) {
+      convergenceTimes.emplace_back(fixture.flipLinkMetric());
+    }
+    suspender.rehire();
+
+    fixture.stopLoad();
+    counters["p50_convergence_us"] = getPercentileUs(convergenceTimes, 50);
+    counters["max_convergence_us"] = getPercentileUs(convergenceTimes, 100);
+  }
+}
+
+// The parameters are API, number of clients and number of KvStore keys
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrCtrlRead,
+    counters,
+    KvStoreKeyVals_1_10000,
+    CtrlApi::KVSTORE_KEY_VALS,
+    1,
+    10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrCtrlRead,
+    counters,
+    KvStoreKeyVals_16_10000,
+    CtrlApi::KVSTORE_KEY_VALS,
+    16,
+    10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrCtrlRead,
+    counters,
+    KvStoreKeyValsArea_1_10000,
+    CtrlApi::KVSTORE_KEY_VALS_AREA,
+    1,
+    10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrCtrlRead,
+    counters,
+    KvStoreKeyValsArea_16_10000,
+    CtrlApi::KVSTORE_KEY_VALS_AREA,
+    16,
+    10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrCtrlRead,
+    counters,
+    DecisionAdjDbs_16,
+    CtrlApi::DECISION_ADJ_DBS,
+    16,
+    0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrCtrlRead,
+    counters,
+    DecisionPrefixDbs_16,
+    CtrlApi::DECISION_PREFIX_DBS,
+    16,
+    0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrCtrlRead, counters, FibRouteDb_16, CtrlApi::FIB_ROUTE_DB, 16, 0);
+
+// The parameter is number of subscribers
+BENCHMARK_COUNTERS_NAME_PARAM(BM_OpenrCtrlStreamFanout, counters, 1, 1);
+BENCHMARK_COUNTERS_NAME_PARAM(BM_OpenrCtrlStreamFanout, counters, 100, 100);
+BENCHMARK_COUNTERS_NAME_PARAM(BM_OpenrCtrlStreamFanout, counters, 1000, 1000);
+
+// The parameters are number of loading clients and number of KvStore keys
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrCtrlLoadConvergence, counters, 0_100000, 0, 100000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrCtrlLoadConvergence, counters, 4_100000, 4, 100000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrCtrlLoadConvergence, counters, 16_100000, 16, 100000);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
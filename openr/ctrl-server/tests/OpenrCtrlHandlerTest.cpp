@@ -8,12 +8,14 @@
 #include <cstdio>
 #include <thread>
 
+#include <fb303/ServiceData.h>
 #include <fbzmq/service/monitor/ZmqMonitor.h>
 #include <fbzmq/zmq/Context.h>
 #include <folly/init/Init.h>
 #include <glog/logging.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 #include <thrift/lib/cpp2/util/ScopedServerThread.h>
 
@@ -89,6 +91,7 @@ class OpenrCtrlFixture : public ::testing::Test {
         std::chrono::seconds(2),
         routeUpdatesQueue_.getReader(),
         interfaceUpdatesQueue_.getReader(),
+        fibUpdatesQueue_,
         MonitorSubmitUrl{"inproc://monitor-sub"},
         kvStoreWrapper->getKvStore(),
         context_);
@@ -183,6 +186,7 @@ class OpenrCtrlFixture : public ::testing::Test {
     routeUpdatesQueue_.close();
     staticRoutesUpdatesQueue_.close();
     interfaceUpdatesQueue_.close();
+    fibUpdatesQueue_.close();
     peerUpdatesQueue_.close();
     neighborUpdatesQueue_.close();
     prefixUpdatesQueue_.close();
@@ -235,6 +239,7 @@ class OpenrCtrlFixture : public ::testing::Test {
 
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> routeUpdatesQueue_;
   messaging::ReplicateQueue<thrift::InterfaceDatabase> interfaceUpdatesQueue_;
+  messaging::ReplicateQueue<thrift::RouteDatabaseDelta> fibUpdatesQueue_;
   messaging::ReplicateQueue<thrift::PeerUpdateRequest> peerUpdatesQueue_;
   messaging::ReplicateQueue<thrift::SparkNeighborEvent> neighborUpdatesQueue_;
   messaging::ReplicateQueue<thrift::PrefixUpdateRequest> prefixUpdatesQueue_;
@@ -277,6 +282,35 @@ TEST_F(OpenrCtrlFixture, getMyNodeName) {
   EXPECT_EQ(nodeName, res);
 }
 
+TEST_F(OpenrCtrlFixture, CounterApis) {
+  facebook::fb303::fbData->setCounter("openr.ctrl_test.counter1", 1);
+  facebook::fb303::fbData->setCounter("openr.ctrl_test.counter2", 2);
+
+  {
+    std::map<std::string, int64_t> counters;
+    openrCtrlThriftClient_->sync_getCounters(counters);
+    EXPECT_EQ(1, counters.at("openr.ctrl_test.counter1"));
+    EXPECT_EQ(2, counters.at("openr.ctrl_test.counter2"));
+  }
+
+  // Matches of repeated regex are memoized, result remains the same
+  for (int i = 0; i < 2; ++i) {
+    std::map<std::string, int64_t> counters;
+    openrCtrlThriftClient_->sync_getRegexCounters(
+        counters, "ctrl_test\\.counter1");
+    EXPECT_EQ(1, counters.size());
+    EXPECT_EQ(1, counters.at("openr.ctrl_test.counter1"));
+  }
+
+  {
+    std::map<std::string, int64_t> counters;
+    openrCtrlThriftClient_->sync_getSelectedCounters(
+        counters, {"openr.ctrl_test.counter2", "openr.ctrl_test.unknown"});
+    EXPECT_EQ(1, counters.size());
+    EXPECT_EQ(2, counters.at("openr.ctrl_test.counter2"));
+  }
+}
+
 TEST_F(OpenrCtrlFixture, PrefixManagerApis) {
   {
     std::vector<thrift::PrefixEntry> prefixes{
@@ -376,6 +410,37 @@ TEST_F(OpenrCtrlFixture, RouteApis) {
   }
 }
 
+TEST_F(OpenrCtrlFixture, ConfigApis) {
+  thrift::OpenrConfig config;
+  openrCtrlThriftClient_->sync_getRunningConfigThrift(config);
+  EXPECT_EQ(nodeName, config.node_name);
+
+  // tuning changes are reloaded and reported as running config
+  config.kvstore_config.set_leaf_node_ref() = true;
+  config.kvstore_config.key_prefix_filters_ref() =
+      std::vector<std::string>{"adj:"};
+  config.decision_debounce_min_ms_ref() = 20;
+  config.decision_debounce_max_ms_ref() = 200;
+  std::string configStr;
+  apache::thrift::SimpleJSONSerializer::serialize(config, &configStr);
+  EXPECT_NO_THROW(openrCtrlThriftClient_->sync_reloadConfig(configStr));
+  thrift::OpenrConfig runningConfig;
+  openrCtrlThriftClient_->sync_getRunningConfigThrift(runningConfig);
+  EXPECT_EQ(config, runningConfig);
+
+  // structural changes and garbage are rejected
+  config.domain = "other";
+  configStr.clear();
+  apache::thrift::SimpleJSONSerializer::serialize(config, &configStr);
+  EXPECT_THROW(
+      openrCtrlThriftClient_->sync_reloadConfig(configStr),
+      thrift::OpenrError);
+  EXPECT_THROW(
+      openrCtrlThriftClient_->sync_reloadConfig("{"), thrift::OpenrError);
+  openrCtrlThriftClient_->sync_getRunningConfigThrift(config);
+  EXPECT_EQ(runningConfig, config);
+}
+
 TEST_F(OpenrCtrlFixture, PerfApis) {
   thrift::PerfDatabase db;
   openrCtrlThriftClient_->sync_getPerfDb(db);
@@ -485,6 +550,27 @@ TEST_F(OpenrCtrlFixture, KvStoreApis) {
     EXPECT_EQ(keyVals.at("key33"), pub.keyVals["key33"]);
     EXPECT_EQ(keyVals.at("key333"), pub.keyVals["key333"]);
   }
+  // repeated dump is served from cache till key-values change
+  {
+    thrift::Publication pub;
+    thrift::KeyDumpParams params;
+    params.prefix = "keyCache";
+
+    openrCtrlThriftClient_->sync_getKvStoreKeyValsFiltered(pub, params);
+    EXPECT_EQ(0, pub.keyVals.size());
+    openrCtrlThriftClient_->sync_getKvStoreKeyValsFiltered(pub, params);
+    EXPECT_EQ(0, pub.keyVals.size());
+
+    thrift::KeySetParams setParams;
+    setParams.keyVals.emplace(
+        "keyCache1", createThriftValue(1, "node1", std::string("value1")));
+    openrCtrlThriftClient_->sync_setKvStoreKeyVals(
+        setParams, thrift::KvStore_constants::kDefaultArea());
+
+    openrCtrlThriftClient_->sync_getKvStoreKeyValsFiltered(pub, params);
+    EXPECT_EQ(1, pub.keyVals.size());
+    EXPECT_EQ(1, pub.keyVals.count("keyCache1"));
+  }
   // with areas
   {
     thrift::Publication pub;
@@ -732,6 +818,122 @@ TEST_F(OpenrCtrlFixture, KvStoreApis) {
       std::this_thread::yield();
     }
   }
+
+  //
+  // Filtered Subscribe API
+  //
+
+  {
+    std::atomic<int> received{0};
+    const std::string key{"snoop-filter-key"};
+    auto handler = openrThriftServerWrapper_->getOpenrCtrlHandler();
+    thrift::KeyDumpParams filter;
+    filter.prefix = "snoop-filter";
+    auto subscription =
+        handler
+            ->subscribeKvStoreFilter(
+                std::make_unique<thrift::KeyDumpParams>(filter),
+                std::make_unique<std::string>("pod"))
+            .toClientStream()
+            .subscribeExTry(folly::getEventBase(), [&received, key](auto&& t) {
+              if (!t.hasValue()) {
+                return;
+              }
+              // Only matching keys of subscribed area are streamed
+              auto& pub = *t;
+              ASSERT_TRUE(pub.area_ref().has_value());
+              EXPECT_EQ("pod", pub.area_ref().value());
+              EXPECT_EQ(1, pub.keyVals.size());
+              ASSERT_EQ(1, pub.keyVals.count(key));
+              EXPECT_EQ(received + 1, pub.keyVals.at(key).version);
+              received++;
+            });
+    EXPECT_EQ(1, handler->getNumKvStorePublishers());
+    kvStoreWrapper->setKey(
+        "snoop-key",
+        createThriftValue(9, "node1", std::string("value1")),
+        std::nullopt,
+        "pod");
+    kvStoreWrapper->setKey(
+        key, createThriftValue(1, "node1", std::string("value1")));
+    kvStoreWrapper->setKey(
+        key,
+        createThriftValue(1, "node1", std::string("value1")),
+        std::nullopt,
+        "pod");
+    kvStoreWrapper->setKey(
+        key,
+        createThriftValue(2, "node1", std::string("value1")),
+        std::nullopt,
+        "pod");
+
+    // Check we should receive-2 updates
+    while (received < 2) {
+      std::this_thread::yield();
+    }
+
+    // Cancel subscription
+    subscription.cancel();
+    std::move(subscription).detach();
+
+    // Wait until publisher is destroyed
+    while (handler->getNumKvStorePublishers() != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  //
+  // Chunked Subscribe and Get API
+  //
+
+  {
+    std::atomic<int> received{0};
+    auto handler = openrThriftServerWrapper_->getOpenrCtrlHandler();
+    thrift::KeyDumpParams filter;
+    filter.prefix = "snoop";
+    filter.maxChunkKeyVals_ref() = 1;
+    auto subscription =
+        handler
+            ->subscribeAndGetKvStoreChunked(
+                std::make_unique<thrift::KeyDumpParams>(filter),
+                std::make_unique<std::string>(
+                    thrift::KvStore_constants::kDefaultArea()))
+            .toClientStream()
+            .subscribeExTry(folly::getEventBase(), [&received](auto&& t) {
+              if (!t.hasValue()) {
+                return;
+              }
+              // Snapshot of "snoop-key" and "snoop-filter-key" in a chunk
+              // each, followed by update
+              auto& pub = *t;
+              ASSERT_TRUE(pub.seqNum_ref().has_value());
+              EXPECT_EQ(received, pub.seqNum_ref().value());
+              EXPECT_EQ(1, pub.keyVals.size());
+              EXPECT_EQ(received == 0, pub.hasMoreChunks_ref().value_or(false));
+              if (received == 2) {
+                ASSERT_EQ(1, pub.keyVals.count("snoop-key"));
+                EXPECT_EQ(9, pub.keyVals.at("snoop-key").version);
+              }
+              received++;
+            });
+    EXPECT_EQ(1, handler->getNumKvStorePublishers());
+    kvStoreWrapper->setKey(
+        "snoop-key", createThriftValue(9, "node1", std::string("value1")));
+
+    // Check we should receive-2 snapshot chunks and 1 update
+    while (received < 3) {
+      std::this_thread::yield();
+    }
+
+    // Cancel subscription
+    subscription.cancel();
+    std::move(subscription).detach();
+
+    // Wait until publisher is destroyed
+    while (handler->getNumKvStorePublishers() != 0) {
+      std::this_thread::yield();
+    }
+  }
 }
 
 TEST_F(OpenrCtrlFixture, LinkMonitorApis) {
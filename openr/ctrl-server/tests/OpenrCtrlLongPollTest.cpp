@@ -310,6 +310,66 @@ TEST_F(LongPollFixture, LongPollAdjExpired) {
   ASSERT_TRUE(isAdjChanged);
 }
 
+TEST_F(LongPollFixture, LongPollAdjAreaGeneration) {
+  //
+  // This UT mimicks client resuming from generation of "adj:" keys of an area.
+  // Only "adj:" key change of that area wakes up client.
+  //
+  const auto area = thrift::KvStore_constants::kDefaultArea();
+  bool isTimeout = false;
+  int64_t generation{0};
+  int64_t newGeneration{0};
+  std::chrono::steady_clock::time_point startTime;
+  std::chrono::steady_clock::time_point endTime;
+
+  // unknown generation is answered immediately with current one
+  generation = client1_->sync_longPollKvStoreAdjArea(area, -1);
+  EXPECT_NE(-1, generation);
+
+  // mimick non-adj publication followed by adj one from kvstore
+  evl_.scheduleTimeout(std::chrono::milliseconds(1000), [&]() noexcept {
+    LOG(INFO) << "PrefixKey set...";
+    kvStoreWrapper_->setKey(
+        prefixKey_, createThriftValue(1, nodeName_, std::string("value1")));
+  });
+  evl_.scheduleTimeout(std::chrono::milliseconds(3000), [&]() noexcept {
+    LOG(INFO) << "AdjKey set...";
+    startTime = std::chrono::steady_clock::now();
+    kvStoreWrapper_->setKey(
+        adjKey_, createThriftValue(1, nodeName_, std::string("value1")));
+    evl_.stop();
+  });
+
+  std::thread evlThread([&]() { evl_.run(); });
+  evl_.waitUntilRunning();
+
+  try {
+    LOG(INFO) << "Start long poll...";
+    newGeneration = client1_->sync_longPollKvStoreAdjArea(area, generation);
+    endTime = std::chrono::steady_clock::now();
+    LOG(INFO) << "Finished long poll...";
+  } catch (std::exception& ex) {
+    LOG(INFO) << "Exception happened: " << folly::exceptionStr(ex);
+    isTimeout = true;
+  }
+
+  // woken up by adj key only, with bumped generation
+  ASSERT_FALSE(isTimeout);
+  ASSERT_LE(endTime - startTime, std::chrono::milliseconds(50));
+  EXPECT_EQ(generation + 1, newGeneration);
+
+  // client behind resumes immediately without waiting
+  EXPECT_EQ(
+      newGeneration, client1_->sync_longPollKvStoreAdjArea(area, generation));
+  EXPECT_EQ(
+      0,
+      openrThriftServerWrapper_->getOpenrCtrlHandler()
+          ->getNumPendingLongPollReqs());
+
+  evl_.waitUntilStopped();
+  evlThread.join();
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -7,11 +7,17 @@
 
 #include "Decision.h"
 
+#include <algorithm>
 #include <chrono>
+#include <limits>
+#include <map>
 #include <set>
+#include <stdexcept>
 #include <string>
+#include <tuple>
 #include <unordered_set>
 
+#include <boost/dynamic_bitset.hpp>
 #include <fb303/ServiceData.h>
 #include <fbzmq/service/logging/LogSample.h>
 #include <fbzmq/zmq/Zmq.h>
@@ -19,7 +25,10 @@
 #include <folly/MapUtil.h>
 #include <folly/Memory.h>
 #include <folly/Optional.h>
+#include <folly/ScopeGuard.h>
 #include <folly/String.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
 #include <folly/futures/Future.h>
 #if FOLLY_USE_SYMBOLIZER
 #include <folly/experimental/exception_tracer/ExceptionTracer.h>
@@ -28,6 +37,7 @@
 
 #include <openr/common/Constants.h>
 #include <openr/common/NetworkUtil.h>
+#include <openr/common/StatCounter.h>
 #include <openr/common/Util.h>
 #include <openr/decision/LinkState.h>
 #include <openr/decision/PrefixState.h>
@@ -40,10 +50,99 @@ using apache::thrift::FRAGILE;
 using apache::thrift::TEnumTraits;
 
 using Metric = openr::LinkStateMetric;
+using NodeId = openr::NodeId;
 
-using SpfResult = unordered_map<
-    string /* otherNodeName */,
-    pair<Metric, unordered_set<string /* nextHopNodeName */>>>;
+// Shortest paths from a single source node. Per node state is kept in flat
+// vectors indexed by NodeId. Nexthops are kept as a bitset over the neighbors
+// of the source and translated back to node names only when building routes
+class SpfResult {
+ public:
+  using NextHopSet = boost::dynamic_bitset<>;
+
+  bool
+  isReachable(NodeId nodeId) const {
+    return nodeId < metrics_.size() and metrics_[nodeId] != kUnreachable;
+  }
+
+  // nodeId must be reachable
+  Metric
+  getMetric(NodeId nodeId) const {
+    DCHECK(isReachable(nodeId));
+    return metrics_[nodeId];
+  }
+
+  // nodeId must be reachable
+  const NextHopSet&
+  getNextHops(NodeId nodeId) const {
+    DCHECK(isReachable(nodeId));
+    return nextHops_[nodeId];
+  }
+
+  void
+  set(NodeId nodeId, Metric metric, NextHopSet nextHops) {
+    if (nodeId >= metrics_.size()) {
+      metrics_.resize(nodeId + 1, kUnreachable);
+      nextHops_.resize(nodeId + 1);
+    }
+    if (metrics_[nodeId] == kUnreachable) {
+      ++size_;
+    }
+    metrics_[nodeId] = metric;
+    nextHops_[nodeId] = std::move(nextHops);
+  }
+
+  void
+  erase(NodeId nodeId) {
+    if (isReachable(nodeId)) {
+      --size_;
+      metrics_[nodeId] = kUnreachable;
+      nextHops_[nodeId].clear();
+    }
+  }
+
+  // number of reachable nodes
+  size_t
+  size() const {
+    return size_;
+  }
+
+  // ids of all reachable nodes are less than this
+  size_t
+  getNodeIdLimit() const {
+    return metrics_.size();
+  }
+
+  // bit representing the given neighbor of the source in NextHopSet
+  size_t
+  getNextHopIndex(NodeId neighborId) {
+    auto it = std::find(nextHopIds_.begin(), nextHopIds_.end(), neighborId);
+    if (it != nextHopIds_.end()) {
+      return std::distance(nextHopIds_.begin(), it);
+    }
+    nextHopIds_.emplace_back(neighborId);
+    return nextHopIds_.size() - 1;
+  }
+
+  // invoke f with the NodeId of every nexthop towards nodeId
+  template <typename F>
+  void
+  forEachNextHop(NodeId nodeId, F&& f) const {
+    auto const& nextHops = getNextHops(nodeId);
+    for (auto index = nextHops.find_first(); index != NextHopSet::npos;
+         index = nextHops.find_next(index)) {
+      f(nextHopIds_.at(index));
+    }
+  }
+
+ private:
+  static constexpr Metric kUnreachable{std::numeric_limits<Metric>::max()};
+
+  std::vector<Metric> metrics_;
+  std::vector<NextHopSet> nextHops_;
+  // neighbors of the source, indexed by their bit in NextHopSet
+  std::vector<NodeId> nextHopIds_;
+  size_t size_{0};
+};
 
 // Path starts from neighbor node and ends at destination. It's size must be
 // atleast one. Second attribute describe the link that is followed from
@@ -56,6 +155,82 @@ namespace {
 // Default HWM is 1k. We set it to 0 to buffer all received messages.
 const int kStoreSubReceiveHwm{0};
 
+// Register the latency histogram of one stage of the route computation.
+// Percentile 100 is exported as the max latency of each window.
+void
+addLatencyHistogram(folly::StringPiece key) {
+  fb303::fbData->addHistogram(
+      key,
+      Constants::kDecisionLatencyBucketWidth.count(),
+      0,
+      Constants::kDecisionLatencyMax.count());
+  fb303::fbData->exportHistogramPercentile(key, 50, 99, 100);
+}
+
+void
+addLatencyValue(
+    folly::StringPiece key, std::chrono::steady_clock::time_point startTime) {
+  auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  fb303::fbData->addHistogramValue(key, deltaTime.count());
+}
+
+// Types of route computation accounted in RouteDatabase.computationStats and
+// exported as decision.<type>.route_build_us / decision.<type>.routes
+const std::string kSpEcmpComputation{"sp_ecmp"};
+const std::string kKsp2EdEcmpComputation{"ksp2_ed_ecmp"};
+const std::string kBgpComputation{"bgp"};
+const std::string kMplsNodeLabelComputation{"mpls_node_label"};
+const std::string kMplsAdjLabelComputation{"mpls_adj_label"};
+const std::string kStaticComputation{"static"};
+
+void
+addComputationStats(
+    std::map<std::string, thrift::RouteComputationStats>& computationStats,
+    std::string const& type,
+    std::chrono::steady_clock::time_point startTime,
+    size_t numRoutes) {
+  auto& stats = computationStats[type];
+  stats.durationUs += std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - startTime)
+                          .count();
+  stats.numRoutes += numRoutes;
+}
+
+void
+exportComputationStats(
+    std::map<std::string, thrift::RouteComputationStats> const&
+        computationStats) {
+  for (auto const& kv : computationStats) {
+    fb303::fbData->addStatValue(
+        folly::sformat("decision.{}.route_build_us", kv.first),
+        kv.second.durationUs,
+        fb303::AVG);
+    fb303::fbData->addStatValue(
+        folly::sformat("decision.{}.routes", kv.first),
+        kv.second.numRoutes,
+        fb303::AVG);
+  }
+}
+
+// Metadata and metric vector of prefix entry only take part in best path
+// selection and route creation of BGP prefixes. Drop them from other entries
+// as they are received, so that they are neither kept, copied into prefix
+// databases of node nor compared on every update.
+void
+dropUnusedPrefixPayload(thrift::PrefixEntry& entry) {
+  if (entry.type == thrift::PrefixType::BGP) {
+    return;
+  }
+  if (not entry.data.empty() or entry.mv_ref().has_value()) {
+    fb303::fbData->addStatValue(
+        "decision.prefix_payloads_dropped", 1, fb303::COUNT);
+  }
+  entry.data.clear();
+  entry.data.shrink_to_fit();
+  entry.mv_ref().reset();
+}
+
 // check if path A is part of path B.
 // Example:
 // path A: a->b->c
@@ -84,77 +259,239 @@ pathAInPathB(const Path& a, const Path& b) {
   return false;
 }
 
+// NextHopSets may have been sized for a different number of neighbors of the
+// source, so align them before combining or comparing
+void
+addNextHop(SpfResult::NextHopSet& nextHops, size_t index) {
+  if (nextHops.size() <= index) {
+    nextHops.resize(index + 1);
+  }
+  nextHops.set(index);
+}
+
+void
+mergeNextHops(SpfResult::NextHopSet& dst, const SpfResult::NextHopSet& src) {
+  if (dst.size() == src.size()) {
+    dst |= src;
+    return;
+  }
+  for (auto index = src.find_first(); index != SpfResult::NextHopSet::npos;
+       index = src.find_next(index)) {
+    addNextHop(dst, index);
+  }
+}
+
+bool
+nextHopsEqual(
+    const SpfResult::NextHopSet& lhs, const SpfResult::NextHopSet& rhs) {
+  if (lhs.size() == rhs.size()) {
+    return lhs == rhs;
+  }
+  if (lhs.count() != rhs.count()) {
+    return false;
+  }
+  for (auto index = lhs.find_first(); index != SpfResult::NextHopSet::npos;
+       index = lhs.find_next(index)) {
+    if (index >= rhs.size() or not rhs.test(index)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // Classes needed for running Dijkstra
 class DijkstraQNode {
  public:
-  DijkstraQNode(const std::string& n, Metric d) : nodeName(n), distance(d) {}
-  const std::string nodeName;
+  NodeId nodeId{0};
   Metric distance{0};
-  std::unordered_set<std::string> nextHops;
+  SpfResult::NextHopSet nextHops;
 };
 
+// Indexed d-ary min-heap of nodes ordered by (distance, nodeId). Nodes live in
+// a flat array indexed by NodeId and the heap only shuffles ids around, so
+// there is no allocation per queued node and decreaseKey is a plain sift-up.
+// Pointers returned by get/extractMin stay valid for the lifetime of the queue
+// but the node is reset if it gets inserted again
 class DijkstraQ {
  private:
-  std::vector<std::shared_ptr<DijkstraQNode>> heap_;
-  std::unordered_map<std::string, std::shared_ptr<DijkstraQNode>> nameToNode_;
+  // wider nodes make the heap shallower, trading a few more comparisons in
+  // extractMin for cheaper decreaseKey
+  static constexpr size_t kArity{4};
+  static constexpr size_t kNotQueued{std::numeric_limits<size_t>::max()};
+
+  std::vector<DijkstraQNode> nodes_;
+  std::vector<NodeId> heap_;
+  std::vector<size_t> heapIndex_;
+
+  bool
+  isLess(NodeId a, NodeId b) const {
+    if (nodes_[a].distance != nodes_[b].distance) {
+      return nodes_[a].distance < nodes_[b].distance;
+    }
+    return a < b;
+  }
+
+  void
+  place(size_t index, NodeId nodeId) {
+    heap_[index] = nodeId;
+    heapIndex_[nodeId] = index;
+  }
+
+  void
+  siftUp(size_t index) {
+    const NodeId nodeId = heap_[index];
+    while (index > 0) {
+      const size_t parent = (index - 1) / kArity;
+      if (not isLess(nodeId, heap_[parent])) {
+        break;
+      }
+      place(index, heap_[parent]);
+      index = parent;
+    }
+    place(index, nodeId);
+  }
 
-  struct {
-    bool
-    operator()(
-        std::shared_ptr<DijkstraQNode> a,
-        std::shared_ptr<DijkstraQNode> b) const {
-      if (a->distance != b->distance) {
-        return a->distance > b->distance;
+  void
+  siftDown(size_t index) {
+    const NodeId nodeId = heap_[index];
+    while (true) {
+      const size_t firstChild = index * kArity + 1;
+      if (firstChild >= heap_.size()) {
+        break;
+      }
+      const size_t lastChild = std::min(firstChild + kArity, heap_.size());
+      size_t minChild = firstChild;
+      for (size_t child = firstChild + 1; child < lastChild; ++child) {
+        if (isLess(heap_[child], heap_[minChild])) {
+          minChild = child;
+        }
+      }
+      if (not isLess(heap_[minChild], nodeId)) {
+        break;
       }
-      return a->nodeName > b->nodeName;
+      place(index, heap_[minChild]);
+      index = minChild;
     }
-  } DijkstraQNodeGreater;
+    place(index, nodeId);
+  }
 
  public:
+  // all node ids ever inserted must be less than numNodeIds
+  explicit DijkstraQ(size_t numNodeIds)
+      : nodes_(numNodeIds), heapIndex_(numNodeIds, kNotQueued) {}
+
   void
-  insertNode(const std::string& nodeName, Metric d) {
-    heap_.push_back(std::make_shared<DijkstraQNode>(nodeName, d));
-    nameToNode_[nodeName] = heap_.back();
-    std::push_heap(heap_.begin(), heap_.end(), DijkstraQNodeGreater);
+  insertNode(NodeId nodeId, Metric d) {
+    CHECK_EQ(heapIndex_.at(nodeId), kNotQueued);
+    auto& node = nodes_[nodeId];
+    node.nodeId = nodeId;
+    node.distance = d;
+    node.nextHops.clear();
+    heap_.push_back(nodeId);
+    siftUp(heap_.size() - 1);
   }
 
-  std::shared_ptr<DijkstraQNode>
-  get(const std::string& nodeName) {
-    if (nameToNode_.count(nodeName)) {
-      return nameToNode_.at(nodeName);
+  DijkstraQNode*
+  get(NodeId nodeId) {
+    if (heapIndex_.at(nodeId) != kNotQueued) {
+      return &nodes_[nodeId];
     }
     return nullptr;
   }
 
-  std::shared_ptr<DijkstraQNode>
+  DijkstraQNode*
   extractMin() {
     if (heap_.empty()) {
       return nullptr;
     }
-    auto min = heap_.at(0);
-    CHECK(nameToNode_.erase(min->nodeName));
-    std::pop_heap(heap_.begin(), heap_.end(), DijkstraQNodeGreater);
+    const NodeId min = heap_.front();
+    const NodeId last = heap_.back();
     heap_.pop_back();
-    return min;
+    heapIndex_[min] = kNotQueued;
+    if (not heap_.empty()) {
+      place(0, last);
+      siftDown(0);
+    }
+    return &nodes_[min];
   }
 
   void
-  decreaseKey(const std::string& nodeName, Metric d) {
-    if (nameToNode_.count(nodeName)) {
-      if (nameToNode_.at(nodeName)->distance < d) {
-        throw std::invalid_argument(std::to_string(d));
-      }
-      nameToNode_.at(nodeName)->distance = d;
-      // this is a bit slow but is rarely called in our application. In fact,
-      // in networks where the metric is hop count, this will never be called
-      // and the Dijkstra run is no different than BFS
-      std::make_heap(heap_.begin(), heap_.end(), DijkstraQNodeGreater);
-    } else {
-      throw std::invalid_argument(nodeName);
+  decreaseKey(NodeId nodeId, Metric d) {
+    const size_t index = heapIndex_.at(nodeId);
+    if (index == kNotQueued) {
+      throw std::invalid_argument(std::to_string(nodeId));
+    }
+    if (nodes_[nodeId].distance < d) {
+      throw std::invalid_argument(std::to_string(d));
     }
+    nodes_[nodeId].distance = d;
+    siftUp(index);
   }
 };
 
+// key by which routes are indexed in DecisionRouteDb
+thrift::IpPrefix const&
+getRouteKey(thrift::UnicastRoute const& route) {
+  return route.dest;
+}
+
+int32_t
+getRouteKey(thrift::MplsRoute const& route) {
+  return route.topLabel;
+}
+
+// lowest metric among the nexthops of route. Routes without nexthops are the
+// least preferred ones when merging routes of areas
+template <typename Route>
+int64_t
+getBestNextHopMetric(Route const& route) {
+  int64_t bestMetric = std::numeric_limits<int64_t>::max();
+  for (auto const& nextHop : route.nextHops) {
+    bestMetric = std::min<int64_t>(bestMetric, nextHop.metric);
+  }
+  return bestMetric;
+}
+
+// merge route of an area into the route kept for the same key
+template <typename Key, typename Route>
+void
+mergeAreaRoute(std::unordered_map<Key, Route>& routes, Route&& route) {
+  const Key key = getRouteKey(route);
+  auto res = routes.try_emplace(key, std::move(route));
+  if (res.second) {
+    return;
+  }
+  auto& bestRoute = res.first->second;
+  const auto metric = getBestNextHopMetric(route);
+  const auto bestMetric = getBestNextHopMetric(bestRoute);
+  if (metric < bestMetric) {
+    bestRoute = std::move(route);
+    return;
+  }
+  if (metric > bestMetric) {
+    return;
+  }
+  // ECMP across areas
+  for (auto& nextHop : route.nextHops) {
+    if (std::find(
+            bestRoute.nextHops.begin(), bestRoute.nextHops.end(), nextHop) ==
+        bestRoute.nextHops.end()) {
+      bestRoute.nextHops.emplace_back(std::move(nextHop));
+    }
+  }
+}
+
+template <typename Key, typename Route>
+std::vector<Route>
+flattenRoutes(std::unordered_map<Key, Route>& routes) {
+  std::vector<Route> flatRoutes;
+  flatRoutes.reserve(routes.size());
+  for (auto& kv : routes) {
+    flatRoutes.emplace_back(std::move(kv.second));
+  }
+  return flatRoutes;
+}
+
 } // anonymous namespace
 
 namespace openr {
@@ -170,36 +507,54 @@ class SpfSolver::SpfSolverImpl {
       bool computeLfaPaths,
       bool enableOrderedFib,
       bool bgpDryRun,
-      bool bgpUseIgpMetric)
-      : myNodeName_(myNodeName),
+      bool bgpUseIgpMetric,
+      bool enableIncrementalSpf,
+      size_t numSpfThreads,
+      std::optional<size_t> maxPrefixesPerNode,
+      thrift::PrefixLimitAction prefixLimitAction)
+      : prefixState_(maxPrefixesPerNode, prefixLimitAction),
+        myNodeName_(myNodeName),
         enableV4_(enableV4),
         computeLfaPaths_(computeLfaPaths),
         enableOrderedFib_(enableOrderedFib),
         bgpDryRun_(bgpDryRun),
-        bgpUseIgpMetric_(bgpUseIgpMetric) {
+        bgpUseIgpMetric_(bgpUseIgpMetric),
+        enableIncrementalSpf_(enableIncrementalSpf) {
+    if (numSpfThreads > 0) {
+      spfExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+          numSpfThreads,
+          std::make_shared<folly::NamedThreadFactory>("DecisionSpf"));
+    }
+
     // Initialize stat keys
-    fb303::fbData->addStatExportType("decision.adj_db_update", fb303::COUNT);
     fb303::fbData->addStatExportType(
         "decision.incompatible_forwarding_type", fb303::COUNT);
     fb303::fbData->addStatExportType(
         "decision.missing_loopback_addr", fb303::SUM);
     fb303::fbData->addStatExportType(
-        "decision.no_route_to_label", fb303::COUNT);
+        "decision.prefix_limit_ignored_prefixes", fb303::SUM);
     fb303::fbData->addStatExportType(
-        "decision.no_route_to_prefix", fb303::COUNT);
+        "decision.no_route_to_label", fb303::COUNT);
     fb303::fbData->addStatExportType("decision.path_build_ms", fb303::AVG);
     fb303::fbData->addStatExportType("decision.path_build_runs", fb303::COUNT);
-    fb303::fbData->addStatExportType("decision.prefix_db_update", fb303::COUNT);
+    fb303::fbData->addStatExportType(
+        "decision.prefix_route_build_ms", fb303::AVG);
+    fb303::fbData->addStatExportType(
+        "decision.prefix_route_build_runs", fb303::COUNT);
     fb303::fbData->addStatExportType("decision.route_build_ms", fb303::AVG);
     fb303::fbData->addStatExportType("decision.route_build_runs", fb303::COUNT);
     fb303::fbData->addStatExportType(
         "decision.skipped_mpls_route", fb303::COUNT);
     fb303::fbData->addStatExportType(
         "decision.duplicate_node_label", fb303::COUNT);
-    fb303::fbData->addStatExportType(
-        "decision.skipped_unicast_route", fb303::COUNT);
     fb303::fbData->addStatExportType("decision.spf_ms", fb303::AVG);
     fb303::fbData->addStatExportType("decision.spf_runs", fb303::COUNT);
+    fb303::fbData->addStatExportType(
+        "decision.incremental_spf_ms", fb303::AVG);
+    fb303::fbData->addStatExportType(
+        "decision.incremental_spf_runs", fb303::COUNT);
+    addLatencyHistogram("decision.latency.spf_ms");
+    addLatencyHistogram("decision.latency.route_build_ms");
   }
 
   ~SpfSolverImpl() = default;
@@ -221,8 +576,10 @@ class SpfSolver::SpfSolverImpl {
 
   thrift::StaticRoutes const& getStaticRoutes();
 
-  // returns true if the prefixDb changed
-  bool updatePrefixDatabase(const thrift::PrefixDatabase& prefixDb);
+  // returns prefixes whose routes may have changed, empty if the prefixDb
+  // didn't change
+  std::unordered_set<thrift::IpPrefix> updatePrefixDatabase(
+      const thrift::PrefixDatabase& prefixDb);
 
   std::unordered_map<std::string /* nodeName */, thrift::PrefixDatabase>
   getPrefixDatabases();
@@ -231,9 +588,15 @@ class SpfSolver::SpfSolverImpl {
       const std::string& myNodeName);
   std::optional<thrift::RouteDatabase> buildRouteDb(
       const std::string& myNodeName);
+  std::optional<std::vector<thrift::UnicastRoute>> buildUnicastRoutes(
+      const std::string& myNodeName,
+      const std::unordered_set<thrift::IpPrefix>& prefixes);
 
   bool decrementHolds();
 
+  std::vector<thrift::IpPrefix> getActiveSummaries(
+      const std::vector<thrift::IpPrefix>& summaries);
+
   void updateGlobalCounters();
 
   std::optional<thrift::RouteDatabaseDelta> processStaticRouteUpdates();
@@ -242,21 +605,57 @@ class SpfSolver::SpfSolverImpl {
 
   bool staticRoutesUpdated();
 
-  static std::pair<Metric, std::unordered_set<std::string>> getMinCostNodes(
-      const SpfResult& spfResult, const std::set<std::string>& dstNodes);
+  std::pair<Metric, std::unordered_set<std::string>> getMinCostNodes(
+      const SpfResult& spfResult, const std::set<std::string>& dstNodes) const;
 
  private:
   // no copy
   SpfSolverImpl(SpfSolverImpl const&) = delete;
   SpfSolverImpl& operator=(SpfSolverImpl const&) = delete;
 
-  // run SPF and produce map from node name to next-hops that have shortest
-  // paths to it
+  // run SPF and produce the distance and next-hops that have shortest paths
+  // to every node reachable from nodeName
   SpfResult runSpf(
       const std::string& nodeName,
       bool useLinkMetric,
       const LinkState::LinkSet& linksToIgnore = {});
 
+  // update a previously computed SPF result of nodeName in place, given the
+  // end points of links which have changed since it was computed. Only the
+  // part of the shortest path tree affected by the changes is recomputed
+  void runIncrementalSpf(
+      const std::string& nodeName,
+      bool useLinkMetric,
+      const std::unordered_set<LinkState::NodePair>& changedLinks,
+      SpfResult& result);
+
+  // SPF result of nodeName, computed or brought up to date with the current
+  // link state (incrementally if possible) only when the cached one is stale
+  const SpfResult& getSpfResult(
+      const std::string& nodeName, bool useLinkMetric = true);
+
+  // bring cached result of nodeName up to date. Only reads LinkState, so
+  // different entries can be refreshed concurrently
+  void refreshSpfResult(
+      const std::string& nodeName,
+      bool useLinkMetric,
+      CachedSpfResult& cached);
+
+  // cached SPF result with link metric, must have been refreshed by
+  // getSpfResult for the current route build
+  const SpfResult& getCachedSpfResult(const std::string& nodeName) const;
+
+  // myNodeName and, if LFA is enabled, each of its neighbors
+  std::unordered_set<std::string> getSpfSources(
+      const std::string& myNodeName) const;
+
+  // create unicast routes (IP and IP2MPLS) towards given prefixes, or towards
+  // all known prefixes if prefixes is nullptr. SPF results of myNodeName's
+  // sources must be up to date
+  std::vector<thrift::UnicastRoute> createUnicastRoutes(
+      const std::string& myNodeName,
+      const std::unordered_set<thrift::IpPrefix>* prefixes = nullptr);
+
   // Trace all edge disjoint paths from source to destination node.
   // srcNodeDistances => map indicating distances of each node from source
   // Returns list of paths.
@@ -279,12 +678,17 @@ class SpfSolver::SpfSolverImpl {
       std::unordered_map<std::string, thrift::PrefixEntry> const& nodePrefixes,
       bool const isV4);
 
-  // helper function to find the nodes for the nexthop for bgp route
+  // helper function to find the nodes for the nexthop for bgp route. Result
+  // is memoized per prefix, see bgpBestPathCache_
   BestPathCalResult findDstNodesForBgpRoute(
       std::string const& myNodeName,
       thrift::IpPrefix const& prefix,
       std::unordered_map<std::string, thrift::PrefixEntry> const& nodePrefixes,
       bool const isV4);
+  BestPathCalResult computeDstNodesForBgpRoute(
+      std::string const& myNodeName,
+      thrift::IpPrefix const& prefix,
+      std::unordered_map<std::string, thrift::PrefixEntry> const& nodePrefixes);
 
   BestPathCalResult getBestAnnouncingNodes(
       std::string const& myNodeName,
@@ -301,9 +705,23 @@ class SpfSolver::SpfSolverImpl {
   // helper to filter overloaded nodes for anycast addresses
   BestPathCalResult maybeFilterDrainedNodes(BestPathCalResult&& result) const;
 
+  // attributes of links from myNodeName that nexthops of MPLS routes are
+  // built from: neighbor, interface, up state, metric, adjacency label and
+  // nexthop addresses
+  using LocalLinkAttrs = std::tuple<
+      std::string,
+      std::string,
+      bool,
+      Metric,
+      int32_t,
+      thrift::BinaryAddress,
+      thrift::BinaryAddress>;
+  std::vector<LocalLinkAttrs> getLocalLinkAttrs(
+      std::string const& myNodeName) const;
+
   // given curNode and the dst nodes, find 2spf paths from curNode to each
-  // dstNode
-  std::unordered_map<std::string, std::vector<std::pair<Path, Metric>>>
+  // dstNode. Paths are memoized until topology changes, see ksp2PathsCache_
+  std::unordered_map<std::string, std::vector<std::pair<Path, Metric>>> const&
   createOpenRKsp2EdRouteForNodes(
       std::string const& myNodeName,
       std::unordered_set<std::string> const& nodes);
@@ -345,6 +763,15 @@ class SpfSolver::SpfSolverImpl {
           nextHopNodes,
       std::optional<int32_t> swapLabel) const;
 
+  // Nexthops towards dstNodeNames as computed by getNextHopsThrift, memoized
+  // in nextHopsCache_ for the current batch of unicast routes. Returns
+  // nullptr if none of dstNodeNames is reachable
+  const std::vector<thrift::NextHopThrift>* getCachedNextHopsThrift(
+      const std::string& myNodeName,
+      const std::set<std::string>& dstNodeNames,
+      bool isV4,
+      bool perDestination);
+
   Metric findMinDistToNeighbor(
       const std::string& myNodeName, const std::string& neighborName) const;
 
@@ -359,16 +786,78 @@ class SpfSolver::SpfSolverImpl {
 
   thrift::StaticRoutes staticRoutes_;
 
-  std::vector<thrift::RouteDatabaseDelta> staticRoutesUpdates_;
+  // static MPLS routes to update, or to delete if unset, squashed by label
+  // across deltas received since they were last processed
+  std::unordered_map<int32_t, std::optional<thrift::MplsRoute>>
+      pendingStaticMplsRoutes_;
 
   // Save all direct next-hop distance from a given source node to a destination
   // node. We update it as we compute all LFA routes from perspective of source
-  std::unordered_map<
-      std::string /* source nodeName */,
-      unordered_map<
-          string /* otherNodeName */,
-          pair<Metric, unordered_set<string /* nextHopNodeName */>>>>
-      spfResults_;
+  struct CachedSpfResult {
+    SpfResult result;
+    // topology version of LinkState the result reflects, none if the result
+    // has not been computed yet
+    std::optional<uint64_t> topologyVersion;
+  };
+
+  // SPF results keyed by (source nodeName, useLinkMetric). Entries are only
+  // recomputed once LinkState topology has changed, see getSpfResult
+  std::unordered_map<std::pair<std::string, bool>, CachedSpfResult> spfCache_;
+
+  // Best announcers of a BGP prefix. Depends on the prefix entries, which
+  // invalidate it on update, and on reachability (and IGP metric) of the
+  // announcers, which is covered by the topology version
+  struct CachedBgpBestPath {
+    std::string myNodeName;
+    uint64_t topologyVersion{0};
+    BestPathCalResult result;
+  };
+  std::unordered_map<thrift::IpPrefix, CachedBgpBestPath> bgpBestPathCache_;
+
+  // Edge disjoint paths from myNodeName to each destination node computed so
+  // far for KSP2_ED_ECMP prefixes. Every destination costs an extra SPF run,
+  // hence paths are shared by all prefixes and rebuilds until topology
+  // changes
+  struct CachedKsp2Paths {
+    std::string myNodeName;
+    std::optional<uint64_t> topologyVersion;
+    std::unordered_map<std::string, std::vector<std::pair<Path, Metric>>>
+        pathsToNodes;
+  };
+  CachedKsp2Paths ksp2PathsCache_;
+
+  // MPLS routes from the last route build of myNodeName. A node label route
+  // is reused as long as label, metric and nexthop nodes of the shortest
+  // paths towards its node are the same; adjacency label routes as long as
+  // links of myNodeName are. Any change of links of myNodeName drops all of
+  // them. Not used along with LFA, whose nexthops depend on SPF results of
+  // neighbors as well
+  struct CachedNodeLabelRoute {
+    int32_t label{0};
+    Metric metric{0};
+    std::vector<std::string> nextHopNodes;
+    thrift::MplsRoute route;
+  };
+  struct CachedMplsRoutes {
+    std::string myNodeName;
+    std::vector<LocalLinkAttrs> localLinks;
+    std::unordered_map<std::string, CachedNodeLabelRoute> nodeLabelRoutes;
+    std::optional<std::vector<thrift::MplsRoute>> adjLabelRoutes;
+  };
+  CachedMplsRoutes mplsRoutesCache_;
+
+  // Nexthops keyed by (dstNodeNames, isV4, perDestination), shared by all
+  // prefixes announced by the same set of best nodes. Only valid while unicast
+  // routes are being created, see createUnicastRoutes
+  std::map<
+      std::tuple<std::set<std::string>, bool, bool>,
+      std::optional<std::vector<thrift::NextHopThrift>>,
+      std::less<>>
+      nextHopsCache_;
+
+  // Time and routes per type of route computation of the route build in
+  // progress, see addComputationStats
+  std::map<std::string, thrift::RouteComputationStats> computationStats_;
 
   const std::string myNodeName_;
 
@@ -384,6 +873,21 @@ class SpfSolver::SpfSolverImpl {
 
   // Use IGP metric in metric vector comparision
   const bool bgpUseIgpMetric_{false};
+
+  // Update SPF results incrementally on topology changes instead of running
+  // full Dijkstra
+  const bool enableIncrementalSpf_{true};
+
+  // stats updated per LSDB update, SPF or route
+  StatCounter adjDbUpdates_{"decision.adj_db_update", fb303::COUNT};
+  StatCounter prefixDbUpdates_{"decision.prefix_db_update", fb303::COUNT};
+  StatCounter spfCacheHits_{"decision.spf_cache_hits", fb303::COUNT};
+  StatCounter skippedUnicastRoutes_{
+      "decision.skipped_unicast_route", fb303::COUNT};
+  StatCounter noRouteToPrefixes_{"decision.no_route_to_prefix", fb303::COUNT};
+
+  // runs SPF from LFA neighbors in parallel, if configured
+  std::unique_ptr<folly::CPUThreadPoolExecutor> spfExecutor_;
 };
 
 std::pair<
@@ -396,7 +900,7 @@ SpfSolver::SpfSolverImpl::updateAdjacencyDatabase(
     holdUpTtl = getMyHopsToNode(newAdjacencyDb.thisNodeName);
     holdDownTtl = getMaxHopsToNode(newAdjacencyDb.thisNodeName) - holdUpTtl;
   }
-  fb303::fbData->addStatValue("decision.adj_db_update", 1, fb303::COUNT);
+  adjDbUpdates_.add();
   auto rc = linkState_.updateAdjacencyDatabase(
       newAdjacencyDb, holdUpTtl, holdDownTtl);
   return rc;
@@ -404,13 +908,20 @@ SpfSolver::SpfSolverImpl::updateAdjacencyDatabase(
 
 bool
 SpfSolver::SpfSolverImpl::staticRoutesUpdated() {
-  return staticRoutesUpdates_.size() > 0;
+  return not pendingStaticMplsRoutes_.empty();
 }
 
 void
 SpfSolver::SpfSolverImpl::pushRoutesDeltaUpdates(
     thrift::RouteDatabaseDelta& staticRoutesDelta) {
-  staticRoutesUpdates_.emplace_back(std::move(staticRoutesDelta));
+  // deletions of a delta override its updates of the same label
+  for (auto& route : staticRoutesDelta.mplsRoutesToUpdate) {
+    const auto topLabel = route.topLabel;
+    pendingStaticMplsRoutes_[topLabel] = std::move(route);
+  }
+  for (auto const& topLabel : staticRoutesDelta.mplsRoutesToDelete) {
+    pendingStaticMplsRoutes_[topLabel] = std::nullopt;
+  }
 }
 
 bool
@@ -423,9 +934,10 @@ SpfSolver::SpfSolverImpl::getMyHopsToNode(const std::string& nodeName) {
   if (myNodeName_ == nodeName) {
     return 0;
   }
-  auto spfResult = runSpf(myNodeName_, false);
-  if (spfResult.count(nodeName)) {
-    return spfResult.at(nodeName).first;
+  auto const& spfResult = getSpfResult(myNodeName_, false);
+  auto const nodeId = linkState_.getNodeId(nodeName);
+  if (nodeId.has_value() and spfResult.isReachable(*nodeId)) {
+    return spfResult.getMetric(*nodeId);
   }
   return getMaxHopsToNode(nodeName);
 }
@@ -433,8 +945,11 @@ SpfSolver::SpfSolverImpl::getMyHopsToNode(const std::string& nodeName) {
 Metric
 SpfSolver::SpfSolverImpl::getMaxHopsToNode(const std::string& nodeName) {
   Metric max = 0;
-  for (auto const& pathsFromNode : runSpf(nodeName, false)) {
-    max = std::max(max, pathsFromNode.second.first);
+  auto const& spfResult = getSpfResult(nodeName, false);
+  for (NodeId id = 0; id < spfResult.getNodeIdLimit(); ++id) {
+    if (spfResult.isReachable(id)) {
+      max = std::max(max, spfResult.getMetric(id));
+    }
   }
   return max;
 }
@@ -444,6 +959,63 @@ SpfSolver::SpfSolverImpl::decrementHolds() {
   return linkState_.decrementHolds();
 }
 
+std::vector<thrift::IpPrefix>
+SpfSolver::SpfSolverImpl::getActiveSummaries(
+    const std::vector<thrift::IpPrefix>& summaries) {
+  std::vector<thrift::IpPrefix> activeSummaries;
+  if (summaries.empty()) {
+    return activeSummaries;
+  }
+  std::vector<folly::CIDRNetwork> summaryNetworks;
+  summaryNetworks.reserve(summaries.size());
+  for (auto const& summary : summaries) {
+    summaryNetworks.emplace_back(toIPNetwork(summary));
+  }
+
+  // Summaries covering a prefix of this node, or a summary advertised by
+  // another border node, would never be withdrawn
+  auto const& spfResult = getSpfResult(myNodeName_);
+  std::vector<bool> isActive(summaries.size(), false);
+  size_t numActive{0};
+  for (auto const& kv : prefixState_.prefixes()) {
+    if (numActive == summaries.size()) {
+      break;
+    }
+    bool isComponent{false};
+    for (auto const& nodePrefix : kv.second) {
+      auto const& nodeName = nodePrefix.first;
+      if (nodeName == myNodeName_ or
+          nodePrefix.second.type == thrift::PrefixType::AREA_SUMMARY) {
+        continue;
+      }
+      auto const nodeId = linkState_.getNodeId(nodeName);
+      if (nodeId.has_value() and spfResult.isReachable(*nodeId)) {
+        isComponent = true;
+        break;
+      }
+    }
+    if (not isComponent) {
+      continue;
+    }
+    auto const network = toIPNetwork(kv.first);
+    for (size_t i = 0; i < summaryNetworks.size(); ++i) {
+      auto const& summaryNetwork = summaryNetworks.at(i);
+      if (not isActive.at(i) and network.second >= summaryNetwork.second and
+          network.first.inSubnet(summaryNetwork.first, summaryNetwork.second)) {
+        isActive.at(i) = true;
+        ++numActive;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < summaries.size(); ++i) {
+    if (isActive.at(i)) {
+      activeSummaries.emplace_back(summaries.at(i));
+    }
+  }
+  return activeSummaries;
+}
+
 bool
 SpfSolver::SpfSolverImpl::deleteAdjacencyDatabase(const std::string& nodeName) {
   return linkState_.deleteAdjacencyDatabase(nodeName);
@@ -459,13 +1031,46 @@ SpfSolver::SpfSolverImpl::getStaticRoutes() {
   return staticRoutes_;
 }
 
-bool
+std::unordered_set<thrift::IpPrefix>
 SpfSolver::SpfSolverImpl::updatePrefixDatabase(
     thrift::PrefixDatabase const& prefixDb) {
   auto const& nodeName = prefixDb.thisNodeName;
   VLOG(1) << "Updating prefix database for node " << nodeName;
-  fb303::fbData->addStatValue("decision.prefix_db_update", 1, fb303::COUNT);
-  return prefixState_.updatePrefixDatabase(prefixDb);
+  prefixDbUpdates_.add();
+
+  // host loopbacks of the node, empty if it has none
+  auto const& loopbacksV4 = prefixState_.getNodeHostLoopbacksV4();
+  auto const& loopbacksV6 = prefixState_.getNodeHostLoopbacksV6();
+  const auto oldLoopbackV4 =
+      folly::get_default(loopbacksV4, nodeName, thrift::BinaryAddress());
+  const auto oldLoopbackV6 =
+      folly::get_default(loopbacksV6, nodeName, thrift::BinaryAddress());
+
+  auto changedPrefixes = prefixState_.updatePrefixDatabase(prefixDb);
+  if (prefixState_.getNumIgnoredPrefixes()) {
+    fb303::fbData->addStatValue(
+        "decision.prefix_limit_ignored_prefixes",
+        prefixState_.getNumIgnoredPrefixes(),
+        fb303::SUM);
+  }
+  if (changedPrefixes.empty()) {
+    return changedPrefixes;
+  }
+  for (auto const& prefix : changedPrefixes) {
+    bgpBestPathCache_.erase(prefix);
+  }
+
+  // BGP routes use host loopbacks of the announcing nodes as nexthops, so a
+  // loopback change can affect the route of any prefix
+  if (oldLoopbackV4 !=
+          folly::get_default(loopbacksV4, nodeName, thrift::BinaryAddress()) or
+      oldLoopbackV6 !=
+          folly::get_default(loopbacksV6, nodeName, thrift::BinaryAddress())) {
+    for (auto const& kv : prefixState_.prefixes()) {
+      changedPrefixes.emplace(kv.first);
+    }
+  }
+  return changedPrefixes;
 }
 
 std::unordered_map<std::string /* nodeName */, thrift::PrefixDatabase>
@@ -476,76 +1081,79 @@ SpfSolver::SpfSolverImpl::getPrefixDatabases() {
 /**
  * Compute shortest-path routes from perspective of nodeName;
  */
-unordered_map<
-    string /* otherNodeName */,
-    pair<Metric, unordered_set<string /* nextHopNodeName */>>>
+SpfResult
 SpfSolver::SpfSolverImpl::runSpf(
     const std::string& thisNodeName,
     bool useLinkMetric,
     const LinkState::LinkSet& linksToIgnore) {
-  unordered_map<string, pair<Metric, unordered_set<string>>> result;
+  SpfResult result;
 
   fb303::fbData->addStatValue("decision.spf_runs", 1, fb303::COUNT);
   const auto startTime = std::chrono::steady_clock::now();
 
-  DijkstraQ q;
-  q.insertNode(thisNodeName, 0);
+  auto const maybeThisNodeId = linkState_.getNodeId(thisNodeName);
+  if (not maybeThisNodeId.has_value()) {
+    // node has never been part of the topology
+    return result;
+  }
+  const NodeId thisNodeId = *maybeThisNodeId;
+  auto const& adjacency = linkState_.getAdjacencySnapshot();
+
+  DijkstraQ q(linkState_.getNodeIdCount());
+  q.insertNode(thisNodeId, 0);
   uint64_t loop = 0;
   for (auto node = q.extractMin(); node; node = q.extractMin()) {
     ++loop;
     // we've found this node's shortest paths. record it
-    auto emplaceRc = result.emplace(
-        std::piecewise_construct,
-        std::forward_as_tuple(node->nodeName),
-        std::forward_as_tuple(node->distance, std::move(node->nextHops)));
-    CHECK(emplaceRc.second);
-
-    auto& recordedNodeName = emplaceRc.first->first;
-    auto& recordedNodeMetric = emplaceRc.first->second.first;
-    auto& recordedNodeNextHops = emplaceRc.first->second.second;
-
-    if (linkState_.isNodeOverloaded(recordedNodeName) &&
-        recordedNodeName != thisNodeName) {
+    const NodeId recordedNodeId = node->nodeId;
+    const Metric recordedNodeMetric = node->distance;
+    CHECK(not result.isReachable(recordedNodeId));
+    result.set(recordedNodeId, recordedNodeMetric, std::move(node->nextHops));
+    auto const& recordedNodeNextHops = result.getNextHops(recordedNodeId);
+
+    if (adjacency.isNodeIdOverloaded(recordedNodeId) &&
+        recordedNodeId != thisNodeId) {
       // no transit traffic through this node. we've recorded the nexthops to
       // this node, but will not consider any of it's adjancecies as offering
       // lower cost paths towards further away nodes. This effectively drains
       // traffic away from this node
       continue;
     }
-    // we have the shortest path nexthops for recordedNodeName. Use these
-    // nextHops for any node that is connected to recordedNodeName that doesn't
+    // we have the shortest path nexthops for recordedNodeId. Use these
+    // nextHops for any node that is connected to recordedNodeId that doesn't
     // already have a lower cost path from thisNodeName
     //
-    // this is the "relax" step in the Dijkstra Algorithm pseudocode in CLRS
-    for (const auto& link : linkState_.linksFromNode(recordedNodeName)) {
-      auto otherNodeName = link->getOtherNodeName(recordedNodeName);
-      if (!link->isUp() or result.count(otherNodeName) or
-          linksToIgnore.count(link)) {
+    // this is the "relax" step in the Dijkstra Algorithm pseudocode in CLRS.
+    // The snapshot only contains links which are up
+    for (const auto& edge : adjacency.edgesFromNodeId(recordedNodeId)) {
+      auto otherNodeId = edge.neighborId;
+      if (result.isReachable(otherNodeId) or
+          (not linksToIgnore.empty() and
+           linksToIgnore.count(adjacency.links[edge.linkIndex]))) {
         continue;
       }
-      auto metric =
-          useLinkMetric ? link->getMetricFromNode(recordedNodeName) : 1;
-      auto otherNode = q.get(otherNodeName);
+      auto metric = useLinkMetric ? edge.metric : 1;
+      auto otherNode = q.get(otherNodeId);
       if (!otherNode) {
-        q.insertNode(otherNodeName, recordedNodeMetric + metric);
-        otherNode = q.get(otherNodeName);
+        q.insertNode(otherNodeId, recordedNodeMetric + metric);
+        otherNode = q.get(otherNodeId);
       }
       if (otherNode->distance >= recordedNodeMetric + metric) {
-        // recordedNodeName is either along an alternate shortest path towards
-        // otherNodeName or is along a new shorter path. In either case,
-        // otherNodeName should use recordedNodeName's nextHops until it finds
+        // recordedNodeId is either along an alternate shortest path towards
+        // otherNodeId or is along a new shorter path. In either case,
+        // otherNodeId should use recordedNodeId's nextHops until it finds
         // some shorter path
         if (otherNode->distance > recordedNodeMetric + metric) {
           // if this is strictly better, forget about any other nexthops
           otherNode->nextHops.clear();
-          q.decreaseKey(otherNode->nodeName, recordedNodeMetric + metric);
+          q.decreaseKey(otherNode->nodeId, recordedNodeMetric + metric);
         }
-        otherNode->nextHops.insert(
-            recordedNodeNextHops.begin(), recordedNodeNextHops.end());
+        mergeNextHops(otherNode->nextHops, recordedNodeNextHops);
       }
-      if (otherNode->nextHops.empty()) {
+      if (otherNode->nextHops.none()) {
         // this node is directly connected to the source
-        otherNode->nextHops.emplace(otherNode->nodeName);
+        addNextHop(
+            otherNode->nextHops, result.getNextHopIndex(otherNode->nodeId));
       }
     }
   }
@@ -554,69 +1162,319 @@ SpfSolver::SpfSolverImpl::runSpf(
       std::chrono::steady_clock::now() - startTime);
   LOG(INFO) << "SPF elapsed time: " << deltaTime.count() << "ms.";
   fb303::fbData->addStatValue("decision.spf_ms", deltaTime.count(), fb303::AVG);
+  fb303::fbData->addHistogramValue(
+      "decision.latency.spf_ms", deltaTime.count());
   return result;
 }
 
-std::vector<Path>
-SpfSolver::SpfSolverImpl::traceEdgeDisjointPaths(
-    const std::string& srcNodeName,
-    const std::string& dstNodeName,
-    const SpfResult& spfResult,
-    const LinkState::LinkSet& linksToIgnore) {
-  std::vector<Path> paths;
+const SpfResult&
+SpfSolver::SpfSolverImpl::getSpfResult(
+    const std::string& nodeName, bool useLinkMetric) {
+  auto& cached = spfCache_[std::make_pair(nodeName, useLinkMetric)];
+  refreshSpfResult(nodeName, useLinkMetric, cached);
+  return cached.result;
+}
 
-  // Return immediately if destination node is not reachable
-  if (not spfResult.count(dstNodeName)) {
-    return paths;
+void
+SpfSolver::SpfSolverImpl::refreshSpfResult(
+    const std::string& nodeName,
+    bool useLinkMetric,
+    CachedSpfResult& cached) {
+  const auto topologyVersion = linkState_.getTopologyVersion();
+  if (cached.topologyVersion.has_value()) {
+    if (*cached.topologyVersion == topologyVersion) {
+      // nothing has changed since the last computation
+      spfCacheHits_.add();
+      return;
+    }
+    // result is empty if nodeName was not part of the topology back then
+    if (enableIncrementalSpf_ and cached.result.size()) {
+      auto changedLinks =
+          linkState_.getTopologyChangesSince(*cached.topologyVersion);
+      if (changedLinks.has_value()) {
+        runIncrementalSpf(
+            nodeName, useLinkMetric, *changedLinks, cached.result);
+        cached.topologyVersion = topologyVersion;
+        return;
+      }
+    }
   }
 
-  //
-  // Here we're tracing paths in reverse from destination node. We first pick
-  // neighbors of destination node which are on the shortest paths
-  //
-  std::unordered_set<std::pair<std::string, std::string>> visitedLinks;
-  // Starting with dummy entry for expanding paths
-  std::vector<Path> partialPaths = {{{dstNodeName, nullptr}}};
+  cached.result = runSpf(nodeName, useLinkMetric);
+  cached.topologyVersion = topologyVersion;
+}
 
-  //
-  // Now recursively trace all the partial paths to the source
-  //
-  while (partialPaths.size()) {
-    auto spurPath = std::move(partialPaths.back());
-    partialPaths.pop_back();
+const SpfResult&
+SpfSolver::SpfSolverImpl::getCachedSpfResult(
+    const std::string& nodeName) const {
+  return spfCache_.at(std::make_pair(nodeName, true)).result;
+}
 
-    const auto spurNode = folly::copy(spurPath.back().first);
+std::unordered_set<std::string>
+SpfSolver::SpfSolverImpl::getSpfSources(const std::string& myNodeName) const {
+  std::unordered_set<std::string> spfSources{myNodeName};
+  if (computeLfaPaths_) {
+    for (auto const& link : linkState_.linksFromNode(myNodeName)) {
+      if (link->isUp()) {
+        spfSources.emplace(link->getOtherNodeName(myNodeName));
+      }
+    }
+  }
+  return spfSources;
+}
 
-    // Clear dummy entry in the path
-    if (spurNode == dstNodeName) {
-      spurPath.clear();
+/**
+ * Dynamic update of shortest-path tree. The previous result stays valid for
+ * every node none of whose shortest paths go over a changed link. Those nodes
+ * can only see their paths improve or gain equal cost alternatives. So we
+ *  1) invalidate the nodes downstream of changed links in the old shortest
+ *     path DAG,
+ *  2) seed the Dijkstra queue from the boundary of the invalidated region and
+ *     from the changed links,
+ *  3) run Dijkstra from there, propagating only to nodes whose distance or
+ *     nexthops are actually changing.
+ */
+void
+SpfSolver::SpfSolverImpl::runIncrementalSpf(
+    const std::string& thisNodeName,
+    bool useLinkMetric,
+    const std::unordered_set<LinkState::NodePair>& changedLinks,
+    SpfResult& result) {
+  fb303::fbData->addStatValue(
+      "decision.incremental_spf_runs", 1, fb303::COUNT);
+  const auto startTime = std::chrono::steady_clock::now();
+
+  const NodeId thisNodeId = linkState_.getNodeId(thisNodeName).value();
+
+  // overloaded nodes, except source, carry no transit traffic (see runSpf)
+  auto const isTransitNode = [&](NodeId nodeId) {
+    return nodeId == thisNodeId or not linkState_.isNodeIdOverloaded(nodeId);
+  };
+  auto const getMetric = [useLinkMetric](const Link& link, NodeId nodeId) {
+    return useLinkMetric ? link.getMetricFromNodeId(nodeId) : 1;
+  };
+
+  // changed links in terms of node ids. Both ends are known to LinkState as
+  // it has seen the links
+  std::vector<std::pair<NodeId, NodeId>> changedNodeIds;
+  changedNodeIds.reserve(changedLinks.size());
+  for (auto const& nodePair : changedLinks) {
+    auto const id1 = linkState_.getNodeId(nodePair.first);
+    auto const id2 = linkState_.getNodeId(nodePair.second);
+    if (id1.has_value() and id2.has_value()) {
+      changedNodeIds.emplace_back(*id1, *id2);
     }
+  }
 
-    // If we have encountered source-node then include this path in
-    // the return value
-    if (spurNode == srcNodeName) {
-      paths.emplace_back(std::move(spurPath));
+  //
+  // Step-1 Invalidate nodes whose shortest paths may traverse a changed link.
+  // Metrics of changed links are not known anymore, so we conservatively
+  // invalidate the far end of every changed link along with it's subtree
+  //
+  std::vector<bool> isInvalidated(result.getNodeIdLimit(), false);
+  std::vector<NodeId> invalidatedNodes;
+  std::vector<NodeId> nodesToVisit;
+  auto const invalidateNode = [&](NodeId nodeId) {
+    if (nodeId != thisNodeId and result.isReachable(nodeId) and
+        not isInvalidated[nodeId]) {
+      isInvalidated[nodeId] = true;
+      invalidatedNodes.emplace_back(nodeId);
+      nodesToVisit.emplace_back(nodeId);
+    }
+  };
+  for (auto const& [id1, id2] : changedNodeIds) {
+    if (not result.isReachable(id1) or not result.isReachable(id2)) {
+      continue;
+    }
+    if (result.getMetric(id1) <= result.getMetric(id2)) {
+      invalidateNode(id2);
+    }
+    if (result.getMetric(id2) <= result.getMetric(id1)) {
+      invalidateNode(id1);
+    }
+  }
+  while (not nodesToVisit.empty()) {
+    const auto nodeId = nodesToVisit.back();
+    nodesToVisit.pop_back();
+    if (not isTransitNode(nodeId)) {
       continue;
     }
+    const auto nodeMetric = result.getMetric(nodeId);
+    for (auto const& link : linkState_.linksFromNodeId(nodeId)) {
+      if (not link->isUp()) {
+        continue;
+      }
+      auto const otherNodeId = link->getOtherNodeId(nodeId);
+      if (result.isReachable(otherNodeId) and
+          nodeMetric + getMetric(*link, nodeId) ==
+              result.getMetric(otherNodeId)) {
+        invalidateNode(otherNodeId);
+      }
+    }
+  }
+  for (auto const nodeId : invalidatedNodes) {
+    result.erase(nodeId);
+  }
 
-    // Iterate over all neighbors to expand spurPath further
-    for (auto& link : linkState_.linksFromNode(spurNode)) {
-      // Skip ignored links
-      // in some scenario, the nbrnode may not be
-      // accessible from srcNode, even though link between
+  //
+  // Step-2 Seed the queue. `relax` offers a path via nodeId (which must be
+  // reachable in result) to the other end of the link
+  //
+  DijkstraQ q(linkState_.getNodeIdCount());
+  auto const relax = [&](NodeId nodeId, const Link& link) {
+    auto const otherNodeId = link.getOtherNodeId(nodeId);
+    if (not link.isUp() or otherNodeId == thisNodeId) {
+      return;
+    }
+    const Metric distance = result.getMetric(nodeId) + getMetric(link, nodeId);
+    auto otherNode = q.get(otherNodeId);
+    if (not otherNode) {
+      if (result.isReachable(otherNodeId)) {
+        if (result.getMetric(otherNodeId) < distance) {
+          return;
+        }
+        // node with still valid shortest paths, this may be an improvement or
+        // an additional equal cost path
+        q.insertNode(otherNodeId, result.getMetric(otherNodeId));
+        otherNode = q.get(otherNodeId);
+        otherNode->nextHops = result.getNextHops(otherNodeId);
+      } else {
+        q.insertNode(otherNodeId, distance);
+        otherNode = q.get(otherNodeId);
+      }
+    }
+    if (otherNode->distance < distance) {
+      return;
+    }
+    if (otherNode->distance > distance) {
+      // if this is strictly better, forget about any other nexthops
+      otherNode->nextHops.clear();
+      q.decreaseKey(otherNodeId, distance);
+    }
+    if (nodeId == thisNodeId) {
+      // this node is directly connected to the source
+      addNextHop(otherNode->nextHops, result.getNextHopIndex(otherNodeId));
+    } else {
+      mergeNextHops(otherNode->nextHops, result.getNextHops(nodeId));
+    }
+  };
+  auto const relaxLinksBetween = [&](NodeId nodeId, NodeId otherNodeId) {
+    if (not result.isReachable(nodeId) or not isTransitNode(nodeId)) {
+      return;
+    }
+    for (auto const& link : linkState_.linksFromNodeId(nodeId)) {
+      if (link->getOtherNodeId(nodeId) == otherNodeId) {
+        relax(nodeId, *link);
+      }
+    }
+  };
+  for (auto const nodeId : invalidatedNodes) {
+    for (auto const& link : linkState_.linksFromNodeId(nodeId)) {
+      relaxLinksBetween(link->getOtherNodeId(nodeId), nodeId);
+    }
+  }
+  for (auto const& [id1, id2] : changedNodeIds) {
+    relaxLinksBetween(id1, id2);
+    relaxLinksBetween(id2, id1);
+  }
+
+  //
+  // Step-3 Dijkstra over the affected region
+  //
+  uint64_t loop = 0;
+  for (auto node = q.extractMin(); node; node = q.extractMin()) {
+    ++loop;
+    const NodeId recordedNodeId = node->nodeId;
+    if (result.isReachable(recordedNodeId) and
+        result.getMetric(recordedNodeId) == node->distance and
+        nextHopsEqual(result.getNextHops(recordedNodeId), node->nextHops)) {
+      // no change, nothing to propagate further
+      continue;
+    }
+    result.set(recordedNodeId, node->distance, std::move(node->nextHops));
+
+    if (not isTransitNode(recordedNodeId)) {
+      continue;
+    }
+    for (const auto& link : linkState_.linksFromNodeId(recordedNodeId)) {
+      relax(recordedNodeId, *link);
+    }
+  }
+
+  VLOG(3) << "Incremental Dijkstra loop count: " << loop << ", invalidated "
+          << invalidatedNodes.size() << " of " << result.size() << " nodes";
+  auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  LOG(INFO) << "Incremental SPF elapsed time: " << deltaTime.count() << "ms.";
+  fb303::fbData->addStatValue(
+      "decision.incremental_spf_ms", deltaTime.count(), fb303::AVG);
+  fb303::fbData->addHistogramValue(
+      "decision.latency.spf_ms", deltaTime.count());
+}
+
+std::vector<Path>
+SpfSolver::SpfSolverImpl::traceEdgeDisjointPaths(
+    const std::string& srcNodeName,
+    const std::string& dstNodeName,
+    const SpfResult& spfResult,
+    const LinkState::LinkSet& linksToIgnore) {
+  std::vector<Path> paths;
+
+  // Return immediately if destination node is not reachable
+  auto const dstNodeId = linkState_.getNodeId(dstNodeName);
+  if (not dstNodeId.has_value() or not spfResult.isReachable(*dstNodeId)) {
+    return paths;
+  }
+
+  //
+  // Here we're tracing paths in reverse from destination node. We first pick
+  // neighbors of destination node which are on the shortest paths
+  //
+  std::unordered_set<std::pair<std::string, std::string>> visitedLinks;
+  // Starting with dummy entry for expanding paths
+  std::vector<Path> partialPaths = {{{dstNodeName, nullptr}}};
+
+  //
+  // Now recursively trace all the partial paths to the source
+  //
+  while (partialPaths.size()) {
+    auto spurPath = std::move(partialPaths.back());
+    partialPaths.pop_back();
+
+    const auto spurNode = folly::copy(spurPath.back().first);
+
+    // Clear dummy entry in the path
+    if (spurNode == dstNodeName) {
+      spurPath.clear();
+    }
+
+    // If we have encountered source-node then include this path in
+    // the return value
+    if (spurNode == srcNodeName) {
+      paths.emplace_back(std::move(spurPath));
+      continue;
+    }
+
+    // Iterate over all neighbors to expand spurPath further
+    const NodeId spurNodeId = linkState_.getNodeId(spurNode).value();
+    for (auto& link : linkState_.linksFromNodeId(spurNodeId)) {
+      // Skip ignored links
+      // in some scenario, the nbrnode may not be
+      // accessible from srcNode, even though link between
       // spur node and nbrnode is still up. For example,
       // if spurnode is overloaded, and the only link between
       // nbrnode and rest of graph is through spurnode.
       // if neighbor node is over loaded skip it.
-      auto& nbrName = link->getOtherNodeName(spurNode);
+      const NodeId nbrId = link->getOtherNodeId(spurNodeId);
       if (!link->isUp() or linksToIgnore.count(link) or
-          spfResult.find(nbrName) == spfResult.end() or
-          linkState_.isNodeOverloaded(nbrName)) {
+          not spfResult.isReachable(nbrId) or
+          linkState_.isNodeIdOverloaded(nbrId)) {
         continue;
       }
+      auto& nbrName = link->getOtherNodeName(spurNode);
       auto& nbrIface = link->getIfaceFromNode(nbrName);
-      auto nbrMetric = spfResult.at(nbrName).first;
-      auto spurMetric = spfResult.at(spurNode).first;
+      auto nbrMetric = spfResult.getMetric(nbrId);
+      auto spurMetric = spfResult.getMetric(spurNodeId);
 
       // Ignore already seen neighbor (except source-node)
       if (visitedLinks.count({nbrName, nbrIface})) {
@@ -625,11 +1483,11 @@ SpfSolver::SpfSolverImpl::traceEdgeDisjointPaths(
 
       // Ignore links not on the shortest path
       // A link is on the shortest path iff following is true
-      if (nbrMetric + link->getMetricFromNode(nbrName) != spurMetric) {
+      if (nbrMetric + link->getMetricFromNodeId(nbrId) != spurMetric) {
         continue;
       }
 
-      CHECK_EQ(nbrMetric + link->getMetricFromNode(nbrName), spurMetric);
+      CHECK_EQ(nbrMetric + link->getMetricFromNodeId(nbrId), spurMetric);
       spurPath.emplace_back(std::make_pair(nbrName, link));
       partialPaths.emplace_back(std::move(spurPath));
       visitedLinks.emplace(nbrName, nbrIface);
@@ -653,19 +1511,36 @@ SpfSolver::SpfSolverImpl::buildPaths(const std::string& myNodeName) {
   auto const& startTime = std::chrono::steady_clock::now();
   fb303::fbData->addStatValue("decision.path_build_runs", 1, fb303::COUNT);
 
-  spfResults_.clear();
-  spfResults_[myNodeName] = runSpf(myNodeName, true);
-  if (computeLfaPaths_) {
-    // avoid duplicate iterations over a neighbor which can happen due to
-    // multiple adjacencies to it
-    std::unordered_set<std::string /* adjacent node name */> visitedAdjNodes;
-    for (auto const& link : linkState_.linksFromNode(myNodeName)) {
-      auto const& otherNodeName = link->getOtherNodeName(myNodeName);
-      // Skip if already visited
-      if (!visitedAdjNodes.insert(otherNodeName).second || !link->isUp()) {
+  // SPF is needed from myNodeName and, for LFA, from each of its neighbors
+  const auto spfSources = getSpfSources(myNodeName);
+
+  // bound the cache by forgetting results which are not needed right now.
+  // No references into the cache are held at this point
+  if (spfCache_.size() > Constants::kMaxSpfCacheSize) {
+    for (auto it = spfCache_.begin(); it != spfCache_.end();) {
+      if (it->first.second and spfSources.count(it->first.first)) {
+        ++it;
         continue;
       }
-      spfResults_[otherNodeName] = runSpf(otherNodeName, true);
+      it = spfCache_.erase(it);
+    }
+  }
+  if (spfExecutor_ and spfSources.size() > 1) {
+    // SPF runs are independent of each other. Cache entries are created here
+    // so that each task only touches it's own entry
+    std::vector<folly::SemiFuture<folly::Unit>> spfRuns;
+    spfRuns.reserve(spfSources.size());
+    for (auto const& source : spfSources) {
+      auto& cached = spfCache_[std::make_pair(source, true)];
+      spfRuns.emplace_back(
+          folly::via(spfExecutor_.get(), [this, &source, &cached]() {
+            refreshSpfResult(source, true, cached);
+          }).semi());
+    }
+    folly::collect(std::move(spfRuns)).get();
+  } else {
+    for (auto const& source : spfSources) {
+      getSpfResult(source);
     }
   }
 
@@ -678,30 +1553,25 @@ SpfSolver::SpfSolverImpl::buildPaths(const std::string& myNodeName) {
   return buildRouteDb(myNodeName);
 } // buildPaths
 
-std::optional<thrift::RouteDatabase>
-SpfSolver::SpfSolverImpl::buildRouteDb(const std::string& myNodeName) {
-  if (not linkState_.hasNode(myNodeName) or
-      spfResults_.count(myNodeName) == 0) {
-    return std::nullopt;
-  }
-
-  const auto startTime = std::chrono::steady_clock::now();
-  fb303::fbData->addStatValue("decision.route_build_runs", 1, fb303::COUNT);
-
-  thrift::RouteDatabase routeDb;
-  routeDb.thisNodeName = myNodeName;
-
-  //
-  // Create unicastRoutes - IP and IP2MPLS routes
-  //
+std::vector<thrift::UnicastRoute>
+SpfSolver::SpfSolverImpl::createUnicastRoutes(
+    const std::string& myNodeName,
+    const std::unordered_set<thrift::IpPrefix>* prefixes) {
+  std::vector<thrift::UnicastRoute> unicastRoutes;
   std::unordered_map<thrift::IpPrefix, BestPathCalResult> prefixToPerformKsp;
 
-  std::unordered_set<std::string> nodesForKsp;
+  // nexthops depend on LinkState, which may have changed since last call
+  nextHopsCache_.clear();
+  SCOPE_EXIT {
+    nextHopsCache_.clear();
+  };
+  unicastRoutes.reserve(
+      prefixes ? prefixes->size() : prefixState_.prefixes().size());
 
-  for (const auto& kv : prefixState_.prefixes()) {
-    const auto& prefix = kv.first;
-    const auto& nodePrefixes = kv.second;
+  std::unordered_set<std::string> nodesForKsp;
 
+  auto createRoute = [&](thrift::IpPrefix const& prefix,
+                         auto const& nodePrefixes) {
     bool hasBGP = false, hasNonBGP = false, missingMv = false;
     bool hasSpEcmp = false, hasKsp2EdEcmp = false;
     for (auto const& npKv : nodePrefixes) {
@@ -725,22 +1595,20 @@ SpfSolver::SpfSolverImpl::buildRouteDb(const std::string& myNodeName) {
       if (hasNonBGP) {
         LOG(ERROR) << "Skipping route for prefix " << toString(prefix)
                    << " which is advertised with BGP and non-BGP type.";
-        fb303::fbData->addStatValue(
-            "decision.skipped_unicast_route", 1, fb303::COUNT);
-        continue;
+        skippedUnicastRoutes_.add();
+        return;
       }
       if (missingMv) {
         LOG(ERROR) << "Skipping route for prefix " << toString(prefix)
                    << " at least one advertiser is missing its metric vector.";
-        fb303::fbData->addStatValue(
-            "decision.skipped_unicast_route", 1, fb303::COUNT);
-        continue;
+        skippedUnicastRoutes_.add();
+        return;
       }
     }
 
     // skip adding route for prefixes advertised by this node
     if (nodePrefixes.count(myNodeName) and not hasBGP) {
-      continue;
+      return;
     }
 
     // Check for enabledV4_
@@ -748,21 +1616,26 @@ SpfSolver::SpfSolverImpl::buildRouteDb(const std::string& myNodeName) {
     bool isV4Prefix = prefixStr.size() == folly::IPAddressV4::byteCount();
     if (isV4Prefix && !enableV4_) {
       LOG(WARNING) << "Received v4 prefix while v4 is not enabled.";
-      fb303::fbData->addStatValue(
-          "decision.skipped_unicast_route", 1, fb303::COUNT);
-      continue;
+      skippedUnicastRoutes_.add();
+      return;
     }
 
     const auto forwardingAlgorithm = hasKsp2EdEcmp and not hasSpEcmp
         ? thrift::PrefixForwardingAlgorithm::KSP2_ED_ECMP
         : thrift::PrefixForwardingAlgorithm::SP_ECMP;
 
+    const auto routeStartTime = std::chrono::steady_clock::now();
     if (forwardingAlgorithm == thrift::PrefixForwardingAlgorithm::SP_ECMP) {
       auto route = hasBGP
           ? createBGPRoute(myNodeName, prefix, nodePrefixes, isV4Prefix)
           : createOpenRRoute(myNodeName, prefix, nodePrefixes, isV4Prefix);
+      addComputationStats(
+          computationStats_,
+          hasBGP ? kBgpComputation : kSpEcmpComputation,
+          routeStartTime,
+          route.has_value() ? 1 : 0);
       if (route.has_value()) {
-        routeDb.unicastRoutes.emplace_back(std::move(route.value()));
+        unicastRoutes.emplace_back(std::move(route.value()));
       }
     } else {
       const auto nodes = getBestAnnouncingNodes(
@@ -773,11 +1646,31 @@ SpfSolver::SpfSolverImpl::buildRouteDb(const std::string& myNodeName) {
           nodesForKsp.insert(node);
         }
       }
+      addComputationStats(
+          computationStats_, kKsp2EdEcmpComputation, routeStartTime, 0);
+    }
+  };
+
+  auto const& allPrefixes = prefixState_.prefixes();
+  if (prefixes) {
+    // withdrawn prefixes have no entry, hence no route
+    for (auto const& prefix : *prefixes) {
+      auto it = allPrefixes.find(prefix);
+      if (it != allPrefixes.end()) {
+        createRoute(it->first, it->second);
+      }
+    }
+  } else {
+    for (auto const& kv : allPrefixes) {
+      createRoute(kv.first, kv.second);
     }
-  } // for prefixState_.prefixes()
+  }
 
-  auto routeToNodes = createOpenRKsp2EdRouteForNodes(myNodeName, nodesForKsp);
+  const auto ksp2StartTime = std::chrono::steady_clock::now();
+  auto const& routeToNodes =
+      createOpenRKsp2EdRouteForNodes(myNodeName, nodesForKsp);
 
+  size_t numKsp2Routes{0};
   for (const auto& kv : prefixToPerformKsp) {
     auto unicastRoute = selectKsp2Routes(
         kv.first,
@@ -786,13 +1679,64 @@ SpfSolver::SpfSolverImpl::buildRouteDb(const std::string& myNodeName) {
         routeToNodes,
         prefixState_.prefixes().at(kv.first));
     if (unicastRoute.has_value()) {
-      routeDb.unicastRoutes.emplace_back(std::move(unicastRoute.value()));
+      unicastRoutes.emplace_back(std::move(unicastRoute.value()));
+      ++numKsp2Routes;
     }
   }
+  if (not nodesForKsp.empty() or numKsp2Routes) {
+    addComputationStats(
+        computationStats_,
+        kKsp2EdEcmpComputation,
+        ksp2StartTime,
+        numKsp2Routes);
+  }
+
+  return unicastRoutes;
+}
+
+std::optional<thrift::RouteDatabase>
+SpfSolver::SpfSolverImpl::buildRouteDb(const std::string& myNodeName) {
+  if (not linkState_.hasNode(myNodeName)) {
+    return std::nullopt;
+  }
+
+  // route computation below reads SPF results of these sources from cache.
+  // This is a no-op when called through buildPaths
+  for (auto const& source : getSpfSources(myNodeName)) {
+    getSpfResult(source);
+  }
+
+  const auto startTime = std::chrono::steady_clock::now();
+  fb303::fbData->addStatValue("decision.route_build_runs", 1, fb303::COUNT);
+
+  thrift::RouteDatabase routeDb;
+  routeDb.thisNodeName = myNodeName;
+  computationStats_.clear();
+
+  //
+  // Create unicastRoutes - IP and IP2MPLS routes
+  //
+  routeDb.unicastRoutes = createUnicastRoutes(myNodeName);
 
   //
   // Create MPLS routes for all nodeLabel
   //
+  auto mplsStartTime = std::chrono::steady_clock::now();
+  const bool useMplsRoutesCache = not computeLfaPaths_;
+  if (useMplsRoutesCache) {
+    auto localLinks = getLocalLinkAttrs(myNodeName);
+    if (mplsRoutesCache_.myNodeName != myNodeName or
+        mplsRoutesCache_.localLinks != localLinks) {
+      mplsRoutesCache_.myNodeName = myNodeName;
+      mplsRoutesCache_.localLinks = std::move(localLinks);
+      mplsRoutesCache_.nodeLabelRoutes.clear();
+      mplsRoutesCache_.adjLabelRoutes.reset();
+    }
+  }
+  // cached routes of nodes visited below, stale ones are dropped
+  std::unordered_map<std::string, CachedNodeLabelRoute> nodeLabelRoutes;
+  auto const& mySpfResult = getCachedSpfResult(myNodeName);
+
   std::unordered_map<int32_t, std::pair<std::string, thrift::MplsRoute>>
       labelToNode;
   for (const auto& kv : linkState_.getAdjacencyDatabases()) {
@@ -837,6 +1781,32 @@ SpfSolver::SpfSolverImpl::buildRouteDb(const std::string& myNodeName) {
       continue;
     }
 
+    // Reuse route if shortest paths towards the node are the same
+    CachedNodeLabelRoute spfState;
+    spfState.label = topLabel;
+    const auto nodeId = linkState_.getNodeId(adjDb.thisNodeName);
+    if (useMplsRoutesCache and nodeId.has_value() and
+        mySpfResult.isReachable(*nodeId)) {
+      spfState.metric = mySpfResult.getMetric(*nodeId);
+      mySpfResult.forEachNextHop(*nodeId, [&](NodeId nhId) {
+        spfState.nextHopNodes.emplace_back(linkState_.getNodeName(nhId));
+      });
+      std::sort(spfState.nextHopNodes.begin(), spfState.nextHopNodes.end());
+
+      auto it = mplsRoutesCache_.nodeLabelRoutes.find(adjDb.thisNodeName);
+      if (it != mplsRoutesCache_.nodeLabelRoutes.end() and
+          it->second.label == spfState.label and
+          it->second.metric == spfState.metric and
+          it->second.nextHopNodes == spfState.nextHopNodes) {
+        fb303::fbData->addStatValue(
+            "decision.mpls_route_cache_hits", 1, fb303::COUNT);
+        labelToNode[topLabel] =
+            std::make_pair(adjDb.thisNodeName, it->second.route);
+        nodeLabelRoutes.emplace(adjDb.thisNodeName, std::move(it->second));
+        continue;
+      }
+    }
+
     // Get best nexthop towards the node
     auto metricNhs =
         getNextHopsWithMetric(myNodeName, {adjDb.thisNodeName}, false);
@@ -863,6 +1833,13 @@ SpfSolver::SpfSolverImpl::buildRouteDb(const std::string& myNodeName) {
     labelToNode[topLabel] = std::make_pair(
         adjDb.thisNodeName,
         createMplsRoute(topLabel, std::move(nextHopsThrift)));
+    if (useMplsRoutesCache and not spfState.nextHopNodes.empty()) {
+      spfState.route = labelToNode[topLabel].second;
+      nodeLabelRoutes.emplace(adjDb.thisNodeName, std::move(spfState));
+    }
+  }
+  if (useMplsRoutesCache) {
+    mplsRoutesCache_.nodeLabelRoutes = std::move(nodeLabelRoutes);
   }
   std::transform(
       labelToNode.begin(),
@@ -870,41 +1847,105 @@ SpfSolver::SpfSolverImpl::buildRouteDb(const std::string& myNodeName) {
       std::back_inserter(routeDb.mplsRoutes),
       [](const std::pair<int32_t, std::pair<std::string, thrift::MplsRoute>>&
              kv) -> thrift::MplsRoute { return kv.second.second; });
+  addComputationStats(
+      computationStats_,
+      kMplsNodeLabelComputation,
+      mplsStartTime,
+      routeDb.mplsRoutes.size());
 
   //
   // Create MPLS routes for all of our adjacencies
   //
-  for (const auto& link : linkState_.linksFromNode(myNodeName)) {
-    const auto topLabel = link->getAdjLabelFromNode(myNodeName);
-    // Top label is not set => Non-SR mode
-    if (topLabel == 0) {
-      continue;
+  mplsStartTime = std::chrono::steady_clock::now();
+  const auto numNodeLabelRoutes = routeDb.mplsRoutes.size();
+  if (useMplsRoutesCache and mplsRoutesCache_.adjLabelRoutes.has_value()) {
+    routeDb.mplsRoutes.insert(
+        routeDb.mplsRoutes.end(),
+        mplsRoutesCache_.adjLabelRoutes->begin(),
+        mplsRoutesCache_.adjLabelRoutes->end());
+  } else {
+    for (const auto& link : linkState_.linksFromNode(myNodeName)) {
+      const auto topLabel = link->getAdjLabelFromNode(myNodeName);
+      // Top label is not set => Non-SR mode
+      if (topLabel == 0) {
+        continue;
+      }
+      // If mpls label is not valid then ignore it
+      if (not isMplsLabelValid(topLabel)) {
+        LOG(ERROR) << "Ignoring invalid adjacency label " << topLabel
+                   << " of link " << link->directionalToString(myNodeName);
+        fb303::fbData->addStatValue(
+            "decision.skipped_mpls_route", 1, fb303::COUNT);
+        continue;
+      }
+
+      auto nh = createNextHop(
+          link->getNhV6FromNode(myNodeName),
+          link->getIfaceFromNode(myNodeName),
+          link->getMetricFromNode(myNodeName),
+          createMplsAction(thrift::MplsActionCode::PHP));
+      routeDb.mplsRoutes.emplace_back(
+          createMplsRoute(topLabel, {std::move(nh)}));
     }
-    // If mpls label is not valid then ignore it
-    if (not isMplsLabelValid(topLabel)) {
-      LOG(ERROR) << "Ignoring invalid adjacency label " << topLabel
-                 << " of link " << link->directionalToString(myNodeName);
-      fb303::fbData->addStatValue(
-          "decision.skipped_mpls_route", 1, fb303::COUNT);
-      continue;
+    if (useMplsRoutesCache) {
+      mplsRoutesCache_.adjLabelRoutes.emplace(
+          routeDb.mplsRoutes.begin() + numNodeLabelRoutes,
+          routeDb.mplsRoutes.end());
     }
-
-    auto nh = createNextHop(
-        link->getNhV6FromNode(myNodeName),
-        link->getIfaceFromNode(myNodeName),
-        link->getMetricFromNode(myNodeName),
-        createMplsAction(thrift::MplsActionCode::PHP));
-    routeDb.mplsRoutes.emplace_back(createMplsRoute(topLabel, {std::move(nh)}));
   }
+  addComputationStats(
+      computationStats_,
+      kMplsAdjLabelComputation,
+      mplsStartTime,
+      routeDb.mplsRoutes.size() - numNodeLabelRoutes);
+
+  exportComputationStats(computationStats_);
+  routeDb.computationStats_ref() = std::move(computationStats_);
+  computationStats_.clear();
 
   auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(
       std::chrono::steady_clock::now() - startTime);
   LOG(INFO) << "Decision::buildRouteDb took " << deltaTime.count() << "ms.";
   fb303::fbData->addStatValue(
       "decision.route_build_ms", deltaTime.count(), fb303::AVG);
+  fb303::fbData->addHistogramValue(
+      "decision.latency.route_build_ms", deltaTime.count());
   return routeDb;
 } // buildRouteDb
 
+std::optional<std::vector<thrift::UnicastRoute>>
+SpfSolver::SpfSolverImpl::buildUnicastRoutes(
+    const std::string& myNodeName,
+    const std::unordered_set<thrift::IpPrefix>& prefixes) {
+  if (not linkState_.hasNode(myNodeName)) {
+    return std::nullopt;
+  }
+
+  // topology hasn't changed, so these are normally served from cache
+  for (auto const& source : getSpfSources(myNodeName)) {
+    getSpfResult(source);
+  }
+
+  const auto startTime = std::chrono::steady_clock::now();
+  fb303::fbData->addStatValue(
+      "decision.prefix_route_build_runs", 1, fb303::COUNT);
+
+  computationStats_.clear();
+  auto unicastRoutes = createUnicastRoutes(myNodeName, &prefixes);
+  exportComputationStats(computationStats_);
+  computationStats_.clear();
+
+  auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  VLOG(1) << "Decision::buildUnicastRoutes for " << prefixes.size()
+          << " prefixes took " << deltaTime.count() << "ms.";
+  fb303::fbData->addStatValue(
+      "decision.prefix_route_build_ms", deltaTime.count(), fb303::AVG);
+  fb303::fbData->addHistogramValue(
+      "decision.latency.route_build_ms", deltaTime.count());
+  return unicastRoutes;
+}
+
 BestPathCalResult
 SpfSolver::SpfSolverImpl::getBestAnnouncingNodes(
     std::string const& myNodeName,
@@ -950,7 +1991,7 @@ SpfSolver::SpfSolverImpl::getBestAnnouncingNodes(
     return maybeFilterDrainedNodes(std::move(bestPathCalRes));
   } else if (not bestPathCalRes.success) {
     LOG(WARNING) << "No route to BGP prefix " << toString(prefix);
-    fb303::fbData->addStatValue("decision.no_route_to_prefix", 1, fb303::COUNT);
+    noRouteToPrefixes_.add();
   } else {
     VLOG(2) << "Ignoring route to BGP prefix " << toString(prefix)
             << ". Best path originated by self.";
@@ -1010,26 +2051,17 @@ SpfSolver::SpfSolverImpl::createOpenRRoute(
   const bool perDestination = getPrefixForwardingType(nodePrefixes) ==
       thrift::PrefixForwardingType::SR_MPLS;
 
-  const auto metricNhs =
-      getNextHopsWithMetric(myNodeName, prefixNodes, perDestination);
-  if (metricNhs.second.empty()) {
+  // Convert list of neighbor nodes to nexthops (considering adjacencies)
+  const auto nextHops =
+      getCachedNextHopsThrift(myNodeName, prefixNodes, isV4, perDestination);
+  if (not nextHops) {
     LOG(WARNING) << "No route to prefix " << toString(prefix)
                  << ", advertised by: " << folly::join(", ", prefixNodes);
-    fb303::fbData->addStatValue("decision.no_route_to_prefix", 1, fb303::COUNT);
+    noRouteToPrefixes_.add();
     return std::nullopt;
   }
 
-  // Convert list of neighbor nodes to nexthops (considering adjacencies)
-  return createUnicastRoute(
-      prefix,
-      getNextHopsThrift(
-          myNodeName,
-          prefixNodes,
-          isV4,
-          perDestination,
-          metricNhs.first,
-          metricNhs.second,
-          std::nullopt));
+  return createUnicastRoute(prefix, *nextHops);
 }
 
 BestPathCalResult
@@ -1037,16 +2069,36 @@ SpfSolver::SpfSolverImpl::findDstNodesForBgpRoute(
     std::string const& myNodeName,
     thrift::IpPrefix const& prefix,
     std::unordered_map<std::string, thrift::PrefixEntry> const& nodePrefixes,
-    bool const isV4) {
+    bool const /* isV4 */) {
+  const auto topologyVersion = linkState_.getTopologyVersion();
+  auto& cached = bgpBestPathCache_[prefix];
+  if (cached.myNodeName == myNodeName and
+      cached.topologyVersion == topologyVersion and cached.result.success) {
+    fb303::fbData->addStatValue(
+        "decision.bgp_best_path_cache_hits", 1, fb303::COUNT);
+    return cached.result;
+  }
+
+  cached.myNodeName = myNodeName;
+  cached.topologyVersion = topologyVersion;
+  cached.result = computeDstNodesForBgpRoute(myNodeName, prefix, nodePrefixes);
+  return cached.result;
+}
+
+BestPathCalResult
+SpfSolver::SpfSolverImpl::computeDstNodesForBgpRoute(
+    std::string const& myNodeName,
+    thrift::IpPrefix const& prefix,
+    std::unordered_map<std::string, thrift::PrefixEntry> const& nodePrefixes) {
   BestPathCalResult ret;
-  const auto& mySpfResult = spfResults_.at(myNodeName);
+  const auto& mySpfResult = getCachedSpfResult(myNodeName);
   for (auto const& kv : nodePrefixes) {
     auto const& nodeName = kv.first;
     auto const& prefixEntry = kv.second;
 
     // Skip unreachable nodes
-    auto it = mySpfResult.find(nodeName);
-    if (it == mySpfResult.end()) {
+    auto const nodeId = linkState_.getNodeId(nodeName);
+    if (not nodeId.has_value() or not mySpfResult.isReachable(*nodeId)) {
       LOG(ERROR) << "No route to " << nodeName
                  << ". Skipping considering this.";
       // skip if no route to node
@@ -1063,27 +2115,32 @@ SpfSolver::SpfSolverImpl::findDstNodesForBgpRoute(
       continue;
     }
 
-    // Copy is intentional - As we will need to augment metric vector with
-    // IGP_COST
-    thrift::MetricVector metricVector = prefixEntry.mv.value();
-
-    // Associate IGP_COST to prefixEntry
+    // Associate IGP_COST to prefixEntry. Metric vector is only copied if it
+    // needs to be augmented with it
+    std::optional<thrift::MetricVector> igpMetricVector;
     if (bgpUseIgpMetric_) {
-      const auto igpMetric = static_cast<int64_t>(it->second.first);
+      igpMetricVector = prefixEntry.mv.value();
+      const auto igpMetric =
+          static_cast<int64_t>(mySpfResult.getMetric(*nodeId));
       if (not ret.bestIgpMetric.has_value() or
           *(ret.bestIgpMetric) > igpMetric) {
         ret.bestIgpMetric = igpMetric;
       }
-      metricVector.metrics.emplace_back(MetricVectorUtils::createMetricEntity(
-          static_cast<int64_t>(thrift::MetricEntityType::OPENR_IGP_COST),
-          static_cast<int64_t>(thrift::MetricEntityPriority::OPENR_IGP_COST),
-          thrift::CompareType::WIN_IF_NOT_PRESENT,
-          false, /* isBestPathTieBreaker */
-          /* lowest metric wins */
-          {-1 * igpMetric}));
+      igpMetricVector->metrics.emplace_back(
+          MetricVectorUtils::createMetricEntity(
+              static_cast<int64_t>(thrift::MetricEntityType::OPENR_IGP_COST),
+              static_cast<int64_t>(
+                  thrift::MetricEntityPriority::OPENR_IGP_COST),
+              thrift::CompareType::WIN_IF_NOT_PRESENT,
+              false, /* isBestPathTieBreaker */
+              /* lowest metric wins */
+              {-1 * igpMetric}));
       VLOG(2) << "Attaching IGP metric of " << igpMetric << " to prefix "
               << toString(prefix) << " for node " << nodeName;
     }
+    auto const& metricVector = igpMetricVector.has_value()
+        ? *igpMetricVector
+        : prefixEntry.mv.value();
 
     switch (ret.bestVector.has_value()
                 ? MetricVectorUtils::compareMetricVectors(
@@ -1093,7 +2150,7 @@ SpfSolver::SpfSolverImpl::findDstNodesForBgpRoute(
       ret.nodes.clear();
       FOLLY_FALLTHROUGH;
     case MetricVectorUtils::CompareResult::TIE_WINNER:
-      ret.bestVector = std::move(metricVector);
+      ret.bestVector = metricVector;
       ret.bestData = &(prefixEntry.data);
       ret.bestNode = nodeName;
       FOLLY_FALLTHROUGH;
@@ -1138,8 +2195,7 @@ SpfSolver::SpfSolverImpl::createBGPRoute(
     // is no path to it
     if (not dstInfo.nodes.count(myNodeName)) {
       LOG(WARNING) << "No route to BGP prefix " << toString(prefix);
-      fb303::fbData->addStatValue(
-          "decision.no_route_to_prefix", 1, fb303::COUNT);
+      noRouteToPrefixes_.add();
     }
     return std::nullopt;
   }
@@ -1155,22 +2211,18 @@ SpfSolver::SpfSolverImpl::createBGPRoute(
     return std::nullopt;
   }
 
-  const auto nextHopsWithMetric =
-      getNextHopsWithMetric(myNodeName, dstInfo.nodes, false);
-
-  auto allNextHops = getNextHopsThrift(
-      myNodeName,
-      dstInfo.nodes,
-      isV4,
-      false,
-      nextHopsWithMetric.first,
-      nextHopsWithMetric.second,
-      std::nullopt);
+  const auto allNextHops =
+      getCachedNextHopsThrift(myNodeName, dstInfo.nodes, isV4, false);
+  if (not allNextHops) {
+    LOG(WARNING) << "No route to BGP prefix " << toString(prefix);
+    noRouteToPrefixes_.add();
+    return std::nullopt;
+  }
 
   return thrift::UnicastRoute{FRAGILE,
                               prefix,
                               thrift::AdminDistance::EBGP,
-                              std::move(allNextHops),
+                              *allNextHops,
                               thrift::PrefixType::BGP,
                               *(dstInfo.bestData),
                               bgpDryRun_, /* doNotInstall */
@@ -1179,43 +2231,41 @@ SpfSolver::SpfSolverImpl::createBGPRoute(
 
 std::optional<thrift::RouteDatabaseDelta>
 SpfSolver::SpfSolverImpl::processStaticRouteUpdates() {
-  std::unordered_map<int32_t, thrift::MplsRoute> routesToUpdate;
-  std::unordered_set<int32_t> routesToDel;
-
-  // squash the updates together.
-  for (const auto& staticRoutesUpdate : staticRoutesUpdates_) {
-    for (const auto& mplsRoutesToUpdate :
-         staticRoutesUpdate.mplsRoutesToUpdate) {
-      LOG(INFO) << "adding: " << mplsRoutesToUpdate.topLabel;
-      routesToUpdate[mplsRoutesToUpdate.topLabel] = mplsRoutesToUpdate;
-      routesToDel.erase(mplsRoutesToUpdate.topLabel);
-    }
-
-    for (const auto& mplsRoutesToDelete :
-         staticRoutesUpdate.mplsRoutesToDelete) {
-      LOG(INFO) << "erasing: " << mplsRoutesToDelete;
-      routesToDel.insert(mplsRoutesToDelete);
-      routesToUpdate.erase(mplsRoutesToDelete);
-    }
-  }
-  staticRoutesUpdates_.clear();
-
-  if (routesToUpdate.size() == 0 && routesToDel.size() == 0) {
-    return {};
-  }
+  const auto startTime = std::chrono::steady_clock::now();
 
+  // Routes are moved into delta as they are, skipping updates which don't
+  // change next-hops and deletions of unknown labels
   thrift::RouteDatabaseDelta ret;
-  for (const auto& routeToUpdate : routesToUpdate) {
-    staticRoutes_.mplsRoutes[routeToUpdate.first] =
-        routeToUpdate.second.nextHops;
-    ret.mplsRoutesToUpdate.emplace_back(std::move(routeToUpdate.second));
+  for (auto& kv : pendingStaticMplsRoutes_) {
+    auto it = staticRoutes_.mplsRoutes.find(kv.first);
+    if (kv.second.has_value()) {
+      auto& route = kv.second.value();
+      if (it != staticRoutes_.mplsRoutes.end() and
+          it->second == route.nextHops) {
+        continue;
+      }
+      staticRoutes_.mplsRoutes[kv.first] = route.nextHops;
+      ret.mplsRoutesToUpdate.emplace_back(std::move(route));
+    } else if (it != staticRoutes_.mplsRoutes.end()) {
+      staticRoutes_.mplsRoutes.erase(it);
+      ret.mplsRoutesToDelete.emplace_back(kv.first);
+    }
   }
+  pendingStaticMplsRoutes_.clear();
 
-  for (const auto& routeToDel : routesToDel) {
-    staticRoutes_.mplsRoutes.erase(routeToDel);
-    ret.mplsRoutesToDelete.push_back(routeToDel);
+  if (ret.mplsRoutesToUpdate.empty() and ret.mplsRoutesToDelete.empty()) {
+    return std::nullopt;
   }
-
+  LOG(INFO) << "Static MPLS routes to update: " << ret.mplsRoutesToUpdate.size()
+            << ", to delete: " << ret.mplsRoutesToDelete.size();
+
+  std::map<std::string, thrift::RouteComputationStats> computationStats;
+  addComputationStats(
+      computationStats,
+      kStaticComputation,
+      startTime,
+      ret.mplsRoutesToUpdate.size() + ret.mplsRoutesToDelete.size());
+  exportComputationStats(computationStats);
   return ret;
 }
 
@@ -1345,21 +2395,35 @@ SpfSolver::SpfSolverImpl::selectKsp2Routes(
   return std::move(route);
 }
 
-std::unordered_map<std::string, std::vector<std::pair<Path, Metric>>>
+std::unordered_map<std::string, std::vector<std::pair<Path, Metric>>> const&
 SpfSolver::SpfSolverImpl::createOpenRKsp2EdRouteForNodes(
     std::string const& myNodeName,
     std::unordered_set<std::string> const& nodes) {
-  std::unordered_map<std::string, std::vector<std::pair<Path, Metric>>>
-      pathsToNodes;
+  const auto topologyVersion = linkState_.getTopologyVersion();
+  if (ksp2PathsCache_.myNodeName != myNodeName or
+      ksp2PathsCache_.topologyVersion != topologyVersion) {
+    ksp2PathsCache_.myNodeName = myNodeName;
+    ksp2PathsCache_.topologyVersion = topologyVersion;
+    ksp2PathsCache_.pathsToNodes.clear();
+  }
+  auto& pathsToNodes = ksp2PathsCache_.pathsToNodes;
 
   // Prepare list of possible destination nodes
   for (const auto& node : nodes) {
+    // computed with same topology already, possibly without any path
+    if (not pathsToNodes.emplace(node, std::vector<std::pair<Path, Metric>>{})
+                .second) {
+      fb303::fbData->addStatValue(
+          "decision.ksp2_paths_cache_hits", 1, fb303::COUNT);
+      continue;
+    }
+
     std::set<std::string> dstNodeNames;
     dstNodeNames.emplace(node);
 
     // Step-1 Get all shortest paths and min-cost nodes to whom we will be
     // forwarding
-    auto const& spf1 = spfResults_.at(myNodeName);
+    auto const& spf1 = getCachedSpfResult(myNodeName);
     auto const& minMetricNodes1 = getMinCostNodes(spf1, dstNodeNames);
     auto const& minCost1 = minMetricNodes1.first;
     auto const& minCostNodes1 = minMetricNodes1.second;
@@ -1399,17 +2463,18 @@ SpfSolver::SpfSolverImpl::createOpenRKsp2EdRouteForNodes(
 
 std::pair<Metric, std::unordered_set<std::string>>
 SpfSolver::SpfSolverImpl::getMinCostNodes(
-    const SpfResult& spfResult, const std::set<std::string>& dstNodeNames) {
+    const SpfResult& spfResult,
+    const std::set<std::string>& dstNodeNames) const {
   Metric shortestMetric = std::numeric_limits<Metric>::max();
 
   // find the set of the closest nodes in our destination
   std::unordered_set<std::string> minCostNodes;
   for (const auto& dstNode : dstNodeNames) {
-    auto it = spfResult.find(dstNode);
-    if (it == spfResult.end()) {
+    auto const dstNodeId = linkState_.getNodeId(dstNode);
+    if (not dstNodeId.has_value() or not spfResult.isReachable(*dstNodeId)) {
       continue;
     }
-    const auto nodeDistance = it->second.first;
+    const auto nodeDistance = spfResult.getMetric(*dstNodeId);
     if (shortestMetric >= nodeDistance) {
       if (shortestMetric > nodeDistance) {
         shortestMetric = nodeDistance;
@@ -1422,6 +2487,24 @@ SpfSolver::SpfSolverImpl::getMinCostNodes(
   return std::make_pair(shortestMetric, std::move(minCostNodes));
 }
 
+std::vector<SpfSolver::SpfSolverImpl::LocalLinkAttrs>
+SpfSolver::SpfSolverImpl::getLocalLinkAttrs(
+    std::string const& myNodeName) const {
+  std::vector<LocalLinkAttrs> localLinks;
+  for (auto const& link : linkState_.linksFromNode(myNodeName)) {
+    localLinks.emplace_back(
+        link->getOtherNodeName(myNodeName),
+        link->getIfaceFromNode(myNodeName),
+        link->isUp(),
+        link->getMetricFromNode(myNodeName),
+        link->getAdjLabelFromNode(myNodeName),
+        link->getNhV4FromNode(myNodeName),
+        link->getNhV6FromNode(myNodeName));
+  }
+  std::sort(localLinks.begin(), localLinks.end());
+  return localLinks;
+}
+
 std::pair<
     Metric /* min metric to destination */,
     std::unordered_map<
@@ -1431,7 +2514,7 @@ SpfSolver::SpfSolverImpl::getNextHopsWithMetric(
     const std::string& myNodeName,
     const std::set<std::string>& dstNodeNames,
     bool perDestination) const {
-  auto& shortestPathsFromHere = spfResults_.at(myNodeName);
+  auto& shortestPathsFromHere = getCachedSpfResult(myNodeName);
   auto const& minMetricNodes =
       getMinCostNodes(shortestPathsFromHere, dstNodeNames);
   auto const& shortestMetric = minMetricNodes.first;
@@ -1452,29 +2535,35 @@ SpfSolver::SpfSolverImpl::getNextHopsWithMetric(
   // Add neighbors with shortest path to the prefix
   for (const auto& dstNode : minCostNodes) {
     const auto dstNodeRef = perDestination ? dstNode : "";
-    for (const auto& nhName : shortestPathsFromHere.at(dstNode).second) {
-      nextHopNodes[std::make_pair(nhName, dstNodeRef)] =
-          shortestMetric - findMinDistToNeighbor(myNodeName, nhName);
-    }
+    shortestPathsFromHere.forEachNextHop(
+        linkState_.getNodeId(dstNode).value(), [&](NodeId nhId) {
+          auto const& nhName = linkState_.getNodeName(nhId);
+          nextHopNodes[std::make_pair(nhName, dstNodeRef)] =
+              shortestMetric - findMinDistToNeighbor(myNodeName, nhName);
+        });
   }
 
   // add any other neighbors that have LFA paths to the prefix
   if (computeLfaPaths_) {
-    for (const auto& kv2 : spfResults_) {
-      const auto& neighborName = kv2.first;
-      const auto& shortestPathsFromNeighbor = kv2.second;
-      if (neighborName == myNodeName) {
+    const NodeId myNodeId = linkState_.getNodeId(myNodeName).value();
+    // a neighbor may be visited more than once because of parallel links to
+    // it, which is harmless as only the minimum distance is retained
+    for (const auto& link : linkState_.linksFromNode(myNodeName)) {
+      if (not link->isUp()) {
         continue;
       }
+      const auto& neighborName = link->getOtherNodeName(myNodeName);
+      const auto& shortestPathsFromNeighbor = getCachedSpfResult(neighborName);
 
-      const auto neighborToHere =
-          shortestPathsFromNeighbor.at(myNodeName).first;
+      const auto neighborToHere = shortestPathsFromNeighbor.getMetric(myNodeId);
       for (const auto& dstNode : dstNodeNames) {
-        auto shortestPathItr = shortestPathsFromNeighbor.find(dstNode);
-        if (shortestPathItr == shortestPathsFromNeighbor.end()) {
+        auto const dstNodeId = linkState_.getNodeId(dstNode);
+        if (not dstNodeId.has_value() or
+            not shortestPathsFromNeighbor.isReachable(*dstNodeId)) {
           continue;
         }
-        const auto distanceFromNeighbor = shortestPathItr->second.first;
+        const auto distanceFromNeighbor =
+            shortestPathsFromNeighbor.getMetric(*dstNodeId);
 
         // This is the LFA condition per RFC 5286
         if (distanceFromNeighbor < shortestMetric + neighborToHere) {
@@ -1488,7 +2577,7 @@ SpfSolver::SpfSolverImpl::getNextHopsWithMetric(
           }
         } // end if
       } // end for dstNodeNames
-    } // end spfResults_
+    } // end linksFromNode
   }
 
   return std::make_pair(shortestMetric, nextHopNodes);
@@ -1576,6 +2665,37 @@ SpfSolver::SpfSolverImpl::getNextHopsThrift(
   return nextHops;
 }
 
+const std::vector<thrift::NextHopThrift>*
+SpfSolver::SpfSolverImpl::getCachedNextHopsThrift(
+    const std::string& myNodeName,
+    const std::set<std::string>& dstNodeNames,
+    bool isV4,
+    bool perDestination) {
+  auto it = nextHopsCache_.find(
+      std::forward_as_tuple(dstNodeNames, isV4, perDestination));
+  if (it == nextHopsCache_.end()) {
+    std::optional<std::vector<thrift::NextHopThrift>> nextHops;
+    const auto metricNhs =
+        getNextHopsWithMetric(myNodeName, dstNodeNames, perDestination);
+    if (not metricNhs.second.empty()) {
+      nextHops = getNextHopsThrift(
+          myNodeName,
+          dstNodeNames,
+          isV4,
+          perDestination,
+          metricNhs.first,
+          metricNhs.second,
+          std::nullopt);
+    }
+    it = nextHopsCache_
+             .emplace(
+                 std::make_tuple(dstNodeNames, isV4, perDestination),
+                 std::move(nextHops))
+             .first;
+  }
+  return it->second.has_value() ? &it->second.value() : nullptr;
+}
+
 Metric
 SpfSolver::SpfSolverImpl::findMinDistToNeighbor(
     const std::string& myNodeName, const std::string& neighborName) const {
@@ -1591,12 +2711,18 @@ SpfSolver::SpfSolverImpl::findMinDistToNeighbor(
 void
 SpfSolver::SpfSolverImpl::updateGlobalCounters() {
   size_t numPartialAdjacencies{0};
-  const auto& mySpfResult = spfResults_[myNodeName_];
+  static const SpfResult kEmptySpfResult;
+  // only consult a result we already have, counters shouldn't trigger SPF
+  auto const search = spfCache_.find(std::make_pair(myNodeName_, true));
+  const auto& mySpfResult =
+      search != spfCache_.end() ? search->second.result : kEmptySpfResult;
   for (auto const& kv : linkState_.getAdjacencyDatabases()) {
     const auto& adjDb = kv.second;
     size_t numLinks = linkState_.linksFromNode(kv.first).size();
     // Consider partial adjacency only iff node is reachable from current node
-    if (mySpfResult.count(adjDb.thisNodeName) && 0 != numLinks) {
+    auto const nodeId = linkState_.getNodeId(adjDb.thisNodeName);
+    if (nodeId.has_value() && mySpfResult.isReachable(*nodeId) &&
+        0 != numLinks) {
       // only add to the count if this node is not completely disconnected
       size_t diff = adjDb.adjacencies.size() - numLinks;
       // Number of links (bi-directional) must be <= number of adjacencies
@@ -1622,6 +2748,9 @@ SpfSolver::SpfSolverImpl::updateGlobalCounters() {
   fb303::fbData->setCounter(
       "decision.num_nodes_v6_loopbacks",
       prefixState_.getNodeHostLoopbacksV6().size());
+  fb303::fbData->setCounter(
+      "decision.num_nodes_over_prefix_limit",
+      prefixState_.getNodesOverPrefixLimit().size());
 }
 
 //
@@ -1634,14 +2763,22 @@ SpfSolver::SpfSolver(
     bool computeLfaPaths,
     bool enableOrderedFib,
     bool bgpDryRun,
-    bool bgpUseIgpMetric)
+    bool bgpUseIgpMetric,
+    bool enableIncrementalSpf,
+    size_t numSpfThreads,
+    std::optional<size_t> maxPrefixesPerNode,
+    thrift::PrefixLimitAction prefixLimitAction)
     : impl_(new SpfSolver::SpfSolverImpl(
           myNodeName,
           enableV4,
           computeLfaPaths,
           enableOrderedFib,
           bgpDryRun,
-          bgpUseIgpMetric)) {}
+          bgpUseIgpMetric,
+          enableIncrementalSpf,
+          numSpfThreads,
+          maxPrefixesPerNode,
+          prefixLimitAction)) {}
 
 SpfSolver::~SpfSolver() {}
 
@@ -1688,7 +2825,16 @@ SpfSolver::getStaticRoutes() {
 // update prefixes for a given router
 bool
 SpfSolver::updatePrefixDatabase(const thrift::PrefixDatabase& prefixDb) {
-  return impl_->updatePrefixDatabase(prefixDb);
+  return not impl_->updatePrefixDatabase(prefixDb).empty();
+}
+
+bool
+SpfSolver::updatePrefixDatabase(
+    const thrift::PrefixDatabase& prefixDb,
+    std::unordered_set<thrift::IpPrefix>& changedPrefixes) {
+  auto prefixes = impl_->updatePrefixDatabase(prefixDb);
+  changedPrefixes.insert(prefixes.begin(), prefixes.end());
+  return not prefixes.empty();
 }
 
 std::unordered_map<std::string /* nodeName */, thrift::PrefixDatabase>
@@ -1706,6 +2852,13 @@ SpfSolver::buildRouteDb(const std::string& myNodeName) {
   return impl_->buildRouteDb(myNodeName);
 }
 
+std::optional<std::vector<thrift::UnicastRoute>>
+SpfSolver::buildUnicastRoutes(
+    const std::string& myNodeName,
+    const std::unordered_set<thrift::IpPrefix>& prefixes) {
+  return impl_->buildUnicastRoutes(myNodeName, prefixes);
+}
+
 std::optional<thrift::RouteDatabaseDelta>
 SpfSolver::processStaticRouteUpdates() {
   return impl_->processStaticRouteUpdates();
@@ -1716,11 +2869,296 @@ SpfSolver::decrementHolds() {
   return impl_->decrementHolds();
 }
 
+std::vector<thrift::IpPrefix>
+SpfSolver::getActiveSummaries(const std::vector<thrift::IpPrefix>& summaries) {
+  return impl_->getActiveSummaries(summaries);
+}
+
 void
 SpfSolver::updateGlobalCounters() {
   return impl_->updateGlobalCounters();
 }
 
+//
+// DecisionRouteDb implementation
+//
+
+namespace detail {
+
+template <typename Key, typename Route>
+void
+DecisionRouteDb::setRoute(
+    RouteMap<Key, Route>& routes,
+    Route&& route,
+    std::vector<Route>& routesToUpdate) {
+  const auto hash = std::hash<Route>()(route);
+  auto res = routes.try_emplace(getRouteKey(route));
+  auto& entry = res.first->second;
+  entry.generation = generation_;
+  // content is compared only if hashes match
+  if (not res.second and entry.hash == hash and entry.route == route) {
+    return;
+  }
+  routesToUpdate.emplace_back(route);
+  entry.hash = hash;
+  entry.route = std::move(route);
+}
+
+template <typename Key, typename Route>
+void
+DecisionRouteDb::replaceRoutes(
+    RouteMap<Key, Route>& routes,
+    std::vector<Route>& newRoutes,
+    std::vector<Route>& routesToUpdate,
+    std::vector<Key>& keysToDelete) {
+  for (auto& route : newRoutes) {
+    setRoute(routes, std::move(route), routesToUpdate);
+  }
+  // routes which are not part of this generation have been withdrawn
+  for (auto it = routes.begin(); it != routes.end();) {
+    if (it->second.generation == generation_) {
+      ++it;
+      continue;
+    }
+    keysToDelete.emplace_back(it->first);
+    it = routes.erase(it);
+  }
+  std::sort(routesToUpdate.begin(), routesToUpdate.end());
+  std::sort(keysToDelete.begin(), keysToDelete.end());
+}
+
+thrift::RouteDatabaseDelta
+DecisionRouteDb::update(thrift::RouteDatabase& routeDb) {
+  ++generation_;
+
+  thrift::RouteDatabaseDelta routeDelta;
+  routeDelta.thisNodeName = routeDb.thisNodeName;
+  replaceRoutes(
+      unicastRoutes_,
+      routeDb.unicastRoutes,
+      routeDelta.unicastRoutesToUpdate,
+      routeDelta.unicastRoutesToDelete);
+  replaceRoutes(
+      mplsRoutes_,
+      routeDb.mplsRoutes,
+      routeDelta.mplsRoutesToUpdate,
+      routeDelta.mplsRoutesToDelete);
+  routeDb.unicastRoutes.clear();
+  routeDb.mplsRoutes.clear();
+  return routeDelta;
+}
+
+thrift::RouteDatabaseDelta
+DecisionRouteDb::updateUnicastRoutes(
+    std::vector<thrift::UnicastRoute>& unicastRoutes,
+    std::unordered_set<thrift::IpPrefix> const& prefixes) {
+  thrift::RouteDatabaseDelta routeDelta;
+  std::unordered_set<thrift::IpPrefix> routedPrefixes;
+  for (auto& route : unicastRoutes) {
+    routedPrefixes.emplace(route.dest);
+    setRoute(
+        unicastRoutes_, std::move(route), routeDelta.unicastRoutesToUpdate);
+  }
+  unicastRoutes.clear();
+
+  for (auto const& prefix : prefixes) {
+    if (not routedPrefixes.count(prefix) and unicastRoutes_.erase(prefix)) {
+      routeDelta.unicastRoutesToDelete.emplace_back(prefix);
+    }
+  }
+  std::sort(
+      routeDelta.unicastRoutesToUpdate.begin(),
+      routeDelta.unicastRoutesToUpdate.end());
+  std::sort(
+      routeDelta.unicastRoutesToDelete.begin(),
+      routeDelta.unicastRoutesToDelete.end());
+  return routeDelta;
+}
+
+thrift::RouteDatabase
+mergeAreaRouteDbs(std::vector<thrift::RouteDatabase>& areaRouteDbs) {
+  thrift::RouteDatabase routeDb;
+  std::unordered_map<thrift::IpPrefix, thrift::UnicastRoute> unicastRoutes;
+  std::unordered_map<int32_t, thrift::MplsRoute> mplsRoutes;
+  std::optional<std::map<std::string, thrift::RouteComputationStats>>
+      computationStats;
+  for (auto& areaRouteDb : areaRouteDbs) {
+    routeDb.thisNodeName = areaRouteDb.thisNodeName;
+    if (auto areaStats = areaRouteDb.computationStats_ref()) {
+      if (not computationStats.has_value()) {
+        computationStats.emplace();
+      }
+      for (auto const& kv : *areaStats) {
+        auto& stats = (*computationStats)[kv.first];
+        stats.durationUs += kv.second.durationUs;
+        stats.numRoutes += kv.second.numRoutes;
+      }
+    }
+    for (auto& route : areaRouteDb.unicastRoutes) {
+      mergeAreaRoute(unicastRoutes, std::move(route));
+    }
+    for (auto& route : areaRouteDb.mplsRoutes) {
+      mergeAreaRoute(mplsRoutes, std::move(route));
+    }
+    areaRouteDb.unicastRoutes.clear();
+    areaRouteDb.mplsRoutes.clear();
+  }
+  routeDb.unicastRoutes = flattenRoutes(unicastRoutes);
+  routeDb.mplsRoutes = flattenRoutes(mplsRoutes);
+  if (computationStats.has_value()) {
+    routeDb.computationStats_ref() = std::move(*computationStats);
+  }
+  return routeDb;
+}
+
+std::vector<thrift::UnicastRoute>
+mergeAreaUnicastRoutes(
+    std::vector<std::vector<thrift::UnicastRoute>>& areaUnicastRoutes) {
+  std::unordered_map<thrift::IpPrefix, thrift::UnicastRoute> unicastRoutes;
+  for (auto& routes : areaUnicastRoutes) {
+    for (auto& route : routes) {
+      mergeAreaRoute(unicastRoutes, std::move(route));
+    }
+    routes.clear();
+  }
+  return flattenRoutes(unicastRoutes);
+}
+
+} // namespace detail
+
+namespace {
+
+void
+applyWhatIfLinkChange(
+    thrift::WhatIfLinkChange const& change, thrift::Adjacency& adj) {
+  if (change.isOverloaded_ref().has_value()) {
+    adj.isOverloaded = change.isOverloaded_ref().value();
+  }
+  if (change.metric_ref().has_value()) {
+    adj.metric = change.metric_ref().value();
+  }
+}
+
+// Apply node overloads and link changes of request to adjacency databases.
+// Throws std::invalid_argument if a node or link isn't part of any area
+void
+applyWhatIfChanges(
+    thrift::RouteDbWhatIfRequest const& request,
+    std::vector<detail::AreaLsdb>& areaLsdbs) {
+  for (auto const& kv : request.nodeOverloads) {
+    bool found{false};
+    for (auto& areaLsdb : areaLsdbs) {
+      auto it = areaLsdb.adjDbs.find(kv.first);
+      if (it != areaLsdb.adjDbs.end()) {
+        it->second.isOverloaded = kv.second;
+        found = true;
+      }
+    }
+    if (not found) {
+      throw std::invalid_argument(folly::sformat("Unknown node {}", kv.first));
+    }
+  }
+
+  for (auto const& change : request.linkChanges) {
+    bool found{false};
+    for (auto& areaLsdb : areaLsdbs) {
+      auto it = areaLsdb.adjDbs.find(change.nodeName);
+      if (it == areaLsdb.adjDbs.end()) {
+        continue;
+      }
+      for (auto& adj : it->second.adjacencies) {
+        if (adj.ifName != change.ifName) {
+          continue;
+        }
+        found = true;
+        applyWhatIfLinkChange(change, adj);
+
+        // adjacency of other end of the link
+        auto otherIt = areaLsdb.adjDbs.find(adj.otherNodeName);
+        if (otherIt == areaLsdb.adjDbs.end()) {
+          continue;
+        }
+        for (auto& otherAdj : otherIt->second.adjacencies) {
+          if (otherAdj.otherNodeName == change.nodeName and
+              otherAdj.ifName == adj.otherIfName) {
+            applyWhatIfLinkChange(change, otherAdj);
+          }
+        }
+      }
+    }
+    if (not found) {
+      throw std::invalid_argument(folly::sformat(
+          "Unknown link {} of node {}", change.ifName, change.nodeName));
+    }
+  }
+}
+
+// Fresh SpfSolver per area, loaded with databases of the area
+std::vector<std::unique_ptr<SpfSolver>>
+createSnapshotSpfSolvers(
+    std::vector<detail::AreaLsdb> const& areaLsdbs,
+    std::function<std::unique_ptr<SpfSolver>()> const& createSpfSolver) {
+  std::vector<std::unique_ptr<SpfSolver>> spfSolvers;
+  spfSolvers.reserve(areaLsdbs.size());
+  for (auto const& areaLsdb : areaLsdbs) {
+    auto spfSolver = createSpfSolver();
+    for (auto const& kv : areaLsdb.adjDbs) {
+      spfSolver->updateAdjacencyDatabase(kv.second);
+    }
+    for (auto const& kv : areaLsdb.prefixDbs) {
+      spfSolver->updatePrefixDatabase(kv.second);
+    }
+    spfSolvers.emplace_back(std::move(spfSolver));
+  }
+  return spfSolvers;
+}
+
+// Routes of nodeName computed by spfSolvers, merged across areas. Route
+// database without routes if no area has any
+thrift::RouteDatabase
+buildSnapshotRouteDb(
+    std::vector<std::unique_ptr<SpfSolver>> const& spfSolvers,
+    std::string const& nodeName) {
+  std::vector<thrift::RouteDatabase> areaRouteDbs;
+  for (auto const& spfSolver : spfSolvers) {
+    auto maybeRouteDb = spfSolver->buildPaths(nodeName);
+    if (maybeRouteDb.has_value()) {
+      areaRouteDbs.emplace_back(std::move(maybeRouteDb.value()));
+    }
+  }
+
+  if (areaRouteDbs.empty()) {
+    thrift::RouteDatabase routeDb;
+    routeDb.thisNodeName = nodeName;
+    return routeDb;
+  }
+  if (areaRouteDbs.size() == 1) {
+    return std::move(areaRouteDbs.front());
+  }
+  return detail::mergeAreaRouteDbs(areaRouteDbs);
+}
+
+// Same as buildSnapshotRouteDb on solvers created from areaLsdbs. Throws
+// folly::FutureTimeout once past deadline
+thrift::RouteDatabase
+buildWhatIfRouteDb(
+    std::vector<detail::AreaLsdb> const& areaLsdbs,
+    std::string const& nodeName,
+    std::function<std::unique_ptr<SpfSolver>()> const& createSpfSolver,
+    std::chrono::steady_clock::time_point deadline) {
+  auto spfSolvers = createSnapshotSpfSolvers(areaLsdbs, createSpfSolver);
+  if (std::chrono::steady_clock::now() > deadline) {
+    throw folly::FutureTimeout();
+  }
+  auto routeDb = buildSnapshotRouteDb(spfSolvers, nodeName);
+  if (std::chrono::steady_clock::now() > deadline) {
+    throw folly::FutureTimeout();
+  }
+  return routeDb;
+}
+
+} // namespace
+
 //
 // Decision class implementation
 //
@@ -1731,35 +3169,73 @@ Decision::Decision(
     bool bgpDryRun,
     std::chrono::milliseconds debounceMinDur,
     std::chrono::milliseconds debounceMaxDur,
-    messaging::RQueue<thrift::Publication> kvStoreUpdatesQueue,
+    messaging::RQueue<messaging::SharedValue<thrift::Publication>>
+        kvStoreUpdatesQueue,
     messaging::RQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue,
     messaging::ReplicateQueue<thrift::RouteDatabaseDelta>& routeUpdatesQueue,
-    fbzmq::Context& zmqContext)
+    fbzmq::Context& zmqContext,
+    messaging::ReplicateQueue<thrift::PrefixUpdateRequest>* prefixUpdatesQueue)
     : config_(config),
       processUpdatesBackoff_(debounceMinDur, debounceMaxDur),
       routeUpdatesQueue_(routeUpdatesQueue),
+      computeLfaPaths_(computeLfaPaths),
+      bgpDryRun_(bgpDryRun),
       myNodeName_(config->getConfig().node_name) {
   auto tConfig = config->getConfig();
-  routeDb_.thisNodeName = myNodeName_;
   processUpdatesTimer_ = folly::AsyncTimeout::make(
-      *getEvb(), [this]() noexcept { processPendingUpdates(); });
-  spfSolver_ = std::make_unique<SpfSolver>(
-      tConfig.node_name,
-      tConfig.enable_v4_ref().value_or(false),
-      computeLfaPaths,
-      tConfig.enable_ordered_fib_programming_ref().value_or(false),
-      bgpDryRun,
-      tConfig.bgp_use_igp_metric_ref().value_or(false));
-
-  coldStartTimer_ = folly::AsyncTimeout::make(
-      *getEvb(), [this]() noexcept { coldStartUpdate(); });
+      *getEvb(), [this]() noexcept { startProcessPendingUpdates(); });
+  if (tConfig.enable_decision_background_computation_ref().value_or(false)) {
+    routeExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        1, std::make_shared<folly::NamedThreadFactory>("DecisionRoute"));
+  }
+
+  snapshotExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+      Constants::kDecisionSnapshotThreads,
+      std::make_shared<folly::NamedThreadFactory>("DecisionSnapshot"));
+
+  const auto numAreaThreads =
+      std::max(tConfig.decision_area_threads_ref().value_or(0), 0);
+  if (numAreaThreads > 0) {
+    areaExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        numAreaThreads,
+        std::make_shared<folly::NamedThreadFactory>("DecisionArea"));
+  }
+  getSpfSolver(thrift::KvStore_constants::kDefaultArea());
+
+  // Only border nodes, being in more than one area, advertise summaries
+  prefixUpdatesQueue_ = prefixUpdatesQueue;
+  if (tConfig.areas.size() > 1) {
+    for (auto const& areaConfig : tConfig.areas) {
+      for (auto const& summary : areaConfig.summary_prefixes) {
+        areaSummaries_[areaConfig.area_id].emplace_back(toIpPrefix(summary));
+      }
+    }
+  }
+
+  // Initialize latency histograms of the stages of route computation. SPF and
+  // route build stages are registered by SpfSolver
+  addLatencyHistogram("decision.latency.publication_ms");
+  addLatencyHistogram("decision.latency.debounce_ms");
+  addLatencyHistogram("decision.latency.route_delta_ms");
+  addLatencyHistogram("decision.latency.route_push_ms");
+  addLatencyHistogram("decision.latency.route_engine_ms");
+
+  coldStartTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+    runWithSolvers([this]() { coldStartUpdate(); });
+  });
   if (auto eor = config->getConfig().eor_time_s_ref()) {
+    inColdStart_ = true;
+    areasPendingInitialSync_ = config->getAreaIds();
     coldStartTimer_->scheduleTimeout(std::chrono::seconds(*eor));
   }
 
   // Schedule periodic timer for counter submission
   counterUpdateTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
-    spfSolver_->updateGlobalCounters();
+    // counters are reported for the default area
+    runWithSolvers([this]() {
+      getSpfSolver(thrift::KvStore_constants::kDefaultArea())
+          .updateGlobalCounters();
+    });
     // Schedule next counters update
     counterUpdateTimer_->scheduleTimeout(Constants::kMonitorSubmitInterval);
   });
@@ -1768,14 +3244,19 @@ Decision::Decision(
   // Schedule periodic timer to decremtOrderedFibHolds
   if (tConfig.enable_ordered_fib_programming_ref().value_or(false)) {
     orderedFibTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
-      LOG(INFO) << "Decrementing Holds";
-      decrementOrderedFibHolds();
-      if (spfSolver_->hasHolds()) {
-        auto timeout = getMaxFib();
-        LOG(INFO) << "Scheduling next hold decrement in " << timeout.count()
-                  << "ms";
-        orderedFibTimer_->scheduleTimeout(getMaxFib());
-      }
+      runWithSolvers([this]() {
+        LOG(INFO) << "Decrementing Holds";
+        decrementOrderedFibHolds();
+        if (std::any_of(
+                spfSolvers_.begin(), spfSolvers_.end(), [](auto const& kv) {
+                  return kv.second->hasHolds();
+                })) {
+          auto timeout = getMaxFib();
+          LOG(INFO) << "Scheduling next hold decrement in " << timeout.count()
+                    << "ms";
+          orderedFibTimer_->scheduleTimeout(getMaxFib());
+        }
+      });
     });
   }
 
@@ -1783,40 +3264,58 @@ Decision::Decision(
   addFiberTask([q = std::move(kvStoreUpdatesQueue), this]() mutable noexcept {
     LOG(INFO) << "Starting KvStore updates processing fiber";
     while (true) {
-      auto maybeThriftPub = q.get(); // perform read
+      // Drain all pending publications so that route computation is
+      // scheduled once per burst
+      auto maybeThriftPubs =
+          q.getBatch(Constants::kDecisionPublicationsBatchSize); // perform read
       VLOG(2) << "Received KvStore update";
-      if (maybeThriftPub.hasError()) {
+      if (maybeThriftPubs.hasError()) {
         LOG(INFO) << "Terminating KvStore updates processing fiber";
         break;
       }
 
-      // Apply publication and update stored update status
-      ProcessPublicationResult res; // default initialized to false
-      try {
-        res = processPublication(maybeThriftPub.value());
-      } catch (const std::exception& e) {
+      fb303::fbData->setCounter(
+          "decision.kvstore_updates_queue.num_coalesced", q.numCoalesced());
+      fb303::fbData->setCounter(
+          "decision.kvstore_updates_queue.num_dropped", q.numDropped());
+
+      // Apply publications and update stored update status. Publications
+      // keep being read off the queue during background route computation
+      runWithSolvers([this, thriftPubs = std::move(maybeThriftPubs).value()]() {
+        ProcessPublicationResult res; // default initialized to false
+        std::vector<std::string> syncedAreas;
+        try {
+          for (const auto& thriftPub : thriftPubs) {
+            auto pubRes = processPublication(*thriftPub);
+            res.adjChanged |= pubRes.adjChanged;
+            res.prefixesChanged |= pubRes.prefixesChanged;
+            if (thriftPub->initialSyncDone_ref().value_or(false)) {
+              syncedAreas.emplace_back(thriftPub->area_ref().value_or(
+                  thrift::KvStore_constants::kDefaultArea()));
+            }
+          }
+        } catch (const std::exception& e) {
 #if FOLLY_USE_SYMBOLIZER
-        // collect stack strace then fail the process
-        for (auto& exInfo : folly::exception_tracer::getCurrentExceptions()) {
-          LOG(ERROR) << exInfo;
-        }
+          // collect stack strace then fail the process
+          for (auto& exInfo :
+               folly::exception_tracer::getCurrentExceptions()) {
+            LOG(ERROR) << exInfo;
+          }
 #endif
-        // FATAL to produce core dump
-        LOG(FATAL) << "Exception occured in Decision::processPublication - "
-                   << folly::exceptionStr(e);
-      }
-      processUpdatesStatus_.adjChanged |= res.adjChanged;
-      processUpdatesStatus_.prefixesChanged |= res.prefixesChanged;
-      // compute routes with exponential backoff timer if needed
-      if (res.adjChanged || res.prefixesChanged) {
-        if (!processUpdatesBackoff_.atMaxBackoff()) {
-          processUpdatesBackoff_.reportError();
-          processUpdatesTimer_->scheduleTimeout(
-              processUpdatesBackoff_.getTimeRemainingUntilRetry());
-        } else {
-          CHECK(processUpdatesTimer_->isScheduled());
+          // FATAL to produce core dump
+          LOG(FATAL) << "Exception occured in Decision::processPublication - "
+                     << folly::exceptionStr(e);
         }
-      }
+        processUpdatesStatus_.adjChanged |= res.adjChanged;
+        processUpdatesStatus_.prefixesChanged |= res.prefixesChanged;
+        // compute routes with exponential backoff timer if needed
+        if (res.adjChanged || res.prefixesChanged) {
+          scheduleProcessPendingUpdates();
+        }
+        for (auto const& area : syncedAreas) {
+          processInitialSyncDone(area);
+        }
+      });
     }
   });
 
@@ -1832,14 +3331,11 @@ Decision::Decision(
             break;
           }
           // Apply publication and update stored update status
-          pushRoutesDeltaUpdates(maybeThriftPub.value());
-          if (!processUpdatesBackoff_.atMaxBackoff()) {
-            processUpdatesBackoff_.reportError();
-            processUpdatesTimer_->scheduleTimeout(
-                processUpdatesBackoff_.getTimeRemainingUntilRetry());
-          } else {
-            CHECK(processUpdatesTimer_->isScheduled());
-          }
+          runWithSolvers(
+              [this, delta = std::move(maybeThriftPub).value()]() mutable {
+                pushRoutesDeltaUpdates(delta);
+                scheduleProcessPendingUpdates();
+              });
         }
       });
 }
@@ -1848,12 +3344,12 @@ folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
 Decision::getDecisionRouteDb(std::string nodeName) {
   folly::Promise<std::unique_ptr<thrift::RouteDatabase>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([p = std::move(p), nodeName, this]() mutable {
+  runInEventBaseThreadWithSolvers([p = std::move(p), nodeName, this]() mutable {
     thrift::RouteDatabase routeDb;
     if (nodeName.empty()) {
       nodeName = myNodeName_;
     }
-    auto maybeRouteDb = spfSolver_->buildPaths(nodeName);
+    auto maybeRouteDb = buildRouteDb(nodeName, true /* computePaths */);
     if (maybeRouteDb.has_value()) {
       routeDb = std::move(maybeRouteDb.value());
     } else {
@@ -1864,12 +3360,155 @@ Decision::getDecisionRouteDb(std::string nodeName) {
   return sf;
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::RouteDatabaseDelta>>
+Decision::getRouteDbWhatIf(thrift::RouteDbWhatIfRequest request) {
+  const auto timeBudget = std::min(
+      request.timeBudgetMs > 0 ? std::chrono::milliseconds(request.timeBudgetMs)
+                               : Constants::kDecisionWhatIfTimeBudget,
+      Constants::kDecisionWhatIfMaxTimeBudget);
+  const auto deadline = std::chrono::steady_clock::now() + timeBudget;
+  if (request.nodeName.empty()) {
+    request.nodeName = myNodeName_;
+  }
+
+  // Databases are copied on evb, everything else runs on snapshotExecutor_
+  return getAreaLsdbs()
+      .via(snapshotExecutor_.get())
+      .thenValue([request = std::move(request),
+                  createSpfSolver = getSnapshotSpfSolverFactory(),
+                  deadline](std::vector<detail::AreaLsdb> areaLsdbs) {
+        if (std::chrono::steady_clock::now() > deadline) {
+          throw folly::FutureTimeout();
+        }
+        auto routeDb = buildWhatIfRouteDb(
+            areaLsdbs, request.nodeName, createSpfSolver, deadline);
+        applyWhatIfChanges(request, areaLsdbs);
+        auto whatIfRouteDb = buildWhatIfRouteDb(
+            areaLsdbs, request.nodeName, createSpfSolver, deadline);
+
+        detail::DecisionRouteDb decisionRouteDb;
+        decisionRouteDb.update(routeDb);
+        return std::make_unique<thrift::RouteDatabaseDelta>(
+            decisionRouteDb.update(whatIfRouteDb));
+      })
+      .semi()
+      .within(timeBudget);
+}
+
+folly::SemiFuture<folly::Unit>
+Decision::getDecisionRouteDbs(
+    std::vector<std::string> nodeNames,
+    std::function<void(thrift::RouteDatabase)> routeDbCb) {
+  for (auto& nodeName : nodeNames) {
+    if (nodeName.empty()) {
+      nodeName = myNodeName_;
+    }
+  }
+
+  // Nodes are split into one contiguous chunk per thread of
+  // snapshotExecutor_. Each chunk loads its own solvers, so that they are
+  // never shared across threads, and SPF results are reused within chunk
+  const size_t numChunks = std::max<size_t>(
+      std::min(nodeNames.size(), snapshotExecutor_->numThreads()), 1);
+  return getAreaLsdbs()
+      .via(snapshotExecutor_.get())
+      .thenValue([nodeNames = std::move(nodeNames),
+                  routeDbCb = std::move(routeDbCb),
+                  createSpfSolver = getSnapshotSpfSolverFactory(),
+                  numChunks,
+                  executor = snapshotExecutor_.get()](
+                     std::vector<detail::AreaLsdb> areaLsdbs) {
+        auto sharedLsdbs =
+            std::make_shared<const std::vector<detail::AreaLsdb>>(
+                std::move(areaLsdbs));
+        auto sharedNodeNames =
+            std::make_shared<const std::vector<std::string>>(
+                std::move(nodeNames));
+        auto sharedRouteDbCb =
+            std::make_shared<std::function<void(thrift::RouteDatabase)>>(
+                std::move(routeDbCb));
+        const size_t chunkSize =
+            (sharedNodeNames->size() + numChunks - 1) / numChunks;
+
+        std::vector<folly::SemiFuture<folly::Unit>> chunkRuns;
+        for (size_t begin = 0; begin < sharedNodeNames->size();
+             begin += chunkSize) {
+          const size_t end =
+              std::min(begin + chunkSize, sharedNodeNames->size());
+          chunkRuns.emplace_back(
+              folly::via(
+                  executor,
+                  [sharedLsdbs,
+                   sharedNodeNames,
+                   sharedRouteDbCb,
+                   createSpfSolver,
+                   begin,
+                   end]() {
+                    auto spfSolvers =
+                        createSnapshotSpfSolvers(*sharedLsdbs, createSpfSolver);
+                    for (size_t i = begin; i < end; ++i) {
+                      (*sharedRouteDbCb)(buildSnapshotRouteDb(
+                          spfSolvers, sharedNodeNames->at(i)));
+                    }
+                  })
+                  .semi());
+        }
+        return folly::collect(std::move(chunkRuns)).unit();
+      })
+      .semi();
+}
+
+folly::SemiFuture<std::vector<detail::AreaLsdb>>
+Decision::getAreaLsdbs() {
+  folly::Promise<std::vector<detail::AreaLsdb>> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThreadWithSolvers(
+      [p = std::move(p), this]() mutable { p.setValue(copyAreaLsdbs()); });
+  return sf;
+}
+
+std::vector<detail::AreaLsdb>
+Decision::copyAreaLsdbs() const {
+  std::vector<detail::AreaLsdb> areaLsdbs;
+  areaLsdbs.reserve(spfSolvers_.size());
+  for (auto const& kv : spfSolvers_) {
+    areaLsdbs.emplace_back(detail::AreaLsdb{kv.second->getAdjacencyDatabases(),
+                                            kv.second->getPrefixDatabases()});
+  }
+  return areaLsdbs;
+}
+
+std::function<std::unique_ptr<SpfSolver>()>
+Decision::getSnapshotSpfSolverFactory() const {
+  // Solvers of snapshots don't hold routes for ordered FIB programming, nor
+  // keep SPF results for incremental updates
+  auto const& tConfig = config_->getConfig();
+  const bool enableV4 = tConfig.enable_v4_ref().value_or(false);
+  const bool bgpUseIgpMetric = tConfig.bgp_use_igp_metric_ref().value_or(false);
+  return [myNodeName = myNodeName_,
+          enableV4,
+          computeLfaPaths = computeLfaPaths_,
+          bgpDryRun = bgpDryRun_,
+          bgpUseIgpMetric]() {
+    return std::make_unique<SpfSolver>(
+        myNodeName,
+        enableV4,
+        computeLfaPaths,
+        false /* enableOrderedFib */,
+        bgpDryRun,
+        bgpUseIgpMetric,
+        false /* enableIncrementalSpf */);
+  };
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::StaticRoutes>>
 Decision::getDecisionStaticRoutes() {
   folly::Promise<std::unique_ptr<thrift::StaticRoutes>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([p = std::move(p), this]() mutable {
-    auto staticRoutes = spfSolver_->getStaticRoutes();
+  runInEventBaseThreadWithSolvers([p = std::move(p), this]() mutable {
+    auto staticRoutes =
+        getSpfSolver(thrift::KvStore_constants::kDefaultArea())
+            .getStaticRoutes();
     p.setValue(std::make_unique<thrift::StaticRoutes>(std::move(staticRoutes)));
   });
   return sf;
@@ -1879,8 +3518,13 @@ folly::SemiFuture<std::unique_ptr<thrift::AdjDbs>>
 Decision::getDecisionAdjacencyDbs() {
   folly::Promise<std::unique_ptr<thrift::AdjDbs>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([p = std::move(p), this]() mutable {
-    auto adjDbs = spfSolver_->getAdjacencyDatabases();
+  runInEventBaseThreadWithSolvers([p = std::move(p), this]() mutable {
+    // nodes part of multiple areas are reported once
+    thrift::AdjDbs adjDbs;
+    for (auto const& kv : spfSolvers_) {
+      auto const& areaAdjDbs = kv.second->getAdjacencyDatabases();
+      adjDbs.insert(areaAdjDbs.begin(), areaAdjDbs.end());
+    }
     p.setValue(std::make_unique<thrift::AdjDbs>(std::move(adjDbs)));
   });
   return sf;
@@ -1890,55 +3534,255 @@ folly::SemiFuture<std::unique_ptr<thrift::PrefixDbs>>
 Decision::getDecisionPrefixDbs() {
   folly::Promise<std::unique_ptr<thrift::PrefixDbs>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([p = std::move(p), this]() mutable {
-    auto prefixDbs = spfSolver_->getPrefixDatabases();
+  runInEventBaseThreadWithSolvers([p = std::move(p), this]() mutable {
+    // nodes part of multiple areas are reported once
+    thrift::PrefixDbs prefixDbs;
+    for (auto const& kv : spfSolvers_) {
+      auto areaPrefixDbs = kv.second->getPrefixDatabases();
+      prefixDbs.insert(
+          std::make_move_iterator(areaPrefixDbs.begin()),
+          std::make_move_iterator(areaPrefixDbs.end()));
+    }
     p.setValue(std::make_unique<thrift::PrefixDbs>(std::move(prefixDbs)));
   });
   return sf;
 }
 
+void
+Decision::setRouteComputationEngine(
+    std::shared_ptr<RouteComputationEngine> engine,
+    std::chrono::milliseconds timeout) {
+  if (engine and
+      config_->getConfig().enable_ordered_fib_programming_ref().value_or(
+          false)) {
+    LOG(ERROR) << "Route computation engine is not supported with ordered "
+               << "FIB programming, routes are computed by SpfSolver";
+    return;
+  }
+  runInEventBaseThreadWithSolvers(
+      [this, engine = std::move(engine), timeout]() mutable {
+        LOG(INFO) << (engine ? "Offloading" : "Stopped offloading")
+                  << " route computation to external engine";
+        routeComputationEngine_ = std::move(engine);
+        routeComputationEngineTimeout_ = timeout;
+      });
+}
+
+folly::SemiFuture<folly::Unit>
+Decision::reloadConfig(std::shared_ptr<const Config> config) {
+  folly::Promise<folly::Unit> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThreadWithSolvers(
+      [p = std::move(p), config = std::move(config), this]() mutable {
+        auto const& tConfig = config->getConfig();
+        auto const minMs = tConfig.decision_debounce_min_ms_ref();
+        auto const maxMs = tConfig.decision_debounce_max_ms_ref();
+        if (minMs.has_value() and maxMs.has_value()) {
+          processUpdatesBackoff_ =
+              ExponentialBackoff<std::chrono::milliseconds>(
+                  std::chrono::milliseconds(*minMs),
+                  std::chrono::milliseconds(*maxMs));
+          LOG(INFO) << "Reloaded decision debounce timers: " << *minMs
+                    << "ms to " << *maxMs << "ms";
+          if (processUpdatesTimer_->isScheduled()) {
+            scheduleProcessPendingUpdates();
+          }
+        }
+        p.setValue();
+      });
+  return sf;
+}
+
 thrift::PrefixDatabase
 Decision::updateNodePrefixDatabase(
-    const std::string& key, const thrift::PrefixDatabase& prefixDb) {
+    const std::string& area,
+    const std::string& key,
+    thrift::PrefixDatabase prefixDb) {
   auto const& nodeName = prefixDb.thisNodeName;
+  auto& perPrefixEntries = perPrefixPrefixEntries_[area][nodeName];
+  auto& fullDbEntries = fullDbPrefixEntries_[area][nodeName];
 
   auto prefixKey = PrefixKey::fromStr(key);
   if (prefixKey.hasValue()) {
     // per prefix key
     if (prefixDb.deletePrefix) {
-      perPrefixPrefixEntries_[nodeName].erase(prefixKey.value().getIpPrefix());
+      perPrefixEntries.erase(prefixKey.value().getIpPrefix());
     } else {
       if (prefixDb.prefixEntries.empty()) {
         LOG(ERROR) << "Received no entries for prefix db";
       } else {
         LOG_IF(ERROR, prefixDb.prefixEntries.size() > 1)
             << "Received more than one prefix, only the first prefix is processed";
-        perPrefixPrefixEntries_[nodeName][prefixKey.value().getIpPrefix()] =
-            prefixDb.prefixEntries[0];
+        dropUnusedPrefixPayload(prefixDb.prefixEntries[0]);
+        perPrefixEntries[prefixKey.value().getIpPrefix()] =
+            std::move(prefixDb.prefixEntries[0]);
       }
     }
   } else {
-    fullDbPrefixEntries_[nodeName].clear();
-    for (auto const& entry : prefixDb.prefixEntries) {
-      fullDbPrefixEntries_[nodeName][entry.prefix] = entry;
+    fullDbEntries.clear();
+    for (auto& entry : prefixDb.prefixEntries) {
+      dropUnusedPrefixPayload(entry);
+      auto prefix = entry.prefix;
+      fullDbEntries[std::move(prefix)] = std::move(entry);
     }
   }
 
   thrift::PrefixDatabase nodePrefixDb;
   nodePrefixDb.thisNodeName = nodeName;
-  nodePrefixDb.perfEvents_ref().copy_from(prefixDb.perfEvents_ref());
-  nodePrefixDb.prefixEntries.reserve(perPrefixPrefixEntries_[nodeName].size());
-  for (auto& kv : perPrefixPrefixEntries_[nodeName]) {
+  nodePrefixDb.perfEvents_ref().move_from(std::move(prefixDb.perfEvents_ref()));
+  nodePrefixDb.prefixEntries.reserve(perPrefixEntries.size());
+  for (auto& kv : perPrefixEntries) {
     nodePrefixDb.prefixEntries.emplace_back(kv.second);
   }
-  for (auto& kv : fullDbPrefixEntries_[nodeName]) {
-    if (not perPrefixPrefixEntries_[nodeName].count(kv.first)) {
+  for (auto& kv : fullDbEntries) {
+    if (not perPrefixEntries.count(kv.first)) {
       nodePrefixDb.prefixEntries.emplace_back(kv.second);
     }
   }
   return nodePrefixDb;
 }
 
+void
+Decision::deleteNodeDatabases(
+    SpfSolver& spfSolver,
+    const std::string& area,
+    const std::string& nodeName,
+    ProcessPublicationResult& res) {
+  perAdjacencyDbs_[area].erase(nodeName);
+  fullDbAdjacencyDbs_[area].erase(nodeName);
+  if (spfSolver.deleteAdjacencyDatabase(nodeName)) {
+    res.adjChanged = true;
+    pendingAdjUpdates_.addUpdate(
+        myNodeName_, castToStd(thrift::PrefixDatabase().perfEvents_ref()));
+  }
+
+  perPrefixPrefixEntries_[area].erase(nodeName);
+  fullDbPrefixEntries_[area].erase(nodeName);
+  thrift::PrefixDatabase emptyPrefixDb;
+  emptyPrefixDb.thisNodeName = nodeName;
+  std::unordered_set<thrift::IpPrefix> changedPrefixes;
+  if (spfSolver.updatePrefixDatabase(emptyPrefixDb, changedPrefixes)) {
+    res.prefixesChanged = true;
+    pendingPrefixUpdates_.addUpdatedPrefixes(changedPrefixes);
+  }
+}
+
+std::optional<thrift::AdjacencyDatabase>
+Decision::updateNodeAdjacencyDatabase(
+    const std::string& area,
+    const std::string& key,
+    std::optional<thrift::AdjacencyDatabase> adjDb) {
+  const auto nodeName = getNodeNameFromKey(key);
+  auto& perAdjacencyDbs = perAdjacencyDbs_[area][nodeName];
+  auto& fullDbs = fullDbAdjacencyDbs_[area];
+
+  // empty per adjacency db signals withdraw of adjacency
+  std::optional<thrift::PerfEvents> perfEvents;
+  if (isPerAdjacencyKey(key)) {
+    if (adjDb.has_value() and not adjDb->adjacencies.empty()) {
+      LOG_IF(ERROR, adjDb->adjacencies.size() > 1)
+          << "Received more than one adjacency for key " << key
+          << ", only the first adjacency is processed";
+      adjDb->adjacencies.resize(1);
+      perAdjacencyDbs[key] = std::move(adjDb).value();
+    } else {
+      perAdjacencyDbs.erase(key);
+    }
+  } else if (adjDb.has_value()) {
+    perfEvents = castToStd(adjDb->perfEvents_ref());
+    fullDbs[nodeName] = std::move(adjDb).value();
+  } else {
+    fullDbs.erase(nodeName);
+  }
+
+  auto fullDbIt = fullDbs.find(nodeName);
+  if (perAdjacencyDbs.empty()) {
+    perAdjacencyDbs_.at(area).erase(nodeName);
+    if (fullDbIt == fullDbs.end()) {
+      return std::nullopt;
+    }
+    return fullDbIt->second;
+  }
+
+  // node attributes come with adjacency db key, or with any of per adjacency
+  // keys until it is received
+  thrift::AdjacencyDatabase nodeAdjDb = fullDbIt != fullDbs.end()
+      ? fullDbIt->second
+      : perAdjacencyDbs.begin()->second;
+  nodeAdjDb.adjacencies.clear();
+  nodeAdjDb.perfEvents_ref().reset();
+  if (perfEvents.has_value()) {
+    nodeAdjDb.perfEvents_ref() = std::move(perfEvents).value();
+  }
+
+  // per adjacency keys take precedence over adjacencies in adjacency db key
+  std::set<std::pair<std::string, std::string>> perAdjacencyIfs;
+  for (auto const& kv : perAdjacencyDbs) {
+    auto const& adj = kv.second.adjacencies.front();
+    perAdjacencyIfs.emplace(adj.otherNodeName, adj.ifName);
+    nodeAdjDb.adjacencies.emplace_back(adj);
+  }
+  if (fullDbIt != fullDbs.end()) {
+    for (auto const& adj : fullDbIt->second.adjacencies) {
+      if (not perAdjacencyIfs.count({adj.otherNodeName, adj.ifName})) {
+        nodeAdjDb.adjacencies.emplace_back(adj);
+      }
+    }
+  }
+  return nodeAdjDb;
+}
+
+void
+Decision::addFloodPerfEvents(
+    thrift::Publication const& thriftPub,
+    thrift::AdjacencyDatabase& adjacencyDb) {
+  auto perfEvents = adjacencyDb.perfEvents_ref();
+  auto floodTimestamps = thriftPub.floodTimestampsMs_ref();
+  if (not perfEvents.has_value() or not floodTimestamps.has_value() or
+      not thriftPub.nodeIds.has_value()) {
+    return;
+  }
+  auto const& nodeIds = *thriftPub.nodeIds;
+  for (size_t i = 0; i < std::min(nodeIds.size(), floodTimestamps->size());
+       ++i) {
+    // hops not tracing floods leave their timestamps unknown
+    if (floodTimestamps->at(i) == 0) {
+      continue;
+    }
+    perfEvents->events.emplace_back(
+        apache::thrift::FRAGILE,
+        nodeIds.at(i),
+        "KVSTORE_FLOODED",
+        floodTimestamps->at(i));
+  }
+}
+
+void
+Decision::updateAdjacencyDatabase(
+    SpfSolver& spfSolver,
+    thrift::AdjacencyDatabase const& adjacencyDb,
+    ProcessPublicationResult& res) {
+  auto rc = spfSolver.updateAdjacencyDatabase(adjacencyDb);
+  if (rc.first) {
+    res.adjChanged = true;
+    pendingAdjUpdates_.addUpdate(
+        myNodeName_, castToStd(adjacencyDb.perfEvents_ref()));
+  }
+  if (rc.second) {
+    // rebuild the routes, if related route attributes has been
+    // changed. e.g. node mpls label change, adjacency label change,
+    // local nexthops change etc.
+    res.prefixesChanged = true;
+    pendingPrefixUpdates_.addUpdate(
+        myNodeName_, castToStd(adjacencyDb.perfEvents_ref()));
+    pendingPrefixUpdates_.setNeedsFullRebuild();
+  }
+  if (spfSolver.hasHolds() && orderedFibTimer_ != nullptr &&
+      !orderedFibTimer_->isScheduled()) {
+    orderedFibTimer_->scheduleTimeout(getMaxFib());
+  }
+}
+
 ProcessPublicationResult
 Decision::processPublication(thrift::Publication const& thriftPub) {
   ProcessPublicationResult res;
@@ -1951,6 +3795,25 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
     return res;
   }
 
+  const auto startTime = std::chrono::steady_clock::now();
+  SCOPE_EXIT {
+    addLatencyValue("decision.latency.publication_ms", startTime);
+  };
+
+  // every area has its own link state and prefix state
+  const auto area = thriftPub.area_ref().value_or(
+      std::string{thrift::KvStore_constants::kDefaultArea()});
+  auto& spfSolver = getSpfSolver(area);
+  auto& keyValueHashes = keyValueHashes_[area];
+
+  // adjacency or prefix database got updated, even if routes don't change
+  bool isLsdbUpdated{false};
+  SCOPE_EXIT {
+    if (isLsdbUpdated) {
+      ++lsdbGeneration_;
+    }
+  };
+
   for (const auto& kv : thriftPub.keyVals) {
     const auto& key = kv.first;
     const auto& rawVal = kv.second;
@@ -1962,45 +3825,64 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
       continue;
     }
 
+    const bool isAdjDbKey = key.find(Constants::kAdjDbMarker.toString()) == 0;
+    const bool isPrefixDbKey =
+        key.find(Constants::kPrefixDbMarker.toString()) == 0;
+    int64_t valueHash{0};
+    if (isAdjDbKey or isPrefixDbKey) {
+      // hash carried by value can't be relied upon, it isn't necessarily set
+      valueHash =
+          generateHash(rawVal.version, rawVal.originatorId, rawVal.value_ref());
+      auto hashIt = keyValueHashes.find(key);
+      if (hashIt != keyValueHashes.end() and hashIt->second == valueHash) {
+        fb303::fbData->addStatValue(
+            "decision.skipped_duplicate_key_vals", 1, fb303::COUNT);
+        continue;
+      }
+      // forget about previous value in case processing of new one fails
+      keyValueHashes.erase(key);
+    }
+
     try {
-      if (key.find(Constants::kAdjDbMarker.toString()) == 0) {
+      if (isAdjDbKey) {
+        isLsdbUpdated = true;
         // update adjacencyDb
         auto adjacencyDb =
             fbzmq::util::readThriftObjStr<thrift::AdjacencyDatabase>(
                 rawVal.value_ref().value(), serializer_);
         CHECK_EQ(nodeName, adjacencyDb.thisNodeName);
-        auto rc = spfSolver_->updateAdjacencyDatabase(adjacencyDb);
-        if (rc.first) {
+        addFloodPerfEvents(thriftPub, adjacencyDb);
+        auto nodeAdjDb =
+            updateNodeAdjacencyDatabase(area, key, std::move(adjacencyDb));
+        if (nodeAdjDb.has_value()) {
+          updateAdjacencyDatabase(spfSolver, *nodeAdjDb, res);
+        } else if (spfSolver.deleteAdjacencyDatabase(nodeName)) {
+          // last of per adjacency keys withdrawn
           res.adjChanged = true;
           pendingAdjUpdates_.addUpdate(
-              myNodeName_, castToStd(adjacencyDb.perfEvents_ref()));
-        }
-        if (rc.second) {
-          // rebuild the routes, if related route attributes has been
-          // changed. e.g. node mpls label change, adjacency label change,
-          // local nexthops change etc.
-          res.prefixesChanged = true;
-          pendingPrefixUpdates_.addUpdate(
-              myNodeName_, castToStd(adjacencyDb.perfEvents_ref()));
-        }
-        if (spfSolver_->hasHolds() && orderedFibTimer_ != nullptr &&
-            !orderedFibTimer_->isScheduled()) {
-          orderedFibTimer_->scheduleTimeout(getMaxFib());
+              myNodeName_,
+              castToStd(thrift::PrefixDatabase().perfEvents_ref()));
         }
+        keyValueHashes.emplace(key, valueHash);
         continue;
       }
 
-      if (key.find(Constants::kPrefixDbMarker.toString()) == 0) {
+      if (isPrefixDbKey) {
+        isLsdbUpdated = true;
         // update prefixDb
         auto prefixDb = fbzmq::util::readThriftObjStr<thrift::PrefixDatabase>(
             rawVal.value_ref().value(), serializer_);
         CHECK_EQ(nodeName, prefixDb.thisNodeName);
-        auto nodePrefixDb = updateNodePrefixDatabase(key, prefixDb);
-        if (spfSolver_->updatePrefixDatabase(nodePrefixDb)) {
+        auto nodePrefixDb =
+            updateNodePrefixDatabase(area, key, std::move(prefixDb));
+        std::unordered_set<thrift::IpPrefix> changedPrefixes;
+        if (spfSolver.updatePrefixDatabase(nodePrefixDb, changedPrefixes)) {
           res.prefixesChanged = true;
           pendingPrefixUpdates_.addUpdate(
               myNodeName_, castToStd(nodePrefixDb.perfEvents_ref()));
+          pendingPrefixUpdates_.addUpdatedPrefixes(changedPrefixes);
         }
+        keyValueHashes.emplace(key, valueHash);
         continue;
       }
 
@@ -2022,11 +3904,30 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
   }
 
   // LSDB deletion
+  // Keys of node are originated by node itself. Nodes without any key left
+  // are dropped at once instead of key by key
+  std::unordered_set<std::string> expiredNodes;
+  if (auto expiredOriginators = thriftPub.expiredOriginators_ref()) {
+    for (const auto& nodeName : *expiredOriginators) {
+      isLsdbUpdated = true;
+      deleteNodeDatabases(spfSolver, area, nodeName, res);
+      expiredNodes.emplace(nodeName);
+    }
+  }
   for (const auto& key : thriftPub.expiredKeys) {
     std::string nodeName = getNodeNameFromKey(key);
+    keyValueHashes.erase(key);
+    if (expiredNodes.count(nodeName)) {
+      continue;
+    }
 
     if (key.find(Constants::kAdjDbMarker.toString()) == 0) {
-      if (spfSolver_->deleteAdjacencyDatabase(nodeName)) {
+      isLsdbUpdated = true;
+      auto nodeAdjDb = updateNodeAdjacencyDatabase(area, key, std::nullopt);
+      if (nodeAdjDb.has_value()) {
+        // adjacencies of other keys of node remain
+        updateAdjacencyDatabase(spfSolver, *nodeAdjDb, res);
+      } else if (spfSolver.deleteAdjacencyDatabase(nodeName)) {
         res.adjChanged = true;
         pendingAdjUpdates_.addUpdate(
             myNodeName_, castToStd(thrift::PrefixDatabase().perfEvents_ref()));
@@ -2035,13 +3936,17 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
     }
 
     if (key.find(Constants::kPrefixDbMarker.toString()) == 0) {
+      isLsdbUpdated = true;
       // manually build delete prefix db to signal delete just as a client would
       thrift::PrefixDatabase deletePrefixDb;
       deletePrefixDb.thisNodeName = nodeName;
       deletePrefixDb.deletePrefix = true;
-      auto nodePrefixDb = updateNodePrefixDatabase(key, deletePrefixDb);
-      if (spfSolver_->updatePrefixDatabase(nodePrefixDb)) {
+      auto nodePrefixDb =
+          updateNodePrefixDatabase(area, key, std::move(deletePrefixDb));
+      std::unordered_set<thrift::IpPrefix> changedPrefixes;
+      if (spfSolver.updatePrefixDatabase(nodePrefixDb, changedPrefixes)) {
         res.prefixesChanged = true;
+        pendingPrefixUpdates_.addUpdatedPrefixes(changedPrefixes);
       }
       continue;
     }
@@ -2052,54 +3957,139 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
 
 void
 Decision::processStaticRouteUpdates() {
-  auto maybePerfEvents = pendingPrefixUpdates_.getPerfEvents();
-  pendingPrefixUpdates_.clear();
-  if (coldStartTimer_->isScheduled()) {
+  if (inColdStart_) {
     return;
   }
 
-  if (maybePerfEvents) {
-    addPerfEvent(*maybePerfEvents, myNodeName_, "DECISION_DEBOUNCE");
-  }
-  // update routeDb once for all updates received
-  LOG(INFO) << "Decision: updating new routeDb.";
-  auto maybeRouteDb = spfSolver_->processStaticRouteUpdates();
+  // Static routes don't depend on computed routes nor the other way round,
+  // their squashed delta is published as is, without any route computation.
+  // Pending prefix updates are left to be processed on their own
+  auto maybeRouteDb = getSpfSolver(thrift::KvStore_constants::kDefaultArea())
+                          .processStaticRouteUpdates();
 
   if (not maybeRouteDb.has_value()) {
     LOG(WARNING) << "prefix manager updates incurred no route updates";
     return;
   }
 
-  fromStdOptional(maybeRouteDb.value().perfEvents_ref(), maybePerfEvents);
   routeUpdatesQueue_.push(std::move(maybeRouteDb.value()));
 }
 
 void
 Decision::pushRoutesDeltaUpdates(
     thrift::RouteDatabaseDelta& staticRoutesDelta) {
-  spfSolver_->pushRoutesDeltaUpdates(staticRoutesDelta);
+  getSpfSolver(thrift::KvStore_constants::kDefaultArea())
+      .pushRoutesDeltaUpdates(staticRoutesDelta);
+}
+
+void
+Decision::scheduleProcessPendingUpdates() {
+  if (processUpdatesBackoff_.atMaxBackoff()) {
+    CHECK(processUpdatesTimer_->isScheduled());
+    return;
+  }
+
+  // backoff doubles with every update received meanwhile, hence adapts to
+  // rate of updates
+  processUpdatesBackoff_.reportError();
+  auto timeout = processUpdatesBackoff_.getTimeRemainingUntilRetry();
+
+  // Updates arriving shortly after last route computation indicate churn.
+  // Wait at least as long as last computation took then, so that at most
+  // half of the time is spent on computing routes which are outdated soon.
+  // Isolated updates are still processed after initial backoff.
+  const auto maxBackoff = processUpdatesBackoff_.getMaxBackoff();
+  if (std::chrono::steady_clock::now() - lastProcessUpdatesTime_ <
+      maxBackoff) {
+    timeout =
+        std::max(timeout, std::min(lastProcessUpdatesDuration_, maxBackoff));
+  }
+  processUpdatesTimer_->scheduleTimeout(timeout);
+}
+
+void
+Decision::startProcessPendingUpdates() {
+  // routes computed during cold start are held back, but computed in
+  // background all the same
+  if (not routeExecutor_) {
+    processPendingUpdates();
+    return;
+  }
+
+  CHECK(not isComputingInBackground_);
+  isComputingInBackground_ = true;
+  folly::via(routeExecutor_.get(), [this]() { processPendingUpdates(); })
+      .via(getEvb())
+      .thenTry([this](folly::Try<folly::Unit>&& result) noexcept {
+        if (result.hasException()) {
+          LOG(FATAL) << "Exception occured in Decision::processPendingUpdates "
+                     << "- " << result.exception().what();
+        }
+        isComputingInBackground_ = false;
+
+        // next computation, if any, is scheduled by timer, hence no task gets
+        // deferred again here
+        auto tasks = std::move(deferredSolverTasks_);
+        deferredSolverTasks_.clear();
+        for (auto& task : tasks) {
+          task();
+        }
+      });
+}
+
+void
+Decision::stop() {
+  if (routeExecutor_) {
+    // completion of computation gets queued on evb once worker is done
+    routeExecutor_->join();
+    getEvb()->runInEventBaseThreadAndWait([]() {});
+  }
+  OpenrEventBase::stop();
+}
+
+void
+Decision::runWithSolvers(folly::Function<void()> fn) {
+  if (isComputingInBackground_) {
+    deferredSolverTasks_.emplace_back(std::move(fn));
+    return;
+  }
+  fn();
+}
+
+void
+Decision::runInEventBaseThreadWithSolvers(folly::Function<void()> fn) {
+  runInEventBaseThread([this, fn = std::move(fn)]() mutable {
+    runWithSolvers(std::move(fn));
+  });
 }
 
 void
 Decision::processPendingUpdates() {
-  // we need to update  static route first, because there maybe routes
-  // depending on static routes.
-  bool staticRoutesUpdated{false};
-  if (spfSolver_->staticRoutesUpdated()) {
-    staticRoutesUpdated = true;
+  const auto startTime = std::chrono::steady_clock::now();
+  SCOPE_EXIT {
+    lastProcessUpdatesTime_ = std::chrono::steady_clock::now();
+    lastProcessUpdatesDuration_ =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            lastProcessUpdatesTime_ - startTime);
+  };
+
+  // static routes are published as a delta of their own, without rebuilding
+  // other routes
+  if (getSpfSolver(thrift::KvStore_constants::kDefaultArea())
+          .staticRoutesUpdated()) {
     processStaticRouteUpdates();
   }
 
   if (processUpdatesStatus_.adjChanged) {
     processPendingAdjUpdates();
-  } else if (
-      processUpdatesStatus_.prefixesChanged ||
-      staticRoutesUpdated) // if only static routes gets updated, we still need
-                           // to update routes because there maybe routes
-                           // depended on static routes.
-  {
+  } else if (processUpdatesStatus_.prefixesChanged) {
     processPendingPrefixUpdates();
   }
+  if (not inColdStart_ and
+      (processUpdatesStatus_.adjChanged or
+       processUpdatesStatus_.prefixesChanged)) {
+    updateAreaSummaries();
+  }
 
   // reset update status
   processUpdatesStatus_.adjChanged = false;
@@ -2132,15 +4122,23 @@ Decision::processPendingAdjUpdates() {
     VLOG(1) << "Debounced " << pendingAdjUpdates_.getCount() << " events over "
             << std::chrono::milliseconds(duration).count() << "ms.";
   }
+  if (auto firstUpdateTime = pendingAdjUpdates_.getFirstUpdateTime()) {
+    addLatencyValue("decision.latency.debounce_ms", *firstUpdateTime);
+  }
   pendingAdjUpdates_.clear();
+  // routes of all prefixes are rebuilt, pending prefix updates included
+  SCOPE_EXIT {
+    pendingPrefixUpdates_.clear();
+  };
 
-  if (coldStartTimer_->isScheduled()) {
+  if (inColdStart_) {
+    speculateColdStartRouteDb(true /* computePaths */);
     return;
   }
 
   // run SPF once for all updates received
   LOG(INFO) << "Decision: computing new paths.";
-  auto maybeRouteDb = spfSolver_->buildPaths(myNodeName_);
+  auto maybeRouteDb = buildRouteDb(myNodeName_, true /* computePaths */);
   if (not maybeRouteDb.has_value()) {
     LOG(WARNING) << "AdjacencyDb updates incurred no route updates";
     return;
@@ -2153,17 +4151,40 @@ Decision::processPendingAdjUpdates() {
 void
 Decision::processPendingPrefixUpdates() {
   auto maybePerfEvents = pendingPrefixUpdates_.getPerfEvents();
-  pendingPrefixUpdates_.clear();
-  if (coldStartTimer_->isScheduled()) {
+  SCOPE_EXIT {
+    pendingPrefixUpdates_.clear();
+  };
+  if (inColdStart_) {
+    speculateColdStartRouteDb(false /* computePaths */);
     return;
   }
 
   if (maybePerfEvents) {
     addPerfEvent(*maybePerfEvents, myNodeName_, "DECISION_DEBOUNCE");
   }
+  if (auto firstUpdateTime = pendingPrefixUpdates_.getFirstUpdateTime()) {
+    addLatencyValue("decision.latency.debounce_ms", *firstUpdateTime);
+  }
+
+  // only prefixes have changed, recompute just their routes
+  auto const& updatedPrefixes = pendingPrefixUpdates_.getUpdatedPrefixes();
+  if (not pendingPrefixUpdates_.needsFullRebuild() and
+      not updatedPrefixes.empty()) {
+    LOG(INFO) << "Decision: updating routes of " << updatedPrefixes.size()
+              << " prefixes.";
+    auto maybeRoutes = buildUnicastRoutes(updatedPrefixes);
+    if (not maybeRoutes.has_value()) {
+      LOG(WARNING) << "PrefixDb updates incurred no route updates";
+      return;
+    }
+    sendUnicastRouteUpdate(
+        maybeRoutes.value(), updatedPrefixes, maybePerfEvents, "ROUTE_UPDATE");
+    return;
+  }
+
   // update routeDb once for all updates received
   LOG(INFO) << "Decision: updating new routeDb.";
-  auto maybeRouteDb = spfSolver_->buildRouteDb(myNodeName_);
+  auto maybeRouteDb = buildRouteDb(myNodeName_, false /* computePaths */);
   if (not maybeRouteDb.has_value()) {
     LOG(WARNING) << "PrefixDb updates incurred no route updates";
     return;
@@ -2175,11 +4196,15 @@ Decision::processPendingPrefixUpdates() {
 
 void
 Decision::decrementOrderedFibHolds() {
-  if (spfSolver_->decrementHolds()) {
-    if (coldStartTimer_->isScheduled()) {
+  bool holdsDecremented{false};
+  for (auto& kv : spfSolvers_) {
+    holdsDecremented |= kv.second->decrementHolds();
+  }
+  if (holdsDecremented) {
+    if (inColdStart_) {
       return;
     }
-    auto maybeRouteDb = spfSolver_->buildPaths(myNodeName_);
+    auto maybeRouteDb = buildRouteDb(myNodeName_, true /* computePaths */);
     if (not maybeRouteDb.has_value()) {
       LOG(INFO) << "decrementOrderedFibHolds incurred no route updates";
       return;
@@ -2194,7 +4219,28 @@ Decision::decrementOrderedFibHolds() {
 
 void
 Decision::coldStartUpdate() {
-  auto maybeRouteDb = spfSolver_->buildPaths(myNodeName_);
+  if (not inColdStart_) {
+    return;
+  }
+  inColdStart_ = false;
+  coldStartTimer_->cancelTimeout();
+
+  std::optional<thrift::RouteDatabase> maybeRouteDb;
+  if (coldStartRouteDb_.has_value() and
+      coldStartLsdbGeneration_ == lsdbGeneration_) {
+    LOG(INFO) << "Publishing routes computed during cold start";
+    fb303::fbData->addStatValue(
+        "decision.cold_start.speculative_hits", 1, fb303::COUNT);
+    maybeRouteDb = std::move(coldStartRouteDb_);
+  } else {
+    // SPF results of speculative computation still hold unless adjacencies
+    // changed since
+    maybeRouteDb = buildRouteDb(
+        myNodeName_,
+        processUpdatesStatus_.adjChanged or not coldStartRouteDb_.has_value());
+  }
+  coldStartRouteDb_.reset();
+  updateAreaSummaries();
   if (not maybeRouteDb.has_value()) {
     LOG(ERROR) << "SEVERE: No routes to program after cold start duration. "
                << "Sending empty route db to FIB";
@@ -2208,6 +4254,65 @@ Decision::coldStartUpdate() {
   sendRouteUpdate(maybeRouteDb.value(), "COLD_START_UPDATE");
 }
 
+void
+Decision::processInitialSyncDone(std::string const& area) {
+  if (not inColdStart_ or not areasPendingInitialSync_.erase(area)) {
+    return;
+  }
+  LOG(INFO) << "KvStore is done with initial sync of area " << area << ", "
+            << areasPendingInitialSync_.size() << " areas pending";
+  if (not areasPendingInitialSync_.empty()) {
+    return;
+  }
+  // LSDB is complete, no need to wait for rest of cold start duration
+  coldStartUpdate();
+}
+
+void
+Decision::speculateColdStartRouteDb(bool computePaths) {
+  coldStartLsdbGeneration_ = lsdbGeneration_;
+  coldStartRouteDb_ = buildRouteDb(myNodeName_, computePaths);
+}
+
+void
+Decision::updateAreaSummaries() {
+  if (not prefixUpdatesQueue_ or areaSummaries_.empty()) {
+    return;
+  }
+
+  std::set<thrift::IpPrefix> summaries;
+  for (auto const& kv : areaSummaries_) {
+    auto solverIt = spfSolvers_.find(kv.first);
+    if (solverIt == spfSolvers_.end()) {
+      continue;
+    }
+    for (auto& summary : solverIt->second->getActiveSummaries(kv.second)) {
+      summaries.emplace(std::move(summary));
+    }
+  }
+  if (summaries == advertisedSummaries_) {
+    return;
+  }
+
+  LOG(INFO) << "Advertising " << summaries.size() << " area summaries";
+  thrift::PrefixUpdateRequest request;
+  request.cmd = thrift::PrefixUpdateCommand::SYNC_PREFIXES_BY_TYPE;
+  request.type_ref() = thrift::PrefixType::AREA_SUMMARY;
+  for (auto const& summary : summaries) {
+    request.prefixes.emplace_back(createPrefixEntry(
+        summary,
+        thrift::PrefixType::AREA_SUMMARY,
+        "",
+        thrift::PrefixForwardingType::IP,
+        thrift::PrefixForwardingAlgorithm::SP_ECMP,
+        true /* ephemeral */));
+  }
+  prefixUpdatesQueue_->push(std::move(request));
+  advertisedSummaries_ = std::move(summaries);
+  fb303::fbData->setCounter(
+      "decision.num_area_summaries", advertisedSummaries_.size());
+}
+
 void
 Decision::sendRouteUpdate(
     thrift::RouteDatabase& db, std::string const& eventDescription) {
@@ -2215,16 +4320,169 @@ Decision::sendRouteUpdate(
     addPerfEvent(db.perfEvents_ref().value(), myNodeName_, eventDescription);
   }
 
-  // sorting the input to meet findDeltaRoutes()'s assumption
-  std::sort(db.mplsRoutes.begin(), db.mplsRoutes.end());
-  std::sort(db.unicastRoutes.begin(), db.unicastRoutes.end());
   // Find out delta to be sent to Fib
-  auto routeDelta = findDeltaRoutes(db, routeDb_);
+  auto startTime = std::chrono::steady_clock::now();
+  auto routeDelta = routeDb_.update(db);
   routeDelta.perfEvents_ref().copy_from(db.perfEvents_ref());
-  routeDb_ = std::move(db);
+  addLatencyValue("decision.latency.route_delta_ms", startTime);
+
+  // publish the new route state
+  startTime = std::chrono::steady_clock::now();
+  routeUpdatesQueue_.push(std::move(routeDelta));
+  addLatencyValue("decision.latency.route_push_ms", startTime);
+}
+
+void
+Decision::sendUnicastRouteUpdate(
+    std::vector<thrift::UnicastRoute>& routes,
+    std::unordered_set<thrift::IpPrefix> const& prefixes,
+    std::optional<thrift::PerfEvents> perfEvents,
+    std::string const& eventDescription) {
+  if (perfEvents.has_value()) {
+    addPerfEvent(perfEvents.value(), myNodeName_, eventDescription);
+  }
+
+  auto startTime = std::chrono::steady_clock::now();
+  auto routeDelta = routeDb_.updateUnicastRoutes(routes, prefixes);
+  routeDelta.thisNodeName = myNodeName_;
+  fromStdOptional(routeDelta.perfEvents_ref(), perfEvents);
+  addLatencyValue("decision.latency.route_delta_ms", startTime);
 
   // publish the new route state
+  startTime = std::chrono::steady_clock::now();
   routeUpdatesQueue_.push(std::move(routeDelta));
+  addLatencyValue("decision.latency.route_push_ms", startTime);
+}
+
+SpfSolver&
+Decision::getSpfSolver(const std::string& area) {
+  auto& spfSolver = spfSolvers_[area];
+  if (not spfSolver) {
+    LOG(INFO) << "Decision: creating SPF solver for area " << area;
+    auto const& tConfig = config_->getConfig();
+    std::optional<size_t> maxPrefixesPerNode;
+    if (auto maxPrefixes = tConfig.decision_max_prefixes_per_node_ref()) {
+      maxPrefixesPerNode = *maxPrefixes;
+    }
+    spfSolver = std::make_unique<SpfSolver>(
+        tConfig.node_name,
+        tConfig.enable_v4_ref().value_or(false),
+        computeLfaPaths_,
+        tConfig.enable_ordered_fib_programming_ref().value_or(false),
+        bgpDryRun_,
+        tConfig.bgp_use_igp_metric_ref().value_or(false),
+        true /* enableIncrementalSpf */,
+        std::max(tConfig.decision_lfa_spf_threads_ref().value_or(0), 0),
+        maxPrefixesPerNode,
+        tConfig.decision_prefix_limit_action);
+  }
+  return *spfSolver;
+}
+
+void
+Decision::forEachSpfSolver(
+    const std::function<void(size_t, SpfSolver&)>& fn) {
+  if (not areaExecutor_ or spfSolvers_.size() == 1) {
+    size_t index{0};
+    for (auto& kv : spfSolvers_) {
+      fn(index++, *kv.second);
+    }
+    return;
+  }
+
+  // areas share no state, every task only touches the solver of its area
+  std::vector<folly::SemiFuture<folly::Unit>> areaRuns;
+  areaRuns.reserve(spfSolvers_.size());
+  size_t index{0};
+  for (auto& kv : spfSolvers_) {
+    areaRuns.emplace_back(
+        folly::via(
+            areaExecutor_.get(),
+            [&fn, index, &spfSolver = *kv.second]() { fn(index, spfSolver); })
+            .semi());
+    ++index;
+  }
+  folly::collect(std::move(areaRuns)).get();
+}
+
+std::optional<thrift::RouteDatabase>
+Decision::buildRouteDb(const std::string& nodeName, bool computePaths) {
+  if (routeComputationEngine_ and nodeName == myNodeName_) {
+    if (auto routeDb = buildRouteDbWithEngine(nodeName)) {
+      if (routeDb->unicastRoutes.empty() and routeDb->mplsRoutes.empty()) {
+        return std::nullopt;
+      }
+      return routeDb;
+    }
+  }
+
+  std::vector<std::optional<thrift::RouteDatabase>> maybeAreaRouteDbs(
+      spfSolvers_.size());
+  forEachSpfSolver([&](size_t index, SpfSolver& spfSolver) {
+    maybeAreaRouteDbs[index] = computePaths ? spfSolver.buildPaths(nodeName)
+                                            : spfSolver.buildRouteDb(nodeName);
+  });
+
+  std::vector<thrift::RouteDatabase> areaRouteDbs;
+  for (auto& maybeAreaRouteDb : maybeAreaRouteDbs) {
+    if (maybeAreaRouteDb.has_value()) {
+      areaRouteDbs.emplace_back(std::move(maybeAreaRouteDb.value()));
+    }
+  }
+  if (areaRouteDbs.empty()) {
+    return std::nullopt;
+  }
+  if (areaRouteDbs.size() == 1) {
+    return std::move(areaRouteDbs.front());
+  }
+  return detail::mergeAreaRouteDbs(areaRouteDbs);
+}
+
+std::optional<thrift::RouteDatabase>
+Decision::buildRouteDbWithEngine(const std::string& nodeName) {
+  const auto startTime = std::chrono::steady_clock::now();
+  try {
+    auto routeDb =
+        routeComputationEngine_->computeRouteDb(nodeName, copyAreaLsdbs())
+            .within(routeComputationEngineTimeout_)
+            .get();
+    routeDb.thisNodeName = nodeName;
+    fb303::fbData->addStatValue(
+        "decision.route_engine.success", 1, fb303::COUNT);
+    addLatencyValue("decision.latency.route_engine_ms", startTime);
+    return routeDb;
+  } catch (std::exception const& ex) {
+    LOG(ERROR) << "Route computation engine failed, computing routes with "
+               << "SpfSolver instead: " << folly::exceptionStr(ex);
+    fb303::fbData->addStatValue(
+        "decision.route_engine.fallback", 1, fb303::COUNT);
+    return std::nullopt;
+  }
+}
+
+std::optional<std::vector<thrift::UnicastRoute>>
+Decision::buildUnicastRoutes(
+    const std::unordered_set<thrift::IpPrefix>& prefixes) {
+  std::vector<std::optional<std::vector<thrift::UnicastRoute>>>
+      maybeAreaRoutes(spfSolvers_.size());
+  forEachSpfSolver([&](size_t index, SpfSolver& spfSolver) {
+    maybeAreaRoutes[index] =
+        spfSolver.buildUnicastRoutes(myNodeName_, prefixes);
+  });
+
+  std::vector<std::vector<thrift::UnicastRoute>> areaRoutes;
+  for (auto& maybeRoutes : maybeAreaRoutes) {
+    if (maybeRoutes.has_value()) {
+      areaRoutes.emplace_back(std::move(maybeRoutes.value()));
+    }
+  }
+  if (areaRoutes.empty()) {
+    return std::nullopt;
+  }
+  if (areaRoutes.size() == 1) {
+    return std::move(areaRoutes.front());
+  }
+  return detail::mergeAreaUnicastRoutes(areaRoutes);
 }
 
 std::chrono::milliseconds
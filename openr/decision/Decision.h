@@ -7,9 +7,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <map>
+#include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <boost/serialization/strong_typedef.hpp>
 #include <fbzmq/async/ZmqThrottle.h>
@@ -19,11 +24,13 @@
 #include <folly/IPAddress.h>
 #include <folly/Memory.h>
 #include <folly/String.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/futures/Future.h>
 #include <folly/io/async/AsyncTimeout.h>
 #include <thrift/lib/cpp2/Thrift.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
+#include <openr/common/Constants.h>
 #include <openr/common/ExponentialBackoff.h>
 #include <openr/common/OpenrEventBase.h>
 #include <openr/common/Util.h>
@@ -66,6 +73,22 @@ struct DecisionPendingUpdates {
     count_ = 0;
     minTs_ = std::nullopt;
     perfEvents_ = std::nullopt;
+    firstUpdateTime_ = std::nullopt;
+    updatedPrefixes_.clear();
+    needsFullRebuild_ = false;
+  }
+
+  // prefixes whose routes need to be recomputed
+  void
+  addUpdatedPrefixes(const std::unordered_set<thrift::IpPrefix>& prefixes) {
+    updatedPrefixes_.insert(prefixes.begin(), prefixes.end());
+  }
+
+  // routes can't be recomputed per prefix, e.g. because of label or nexthop
+  // changes of adjacencies
+  void
+  setNeedsFullRebuild() {
+    needsFullRebuild_ = true;
   }
 
   void
@@ -73,6 +96,9 @@ struct DecisionPendingUpdates {
       const std::string& nodeName,
       const std::optional<thrift::PerfEvents>& perfEvents) {
     ++count_;
+    if (not firstUpdateTime_) {
+      firstUpdateTime_ = std::chrono::steady_clock::now();
+    }
 
     // Skip if perf information is missing
     if (not perfEvents.has_value()) {
@@ -105,10 +131,109 @@ struct DecisionPendingUpdates {
     return perfEvents_;
   }
 
+  // local time of the first update buffered since the last clear()
+  std::optional<std::chrono::steady_clock::time_point>
+  getFirstUpdateTime() const {
+    return firstUpdateTime_;
+  }
+
+  std::unordered_set<thrift::IpPrefix> const&
+  getUpdatedPrefixes() const {
+    return updatedPrefixes_;
+  }
+
+  bool
+  needsFullRebuild() const {
+    return needsFullRebuild_;
+  }
+
  private:
   uint32_t count_{0};
   std::optional<int64_t> minTs_;
   std::optional<thrift::PerfEvents> perfEvents_;
+  std::optional<std::chrono::steady_clock::time_point> firstUpdateTime_;
+  std::unordered_set<thrift::IpPrefix> updatedPrefixes_;
+  bool needsFullRebuild_{false};
+};
+
+/**
+ * Routes computed by Decision, indexed by their key (destination or label)
+ * along with a hash of their content. The delta to newly computed routes is
+ * found with a lookup per route instead of sorting and diffing two complete
+ * route databases, and only routes with an unchanged hash are compared.
+ */
+class DecisionRouteDb {
+ public:
+  // replace all routes with the ones of routeDb and return the delta. Routes
+  // are moved out of routeDb
+  thrift::RouteDatabaseDelta update(thrift::RouteDatabase& routeDb);
+
+  // replace routes towards prefixes with unicastRoutes, which are moved from,
+  // and return the delta. Prefixes without a route are withdrawn
+  thrift::RouteDatabaseDelta updateUnicastRoutes(
+      std::vector<thrift::UnicastRoute>& unicastRoutes,
+      std::unordered_set<thrift::IpPrefix> const& prefixes);
+
+  size_t
+  getUnicastRoutesCount() const {
+    return unicastRoutes_.size();
+  }
+
+  size_t
+  getMplsRoutesCount() const {
+    return mplsRoutes_.size();
+  }
+
+ private:
+  template <typename Route>
+  struct RouteEntry {
+    size_t hash{0};
+    // generation of the last full update which contained this route
+    uint64_t generation{0};
+    Route route;
+  };
+
+  template <typename Key, typename Route>
+  using RouteMap = std::unordered_map<Key, RouteEntry<Route>>;
+
+  // store route, adding a copy of it to routesToUpdate if it is new or has
+  // changed
+  template <typename Key, typename Route>
+  void setRoute(
+      RouteMap<Key, Route>& routes,
+      Route&& route,
+      std::vector<Route>& routesToUpdate);
+
+  // store all newRoutes and remove the ones not among them. Keys of removed
+  // routes are added to keysToDelete
+  template <typename Key, typename Route>
+  void replaceRoutes(
+      RouteMap<Key, Route>& routes,
+      std::vector<Route>& newRoutes,
+      std::vector<Route>& routesToUpdate,
+      std::vector<Key>& keysToDelete);
+
+  RouteMap<thrift::IpPrefix, thrift::UnicastRoute> unicastRoutes_;
+  RouteMap<int32_t, thrift::MplsRoute> mplsRoutes_;
+  uint64_t generation_{0};
+};
+
+// Merge routes computed independently for each area into one route database.
+// For every destination the route of the area with the lowest nexthop metric
+// is kept, nexthops of areas with an equal metric are combined. Routes are
+// moved out of areaRouteDbs
+thrift::RouteDatabase mergeAreaRouteDbs(
+    std::vector<thrift::RouteDatabase>& areaRouteDbs);
+
+// Same as above for the unicast routes of a subset of prefixes
+std::vector<thrift::UnicastRoute> mergeAreaUnicastRoutes(
+    std::vector<std::vector<thrift::UnicastRoute>>& areaUnicastRoutes);
+
+// Copy of adjacency and prefix databases of an area, to compute routes on off
+// evb thread of Decision
+struct AreaLsdb {
+  std::unordered_map<std::string, thrift::AdjacencyDatabase> adjDbs;
+  std::unordered_map<std::string, thrift::PrefixDatabase> prefixDbs;
 };
 } // namespace detail
 
@@ -123,7 +248,15 @@ class SpfSolver {
       bool computeLfaPaths,
       bool enableOrderedFib = false,
       bool bgpDryRun = false,
-      bool bgpUseIgpMetric = false);
+      bool bgpUseIgpMetric = false,
+      bool enableIncrementalSpf = true,
+      // run SPF from LFA neighbors on a pool of this many threads, inline on
+      // the calling thread if 0
+      size_t numSpfThreads = 0,
+      // limit of prefixes taken from a single node, see PrefixState
+      std::optional<size_t> maxPrefixesPerNode = std::nullopt,
+      thrift::PrefixLimitAction prefixLimitAction =
+          thrift::PrefixLimitAction::IGNORE_EXCESS);
   ~SpfSolver();
 
   //
@@ -161,6 +294,12 @@ class SpfSolver {
   // routeDb change
   bool updatePrefixDatabase(thrift::PrefixDatabase const& prefixDb);
 
+  // same as above, additionally collects prefixes whose routes may have
+  // changed into changedPrefixes
+  bool updatePrefixDatabase(
+      thrift::PrefixDatabase const& prefixDb,
+      std::unordered_set<thrift::IpPrefix>& changedPrefixes);
+
   // get prefix databases
   std::unordered_map<std::string /* nodeName */, thrift::PrefixDatabase>
   getPrefixDatabases();
@@ -176,8 +315,21 @@ class SpfSolver {
   std::optional<thrift::RouteDatabase> buildRouteDb(
       const std::string& myNodeName);
 
+  // Build unicast routes towards given prefixes only, using cached SPF
+  // computation from perspective of a given router. Prefixes without a route
+  // (e.g. withdrawn ones) are absent from the result.
+  // Returns std::nullopt if myNodeName is not part of the topology
+  std::optional<std::vector<thrift::UnicastRoute>> buildUnicastRoutes(
+      const std::string& myNodeName,
+      const std::unordered_set<thrift::IpPrefix>& prefixes);
+
   bool decrementHolds();
 
+  // summaries covering a prefix of a node reachable from this node, other
+  // than area summaries and prefixes of this node
+  std::vector<thrift::IpPrefix> getActiveSummaries(
+      const std::vector<thrift::IpPrefix>& summaries);
+
   void updateGlobalCounters();
 
  private:
@@ -190,6 +342,22 @@ class SpfSolver {
   std::unique_ptr<SpfSolverImpl> impl_;
 };
 
+//
+// External engine computing routes from snapshots of link state, e.g. an
+// accelerated path computation engine or one in another process. Decision
+// hands it the databases of all areas whenever routes of this node are built,
+// and falls back to SpfSolver if the engine fails or misses its timeout.
+//
+class RouteComputationEngine {
+ public:
+  virtual ~RouteComputationEngine() = default;
+
+  // Routes of nodeName merged across areas in topology of areaLsdbs. Waited
+  // for on Decision thread, so must not need it to complete
+  virtual folly::SemiFuture<thrift::RouteDatabase> computeRouteDb(
+      std::string nodeName, std::vector<detail::AreaLsdb> areaLsdbs) = 0;
+};
+
 //
 // The decision thread announces FIB updates for myNodeName every time
 // there is a change in LSDB. The announcements are made on a PUB socket. At
@@ -215,13 +383,20 @@ class Decision : public OpenrEventBase {
       bool bgpDryRun,
       std::chrono::milliseconds debounceMinDur,
       std::chrono::milliseconds debounceMaxDur,
-      messaging::RQueue<thrift::Publication> kvStoreUpdatesQueue,
+      messaging::RQueue<messaging::SharedValue<thrift::Publication>>
+          kvStoreUpdatesQueue,
       messaging::RQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue,
       messaging::ReplicateQueue<thrift::RouteDatabaseDelta>& routeUpdatesQueue,
-      fbzmq::Context& zmqContext);
+      fbzmq::Context& zmqContext,
+      // to advertise summaries of areas on area border nodes, if configured
+      messaging::ReplicateQueue<thrift::PrefixUpdateRequest>*
+          prefixUpdatesQueue = nullptr);
 
   virtual ~Decision() = default;
 
+  // waits for background route computation, if any, before stopping evb
+  void stop() override;
+
   /*
    * Retrieve routeDb from specified node.
    * If empty nodename specified, will return routeDb of its own
@@ -229,6 +404,29 @@ class Decision : public OpenrEventBase {
   folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>> getDecisionRouteDb(
       std::string nodeName);
 
+  /*
+   * Compute routes of request's node, this node if empty, as if its node
+   * overloads and link changes were applied to the topology, and return their
+   * delta to routes of the node in current topology. Runs on a worker thread
+   * against copies of adjacency and prefix databases, leaving live ones and
+   * route computation untouched. Fails with std::invalid_argument for unknown
+   * nodes or links, and with folly::FutureTimeout past time budget of request.
+   */
+  folly::SemiFuture<std::unique_ptr<thrift::RouteDatabaseDelta>>
+  getRouteDbWhatIf(thrift::RouteDbWhatIfRequest request);
+
+  /*
+   * Compute routes of each of nodeNames, this node for empty names, and hand
+   * them to routeDbCb as soon as each is ready. Routes are computed on a
+   * thread pool against one copy of adjacency and prefix databases, taken on
+   * call, so all are consistent with each other. routeDbCb is called from
+   * threads of the pool, concurrently. Returned future completes once all
+   * route databases are handed over.
+   */
+  folly::SemiFuture<folly::Unit> getDecisionRouteDbs(
+      std::vector<std::string> nodeNames,
+      std::function<void(thrift::RouteDatabase)> routeDbCb);
+
   folly::SemiFuture<std::unique_ptr<thrift::StaticRoutes>>
   getDecisionStaticRoutes();
 
@@ -242,6 +440,33 @@ class Decision : public OpenrEventBase {
    */
   folly::SemiFuture<std::unique_ptr<thrift::PrefixDbs>> getDecisionPrefixDbs();
 
+  /*
+   * Offload route computation of this node to engine, or stop offloading with
+   * nullptr. Routes of engine are used if they arrive within timeout, else
+   * SpfSolver computes them. Ignored with ordered FIB programming, which
+   * relies on state of SpfSolver.
+   */
+  void setRouteComputationEngine(
+      std::shared_ptr<RouteComputationEngine> engine,
+      std::chrono::milliseconds timeout =
+          Constants::kDecisionRouteEngineTimeout);
+
+  /*
+   * Apply debounce timers of reloaded config, if set. Updates already being
+   * debounced are processed with the new timers.
+   */
+  folly::SemiFuture<folly::Unit> reloadConfig(
+      std::shared_ptr<const Config> config);
+
+  /*
+   * Generation of adjacency and prefix databases, bumped on each of their
+   * changes. Can be read from any thread.
+   */
+  int64_t
+  getLsdbGeneration() const {
+    return lsdbGeneration_.load();
+  }
+
  private:
   Decision(Decision const&) = delete;
   Decision& operator=(Decision const&) = delete;
@@ -274,6 +499,25 @@ class Decision : public OpenrEventBase {
   // gracefulRestartDuration
   std::unique_ptr<folly::AsyncTimeout> coldStartTimer_{nullptr};
 
+  // whether first routes are held back till cold start is over, which is the
+  // case till KvStore is done with initial sync of all areas or cold start
+  // timer fires. Routes computed meanwhile are kept in coldStartRouteDb_,
+  // along with generation of LSDB they were computed from. Accessed with
+  // solvers only, see runWithSolvers
+  bool inColdStart_{false};
+  std::unordered_set<std::string> areasPendingInitialSync_;
+  std::optional<thrift::RouteDatabase> coldStartRouteDb_;
+  int64_t coldStartLsdbGeneration_{0};
+
+  // Summary prefixes by area, if this node is in more than one area, and the
+  // ones currently advertised through prefixUpdatesQueue_. Accessed with
+  // solvers only
+  std::map<std::string /* area */, std::vector<thrift::IpPrefix>>
+      areaSummaries_;
+  std::set<thrift::IpPrefix> advertisedSummaries_;
+  messaging::ReplicateQueue<thrift::PrefixUpdateRequest>* prefixUpdatesQueue_{
+      nullptr};
+
   /**
    * Timer to schedule pending update processing
    * Refer to processUpdatesStatus_ to decide whether spf recalculation or
@@ -283,6 +527,11 @@ class Decision : public OpenrEventBase {
   std::unique_ptr<folly::AsyncTimeout> processUpdatesTimer_;
   ExponentialBackoff<std::chrono::milliseconds> processUpdatesBackoff_;
 
+  // end time and duration of last processing of pending updates, see
+  // scheduleProcessPendingUpdates
+  std::chrono::steady_clock::time_point lastProcessUpdatesTime_;
+  std::chrono::milliseconds lastProcessUpdatesDuration_{0};
+
   // store update to-do status
   ProcessPublicationResult processUpdatesStatus_;
 
@@ -296,6 +545,30 @@ class Decision : public OpenrEventBase {
    */
   void processPendingUpdates();
 
+  /**
+   * Schedule processing of pending updates with a timeout adapting to rate
+   * of updates and time taken by last processing
+   */
+  void scheduleProcessPendingUpdates();
+
+  /**
+   * Process pending updates on routeExecutor_ if configured, else right away.
+   * Background computation owns all SPF solvers and route state till it has
+   * finished, everything else touching them is deferred, see runWithSolvers
+   */
+  void startProcessPendingUpdates();
+
+  /**
+   * Run fn, which may access SPF solvers and route state, right away unless
+   * a background route computation is running. In that case fn is queued
+   * and run once computation has finished, preserving order of tasks.
+   * Must be called in evb thread
+   */
+  void runWithSolvers(folly::Function<void()> fn);
+
+  // schedule fn in evb thread, see runWithSolvers
+  void runInEventBaseThreadWithSolvers(folly::Function<void()> fn);
+
   /**
    * Function to process pending adjacency publications.
    */
@@ -310,22 +583,114 @@ class Decision : public OpenrEventBase {
 
   void coldStartUpdate();
 
+  // end cold start once KvStore is done with initial sync of all areas
+  void processInitialSyncDone(std::string const& area);
+
+  // compute routes of LSDB received so far during cold start, to be
+  // published when it is over unless LSDB changes meanwhile
+  void speculateColdStartRouteDb(bool computePaths);
+
+  // advertise active summaries of areas, see getActiveSummaries, through
+  // PrefixManager if they changed since last advertised
+  void updateAreaSummaries();
+
   void sendRouteUpdate(
       thrift::RouteDatabase& db, std::string const& eventDescription);
 
+  // apply freshly computed routes of prefixes on routeDb_ and publish the
+  // delta. Prefixes without a route in routes are withdrawn
+  void sendUnicastRouteUpdate(
+      std::vector<thrift::UnicastRoute>& routes,
+      std::unordered_set<thrift::IpPrefix> const& prefixes,
+      std::optional<thrift::PerfEvents> perfEvents,
+      std::string const& eventDescription);
+
   std::chrono::milliseconds getMaxFib();
 
   // node to prefix entries database for nodes advertising per prefix keys
   thrift::PrefixDatabase updateNodePrefixDatabase(
-      const std::string& key, const thrift::PrefixDatabase& prefixDb);
+      const std::string& area,
+      const std::string& key,
+      thrift::PrefixDatabase prefixDb);
+
+  // merged adjacency database of node out of its adjacency database key and
+  // per adjacency keys, after update (or expiry if adjDb is not set) of key.
+  // Returns nothing if node doesn't advertise any of them anymore.
+  std::optional<thrift::AdjacencyDatabase> updateNodeAdjacencyDatabase(
+      const std::string& area,
+      const std::string& key,
+      std::optional<thrift::AdjacencyDatabase> adjDb);
+
+  // append flood hops of publication, stamped by KvStores along its flood
+  // path, to perf events of adjacency database carried by it
+  static void addFloodPerfEvents(
+      thrift::Publication const& thriftPub,
+      thrift::AdjacencyDatabase& adjacencyDb);
+
+  // apply adjacency database of node on SPF solver and mark pending updates
+  void updateAdjacencyDatabase(
+      SpfSolver& spfSolver,
+      thrift::AdjacencyDatabase const& adjacencyDb,
+      ProcessPublicationResult& res);
+
+  // drop all adjacency and prefix databases of node gone from area at once,
+  // and mark pending updates
+  void deleteNodeDatabases(
+      SpfSolver& spfSolver,
+      const std::string& area,
+      const std::string& nodeName,
+      ProcessPublicationResult& res);
+
+  // SPF path calculator of area, created on first use
+  SpfSolver& getSpfSolver(const std::string& area);
+
+  // run fn on the SPF path calculator of every area along with its index in
+  // spfSolvers_. Areas are processed concurrently on areaExecutor_ if set
+  void forEachSpfSolver(const std::function<void(size_t, SpfSolver&)>& fn);
+
+  // routes of nodeName merged across all areas, running SPF first if
+  // computePaths is set. Returns std::nullopt if no area has routes for
+  // nodeName
+  std::optional<thrift::RouteDatabase> buildRouteDb(
+      const std::string& nodeName, bool computePaths);
+
+  // copy of databases of all areas, taken on evb
+  folly::SemiFuture<std::vector<detail::AreaLsdb>> getAreaLsdbs();
+
+  // copy of databases of all areas. Must be called with solvers at hand
+  std::vector<detail::AreaLsdb> copyAreaLsdbs() const;
+
+  // routes of nodeName computed by routeComputationEngine_. Returns
+  // std::nullopt if engine failed or timed out
+  std::optional<thrift::RouteDatabase> buildRouteDbWithEngine(
+      const std::string& nodeName);
+
+  // creates solvers to compute routes of copies of databases with
+  std::function<std::unique_ptr<SpfSolver>()> getSnapshotSpfSolverFactory()
+      const;
+
+  // routes of myNodeName_ towards given prefixes merged across all areas
+  std::optional<std::vector<thrift::UnicastRoute>> buildUnicastRoutes(
+      const std::unordered_set<thrift::IpPrefix>& prefixes);
 
-  thrift::RouteDatabase routeDb_;
+  detail::DecisionRouteDb routeDb_;
 
   // Queue to publish route changes
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta>& routeUpdatesQueue_;
 
-  // the pointer to the SPF path calculator
-  std::unique_ptr<SpfSolver> spfSolver_;
+  // SPF path calculators, one per area, each with its own LinkState and
+  // PrefixState. The one of the default area always exists and also keeps
+  // static routes. Ordered to merge routes deterministically
+  std::map<std::string /* area */, std::unique_ptr<SpfSolver>> spfSolvers_;
+
+  // generation of adjacency and prefix databases of spfSolvers_
+  std::atomic<int64_t> lsdbGeneration_{0};
+
+  // computes routes of areas in parallel, if configured
+  std::unique_ptr<folly::CPUThreadPoolExecutor> areaExecutor_;
+
+  const bool computeLfaPaths_{false};
+  const bool bgpDryRun_{false};
 
   // For orderedFib prgramming, we keep track of the fib programming times
   // across the network
@@ -348,12 +713,54 @@ class Decision : public OpenrEventBase {
   // need to store all this for backward compatibility, otherwise a key update
   // can lead to mistakenly withdrawing some prefixes
   std::unordered_map<
-      std::string,
-      std::unordered_map<thrift::IpPrefix, thrift::PrefixEntry>>
+      std::string /* area */,
+      std::unordered_map<
+          std::string /* nodeName */,
+          std::unordered_map<thrift::IpPrefix, thrift::PrefixEntry>>>
       perPrefixPrefixEntries_, fullDbPrefixEntries_;
 
+  // adjacency databases as advertised by nodes in adjacency database key, and
+  // in per adjacency keys (single adjacency each)
+  std::unordered_map<
+      std::string /* area */,
+      std::unordered_map<std::string /* nodeName */, thrift::AdjacencyDatabase>>
+      fullDbAdjacencyDbs_;
+  std::unordered_map<
+      std::string /* area */,
+      std::unordered_map<
+          std::string /* nodeName */,
+          std::map<std::string /* key */, thrift::AdjacencyDatabase>>>
+      perAdjacencyDbs_;
+
+  // hash of value (version, originator and value) last processed for every
+  // adjacency and prefix key. Values processed already aren't deserialized
+  // again, e.g. when flooded to us once more
+  std::unordered_map<
+      std::string /* area */,
+      std::unordered_map<std::string /* key */, int64_t /* hash */>>
+      keyValueHashes_;
+
   // this node's name and the key markers
   const std::string myNodeName_;
+
+  // whether background route computation is running, and tasks deferred
+  // until it has finished
+  bool isComputingInBackground_{false};
+  std::vector<folly::Function<void()>> deferredSolverTasks_;
+
+  // external engine computing routes of this node, if any
+  std::shared_ptr<RouteComputationEngine> routeComputationEngine_;
+  std::chrono::milliseconds routeComputationEngineTimeout_{
+      Constants::kDecisionRouteEngineTimeout};
+
+  // computes routes of copies of databases, for what-if and batch route
+  // dumps. Tasks don't refer to any member
+  std::unique_ptr<folly::CPUThreadPoolExecutor> snapshotExecutor_;
+
+  // computes routes of pending updates off evb thread, if configured. Must
+  // be last member, so that running computation is joined before any member
+  // it uses gets destroyed
+  std::unique_ptr<folly::CPUThreadPoolExecutor> routeExecutor_;
 };
 
 } // namespace openr
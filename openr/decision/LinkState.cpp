@@ -9,9 +9,11 @@
 
 #include <algorithm>
 #include <functional>
+#include <numeric>
 #include <utility>
 
 #include <folly/Format.h>
+#include <openr/common/Constants.h>
 #include <openr/common/Util.h>
 
 size_t
@@ -122,6 +124,17 @@ Link::getOtherNodeName(const std::string& nodeName) const {
   throw std::invalid_argument(nodeName);
 }
 
+NodeId
+Link::getOtherNodeId(NodeId nodeId) const {
+  if (id1_ == nodeId) {
+    return id2_;
+  }
+  if (id2_ == nodeId) {
+    return id1_;
+  }
+  throw std::invalid_argument(std::to_string(nodeId));
+}
+
 const std::string&
 Link::firstNodeName() const {
   return orderedNames.first.first;
@@ -154,6 +167,17 @@ Link::getMetricFromNode(const std::string& nodeName) const {
   throw std::invalid_argument(nodeName);
 }
 
+LinkStateMetric
+Link::getMetricFromNodeId(NodeId nodeId) const {
+  if (id1_ == nodeId) {
+    return metric1_.value();
+  }
+  if (id2_ == nodeId) {
+    return metric2_.value();
+  }
+  throw std::invalid_argument(std::to_string(nodeId));
+}
+
 int32_t
 Link::getAdjLabelFromNode(const std::string& nodeName) const {
   if (n1_ == nodeName) {
@@ -343,19 +367,123 @@ LinkState::LinkPtrEqual::operator()(
   return *lhs == *rhs;
 }
 
+namespace {
+
+// insert link at its position in the ordered set. Returns false if an equal
+// link is present already
+bool
+insertOrderedLink(
+    LinkState::OrderedLinkSet& links, const std::shared_ptr<Link>& link) {
+  auto it = std::lower_bound(
+      links.begin(), links.end(), link, LinkState::LinkPtrLess{});
+  if (it != links.end() and **it == *link) {
+    return false;
+  }
+  links.insert(it, link);
+  return true;
+}
+
+// erase link from the ordered set. Returns false if it wasn't present
+bool
+eraseOrderedLink(
+    LinkState::OrderedLinkSet& links, const std::shared_ptr<Link>& link) {
+  auto it = std::lower_bound(
+      links.begin(), links.end(), link, LinkState::LinkPtrLess{});
+  if (it == links.end() or not(**it == *link)) {
+    return false;
+  }
+  links.erase(it);
+  return true;
+}
+
+} // namespace
+
+NodeId
+LinkState::getOrCreateNodeId(const std::string& nodeName) {
+  auto it = nodeIds_.emplace(nodeName, nodeNames_.size());
+  if (it.second) {
+    nodeNames_.emplace_back(nodeName);
+    nodeIdToLinks_.emplace_back(nullptr);
+    nodeOverloads_.emplace_back(std::nullopt);
+  }
+  return it.first->second;
+}
+
+std::optional<NodeId>
+LinkState::getNodeId(const std::string& nodeName) const {
+  auto search = nodeIds_.find(nodeName);
+  if (search != nodeIds_.end()) {
+    return search->second;
+  }
+  return std::nullopt;
+}
+
+const std::string&
+LinkState::getNodeName(NodeId nodeId) const {
+  return nodeNames_.at(nodeId);
+}
+
+void
+LinkState::recordTopologyChange(const Link& link) {
+  ++topologyVersion_;
+  topologyChangeLog_.emplace_back(
+      topologyVersion_,
+      std::make_pair(link.firstNodeName(), link.secondNodeName()));
+  if (topologyChangeLog_.size() > Constants::kMaxTopologyChangeLogSize) {
+    topologyChangeLog_.pop_front();
+  }
+}
+
+void
+LinkState::recordTopologyChange(const std::string& nodeName) {
+  for (auto const& link : linksFromNode(nodeName)) {
+    recordTopologyChange(*link);
+  }
+}
+
+std::optional<std::unordered_set<LinkState::NodePair>>
+LinkState::getTopologyChangesSince(uint64_t version) const {
+  std::unordered_set<NodePair> changes;
+  if (version >= topologyVersion_) {
+    return changes;
+  }
+  if (topologyChangeLog_.empty() or
+      topologyChangeLog_.front().first > version + 1) {
+    // some of the changes have been trimmed from the log
+    return std::nullopt;
+  }
+  for (auto it = topologyChangeLog_.rbegin();
+       it != topologyChangeLog_.rend() and it->first > version;
+       ++it) {
+    changes.insert(it->second);
+  }
+  return changes;
+}
+
 void
 LinkState::addLink(std::shared_ptr<Link> link) {
-  CHECK(linkMap_[link->firstNodeName()].insert(link).second);
-  CHECK(linkMap_[link->secondNodeName()].insert(link).second);
+  link->id1_ = getOrCreateNodeId(link->n1_);
+  link->id2_ = getOrCreateNodeId(link->n2_);
+  for (auto const id : {link->id1_, link->id2_}) {
+    auto& linkSet = linkMap_[nodeNames_[id]];
+    CHECK(insertOrderedLink(linkSet, link));
+    nodeIdToLinks_[id] = &linkSet;
+  }
   CHECK(allLinks_.insert(link).second);
+  if (link->hasHolds()) {
+    linksWithHolds_.insert(link);
+  }
+  recordTopologyChange(*link);
 }
 
 // throws std::out_of_range if links are not present
 void
 LinkState::removeLink(std::shared_ptr<Link> link) {
-  CHECK(linkMap_.at(link->firstNodeName()).erase(link));
-  CHECK(linkMap_.at(link->secondNodeName()).erase(link));
+  CHECK(eraseOrderedLink(linkMap_.at(link->firstNodeName()), link));
+  CHECK(eraseOrderedLink(linkMap_.at(link->secondNodeName()), link));
   CHECK(allLinks_.erase(link));
+  linksWithHolds_.erase(link);
+  recordTopologyChange(*link);
 }
 
 void
@@ -368,20 +496,26 @@ LinkState::removeNode(const std::string& nodeName) {
 
   // erase ptrs to these links from other nodes
   for (auto const& link : search->second) {
+    recordTopologyChange(*link);
     try {
-      CHECK(linkMap_.at(link->getOtherNodeName(nodeName)).erase(link));
+      CHECK(eraseOrderedLink(
+          linkMap_.at(link->getOtherNodeName(nodeName)), link));
       CHECK(allLinks_.erase(link));
+      linksWithHolds_.erase(link);
     } catch (std::out_of_range const& e) {
       LOG(FATAL) << "std::out_of_range for " << nodeName;
     }
   }
   linkMap_.erase(search);
-  nodeOverloads_.erase(nodeName);
+  auto const nodeId = nodeIds_.at(nodeName);
+  nodeIdToLinks_[nodeId] = nullptr;
+  nodeOverloads_[nodeId].reset();
+  nodesWithHolds_.erase(nodeId);
 }
 
-const LinkState::LinkSet&
+const LinkState::OrderedLinkSet&
 LinkState::linksFromNode(const std::string& nodeName) const {
-  static const LinkState::LinkSet defaultEmptySet;
+  static const LinkState::OrderedLinkSet defaultEmptySet;
   auto search = linkMap_.find(nodeName);
   if (search != linkMap_.end()) {
     return search->second;
@@ -389,17 +523,81 @@ LinkState::linksFromNode(const std::string& nodeName) const {
   return defaultEmptySet;
 }
 
-std::vector<std::shared_ptr<Link>>
-LinkState::orderedLinksFromNode(const std::string& nodeName) {
-  std::vector<std::shared_ptr<Link>> links;
-  if (linkMap_.count(nodeName)) {
-    links.insert(
-        links.begin(),
-        linkMap_.at(nodeName).begin(),
-        linkMap_.at(nodeName).end());
-    std::sort(links.begin(), links.end(), LinkPtrLess{});
+const LinkState::OrderedLinkSet&
+LinkState::linksFromNodeId(NodeId nodeId) const {
+  static const LinkState::OrderedLinkSet defaultEmptySet;
+  auto const linkSet = nodeIdToLinks_.at(nodeId);
+  return linkSet ? *linkSet : defaultEmptySet;
+}
+
+folly::Range<const LinkState::AdjacencySnapshot::Edge*>
+LinkState::AdjacencySnapshot::edgesFromNodeId(NodeId nodeId) const {
+  // nodes which got an id after the snapshot was built have no up links
+  if (nodeId + 1 >= offsets.size()) {
+    return {};
   }
-  return links;
+  return {edges.data() + offsets[nodeId], edges.data() + offsets[nodeId + 1]};
+}
+
+bool
+LinkState::AdjacencySnapshot::isNodeIdOverloaded(NodeId nodeId) const {
+  return nodeId < overloaded.size() && overloaded[nodeId];
+}
+
+const LinkState::AdjacencySnapshot&
+LinkState::getAdjacencySnapshot() const {
+  std::lock_guard<std::mutex> lock(adjacencySnapshotLock_);
+  if (adjacencySnapshotVersion_ != topologyVersion_) {
+    buildAdjacencySnapshot();
+    adjacencySnapshotVersion_ = topologyVersion_;
+  }
+  return adjacencySnapshot_;
+}
+
+void
+LinkState::buildAdjacencySnapshot() const {
+  auto& snapshot = adjacencySnapshot_;
+  const auto numNodeIds = getNodeIdCount();
+  snapshot.offsets.assign(numNodeIds + 1, 0);
+  snapshot.edges.clear();
+  snapshot.links.clear();
+  snapshot.overloaded.assign(numNodeIds, false);
+
+  // count edges of each node, then place them at their node's offset
+  for (auto const& link : allLinks_) {
+    if (link->isUp()) {
+      ++snapshot.offsets[link->id1_ + 1];
+      ++snapshot.offsets[link->id2_ + 1];
+    }
+  }
+  std::partial_sum(
+      snapshot.offsets.begin(),
+      snapshot.offsets.end(),
+      snapshot.offsets.begin());
+  snapshot.edges.resize(snapshot.offsets.back());
+  snapshot.links.reserve(snapshot.offsets.back() / 2);
+  std::vector<uint32_t> nextEdge(
+      snapshot.offsets.begin(), snapshot.offsets.end() - 1);
+  for (auto const& link : allLinks_) {
+    if (not link->isUp()) {
+      continue;
+    }
+    const uint32_t linkIndex = snapshot.links.size();
+    snapshot.links.emplace_back(link);
+    snapshot.edges[nextEdge[link->id1_]++] = {
+        link->id2_, link->getMetricFromNodeId(link->id1_), linkIndex};
+    snapshot.edges[nextEdge[link->id2_]++] = {
+        link->id1_, link->getMetricFromNodeId(link->id2_), linkIndex};
+  }
+
+  for (NodeId id = 0; id < numNodeIds; ++id) {
+    snapshot.overloaded[id] = isNodeIdOverloaded(id);
+  }
+}
+
+const LinkState::OrderedLinkSet&
+LinkState::orderedLinksFromNode(const std::string& nodeName) const {
+  return linksFromNode(nodeName);
 }
 
 bool
@@ -408,45 +606,69 @@ LinkState::updateNodeOverloaded(
     bool isOverloaded,
     LinkStateMetric holdUpTtl,
     LinkStateMetric holdDownTtl) {
-  if (nodeOverloads_.count(nodeName)) {
-    return nodeOverloads_.at(nodeName).updateValue(
-        isOverloaded, holdUpTtl, holdDownTtl);
+  const auto nodeId = getOrCreateNodeId(nodeName);
+  auto& maybeOverload = nodeOverloads_.at(nodeId);
+  if (maybeOverload.has_value()) {
+    auto& overload = maybeOverload.value();
+    const bool wasOverloaded = overload.value();
+    const bool changed =
+        overload.updateValue(isOverloaded, holdUpTtl, holdDownTtl);
+    if (overload.hasHold()) {
+      nodesWithHolds_.insert(nodeId);
+    }
+    if (wasOverloaded != overload.value()) {
+      recordTopologyChange(nodeName);
+    }
+    return changed;
+  }
+  maybeOverload.emplace(isOverloaded);
+  if (isOverloaded) {
+    // no-op for a node whose links are yet to be added
+    recordTopologyChange(nodeName);
   }
-  nodeOverloads_.emplace(nodeName, HoldableValue<bool>{isOverloaded});
   // don't indicate LinkState changed if this is a new node
   return false;
 }
 
 bool
 LinkState::isNodeOverloaded(const std::string& nodeName) const {
-  return nodeOverloads_.count(nodeName) && nodeOverloads_.at(nodeName).value();
+  auto search = nodeIds_.find(nodeName);
+  return search != nodeIds_.end() && isNodeIdOverloaded(search->second);
+}
+
+bool
+LinkState::isNodeIdOverloaded(NodeId nodeId) const {
+  auto const& overload = nodeOverloads_.at(nodeId);
+  return overload.has_value() && overload->value();
 }
 
 bool
 LinkState::decrementHolds() {
   bool holdChange = false;
-  for (auto& link : allLinks_) {
-    holdChange |= link->decrementHolds();
+  for (auto it = linksWithHolds_.begin(); it != linksWithHolds_.end();) {
+    auto const& link = *it;
+    if (link->decrementHolds()) {
+      recordTopologyChange(*link);
+      holdChange = true;
+    }
+    it = link->hasHolds() ? std::next(it) : linksWithHolds_.erase(it);
   }
-  for (auto& kv : nodeOverloads_) {
-    holdChange |= kv.second.decrementTtl();
+  for (auto it = nodesWithHolds_.begin(); it != nodesWithHolds_.end();) {
+    auto& overload = nodeOverloads_.at(*it);
+    if (overload.has_value() && overload->decrementTtl()) {
+      recordTopologyChange(nodeNames_[*it]);
+      holdChange = true;
+    }
+    it = overload.has_value() && overload->hasHold()
+        ? std::next(it)
+        : nodesWithHolds_.erase(it);
   }
   return holdChange;
 }
 
 bool
 LinkState::hasHolds() const {
-  for (auto& link : allLinks_) {
-    if (link->hasHolds()) {
-      return true;
-    }
-  }
-  for (auto& kv : nodeOverloads_) {
-    if (kv.second.hasHold()) {
-      return true;
-    }
-  }
-  return false;
+  return not linksWithHolds_.empty() or not nodesWithHolds_.empty();
 }
 
 std::shared_ptr<Link>
@@ -467,17 +689,56 @@ LinkState::maybeMakeLink(
   return nullptr;
 }
 
-std::vector<std::shared_ptr<Link>>
-LinkState::getOrderedLinkSet(const thrift::AdjacencyDatabase& adjDb) const {
-  std::vector<std::shared_ptr<Link>> links;
-  links.reserve(adjDb.adjacencies.size());
+std::unordered_set<LinkState::AdjacencyKey>
+LinkState::getChangedAdjacencies(
+    const thrift::AdjacencyDatabase& oldAdjDb,
+    const thrift::AdjacencyDatabase& newAdjDb) {
+  std::unordered_set<AdjacencyKey> changedKeys;
+  // old adjacencies not matched by a new one yet
+  std::unordered_map<AdjacencyKey, const thrift::Adjacency*> oldAdjs;
+  oldAdjs.reserve(oldAdjDb.adjacencies.size());
+  for (const auto& adj : oldAdjDb.adjacencies) {
+    AdjacencyKey key(adj.otherNodeName, adj.ifName);
+    if (not oldAdjs.emplace(key, &adj).second) {
+      changedKeys.emplace(std::move(key));
+    }
+  }
+  for (const auto& adj : newAdjDb.adjacencies) {
+    AdjacencyKey key(adj.otherNodeName, adj.ifName);
+    auto search = oldAdjs.find(key);
+    // both ends of a link to self are in this database, always look at them
+    if (search == oldAdjs.end() or adj.otherNodeName == newAdjDb.thisNodeName) {
+      changedKeys.emplace(std::move(key));
+      continue;
+    }
+    if (nullptr == search->second or not(*search->second == adj)) {
+      changedKeys.emplace(key);
+    }
+    search->second = nullptr;
+  }
+  for (const auto& kv : oldAdjs) {
+    if (nullptr != kv.second) {
+      changedKeys.emplace(kv.first);
+    }
+  }
+  return changedKeys;
+}
+
+LinkState::OrderedLinkSet
+LinkState::getOrderedLinkSet(
+    const thrift::AdjacencyDatabase& adjDb,
+    const std::unordered_set<AdjacencyKey>& adjKeys) const {
+  OrderedLinkSet links;
+  links.reserve(adjKeys.size());
   for (const auto& adj : adjDb.adjacencies) {
+    if (not adjKeys.count(AdjacencyKey(adj.otherNodeName, adj.ifName))) {
+      continue;
+    }
     auto linkPtr = maybeMakeLink(adjDb.thisNodeName, adj);
     if (nullptr != linkPtr) {
       links.emplace_back(linkPtr);
     }
   }
-  links.shrink_to_fit();
   std::sort(links.begin(), links.end(), LinkState::LinkPtrLess{});
   return links;
 }
@@ -505,11 +766,26 @@ LinkState::updateAdjacencyDatabase(
   // replace
   adjacencyDatabases_[nodeName] = newAdjacencyDb;
 
+  // links of unchanged adjacencies stay as they are, as the reverse
+  // adjacencies they depend on are not touched by this update either. Only
+  // links of added, removed or changed adjacencies are looked at below
+  auto const changedAdjs =
+      getChangedAdjacencies(priorAdjacencyDb, newAdjacencyDb);
+
   // for comparing old and new state, we order the links based on the tuple
   // <nodeName1, iface1, nodeName2, iface2>, this allows us to easily discern
-  // topology changes in the single loop below
-  auto oldLinks = orderedLinksFromNode(nodeName);
-  auto newLinks = getOrderedLinkSet(newAdjacencyDb);
+  // topology changes in the single loop below. Old links are copied as the
+  // loop adds and removes links of this node
+  OrderedLinkSet oldLinks;
+  for (auto const& link : orderedLinksFromNode(nodeName)) {
+    auto const& otherNodeName = link->getOtherNodeName(nodeName);
+    if (otherNodeName == nodeName or
+        changedAdjs.count(AdjacencyKey(
+            otherNodeName, link->getIfaceFromNode(nodeName)))) {
+      oldLinks.emplace_back(link);
+    }
+  }
+  auto newLinks = getOrderedLinkSet(newAdjacencyDb, changedAdjs);
 
   // fill these sets with the appropriate links
   std::unordered_set<Link> linksUp;
@@ -570,6 +846,7 @@ LinkState::updateAdjacencyDatabase(
           newLink.getMetricFromNode(nodeName),
           holdUpTtl,
           holdDownTtl);
+      recordTopologyChange(oldLink);
     }
 
     if (newLink.getOverloadFromNode(nodeName) !=
@@ -584,6 +861,7 @@ LinkState::updateAdjacencyDatabase(
           newLink.getOverloadFromNode(nodeName),
           holdUpTtl,
           holdDownTtl);
+      recordTopologyChange(oldLink);
     }
 
     // Check if adjacency label has changed
@@ -626,6 +904,9 @@ LinkState::updateAdjacencyDatabase(
       routeAttrChanged |= true;
       oldLink.setNhV6FromNode(nodeName, newLink.getNhV6FromNode(nodeName));
     }
+    if (oldLink.hasHolds()) {
+      linksWithHolds_.insert(*oldIter);
+    }
     ++newIter;
     ++oldIter;
   }
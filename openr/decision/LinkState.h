@@ -7,12 +7,18 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include <folly/Range.h>
+#include <folly/hash/Hash.h>
+
 #include <openr/if/gen-cpp2/Lsdb_types.h>
 #include <openr/if/gen-cpp2/Network_types.h>
 
@@ -20,6 +26,11 @@ namespace openr {
 
 using LinkStateMetric = uint64_t;
 
+// Dense integer identifier of a node in LinkState. IDs are handed out on first
+// sight of a node name and are never reused, which lets SPF keep its per-node
+// state in flat vectors instead of maps keyed by node name
+using NodeId = uint32_t;
+
 // HoldableValue is the basic building block for ordered FIB programming
 // (rfc 6976)
 //
@@ -82,7 +93,11 @@ class Link {
       const openr::thrift::Adjacency& adj2);
 
  private:
+  // LinkState assigns node ids when the link is added to it
+  friend class LinkState;
+
   const std::string n1_, n2_, if1_, if2_;
+  NodeId id1_{0}, id2_{0};
   HoldableValue<LinkStateMetric> metric1_{1}, metric2_{1};
   HoldableValue<bool> overload1_{false}, overload2_{false};
   int32_t adjLabel1_{0}, adjLabel2_{0};
@@ -107,6 +122,11 @@ class Link {
 
   const std::string& getOtherNodeName(const std::string& nodeName) const;
 
+  // id based accessors, only valid once the link is added to LinkState
+  NodeId getOtherNodeId(NodeId nodeId) const;
+
+  LinkStateMetric getMetricFromNodeId(NodeId nodeId) const;
+
   const std::string& firstNodeName() const;
 
   const std::string& secondNodeName() const;
@@ -175,6 +195,34 @@ class LinkState {
   using LinkSet =
       std::unordered_set<std::shared_ptr<Link>, LinkPtrHash, LinkPtrEqual>;
 
+  // links kept sorted by LinkPtrLess
+  using OrderedLinkSet = std::vector<std::shared_ptr<Link>>;
+
+  // ordered pair of node names at the two ends of one or more links
+  using NodePair = std::pair<std::string, std::string>;
+
+  // Compact view of all up links for SPF in compressed sparse row layout:
+  // edges leaving node id n are edges[offsets[n], offsets[n + 1]). Keeps the
+  // edge relaxation loop on contiguous memory instead of chasing Link ptrs
+  struct AdjacencySnapshot {
+    struct Edge {
+      NodeId neighborId{0};
+      // metric of the link in the direction towards neighborId
+      LinkStateMetric metric{1};
+      // index of the link in links
+      uint32_t linkIndex{0};
+    };
+
+    folly::Range<const Edge*> edgesFromNodeId(NodeId nodeId) const;
+
+    bool isNodeIdOverloaded(NodeId nodeId) const;
+
+    std::vector<uint32_t> offsets;
+    std::vector<Edge> edges;
+    std::vector<std::shared_ptr<Link>> links;
+    std::vector<bool> overloaded;
+  };
+
   void addLink(std::shared_ptr<Link> link);
 
   void removeLink(std::shared_ptr<Link> link);
@@ -186,10 +234,29 @@ class LinkState {
     return 0 != adjacencyDatabases_.count(nodeName);
   }
 
-  const LinkSet& linksFromNode(const std::string& nodeName) const;
+  // links of the node, ordered by LinkPtrLess. The containers are maintained
+  // as links are added and removed, so walking them never allocates
+  const OrderedLinkSet& linksFromNode(const std::string& nodeName) const;
+
+  const OrderedLinkSet& linksFromNodeId(NodeId nodeId) const;
+
+  // NodeId of a node known to LinkState
+  std::optional<NodeId> getNodeId(const std::string& nodeName) const;
 
-  std::vector<std::shared_ptr<Link>> orderedLinksFromNode(
-      const std::string& nodeName);
+  const std::string& getNodeName(NodeId nodeId) const;
+
+  // number of node ids handed out so far. All ids are less than this
+  size_t
+  getNodeIdCount() const {
+    return nodeNames_.size();
+  }
+
+  const OrderedLinkSet& orderedLinksFromNode(
+      const std::string& nodeName) const;
+
+  // adjacency snapshot of the current topology, rebuilt on first use after
+  // the topology version has changed. Safe to call from concurrent readers
+  const AdjacencySnapshot& getAdjacencySnapshot() const;
 
   bool updateNodeOverloaded(
       const std::string& nodeName,
@@ -199,6 +266,8 @@ class LinkState {
 
   bool isNodeOverloaded(const std::string& nodeName) const;
 
+  bool isNodeIdOverloaded(NodeId nodeId) const;
+
   bool decrementHolds();
 
   bool hasHolds() const;
@@ -234,28 +303,89 @@ class LinkState {
     return adjacencyDatabases_;
   }
 
+  // Topology version is bumped on every change that may alter shortest paths
+  // (link up/down, metric or overload change, hold expiry). Users of SPF
+  // results remember the version their result was computed at and can ask for
+  // the links changed since then to update the result incrementally.
+  uint64_t
+  getTopologyVersion() const {
+    return topologyVersion_;
+  }
+
+  // get the end points of all links changed after the given version. Returns
+  // std::nullopt if the change log doesn't go back that far, in which case a
+  // full SPF run is required
+  std::optional<std::unordered_set<NodePair>> getTopologyChangesSince(
+      uint64_t version) const;
+
  private:
+  // intern node name
+  NodeId getOrCreateNodeId(const std::string& nodeName);
+
+  // record change of link(s) between the given nodes
+  void recordTopologyChange(const Link& link);
+
+  // record change of every link of the given node
+  void recordTopologyChange(const std::string& nodeName);
+
+  void buildAdjacencySnapshot() const;
+
   // returns Link object if the reverse adjancency is present in
   // adjacencyDatabases_.at(adj.otherNodeName), else returns nullptr
   std::shared_ptr<Link> maybeMakeLink(
       const std::string& nodeName, const thrift::Adjacency& adj) const;
 
-  std::vector<std::shared_ptr<Link>> getOrderedLinkSet(
-      const thrift::AdjacencyDatabase& adjDb) const;
+  // adjacencies of a node are identified by the neighbor and local interface
+  using AdjacencyKey =
+      std::pair<std::string /* otherNodeName */, std::string /* ifName */>;
+
+  // keys of adjacencies added, removed or changed between the two databases.
+  // Keys appearing more than once in a database are always reported
+  static std::unordered_set<AdjacencyKey> getChangedAdjacencies(
+      const thrift::AdjacencyDatabase& oldAdjDb,
+      const thrift::AdjacencyDatabase& newAdjDb);
+
+  // links of the given adjacencies of adjDb, ordered by LinkPtrLess
+  OrderedLinkSet getOrderedLinkSet(
+      const thrift::AdjacencyDatabase& adjDb,
+      const std::unordered_set<AdjacencyKey>& adjKeys) const;
+
+  // node name interning table
+  std::unordered_map<std::string /* nodeName */, NodeId> nodeIds_;
+  std::vector<std::string> nodeNames_;
 
   // this stores the same link object accessible from either nodeName
-  std::unordered_map<std::string /* nodeName */, LinkSet> linkMap_;
+  std::unordered_map<std::string /* nodeName */, OrderedLinkSet> linkMap_;
+
+  // id indexed view of linkMap_. Elements of an unordered_map are never
+  // relocated, so the pointers stay valid until the entry is erased
+  std::vector<const OrderedLinkSet*> nodeIdToLinks_;
 
   // useful for iterating over all the links
   LinkSet allLinks_;
 
-  std::unordered_map<std::string /* nodeName */, HoldableValue<bool>>
-      nodeOverloads_;
+  // links and nodes with a pending hold, only these need to be visited on
+  // every hold decrement. May contain ones whose hold got cancelled by an
+  // update meanwhile, they are pruned on next decrement
+  LinkSet linksWithHolds_;
+  std::unordered_set<NodeId> nodesWithHolds_;
+
+  // indexed by NodeId, empty for nodes not advertising overload state
+  std::vector<std::optional<HoldableValue<bool>>> nodeOverloads_;
 
   // the latest AdjacencyDatabase we've received from each node
   std::unordered_map<std::string, thrift::AdjacencyDatabase>
       adjacencyDatabases_;
 
+  // bounded log of <topologyVersion, changed link end points>
+  uint64_t topologyVersion_{0};
+  std::deque<std::pair<uint64_t, NodePair>> topologyChangeLog_;
+
+  // lazily built by getAdjacencySnapshot()
+  mutable std::mutex adjacencySnapshotLock_;
+  mutable AdjacencySnapshot adjacencySnapshot_;
+  mutable std::optional<uint64_t> adjacencySnapshotVersion_;
+
 }; // class LinkState
 } // namespace openr
 
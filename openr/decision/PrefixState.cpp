@@ -7,6 +7,8 @@
 
 #include "openr/decision/PrefixState.h"
 
+#include <algorithm>
+
 #include <openr/common/Util.h>
 
 namespace openr {
@@ -31,40 +33,48 @@ PrefixState::deleteLoopbackPrefix(
   }
 }
 
-bool
+std::unordered_set<thrift::IpPrefix>
 PrefixState::updatePrefixDatabase(thrift::PrefixDatabase const& prefixDb) {
   auto const& nodeName = prefixDb.thisNodeName;
 
-  // Get old and new set of prefixes - NOTE explicit copy
-  const std::set<thrift::IpPrefix> oldPrefixSet = nodeToPrefixes_[nodeName];
-
-  // update the entry
+  // Get old and new set of prefixes. Old set is left with prefixes withdrawn
+  // by this node once new set is built
+  auto oldPrefixSet = std::move(nodeToPrefixes_[nodeName]);
   auto& newPrefixSet = nodeToPrefixes_[nodeName];
   newPrefixSet.clear();
-  for (const auto& prefixEntry : prefixDb.prefixEntries) {
-    newPrefixSet.emplace(prefixEntry.prefix);
-  }
 
-  // Boolean to indicate update in prefix entry
-  bool isUpdated{false};
+  // Prefixes which are withdrawn, advertised or updated by this node
+  std::unordered_set<thrift::IpPrefix> changedPrefixes;
 
-  // Remove old prefixes first
-  for (const auto& prefix : oldPrefixSet) {
-    if (newPrefixSet.count(prefix)) {
-      continue;
-    }
-    VLOG(1) << "Prefix " << toString(prefix) << " has been withdrawn by "
-            << nodeName;
-    auto& nodeList = prefixes_.at(prefix);
-    nodeList.erase(nodeName);
-    isUpdated = true;
-    if (nodeList.empty()) {
-      prefixes_.erase(prefix);
+  // Take prefixes up to limit, or none, from a node over limit. Every node of
+  // the area receives the same prefix database, hence ignores same prefixes
+  size_t numPrefixEntries = prefixDb.prefixEntries.size();
+  numIgnoredPrefixes_ = 0;
+  if (maxPrefixesPerNode_ and numPrefixEntries > *maxPrefixesPerNode_) {
+    const size_t numAccepted =
+        prefixLimitAction_ == thrift::PrefixLimitAction::IGNORE_EXCESS
+        ? *maxPrefixesPerNode_
+        : 0;
+    if (nodesOverPrefixLimit_.emplace(nodeName).second) {
+      LOG(WARNING) << "Node " << nodeName << " advertises " << numPrefixEntries
+                   << " prefixes, over limit of " << *maxPrefixesPerNode_
+                   << ". Ignoring " << numPrefixEntries - numAccepted
+                   << " of them";
     }
-    deleteLoopbackPrefix(prefix, nodeName);
+    numIgnoredPrefixes_ = numPrefixEntries - numAccepted;
+    numPrefixEntries = numAccepted;
+  } else if (nodesOverPrefixLimit_.erase(nodeName)) {
+    LOG(INFO) << "Node " << nodeName << " is back under prefix limit";
   }
-  for (const auto& prefixEntry : prefixDb.prefixEntries) {
-    auto& nodeList = prefixes_[prefixEntry.prefix];
+
+  // Add or update new prefixes first, so that node's prefix set can refer to
+  // keys of prefixes_
+  for (size_t i = 0; i < numPrefixEntries; ++i) {
+    auto const& prefixEntry = prefixDb.prefixEntries.at(i);
+    auto prefixIt = prefixes_.try_emplace(prefixEntry.prefix).first;
+    newPrefixSet.emplace(&prefixIt->first);
+    oldPrefixSet.erase(&prefixIt->first);
+    auto& nodeList = prefixIt->second;
     auto nodePrefixIt = nodeList.find(nodeName);
 
     // Add or Update prefix
@@ -72,12 +82,12 @@ PrefixState::updatePrefixDatabase(thrift::PrefixDatabase const& prefixDb) {
       VLOG(1) << "Prefix " << toString(prefixEntry.prefix)
               << " has been advertised by node " << nodeName;
       nodeList.emplace(nodeName, prefixEntry);
-      isUpdated = true;
+      changedPrefixes.emplace(prefixEntry.prefix);
     } else if (nodePrefixIt->second != prefixEntry) {
       VLOG(1) << "Prefix " << toString(prefixEntry.prefix)
               << " has been updated by node " << nodeName;
-      nodeList[nodeName] = prefixEntry;
-      isUpdated = true;
+      nodePrefixIt->second = prefixEntry;
+      changedPrefixes.emplace(prefixEntry.prefix);
     } else {
       // This prefix has no change. Skip rest of code!
       continue;
@@ -97,11 +107,25 @@ PrefixState::updatePrefixDatabase(thrift::PrefixDatabase const& prefixDb) {
     }
   }
 
+  // Remove withdrawn prefixes. NOTE explicit copy, as key may be erased
+  for (const auto* oldPrefix : oldPrefixSet) {
+    const thrift::IpPrefix prefix = *oldPrefix;
+    VLOG(1) << "Prefix " << toString(prefix) << " has been withdrawn by "
+            << nodeName;
+    auto& nodeList = prefixes_.at(prefix);
+    nodeList.erase(nodeName);
+    changedPrefixes.emplace(prefix);
+    if (nodeList.empty()) {
+      prefixes_.erase(prefix);
+    }
+    deleteLoopbackPrefix(prefix, nodeName);
+  }
+
   if (newPrefixSet.empty()) {
     nodeToPrefixes_.erase(nodeName);
   }
 
-  return isUpdated;
+  return changedPrefixes;
 }
 
 std::unordered_map<std::string /* nodeName */, thrift::PrefixDatabase>
@@ -110,9 +134,17 @@ PrefixState::getPrefixDatabases() const {
   for (auto const& kv : nodeToPrefixes_) {
     thrift::PrefixDatabase prefixDb;
     prefixDb.thisNodeName = kv.first;
-    for (auto const& prefix : kv.second) {
-      prefixDb.prefixEntries.emplace_back(prefixes_.at(prefix).at(kv.first));
+    prefixDb.prefixEntries.reserve(kv.second.size());
+    for (auto const* prefix : kv.second) {
+      prefixDb.prefixEntries.emplace_back(prefixes_.at(*prefix).at(kv.first));
     }
+    // keep entries ordered by prefix
+    std::sort(
+        prefixDb.prefixEntries.begin(),
+        prefixDb.prefixEntries.end(),
+        [](thrift::PrefixEntry const& lhs, thrift::PrefixEntry const& rhs) {
+          return lhs.prefix < rhs.prefix;
+        });
     prefixDatabases.emplace(kv.first, std::move(prefixDb));
   }
   return prefixDatabases;
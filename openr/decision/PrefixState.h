@@ -7,17 +7,33 @@
 
 #pragma once
 
+#include <optional>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <openr/common/NetworkUtil.h>
 #include <openr/if/gen-cpp2/Lsdb_types.h>
 #include <openr/if/gen-cpp2/Network_types.h>
+#include <openr/if/gen-cpp2/OpenrConfig_types.h>
 
 namespace openr {
 class PrefixState {
  public:
+  // prefixes taken from a single node are limited to maxPrefixesPerNode, if
+  // set, and prefix databases over limit are handled as per prefixLimitAction
+  explicit PrefixState(
+      std::optional<size_t> maxPrefixesPerNode = std::nullopt,
+      thrift::PrefixLimitAction prefixLimitAction =
+          thrift::PrefixLimitAction::IGNORE_EXCESS)
+      : maxPrefixesPerNode_(maxPrefixesPerNode),
+        prefixLimitAction_(prefixLimitAction) {}
+
+  // non-copyable, nodeToPrefixes_ refers to keys of prefixes_
+  PrefixState(PrefixState const&) = delete;
+  PrefixState& operator=(PrefixState const&) = delete;
+
   std::unordered_map<
       thrift::IpPrefix,
       std::unordered_map<std::string, thrift::PrefixEntry>> const&
@@ -29,8 +45,10 @@ class PrefixState {
   void deleteLoopbackPrefix(
       thrift::IpPrefix const& prefix, const std::string& nodename);
 
-  // returns true if the prefixDb changed
-  bool updatePrefixDatabase(thrift::PrefixDatabase const& prefixDb);
+  // returns the set of prefixes which have been withdrawn, advertised or
+  // updated by the node. Empty if the prefixDb didn't change
+  std::unordered_set<thrift::IpPrefix> updatePrefixDatabase(
+      thrift::PrefixDatabase const& prefixDb);
 
   std::unordered_map<std::string /* nodeName */, thrift::PrefixDatabase>
   getPrefixDatabases() const;
@@ -50,15 +68,36 @@ class PrefixState {
     return nodeHostLoopbacksV6_;
   }
 
+  // nodes whose last prefix database was over maxPrefixesPerNode
+  std::unordered_set<std::string> const&
+  getNodesOverPrefixLimit() const {
+    return nodesOverPrefixLimit_;
+  }
+
+  // prefixes ignored from the last prefix database, for being over limit
+  size_t
+  getNumIgnoredPrefixes() const {
+    return numIgnoredPrefixes_;
+  }
+
  private:
+  const std::optional<size_t> maxPrefixesPerNode_;
+  const thrift::PrefixLimitAction prefixLimitAction_{
+      thrift::PrefixLimitAction::IGNORE_EXCESS};
+
   // For each prefix in the network, stores a set of nodes that advertise it
   std::unordered_map<
       thrift::IpPrefix,
       std::unordered_map<std::string, thrift::PrefixEntry>>
       prefixes_;
-  std::unordered_map<std::string, std::set<thrift::IpPrefix>> nodeToPrefixes_;
+  // prefixes advertised by every node, referring to keys of prefixes_ rather
+  // than holding another copy of every prefix
+  std::unordered_map<std::string, std::unordered_set<thrift::IpPrefix const*>>
+      nodeToPrefixes_;
   std::unordered_map<std::string, thrift::BinaryAddress> nodeHostLoopbacksV4_;
   std::unordered_map<std::string, thrift::BinaryAddress> nodeHostLoopbacksV6_;
+  std::unordered_set<std::string> nodesOverPrefixLimit_;
+  size_t numIgnoredPrefixes_{0};
 }; // class PrefixState
 
 } // namespace openr
@@ -5,45 +5,44 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <sys/resource.h>
+
 #include <folly/Benchmark.h>
+#include <folly/FileUtil.h>
 #include <folly/IPAddress.h>
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
 #include <folly/Random.h>
 #include <folly/futures/Promise.h>
 #include <folly/init/Init.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+#include <gflags/gflags.h>
+#include <atomic>
+#include <cstdlib>
 #include <memory>
+#include <new>
 
 #include <openr/common/Constants.h>
 #include <openr/common/Util.h>
+#include <openr/common/tests/BenchmarkUtils.h>
 #include <openr/config/tests/Utils.h>
 #include <openr/decision/Decision.h>
 #include <openr/tests/OpenrThriftServerWrapper.h>
 #include <thrift/lib/cpp2/Thrift.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
-/**
- * Defines a benchmark that allows users to record customized counter during
- * benchmarking and passes a parameter to another one. This is common for
- * benchmarks that need a "problem size" in addition to "number of iterations".
- */
-#define BENCHMARK_COUNTERS_PARAM(name, counters, param) \
-  BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param, param)
-
-/*
- * Like BENCHMARK_COUNTERS_PARAM(), but allows a custom name to be specified for
- * each parameter, rather than using the parameter value.
- */
-#define BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param_name, ...) \
-  BENCHMARK_IMPL_COUNTERS(                                             \
-      FB_CONCATENATE(name, FB_CONCATENATE(_, param_name)),             \
-      FOLLY_PP_STRINGIZE(name) "(" FOLLY_PP_STRINGIZE(param_name) ")", \
-      counters,                                                        \
-      iters,                                                           \
-      unsigned,                                                        \
-      iters) {                                                         \
-    name(counters, iters, ##__VA_ARGS__);                              \
-  }
+DEFINE_string(
+    decision_replay_file,
+    "",
+    "File with recorded KvStore publications replayed by BM_DecisionReplay. "
+    "Each record is a 4-byte big-endian length followed by a compact "
+    "serialized thrift::Publication. The first record is the initial "
+    "snapshot and every later record must trigger a route computation.");
+DEFINE_string(
+    decision_replay_node,
+    "",
+    "Node name Decision computes routes for while replaying publications");
 
 namespace {
 // We have 24 SSWs per plane as of now and moving towards 36 per plane.
@@ -53,9 +52,34 @@ const int kNumOfRswsPerPod = 48;
 const uint8_t kSswMarker = 1;
 const uint8_t kFswMarker = 2;
 const uint8_t kRswMarker = 3;
+// Node labels are offset to not collide with adjacency labels
+const int32_t kNodeLabelOffset = 500000;
+
+// Number of heap allocations made by the whole process, including the
+// decision thread. Read before and after the measured section.
+std::atomic<uint64_t> gNumOfAllocations{0};
 
 } // namespace
 
+void*
+operator new(std::size_t size) {
+  gNumOfAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void
+operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t /* size */) noexcept {
+  std::free(ptr);
+}
+
 namespace openr {
 
 using apache::thrift::CompactSerializer;
@@ -67,13 +91,14 @@ using apache::thrift::FRAGILE;
 //
 class DecisionWrapper {
  public:
-  explicit DecisionWrapper(const std::string& nodeName) {
+  explicit DecisionWrapper(
+      const std::string& nodeName, bool computeLfaPaths = true) {
     auto tConfig = getBasicOpenrConfig(nodeName);
     config = std::make_shared<Config>(tConfig);
 
     decision = std::make_shared<Decision>(
         config,
-        true, /* computeLfaPaths */
+        computeLfaPaths,
         false, /* bgpDryRun */
         std::chrono::milliseconds(10),
         std::chrono::milliseconds(500),
@@ -117,8 +142,9 @@ class DecisionWrapper {
       int64_t version,
       const std::vector<thrift::Adjacency>& adjs,
       const std::optional<thrift::PerfEvents>& perfEvents,
-      bool overloadBit = false) {
-    auto adjDb = createAdjDb(nodeId, adjs, 0, overloadBit);
+      bool overloadBit = false,
+      int32_t nodeLabel = 0) {
+    auto adjDb = createAdjDb(nodeId, adjs, nodeLabel, overloadBit);
     if (perfEvents.has_value()) {
       fromStdOptional(adjDb.perfEvents_ref(), perfEvents);
     }
@@ -136,17 +162,33 @@ class DecisionWrapper {
   createPrefixValue(
       const std::string& nodeId,
       int64_t version,
-      const std::vector<thrift::IpPrefix>& prefixes) {
+      const std::vector<thrift::IpPrefix>& prefixes,
+      const std::optional<thrift::PerfEvents>& perfEvents = std::nullopt,
+      thrift::PrefixForwardingAlgorithm forwardingAlgorithm =
+          thrift::PrefixForwardingAlgorithm::SP_ECMP) {
+    // KSP2_ED_ECMP is only honoured for SR_MPLS forwarding
+    const auto forwardingType =
+        forwardingAlgorithm == thrift::PrefixForwardingAlgorithm::SP_ECMP
+        ? thrift::PrefixForwardingType::IP
+        : thrift::PrefixForwardingType::SR_MPLS;
     std::vector<thrift::PrefixEntry> prefixEntries;
     for (const auto& prefix : prefixes) {
-      prefixEntries.emplace_back(createPrefixEntry(prefix));
+      prefixEntries.emplace_back(createPrefixEntry(
+          prefix,
+          thrift::PrefixType::LOOPBACK,
+          "",
+          forwardingType,
+          forwardingAlgorithm));
+    }
+    auto prefixDb = createPrefixDb(nodeId, prefixEntries);
+    if (perfEvents.has_value()) {
+      fromStdOptional(prefixDb.perfEvents_ref(), perfEvents);
     }
     return thrift::Value(
         FRAGILE,
         version,
         "originator-1",
-        fbzmq::util::writeThriftObjStr(
-            createPrefixDb(nodeId, prefixEntries), serializer),
+        fbzmq::util::writeThriftObjStr(prefixDb, serializer),
         Constants::kTtlInfinity /* ttl */,
         0 /* ttl version */,
         0 /* hash */);
@@ -187,7 +229,8 @@ class DecisionWrapper {
   fbzmq::Context zeromqContext{};
 
   std::shared_ptr<Config> config;
-  messaging::ReplicateQueue<thrift::Publication> kvStoreUpdatesQueue;
+  messaging::ReplicateQueue<messaging::SharedValue<thrift::Publication>>
+      kvStoreUpdatesQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> routeUpdatesQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue;
   messaging::RQueue<thrift::RouteDatabaseDelta> routeUpdatesQueueReader{
@@ -221,6 +264,12 @@ getId(const uint8_t swMarker, const int podId, const int swId) {
   return swMarker * 100000 + podId * 100 + swId;
 }
 
+// Get a unique node-label, required for KSP2_ED_ECMP routes
+inline int32_t
+getNodeLabel(const uint8_t swMarker, const int podId, const int swId) {
+  return kNodeLabelOffset + getId(swMarker, podId, swId);
+}
+
 // Get a unique node name
 std::string
 getNodeName(const uint8_t swMarker, const int podId, const int swId) {
@@ -241,6 +290,23 @@ accumulatePerfTimes(
   }
 }
 
+// Send publication to decision and receive routes
+void
+sendRecvPublication(
+    const std::shared_ptr<DecisionWrapper>& decisionWrapper,
+    const thrift::Publication& newPub,
+    std::vector<uint64_t>& processTimes) {
+  decisionWrapper->sendKvPublication(newPub);
+
+  // Receive route update from Decision
+  auto routes2 = decisionWrapper->recvMyRouteDb();
+
+  // Extract time from perfevent and accumulate processing time
+  if (routes2.perfEvents_ref().has_value()) {
+    accumulatePerfTimes(routes2.perfEvents_ref().value(), processTimes);
+  }
+}
+
 // Send adjacencies update to decision and receive routes
 void
 sendRecvUpdate(
@@ -249,7 +315,8 @@ sendRecvUpdate(
     const std::string& nodeName,
     const std::vector<thrift::Adjacency>& adjs,
     std::vector<uint64_t>& processTimes,
-    bool overloadBit = false) {
+    bool overloadBit = false,
+    int32_t nodeLabel = 0) {
   // Add perfevent
   thrift::PerfEvents perfEvents;
   addPerfEvent(perfEvents, nodeName, "DECISION_INIT_UPDATE");
@@ -257,18 +324,32 @@ sendRecvUpdate(
   // Add adjs to publication
   newPub.keyVals[folly::sformat("adj:{}", nodeName)] =
       decisionWrapper->createAdjValue(
-          nodeName, 2, adjs, std::move(perfEvents), overloadBit);
+          nodeName, 2, adjs, std::move(perfEvents), overloadBit, nodeLabel);
 
   LOG(INFO) << "Advertising adj update";
-  decisionWrapper->sendKvPublication(newPub);
+  sendRecvPublication(decisionWrapper, newPub, processTimes);
+}
 
-  // Receive route update from Decision
-  auto routes2 = decisionWrapper->recvMyRouteDb();
+// Send prefixes update to decision and receive routes
+void
+sendRecvPrefixUpdate(
+    const std::shared_ptr<DecisionWrapper>& decisionWrapper,
+    thrift::Publication& newPub,
+    const std::string& nodeName,
+    const std::vector<thrift::IpPrefix>& prefixes,
+    const thrift::PrefixForwardingAlgorithm forwardingAlgorithm,
+    std::vector<uint64_t>& processTimes) {
+  // Add perfevent
+  thrift::PerfEvents perfEvents;
+  addPerfEvent(perfEvents, nodeName, "DECISION_INIT_UPDATE");
 
-  // Extract time from perfevent and accumulate processing time
-  if (routes2.perfEvents_ref().has_value()) {
-    accumulatePerfTimes(routes2.perfEvents_ref().value(), processTimes);
-  }
+  // Add prefixes to publication
+  newPub.keyVals[folly::sformat("prefix:{}", nodeName)] =
+      decisionWrapper->createPrefixValue(
+          nodeName, 2, prefixes, std::move(perfEvents), forwardingAlgorithm);
+
+  LOG(INFO) << "Advertising prefix update";
+  sendRecvPublication(decisionWrapper, newPub, processTimes);
 }
 
 // Add an adjacency to node
@@ -442,16 +523,21 @@ createSswsAdjacencies(
          sswIdInPlane++) {
       auto nodeName = getNodeName(sswMarker, planeId, sswIdInPlane);
       // Add one fsw in each pod to ssw's adjacencies.
+      std::vector<thrift::Adjacency> adjs;
       for (int podId = 0; podId < numOfPods; podId++) {
-        std::vector<thrift::Adjacency> adjs;
-        auto otherName = getNodeName(fswMarker, podId, planeId);
         createFabricAdjacency(nodeName, fswMarker, podId, planeId, adjs);
-
-        // Add to publication
-        initialPub.keyVals.emplace(
-            folly::sformat("adj:{}", nodeName),
-            decisionWrapper->createAdjValue(nodeName, 1, adjs, std::nullopt));
       }
+
+      // Add to publication
+      initialPub.keyVals.emplace(
+          folly::sformat("adj:{}", nodeName),
+          decisionWrapper->createAdjValue(
+              nodeName,
+              1,
+              adjs,
+              std::nullopt,
+              false /* overloadBit */,
+              getNodeLabel(sswMarker, planeId, sswIdInPlane)));
     }
   }
 }
@@ -493,7 +579,13 @@ createFswsAdjacencies(
       // Add to publication
       initialPub.keyVals.emplace(
           folly::sformat("adj:{}", nodeName),
-          decisionWrapper->createAdjValue(nodeName, 1, adjs, std::nullopt));
+          decisionWrapper->createAdjValue(
+              nodeName,
+              1,
+              adjs,
+              std::nullopt,
+              false /* overloadBit */,
+              getNodeLabel(fswMarker, podId, swIdInPod)));
     }
   }
 }
@@ -524,7 +616,60 @@ createRswsAdjacencies(
       // Add to publication
       initialPub.keyVals.emplace(
           folly::sformat("adj:{}", nodeName),
-          decisionWrapper->createAdjValue(nodeName, 1, adjs, std::nullopt));
+          decisionWrapper->createAdjValue(
+              nodeName,
+              1,
+              adjs,
+              std::nullopt,
+              false /* overloadBit */,
+              getNodeLabel(rswMarker, podId, swIdInPod)));
+    }
+  }
+}
+
+/**
+ * Get the prefixes advertised by the rack switch identified by (podId, swId).
+ * Each rack switch advertises numOfPrefixes unique /64 prefixes.
+ */
+std::vector<thrift::IpPrefix>
+getRswPrefixes(const int podId, const int swId, const int numOfPrefixes) {
+  CHECK_GT(0x10000, numOfPrefixes);
+  std::vector<thrift::IpPrefix> prefixes;
+  prefixes.reserve(numOfPrefixes);
+  for (int index = 0; index < numOfPrefixes; index++) {
+    prefixes.emplace_back(toIpPrefix(
+        folly::sformat("fd00:{:x}:{:x}:{:x}::/64", podId, swId, index)));
+  }
+  return prefixes;
+}
+
+/**
+ * Create prefixes for rack switches.
+ * Each rack switch advertises numOfPrefixesPerRsw prefixes.
+ */
+void
+createRswsPrefixes(
+    const std::shared_ptr<DecisionWrapper>& decisionWrapper,
+    thrift::Publication& initialPub,
+    const uint8_t rswMarker,
+    const int numOfPods,
+    const int numOfRswsPerPod,
+    const int numOfPrefixesPerRsw,
+    const thrift::PrefixForwardingAlgorithm forwardingAlgorithm) {
+  if (numOfPrefixesPerRsw == 0) {
+    return;
+  }
+  for (int podId = 0; podId < numOfPods; podId++) {
+    for (int swIdInPod = 0; swIdInPod < numOfRswsPerPod; swIdInPod++) {
+      auto nodeName = getNodeName(rswMarker, podId, swIdInPod);
+      initialPub.keyVals.emplace(
+          folly::sformat("prefix:{}", nodeName),
+          decisionWrapper->createPrefixValue(
+              nodeName,
+              1,
+              getRswPrefixes(podId, swIdInPod, numOfPrefixesPerRsw),
+              std::nullopt,
+              forwardingAlgorithm));
     }
   }
 }
@@ -538,7 +683,10 @@ createFabric(
     const int numOfPods,
     const int numOfSswsPerPlane,
     const int numOfFswsPerPod,
-    const int numOfRswsPerPod) {
+    const int numOfRswsPerPod,
+    const int numOfPrefixesPerRsw = 0,
+    const thrift::PrefixForwardingAlgorithm forwardingAlgorithm =
+        thrift::PrefixForwardingAlgorithm::SP_ECMP) {
   LOG(INFO) << "Pods number: " << numOfPods;
   thrift::Publication initialPub;
 
@@ -576,6 +724,16 @@ createFabric(
       numOfFswsPerPod,
       numOfRswsPerPod);
 
+  // rsw: each rsw advertises its own set of prefixes
+  createRswsPrefixes(
+      decisionWrapper,
+      initialPub,
+      kRswMarker,
+      numOfPods,
+      numOfRswsPerPod,
+      numOfPrefixesPerRsw,
+      forwardingAlgorithm);
+
   return initialPub;
 }
 
@@ -623,7 +781,104 @@ updateRandomFabricAdjs(
 
   // Send the update to decision and receive the routes
   sendRecvUpdate(
-      decisionWrapper, newPub, rwsNodeName, adjsRsw, processTimes, overloadBit);
+      decisionWrapper,
+      newPub,
+      rwsNodeName,
+      adjsRsw,
+      processTimes,
+      overloadBit,
+      getNodeLabel(kRswMarker, podId, rswIdInPod));
+}
+
+//
+// Randomly choose one rsw from a random pod and bring down its link towards
+// the first fsw of the pod. The next call brings the same link back up.
+//
+void
+flapRandomFabricLink(
+    const std::shared_ptr<DecisionWrapper>& decisionWrapper,
+    std::optional<std::pair<int, int>>& selectedNode,
+    const int numOfPods,
+    const int numOfFswsPerPod,
+    const int numOfRswsPerPod,
+    std::vector<uint64_t>& processTimes) {
+  thrift::Publication newPub;
+
+  // If there has been a link down, restore the link,
+  // otherwise, choose a random rsw for the link down
+  auto podId = selectedNode.has_value() ? selectedNode.value().first
+                                        : folly::Random::rand32() % numOfPods;
+  auto rswIdInPod = selectedNode.has_value()
+      ? selectedNode.value().second
+      : folly::Random::rand32() % numOfRswsPerPod;
+
+  auto rwsNodeName = getNodeName(kRswMarker, podId, rswIdInPod);
+
+  // Add fsws within the pod to the adjacencies, skip the first fsw on link down
+  std::vector<thrift::Adjacency> adjsRsw;
+  const int firstFswId = selectedNode.has_value() ? 0 : 1;
+  for (int otherId = firstFswId; otherId < numOfFswsPerPod; otherId += 1) {
+    createFabricAdjacency(rwsNodeName, kFswMarker, podId, otherId, adjsRsw);
+  }
+
+  // Record the updated rsw
+  selectedNode = (selectedNode.has_value())
+      ? std::nullopt
+      : std::optional<std::pair<int, int>>(std::make_pair(podId, rswIdInPod));
+
+  // Send the update to decision and receive the routes
+  sendRecvUpdate(
+      decisionWrapper,
+      newPub,
+      rwsNodeName,
+      adjsRsw,
+      processTimes,
+      false /* overloadBit */,
+      getNodeLabel(kRswMarker, podId, rswIdInPod));
+}
+
+//
+// Randomly choose one rsw from a random pod and withdraw its first prefix.
+// The next call advertises the same prefix again.
+//
+void
+churnRandomFabricPrefixes(
+    const std::shared_ptr<DecisionWrapper>& decisionWrapper,
+    std::optional<std::pair<int, int>>& selectedNode,
+    const int numOfPods,
+    const int numOfRswsPerPod,
+    const int numOfPrefixesPerRsw,
+    const thrift::PrefixForwardingAlgorithm forwardingAlgorithm,
+    std::vector<uint64_t>& processTimes) {
+  thrift::Publication newPub;
+
+  // If there has been a withdrawal, re-advertise the prefix,
+  // otherwise, choose a random rsw for the withdrawal
+  auto podId = selectedNode.has_value() ? selectedNode.value().first
+                                        : folly::Random::rand32() % numOfPods;
+  auto rswIdInPod = selectedNode.has_value()
+      ? selectedNode.value().second
+      : folly::Random::rand32() % numOfRswsPerPod;
+
+  auto rwsNodeName = getNodeName(kRswMarker, podId, rswIdInPod);
+  auto prefixes = getRswPrefixes(podId, rswIdInPod, numOfPrefixesPerRsw);
+  if (not selectedNode.has_value()) {
+    prefixes.erase(prefixes.begin());
+  }
+
+  // Record the updated rsw
+  selectedNode = (selectedNode.has_value())
+      ? std::nullopt
+      : std::optional<std::pair<int, int>>(std::make_pair(podId, rswIdInPod));
+
+  // Send the update to decision and receive the routes
+  sendRecvPrefixUpdate(
+      decisionWrapper,
+      newPub,
+      rwsNodeName,
+      prefixes,
+      forwardingAlgorithm,
+      processTimes);
 }
 
 //
@@ -676,6 +931,62 @@ insertUserCounters(
   counters["spf"] = processTimes[2];
 }
 
+//
+// Get average number of allocations and peak RSS and insert as user counters.
+// Peak RSS is process wide and hence includes all previous benchmarks.
+//
+void
+insertResourceCounters(
+    folly::UserCounters& counters, uint32_t iters, uint64_t numOfAllocations) {
+  counters["allocations"] = numOfAllocations / (iters == 0 ? 1 : iters);
+
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    counters["peak_rss_kb"] = usage.ru_maxrss;
+  }
+}
+
+//
+// Get the number of pods which fit into numOfSws switches
+//
+int
+getNumOfFabricPods(const uint32_t numOfSws) {
+  const int numOfPlanes = kNumOfFswsPerPod;
+
+  // Check the total number of switches is no smaller than (the number of ssws +
+  // the number of switches in one pod)
+  CHECK_LE(
+      numOfPlanes * kNumOfSswsPerPlane + kNumOfFswsPerPod + kNumOfRswsPerPod,
+      numOfSws);
+
+  // #pods = (#total_switches - #ssws) / (sws_per_pod)
+  return (numOfSws - numOfPlanes * kNumOfSswsPerPlane) /
+      (kNumOfFswsPerPod + kNumOfRswsPerPod);
+}
+
+//
+// Read recorded publications. Each record is a 4-byte big-endian length
+// followed by a compact serialized thrift::Publication.
+//
+std::vector<thrift::Publication>
+readRecordedPublications(const std::string& filePath) {
+  std::string fileData;
+  CHECK(folly::readFile(filePath.c_str(), fileData))
+      << "Failed to read recorded publications from " << filePath;
+
+  CompactSerializer serializer;
+  std::vector<thrift::Publication> publications;
+  auto ioBuf = folly::IOBuf::wrapBuffer(fileData.c_str(), fileData.size());
+  folly::io::Cursor cursor(ioBuf.get());
+  while (not cursor.isAtEnd()) {
+    const auto length = cursor.readBE<uint32_t>();
+    publications.emplace_back(
+        fbzmq::util::readThriftObjStr<thrift::Publication>(
+            cursor.readFixedString(length), serializer));
+  }
+  return publications;
+}
+
 //
 // Benchmark test for grid topology
 //
@@ -730,17 +1041,7 @@ BM_DecisionFabric(
   const int numOfFswsPerPod = kNumOfFswsPerPod;
   const int numOfRswsPerPod = kNumOfRswsPerPod;
   const int numOfSswsPerPlane = kNumOfSswsPerPlane;
-  const int numOfPlanes = numOfFswsPerPod;
-
-  // Check the total number of switches is no smaller than (the number of ssws +
-  // the number of switches in one pod)
-  CHECK_LE(
-      numOfPlanes * numOfSswsPerPlane + numOfFswsPerPod + numOfRswsPerPod,
-      numOfSws);
-
-  // #pods = (#total_switches - #ssws) / (sws_per_pod)
-  const int numOfPods = (numOfSws - numOfPlanes * numOfSswsPerPlane) /
-      (numOfFswsPerPod + numOfRswsPerPod);
+  const int numOfPods = getNumOfFabricPods(numOfSws);
 
   auto initialPub = createFabric(
       decisionWrapper,
@@ -786,6 +1087,197 @@ BM_DecisionFabric(
   insertUserCounters(counters, iters, processTimes);
 }
 
+//
+// Benchmark test for the initial route build of a fabric topology with
+// numOfPrefixesPerRsw prefixes advertised by every rsw.
+//
+static void
+BM_DecisionFabricFullBuild(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfSws,
+    uint32_t numOfPrefixesPerRsw,
+    bool computeLfaPaths) {
+  auto suspender = folly::BenchmarkSuspender();
+  const std::string nodeName = folly::sformat("{}-{}", kFswMarker, "0-0");
+  const int numOfPods = getNumOfFabricPods(numOfSws);
+  uint64_t numOfAllocations{0};
+
+  for (uint32_t i = 0; i < iters; i++) {
+    // Start every iteration from an empty link state
+    auto decisionWrapper =
+        std::make_shared<DecisionWrapper>(nodeName, computeLfaPaths);
+    auto initialPub = createFabric(
+        decisionWrapper,
+        numOfPods,
+        kNumOfSswsPerPlane,
+        kNumOfFswsPerPod,
+        kNumOfRswsPerPod,
+        numOfPrefixesPerRsw);
+
+    const auto allocationsBefore = gNumOfAllocations.load();
+    suspender.dismiss(); // Start measuring benchmark time
+
+    // Publish the whole topology and receive the full route database
+    decisionWrapper->sendKvPublication(initialPub);
+    decisionWrapper->recvMyRouteDb();
+
+    suspender.rehire(); // Stop measuring time again
+    numOfAllocations += gNumOfAllocations.load() - allocationsBefore;
+  }
+
+  insertResourceCounters(counters, iters, numOfAllocations);
+}
+
+//
+// Benchmark test for a single link flap in a fabric topology.
+//
+static void
+BM_DecisionFabricLinkFlap(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfSws,
+    uint32_t numOfPrefixesPerRsw,
+    bool computeLfaPaths) {
+  auto suspender = folly::BenchmarkSuspender();
+  const std::string nodeName = folly::sformat("{}-{}", kFswMarker, "0-0");
+  auto decisionWrapper =
+      std::make_shared<DecisionWrapper>(nodeName, computeLfaPaths);
+  const int numOfPods = getNumOfFabricPods(numOfSws);
+
+  auto initialPub = createFabric(
+      decisionWrapper,
+      numOfPods,
+      kNumOfSswsPerPlane,
+      kNumOfFswsPerPod,
+      kNumOfRswsPerPod,
+      numOfPrefixesPerRsw);
+  decisionWrapper->sendKvPublication(initialPub);
+  decisionWrapper->recvMyRouteDb();
+
+  // Record the updated node
+  std::optional<std::pair<int, int>> selectedNode = std::nullopt;
+
+  // Customized time counters, see BM_DecisionFabric
+  std::vector<uint64_t> processTimes{0, 0, 0};
+  const auto allocationsBefore = gNumOfAllocations.load();
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; i++) {
+    // Bring a link down or up. This should trigger the SPF run.
+    flapRandomFabricLink(
+        decisionWrapper,
+        selectedNode,
+        numOfPods,
+        kNumOfFswsPerPod,
+        kNumOfRswsPerPod,
+        processTimes);
+  }
+
+  suspender.rehire(); // Stop measuring time again
+  insertUserCounters(counters, iters, processTimes);
+  insertResourceCounters(
+      counters, iters, gNumOfAllocations.load() - allocationsBefore);
+}
+
+//
+// Benchmark test for a single prefix withdrawal/advertisement in a fabric
+// topology, using forwardingAlgorithm for all prefixes.
+//
+static void
+BM_DecisionFabricPrefixChurn(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfSws,
+    uint32_t numOfPrefixesPerRsw,
+    thrift::PrefixForwardingAlgorithm forwardingAlgorithm) {
+  auto suspender = folly::BenchmarkSuspender();
+  const std::string nodeName = folly::sformat("{}-{}", kFswMarker, "0-0");
+  auto decisionWrapper = std::make_shared<DecisionWrapper>(nodeName);
+  const int numOfPods = getNumOfFabricPods(numOfSws);
+  CHECK_LT(0, numOfPrefixesPerRsw);
+
+  auto initialPub = createFabric(
+      decisionWrapper,
+      numOfPods,
+      kNumOfSswsPerPlane,
+      kNumOfFswsPerPod,
+      kNumOfRswsPerPod,
+      numOfPrefixesPerRsw,
+      forwardingAlgorithm);
+  decisionWrapper->sendKvPublication(initialPub);
+  decisionWrapper->recvMyRouteDb();
+
+  // Record the updated node
+  std::optional<std::pair<int, int>> selectedNode = std::nullopt;
+
+  //
+  // Customized time counters
+  // processTimes[0] is the time of sending prefixDB from Kvstore (simulated) to
+  // Decision, processTimes[1] is the time of debounce, and processTimes[2] is
+  // the time of route build
+  //
+  std::vector<uint64_t> processTimes{0, 0, 0};
+  const auto allocationsBefore = gNumOfAllocations.load();
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; i++) {
+    // Withdraw or advertise a prefix. This should trigger the route build.
+    churnRandomFabricPrefixes(
+        decisionWrapper,
+        selectedNode,
+        numOfPods,
+        kNumOfRswsPerPod,
+        numOfPrefixesPerRsw,
+        forwardingAlgorithm,
+        processTimes);
+  }
+
+  suspender.rehire(); // Stop measuring time again
+  insertUserCounters(counters, iters, processTimes);
+  insertResourceCounters(
+      counters, iters, gNumOfAllocations.load() - allocationsBefore);
+}
+
+//
+// Benchmark test replaying publications recorded in --decision_replay_file.
+// Every iteration replays all publications on a fresh Decision instance.
+//
+static void
+BM_DecisionReplay(folly::UserCounters& counters, uint32_t iters) {
+  auto suspender = folly::BenchmarkSuspender();
+  if (FLAGS_decision_replay_file.empty()) {
+    LOG(INFO) << "No --decision_replay_file given, skipping replay";
+    return;
+  }
+  CHECK(not FLAGS_decision_replay_node.empty())
+      << "--decision_replay_node is required for replay";
+
+  const auto publications =
+      readRecordedPublications(FLAGS_decision_replay_file);
+  CHECK(not publications.empty());
+  LOG(INFO) << "Replaying " << publications.size() << " publications";
+  uint64_t numOfAllocations{0};
+
+  for (uint32_t i = 0; i < iters; i++) {
+    auto decisionWrapper =
+        std::make_shared<DecisionWrapper>(FLAGS_decision_replay_node);
+
+    const auto allocationsBefore = gNumOfAllocations.load();
+    suspender.dismiss(); // Start measuring benchmark time
+
+    for (const auto& publication : publications) {
+      decisionWrapper->sendKvPublication(publication);
+      decisionWrapper->recvMyRouteDb();
+    }
+
+    suspender.rehire(); // Stop measuring time again
+    numOfAllocations += gNumOfAllocations.load() - allocationsBefore;
+  }
+
+  insertResourceCounters(counters, iters, numOfAllocations);
+}
+
 // The integer parameter is the number of nodes in grid topology
 BENCHMARK_COUNTERS_PARAM(BM_DecisionGrid, counters, 10);
 BENCHMARK_COUNTERS_PARAM(BM_DecisionGrid, counters, 100);
@@ -801,6 +1293,49 @@ BENCHMARK_COUNTERS_PARAM(BM_DecisionGrid, counters, 10000);
 BENCHMARK_COUNTERS_PARAM(BM_DecisionFabric, counters, 344);
 BENCHMARK_COUNTERS_PARAM(BM_DecisionFabric, counters, 1000);
 BENCHMARK_COUNTERS_PARAM(BM_DecisionFabric, counters, 5000);
+BENCHMARK_COUNTERS_PARAM(BM_DecisionFabric, counters, 10000);
+
+// Parameters are (numOfGivenNodes, numOfPrefixesPerRsw, computeLfaPaths).
+// 10000 nodes result in 9976 switches with ~116k links and, with 60 prefixes
+// per rsw, ~500k prefixes.
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricFullBuild, counters, 1000_10, 1000, 10, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricFullBuild, counters, 10000_60, 10000, 60, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricFullBuild, counters, 10000_60_lfa, 10000, 60, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricLinkFlap, counters, 1000_10, 1000, 10, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricLinkFlap, counters, 10000_60, 10000, 60, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricLinkFlap, counters, 10000_60_lfa, 10000, 60, true);
+
+// Parameters are (numOfGivenNodes, numOfPrefixesPerRsw, forwardingAlgorithm)
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricPrefixChurn,
+    counters,
+    10000_60,
+    10000,
+    60,
+    thrift::PrefixForwardingAlgorithm::SP_ECMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricPrefixChurn,
+    counters,
+    1000_10_ksp2,
+    1000,
+    10,
+    thrift::PrefixForwardingAlgorithm::KSP2_ED_ECMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricPrefixChurn,
+    counters,
+    10000_60_ksp2,
+    10000,
+    60,
+    thrift::PrefixForwardingAlgorithm::KSP2_ED_ECMP);
+
+// Replays --decision_replay_file, a no-op when the flag is not set
+BENCHMARK_COUNTERS_NAME_PARAM(BM_DecisionReplay, counters, recorded);
 
 } // namespace openr
 
@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <atomic>
 #include <memory>
 
 #include <fb303/ServiceData.h>
@@ -13,6 +14,7 @@
 #include <folly/IPAddressV6.h>
 #include <folly/Optional.h>
 #include <folly/Random.h>
+#include <folly/Synchronized.h>
 #include <folly/futures/Promise.h>
 #include <folly/init/Init.h>
 #include <gflags/gflags.h>
@@ -23,6 +25,7 @@
 
 #include <openr/common/Constants.h>
 #include <openr/common/NetworkUtil.h>
+#include <openr/common/StatCounter.h>
 #include <openr/common/Util.h>
 #include <openr/config/tests/Utils.h>
 #include <openr/decision/Decision.h>
@@ -396,6 +399,7 @@ TEST(SpfSolver, Counters) {
 
   // Verify counters
   spfSolver.updateGlobalCounters();
+  StatCounter::flushAll();
   const auto counters = fb303::fbData->getCounters();
   EXPECT_EQ(counters.at("decision.num_partial_adjacencies"), 1);
   EXPECT_EQ(counters.at("decision.num_complete_adjacencies"), 2);
@@ -668,6 +672,217 @@ TEST(SpfSolver, AdjacencyUpdate) {
   }
 }
 
+//
+// Verify that SPF results are reused across route builds for different nodes
+// and only updated once topology changes
+//
+TEST(SpfSolver, SpfResultCache) {
+  auto adjacencyDb1 = createAdjDb("1", {adj12}, 1);
+  auto adjacencyDb2 = createAdjDb("2", {adj21}, 2);
+
+  std::string nodeName("1");
+  SpfSolver spfSolver(nodeName, false /* disable v4 */, true /* enable LFA */);
+  spfSolver.updateAdjacencyDatabase(adjacencyDb1);
+  spfSolver.updateAdjacencyDatabase(adjacencyDb2);
+  EXPECT_TRUE(spfSolver.updatePrefixDatabase(prefixDb1));
+  EXPECT_TRUE(spfSolver.updatePrefixDatabase(prefixDb2));
+
+  fb303::fbData->resetAllData();
+
+  // node1 and it's LFA neighbor node2 are the SPF roots for either node
+  EXPECT_TRUE(spfSolver.buildPaths("1").has_value());
+  EXPECT_TRUE(spfSolver.buildPaths("2").has_value());
+  EXPECT_TRUE(spfSolver.buildPaths("1").has_value());
+  EXPECT_TRUE(spfSolver.buildRouteDb("2").has_value());
+  StatCounter::flushAll();
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(2, counters.at("decision.spf_runs.count"));
+  EXPECT_LT(0, counters.at("decision.spf_cache_hits.count"));
+
+  // metric change is applied to both cached results
+  adjacencyDb1.adjacencies[0].metric = 5;
+  EXPECT_TRUE(spfSolver.updateAdjacencyDatabase(adjacencyDb1).first);
+  auto routeDb = spfSolver.buildPaths("1");
+  ASSERT_TRUE(routeDb.has_value());
+  EXPECT_TRUE(spfSolver.buildPaths("2").has_value());
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(2, counters.at("decision.spf_runs.count"));
+  EXPECT_EQ(2, counters.at("decision.incremental_spf_runs.count"));
+
+  ASSERT_EQ(1, routeDb->unicastRoutes.size());
+  EXPECT_THAT(
+      routeDb->unicastRoutes.at(0).nextHops,
+      testing::UnorderedElementsAre(createNextHopFromAdj(adj12, false, 5)));
+}
+
+//
+// Verify that routes built for a subset of prefixes match the full route
+// build, and that withdrawn prefixes are reported as changed without a route
+//
+TEST(SpfSolver, BuildUnicastRoutes) {
+  auto adjacencyDb1 = createAdjDb("1", {adj12}, 1);
+  auto adjacencyDb2 = createAdjDb("2", {adj21}, 2);
+
+  std::string nodeName("1");
+  SpfSolver spfSolver(
+      nodeName, false /* disable v4 */, false /* disable LFA */);
+  spfSolver.updateAdjacencyDatabase(adjacencyDb1);
+  spfSolver.updateAdjacencyDatabase(adjacencyDb2);
+  EXPECT_TRUE(spfSolver.updatePrefixDatabase(prefixDb1));
+
+  std::unordered_set<thrift::IpPrefix> changedPrefixes;
+  EXPECT_TRUE(spfSolver.updatePrefixDatabase(
+      createPrefixDb(
+          "2", {createPrefixEntry(addr2), createPrefixEntry(addr3)}),
+      changedPrefixes));
+  EXPECT_THAT(changedPrefixes, testing::UnorderedElementsAre(addr2, addr3));
+
+  auto routeDb = spfSolver.buildPaths("1");
+  ASSERT_TRUE(routeDb.has_value());
+  EXPECT_EQ(2, routeDb->unicastRoutes.size());
+
+  fb303::fbData->resetAllData();
+  auto routes = spfSolver.buildUnicastRoutes("1", changedPrefixes);
+  ASSERT_TRUE(routes.has_value());
+  EXPECT_THAT(
+      routes.value(),
+      testing::UnorderedElementsAreArray(routeDb->unicastRoutes));
+  // SPF results are reused, routes are only built for the given prefixes
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(0, counters["decision.spf_runs.count"]);
+  EXPECT_EQ(0, counters["decision.route_build_runs.count"]);
+  EXPECT_EQ(1, counters.at("decision.prefix_route_build_runs.count"));
+
+  // route to prefix of node-1 is not programmed by node-1 itself
+  routes = spfSolver.buildUnicastRoutes("1", {addr1});
+  ASSERT_TRUE(routes.has_value());
+  EXPECT_EQ(0, routes->size());
+
+  // withdraw addr3
+  changedPrefixes.clear();
+  EXPECT_TRUE(spfSolver.updatePrefixDatabase(prefixDb2, changedPrefixes));
+  EXPECT_THAT(changedPrefixes, testing::UnorderedElementsAre(addr3));
+  routes = spfSolver.buildUnicastRoutes("1", changedPrefixes);
+  ASSERT_TRUE(routes.has_value());
+  EXPECT_EQ(0, routes->size());
+
+  // unknown node
+  EXPECT_FALSE(spfSolver.buildUnicastRoutes("3", {addr2}).has_value());
+}
+
+//
+// Verify deltas produced by DecisionRouteDb for full and per prefix updates
+//
+TEST(DecisionRouteDb, Update) {
+  const auto nh1 = createNextHop(toBinaryAddress("fe80::1"), "iface1", 1);
+  const auto nh2 = createNextHop(toBinaryAddress("fe80::2"), "iface2", 1);
+  const auto route1 = createUnicastRoute(addr1, {nh1});
+  const auto route2 = createUnicastRoute(addr2, {nh1, nh2});
+  const auto labelRoute = createMplsRoute(1, {nh1});
+
+  detail::DecisionRouteDb routeDb;
+  thrift::RouteDatabase db;
+  db.thisNodeName = "1";
+  db.unicastRoutes = {route2, route1};
+  db.mplsRoutes = {labelRoute};
+  auto delta = routeDb.update(db);
+  EXPECT_EQ("1", delta.thisNodeName);
+  EXPECT_EQ(
+      std::vector<thrift::UnicastRoute>({route1, route2}),
+      delta.unicastRoutesToUpdate);
+  EXPECT_EQ(
+      std::vector<thrift::MplsRoute>({labelRoute}), delta.mplsRoutesToUpdate);
+  EXPECT_EQ(2, routeDb.getUnicastRoutesCount());
+  EXPECT_EQ(1, routeDb.getMplsRoutesCount());
+
+  // same routes, no delta
+  db.unicastRoutes = {route1, route2};
+  db.mplsRoutes = {labelRoute};
+  delta = routeDb.update(db);
+  EXPECT_EQ(0, delta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(0, delta.unicastRoutesToDelete.size());
+  EXPECT_EQ(0, delta.mplsRoutesToUpdate.size());
+  EXPECT_EQ(0, delta.mplsRoutesToDelete.size());
+
+  // route1 changes, route2 and label route are withdrawn
+  const auto newRoute1 = createUnicastRoute(addr1, {nh2});
+  db.unicastRoutes = {newRoute1};
+  db.mplsRoutes = {};
+  delta = routeDb.update(db);
+  EXPECT_EQ(
+      std::vector<thrift::UnicastRoute>({newRoute1}),
+      delta.unicastRoutesToUpdate);
+  EXPECT_EQ(
+      std::vector<thrift::IpPrefix>({addr2}), delta.unicastRoutesToDelete);
+  EXPECT_EQ(0, delta.mplsRoutesToUpdate.size());
+  EXPECT_EQ(std::vector<int32_t>({1}), delta.mplsRoutesToDelete);
+
+  // per prefix update: add route2, withdraw route1, addr3 is unknown
+  std::vector<thrift::UnicastRoute> routes = {route2};
+  delta = routeDb.updateUnicastRoutes(routes, {addr1, addr2, addr3});
+  EXPECT_EQ(
+      std::vector<thrift::UnicastRoute>({route2}), delta.unicastRoutesToUpdate);
+  EXPECT_EQ(
+      std::vector<thrift::IpPrefix>({addr1}), delta.unicastRoutesToDelete);
+  EXPECT_EQ(1, routeDb.getUnicastRoutesCount());
+
+  // route2 stays after a full update containing it
+  db.unicastRoutes = {route2};
+  delta = routeDb.update(db);
+  EXPECT_EQ(0, delta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(0, delta.unicastRoutesToDelete.size());
+}
+
+TEST(DecisionRouteDb, MergeAreaRoutes) {
+  const auto nh1 = createNextHop(toBinaryAddress("fe80::1"), "iface1", 10);
+  const auto nh2 = createNextHop(toBinaryAddress("fe80::2"), "iface2", 10);
+  const auto nh3 = createNextHop(toBinaryAddress("fe80::3"), "iface3", 20);
+
+  std::vector<thrift::RouteDatabase> areaRouteDbs(2);
+  thrift::RouteComputationStats stats;
+  stats.durationUs = 10;
+  stats.numRoutes = 2;
+  areaRouteDbs[0].computationStats_ref() =
+      std::map<std::string, thrift::RouteComputationStats>{{"sp_ecmp", stats}};
+  areaRouteDbs[1].computationStats_ref() =
+      std::map<std::string, thrift::RouteComputationStats>{{"sp_ecmp", stats}};
+  areaRouteDbs[0].thisNodeName = "1";
+  areaRouteDbs[0].unicastRoutes = {createUnicastRoute(addr1, {nh1}),
+                                   createUnicastRoute(addr2, {nh3})};
+  areaRouteDbs[0].mplsRoutes = {createMplsRoute(1, {nh1})};
+  areaRouteDbs[1].thisNodeName = "1";
+  areaRouteDbs[1].unicastRoutes = {createUnicastRoute(addr1, {nh2, nh1}),
+                                   createUnicastRoute(addr2, {nh2}),
+                                   createUnicastRoute(addr3, {nh3})};
+  areaRouteDbs[1].mplsRoutes = {createMplsRoute(2, {nh2})};
+
+  auto routeDb = detail::mergeAreaRouteDbs(areaRouteDbs);
+  EXPECT_EQ("1", routeDb.thisNodeName);
+  std::sort(routeDb.unicastRoutes.begin(), routeDb.unicastRoutes.end());
+  std::sort(routeDb.mplsRoutes.begin(), routeDb.mplsRoutes.end());
+  // equal metric nexthops are combined, lower metric area route wins
+  EXPECT_EQ(
+      std::vector<thrift::UnicastRoute>(
+          {createUnicastRoute(addr1, {nh1, nh2}),
+           createUnicastRoute(addr2, {nh2}),
+           createUnicastRoute(addr3, {nh3})}),
+      routeDb.unicastRoutes);
+  EXPECT_EQ(
+      std::vector<thrift::MplsRoute>(
+          {createMplsRoute(1, {nh1}), createMplsRoute(2, {nh2})}),
+      routeDb.mplsRoutes);
+  // computation stats of areas add up
+  ASSERT_TRUE(routeDb.computationStats_ref().has_value());
+  EXPECT_EQ(20, routeDb.computationStats_ref()->at("sp_ecmp").durationUs);
+  EXPECT_EQ(4, routeDb.computationStats_ref()->at("sp_ecmp").numRoutes);
+
+  std::vector<std::vector<thrift::UnicastRoute>> areaUnicastRoutes = {
+      {createUnicastRoute(addr2, {nh1})}, {createUnicastRoute(addr2, {nh3})}};
+  EXPECT_EQ(
+      std::vector<thrift::UnicastRoute>({createUnicastRoute(addr2, {nh1})}),
+      detail::mergeAreaUnicastRoutes(areaUnicastRoutes));
+}
+
 //
 // Node-1 connects to 2 but 2 doesn't report bi-directionality
 // Node-2 and Node-3 are bi-directionally connected
@@ -709,6 +924,87 @@ TEST(MplsRoutes, BasicTest) {
   // Validate 3's routes
   validatePopLabelRoute(routeMap, "3", adjacencyDb3.nodeLabel);
   validateAdjLabelRoutes(routeMap, "3", {adj32});
+
+  // Routes are accounted per type of computation
+  auto routeDb = spfSolver.buildRouteDb("3");
+  ASSERT_TRUE(routeDb.has_value());
+  ASSERT_TRUE(routeDb->computationStats_ref().has_value());
+  auto const& computationStats = *routeDb->computationStats_ref();
+  EXPECT_EQ(1, computationStats.at("mpls_node_label").numRoutes);
+  EXPECT_EQ(1, computationStats.at("mpls_adj_label").numRoutes);
+  EXPECT_EQ(0, computationStats.count("bgp"));
+}
+
+//
+// MPLS routes are only rebuilt for nodes whose shortest paths have changed,
+// and all of them once links of the node itself change
+//
+TEST(MplsRoutes, CachedRoutes) {
+  fb303::fbData->resetAllData();
+  SpfSolver spfSolver("1", false /* disable v4 */, false /* disable LFA */);
+
+  auto adjacencyDb1 = createAdjDb("1", {adj12}, 1);
+  auto adjacencyDb2 = createAdjDb("2", {adj21, adj23}, 2);
+  auto adjacencyDb3 = createAdjDb("3", {adj32}, 3);
+  spfSolver.updateAdjacencyDatabase(adjacencyDb1);
+  spfSolver.updateAdjacencyDatabase(adjacencyDb2);
+  spfSolver.updateAdjacencyDatabase(adjacencyDb3);
+
+  auto getMplsRoutes = [&]() {
+    auto routeDb = spfSolver.buildRouteDb("1");
+    EXPECT_TRUE(routeDb.has_value());
+    std::sort(routeDb->mplsRoutes.begin(), routeDb->mplsRoutes.end());
+    return routeDb->mplsRoutes;
+  };
+  auto getCacheHits = []() {
+    return fb303::fbData->getCounters()["decision.mpls_route_cache_hits.count"];
+  };
+
+  // self, node 2, node 3 and adj12 label routes
+  const auto mplsRoutes = getMplsRoutes();
+  EXPECT_EQ(4, mplsRoutes.size());
+  EXPECT_EQ(0, getCacheHits());
+
+  // nothing changed, routes of node 2 and 3 are reused
+  EXPECT_EQ(mplsRoutes, getMplsRoutes());
+  EXPECT_EQ(2, getCacheHits());
+
+  // longer path to node 3, only route of node 2 is reused
+  adjacencyDb2 = createAdjDb(
+      "2",
+      {adj21,
+       createAdjacency(
+           "3", "2/3", "3/2", "fe80::3", "192.168.0.3", 20, 100003)},
+      2);
+  adjacencyDb3 = createAdjDb(
+      "3",
+      {createAdjacency(
+          "2", "3/2", "2/3", "fe80::2", "192.168.0.2", 20, 100002)},
+      3);
+  spfSolver.updateAdjacencyDatabase(adjacencyDb2);
+  spfSolver.updateAdjacencyDatabase(adjacencyDb3);
+  for (auto const& route : getMplsRoutes()) {
+    if (route.topLabel == 3) {
+      ASSERT_EQ(1, route.nextHops.size());
+      EXPECT_EQ(30, route.nextHops.at(0).metric);
+    }
+  }
+  EXPECT_EQ(3, getCacheHits());
+
+  // adjacency label of node 1 changed, all routes are rebuilt
+  auto adj12NewLabel =
+      createAdjacency("2", "1/2", "2/1", "fe80::2", "192.168.0.2", 10, 100099);
+  adjacencyDb1 = createAdjDb("1", {adj12NewLabel}, 1);
+  spfSolver.updateAdjacencyDatabase(adjacencyDb1);
+  auto newMplsRoutes = getMplsRoutes();
+  EXPECT_EQ(3, getCacheHits());
+  ASSERT_EQ(4, newMplsRoutes.size());
+  EXPECT_EQ(
+      1,
+      std::count_if(
+          newMplsRoutes.begin(), newMplsRoutes.end(), [](auto const& route) {
+            return route.topLabel == 100099;
+          }));
 }
 
 TEST(BGPRedistribution, BasicOperation) {
@@ -3803,15 +4099,111 @@ TEST(GridTopology, StressTest) {
   spfSolver.buildPaths("523");
 }
 
+//
+// Apply random link metric, link up/down and node overload changes on a grid
+// and verify that incrementally updated SPF results produce exactly the same
+// routes as full SPF runs
+//
+TEST(GridTopology, IncrementalSpf) {
+  const int n = 8;
+  const std::string myNodeName{"9"};
+  SpfSolver fullSpfSolver(
+      myNodeName,
+      false /* enableV4 */,
+      true /* computeLfaPaths */,
+      false /* enableOrderedFib */,
+      false /* bgpDryRun */,
+      false /* bgpUseIgpMetric */,
+      false /* enableIncrementalSpf */);
+  SpfSolver incSpfSolver(
+      myNodeName,
+      false /* enableV4 */,
+      true /* computeLfaPaths */,
+      false /* enableOrderedFib */,
+      false /* bgpDryRun */,
+      false /* bgpUseIgpMetric */,
+      true /* enableIncrementalSpf */);
+  // LFA neighbor SPF updated concurrently
+  SpfSolver parallelSpfSolver(
+      myNodeName,
+      false /* enableV4 */,
+      true /* computeLfaPaths */,
+      false /* enableOrderedFib */,
+      false /* bgpDryRun */,
+      false /* bgpUseIgpMetric */,
+      true /* enableIncrementalSpf */,
+      4 /* numSpfThreads */);
+  createGrid(fullSpfSolver, n);
+  createGrid(incSpfSolver, n);
+  createGrid(parallelSpfSolver, n);
+
+  auto const getRoutes = [&](SpfSolver& spfSolver) {
+    RouteMap routeMap;
+    auto routeDb = spfSolver.buildPaths(myNodeName);
+    EXPECT_TRUE(routeDb.has_value());
+    if (routeDb.has_value()) {
+      fillRouteMap(myNodeName, routeMap, routeDb.value());
+    }
+    return routeMap;
+  };
+  EXPECT_EQ(getRoutes(fullSpfSolver), getRoutes(incSpfSolver));
+  EXPECT_EQ(getRoutes(fullSpfSolver), getRoutes(parallelSpfSolver));
+
+  for (int iter = 0; iter < 200; ++iter) {
+    const int node = folly::Random::rand32() % (n * n);
+    const int i = node / n, j = node % n;
+
+    // re-create adjacencies of node with random metrics, randomly dropping
+    // some of them
+    vector<thrift::Adjacency> adjs;
+    addAdj(i, j + 1, "0/1", adjs, n, "0/3");
+    addAdj(i - 1, j, "0/2", adjs, n, "0/4");
+    addAdj(i, j - 1, "0/3", adjs, n, "0/1");
+    addAdj(i + 1, j, "0/4", adjs, n, "0/2");
+    vector<thrift::Adjacency> newAdjs;
+    for (auto& adj : adjs) {
+      if (folly::Random::oneIn(6)) {
+        continue;
+      }
+      adj.metric = 1 + folly::Random::rand32() % 4;
+      adj.isOverloaded = folly::Random::oneIn(10);
+      newAdjs.emplace_back(adj);
+    }
+    auto adjacencyDb = createAdjDb(
+        folly::sformat("{}", node),
+        newAdjs,
+        node + 1,
+        folly::Random::oneIn(10) /* overload */);
+
+    fullSpfSolver.updateAdjacencyDatabase(adjacencyDb);
+    incSpfSolver.updateAdjacencyDatabase(adjacencyDb);
+    parallelSpfSolver.updateAdjacencyDatabase(adjacencyDb);
+    const auto routes = getRoutes(fullSpfSolver);
+    ASSERT_EQ(routes, getRoutes(incSpfSolver))
+        << "Mismatch after updating adjacencies of node " << node;
+    ASSERT_EQ(routes, getRoutes(parallelSpfSolver))
+        << "Mismatch after updating adjacencies of node " << node;
+  }
+
+  // verify that incremental updates have actually been exercised
+  const auto counters = fb303::fbData->getCounters();
+  EXPECT_LT(0, counters.at("decision.incremental_spf_runs.count"));
+}
+
 //
 // Start the decision thread and simulate KvStore communications
 // Expect proper RouteDatabase publications to appear
 //
 class DecisionTestFixture : public ::testing::Test {
  protected:
+  virtual openr::thrift::OpenrConfig
+  createConfig() {
+    return getBasicOpenrConfig("1");
+  }
+
   void
   SetUp() override {
-    auto tConfig = getBasicOpenrConfig("1");
+    auto tConfig = createConfig();
     config = std::make_shared<Config>(tConfig);
 
     decision = make_shared<Decision>(
@@ -3823,7 +4215,8 @@ class DecisionTestFixture : public ::testing::Test {
         kvStoreUpdatesQueue.getReader(),
         staticRoutesUpdateQueue.getReader(),
         routeUpdatesQueue,
-        zeromqContext);
+        zeromqContext,
+        &prefixUpdatesQueue);
 
     decisionThread = std::make_unique<std::thread>([this]() {
       LOG(INFO) << "Decision thread starting";
@@ -3842,6 +4235,7 @@ class DecisionTestFixture : public ::testing::Test {
     decision->stop();
     decisionThread->join();
     LOG(INFO) << "Decision thread got stopped";
+    prefixUpdatesQueue.close();
   }
 
   //
@@ -3977,11 +4371,15 @@ class DecisionTestFixture : public ::testing::Test {
   fbzmq::Context zeromqContext{};
 
   std::shared_ptr<Config> config;
-  messaging::ReplicateQueue<thrift::Publication> kvStoreUpdatesQueue;
+  messaging::ReplicateQueue<messaging::SharedValue<thrift::Publication>>
+      kvStoreUpdatesQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> staticRoutesUpdateQueue;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> routeUpdatesQueue;
   messaging::RQueue<thrift::RouteDatabaseDelta> routeUpdatesQueueReader{
       routeUpdatesQueue.getReader()};
+  messaging::ReplicateQueue<thrift::PrefixUpdateRequest> prefixUpdatesQueue;
+  messaging::RQueue<thrift::PrefixUpdateRequest> prefixUpdatesQueueReader{
+      prefixUpdatesQueue.getReader()};
 
   // Decision owned by this wrapper.
   std::shared_ptr<Decision> decision{nullptr};
@@ -4182,8 +4580,6 @@ TEST_F(DecisionTestFixture, BasicOperations) {
   // update 32011 and make sure only that is updated
   sendStaticRoutesUpdate(input);
   auto routesDelta = routeUpdatesQueueReader.get().value();
-  // consume an empty routes update because of reachability change.
-  routeUpdatesQueueReader.get().value();
   routesDelta.perfEvents_ref().reset();
   EXPECT_EQ(routesDelta, input);
 
@@ -4192,8 +4588,6 @@ TEST_F(DecisionTestFixture, BasicOperations) {
   input.mplsRoutesToUpdate = {route};
   sendStaticRoutesUpdate(input);
   routesDelta = routeUpdatesQueueReader.get().value();
-  // consume an empty routes update because of reachability change.
-  routeUpdatesQueueReader.get().value();
   routesDelta.perfEvents_ref().reset();
   EXPECT_EQ(routesDelta, input);
 
@@ -4216,8 +4610,6 @@ TEST_F(DecisionTestFixture, BasicOperations) {
   sendStaticRoutesUpdate(input);
 
   routesDelta = routeUpdatesQueueReader.get().value();
-  // consume an empty routes update because of reachability change.
-  routeUpdatesQueueReader.get().value();
   routesDelta.perfEvents_ref().reset();
   EXPECT_EQ(routesDelta.mplsRoutesToDelete[0], 32011);
   EXPECT_EQ(routesDelta.mplsRoutesToUpdate.size(), 0);
@@ -4239,8 +4631,6 @@ TEST_F(DecisionTestFixture, BasicOperations) {
   sendStaticRoutesUpdate(input);
 
   routesDelta = routeUpdatesQueueReader.get().value();
-  // consume an empty routes update because of reachability change.
-  routeUpdatesQueueReader.get().value();
   routesDelta.perfEvents_ref().reset();
   EXPECT_EQ(routesDelta, input);
 
@@ -4248,6 +4638,19 @@ TEST_F(DecisionTestFixture, BasicOperations) {
   EXPECT_EQ(staticRoutes.size(), 1);
   EXPECT_THAT(
       staticRoutes[32012], testing::UnorderedElementsAreArray({nh, nh1}));
+
+  // update without change of next-hops is not published, only new one is
+  input.mplsRoutesToUpdate = {route};
+  route.topLabel = 32013;
+  input.mplsRoutesToUpdate.push_back(route);
+  sendStaticRoutesUpdate(input);
+  routesDelta = routeUpdatesQueueReader.get().value();
+  ASSERT_EQ(1, routesDelta.mplsRoutesToUpdate.size());
+  EXPECT_EQ(32013, routesDelta.mplsRoutesToUpdate.at(0).topLabel);
+  EXPECT_EQ(0, routesDelta.mplsRoutesToDelete.size());
+
+  // static routes alone never trigger route computation
+  EXPECT_EQ(0, routeUpdatesQueueReader.size());
 }
 
 // The following topology is used:
@@ -4515,6 +4918,286 @@ TEST_F(DecisionTestFixture, PubDebouncing) {
   EXPECT_EQ(5, counters["decision.route_build_runs.count"]);
 }
 
+//
+// Make sure latency histograms of every route computation stage are exported
+//
+TEST_F(DecisionTestFixture, LatencyHistograms) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12})},
+       {"adj:2", createAdjValue("2", 1, {adj21})},
+       {"prefix:1", createPrefixValue("1", 1, {addr1})},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  recvMyRouteDb("1", serializer);
+
+  const auto counters = fb303::fbData->getCounters();
+  for (auto const& stage :
+       {"publication_ms",
+        "debounce_ms",
+        "spf_ms",
+        "route_build_ms",
+        "route_delta_ms",
+        "route_push_ms"}) {
+    for (auto const& percentile : {"p50", "p99", "p100"}) {
+      const auto key =
+          folly::sformat("decision.latency.{}.{}.60", stage, percentile);
+      EXPECT_EQ(1, counters.count(key)) << key;
+    }
+  }
+}
+
+//
+// Node 1 is part of two areas, R1 - R2 in area A and R1 - R3 in area B.
+// Routes of both areas are merged.
+//
+TEST_F(DecisionTestFixture, MultiAreaRoutes) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21}, false, 2)},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})}},
+      {},
+      {},
+      {},
+      std::string(""),
+      std::string("A"));
+  sendKvPublication(publication);
+  auto routeDbDelta = recvMyRouteDb("1", serializer);
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(addr2, routeDbDelta.unicastRoutesToUpdate[0].dest);
+
+  publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj13}, false, 1)},
+       {"adj:3", createAdjValue("3", 1, {adj31}, false, 3)},
+       {"prefix:3", createPrefixValue("3", 1, {addr3})}},
+      {},
+      {},
+      {},
+      std::string(""),
+      std::string("B"));
+  sendKvPublication(publication);
+  routeDbDelta = recvMyRouteDb("1", serializer);
+  // routes of area A are unchanged
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(addr3, routeDbDelta.unicastRoutesToUpdate[0].dest);
+  EXPECT_EQ(0, routeDbDelta.unicastRoutesToDelete.size());
+  EXPECT_EQ(0, routeDbDelta.mplsRoutesToDelete.size());
+
+  RouteMap routeMap;
+  fillRouteMap("1", routeMap, dumpRouteDb({"1"})["1"]);
+  EXPECT_EQ(
+      routeMap[make_pair("1", toString(addr2))],
+      NextHops({createNextHopFromAdj(adj12, false, 10)}));
+  EXPECT_EQ(
+      routeMap[make_pair("1", toString(addr3))],
+      NextHops({createNextHopFromAdj(adj13, false, 10)}));
+}
+
+//
+// What-if route computation reports delta of simulated drains, leaving live
+// routes untouched
+//
+TEST_F(DecisionTestFixture, RouteDbWhatIf) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12, adj13}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21, adj23}, false, 2)},
+       {"adj:3", createAdjValue("3", 1, {adj31, adj32}, false, 3)},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})},
+       {"prefix:3", createPrefixValue("3", 1, {addr3})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  recvMyRouteDb("1", serializer);
+
+  // drain of link 1-3, given by its end on node 3, moves route via node 2
+  thrift::WhatIfLinkChange linkChange;
+  linkChange.nodeName = "3";
+  linkChange.ifName = "3/1";
+  linkChange.isOverloaded_ref() = true;
+  {
+    thrift::RouteDbWhatIfRequest request;
+    request.linkChanges.emplace_back(linkChange);
+    auto delta = decision->getRouteDbWhatIf(request).get();
+    EXPECT_EQ("1", delta->thisNodeName);
+    EXPECT_EQ(0, delta->unicastRoutesToDelete.size());
+    ASSERT_EQ(1, delta->unicastRoutesToUpdate.size());
+    EXPECT_EQ(addr3, delta->unicastRoutesToUpdate.at(0).dest);
+
+    thrift::RouteDatabase routeDb;
+    routeDb.unicastRoutes = delta->unicastRoutesToUpdate;
+    RouteMap routeMap;
+    fillRouteMap("1", routeMap, routeDb);
+    EXPECT_EQ(
+        routeMap[make_pair("1", toString(addr3))],
+        NextHops({createNextHopFromAdj(adj12, false, 20)}));
+  }
+
+  // drain of node 2 on top of it leaves node 3 unreachable
+  {
+    thrift::RouteDbWhatIfRequest request;
+    request.nodeOverloads.emplace("2", true);
+    request.linkChanges.emplace_back(linkChange);
+    auto delta = decision->getRouteDbWhatIf(request).get();
+    EXPECT_EQ(0, delta->unicastRoutesToUpdate.size());
+    ASSERT_EQ(1, delta->unicastRoutesToDelete.size());
+    EXPECT_EQ(addr3, delta->unicastRoutesToDelete.at(0));
+  }
+
+  // unknown nodes and links are rejected
+  {
+    thrift::RouteDbWhatIfRequest request;
+    request.nodeOverloads.emplace("5", true);
+    EXPECT_THROW(
+        decision->getRouteDbWhatIf(request).get(), std::invalid_argument);
+  }
+  {
+    thrift::RouteDbWhatIfRequest request;
+    linkChange.ifName = "3/5";
+    request.linkChanges.emplace_back(linkChange);
+    EXPECT_THROW(
+        decision->getRouteDbWhatIf(request).get(), std::invalid_argument);
+  }
+
+  // live routes are unchanged
+  RouteMap routeMap;
+  fillRouteMap("1", routeMap, dumpRouteDb({"1"})["1"]);
+  EXPECT_EQ(
+      1,
+      routeMap[make_pair("1", toString(addr3))].count(
+          createNextHopFromAdj(adj13, false, 10)));
+}
+
+//
+// Batch computation of routes of many nodes matches one by one computation
+//
+TEST_F(DecisionTestFixture, DecisionRouteDbs) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12, adj13}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21, adj23}, false, 2)},
+       {"adj:3", createAdjValue("3", 1, {adj31, adj32}, false, 3)},
+       {"prefix:1", createPrefixValue("1", 1, {addr1})},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})},
+       {"prefix:3", createPrefixValue("3", 1, {addr3})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  recvMyRouteDb("1", serializer);
+
+  folly::Synchronized<std::map<std::string, thrift::RouteDatabase>> routeDbs;
+  decision
+      ->getDecisionRouteDbs(
+          {"1", "2", "3", "4"},
+          [&routeDbs](thrift::RouteDatabase routeDb) {
+            auto name = routeDb.thisNodeName;
+            routeDbs.wlock()->emplace(std::move(name), std::move(routeDb));
+          })
+      .get();
+
+  auto expectedRouteDbs = dumpRouteDb({"1", "2", "3", "4"});
+  auto batchRouteDbs = routeDbs.copy();
+  ASSERT_EQ(4, batchRouteDbs.size());
+  for (auto const& kv : batchRouteDbs) {
+    auto const& expected = expectedRouteDbs.at(kv.first);
+    // unknown node has no routes
+    EXPECT_EQ(kv.first == "4", kv.second.unicastRoutes.empty());
+    EXPECT_EQ(expected.unicastRoutes.size(), kv.second.unicastRoutes.size());
+    EXPECT_EQ(expected.mplsRoutes.size(), kv.second.mplsRoutes.size());
+
+    RouteMap expectedRouteMap, routeMap;
+    fillRouteMap(kv.first, expectedRouteMap, expected);
+    fillRouteMap(kv.first, routeMap, kv.second);
+    EXPECT_EQ(expectedRouteMap, routeMap);
+  }
+}
+
+namespace {
+
+// Engine handing out given routes, or failing if there are none
+class FakeRouteComputationEngine : public RouteComputationEngine {
+ public:
+  explicit FakeRouteComputationEngine(
+      std::optional<thrift::RouteDatabase> routeDb)
+      : routeDb_(std::move(routeDb)) {}
+
+  folly::SemiFuture<thrift::RouteDatabase>
+  computeRouteDb(
+      std::string /* nodeName */,
+      std::vector<detail::AreaLsdb> areaLsdbs) override {
+    ++numComputations;
+    numAdjDbs = areaLsdbs.at(0).adjDbs.size();
+    if (not routeDb_.has_value()) {
+      return folly::makeSemiFuture<thrift::RouteDatabase>(
+          std::runtime_error("engine is down"));
+    }
+    return folly::makeSemiFuture(*routeDb_);
+  }
+
+  std::atomic<size_t> numComputations{0};
+  std::atomic<size_t> numAdjDbs{0};
+
+ private:
+  const std::optional<thrift::RouteDatabase> routeDb_;
+};
+
+} // namespace
+
+TEST_F(DecisionTestFixture, RouteComputationEngine) {
+  // routes of engine are used
+  thrift::RouteDatabase engineRouteDb;
+  engineRouteDb.unicastRoutes.emplace_back(
+      createUnicastRoute(addr3, {createNextHopFromAdj(adj12, false, 20)}));
+  auto engine = std::make_shared<FakeRouteComputationEngine>(engineRouteDb);
+  decision->setRouteComputationEngine(engine);
+
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12, adj13}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21, adj23}, false, 2)},
+       {"adj:3", createAdjValue("3", 1, {adj31, adj32}, false, 3)},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})},
+       {"prefix:3", createPrefixValue("3", 1, {addr3})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  auto routeDbDelta = recvMyRouteDb("1", serializer);
+  EXPECT_EQ(1, engine->numComputations);
+  EXPECT_EQ(3, engine->numAdjDbs);
+  EXPECT_EQ(engineRouteDb.unicastRoutes, routeDbDelta.unicastRoutesToUpdate);
+
+  // failing engine falls back to SpfSolver
+  auto failingEngine = std::make_shared<FakeRouteComputationEngine>(
+      std::nullopt /* routeDb */);
+  decision->setRouteComputationEngine(failingEngine);
+  auto adj13Heavy = adj13;
+  adj13Heavy.metric = 30;
+  publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 2, {adj12, adj13Heavy}, false, 1)}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  routeDbDelta = recvMyRouteDb("1", serializer);
+  EXPECT_EQ(1, failingEngine->numComputations);
+  EXPECT_EQ(1, engine->numComputations);
+
+  thrift::RouteDatabase routeDb;
+  routeDb.unicastRoutes = routeDbDelta.unicastRoutesToUpdate;
+  RouteMap routeMap;
+  fillRouteMap("1", routeMap, routeDb);
+  EXPECT_EQ(
+      routeMap[make_pair("1", toString(addr2))],
+      NextHops({createNextHopFromAdj(adj12, false, 10)}));
+}
+
 //
 // Send unrelated key-value pairs to Decision
 // Make sure they do not trigger SPF runs, but rather ignored
@@ -4589,9 +5272,124 @@ TEST_F(DecisionTestFixture, NoSpfOnDuplicatePublication) {
   /* sleep override */
   std::this_thread::sleep_for(2 * debounceTimeoutMax);
 
-  // make sure counter is not incremented
+  // make sure counter is not incremented, none of the values got
+  // deserialized again
   counters = fb303::fbData->getCounters();
   EXPECT_EQ(1, counters["decision.path_build_runs.count"]);
+  EXPECT_EQ(4, counters["decision.skipped_duplicate_key_vals.count"]);
+}
+
+//
+// Metadata and metric vector are only kept for BGP prefix entries
+//
+TEST_F(DecisionTestFixture, DropUnusedPrefixPayload) {
+  fb303::fbData->resetAllData();
+  const auto bgpEntry = createPrefixEntry(
+      addr2,
+      thrift::PrefixType::BGP,
+      "bgp-data",
+      thrift::PrefixForwardingType::IP,
+      thrift::PrefixForwardingAlgorithm::SP_ECMP,
+      std::nullopt,
+      thrift::MetricVector{});
+  auto loopbackEntry = bgpEntry;
+  loopbackEntry.prefix = addr1;
+  loopbackEntry.type = thrift::PrefixType::LOOPBACK;
+
+  sendKvPublication(createThriftPublication(
+      {{"prefix:2",
+        createThriftValue(
+            1,
+            "2",
+            fbzmq::util::writeThriftObjStr(
+                createPrefixDb("2", {loopbackEntry, bgpEntry}), serializer),
+            Constants::kTtlInfinity /* ttl */,
+            0 /* ttl version */,
+            0 /* hash */)}},
+      {},
+      {},
+      {},
+      std::string("")));
+
+  // wait for publication to be processed
+  /* sleep override */
+  std::this_thread::sleep_for(2 * debounceTimeoutMax);
+
+  auto prefixDbs = *decision->getDecisionPrefixDbs().get();
+  ASSERT_EQ(1, prefixDbs.count("2"));
+  auto const& entries = prefixDbs.at("2").prefixEntries;
+  ASSERT_EQ(2, entries.size());
+  for (auto const& entry : entries) {
+    if (entry.type == thrift::PrefixType::BGP) {
+      EXPECT_EQ(bgpEntry, entry);
+    } else {
+      EXPECT_TRUE(entry.data.empty());
+      EXPECT_FALSE(entry.mv_ref().has_value());
+    }
+  }
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(1, counters["decision.prefix_payloads_dropped.count"]);
+}
+
+class DecisionBackgroundComputationFixture : public DecisionTestFixture {
+ protected:
+  openr::thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = getBasicOpenrConfig("1");
+    tConfig.enable_decision_background_computation_ref() = true;
+    return tConfig;
+  }
+};
+
+//
+// Routes computed off decision thread are the same, and publications and
+// queries received meanwhile are applied afterwards
+//
+TEST_F(DecisionBackgroundComputationFixture, BasicOperations) {
+  sendKvPublication(createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21}, false, 2)},
+       {"prefix:1", createPrefixValue("1", 1, {addr1})},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})}},
+      {},
+      {},
+      {},
+      std::string("")));
+  // withdraw prefix of node 2 right away, possibly while computing
+  sendKvPublication(createThriftPublication(
+      {{"prefix:2", createPrefixValue("2", 2, {})}},
+      {},
+      {},
+      {},
+      std::string("")));
+
+  // routes settle with prefix of node 2 withdrawn
+  thrift::RouteDatabase routeDb;
+  do {
+    auto routeDbDelta = recvMyRouteDb("1", serializer);
+    EXPECT_EQ(0, routeDbDelta.mplsRoutesToDelete.size());
+    routeDb = dumpRouteDb({"1"})["1"];
+  } while (not routeDb.unicastRoutes.empty());
+
+  // self mpls route, node 2 mpls route and adj12 label route
+  EXPECT_EQ(3, routeDb.mplsRoutes.size());
+
+  // advertise prefix of node 2 again
+  sendKvPublication(createThriftPublication(
+      {{"prefix:2", createPrefixValue("2", 3, {addr2})}},
+      {},
+      {},
+      {},
+      std::string("")));
+  auto routeDbDelta = recvMyRouteDb("1", serializer);
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(addr2, routeDbDelta.unicastRoutesToUpdate.at(0).dest);
+
+  RouteMap routeMap;
+  fillRouteMap("1", routeMap, dumpRouteDb({"1"})["1"]);
+  EXPECT_EQ(
+      routeMap[make_pair("1", toString(addr2))],
+      NextHops({createNextHopFromAdj(adj12, false, 10)}));
 }
 
 /**
@@ -5028,6 +5826,7 @@ TEST_F(DecisionTestFixture, DecisionSubReliability) {
 
   const int64_t adjUpdateCnt = 1000 /* initial */;
   const int64_t prefixUpdateCnt = totalSent + 1000 /* initial */ + 1 /* end */;
+  StatCounter::flushAll();
   auto counters = fb303::fbData->getCounters();
   EXPECT_EQ(1, counters["decision.path_build_runs.count"]);
   EXPECT_EQ(adjUpdateCnt, counters["decision.adj_db_update.count"]);
@@ -5136,6 +5935,210 @@ TEST_F(DecisionTestFixture, PerPrefixKeyExpiry) {
   EXPECT_EQ(addr5, routeDbDelta.unicastRoutesToDelete.at(0));
 }
 
+//
+// Node 2 gone, along with all of its keys. Expiry reporting it as originator
+// without any key left must remove all of its routes at once.
+//
+TEST_F(DecisionTestFixture, ExpiredOriginators) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12})},
+       {"adj:2", createAdjValue("2", 1, {adj21})},
+       {"prefix:1", createPrefixValue("1", 1, {addr1})},
+       {"prefix:2", createPrefixValue("2", 1, {addr2, addr5})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  auto routeDbDelta = recvMyRouteDb("1", serializer);
+  EXPECT_EQ(2, routeDbDelta.unicastRoutesToUpdate.size());
+
+  publication = createThriftPublication(
+      {}, {"adj:2", "prefix:2"}, {}, {}, std::string(""));
+  publication.expiredOriginators_ref() = std::vector<std::string>{"2"};
+  sendKvPublication(publication);
+  routeDbDelta = recvMyRouteDb("1", serializer);
+  EXPECT_EQ(0, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(2, routeDbDelta.unicastRoutesToDelete.size());
+  EXPECT_EQ(0, dumpRouteDb({"1"})["1"].unicastRoutes.size());
+}
+
+//
+// Node 1 advertises its adjacency in per adjacency key, on top of adjacency
+// db key with node attributes only. Withdraw and expiry of per adjacency key
+// must remove the adjacency.
+//
+TEST_F(DecisionTestFixture, PerAdjacencyKeys) {
+  const auto adjKey12 = getPerAdjacencyKey(
+      Constants::kAdjDbMarker.toString(),
+      "1",
+      adj12.otherNodeName,
+      adj12.ifName);
+  auto publication0 = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {})},
+       {adjKey12, createAdjValue("1", 1, {adj12})},
+       {"adj:2", createAdjValue("2", 1, {adj21})},
+       {"prefix:1", createPrefixValue("1", 1, {addr1})},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication0);
+  auto routeDbDelta = recvMyRouteDb("1", serializer);
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(addr2, routeDbDelta.unicastRoutesToUpdate.at(0).dest);
+  EXPECT_EQ(
+      NextHops({createNextHopFromAdj(adj12, false, 10)}),
+      NextHops(
+          routeDbDelta.unicastRoutesToUpdate.at(0).nextHops.begin(),
+          routeDbDelta.unicastRoutesToUpdate.at(0).nextHops.end()));
+
+  // withdraw per adjacency key, route must be deleted
+  auto publication = createThriftPublication(
+      {{adjKey12, createAdjValue("1", 2, {})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  routeDbDelta = recvMyRouteDb("1", serializer);
+  EXPECT_EQ(0, routeDbDelta.unicastRoutesToUpdate.size());
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToDelete.size());
+  EXPECT_EQ(addr2, routeDbDelta.unicastRoutesToDelete.at(0));
+
+  // re-add and expire per adjacency key
+  sendKvPublication(publication0);
+  routeDbDelta = recvMyRouteDb("1", serializer);
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+
+  publication =
+      createThriftPublication({}, {adjKey12}, {}, {}, std::string(""));
+  sendKvPublication(publication);
+  routeDbDelta = recvMyRouteDb("1", serializer);
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToDelete.size());
+  EXPECT_EQ(addr2, routeDbDelta.unicastRoutesToDelete.at(0));
+}
+
+class DecisionAreaSummaryFixture : public DecisionTestFixture {
+ protected:
+  openr::thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = getBasicOpenrConfig("1");
+    thrift::AreaConfig areaA;
+    areaA.area_id = "A";
+    areaA.neighbor_regexes = {".*"};
+    areaA.summary_prefixes = {"::ffff:10.0.0.0/104", "fc00:cafe::/32"};
+    thrift::AreaConfig areaB;
+    areaB.area_id = "B";
+    areaB.neighbor_regexes = {".*"};
+    tConfig.areas = {areaA, areaB};
+    return tConfig;
+  }
+};
+
+//
+// Border node advertises summary of area A while a node reachable in area A
+// advertises a prefix covered by it. Prefixes of border node itself don't
+// keep summary advertised
+//
+TEST_F(DecisionAreaSummaryFixture, AreaSummary) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21}, false, 2)},
+       {"prefix:1", createPrefixValue("1", 1, {addr1})},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})}},
+      {},
+      {},
+      {},
+      std::string(""),
+      std::string("A"));
+  sendKvPublication(publication);
+  recvMyRouteDb("1", serializer);
+
+  {
+    auto maybeUpdate = prefixUpdatesQueueReader.get();
+    ASSERT_FALSE(maybeUpdate.hasError());
+    auto const& update = maybeUpdate.value();
+    EXPECT_EQ(thrift::PrefixUpdateCommand::SYNC_PREFIXES_BY_TYPE, update.cmd);
+    EXPECT_EQ(thrift::PrefixType::AREA_SUMMARY, update.type_ref().value());
+    ASSERT_EQ(1, update.prefixes.size());
+    EXPECT_EQ(toIpPrefix("::ffff:10.0.0.0/104"), update.prefixes.at(0).prefix);
+    EXPECT_EQ(thrift::PrefixType::AREA_SUMMARY, update.prefixes.at(0).type);
+  }
+
+  // component of node 2 is withdrawn, summary too
+  publication = createThriftPublication(
+      {}, {"prefix:2"}, {}, {}, std::string(""), std::string("A"));
+  sendKvPublication(publication);
+  recvMyRouteDb("1", serializer);
+
+  {
+    auto maybeUpdate = prefixUpdatesQueueReader.get();
+    ASSERT_FALSE(maybeUpdate.hasError());
+    EXPECT_EQ(
+        thrift::PrefixType::AREA_SUMMARY, maybeUpdate->type_ref().value());
+    EXPECT_TRUE(maybeUpdate->prefixes.empty());
+  }
+  EXPECT_EQ(0, prefixUpdatesQueueReader.size());
+}
+
+class DecisionColdStartFixture : public DecisionTestFixture {
+ protected:
+  openr::thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = getBasicOpenrConfig("1");
+    tConfig.eor_time_s_ref() = 3600;
+    tConfig.enable_decision_background_computation_ref() = true;
+    return tConfig;
+  }
+};
+
+//
+// Routes computed during cold start are held back till KvStore is done with
+// initial sync, and published at once then instead of after eor_time_s
+//
+TEST_F(DecisionColdStartFixture, InitialSyncDone) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21}, false, 2)},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+
+  // routes are computed past debounce, but not published
+  std::this_thread::sleep_for(2 * debounceTimeoutMax);
+  EXPECT_EQ(0, routeUpdatesQueueReader.size());
+
+  // initial sync of other areas is ignored
+  thrift::Publication syncDone;
+  syncDone.area = "other";
+  syncDone.initialSyncDone_ref() = true;
+  sendKvPublication(syncDone);
+  syncDone.area = thrift::KvStore_constants::kDefaultArea();
+  sendKvPublication(syncDone);
+
+  auto routeDbDelta = recvMyRouteDb("1", serializer);
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(addr2, routeDbDelta.unicastRoutesToUpdate.at(0).dest);
+  EXPECT_EQ(0, routeUpdatesQueueReader.size());
+
+  // updates are published right away after cold start
+  publication = createThriftPublication(
+      {{"prefix:2", createPrefixValue("2", 2, {addr2, addr3})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  routeDbDelta = recvMyRouteDb("1", serializer);
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(addr3, routeDbDelta.unicastRoutesToUpdate.at(0).dest);
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -182,6 +184,276 @@ TEST(LinkStateTest, BasicOperation) {
   EXPECT_THROW(state.removeLink(l1), std::out_of_range);
 }
 
+TEST(LinkStateTest, OrderedLinks) {
+  std::string n1 = "node1";
+  std::string n2 = "node2";
+  std::string n3 = "node3";
+  auto adj12 =
+      openr::createAdjacency(n2, "if2", "if1", "fe80::2", "10.0.0.2", 1, 1, 1);
+  auto adj21 =
+      openr::createAdjacency(n1, "if1", "if2", "fe80::1", "10.0.0.1", 1, 1, 1);
+  auto adj13 =
+      openr::createAdjacency(n3, "if3", "if1", "fe80::3", "10.0.0.3", 1, 1, 1);
+  auto adj31 =
+      openr::createAdjacency(n1, "if1", "if3", "fe80::1", "10.0.0.1", 1, 1, 1);
+  auto adj12b =
+      openr::createAdjacency(n2, "if4", "if3", "fe80::2", "10.0.0.2", 1, 1, 1);
+  auto adj21b =
+      openr::createAdjacency(n1, "if3", "if4", "fe80::1", "10.0.0.1", 1, 1, 1);
+
+  auto l1 = std::make_shared<openr::Link>(n1, adj12, n2, adj21);
+  auto l2 = std::make_shared<openr::Link>(n3, adj31, n1, adj13);
+  auto l3 = std::make_shared<openr::Link>(n1, adj12b, n2, adj21b);
+
+  // links of a node are kept ordered whatever order they are added in
+  openr::LinkState state;
+  state.addLink(l2);
+  state.addLink(l3);
+  state.addLink(l1);
+  auto const isOrdered = [](auto const& links) {
+    return std::is_sorted(
+        links.begin(), links.end(), openr::LinkState::LinkPtrLess{});
+  };
+  EXPECT_THAT(
+      state.orderedLinksFromNode(n1),
+      testing::UnorderedElementsAre(l1, l2, l3));
+  EXPECT_TRUE(isOrdered(state.orderedLinksFromNode(n1)));
+  EXPECT_THAT(
+      state.orderedLinksFromNode(n2), testing::UnorderedElementsAre(l1, l3));
+  EXPECT_TRUE(isOrdered(state.orderedLinksFromNode(n2)));
+  // same containers are handed out without copies
+  EXPECT_EQ(&state.linksFromNode(n1), &state.orderedLinksFromNode(n1));
+
+  state.removeLink(l3);
+  EXPECT_THAT(
+      state.orderedLinksFromNode(n1), testing::UnorderedElementsAre(l1, l2));
+  EXPECT_TRUE(isOrdered(state.orderedLinksFromNode(n1)));
+  EXPECT_THAT(state.orderedLinksFromNode(n2), testing::ElementsAre(l1));
+  EXPECT_THAT(state.orderedLinksFromNode("node4"), testing::IsEmpty());
+}
+
+TEST(LinkStateTest, NodeIds) {
+  std::string n1 = "node1";
+  auto adj12 =
+      openr::createAdjacency(n1, "if2", "if1", "fe80::2", "10.0.0.2", 1, 1, 1);
+  std::string n2 = "node2";
+  auto adj21 =
+      openr::createAdjacency(n2, "if1", "if2", "fe80::1", "10.0.0.1", 2, 1, 1);
+  auto l1 = std::make_shared<openr::Link>(n1, adj12, n2, adj21);
+
+  openr::LinkState state;
+  EXPECT_FALSE(state.getNodeId(n1).has_value());
+  EXPECT_EQ(0, state.getNodeIdCount());
+
+  state.addLink(l1);
+  EXPECT_EQ(2, state.getNodeIdCount());
+  auto const id1 = state.getNodeId(n1).value();
+  auto const id2 = state.getNodeId(n2).value();
+  EXPECT_NE(id1, id2);
+  EXPECT_EQ(n1, state.getNodeName(id1));
+  EXPECT_EQ(n2, state.getNodeName(id2));
+  EXPECT_EQ(id2, l1->getOtherNodeId(id1));
+  EXPECT_EQ(id1, l1->getOtherNodeId(id2));
+  EXPECT_EQ(1, l1->getMetricFromNodeId(id1));
+  EXPECT_EQ(2, l1->getMetricFromNodeId(id2));
+  EXPECT_THAT(state.linksFromNodeId(id1), testing::UnorderedElementsAre(l1));
+  EXPECT_THAT(state.linksFromNodeId(id2), testing::UnorderedElementsAre(l1));
+
+  EXPECT_FALSE(state.updateNodeOverloaded(n1, true, 0, 0));
+  EXPECT_TRUE(state.isNodeIdOverloaded(id1));
+  EXPECT_FALSE(state.isNodeIdOverloaded(id2));
+
+  // ids stay assigned when node goes away and are reused when it comes back
+  state.removeNode(n1);
+  EXPECT_THAT(state.linksFromNodeId(id1), testing::IsEmpty());
+  EXPECT_THAT(state.linksFromNodeId(id2), testing::IsEmpty());
+  EXPECT_FALSE(state.isNodeIdOverloaded(id1));
+  EXPECT_EQ(id1, state.getNodeId(n1).value());
+
+  auto l2 = std::make_shared<openr::Link>(n1, adj12, n2, adj21);
+  state.addLink(l2);
+  EXPECT_EQ(2, state.getNodeIdCount());
+  EXPECT_EQ(id1, state.getNodeId(n1).value());
+  EXPECT_THAT(state.linksFromNodeId(id1), testing::UnorderedElementsAre(l2));
+}
+
+TEST(LinkStateTest, AdjacencySnapshot) {
+  std::string n1 = "node1";
+  auto adj12 =
+      openr::createAdjacency(n1, "if2", "if1", "fe80::2", "10.0.0.2", 1, 1, 1);
+  auto adj13 =
+      openr::createAdjacency(n1, "if3", "if1", "fe80::3", "10.0.0.3", 3, 1, 1);
+  std::string n2 = "node2";
+  auto adj21 =
+      openr::createAdjacency(n2, "if1", "if2", "fe80::1", "10.0.0.1", 2, 1, 1);
+  std::string n3 = "node3";
+  auto adj31 =
+      openr::createAdjacency(n3, "if1", "if3", "fe80::1", "10.0.0.1", 4, 1, 1);
+  auto l1 = std::make_shared<openr::Link>(n1, adj12, n2, adj21);
+  auto l2 = std::make_shared<openr::Link>(n1, adj13, n3, adj31);
+
+  openr::LinkState state;
+  EXPECT_TRUE(state.getAdjacencySnapshot().edges.empty());
+
+  state.addLink(l1);
+  state.addLink(l2);
+  auto const id1 = state.getNodeId(n1).value();
+  auto const id2 = state.getNodeId(n2).value();
+  auto const id3 = state.getNodeId(n3).value();
+
+  using Edge = openr::LinkState::AdjacencySnapshot::Edge;
+  using NodeMetric = std::pair<openr::NodeId, openr::LinkStateMetric>;
+  auto const edgeTuples = [](folly::Range<const Edge*> edges) {
+    std::vector<NodeMetric> res;
+    for (auto const& edge : edges) {
+      res.emplace_back(edge.neighborId, edge.metric);
+    }
+    return res;
+  };
+  {
+    auto const& snapshot = state.getAdjacencySnapshot();
+    EXPECT_EQ(4, snapshot.edges.size());
+    EXPECT_EQ(2, snapshot.links.size());
+    EXPECT_THAT(
+        edgeTuples(snapshot.edgesFromNodeId(id1)),
+        testing::UnorderedElementsAre(NodeMetric(id2, 1), NodeMetric(id3, 3)));
+    EXPECT_THAT(
+        edgeTuples(snapshot.edgesFromNodeId(id2)),
+        testing::ElementsAre(NodeMetric(id1, 2)));
+    EXPECT_THAT(
+        edgeTuples(snapshot.edgesFromNodeId(id3)),
+        testing::ElementsAre(NodeMetric(id1, 4)));
+    EXPECT_FALSE(snapshot.isNodeIdOverloaded(id1));
+  }
+
+  // snapshot is rebuilt once topology changes
+  EXPECT_FALSE(state.updateNodeOverloaded(n2, true, 0, 0));
+  EXPECT_TRUE(state.getAdjacencySnapshot().isNodeIdOverloaded(id2));
+
+  state.removeLink(l2);
+  {
+    auto const& snapshot = state.getAdjacencySnapshot();
+    EXPECT_EQ(2, snapshot.edges.size());
+    EXPECT_THAT(snapshot.links, testing::ElementsAre(l1));
+    EXPECT_TRUE(snapshot.edgesFromNodeId(id3).empty());
+    // node without any id when snapshot was built
+    EXPECT_TRUE(snapshot.edgesFromNodeId(id3 + 1).empty());
+  }
+}
+
+TEST(LinkStateTest, Holds) {
+  std::string n1 = "node1";
+  auto adj12 =
+      openr::createAdjacency(n1, "if2", "if1", "fe80::2", "10.0.0.2", 1, 1, 1);
+  auto adj13 =
+      openr::createAdjacency(n1, "if3", "if1", "fe80::3", "10.0.0.3", 1, 1, 1);
+  std::string n2 = "node2";
+  auto adj21 =
+      openr::createAdjacency(n2, "if1", "if2", "fe80::1", "10.0.0.1", 1, 1, 1);
+  std::string n3 = "node3";
+  auto adj31 =
+      openr::createAdjacency(n3, "if1", "if3", "fe80::1", "10.0.0.1", 1, 1, 1);
+  auto l1 = std::make_shared<openr::Link>(n1, adj12, n2, adj21);
+  auto l2 = std::make_shared<openr::Link>(n1, adj13, n3, adj31);
+
+  openr::LinkState state;
+  state.addLink(l1);
+  EXPECT_FALSE(state.hasHolds());
+  EXPECT_FALSE(state.decrementHolds());
+
+  // only link being held is changed on hold expiry
+  l2->setHoldUpTtl(2);
+  state.addLink(l2);
+  EXPECT_TRUE(state.hasHolds());
+  EXPECT_FALSE(l2->isUp());
+  auto version = state.getTopologyVersion();
+  EXPECT_FALSE(state.decrementHolds());
+  EXPECT_TRUE(state.hasHolds());
+  EXPECT_TRUE(state.decrementHolds());
+  EXPECT_TRUE(l2->isUp());
+  EXPECT_FALSE(state.hasHolds());
+  EXPECT_THAT(
+      state.getTopologyChangesSince(version).value(),
+      testing::ElementsAre(std::make_pair(n1, n3)));
+
+  // node overload hold
+  EXPECT_FALSE(state.updateNodeOverloaded(n2, true, 0, 0));
+  EXPECT_FALSE(state.updateNodeOverloaded(n2, false, 1, 1));
+  EXPECT_TRUE(state.hasHolds());
+  EXPECT_TRUE(state.isNodeOverloaded(n2));
+  EXPECT_TRUE(state.decrementHolds());
+  EXPECT_FALSE(state.isNodeOverloaded(n2));
+  EXPECT_FALSE(state.hasHolds());
+
+  // holds of removed links are dropped
+  l1->setHoldUpTtl(1);
+  state.removeLink(l1);
+  state.addLink(l1);
+  EXPECT_TRUE(state.hasHolds());
+  state.removeNode(n2);
+  EXPECT_FALSE(state.hasHolds());
+  EXPECT_FALSE(state.decrementHolds());
+}
+
+TEST(LinkStateTest, UpdateAdjacencyDatabase) {
+  std::string n1 = "node1";
+  std::string n2 = "node2";
+  std::string n3 = "node3";
+  auto adj12 =
+      openr::createAdjacency(n2, "if2", "if1", "fe80::2", "10.0.0.2", 1, 1, 1);
+  auto adj13 =
+      openr::createAdjacency(n3, "if3", "if1", "fe80::3", "10.0.0.3", 1, 1, 1);
+  auto adj21 =
+      openr::createAdjacency(n1, "if1", "if2", "fe80::1", "10.0.0.1", 1, 1, 1);
+  auto adj31 =
+      openr::createAdjacency(n1, "if1", "if3", "fe80::1", "10.0.0.1", 1, 1, 1);
+
+  openr::LinkState state;
+  EXPECT_FALSE(
+      state.updateAdjacencyDatabase(openr::createAdjDb(n2, {adj21}, 2), 0, 0)
+          .first);
+  EXPECT_FALSE(
+      state.updateAdjacencyDatabase(openr::createAdjDb(n3, {adj31}, 3), 0, 0)
+          .first);
+  EXPECT_TRUE(state
+                  .updateAdjacencyDatabase(
+                      openr::createAdjDb(n1, {adj12, adj13}, 1), 0, 0)
+                  .first);
+  ASSERT_EQ(2, state.numLinks());
+  auto const links = state.linksFromNode(n1);
+  auto const link12 = state.linksFromNode(n2).at(0);
+  auto const link13 = state.linksFromNode(n3).at(0);
+
+  // same database again changes nothing
+  EXPECT_EQ(
+      std::make_pair(false, false),
+      state.updateAdjacencyDatabase(
+          openr::createAdjDb(n1, {adj12, adj13}, 1), 0, 0));
+  EXPECT_EQ(links, state.linksFromNode(n1));
+
+  // metric change of one adjacency is applied on the link in place, other
+  // links are left alone
+  adj12.metric = 5;
+  auto version = state.getTopologyVersion();
+  EXPECT_TRUE(state
+                  .updateAdjacencyDatabase(
+                      openr::createAdjDb(n1, {adj13, adj12}, 1), 0, 0)
+                  .first);
+  EXPECT_EQ(links, state.linksFromNode(n1));
+  EXPECT_EQ(5, link12->getMetricFromNode(n1));
+  EXPECT_EQ(1, link13->getMetricFromNode(n1));
+  EXPECT_THAT(
+      state.getTopologyChangesSince(version).value(),
+      testing::ElementsAre(std::make_pair(n1, n2)));
+
+  // adjacency removal takes its link down only
+  EXPECT_TRUE(
+      state.updateAdjacencyDatabase(openr::createAdjDb(n1, {adj13}, 1), 0, 0)
+          .first);
+  EXPECT_THAT(state.linksFromNode(n1), testing::ElementsAre(link13));
+  EXPECT_TRUE(state.linksFromNode(n2).empty());
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
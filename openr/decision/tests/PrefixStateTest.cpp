@@ -32,7 +32,7 @@ class PrefixStateTestFixture : public ::testing::Test {
     for (size_t i = 0; i < numNodes; ++i) {
       std::string nodeName = std::to_string(i);
       prefixDbs_[nodeName] = createPrefixDbForNode(nodeName, i);
-      EXPECT_TRUE(state_.updatePrefixDatabase(prefixDbs_[nodeName]));
+      EXPECT_FALSE(state_.updatePrefixDatabase(prefixDbs_[nodeName]).empty());
     }
   }
 
@@ -53,30 +53,33 @@ class PrefixStateTestFixture : public ::testing::Test {
 TEST_F(PrefixStateTestFixture, basicOperation) {
   EXPECT_EQ(state_.getPrefixDatabases(), prefixDbs_);
   auto const dbEntry = *prefixDbs_.begin();
-  EXPECT_FALSE(state_.updatePrefixDatabase(dbEntry.second));
+  EXPECT_TRUE(state_.updatePrefixDatabase(dbEntry.second).empty());
 
   auto prefixDb1Updated = dbEntry.second;
   prefixDb1Updated.prefixEntries.at(0).type = thrift::PrefixType::BREEZE;
-  EXPECT_TRUE(state_.updatePrefixDatabase(prefixDb1Updated));
-  EXPECT_FALSE(state_.updatePrefixDatabase(prefixDb1Updated));
+  EXPECT_THAT(
+      state_.updatePrefixDatabase(prefixDb1Updated),
+      testing::UnorderedElementsAre(
+          prefixDb1Updated.prefixEntries.at(0).prefix));
+  EXPECT_TRUE(state_.updatePrefixDatabase(prefixDb1Updated).empty());
   EXPECT_EQ(prefixDb1Updated, state_.getPrefixDatabases().at(dbEntry.first));
 
   prefixDb1Updated.prefixEntries.at(0).forwardingType =
       thrift::PrefixForwardingType::SR_MPLS;
-  EXPECT_TRUE(state_.updatePrefixDatabase(prefixDb1Updated));
-  EXPECT_FALSE(state_.updatePrefixDatabase(prefixDb1Updated));
+  EXPECT_FALSE(state_.updatePrefixDatabase(prefixDb1Updated).empty());
+  EXPECT_TRUE(state_.updatePrefixDatabase(prefixDb1Updated).empty());
   EXPECT_EQ(prefixDb1Updated, state_.getPrefixDatabases().at(dbEntry.first));
 
   thrift::PrefixDatabase emptyPrefixDb;
   emptyPrefixDb.thisNodeName = dbEntry.first;
-  EXPECT_TRUE(state_.updatePrefixDatabase(emptyPrefixDb));
+  EXPECT_FALSE(state_.updatePrefixDatabase(emptyPrefixDb).empty());
   auto modifiedPrefixDbs = prefixDbs_;
   modifiedPrefixDbs.erase(dbEntry.first);
   EXPECT_NE(prefixDbs_, modifiedPrefixDbs);
   EXPECT_EQ(state_.getPrefixDatabases(), modifiedPrefixDbs);
   emptyPrefixDb.thisNodeName = dbEntry.first;
-  EXPECT_FALSE(state_.updatePrefixDatabase(emptyPrefixDb));
-  EXPECT_TRUE(state_.updatePrefixDatabase(dbEntry.second));
+  EXPECT_TRUE(state_.updatePrefixDatabase(emptyPrefixDb).empty());
+  EXPECT_FALSE(state_.updatePrefixDatabase(dbEntry.second).empty());
 }
 
 class GetLoopbackViasTest : public PrefixStateTestFixture,
@@ -139,7 +142,7 @@ TEST_F(PrefixStateTestFixture, getNodeHostLoopbacksV4) {
 
   thrift::PrefixDatabase emptyPrefixDb;
   emptyPrefixDb.thisNodeName = "0";
-  EXPECT_TRUE(state_.updatePrefixDatabase(emptyPrefixDb));
+  EXPECT_FALSE(state_.updatePrefixDatabase(emptyPrefixDb).empty());
   EXPECT_THAT(
       state_.getNodeHostLoopbacksV4(), testing::UnorderedElementsAre(pair2));
 }
@@ -155,7 +158,7 @@ TEST_F(PrefixStateTestFixture, getNodeHostLoopbacksV6) {
 
   thrift::PrefixDatabase emptyPrefixDb;
   emptyPrefixDb.thisNodeName = "0";
-  EXPECT_TRUE(state_.updatePrefixDatabase(emptyPrefixDb));
+  EXPECT_FALSE(state_.updatePrefixDatabase(emptyPrefixDb).empty());
   EXPECT_THAT(
       state_.getNodeHostLoopbacksV6(), testing::UnorderedElementsAre(pair2));
 }
@@ -196,12 +199,12 @@ TEST_P(LoopbackTestWithParam, AddRemoveLoopbackV4orV6) {
   thrift::PrefixDatabase emptyPrefixDb;
   emptyPrefixDb.thisNodeName = "0";
   emptyPrefixDb.prefixEntries = {node0LB, p1};
-  EXPECT_TRUE(state_.updatePrefixDatabase(emptyPrefixDb));
+  EXPECT_FALSE(state_.updatePrefixDatabase(emptyPrefixDb).empty());
 
   // withdraw loopback and p1, announcing p2, expect no loopback is there
   // anymore
   emptyPrefixDb.prefixEntries = {p2};
-  EXPECT_TRUE(state_.updatePrefixDatabase(emptyPrefixDb));
+  EXPECT_FALSE(state_.updatePrefixDatabase(emptyPrefixDb).empty());
   if (isV4) {
     EXPECT_THAT(
         state_.getNodeHostLoopbacksV4(), testing::UnorderedElementsAre(pair2));
@@ -214,6 +217,60 @@ TEST_P(LoopbackTestWithParam, AddRemoveLoopbackV4orV6) {
 
 INSTANTIATE_TEST_CASE_P(LoopbackTest, LoopbackTestWithParam, ::testing::Bool());
 
+TEST(PrefixStateTest, PrefixLimit) {
+  std::vector<thrift::PrefixEntry> prefixEntries;
+  for (size_t i = 1; i <= 4; ++i) {
+    prefixEntries.emplace_back(createPrefixEntry(
+        toIpPrefix(folly::sformat("10.0.0.{}/32", i)),
+        thrift::PrefixType::LOOPBACK));
+  }
+  auto const overLimitDb = createPrefixDb("node-1", prefixEntries);
+  auto const underLimitDb = createPrefixDb(
+      "node-1", {prefixEntries.at(prefixEntries.size() - 1)});
+  auto const otherDb = createPrefixDb("node-2", {prefixEntries.at(0)});
+
+  // prefixes up to limit are taken, in order advertised
+  {
+    PrefixState state(2);
+    EXPECT_EQ(1, state.updatePrefixDatabase(otherDb).size());
+    EXPECT_EQ(2, state.updatePrefixDatabase(overLimitDb).size());
+    EXPECT_EQ(2, state.getNumIgnoredPrefixes());
+    EXPECT_THAT(
+        state.getNodesOverPrefixLimit(), testing::ElementsAre("node-1"));
+    EXPECT_EQ(2, state.prefixes().size());
+    EXPECT_EQ(2, state.prefixes().at(prefixEntries.at(0).prefix).size());
+    EXPECT_EQ(1, state.prefixes().at(prefixEntries.at(1).prefix).size());
+
+    // same prefix database is no change
+    EXPECT_TRUE(state.updatePrefixDatabase(overLimitDb).empty());
+
+    // back under limit
+    EXPECT_EQ(3, state.updatePrefixDatabase(underLimitDb).size());
+    EXPECT_EQ(0, state.getNumIgnoredPrefixes());
+    EXPECT_TRUE(state.getNodesOverPrefixLimit().empty());
+    EXPECT_EQ(2, state.prefixes().size());
+  }
+
+  // no prefix is taken from node over limit
+  {
+    PrefixState state(2, thrift::PrefixLimitAction::IGNORE_ALL);
+    EXPECT_EQ(1, state.updatePrefixDatabase(otherDb).size());
+    EXPECT_TRUE(state.updatePrefixDatabase(overLimitDb).empty());
+    EXPECT_EQ(4, state.getNumIgnoredPrefixes());
+    EXPECT_THAT(
+        state.getNodesOverPrefixLimit(), testing::ElementsAre("node-1"));
+    EXPECT_EQ(1, state.prefixes().size());
+    EXPECT_EQ(0, state.getPrefixDatabases().count("node-1"));
+
+    EXPECT_EQ(1, state.updatePrefixDatabase(underLimitDb).size());
+    EXPECT_TRUE(state.getNodesOverPrefixLimit().empty());
+    EXPECT_EQ(2, state.prefixes().size());
+    EXPECT_EQ(
+        state.getPrefixDatabases().at("node-1").prefixEntries,
+        underLimitDb.prefixEntries);
+  }
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -70,8 +70,13 @@ Dual::Dual(
         const std::optional<std::string>& newNh)> nexthopChangeCb)
     : nodeId(nodeId),
       rootId(rootId),
-      localDistances_(localDistance),
       nexthopCb_(std::move(nexthopChangeCb)) {
+  for (const auto& kv : localDistance) {
+    auto& entry = getNeighbor(kv.first);
+    entry.localDistance = kv.second;
+    entry.hasLocalDistance = true;
+  }
+
   // set distance to 0 if I'm the root, otherwise default to inf
   if (rootId == nodeId) {
     info_.distance = 0;
@@ -81,6 +86,26 @@ Dual::Dual(
   }
 }
 
+Dual::NeighborEntry&
+Dual::getNeighbor(const std::string& neighbor) {
+  auto it = neighborIndex_.find(neighbor);
+  if (it != neighborIndex_.end()) {
+    return neighbors_[it->second];
+  }
+  neighborIndex_.emplace(neighbor, neighbors_.size());
+  neighbors_.emplace_back(neighbor);
+  return neighbors_.back();
+}
+
+const Dual::NeighborEntry*
+Dual::findNeighbor(const std::string& neighbor) const {
+  auto it = neighborIndex_.find(neighbor);
+  if (it == neighborIndex_.end()) {
+    return nullptr;
+  }
+  return &neighbors_[it->second];
+}
+
 int64_t
 Dual::getMinDistance() {
   if (nodeId == rootId) {
@@ -88,17 +113,18 @@ Dual::getMinDistance() {
     return 0;
   }
   int64_t dmin = std::numeric_limits<int64_t>::max();
-  for (const auto& kv : localDistances_) {
-    const auto& ld = kv.second;
-    const auto& rd = info_.neighborInfos[kv.first].reportDistance;
-    dmin = std::min(dmin, addDistances(ld, rd));
+  for (const auto& entry : neighbors_) {
+    dmin = std::min(
+        dmin, addDistances(entry.localDistance, entry.info.reportDistance));
   }
   return dmin;
 }
 
 bool
 Dual::routeAffected() {
-  if (localDistances_.size() == 0) {
+  if (std::none_of(neighbors_.begin(), neighbors_.end(), [](const auto& e) {
+        return e.hasLocalDistance;
+      })) {
     // no neighbor
     return false;
   }
@@ -122,13 +148,10 @@ Dual::routeAffected() {
   }
 
   std::unordered_set<std::string> nexthops;
-  for (const auto& kv : localDistances_) {
-    const auto& neighbor = kv.first;
-    const auto& ld = kv.second;
-    const auto& rd = info_.neighborInfos[neighbor].reportDistance;
-    int64_t d = addDistances(ld, rd);
+  for (const auto& entry : neighbors_) {
+    int64_t d = addDistances(entry.localDistance, entry.info.reportDistance);
     if (d == dmin) {
-      nexthops.emplace(neighbor);
+      nexthops.emplace(entry.id);
     }
   }
 
@@ -149,18 +172,17 @@ bool
 Dual::meetFeasibleCondition(std::string& nexthop, int64_t& distance) {
   int64_t dmin = getMinDistance();
   // find feasible nexthop according to SNC(source node condition)
-  for (const auto& kv : localDistances_) {
-    const auto& neighbor = kv.first;
-    const auto& ld = kv.second;
+  for (const auto& entry : neighbors_) {
+    const auto& ld = entry.localDistance;
     if (ld == std::numeric_limits<int64_t>::max()) {
       // skip down neighbor
       continue;
     }
-    const auto& rd = info_.neighborInfos[neighbor].reportDistance;
+    const auto& rd = entry.info.reportDistance;
     if (rd < info_.feasibleDistance and addDistances(ld, rd) == dmin) {
-      VLOG(2) << rootId << "::" << nodeId << ": meet FC: " << neighbor << ", "
+      VLOG(2) << rootId << "::" << nodeId << ": meet FC: " << entry.id << ", "
               << rd << ", " << dmin;
-      nexthop = neighbor;
+      nexthop = entry.id;
       distance = dmin;
       return true;
     }
@@ -168,6 +190,43 @@ Dual::meetFeasibleCondition(std::string& nexthop, int64_t& distance) {
   return false;
 }
 
+bool
+Dual::findFeasibleSuccessor(std::string& nexthop, int64_t& distance) {
+  if (info_.nexthop.has_value()) {
+    if (*info_.nexthop == nodeId) {
+      // I'm the root
+      return false;
+    }
+    const auto entry = findNeighbor(*info_.nexthop);
+    if (entry != nullptr and
+        addDistances(entry->localDistance, entry->info.reportDistance) !=
+            std::numeric_limits<int64_t>::max()) {
+      // nexthop still has a route
+      return false;
+    }
+  }
+
+  int64_t dmin = std::numeric_limits<int64_t>::max();
+  for (const auto& entry : neighbors_) {
+    const auto& rd = entry.info.reportDistance;
+    if (rd >= info_.feasibleDistance) {
+      continue;
+    }
+    int64_t d = addDistances(entry.localDistance, rd);
+    if (d < dmin) {
+      dmin = d;
+      nexthop = entry.id;
+    }
+  }
+  if (dmin == std::numeric_limits<int64_t>::max()) {
+    return false;
+  }
+  VLOG(2) << rootId << "::" << nodeId << ": feasible successor: " << nexthop
+          << ", " << dmin;
+  distance = dmin;
+  return true;
+}
+
 void
 Dual::floodUpdates(
     std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
@@ -176,9 +235,9 @@ Dual::floodUpdates(
   msg.distance = info_.reportDistance;
   msg.type = thrift::DualMessageType::UPDATE;
 
-  for (const auto& kv : localDistances_) {
-    const auto& neighbor = kv.first;
-    if (kv.second == std::numeric_limits<int64_t>::max()) {
+  for (const auto& entry : neighbors_) {
+    const auto& neighbor = entry.id;
+    if (entry.localDistance == std::numeric_limits<int64_t>::max()) {
       // skip down neighbor
       continue;
     }
@@ -214,9 +273,9 @@ bool
 Dual::diffusingComputation(
     std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
   // maintain current nexthop, update other fields
-  auto ld = localDistances_[*info_.nexthop];
-  auto rd = info_.neighborInfos[*info_.nexthop].reportDistance;
-  int64_t newDistance = addDistances(ld, rd);
+  const auto& nexthop = getNeighbor(*info_.nexthop);
+  int64_t newDistance =
+      addDistances(nexthop.localDistance, nexthop.info.reportDistance);
   info_.distance = newDistance;
   info_.reportDistance = newDistance;
   info_.feasibleDistance = newDistance;
@@ -229,9 +288,9 @@ Dual::diffusingComputation(
   msg.distance = info_.reportDistance;
   msg.type = thrift::DualMessageType::QUERY;
 
-  for (const auto& kv : localDistances_) {
-    const auto& neighbor = kv.first;
-    if (kv.second == std::numeric_limits<int64_t>::max()) {
+  for (auto& entry : neighbors_) {
+    const auto& neighbor = entry.id;
+    if (entry.localDistance == std::numeric_limits<int64_t>::max()) {
       // skip down neighbor
       continue;
     }
@@ -239,7 +298,7 @@ Dual::diffusingComputation(
     msgsToSend[neighbor].messages.emplace_back(msg);
     counters_[neighbor].querySent++;
     counters_[neighbor].totalSent++;
-    info_.neighborInfos[neighbor].expectReply = true;
+    entry.info.expectReply = true;
     success = true;
   }
   return success;
@@ -277,6 +336,16 @@ Dual::tryLocalOrDiffusing(
       // send reply back before starting diffusing
       sendReply(msgsToSend);
     }
+    // if I lost my nexthop, switch to a feasible successor first and diffuse
+    // from it. Route through it is loop-free, so it stays usable until
+    // diffusing completes
+    info_.feasibleSuccessor = findFeasibleSuccessor(newNexthop, newDistance);
+    if (info_.feasibleSuccessor and info_.nexthop != newNexthop) {
+      if (nexthopCb_) {
+        nexthopCb_(info_.nexthop, newNexthop);
+      }
+      info_.nexthop = newNexthop;
+    }
     VLOG(2) << rootId << "::" << nodeId << ": start diffusing";
     bool success = diffusingComputation(msgsToSend);
     if (success) {
@@ -358,10 +427,11 @@ Dual::children() const noexcept {
 
 bool
 Dual::neighborUp(const std::string& neighbor) {
-  if (localDistances_.count(neighbor) == 0) {
+  const auto entry = findNeighbor(neighbor);
+  if (entry == nullptr) {
     return false;
   }
-  return localDistances_.at(neighbor) != std::numeric_limits<int64_t>::max();
+  return entry->localDistance != std::numeric_limits<int64_t>::max();
 }
 
 const Dual::RouteInfo&
@@ -371,10 +441,19 @@ Dual::getInfo() const noexcept {
 
 bool
 Dual::hasValidRoute() const noexcept {
-  return (
-      info_.sm.state == DualState::PASSIVE and
-      info_.distance != std::numeric_limits<int64_t>::max() and
-      info_.nexthop.has_value());
+  if (info_.sm.state == DualState::PASSIVE) {
+    return (
+        info_.distance != std::numeric_limits<int64_t>::max() and
+        info_.nexthop.has_value());
+  }
+  // diffusing from a feasible successor, route is valid as long as link
+  // towards it is up
+  if (not info_.feasibleSuccessor or not info_.nexthop.has_value()) {
+    return false;
+  }
+  const auto entry = findNeighbor(*info_.nexthop);
+  return entry != nullptr and
+      entry->localDistance != std::numeric_limits<int64_t>::max();
 }
 
 std::unordered_set<std::string>
@@ -418,21 +497,22 @@ Dual::peerUp(
   }
 
   // update local-distance
-  localDistances_[neighbor] = cost;
-  info_.neighborInfos.emplace(neighbor, NeighborInfo());
+  auto& entry = getNeighbor(neighbor);
+  entry.localDistance = cost;
+  entry.hasLocalDistance = true;
 
   if (info_.sm.state == DualState::PASSIVE) {
     // passive
     tryLocalOrDiffusing(DualEvent::OTHERS, false, msgsToSend);
   } else {
     // active
-    if (info_.neighborInfos[neighbor].expectReply) {
+    if (getNeighbor(neighbor).info.expectReply) {
       // I expected a reply from this neighbor before and it just came up
       // this is equivlent to receiving a reply
 
       thrift::DualMessage msg;
       msg.dstId = rootId;
-      msg.distance = info_.neighborInfos[neighbor].reportDistance;
+      msg.distance = getNeighbor(neighbor).info.reportDistance;
       msg.type = thrift::DualMessageType::REPLY;
       processReply(neighbor, msg, msgsToSend);
     }
@@ -450,8 +530,9 @@ Dual::peerUp(
   counters_[neighbor].updateSent++;
   counters_[neighbor].totalSent++;
 
-  if (info_.neighborInfos[neighbor].needToReply) {
-    info_.neighborInfos.at(neighbor).needToReply = false;
+  auto& neighborInfo = getNeighbor(neighbor).info;
+  if (neighborInfo.needToReply) {
+    neighborInfo.needToReply = false;
 
     thrift::DualMessage reply;
     reply.dstId = rootId;
@@ -476,9 +557,10 @@ Dual::peerDown(
   removeChild(neighbor);
 
   // update local-distance and report-distance
-  localDistances_[neighbor] = std::numeric_limits<int64_t>::max();
-  info_.neighborInfos[neighbor].reportDistance =
-      std::numeric_limits<int64_t>::max();
+  auto& entry = getNeighbor(neighbor);
+  entry.localDistance = std::numeric_limits<int64_t>::max();
+  entry.hasLocalDistance = true;
+  entry.info.reportDistance = std::numeric_limits<int64_t>::max();
   DualEvent event = DualEvent::INCREASE_D;
 
   if (info_.sm.state == DualState::PASSIVE) {
@@ -487,7 +569,7 @@ Dual::peerDown(
   } else {
     // active
     info_.sm.processEvent(event);
-    if (info_.neighborInfos[neighbor].expectReply) {
+    if (getNeighbor(neighbor).info.expectReply) {
       // expecting a reply from this neighbor, but it goes down
       // equivlent to receing a reply from this guy with max-distance.
 
@@ -507,10 +589,12 @@ Dual::peerCostChange(
     std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
   LOG(INFO) << rootId << "::" << nodeId << ": LINK COST event from ("
             << neighbor << ", " << cost << ")";
-  DualEvent event = cost > localDistances_[neighbor] ? DualEvent::INCREASE_D
-                                                     : DualEvent::OTHERS;
+  auto& entry = getNeighbor(neighbor);
+  DualEvent event = cost > entry.localDistance ? DualEvent::INCREASE_D
+                                               : DualEvent::OTHERS;
   // update local-distance
-  localDistances_[neighbor] = cost;
+  entry.localDistance = cost;
+  entry.hasLocalDistance = true;
 
   if (info_.sm.state == DualState::PASSIVE) {
     // passive
@@ -519,8 +603,7 @@ Dual::peerCostChange(
     // active
     // only update d while leaving rd, fd as-is
     if (info_.nexthop.has_value() and *info_.nexthop == neighbor) {
-      info_.distance = addDistances(
-          cost, info_.neighborInfos[*info_.nexthop].reportDistance);
+      info_.distance = addDistances(cost, entry.info.reportDistance);
     }
     info_.sm.processEvent(event);
   }
@@ -542,9 +625,10 @@ Dual::processUpdate(
   counters_[neighbor].totalRecv++;
 
   // update report-distance
-  info_.neighborInfos[neighbor].reportDistance = rd;
+  auto& entry = getNeighbor(neighbor);
+  entry.info.reportDistance = rd;
 
-  if (localDistances_.count(neighbor) == 0) {
+  if (not entry.hasLocalDistance) {
     // received UPDATE before having local info_ (LINK-UP), done here
     return;
   }
@@ -556,7 +640,7 @@ Dual::processUpdate(
     // active
     // only update d while leaving rd, fd as-is
     if (info_.nexthop.has_value() and *info_.nexthop == neighbor) {
-      info_.distance = addDistances(localDistances_[*info_.nexthop], rd);
+      info_.distance = addDistances(entry.localDistance, rd);
     }
     info_.sm.processEvent(DualEvent::OTHERS);
   }
@@ -578,7 +662,7 @@ Dual::sendReply(
     // 2. link is up on the other end, I received a query, but I haven't
     //    received a neighbor-up event yet. set pending-reply = true so when
     //    link is up on my end, I can send out reply.
-    info_.neighborInfos[dstNode].needToReply = true;
+    getNeighbor(dstNode).info.needToReply = true;
     return;
   }
 
@@ -608,7 +692,8 @@ Dual::processQuery(
   counters_[neighbor].totalRecv++;
 
   // update report-distance
-  info_.neighborInfos[neighbor].reportDistance = rd;
+  auto& entry = getNeighbor(neighbor);
+  entry.info.reportDistance = rd;
   info_.cornet.emplace(neighbor);
   DualEvent event = DualEvent::OTHERS;
   if (info_.nexthop.has_value() and *info_.nexthop == neighbor) {
@@ -621,9 +706,8 @@ Dual::processQuery(
   } else {
     // active
     if (info_.nexthop.has_value() and *info_.nexthop == neighbor) {
-      info_.distance = addDistances(
-          localDistances_[*info_.nexthop],
-          info_.neighborInfos[*info_.nexthop].reportDistance);
+      info_.distance =
+          addDistances(entry.localDistance, entry.info.reportDistance);
     }
     info_.sm.processEvent(event);
     sendReply(msgsToSend);
@@ -645,7 +729,8 @@ Dual::processReply(
   counters_[neighbor].replyRecv++;
   counters_[neighbor].totalRecv++;
 
-  if (not info_.neighborInfos[neighbor].expectReply) {
+  auto& entry = getNeighbor(neighbor);
+  if (not entry.info.expectReply) {
     // received a reply when I don't expect to receive a reply from it
     // this is OK, this can happen when I detect link-down event before I
     // receive the reply, just ignore it.
@@ -656,12 +741,12 @@ Dual::processReply(
 
   // active
   // update report-distance and expect-reply flag
-  info_.neighborInfos[neighbor].reportDistance = reportDistance;
-  info_.neighborInfos[neighbor].expectReply = false;
+  entry.info.reportDistance = reportDistance;
+  entry.info.expectReply = false;
 
   bool lastReply = true;
-  for (const auto& kv : info_.neighborInfos) {
-    if (kv.second.expectReply) {
+  for (const auto& other : neighbors_) {
+    if (other.info.expectReply) {
       lastReply = false;
       break;
     }
@@ -674,18 +759,16 @@ Dual::processReply(
   // result of the distance reported by me OR stopped being my dependent
   // Therefore, I'm free to pick the optimal solution
   info_.sm.processEvent(DualEvent::LAST_REPLY, true);
+  info_.feasibleSuccessor = false;
 
   int64_t d;
   int64_t dmin = std::numeric_limits<int64_t>::max();
   std::optional<std::string> newNh{std::nullopt};
-  for (const auto& kv : localDistances_) {
-    const auto& nb = kv.first;
-    const auto& ld = kv.second;
-    const auto& rd = info_.neighborInfos[nb].reportDistance;
-    d = addDistances(ld, rd);
+  for (const auto& other : neighbors_) {
+    d = addDistances(other.localDistance, other.info.reportDistance);
     if (d < dmin) {
       dmin = d;
-      newNh = nb;
+      newNh = other.id;
     }
   }
   bool sameRd = dmin == info_.reportDistance;
@@ -740,6 +823,8 @@ DualNode::peerDown(const std::string& neighbor) {
   localDistances_[neighbor] = std::numeric_limits<int64_t>::max();
   // clear counters
   clearCounters(neighbor);
+  // drop messages which are yet to be sent to neighbor
+  pendingMsgs_.erase(neighbor);
 
   std::unordered_map<std::string, thrift::DualMessages> msgsToSend;
 
@@ -825,8 +910,7 @@ DualNode::processDualMessages(const thrift::DualMessages& messages) {
 
   for (const auto& msg : messages.messages) {
     const auto& rootId = msg.dstId;
-    addDual(rootId);
-    auto& dual = duals_.at(rootId);
+    auto& dual = addDual(rootId);
     switch (msg.type) {
     case thrift::DualMessageType::UPDATE: {
       dual.processUpdate(neighbor, msg, msgsToSend);
@@ -931,6 +1015,29 @@ DualNode::clearCounters(const std::string& neighbor) noexcept {
 void
 DualNode::sendAllDualMessages(
     std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+  for (auto& kv : msgsToSend) {
+    auto& msgs = kv.second.messages;
+    if (msgs.empty()) {
+      // ignore empty messages
+      continue;
+    }
+    auto& pendingMsgs = pendingMsgs_[kv.first].messages;
+    pendingMsgs.insert(
+        pendingMsgs.end(),
+        std::make_move_iterator(msgs.begin()),
+        std::make_move_iterator(msgs.end()));
+  }
+
+  if (not deferDualMessages()) {
+    flushDualMessages();
+  }
+}
+
+void
+DualNode::flushDualMessages() {
+  auto msgsToSend = std::move(pendingMsgs_);
+  pendingMsgs_.clear();
+
   for (auto& kv : msgsToSend) {
     const auto& neighbor = kv.first;
     auto& msgs = kv.second;
@@ -950,10 +1057,11 @@ DualNode::sendAllDualMessages(
   }
 }
 
-void
+Dual&
 DualNode::addDual(const std::string& rootId) {
-  if (duals_.count(rootId) != 0) {
-    return;
+  auto it = duals_.find(rootId);
+  if (it != duals_.end()) {
+    return it->second;
   }
 
   auto nexthopCb = [this, rootId](
@@ -961,7 +1069,9 @@ DualNode::addDual(const std::string& rootId) {
                        const std::optional<std::string>& newNh) {
     processNexthopChange(rootId, oldNh, newNh);
   };
-  duals_.emplace(rootId, Dual(nodeId, rootId, localDistances_, nexthopCb));
+  return duals_
+      .emplace(rootId, Dual(nodeId, rootId, localDistances_, nexthopCb))
+      .first->second;
 }
 
 } // namespace openr
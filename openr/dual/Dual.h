@@ -7,10 +7,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <functional>
+#include <iterator>
 #include <limits>
 #include <stack>
 #include <unordered_map>
+#include <vector>
 
 #include <folly/Format.h>
 
@@ -148,10 +151,11 @@ class Dual {
     std::optional<std::string> nexthop{std::nullopt};
     // state machine
     DualStateMachine sm;
-    // neighbor exchanged information <report-distance, expect-reply-flag>
-    std::unordered_map<std::string, NeighborInfo> neighborInfos;
     // diffusing: track received query
     std::stack<std::string> cornet{};
+    // diffusing: nexthop is a feasible successor switched to when previous
+    // nexthop was lost, route through it is usable while diffusing
+    bool feasibleSuccessor{false};
 
     // dump route info into human-friendly string mainly for logging or
     // debugging
@@ -197,7 +201,8 @@ class Dual {
   // get current route-info
   const RouteInfo& getInfo() const noexcept;
 
-  // check if have a valid route towards root or not
+  // check if have a valid route towards root or not. Route is valid when
+  // PASSIVE, or while diffusing from a feasible successor
   bool hasValidRoute() const noexcept;
 
   // get status string (includes route-info and dual-counters)
@@ -240,6 +245,13 @@ class Dual {
   // return true, otherwise return false
   bool meetFeasibleCondition(std::string& nexthop, int64_t& distance);
 
+  // when my current nexthop is lost (link down or no route), find the best
+  // feasible successor: a neighbor whose report-distance <
+  // my-feasible-distance, regardless of it giving the minimum-distance.
+  // Switching to it is loop-free.
+  // return false if nexthop is not lost or there is no feasible successor
+  bool findFeasibleSuccessor(std::string& nexthop, int64_t& distance);
+
   // flood updates to all my neighbor
   void floodUpdates(
       std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
@@ -271,14 +283,39 @@ class Dual {
   // check if a neighbor is up or not
   bool neighborUp(const std::string& neighbor);
 
+  // Per neighbor state towards root. Neighbors are stored contiguously and
+  // never removed, so that computations looping over all neighbors don't
+  // need to hash neighbor-ids.
+  struct NeighborEntry {
+    explicit NeighborEntry(const std::string& id) : id(id) {}
+
+    // neighbor id
+    std::string id;
+    // local distance, max if link is down
+    int64_t localDistance{std::numeric_limits<int64_t>::max()};
+    // false until local distance is known (LINK-UP)
+    bool hasLocalDistance{false};
+    // neighbor exchanged information <report-distance, expect-reply-flag>
+    NeighborInfo info;
+  };
+
+  // get neighbor entry, create one if not exist
+  NeighborEntry& getNeighbor(const std::string& neighbor);
+
+  // get neighbor entry, nullptr if not exist
+  const NeighborEntry* findNeighbor(const std::string& neighbor) const;
+
   // clear counters to zero for a given neighbor
   void clearCounters(const std::string& neighbor) noexcept;
 
   // route-info towards root
   RouteInfo info_;
 
-  // local neighbor distances
-  std::unordered_map<std::string, int64_t> localDistances_;
+  // neighbor states, indexed by neighborIndex_
+  std::vector<NeighborEntry> neighbors_;
+
+  // map<neighbor-id: index in neighbors_>
+  std::unordered_map<std::string, size_t> neighborIndex_;
 
   // dual messages counters map<neighbor: dual-counters>
   std::map<std::string, thrift::DualPerRootCounters> counters_;
@@ -384,19 +421,33 @@ class DualNode {
   // get dual related counters
   thrift::DualCounters getCounters() const noexcept;
 
+  // send out pending dual messages, one packet per neighbor carrying messages
+  // of all roots. Subclass deferring dual messages must call this later.
+  void flushDualMessages();
+
   // myRootId
   const std::string nodeId;
 
   // I'm a root or not
   const bool isRoot{false};
 
+ protected:
+  // subclass can override this api to defer sending of dual messages, e.g.
+  // until end of event loop iteration, so that messages produced by several
+  // events towards a neighbor are coalesced. Return false to send right away.
+  virtual bool
+  deferDualMessages() noexcept {
+    return false;
+  }
+
  private:
-  // send out dual messages for a given <neighbor: dual-messages>
+  // queue dual messages for a given <neighbor: dual-messages> and send them
+  // out unless deferred
   void sendAllDualMessages(
       std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
 
-  // add Dual for a given root-id if not exist yet
-  void addDual(const std::string& rootId);
+  // add Dual for a given root-id if not exist yet, return Dual of root-id
+  Dual& addDual(const std::string& rootId);
 
   // clear counters to zero for a given neighbor
   void clearCounters(const std::string& neighbor) noexcept;
@@ -409,6 +460,9 @@ class DualNode {
 
   // map<neighbor-id: counters>
   std::unordered_map<std::string, thrift::DualPerNeighborCounters> counters_;
+
+  // dual messages yet to be sent map<neighbor-id: dual-messages>
+  std::unordered_map<std::string, thrift::DualMessages> pendingMsgs_;
 };
 
 } // namespace openr
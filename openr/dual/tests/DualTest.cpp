@@ -265,6 +265,136 @@ class DualTestNode final : public DualNode {
   std::map<std::string, std::shared_ptr<DualTestNode>>& nodes_;
 };
 
+// Dual node recording sent messages, optionally deferring them until flushed
+class DualRecordingNode final : public DualNode {
+ public:
+  DualRecordingNode(const std::string& nodeId, bool deferMessages)
+      : DualNode(nodeId, false), deferMessages_(deferMessages) {}
+
+  bool
+  sendDualMessages(
+      const std::string& neighbor,
+      const thrift::DualMessages& msgs) noexcept override {
+    pktSent[neighbor]++;
+    msgSent[neighbor] += msgs.messages.size();
+    return true;
+  }
+
+  void
+  processNexthopChange(
+      const std::string& /* rootId */,
+      const std::optional<std::string>& /* oldNh */,
+      const std::optional<std::string>& /* newNh */) noexcept override {}
+
+  // map<neighbor: number of packets/messages sent>
+  std::map<std::string, size_t> pktSent;
+  std::map<std::string, size_t> msgSent;
+
+ protected:
+  bool
+  deferDualMessages() noexcept override {
+    return deferMessages_;
+  }
+
+ private:
+  const bool deferMessages_{false};
+};
+
+// Verify deferred dual messages towards a neighbor are coalesced across roots
+// and events into a single packet
+TEST(Dual, CoalesceMessages) {
+  DualRecordingNode node("n0", false /* defer */);
+  DualRecordingNode deferNode("n0", true /* defer */);
+
+  for (auto* dualNode : {&node, &deferNode}) {
+    dualNode->peerUp("n1", 1);
+    dualNode->peerUp("n2", 1);
+    // updates of two roots received in separate packets
+    for (const auto& rootId : {"r1", "r2"}) {
+      thrift::DualMessages msgs;
+      msgs.srcId = "n1";
+      thrift::DualMessage msg;
+      msg.dstId = rootId;
+      msg.distance = 0;
+      msg.type = thrift::DualMessageType::UPDATE;
+      msgs.messages.emplace_back(std::move(msg));
+      dualNode->processDualMessages(msgs);
+    }
+  }
+
+  // nothing sent until flushed
+  EXPECT_TRUE(deferNode.pktSent.empty());
+  deferNode.flushDualMessages();
+
+  EXPECT_LE(2, node.msgSent["n2"]);
+  EXPECT_EQ(node.msgSent, deferNode.msgSent);
+  for (const auto& kv : deferNode.pktSent) {
+    EXPECT_EQ(1, kv.second);
+    EXPECT_LT(kv.second, node.pktSent.at(kv.first));
+  }
+  EXPECT_EQ(
+      deferNode.msgSent["n2"],
+      deferNode.getCounters().neighborCounters.at("n2").msgSent);
+}
+
+// Verify node switches to a feasible successor when its nexthop goes down,
+// and keeps a valid route through it while diffusing towards shortest path
+// links (cost): n0-r (2), n0-b (1), n0-c (10), b-r (3), c-r (1)
+TEST(Dual, FeasibleSuccessor) {
+  DualRecordingNode node("n0", false /* defer */);
+  node.peerUp("r", 2);
+  node.peerUp("b", 1);
+  node.peerUp("c", 10);
+
+  auto sendMessage = [&node](
+                         const std::string& srcId,
+                         thrift::DualMessageType type,
+                         int64_t distance) {
+    thrift::DualMessages msgs;
+    msgs.srcId = srcId;
+    thrift::DualMessage msg;
+    msg.dstId = "r";
+    msg.distance = distance;
+    msg.type = type;
+    msgs.messages.emplace_back(std::move(msg));
+    node.processDualMessages(msgs);
+  };
+
+  // report-distances towards root r
+  sendMessage("r", thrift::DualMessageType::UPDATE, 0);
+  sendMessage("b", thrift::DualMessageType::UPDATE, 3);
+  sendMessage("c", thrift::DualMessageType::UPDATE, 1);
+  auto info = node.getInfo("r");
+  ASSERT_TRUE(info.has_value());
+  EXPECT_EQ(DualState::PASSIVE, info->sm.state);
+  EXPECT_EQ("r", info->nexthop);
+  EXPECT_EQ(2, info->distance);
+
+  // b is on shortest path but not feasible (3 >= 2), c is feasible (1 < 2)
+  node.peerDown("r");
+  info = node.getInfo("r");
+  ASSERT_TRUE(info.has_value());
+  EXPECT_NE(DualState::PASSIVE, info->sm.state);
+  EXPECT_TRUE(info->feasibleSuccessor);
+  EXPECT_EQ("c", info->nexthop);
+  EXPECT_EQ(11, info->distance);
+  EXPECT_TRUE(node.getDual("r").hasValidRoute());
+  EXPECT_EQ("r", node.getSptRootId());
+  EXPECT_EQ(
+      (std::unordered_set<std::string>{"c"}), node.getSptPeers("r"));
+
+  // diffusing completes on shortest path
+  sendMessage("b", thrift::DualMessageType::REPLY, 3);
+  sendMessage("c", thrift::DualMessageType::REPLY, 1);
+  info = node.getInfo("r");
+  ASSERT_TRUE(info.has_value());
+  EXPECT_EQ(DualState::PASSIVE, info->sm.state);
+  EXPECT_FALSE(info->feasibleSuccessor);
+  EXPECT_EQ("b", info->nexthop);
+  EXPECT_EQ(4, info->distance);
+  EXPECT_TRUE(node.getDual("r").hasValidRoute());
+}
+
 // Dual test fixture
 class DualBaseFixture : public ::testing::Test {
  protected:
@@ -12,6 +12,7 @@
 #include <fbzmq/service/logging/LogSample.h>
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/MapUtil.h>
+#include <folly/futures/Future.h>
 #include <thrift/lib/cpp/protocol/TProtocolTypes.h>
 #include <thrift/lib/cpp/transport/THeader.h>
 #include <thrift/lib/cpp2/async/HeaderClientChannel.h>
@@ -24,19 +25,69 @@ namespace fb303 = facebook::fb303;
 
 namespace openr {
 
+namespace {
+
+// Forwarding attributes of nexthop, as kept by agent
+thrift::NextHopThrift
+toAgentNextHop(const thrift::NextHopThrift& nextHop) {
+  thrift::NextHopThrift agentNextHop;
+  agentNextHop.address = nextHop.address;
+  agentNextHop.weight = nextHop.weight;
+  if (nextHop.mplsAction_ref().has_value()) {
+    agentNextHop.mplsAction_ref() = *nextHop.mplsAction_ref();
+  }
+  return agentNextHop;
+}
+
+// Routes reduced to what agent keeps of them, with sorted nexthops, so that
+// routes read back from agent compare equal to programmed ones
+thrift::UnicastRoute
+toAgentUnicastRoute(const thrift::UnicastRoute& route) {
+  std::vector<thrift::NextHopThrift> nextHops;
+  for (auto const& nextHop : route.nextHops) {
+    nextHops.emplace_back(toAgentNextHop(nextHop));
+  }
+  std::sort(nextHops.begin(), nextHops.end());
+  thrift::UnicastRoute agentRoute;
+  agentRoute.dest = route.dest;
+  agentRoute.nextHops = std::move(nextHops);
+  return agentRoute;
+}
+
+thrift::MplsRoute
+toAgentMplsRoute(const thrift::MplsRoute& route) {
+  std::vector<thrift::NextHopThrift> nextHops;
+  for (auto const& nextHop : route.nextHops) {
+    nextHops.emplace_back(toAgentNextHop(nextHop));
+  }
+  std::sort(nextHops.begin(), nextHops.end());
+  thrift::MplsRoute agentRoute;
+  agentRoute.topLabel = route.topLabel;
+  agentRoute.nextHops = std::move(nextHops);
+  return agentRoute;
+}
+
+} // namespace
+
 Fib::Fib(
     std::shared_ptr<const Config> config,
     int32_t thriftPort,
     std::chrono::seconds coldStartDuration,
     messaging::RQueue<thrift::RouteDatabaseDelta> routeUpdatesQueue,
     messaging::RQueue<thrift::InterfaceDatabase> interfaceUpdatesQueue,
+    messaging::ReplicateQueue<thrift::RouteDatabaseDelta>& fibUpdatesQueue,
     const MonitorSubmitUrl& monitorSubmitUrl,
     KvStore* kvStore,
-    fbzmq::Context& zmqContext)
+    fbzmq::Context& zmqContext,
+    std::shared_ptr<thrift::FibServiceSvIf> fibHandler)
     : myNodeName_(config->getConfig().node_name),
       thriftPort_(thriftPort),
+      fibHandler_(std::move(fibHandler)),
       expBackoff_(
           std::chrono::milliseconds(8), std::chrono::milliseconds(4096)),
+      retryRoutesExpBackoff_(
+          std::chrono::milliseconds(8), std::chrono::milliseconds(4096)),
+      fibUpdatesQueue_(fibUpdatesQueue),
       kvStore_(kvStore) {
   auto tConfig = config->getConfig();
 
@@ -45,10 +96,30 @@ Fib::Fib(
       config->getConfig().enable_segment_routing_ref().value_or(false);
   enableOrderedFib_ =
       config->getConfig().enable_ordered_fib_programming_ref().value_or(false);
+  routeProgrammingWindow_ = std::max(
+      config->getConfig().fib_route_programming_window_ref().value_or(
+          Constants::kFibRouteProgrammingWindow),
+      1);
+  enableRoutePriority_ =
+      config->getConfig().enable_fib_route_priority_ref().value_or(false);
+  enableChunkedSync_ =
+      config->getConfig().enable_fib_chunked_sync_ref().value_or(false);
+  enableWarmSync_ =
+      config->getConfig().enable_fib_warm_sync_ref().value_or(false);
+  syncId_ = getUnixTimeStampMs();
+  perfEventSampleRate_ = std::max(
+      config->getConfig().fib_perf_event_sample_rate_ref().value_or(1), 1);
 
   syncRoutesTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
     if (routeState_.hasRoutesFromDecision) {
       if (syncRouteDb()) {
+        if (not hasSyncedFib_) {
+          fb303::fbData->setCounter(
+              "fib.initial_sync_ms",
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - startTime_)
+                  .count());
+        }
         hasSyncedFib_ = true;
         expBackoff_.reportSuccess();
       } else {
@@ -62,6 +133,19 @@ Fib::Fib(
         "fib.require_routedb_sync", syncRoutesTimer_->isScheduled());
   });
 
+  retryRoutesTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+    retryFailedRoutes();
+    if (routeState_.failedUnicastRoutes.empty() and
+        routeState_.failedMplsRoutes.empty()) {
+      retryRoutesExpBackoff_.reportSuccess();
+    } else {
+      // Apply exponential backoff and schedule next run
+      retryRoutesExpBackoff_.reportError();
+      retryRoutesTimer_->scheduleTimeout(
+          retryRoutesExpBackoff_.getTimeRemainingUntilRetry());
+    }
+  });
+
   if (enableOrderedFib_) {
     // check non-empty module ptr
     CHECK(kvStore_);
@@ -97,15 +181,26 @@ Fib::Fib(
   // Fiber to process route updates from Decision
   addFiberTask([q = std::move(routeUpdatesQueue), this]() mutable noexcept {
     while (true) {
-      auto maybeThriftObj = q.get(); // perform read
+      // Coalesce all pending deltas into a single programming call
+      auto maybeThriftObjs =
+          q.getBatch(Constants::kFibRouteUpdatesBatchSize); // perform read
       VLOG(1) << "Received route updates";
-      if (maybeThriftObj.hasError()) {
+      if (maybeThriftObjs.hasError()) {
         LOG(INFO) << "Terminating route delta processing fiber";
         break;
       }
 
-      CHECK_EQ(myNodeName_, maybeThriftObj.value().thisNodeName);
-      processRouteUpdates(std::move(maybeThriftObj).value());
+      for (const auto& routeDelta : maybeThriftObjs.value()) {
+        CHECK_EQ(myNodeName_, routeDelta.thisNodeName);
+      }
+      fb303::fbData->addStatValue(
+          "fib.num_of_coalesced_route_updates",
+          maybeThriftObjs.value().size() - 1,
+          fb303::SUM);
+      fb303::fbData->setCounter(
+          "fib.route_updates_queue.num_coalesced", q.numCoalesced());
+      processRouteUpdates(
+          mergeRouteDeltas(std::move(maybeThriftObjs).value()));
     }
   });
 
@@ -124,14 +219,31 @@ Fib::Fib(
     }
   });
 
-  zmqMonitorClient_ =
-      std::make_unique<fbzmq::ZmqMonitorClient>(zmqContext, monitorSubmitUrl);
+  eventLogger_ = std::make_unique<EventLogger>(zmqContext, monitorSubmitUrl);
 
   // Initialize stats keys
   fb303::fbData->addStatExportType("fib.convergence_time_ms", fb303::AVG);
+  // Percentile 100 is exported as the max of each window
+  for (auto const key :
+       {"fib.latency.route_program_ms", "fib.latency.convergence_ms"}) {
+    fb303::fbData->addHistogram(
+        key,
+        Constants::kFibLatencyBucketWidth.count(),
+        0,
+        Constants::kFibLatencyMax.count());
+    fb303::fbData->exportHistogramPercentile(key, 50, 99, 100);
+  }
+  fb303::fbData->addHistogram(
+      "fib.routes_per_call",
+      Constants::kFibRoutesPerCallBucketWidth,
+      0,
+      Constants::kFibRouteProgrammingChunkSize);
+  fb303::fbData->exportHistogramPercentile("fib.routes_per_call", 50, 99, 100);
   fb303::fbData->addStatExportType(
       "fib.local_route_program_time_ms", fb303::AVG);
   fb303::fbData->addStatExportType("fib.num_of_route_updates", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "fib.num_of_coalesced_route_updates", fb303::SUM);
   fb303::fbData->addStatExportType("fib.process_interface_db", fb303::COUNT);
   fb303::fbData->addStatExportType("fib.process_route_db", fb303::COUNT);
   fb303::fbData->addStatExportType("fib.sync_fib_calls", fb303::COUNT);
@@ -142,6 +254,22 @@ Fib::Fib(
   fb303::fbData->addStatExportType("fib.thrift.failure.sync_fib", fb303::COUNT);
 }
 
+messaging::ReaderOptions<thrift::RouteDatabaseDelta>
+Fib::getRouteUpdatesReaderOptions() {
+  messaging::ReaderOptions<thrift::RouteDatabaseDelta> options;
+  options.maxSize = Constants::kFibRouteUpdatesQueueMaxSize;
+  options.overflowPolicy = messaging::OverflowPolicy::COALESCE;
+  options.coalesce = [](thrift::RouteDatabaseDelta& pending,
+                        thrift::RouteDatabaseDelta&& update) {
+    std::vector<thrift::RouteDatabaseDelta> routeDeltas;
+    routeDeltas.emplace_back(std::move(pending));
+    routeDeltas.emplace_back(std::move(update));
+    pending = mergeRouteDeltas(std::move(routeDeltas));
+    return true;
+  };
+  return options;
+}
+
 std::optional<thrift::IpPrefix>
 Fib::longestPrefixMatch(
     const folly::CIDRNetwork& inputPrefix,
@@ -166,6 +294,134 @@ Fib::longestPrefixMatch(
   return matchedPrefix;
 }
 
+void
+Fib::RouteState::updateUnicastRoute(thrift::UnicastRoute route) {
+  const auto dest = toIPNetwork(route.dest, false /* applyMask */);
+  RouteEntry<thrift::UnicastRoute> entry;
+  entry.nextHops = nextHopGroups.get(std::move(route.nextHops));
+  route.dest = thrift::IpPrefix();
+  route.nextHops.clear();
+  if (not(route == thrift::UnicastRoute())) {
+    entry.attributes =
+        std::make_unique<thrift::UnicastRoute>(std::move(route));
+  }
+  auto& currEntry = unicastRoutes[dest];
+  if (currEntry.nextHops) {
+    groupRoutes.at(currEntry.nextHops.get()).prefixes.erase(dest);
+    unindexGroup(*currEntry.nextHops);
+  }
+  indexGroup(*entry.nextHops).prefixes.emplace(dest);
+  currEntry = std::move(entry);
+  unicastPrefixes.insert(dest);
+}
+
+void
+Fib::RouteState::deleteUnicastRoute(const thrift::IpPrefix& dest) {
+  const auto network = toIPNetwork(dest, false /* applyMask */);
+  auto it = unicastRoutes.find(network);
+  if (it == unicastRoutes.end()) {
+    return;
+  }
+  groupRoutes.at(it->second.nextHops.get()).prefixes.erase(network);
+  unindexGroup(*it->second.nextHops);
+  unicastRoutes.erase(it);
+  unicastPrefixes.erase(network);
+}
+
+void
+Fib::RouteState::deleteMplsRoute(uint32_t topLabel) {
+  auto it = mplsRoutes.find(topLabel);
+  if (it == mplsRoutes.end()) {
+    return;
+  }
+  groupRoutes.at(it->second.nextHops.get()).labels.erase(topLabel);
+  unindexGroup(*it->second.nextHops);
+  mplsRoutes.erase(it);
+}
+
+Fib::RouteState::GroupRoutes&
+Fib::RouteState::indexGroup(NextHopGroup const& group) {
+  auto it = groupRoutes.find(&group);
+  if (it != groupRoutes.end()) {
+    return it->second;
+  }
+  for (auto const& nextHop : group) {
+    // We don't have ifName for `POP_AND_LOOKUP` mpls action
+    if (auto ifName = nextHop.address.ifName_ref()) {
+      interfaceGroups[*ifName].emplace(&group);
+    }
+  }
+  return groupRoutes[&group];
+}
+
+void
+Fib::RouteState::unindexGroup(NextHopGroup const& group) {
+  auto it = groupRoutes.find(&group);
+  CHECK(it != groupRoutes.end());
+  if (not it->second.prefixes.empty() or not it->second.labels.empty()) {
+    return;
+  }
+  groupRoutes.erase(it);
+  for (auto const& nextHop : group) {
+    auto ifName = nextHop.address.ifName_ref();
+    if (not ifName.has_value()) {
+      continue;
+    }
+    auto groupsIt = interfaceGroups.find(*ifName);
+    if (groupsIt == interfaceGroups.end()) {
+      continue; // nexthops may repeat interface
+    }
+    groupsIt->second.erase(&group);
+    if (groupsIt->second.empty()) {
+      interfaceGroups.erase(groupsIt);
+    }
+  }
+}
+
+void
+Fib::RouteState::updateMplsRoute(thrift::MplsRoute route) {
+  const uint32_t topLabel = route.topLabel;
+  RouteEntry<thrift::MplsRoute> entry;
+  entry.nextHops = nextHopGroups.get(std::move(route.nextHops));
+  route.topLabel = 0;
+  route.nextHops.clear();
+  if (not(route == thrift::MplsRoute())) {
+    entry.attributes = std::make_unique<thrift::MplsRoute>(std::move(route));
+  }
+  auto& currEntry = mplsRoutes[topLabel];
+  if (currEntry.nextHops) {
+    groupRoutes.at(currEntry.nextHops.get()).labels.erase(topLabel);
+    unindexGroup(*currEntry.nextHops);
+  }
+  indexGroup(*entry.nextHops).labels.emplace(topLabel);
+  currEntry = std::move(entry);
+}
+
+thrift::UnicastRoute
+Fib::RouteState::toUnicastRoute(
+    const folly::CIDRNetwork& dest,
+    const RouteEntry<thrift::UnicastRoute>& entry) {
+  thrift::UnicastRoute route;
+  if (entry.attributes) {
+    route = *entry.attributes;
+  }
+  route.dest = toIpPrefix(dest);
+  route.nextHops = *entry.nextHops;
+  return route;
+}
+
+thrift::MplsRoute
+Fib::RouteState::toMplsRoute(
+    uint32_t topLabel, const RouteEntry<thrift::MplsRoute>& entry) {
+  thrift::MplsRoute route;
+  if (entry.attributes) {
+    route = *entry.attributes;
+  }
+  route.topLabel = topLabel;
+  route.nextHops = *entry.nextHops;
+  return route;
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
 Fib::getRouteDb() {
   folly::Promise<std::unique_ptr<thrift::RouteDatabase>> p;
@@ -174,10 +430,12 @@ Fib::getRouteDb() {
     thrift::RouteDatabase routeDb;
     routeDb.thisNodeName = myNodeName_;
     for (const auto& route : routeState_.unicastRoutes) {
-      routeDb.unicastRoutes.emplace_back(route.second);
+      routeDb.unicastRoutes.emplace_back(
+          RouteState::toUnicastRoute(route.first, route.second));
     }
     for (const auto& route : routeState_.mplsRoutes) {
-      routeDb.mplsRoutes.emplace_back(route.second);
+      routeDb.mplsRoutes.emplace_back(
+          RouteState::toMplsRoute(route.first, route.second));
     }
     p.setValue(std::make_unique<thrift::RouteDatabase>(std::move(routeDb)));
   });
@@ -223,12 +481,13 @@ Fib::getUnicastRoutesFiltered(std::vector<std::string> prefixes) {
   // return and send the vector<thrift::UnicastRoute>
   std::vector<thrift::UnicastRoute> retRouteVec;
   // the matched prefix after longest prefix matching and avoid duplicates
-  std::set<thrift::IpPrefix> matchPrefixSet;
+  std::set<folly::CIDRNetwork> matchPrefixSet;
 
   // if the params is empty, return all routes
   if (prefixes.empty()) {
     for (const auto& routes : routeState_.unicastRoutes) {
-      retRouteVec.emplace_back(routes.second);
+      retRouteVec.emplace_back(
+          RouteState::toUnicastRoute(routes.first, routes.second));
     }
     return retRouteVec;
   }
@@ -244,17 +503,19 @@ Fib::getUnicastRoutesFiltered(std::vector<std::string> prefixes) {
     }
     const auto inputPrefix = maybePrefix.value();
 
-    // do longest prefix match, add the matched prefix to the result set
-    const auto& matchedPrefix =
-        Fib::longestPrefixMatch(inputPrefix, routeState_.unicastRoutes);
-    if (matchedPrefix.has_value()) {
-      matchPrefixSet.insert(matchedPrefix.value());
+    // do longest prefix match, add the matched prefix to the result set.
+    // NOTE: Default route is never matched, same as longestPrefixMatch.
+    const auto matchedPrefix =
+        routeState_.unicastPrefixes.longestMatch(inputPrefix);
+    if (matchedPrefix.has_value() and matchedPrefix->second > 0) {
+      matchPrefixSet.insert(*matchedPrefix);
     }
   }
 
   // get the routes from the prefix set
   for (const auto& prefix : matchPrefixSet) {
-    retRouteVec.emplace_back(routeState_.unicastRoutes.at(prefix));
+    retRouteVec.emplace_back(RouteState::toUnicastRoute(
+        prefix, routeState_.unicastRoutes.at(prefix)));
   }
 
   return retRouteVec;
@@ -268,7 +529,8 @@ Fib::getMplsRoutesFiltered(std::vector<int32_t> labels) {
   // if the params is empty, return all MPLS routes
   if (labels.empty()) {
     for (const auto& routes : routeState_.mplsRoutes) {
-      retRouteVec.emplace_back(routes.second);
+      retRouteVec.emplace_back(
+          RouteState::toMplsRoute(routes.first, routes.second));
     }
     return retRouteVec;
   }
@@ -282,7 +544,8 @@ Fib::getMplsRoutesFiltered(std::vector<int32_t> labels) {
   // get the filtered MPLS routes and avoid duplicates
   for (const auto& routes : routeState_.mplsRoutes) {
     if (labelFilterSet.find(routes.first) != labelFilterSet.end()) {
-      retRouteVec.emplace_back(routes.second);
+      retRouteVec.emplace_back(
+          RouteState::toMplsRoute(routes.first, routes.second));
     }
   }
 
@@ -311,27 +574,33 @@ Fib::processRouteUpdates(thrift::RouteDatabaseDelta&& routeDelta) {
 
   // Add/Update unicast routes to update
   for (const auto& route : routeDelta.unicastRoutesToUpdate) {
-    routeState_.unicastRoutes[route.dest] = route;
+    routeState_.updateUnicastRoute(route);
     routeState_.dirtyPrefixes.erase(route.dest);
   }
 
   // Add mpls routes to update
   for (const auto& route : routeDelta.mplsRoutesToUpdate) {
-    routeState_.mplsRoutes[route.topLabel] = route;
+    routeState_.updateMplsRoute(route);
     routeState_.dirtyLabels.erase(route.topLabel);
   }
 
   // Delete unicast routes
   for (const auto& dest : routeDelta.unicastRoutesToDelete) {
-    routeState_.unicastRoutes.erase(dest);
+    routeState_.deleteUnicastRoute(dest);
     routeState_.dirtyPrefixes.erase(dest);
   }
 
   // Delete mpls routes
   for (const auto& topLabel : routeDelta.mplsRoutesToDelete) {
-    routeState_.mplsRoutes.erase(topLabel);
+    routeState_.deleteMplsRoute(topLabel);
     routeState_.dirtyLabels.erase(topLabel);
   }
+  ++routeDbGeneration_;
+
+  // Publish update of route table to subscribers, if any
+  if (fibUpdatesQueue_.getNumReaders()) {
+    fibUpdatesQueue_.push(routeDelta);
+  }
 
   // Add some counters
   fb303::fbData->addStatValue("fib.process_route_db", 1, fb303::COUNT);
@@ -348,8 +617,10 @@ Fib::processInterfaceDb(thrift::InterfaceDatabase&& interfaceDb) {
   }
 
   //
-  // Update interface states
+  // Update interface states. Interfaces not in a delta database retain
+  // their status.
   //
+  std::vector<std::string> changedInterfaces;
   for (auto const& kv : interfaceDb.interfaces) {
     const auto& ifName = kv.first;
     const auto isUp = kv.second.isUp;
@@ -366,107 +637,131 @@ Fib::processInterfaceDb(thrift::InterfaceDatabase&& interfaceDb) {
 
     // Update new status
     interfaceStatusDb_[ifName] = isUp;
+    if (wasUp != isUp) {
+      changedInterfaces.emplace_back(ifName);
+    }
+  }
+
+  // Only nexthop groups over interfaces with changed status are affected.
+  // Routes sharing a group share its best and valid best nexthops as well,
+  // hence they are computed once per group.
+  std::unordered_set<NextHopGroup const*> affectedGroups;
+  for (auto const& ifName : changedInterfaces) {
+    auto it = routeState_.interfaceGroups.find(ifName);
+    if (it != routeState_.interfaceGroups.end()) {
+      affectedGroups.insert(it->second.begin(), it->second.end());
+    }
   }
 
   thrift::RouteDatabaseDelta routeDbDelta;
   routeDbDelta.perfEvents.move_from(std::move(interfaceDb.perfEvents));
 
-  //
-  // Compute unicast route changes
-  //
-  for (auto const& kv : routeState_.unicastRoutes) {
-    auto const& route = kv.second;
-
-    // Find valid nexthops for route
-    std::vector<thrift::NextHopThrift> validNextHops;
-    for (auto const& nextHop : route.nextHops) {
-      const auto ifName = nextHop.address.ifName_ref();
-      CHECK(ifName.has_value());
-      if (folly::get_default(interfaceStatusDb_, *ifName, false)) {
-        validNextHops.emplace_back(nextHop);
-      }
-    } // end for ... kv.second
-
-    // Find previous best nexthops
-    auto prevBestNextHops = getBestNextHopsUnicast(route.nextHops);
-
-    // Find new valid best nexthops
-    auto validBestNextHops = getBestNextHopsUnicast(validNextHops);
-
-    // Remove route if no valid nexthops
-    if (not validBestNextHops.size()) {
-      VLOG(1) << "Removing prefix " << toString(route.dest)
-              << " because of no valid nextHops.";
-      routeDbDelta.unicastRoutesToDelete.emplace_back(route.dest);
-      routeState_.dirtyPrefixes.emplace(route.dest); // Mark prefix as dirty
-      continue; // Skip rest
-    }
-
-    if (validBestNextHops != prevBestNextHops) {
-      // Nexthop group shrink
-      VLOG(1) << "bestPaths group resize for prefix: " << toString(route.dest)
-              << ", old: " << prevBestNextHops.size()
-              << ", new: " << validBestNextHops.size();
-      thrift::UnicastRoute newRoute;
-      newRoute.dest = route.dest;
-      newRoute.nextHops = std::move(validBestNextHops);
-      routeDbDelta.unicastRoutesToUpdate.emplace_back(std::move(newRoute));
-      routeState_.dirtyPrefixes.emplace(route.dest); // Mark prefix as dirty
-    } else if (routeState_.dirtyPrefixes.count(route.dest)) {
-      // Nexthop group restore - previously best
-      routeDbDelta.unicastRoutesToUpdate.emplace_back(route);
-      routeState_.dirtyPrefixes.erase(route.dest); // Remove from dirty list
-    }
-  } // end for ... routeDb_.unicastRoutes
-
-  //
-  // Compute MPLS route changes
-  //
-  for (const auto& kv : routeState_.mplsRoutes) {
-    const auto& route = kv.second;
-
-    // Find valid nexthops for route
-    std::vector<thrift::NextHopThrift> validNextHops;
-    for (auto const& nextHop : route.nextHops) {
-      // We don't have ifName for `POP_AND_LOOKUP` mpls action
-      auto const ifName = nextHop.address.ifName_ref();
-      if (not ifName.has_value() or
-          folly::get_default(interfaceStatusDb_, *ifName, false)) {
-        validNextHops.emplace_back(nextHop);
-      }
+  for (auto const* group : affectedGroups) {
+    auto const& nextHops = *group;
+    auto const& groupRoutes = routeState_.groupRoutes.at(group);
+
+    //
+    // Compute unicast route changes
+    //
+    if (not groupRoutes.prefixes.empty()) {
+      // Find valid nexthops for group
+      std::vector<thrift::NextHopThrift> validNextHops;
+      for (auto const& nextHop : nextHops) {
+        const auto ifName = nextHop.address.ifName_ref();
+        CHECK(ifName.has_value());
+        if (folly::get_default(interfaceStatusDb_, *ifName, false)) {
+          validNextHops.emplace_back(nextHop);
+        }
+      } // end for ... nextHops
+
+      // Find previous best nexthops
+      const auto prevBestNextHops = getBestNextHopsUnicast(nextHops);
+
+      // Find new valid best nexthops
+      const auto validBestNextHops = getBestNextHopsUnicast(validNextHops);
+
+      for (auto const& network : groupRoutes.prefixes) {
+        const auto dest = toIpPrefix(network);
+
+        // Remove route if no valid nexthops
+        if (not validBestNextHops.size()) {
+          VLOG(1) << "Removing prefix " << toString(dest)
+                  << " because of no valid nextHops.";
+          routeDbDelta.unicastRoutesToDelete.emplace_back(dest);
+          routeState_.dirtyPrefixes.emplace(dest); // Mark prefix as dirty
+          continue; // Skip rest
+        }
+
+        if (validBestNextHops != prevBestNextHops) {
+          // Nexthop group shrink
+          VLOG(1) << "bestPaths group resize for prefix: " << toString(dest)
+                  << ", old: " << prevBestNextHops.size()
+                  << ", new: " << validBestNextHops.size();
+          thrift::UnicastRoute newRoute;
+          newRoute.dest = dest;
+          newRoute.nextHops = validBestNextHops;
+          routeDbDelta.unicastRoutesToUpdate.emplace_back(std::move(newRoute));
+          routeState_.dirtyPrefixes.emplace(dest); // Mark prefix as dirty
+        } else if (routeState_.dirtyPrefixes.count(dest)) {
+          // Nexthop group restore - previously best
+          routeDbDelta.unicastRoutesToUpdate.emplace_back(
+              RouteState::toUnicastRoute(
+                  network, routeState_.unicastRoutes.at(network)));
+          routeState_.dirtyPrefixes.erase(dest); // Remove from dirty list
+        }
+      } // end for ... groupRoutes.prefixes
     }
 
-    // Find previous best nexthops
-    auto prevBestNextHops = getBestNextHopsMpls(route.nextHops);
-
-    // Find new valid best nexthops
-    auto validBestNextHops = getBestNextHopsMpls(validNextHops);
-
-    // Remove route if no valid nexthops
-    if (not validBestNextHops.size()) {
-      VLOG(1) << "Removing label route " << route.topLabel
-              << " because of no valid nextHops.";
-      routeDbDelta.mplsRoutesToDelete.emplace_back(route.topLabel);
-      routeState_.dirtyLabels.emplace(route.topLabel); // Mark prefix as dirty
-      continue; // Skip rest
-    }
+    //
+    // Compute MPLS route changes
+    //
+    if (not groupRoutes.labels.empty()) {
+      // Find valid nexthops for group
+      std::vector<thrift::NextHopThrift> validNextHops;
+      for (auto const& nextHop : nextHops) {
+        // We don't have ifName for `POP_AND_LOOKUP` mpls action
+        auto const ifName = nextHop.address.ifName_ref();
+        if (not ifName.has_value() or
+            folly::get_default(interfaceStatusDb_, *ifName, false)) {
+          validNextHops.emplace_back(nextHop);
+        }
+      }
 
-    if (validBestNextHops != prevBestNextHops) {
-      // Nexthop group shrink
-      VLOG(1) << "bestPaths group resize for label: " << route.topLabel
-              << ", old: " << prevBestNextHops.size()
-              << ", new: " << validBestNextHops.size();
-      thrift::MplsRoute newRoute;
-      newRoute.topLabel = route.topLabel;
-      newRoute.nextHops = std::move(validBestNextHops);
-      routeDbDelta.mplsRoutesToUpdate.emplace_back(std::move(newRoute));
-      routeState_.dirtyLabels.emplace(route.topLabel);
-    } else if (routeState_.dirtyLabels.count(route.topLabel)) {
-      // Nexthop group restore - previously best
-      routeDbDelta.mplsRoutesToUpdate.emplace_back(route);
-      routeState_.dirtyLabels.erase(route.topLabel); // Remove from dirty list
+      // Find previous best nexthops
+      const auto prevBestNextHops = getBestNextHopsMpls(nextHops);
+
+      // Find new valid best nexthops
+      const auto validBestNextHops = getBestNextHopsMpls(validNextHops);
+
+      for (const auto topLabel : groupRoutes.labels) {
+        // Remove route if no valid nexthops
+        if (not validBestNextHops.size()) {
+          VLOG(1) << "Removing label route " << topLabel
+                  << " because of no valid nextHops.";
+          routeDbDelta.mplsRoutesToDelete.emplace_back(topLabel);
+          routeState_.dirtyLabels.emplace(topLabel); // Mark prefix as dirty
+          continue; // Skip rest
+        }
+
+        if (validBestNextHops != prevBestNextHops) {
+          // Nexthop group shrink
+          VLOG(1) << "bestPaths group resize for label: " << topLabel
+                  << ", old: " << prevBestNextHops.size()
+                  << ", new: " << validBestNextHops.size();
+          thrift::MplsRoute newRoute;
+          newRoute.topLabel = topLabel;
+          newRoute.nextHops = validBestNextHops;
+          routeDbDelta.mplsRoutesToUpdate.emplace_back(std::move(newRoute));
+          routeState_.dirtyLabels.emplace(topLabel);
+        } else if (routeState_.dirtyLabels.count(topLabel)) {
+          // Nexthop group restore - previously best
+          routeDbDelta.mplsRoutesToUpdate.emplace_back(RouteState::toMplsRoute(
+              topLabel, routeState_.mplsRoutes.at(topLabel)));
+          routeState_.dirtyLabels.erase(topLabel); // Remove from dirty list
+        }
+      } // end for ... groupRoutes.labels
     }
-  } // end for ... routeDb_.mplsRoutes
+  } // end for ... affectedGroups
 
   updateRoutes(routeDbDelta);
 }
@@ -553,41 +848,257 @@ Fib::updateRoutes(const thrift::RouteDatabaseDelta& routeDbDelta) {
     return;
   }
 
-  // Make thrift calls to do real programming
+  // Make thrift calls to do real programming. Routes of each kind are
+  // programmed in pipelined chunks. Deletes go ahead of adds, unless route
+  // priority is enabled.
+  RoutesProgrammed programmed;
+  const auto startTime = std::chrono::steady_clock::now();
   try {
-    uint32_t numOfRouteUpdates = 0;
-    createFibClient(evb_, socket_, client_, thriftPort_);
-    if (routeDbDelta.unicastRoutesToDelete.size()) {
-      numOfRouteUpdates += routeDbDelta.unicastRoutesToDelete.size();
-      client_->sync_deleteUnicastRoutes(
-          kFibId_, routeDbDelta.unicastRoutesToDelete);
-    }
-    if (patchedUnicastRoutesToUpdate.size()) {
-      numOfRouteUpdates += patchedUnicastRoutesToUpdate.size();
-      client_->sync_addUnicastRoutes(kFibId_, patchedUnicastRoutesToUpdate);
-    }
-    if (enableSegmentRouting_ && routeDbDelta.mplsRoutesToDelete.size()) {
-      numOfRouteUpdates += routeDbDelta.mplsRoutesToDelete.size();
-      client_->sync_deleteMplsRoutes(kFibId_, routeDbDelta.mplsRoutesToDelete);
+    createClient();
+    auto programDeletes = [&]() {
+      programmed.unicastRoutesToDelete = programInChunks(
+          routeDbDelta.unicastRoutesToDelete, [this](auto chunk) {
+            return client_->deleteUnicastRoutes(kFibId_, std::move(chunk));
+          });
+      if (enableSegmentRouting_) {
+        programmed.mplsRoutesToDelete = programInChunks(
+            routeDbDelta.mplsRoutesToDelete, [this](auto chunk) {
+              return client_->deleteMplsRoutes(kFibId_, std::move(chunk));
+            });
+      }
+    };
+    auto programAdds = [&]() {
+      programmed.unicastRoutesToUpdate =
+          programUnicastRoutes(routeDbDelta, patchedUnicastRoutesToUpdate);
+      if (enableSegmentRouting_) {
+        programmed.mplsRoutesToUpdate = programInChunks(
+            mplsRoutesToUpdate, [this](auto chunk) {
+              return client_->addMplsRoutes(kFibId_, std::move(chunk));
+            });
+      }
+    };
+    if (enableRoutePriority_) {
+      programAdds();
+      programDeletes();
+    } else {
+      programDeletes();
+      programAdds();
     }
-    if (enableSegmentRouting_ && mplsRoutesToUpdate.size()) {
-      numOfRouteUpdates += mplsRoutesToUpdate.size();
-      client_->sync_addMplsRoutes(kFibId_, mplsRoutesToUpdate);
+
+    uint32_t numOfRouteUpdates = routeDbDelta.unicastRoutesToDelete.size() +
+        patchedUnicastRoutesToUpdate.size();
+    if (enableSegmentRouting_) {
+      numOfRouteUpdates +=
+          routeDbDelta.mplsRoutesToDelete.size() + mplsRoutesToUpdate.size();
     }
     fb303::fbData->addStatValue(
         "fib.num_of_route_updates", numOfRouteUpdates, fb303::SUM);
-    routeState_.dirtyRouteDb = false;
-    logPerfEvents(castToStd(routeDbDelta.perfEvents));
-    LOG(INFO) << "Done processing route add/update";
   } catch (const std::exception& e) {
     fb303::fbData->addStatValue(
         "fib.thrift.failure.add_del_route", 1, fb303::COUNT);
-    client_.reset();
-    routeState_.dirtyRouteDb = true;
-    syncRouteDbDebounced(); // Schedule future full sync of route DB
     LOG(ERROR) << "Failed to make thrift call to FibAgent. Error: "
                << folly::exceptionStr(e);
   }
+  fb303::fbData->addHistogramValue(
+      "fib.latency.route_program_ms",
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - startTime)
+          .count());
+
+  // Retry routes which failed to program on their own. Full sync of route DB
+  // is left for agent restart.
+  if (updateFailedRoutes(routeDbDelta, programmed) == 0) {
+    logPerfEvents(castToStd(routeDbDelta.perfEvents));
+    LOG(INFO) << "Done processing route add/update";
+    return;
+  }
+  client_.reset();
+  if (not retryRoutesTimer_->isScheduled()) {
+    retryRoutesTimer_->scheduleTimeout(
+        retryRoutesExpBackoff_.getTimeRemainingUntilRetry());
+  }
+}
+
+template <typename T, typename Call>
+std::vector<bool>
+Fib::programInChunks(std::vector<T> const& items, Call const& call) {
+  const size_t chunkSize = Constants::kFibRouteProgrammingChunkSize;
+  std::vector<bool> programmed(items.size(), false);
+
+  // In-flight calls, along with index of first item of their chunk
+  std::deque<std::pair<size_t, folly::Future<folly::Unit>>> inFlight;
+  auto completeOldest = [&]() {
+    const auto begin = inFlight.front().first;
+    auto result = std::move(inFlight.front().second).getTryVia(&evb_);
+    inFlight.pop_front();
+    if (result.hasException()) {
+      fb303::fbData->addStatValue(
+          "fib.thrift.failure.add_del_route", 1, fb303::COUNT);
+      LOG(ERROR) << "Failed to program chunk of routes with FibAgent. Error: "
+                 << result.exception().what();
+      return;
+    }
+    const auto end = std::min(begin + chunkSize, items.size());
+    std::fill(programmed.begin() + begin, programmed.begin() + end, true);
+  };
+
+  for (size_t begin = 0; begin < items.size(); begin += chunkSize) {
+    if (inFlight.size() >= routeProgrammingWindow_) {
+      completeOldest();
+    }
+    std::vector<T> chunk(
+        items.begin() + begin,
+        items.begin() + std::min(begin + chunkSize, items.size()));
+    fb303::fbData->addHistogramValue("fib.routes_per_call", chunk.size());
+    inFlight.emplace_back(
+        begin,
+        folly::makeSemiFutureWith([&]() {
+          return call(std::move(chunk));
+        }).via(&evb_));
+  }
+  while (not inFlight.empty()) {
+    completeOldest();
+  }
+  return programmed;
+}
+
+std::vector<bool>
+Fib::programUnicastRoutes(
+    const thrift::RouteDatabaseDelta& routeDbDelta,
+    const std::vector<thrift::UnicastRoute>& patchedRoutes) {
+  auto addRoutes = [this](auto chunk) {
+    return client_->addUnicastRoutes(kFibId_, std::move(chunk));
+  };
+  if (not enableRoutePriority_) {
+    return programInChunks(patchedRoutes, addRoutes);
+  }
+
+  // Split into priority routes and the rest, by index into delta. Patched
+  // routes lack prefix type, so look at routes of delta.
+  std::vector<size_t> priorityIndices;
+  std::vector<size_t> otherIndices;
+  for (size_t i = 0; i < patchedRoutes.size(); ++i) {
+    if (isPriorityRoute(routeDbDelta.unicastRoutesToUpdate.at(i))) {
+      priorityIndices.emplace_back(i);
+    } else {
+      otherIndices.emplace_back(i);
+    }
+  }
+  fb303::fbData->addStatValue(
+      "fib.num_of_priority_route_updates", priorityIndices.size(), fb303::SUM);
+
+  // Priority routes complete before rest of routes starts
+  std::vector<bool> programmed(patchedRoutes.size(), false);
+  for (auto const* indices : {&priorityIndices, &otherIndices}) {
+    std::vector<thrift::UnicastRoute> routes;
+    routes.reserve(indices->size());
+    for (auto const i : *indices) {
+      routes.emplace_back(patchedRoutes.at(i));
+    }
+    const auto routesProgrammed = programInChunks(routes, addRoutes);
+    for (size_t j = 0; j < indices->size(); ++j) {
+      programmed[indices->at(j)] = routesProgrammed[j];
+    }
+  }
+  return programmed;
+}
+
+bool
+Fib::isPriorityRoute(const thrift::UnicastRoute& route) {
+  if (route.prefixType_ref().has_value() and
+      *route.prefixType_ref() == thrift::PrefixType::LOOPBACK) {
+    return true;
+  }
+  // Host route
+  return static_cast<size_t>(route.dest.prefixLength) ==
+      route.dest.prefixAddress.addr.size() * 8;
+}
+
+size_t
+Fib::updateFailedRoutes(
+    const thrift::RouteDatabaseDelta& routeDbDelta,
+    const RoutesProgrammed& programmed) {
+  auto& failedUnicastRoutes = routeState_.failedUnicastRoutes;
+  auto& failedMplsRoutes = routeState_.failedMplsRoutes;
+  // Items which didn't make it into a call count as failed
+  auto isProgrammed = [](std::vector<bool> const& flags, size_t i) {
+    return i < flags.size() and flags[i];
+  };
+
+  size_t numFailed{0};
+  auto const& unicastToDelete = routeDbDelta.unicastRoutesToDelete;
+  for (size_t i = 0; i < unicastToDelete.size(); ++i) {
+    if (isProgrammed(programmed.unicastRoutesToDelete, i)) {
+      failedUnicastRoutes.erase(unicastToDelete[i]);
+    } else {
+      failedUnicastRoutes[unicastToDelete[i]] = std::nullopt;
+      ++numFailed;
+    }
+  }
+  auto const& unicastToUpdate = routeDbDelta.unicastRoutesToUpdate;
+  for (size_t i = 0; i < unicastToUpdate.size(); ++i) {
+    if (isProgrammed(programmed.unicastRoutesToUpdate, i)) {
+      failedUnicastRoutes.erase(unicastToUpdate[i].dest);
+    } else {
+      failedUnicastRoutes[unicastToUpdate[i].dest] = unicastToUpdate[i];
+      ++numFailed;
+    }
+  }
+  if (not enableSegmentRouting_) {
+    return numFailed;
+  }
+  auto const& mplsToDelete = routeDbDelta.mplsRoutesToDelete;
+  for (size_t i = 0; i < mplsToDelete.size(); ++i) {
+    if (isProgrammed(programmed.mplsRoutesToDelete, i)) {
+      failedMplsRoutes.erase(mplsToDelete[i]);
+    } else {
+      failedMplsRoutes[mplsToDelete[i]] = std::nullopt;
+      ++numFailed;
+    }
+  }
+  auto const& mplsToUpdate = routeDbDelta.mplsRoutesToUpdate;
+  for (size_t i = 0; i < mplsToUpdate.size(); ++i) {
+    if (isProgrammed(programmed.mplsRoutesToUpdate, i)) {
+      failedMplsRoutes.erase(mplsToUpdate[i].topLabel);
+    } else {
+      failedMplsRoutes[mplsToUpdate[i].topLabel] = mplsToUpdate[i];
+      ++numFailed;
+    }
+  }
+  return numFailed;
+}
+
+void
+Fib::retryFailedRoutes() {
+  thrift::RouteDatabaseDelta routeDbDelta;
+  routeDbDelta.thisNodeName = myNodeName_;
+  for (auto& kv : routeState_.failedUnicastRoutes) {
+    if (kv.second.has_value()) {
+      routeDbDelta.unicastRoutesToUpdate.emplace_back(std::move(*kv.second));
+    } else {
+      routeDbDelta.unicastRoutesToDelete.emplace_back(kv.first);
+    }
+  }
+  for (auto& kv : routeState_.failedMplsRoutes) {
+    if (kv.second.has_value()) {
+      routeDbDelta.mplsRoutesToUpdate.emplace_back(std::move(*kv.second));
+    } else {
+      routeDbDelta.mplsRoutesToDelete.emplace_back(kv.first);
+    }
+  }
+  // Routes failing again are put back by updateRoutes(). If a full sync is
+  // due instead, it covers all of them.
+  routeState_.failedUnicastRoutes.clear();
+  routeState_.failedMplsRoutes.clear();
+
+  const auto numUnicastRoutes = routeDbDelta.unicastRoutesToUpdate.size() +
+      routeDbDelta.unicastRoutesToDelete.size();
+  const auto numMplsRoutes = routeDbDelta.mplsRoutesToUpdate.size() +
+      routeDbDelta.mplsRoutesToDelete.size();
+  LOG(INFO) << "Retrying programming of " << numUnicastRoutes
+            << " unicast and " << numMplsRoutes << " mpls routes";
+  fb303::fbData->addStatValue("fib.retry_failed_routes", 1, fb303::COUNT);
+  updateRoutes(routeDbDelta);
 }
 
 bool
@@ -595,10 +1106,18 @@ Fib::syncRouteDb() {
   LOG(INFO) << "Syncing latest routeDb with fib-agent with "
             << routeState_.unicastRoutes.size() << " routes";
 
-  const auto& unicastRoutes =
-      createUnicastRoutesWithBestNextHopsMap(routeState_.unicastRoutes);
-  const auto& mplsRoutes =
-      createMplsRoutesWithBestNextHopsMap(routeState_.mplsRoutes);
+  std::vector<thrift::UnicastRoute> unicastRoutes;
+  unicastRoutes.reserve(routeState_.unicastRoutes.size());
+  for (auto const& kv : routeState_.unicastRoutes) {
+    unicastRoutes.emplace_back(createUnicastRoute(
+        toIpPrefix(kv.first), getBestNextHopsUnicast(*kv.second.nextHops)));
+  }
+  std::vector<thrift::MplsRoute> mplsRoutes;
+  mplsRoutes.reserve(routeState_.mplsRoutes.size());
+  for (auto const& kv : routeState_.mplsRoutes) {
+    mplsRoutes.emplace_back(createMplsRoute(
+        kv.first, getBestNextHopsMpls(*kv.second.nextHops)));
+  }
 
   // In dry run we just print the routes. No real action
   if (dryrun_) {
@@ -625,19 +1144,32 @@ Fib::syncRouteDb() {
   }
 
   try {
-    createFibClient(evb_, socket_, client_, thriftPort_);
+    createClient();
     fb303::fbData->addStatValue("fib.sync_fib_calls", 1, fb303::COUNT);
 
-    // Sync unicast routes
-    client_->sync_syncFib(kFibId_, unicastRoutes);
-    routeState_.dirtyPrefixes.clear();
+    if (enableWarmSync_) {
+      syncRoutesByDelta(std::move(unicastRoutes), std::move(mplsRoutes));
+    } else {
+      // Sync unicast routes. Empty route table is a single call either way.
+      if (enableChunkedSync_ and not unicastRoutes.empty()) {
+        syncUnicastRoutesInChunks(unicastRoutes);
+      } else {
+        client_->syncFib(kFibId_, std::move(unicastRoutes));
+      }
 
-    // Sync mpls routes
-    if (enableSegmentRouting_) {
-      client_->sync_syncMplsFib(kFibId_, mplsRoutes);
+      // Sync mpls routes
+      if (enableSegmentRouting_) {
+        client_->syncMplsFib(kFibId_, std::move(mplsRoutes));
+      }
     }
+    routeState_.dirtyPrefixes.clear();
     routeState_.dirtyLabels.clear();
 
+    // Full sync covers failed routes as well
+    routeState_.failedUnicastRoutes.clear();
+    routeState_.failedMplsRoutes.clear();
+    retryRoutesTimer_->cancelTimeout();
+
     routeState_.dirtyRouteDb = false;
     LOG(INFO) << "Done syncing latest routeDb with fib-agent";
     return true;
@@ -651,6 +1183,95 @@ Fib::syncRouteDb() {
   }
 }
 
+void
+Fib::syncUnicastRoutesInChunks(
+    const std::vector<thrift::UnicastRoute>& unicastRoutes) {
+  const size_t chunkSize = Constants::kFibRouteProgrammingChunkSize;
+  const int64_t syncId = ++syncId_;
+  const int32_t numChunks = (unicastRoutes.size() + chunkSize - 1) / chunkSize;
+
+  // Chunks are sent in order
+  int32_t chunkIndex{0};
+  const auto programmed = programInChunks(
+      unicastRoutes, [this, syncId, numChunks, &chunkIndex](auto chunk) {
+        thrift::UnicastRouteSyncChunk syncChunk;
+        syncChunk.syncId = syncId;
+        syncChunk.numChunks = numChunks;
+        syncChunk.chunkIndex = chunkIndex++;
+        syncChunk.routes = std::move(chunk);
+        return client_->syncFibChunk(kFibId_, std::move(syncChunk));
+      });
+  if (std::find(programmed.begin(), programmed.end(), false) !=
+      programmed.end()) {
+    throw std::runtime_error(folly::sformat("Chunked sync {} failed", syncId));
+  }
+}
+
+void
+Fib::syncRoutesByDelta(
+    std::vector<thrift::UnicastRoute> unicastRoutes,
+    std::vector<thrift::MplsRoute> mplsRoutes) {
+  thrift::RouteDatabase agentRouteDb;
+  thrift::RouteDatabase newRouteDb;
+  agentRouteDb.unicastRoutes = client_->getRouteTableByClient(kFibId_);
+  for (auto& route : agentRouteDb.unicastRoutes) {
+    route = toAgentUnicastRoute(route);
+  }
+  for (auto const& route : unicastRoutes) {
+    newRouteDb.unicastRoutes.emplace_back(toAgentUnicastRoute(route));
+  }
+  if (enableSegmentRouting_) {
+    agentRouteDb.mplsRoutes = client_->getMplsRouteTableByClient(kFibId_);
+    for (auto& route : agentRouteDb.mplsRoutes) {
+      route = toAgentMplsRoute(route);
+    }
+    for (auto const& route : mplsRoutes) {
+      newRouteDb.mplsRoutes.emplace_back(toAgentMplsRoute(route));
+    }
+  }
+  for (auto* routeDb : {&agentRouteDb, &newRouteDb}) {
+    std::sort(routeDb->unicastRoutes.begin(), routeDb->unicastRoutes.end());
+    std::sort(routeDb->mplsRoutes.begin(), routeDb->mplsRoutes.end());
+  }
+
+  const auto routeDbDelta = findDeltaRoutes(newRouteDb, agentRouteDb);
+  LOG(INFO) << "Warm sync of " << newRouteDb.unicastRoutes.size()
+            << " unicast routes with agent, programming "
+            << routeDbDelta.unicastRoutesToUpdate.size() << " and deleting "
+            << routeDbDelta.unicastRoutesToDelete.size() << " of them";
+  fb303::fbData->addStatValue(
+      "fib.warm_sync.num_routes_programmed",
+      routeDbDelta.unicastRoutesToUpdate.size() +
+          routeDbDelta.unicastRoutesToDelete.size() +
+          routeDbDelta.mplsRoutesToUpdate.size() +
+          routeDbDelta.mplsRoutesToDelete.size(),
+      fb303::SUM);
+
+  // Stale routes are deleted ahead of adds, as in regular deltas
+  std::vector<std::vector<bool>> programmed;
+  programmed.emplace_back(programInChunks(
+      routeDbDelta.unicastRoutesToDelete, [this](auto chunk) {
+        return client_->deleteUnicastRoutes(kFibId_, std::move(chunk));
+      }));
+  programmed.emplace_back(programInChunks(
+      routeDbDelta.mplsRoutesToDelete, [this](auto chunk) {
+        return client_->deleteMplsRoutes(kFibId_, std::move(chunk));
+      }));
+  programmed.emplace_back(programInChunks(
+      routeDbDelta.unicastRoutesToUpdate, [this](auto chunk) {
+        return client_->addUnicastRoutes(kFibId_, std::move(chunk));
+      }));
+  programmed.emplace_back(programInChunks(
+      routeDbDelta.mplsRoutesToUpdate, [this](auto chunk) {
+        return client_->addMplsRoutes(kFibId_, std::move(chunk));
+      }));
+  for (auto const& results : programmed) {
+    if (std::find(results.begin(), results.end(), false) != results.end()) {
+      throw std::runtime_error("Warm sync failed to program routes");
+    }
+  }
+}
+
 void
 Fib::syncRouteDbDebounced() {
   if (!syncRoutesTimer_->isScheduled()) {
@@ -661,8 +1282,8 @@ Fib::syncRouteDbDebounced() {
 
 void
 Fib::keepAliveCheck() {
-  createFibClient(evb_, socket_, client_, thriftPort_);
-  int64_t aliveSince = client_->sync_aliveSince();
+  createClient();
+  int64_t aliveSince = client_->aliveSince();
   // Check if FIB has restarted or not
   if (aliveSince != latestAliveSince_) {
     LOG(WARNING) << "FibAgent seems to have restarted. "
@@ -675,6 +1296,27 @@ Fib::keepAliveCheck() {
   latestAliveSince_ = aliveSince;
 }
 
+void
+Fib::createClient() {
+  if (fibHandler_) {
+    if (not client_) {
+      client_ = std::make_unique<FibServiceClient>(fibHandler_);
+    }
+    return;
+  }
+
+  // Reset client if channel is not good
+  if (socket_ && (!socket_->good() || socket_->hangup())) {
+    client_.reset();
+  }
+  if (client_) {
+    return;
+  }
+  std::unique_ptr<thrift::FibServiceAsyncClient> client;
+  createFibClient(evb_, socket_, client, thriftPort_);
+  client_ = std::make_unique<FibServiceClient>(std::move(client));
+}
+
 void
 Fib::createFibClient(
     folly::EventBase& evb,
@@ -725,11 +1367,18 @@ Fib::updateGlobalCounters() {
       "fib.num_dirty_prefixes", routeState_.dirtyPrefixes.size());
   fb303::fbData->setCounter(
       "fib.num_dirty_labels", routeState_.dirtyLabels.size());
+  fb303::fbData->setCounter(
+      "fib.num_nexthop_groups", routeState_.nextHopGroups.size());
+  fb303::fbData->setCounter(
+      "fib.num_failed_routes",
+      routeState_.failedUnicastRoutes.size() +
+          routeState_.failedMplsRoutes.size());
 
   // Count the number of bgp routes
   int64_t bgpCounter = 0;
   for (const auto& route : routeState_.unicastRoutes) {
-    if (route.second.bestNexthop.has_value()) {
+    auto const& attributes = route.second.attributes;
+    if (attributes and attributes->bestNexthop.has_value()) {
       bgpCounter++;
     }
   }
@@ -789,6 +1438,21 @@ Fib::logPerfEvents(std::optional<thrift::PerfEvents> perfEvents) {
     return;
   }
 
+  // Export convergence duration counter
+  fb303::fbData->addStatValue(
+      "fib.convergence_time_ms", totalDuration.count(), fb303::AVG);
+  fb303::fbData->addHistogramValue(
+      "fib.latency.convergence_ms", totalDuration.count());
+
+  // Rest of reporting is sampled, by trace id when present so that all nodes
+  // keep the same traces
+  const auto sampleId = perfEvents->traceId_ref().has_value()
+      ? static_cast<uint64_t>(*perfEvents->traceId_ref())
+      : numOfPerfEvents_++;
+  if (sampleId % perfEventSampleRate_ != 0) {
+    return;
+  }
+
   // Log event
   auto eventStrs = sprintPerfEvents(*perfEvents);
   LOG(INFO) << "OpenR convergence performance. "
@@ -803,20 +1467,13 @@ Fib::logPerfEvents(std::optional<thrift::PerfEvents> perfEvents) {
     perfDb_.pop_front();
   }
 
-  // Export convergence duration counter
-  fb303::fbData->addStatValue(
-      "fib.convergence_time_ms", totalDuration.count(), fb303::AVG);
-
   // Log via zmq monitor
   fbzmq::LogSample sample{};
   sample.addString("event", "ROUTE_CONVERGENCE");
   sample.addString("node_name", myNodeName_);
   sample.addStringVector("perf_events", eventStrs);
   sample.addInt("duration_ms", totalDuration.count());
-  zmqMonitorClient_->addEventLog(fbzmq::thrift::EventLog(
-      apache::thrift::FRAGILE,
-      Constants::kEventLogCategory.toString(),
-      {sample.toJson()}));
+  eventLogger_->log(std::move(sample));
 }
 
 } // namespace openr
@@ -7,24 +7,32 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <boost/serialization/strong_typedef.hpp>
-#include <fbzmq/service/monitor/ZmqMonitorClient.h>
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/container/F14Map.h>
+#include <folly/container/F14Set.h>
 #include <folly/io/async/AsyncSocket.h>
 #include <folly/io/async/AsyncTimeout.h>
 #include <folly/io/async/EventBase.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include <openr/common/ExponentialBackoff.h>
+#include <openr/common/EventLogger.h>
 #include <openr/common/OpenrEventBase.h>
 #include <openr/common/Util.h>
 #include <openr/config/Config.h>
+#include <openr/fib/NextHopGroups.h>
+#include <openr/fib/PrefixTrie.h>
 #include <openr/if/gen-cpp2/FibService.h>
 #include <openr/if/gen-cpp2/Fib_types.h>
 #include <openr/if/gen-cpp2/LinkMonitor_types.h>
 #include <openr/if/gen-cpp2/Platform_types.h>
 #include <openr/kvstore/KvStoreClientInternal.h>
 #include <openr/messaging/Queue.h>
+#include <openr/messaging/ReplicateQueue.h>
+#include <openr/platform/PlatformClients.h>
 
 namespace openr {
 
@@ -55,9 +63,11 @@ class Fib final : public OpenrEventBase {
       std::chrono::seconds coldStartDuration,
       messaging::RQueue<thrift::RouteDatabaseDelta> routeUpdatesQueue,
       messaging::RQueue<thrift::InterfaceDatabase> interfaceUpdatesQueue,
+      messaging::ReplicateQueue<thrift::RouteDatabaseDelta>& fibUpdatesQueue,
       const MonitorSubmitUrl& monitorSubmitUrl,
       KvStore* kvStore,
-      fbzmq::Context& zmqContext);
+      fbzmq::Context& zmqContext,
+      std::shared_ptr<thrift::FibServiceSvIf> fibHandler = nullptr);
 
   /**
    * Utility function to create thrift client connection to SwitchAgent. Can
@@ -82,6 +92,12 @@ class Fib final : public OpenrEventBase {
       const std::unordered_map<thrift::IpPrefix, thrift::UnicastRoute>&
           unicastRoutes);
 
+  /**
+   * Whether route is programmed ahead of others with route priority. These
+   * are host routes, e.g. of loopback addresses, and loopback prefixes.
+   */
+  static bool isPriorityRoute(const thrift::UnicastRoute& route);
+
   /**
    * NOTE: DEPRECATED! Use getUnicastRoutes or getMplsRoutes.
    */
@@ -106,6 +122,31 @@ class Fib final : public OpenrEventBase {
    */
   folly::SemiFuture<std::unique_ptr<thrift::PerfDatabase>> getPerfDb();
 
+  /**
+   * Get reader for route updates applied to route table of Fib, i.e. routes
+   * of getRouteDb
+   */
+  messaging::RQueue<thrift::RouteDatabaseDelta>
+  getFibUpdatesReader() {
+    return fibUpdatesQueue_.getReader();
+  }
+
+  /**
+   * Generation of routes of getRouteDb, bumped on each of their updates. Can
+   * be read from any thread
+   */
+  int64_t
+  getRouteDbGeneration() const {
+    return routeDbGeneration_.load();
+  }
+
+  /**
+   * Reader options bounding pending route updates for Fib. Overflowing
+   * route updates are merged with mergeRouteDeltas() and aren't lost.
+   */
+  static messaging::ReaderOptions<thrift::RouteDatabaseDelta>
+  getRouteUpdatesReaderOptions();
+
  private:
   // No-copy
   Fib(const Fib&) = delete;
@@ -146,6 +187,60 @@ class Fib final : public OpenrEventBase {
    */
   void updateRoutes(const thrift::RouteDatabaseDelta& routeDbDelta);
 
+  // Whether each route of delta has been programmed, in order of delta
+  struct RoutesProgrammed {
+    std::vector<bool> unicastRoutesToDelete;
+    std::vector<bool> unicastRoutesToUpdate;
+    std::vector<bool> mplsRoutesToDelete;
+    std::vector<bool> mplsRoutesToUpdate;
+  };
+
+  /**
+   * Program items with `call` in chunks of kFibRouteProgrammingChunkSize,
+   * keeping up to routeProgrammingWindow_ calls in flight. Chunks are moved
+   * into `call`. Returns whether each item has been programmed.
+   */
+  template <typename T, typename Call>
+  std::vector<bool> programInChunks(
+      std::vector<T> const& items, Call const& call);
+
+  /**
+   * Program unicast routes to add of delta, priority routes ahead of rest if
+   * enabled
+   */
+  std::vector<bool> programUnicastRoutes(
+      const thrift::RouteDatabaseDelta& routeDbDelta,
+      const std::vector<thrift::UnicastRoute>& patchedRoutes);
+
+  /**
+   * Full sync of unicast routes with agent in pipelined chunks. Throws if any
+   * chunk fails.
+   */
+  void syncUnicastRoutesInChunks(
+      const std::vector<thrift::UnicastRoute>& unicastRoutes);
+
+  /**
+   * Full sync of routes with agent by reading its current routes, and only
+   * programming routes which differ and deleting stale ones. Throws if any
+   * call fails.
+   */
+  void syncRoutesByDelta(
+      std::vector<thrift::UnicastRoute> unicastRoutes,
+      std::vector<thrift::MplsRoute> mplsRoutes);
+
+  /**
+   * Update failed routes of RouteState after programming routeDbDelta.
+   * Returns number of routes which failed.
+   */
+  size_t updateFailedRoutes(
+      const thrift::RouteDatabaseDelta& routeDbDelta,
+      const RoutesProgrammed& programmed);
+
+  /**
+   * Program routes which failed to program previously
+   */
+  void retryFailedRoutes();
+
   /**
    * Sync the current routeDb_ with the switch agent.
    * on success no action needed
@@ -165,6 +260,12 @@ class Fib final : public OpenrEventBase {
    */
   void keepAliveCheck();
 
+  /**
+   * Create client_ of FibService if there is none, or if its thrift
+   * connection went bad
+   */
+  void createClient();
+
   // set flat counter/stats
   void updateGlobalCounters();
 
@@ -174,9 +275,58 @@ class Fib final : public OpenrEventBase {
   // Prefix to available nexthop information. Also store perf information of
   // received route-db if provided.
   struct RouteState {
-    // Non modified copy of Unicast and MPLS routes received from Decision
-    std::unordered_map<thrift::IpPrefix, thrift::UnicastRoute> unicastRoutes;
-    std::unordered_map<uint32_t, thrift::MplsRoute> mplsRoutes;
+    // Route as stored in RouteState. Nexthops are shared with all routes of
+    // same nexthops. Rest of route attributes, if any is set, are kept aside
+    // with destination and nexthops left empty.
+    template <typename RouteType>
+    struct RouteEntry {
+      std::shared_ptr<const NextHopGroup> nextHops;
+      std::unique_ptr<RouteType> attributes;
+    };
+
+    // Add or replace route
+    void updateUnicastRoute(thrift::UnicastRoute route);
+    void updateMplsRoute(thrift::MplsRoute route);
+
+    // Remove route, if any
+    void deleteUnicastRoute(const thrift::IpPrefix& dest);
+    void deleteMplsRoute(uint32_t topLabel);
+
+    // Convert stored route back to thrift
+    static thrift::UnicastRoute toUnicastRoute(
+        const folly::CIDRNetwork& dest,
+        const RouteEntry<thrift::UnicastRoute>& entry);
+    static thrift::MplsRoute toMplsRoute(
+        uint32_t topLabel, const RouteEntry<thrift::MplsRoute>& entry);
+
+    // Nexthop groups of routes. Declared ahead of routes as it must outlive
+    // them.
+    NextHopGroups nextHopGroups;
+
+    // Non modified copy of Unicast and MPLS routes received from Decision,
+    // keyed by destination (unmasked) and top label
+    folly::F14FastMap<folly::CIDRNetwork, RouteEntry<thrift::UnicastRoute>>
+        unicastRoutes;
+    folly::F14FastMap<uint32_t, RouteEntry<thrift::MplsRoute>> mplsRoutes;
+
+    // Longest prefix match index of unicastRoutes keys
+    PrefixTrie unicastPrefixes;
+
+    // Reverse index of routes by nexthop group, and of nexthop groups by
+    // interface of their nexthops. Interface events are processed for affected
+    // routes only.
+    struct GroupRoutes {
+      folly::F14FastSet<folly::CIDRNetwork> prefixes;
+      folly::F14FastSet<uint32_t> labels;
+    };
+    std::unordered_map<NextHopGroup const*, GroupRoutes> groupRoutes;
+    std::unordered_map<std::string, std::unordered_set<NextHopGroup const*>>
+        interfaceGroups;
+
+    // Add/remove group of route to/from reverse index. Group is dropped from
+    // index along with its last route.
+    GroupRoutes& indexGroup(NextHopGroup const& group);
+    void unindexGroup(NextHopGroup const& group);
 
     // indicates we've received a decision route publication and therefore have
     // routes to sync. will not synce routes with system until this is set
@@ -197,9 +347,20 @@ class Fib final : public OpenrEventBase {
     // successfully synced with agent, we have to trigger an enforced full fib
     // sync with agent again
     bool dirtyRouteDb{false};
+
+    // Routes of delta programming which failed. They are retried with
+    // retryRoutesTimer_ instead of full sync, till programmed or superseded.
+    // Map value is route to add, or none to delete.
+    std::unordered_map<thrift::IpPrefix, std::optional<thrift::UnicastRoute>>
+        failedUnicastRoutes;
+    std::unordered_map<uint32_t, std::optional<thrift::MplsRoute>>
+        failedMplsRoutes;
   };
   RouteState routeState_;
 
+  // see getRouteDbGeneration()
+  std::atomic<int64_t> routeDbGeneration_{0};
+
   // Events to capture and indicate performance of protocol convergence.
   std::deque<thrift::PerfEvents> perfDb_;
 
@@ -225,24 +386,51 @@ class Fib final : public OpenrEventBase {
   // indicates that we should publish fib programming time to kvstore
   bool enableOrderedFib_{false};
 
+  // Max number of route programming calls in flight to agent
+  size_t routeProgrammingWindow_{1};
+
+  // Program priority routes first, and deletes after adds
+  bool enableRoutePriority_{false};
+
+  // Full sync of unicast routes in chunks, identified by syncId_. Starts from
+  // time of construction, so that it never repeats one of previous instance.
+  bool enableChunkedSync_{false};
+  int64_t syncId_{0};
+
+  // Full sync programs difference to current routes of agent
+  bool enableWarmSync_{false};
+
+  // Log one in every perfEventSampleRate_ perf event chains
+  uint32_t perfEventSampleRate_{1};
+  uint64_t numOfPerfEvents_{0};
+
   apache::thrift::CompactSerializer serializer_;
 
-  // Thrift client connection to switch FIB Agent using which we actually
-  // manipulate routes.
+  // Client of switch FIB Agent using which we actually manipulate routes.
+  // Agent running in-process is called directly via its handler, through
+  // thrift connection otherwise.
   folly::EventBase evb_;
   std::shared_ptr<folly::AsyncSocket> socket_{nullptr};
-  std::unique_ptr<thrift::FibServiceAsyncClient> client_{nullptr};
+  std::shared_ptr<thrift::FibServiceSvIf> fibHandler_{nullptr};
+  std::unique_ptr<FibServiceClient> client_{nullptr};
 
   // Callback timer to sync routes to switch agent and scheduled on route-sync
   // failure. ExponentialBackoff timer to ease up things if they go wrong
   std::unique_ptr<folly::AsyncTimeout> syncRoutesTimer_{nullptr};
   ExponentialBackoff<std::chrono::milliseconds> expBackoff_;
 
+  // Callback timer to retry failed routes of RouteState, with its own backoff
+  std::unique_ptr<folly::AsyncTimeout> retryRoutesTimer_{nullptr};
+  ExponentialBackoff<std::chrono::milliseconds> retryRoutesExpBackoff_;
+
   // periodically send alive msg to switch agent
   std::unique_ptr<folly::AsyncTimeout> keepAliveTimer_{nullptr};
 
-  // client to interact with monitor
-  std::unique_ptr<fbzmq::ZmqMonitorClient> zmqMonitorClient_;
+  // batched logger of events, submitting them to monitor
+  std::unique_ptr<EventLogger> eventLogger_;
+
+  // Queue to publish route updates applied to routeState_
+  messaging::ReplicateQueue<thrift::RouteDatabaseDelta>& fibUpdatesQueue_;
 
   // module ptr to refer to KvStore for KvStoreClientInternal usage
   KvStore* kvStore_{nullptr};
@@ -255,6 +443,10 @@ class Fib final : public OpenrEventBase {
   // moves to true after initial sync
   bool hasSyncedFib_{false};
 
+  // time of creation, initial sync is timed relative to it
+  const std::chrono::steady_clock::time_point startTime_{
+      std::chrono::steady_clock::now()};
+
   const int16_t kFibId_{static_cast<int16_t>(thrift::FibClient::OPENR)};
 };
 
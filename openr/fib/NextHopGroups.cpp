@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "NextHopGroups.h"
+
+#include <folly/hash/Hash.h>
+#include <glog/logging.h>
+
+#include <openr/common/NetworkUtil.h>
+
+namespace openr {
+
+std::shared_ptr<const NextHopGroup>
+NextHopGroups::get(NextHopGroup nextHops) {
+  const size_t hash = folly::hash::hash_range(nextHops.begin(), nextHops.end());
+  auto range = groups_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (*it->second.group == nextHops) {
+      // Group is erased on release, hence it's still alive
+      auto ref = it->second.ref.lock();
+      CHECK(ref);
+      return ref;
+    }
+  }
+
+  auto const* group = new NextHopGroup(std::move(nextHops));
+  std::shared_ptr<const NextHopGroup> ref(
+      group, [this, hash](NextHopGroup const* released) {
+        erase(hash, released);
+        delete released;
+      });
+  groups_.emplace(hash, Entry{group, ref});
+  return ref;
+}
+
+void
+NextHopGroups::erase(size_t hash, NextHopGroup const* group) {
+  auto range = groups_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second.group == group) {
+      groups_.erase(it);
+      return;
+    }
+  }
+}
+
+} // namespace openr
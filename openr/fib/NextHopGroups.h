@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <openr/if/gen-cpp2/Network_types.h>
+
+namespace openr {
+
+using NextHopGroup = std::vector<thrift::NextHopThrift>;
+
+/**
+ * Interning table of nexthop groups. Routes with the same nexthops refer to a
+ * single immutable copy of them, which is released along with its last route.
+ *
+ * NOTE: Not thread safe. Groups must be released on thread using the table,
+ * and table must outlive them.
+ */
+class NextHopGroups {
+ public:
+  NextHopGroups() = default;
+
+  /**
+   * non-copyable and non-movable, groups refer back to their table
+   */
+  NextHopGroups(NextHopGroups const&) = delete;
+  NextHopGroups& operator=(NextHopGroups const&) = delete;
+
+  /**
+   * Return group equal to nextHops, creating it if there is none
+   */
+  std::shared_ptr<const NextHopGroup> get(NextHopGroup nextHops);
+
+  /**
+   * Number of groups in use
+   */
+  size_t
+  size() const {
+    return groups_.size();
+  }
+
+ private:
+  struct Entry {
+    NextHopGroup const* group{nullptr};
+    std::weak_ptr<const NextHopGroup> ref;
+  };
+
+  // Erase group from table, called on release of group
+  void erase(size_t hash, NextHopGroup const* group);
+
+  // Groups by hash of nexthops
+  std::unordered_multimap<size_t, Entry> groups_;
+};
+
+} // namespace openr
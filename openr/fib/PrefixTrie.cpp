@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "PrefixTrie.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+namespace openr {
+
+PrefixTrie::PrefixTrie() : nodes_(2) {}
+
+void
+PrefixTrie::insert(const folly::CIDRNetwork& prefix) {
+  CHECK_LE(prefix.second, prefix.first.bitCount());
+  uint32_t index = getRoot(prefix);
+  for (uint8_t i = 0; i < prefix.second; ++i) {
+    const auto bit = prefix.first.getNthMSBit(i) ? 1 : 0;
+    auto child = nodes_.at(index).children[bit];
+    if (child == 0) {
+      if (not freeNodes_.empty()) {
+        child = freeNodes_.back();
+        freeNodes_.pop_back();
+      } else {
+        child = nodes_.size();
+        nodes_.emplace_back();
+      }
+      // NOTE: emplace_back may have moved nodes, index again
+      nodes_.at(index).children[bit] = child;
+    }
+    index = child;
+  }
+
+  auto& node = nodes_.at(index);
+  if (not node.prefix.has_value()) {
+    ++size_;
+  }
+  node.prefix = prefix;
+}
+
+bool
+PrefixTrie::erase(const folly::CIDRNetwork& prefix) {
+  if (prefix.second > prefix.first.bitCount()) {
+    return false;
+  }
+
+  // Nodes on path from root to prefix
+  std::vector<uint32_t> path{getRoot(prefix)};
+  for (uint8_t i = 0; i < prefix.second; ++i) {
+    const auto bit = prefix.first.getNthMSBit(i) ? 1 : 0;
+    const auto child = nodes_.at(path.back()).children[bit];
+    if (child == 0) {
+      return false;
+    }
+    path.emplace_back(child);
+  }
+
+  auto& node = nodes_.at(path.back());
+  if (node.prefix != prefix) {
+    return false;
+  }
+  node.prefix.reset();
+  --size_;
+
+  // Release nodes which no longer lead to any prefix, bottom up
+  for (size_t i = path.size() - 1; i > 0; --i) {
+    auto& curr = nodes_.at(path[i]);
+    if (curr.prefix.has_value() or curr.children[0] or curr.children[1]) {
+      break;
+    }
+    auto& parent = nodes_.at(path[i - 1]);
+    const auto bit = prefix.first.getNthMSBit(i - 1) ? 1 : 0;
+    parent.children[bit] = 0;
+    freeNodes_.emplace_back(path[i]);
+  }
+  return true;
+}
+
+std::optional<folly::CIDRNetwork>
+PrefixTrie::longestMatch(const folly::CIDRNetwork& prefix) const {
+  uint32_t index = getRoot(prefix);
+  std::optional<folly::CIDRNetwork> match = nodes_.at(index).prefix;
+  const uint8_t length =
+      std::min<size_t>(prefix.second, prefix.first.bitCount());
+  for (uint8_t i = 0; i < length; ++i) {
+    const auto bit = prefix.first.getNthMSBit(i) ? 1 : 0;
+    index = nodes_.at(index).children[bit];
+    if (index == 0) {
+      break;
+    }
+    if (nodes_.at(index).prefix.has_value()) {
+      match = nodes_.at(index).prefix;
+    }
+  }
+  return match;
+}
+
+void
+PrefixTrie::clear() {
+  nodes_.clear();
+  nodes_.resize(2);
+  freeNodes_.clear();
+  size_ = 0;
+}
+
+} // namespace openr
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include <folly/IPAddress.h>
+
+namespace openr {
+
+/**
+ * Binary trie of IPv4 and IPv6 prefixes for longest prefix match. Lookup cost
+ * is bounded by prefix length, independent of number of prefixes.
+ *
+ * Prefixes are indexed by their masked address, and are returned as they were
+ * inserted. Inserting a prefix which masks to the same network as an existing
+ * one replaces it.
+ *
+ * NOTE: Not thread safe
+ */
+class PrefixTrie {
+ public:
+  PrefixTrie();
+
+  /**
+   * Add prefix, or replace prefix of the same network
+   */
+  void insert(const folly::CIDRNetwork& prefix);
+
+  /**
+   * Remove prefix if present as inserted. Returns false if there was none.
+   */
+  bool erase(const folly::CIDRNetwork& prefix);
+
+  /**
+   * Longest prefix in trie which covers given prefix, i.e. of same address
+   * family, of length not exceeding it and matching its leading bits.
+   */
+  std::optional<folly::CIDRNetwork> longestMatch(
+      const folly::CIDRNetwork& prefix) const;
+
+  /**
+   * Remove all prefixes
+   */
+  void clear();
+
+  size_t
+  size() const {
+    return size_;
+  }
+
+ private:
+  struct Node {
+    // Child node index per bit value, 0 if none. Root is never a child.
+    uint32_t children[2]{0, 0};
+    std::optional<folly::CIDRNetwork> prefix;
+  };
+
+  // Root node index of address family of prefix
+  static uint32_t
+  getRoot(const folly::CIDRNetwork& prefix) {
+    return prefix.first.isV4() ? 0 : 1;
+  }
+
+  // Nodes of both roots, followed by inner nodes. Released nodes are kept in
+  // freeNodes_ for reuse.
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> freeNodes_;
+
+  // Number of prefixes
+  size_t size_{0};
+};
+
+} // namespace openr
@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <thread>
 
 #include <fbzmq/async/StopEventLoopSignalHandler.h>
@@ -14,6 +15,7 @@
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 #include <thrift/lib/cpp2/util/ScopedServerThread.h>
 
+#include <openr/common/tests/BenchmarkUtils.h>
 #include <openr/config/Config.h>
 #include <openr/config/tests/Utils.h>
 #include <openr/fib/Fib.h>
@@ -22,29 +24,6 @@
 #include <openr/messaging/ReplicateQueue.h>
 #include <openr/tests/OpenrThriftServerWrapper.h>
 
-/**
- * Defines a benchmark that allows users to record customized counter during
- * benchmarking and passes a parameter to another one. This is common for
- * benchmarks that need a "problem size" in addition to "number of iterations".
- */
-#define BENCHMARK_COUNTERS_PARAM(name, counters, param) \
-  BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param, param)
-
-/*
- * Like BENCHMARK_COUNTERS_PARAM(), but allows a custom name to be specified for
- * each parameter, rather than using the parameter value.
- */
-#define BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param_name, ...) \
-  BENCHMARK_IMPL_COUNTERS(                                             \
-      FB_CONCATENATE(name, FB_CONCATENATE(_, param_name)),             \
-      FOLLY_PP_STRINGIZE(name) "(" FOLLY_PP_STRINGIZE(param_name) ")", \
-      counters,                                                        \
-      iters,                                                           \
-      unsigned,                                                        \
-      iters) {                                                         \
-    name(counters, iters, ##__VA_ARGS__);                              \
-  }
-
 namespace {
 // Virtual interface
 const std::string kVethNameY("vethTestY");
@@ -94,6 +73,7 @@ class FibWrapper {
         std::chrono::seconds(2), // coldStartDuration
         routeUpdatesQueue.getReader(),
         interfaceUpdatesQueue.getReader(),
+        fibUpdatesQueue,
         MonitorSubmitUrl{"inproc://monitor-sub"},
         nullptr, /* KvStore module ptr */
         context);
@@ -121,6 +101,9 @@ class FibWrapper {
   }
 
   ~FibWrapper() {
+    // Close queue read by openr-ctrl handler ahead of stopping it
+    fibUpdatesQueue.close();
+
     LOG(INFO) << "Stopping openr-ctrl thrift server";
     openrThriftServerWrapper_->stop();
     LOG(INFO) << "Openr-ctrl thrift server got stopped";
@@ -177,6 +160,7 @@ class FibWrapper {
 
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> routeUpdatesQueue;
   messaging::ReplicateQueue<thrift::InterfaceDatabase> interfaceUpdatesQueue;
+  messaging::ReplicateQueue<thrift::RouteDatabaseDelta> fibUpdatesQueue;
 
   fbzmq::Context context{};
 
@@ -264,12 +248,107 @@ BM_Fib(folly::UserCounters& counters, uint32_t iters, unsigned numOfPrefixes) {
   counters["route_install"] = processTimes[2];
 }
 
+/**
+ * Benchmark of route programming against agent with latency and failures
+ * 1. Create a fib, with agent taking `callLatencyMs` for every call
+ * 2. Send `numOfPrefixes` routes spread over `numOfGroups` nexthop groups of
+ *    `numOfNexthops` nexthops each
+ * 3. Fail first `numOfFailures` agent calls, which fib has to retry
+ * 4. Wait until all routes are programmed
+ *
+ * Reports programming rate and percentiles of convergence latency
+ */
+static void
+BM_FibAgent(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    unsigned numOfPrefixes,
+    unsigned numOfNexthops,
+    unsigned numOfGroups,
+    unsigned callLatencyMs,
+    unsigned numOfFailures) {
+  auto suspender = folly::BenchmarkSuspender();
+  // Fib starts with clean route database
+  auto fibWrapper = std::make_unique<FibWrapper>();
+  auto& mockFibHandler = fibWrapper->mockFibHandler;
+
+  // Initial syncFib debounce
+  mockFibHandler->waitForSyncFib();
+  mockFibHandler->setCallLatency(std::chrono::milliseconds(callLatencyMs));
+
+  const auto prefixes = fibWrapper->prefixGenerator.ipv6PrefixGenerator(
+      numOfPrefixes, kBitMaskLen);
+
+  // Convergence latency of every iteration in microseconds
+  std::vector<int64_t> latencies;
+  for (uint32_t i = 0; i < iters; i++) {
+    // New nexthop groups every iteration, so that every route is updated
+    std::vector<std::vector<thrift::NextHopThrift>> groups;
+    for (uint32_t index = 0; index < numOfGroups; index++) {
+      groups.emplace_back(fibWrapper->prefixGenerator.getRandomNextHopsUnicast(
+          numOfNexthops, kVethNameY));
+    }
+    thrift::RouteDatabaseDelta routeDbDelta;
+    routeDbDelta.thisNodeName = "node-1";
+    for (uint32_t index = 0; index < numOfPrefixes; index++) {
+      routeDbDelta.unicastRoutesToUpdate.emplace_back(
+          createUnicastRoute(prefixes[index], groups[index % numOfGroups]));
+    }
+    mockFibHandler->failAddUnicastRoutes(numOfFailures);
+    const auto expectedCount =
+        mockFibHandler->getAddRoutesCount() + numOfPrefixes;
+    suspender.dismiss(); // Start measuring benchmark time
+
+    // Send routeDB to Fib and wait until all routes are programmed
+    const auto startTime = std::chrono::steady_clock::now();
+    fibWrapper->routeUpdatesQueue.push(std::move(routeDbDelta));
+    mockFibHandler->waitForAddRoutesCount(expectedCount);
+    latencies.emplace_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startTime)
+            .count());
+
+    suspender.rehire(); // Stop measuring time again
+  }
+
+  if (latencies.empty()) {
+    return;
+  }
+  int64_t totalLatency{0};
+  for (auto const latency : latencies) {
+    totalLatency += latency;
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  // Add customized counters to state.
+  counters["routes_per_sec"] =
+      totalLatency ? numOfPrefixes * latencies.size() * 1000000 / totalLatency
+                   : 0;
+  counters["latency_p50_us"] = latencies.at(latencies.size() / 2);
+  counters["latency_p99_us"] = latencies.at(latencies.size() * 99 / 100);
+}
+
 // The parameter is the number of prefixes sent to fib
 BENCHMARK_COUNTERS_PARAM(BM_Fib, counters, 10);
 BENCHMARK_COUNTERS_PARAM(BM_Fib, counters, 100);
 BENCHMARK_COUNTERS_PARAM(BM_Fib, counters, 1000);
 BENCHMARK_COUNTERS_PARAM(BM_Fib, counters, 9000);
 
+// The parameters are number of prefixes, nexthops per group, nexthop groups,
+// agent call latency in milliseconds and number of failed agent calls
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibAgent, counters, 10000_16_1_0_0, 10000, 16, 1, 0, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibAgent, counters, 10000_16_1_5_0, 10000, 16, 1, 5, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibAgent, counters, 10000_16_1_5_2, 10000, 16, 1, 5, 2);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibAgent, counters, 10000_16_100_5_0, 10000, 16, 100, 5, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibAgent, counters, 10000_128_100_5_0, 10000, 128, 100, 5, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibAgent, counters, 100000_16_100_5_0, 100000, 16, 100, 5, 0);
+
 } // namespace openr
 
 int
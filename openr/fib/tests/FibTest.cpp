@@ -7,6 +7,7 @@
 
 #include "MockNetlinkFibHandler.h"
 
+#include <atomic>
 #include <chrono>
 #include <thread>
 
@@ -15,6 +16,7 @@
 #include <folly/Format.h>
 #include <folly/Memory.h>
 #include <folly/String.h>
+#include <folly/executors/GlobalExecutor.h>
 #include <folly/futures/Future.h>
 #include <folly/gen/Base.h>
 #include <folly/init/Init.h>
@@ -192,8 +194,13 @@ checkEqualMplsRoutes(thrift::RouteDatabase lhs, thrift::RouteDatabase rhs) {
 
 class FibTestFixture : public ::testing::Test {
  public:
-  explicit FibTestFixture(bool waitOnDecision = false)
-      : waitOnDecision_(waitOnDecision) {}
+  explicit FibTestFixture(
+      bool waitOnDecision = false,
+      bool enableChunkedSync = false,
+      bool enableWarmSync = false)
+      : waitOnDecision_(waitOnDecision),
+        enableChunkedSync_(enableChunkedSync),
+        enableWarmSync_(enableWarmSync) {}
   void
   SetUp() override {
     mockFibHandler = std::make_shared<MockNetlinkFibHandler>();
@@ -216,6 +223,12 @@ class FibTestFixture : public ::testing::Test {
     if (waitOnDecision_) {
       tConfig.eor_time_s_ref() = 1;
     }
+    if (enableChunkedSync_) {
+      tConfig.enable_fib_chunked_sync_ref() = true;
+    }
+    if (enableWarmSync_) {
+      tConfig.enable_fib_warm_sync_ref() = true;
+    }
 
     config = make_shared<Config>(tConfig);
 
@@ -225,6 +238,7 @@ class FibTestFixture : public ::testing::Test {
         std::chrono::seconds(2), /* coldStartDuration */
         routeUpdatesQueue.getReader(),
         interfaceUpdatesQueue.getReader(),
+        fibUpdatesQueue,
         MonitorSubmitUrl{"inproc://monitor-sub"},
         nullptr, /* KvStore module ptr */
         context);
@@ -253,6 +267,9 @@ class FibTestFixture : public ::testing::Test {
 
   void
   TearDown() override {
+    // Close queue read by openr-ctrl handler ahead of stopping it
+    fibUpdatesQueue.close();
+
     LOG(INFO) << "Stopping openr-ctrl thrift server";
     openrThriftServerWrapper_->stop();
     LOG(INFO) << "Openr-ctrl thrift server got stopped";
@@ -323,6 +340,7 @@ class FibTestFixture : public ::testing::Test {
 
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> routeUpdatesQueue;
   messaging::ReplicateQueue<thrift::InterfaceDatabase> interfaceUpdatesQueue;
+  messaging::ReplicateQueue<thrift::RouteDatabaseDelta> fibUpdatesQueue;
 
   fbzmq::Context context{};
 
@@ -340,6 +358,8 @@ class FibTestFixture : public ::testing::Test {
   std::shared_ptr<OpenrThriftServerWrapper> openrThriftServerWrapper_{nullptr};
 
   bool waitOnDecision_{false};
+  bool enableChunkedSync_{false};
+  bool enableWarmSync_{false};
 };
 
 TEST_F(FibTestFixture, processRouteDb) {
@@ -675,6 +695,34 @@ TEST_F(FibTestFixture, basicAddAndDelete) {
   EXPECT_EQ(mockFibHandler->getDelMplsRoutesCount(), 2);
 }
 
+/**
+ * Routes which fail to program are retried on their own, without full sync of
+ * route DB
+ */
+TEST_F(FibTestFixture, retryFailedRoutes) {
+  // initial syncFib debounce
+  mockFibHandler->waitForSyncFib();
+  mockFibHandler->waitForSyncMplsFib();
+  EXPECT_EQ(mockFibHandler->getFibSyncCount(), 1);
+
+  // first attempt to add routes fails
+  mockFibHandler->failAddUnicastRoutes(1);
+  thrift::RouteDatabaseDelta routeDbDelta;
+  routeDbDelta.thisNodeName = "node-1";
+  routeDbDelta.unicastRoutesToUpdate = {
+      createUnicastRoute(prefix1, {path1_2_1, path1_2_2}),
+      createUnicastRoute(prefix3, {path1_3_1, path1_3_2})};
+  routeUpdatesQueue.push(routeDbDelta);
+
+  // retried routes are added
+  mockFibHandler->waitForUpdateUnicastRoutes();
+  std::vector<thrift::UnicastRoute> routes;
+  mockFibHandler->getRouteTableByClient(routes, kFibId);
+  EXPECT_EQ(routes.size(), 2);
+  EXPECT_EQ(mockFibHandler->getAddRoutesCount(), 2);
+  EXPECT_EQ(mockFibHandler->getFibSyncCount(), 1);
+}
+
 TEST_F(FibTestFixture, fibRestart) {
   // Make sure fib starts with clean route database
   std::vector<thrift::UnicastRoute> routes;
@@ -722,6 +770,82 @@ TEST_F(FibTestFixture, fibRestart) {
   EXPECT_EQ(mplsRoutes.size(), 2);
 }
 
+class FibTestFixtureChunkedSync : public FibTestFixture {
+ public:
+  FibTestFixtureChunkedSync() : FibTestFixture(false, true) {}
+};
+
+TEST_F(FibTestFixtureChunkedSync, fibRestart) {
+  // initial syncFib debounce, with empty route table in a single call
+  mockFibHandler->waitForSyncFib();
+  EXPECT_EQ(mockFibHandler->getFibSyncChunkCount(), 0);
+
+  // Routes spanning multiple chunks
+  const size_t numRoutes = Constants::kFibRouteProgrammingChunkSize * 2 + 1;
+  thrift::RouteDatabaseDelta routeDbDelta;
+  routeDbDelta.thisNodeName = "node-1";
+  for (size_t i = 0; i < numRoutes; ++i) {
+    routeDbDelta.unicastRoutesToUpdate.emplace_back(createUnicastRoute(
+        toIpPrefix(folly::sformat("fd00:{:x}::/64", i)),
+        {path1_2_1, path1_2_2}));
+  }
+  routeUpdatesQueue.push(routeDbDelta);
+  mockFibHandler->waitForAddRoutesCount(numRoutes);
+
+  // Restart agent. Full sync is sent in chunks.
+  mockFibHandler->restart();
+  mockFibHandler->waitForSyncFib();
+
+  std::vector<thrift::UnicastRoute> routes;
+  mockFibHandler->getRouteTableByClient(routes, kFibId);
+  EXPECT_EQ(routes.size(), numRoutes);
+  EXPECT_EQ(mockFibHandler->getFibSyncCount(), 1);
+  EXPECT_EQ(mockFibHandler->getFibSyncChunkCount(), 3);
+}
+
+class FibTestFixtureWarmSync : public FibTestFixture {
+ public:
+  FibTestFixtureWarmSync() : FibTestFixture(false, false, true) {}
+};
+
+TEST_F(FibTestFixtureWarmSync, initialSync) {
+  // Agent still holds routes of previous instance
+  mockFibHandler->addUnicastRoutes(
+      kFibId,
+      std::make_unique<std::vector<thrift::UnicastRoute>>(
+          std::vector<thrift::UnicastRoute>{
+              createUnicastRoute(prefix1, {path1_2_1}),
+              createUnicastRoute(prefix2, {path1_2_1})}));
+  mockFibHandler->addMplsRoutes(
+      kFibId,
+      std::make_unique<std::vector<thrift::MplsRoute>>(
+          std::vector<thrift::MplsRoute>{
+              createMplsRoute(label1, {mpls_path1_2_1})}));
+
+  // Route of prefix1 is unchanged, prefix3 is new
+  thrift::RouteDatabaseDelta routeDbDelta;
+  routeDbDelta.thisNodeName = "node-1";
+  routeDbDelta.unicastRoutesToUpdate = {
+      createUnicastRoute(prefix1, {path1_2_1, path1_2_2}),
+      createUnicastRoute(prefix3, {path1_3_1})};
+  routeUpdatesQueue.push(routeDbDelta);
+
+  // Only prefix3 is programmed, after stale routes got deleted
+  mockFibHandler->waitForAddRoutesCount(3);
+  EXPECT_EQ(mockFibHandler->getAddRoutesCount(), 3);
+  EXPECT_EQ(mockFibHandler->getDelRoutesCount(), 1);
+  EXPECT_EQ(mockFibHandler->getDelMplsRoutesCount(), 1);
+  EXPECT_EQ(mockFibHandler->getFibSyncCount(), 0);
+  EXPECT_EQ(mockFibHandler->getFibMplsSyncCount(), 0);
+
+  std::vector<thrift::UnicastRoute> routes;
+  mockFibHandler->getRouteTableByClient(routes, kFibId);
+  EXPECT_EQ(routes.size(), 2);
+  std::vector<thrift::MplsRoute> mplsRoutes;
+  mockFibHandler->getMplsRouteTableByClient(mplsRoutes, kFibId);
+  EXPECT_EQ(mplsRoutes.size(), 0);
+}
+
 class FibTestFixtureWaitOnDecision : public FibTestFixture {
  public:
   FibTestFixtureWaitOnDecision() : FibTestFixture(true) {}
@@ -761,6 +885,67 @@ TEST_F(FibTestFixtureWaitOnDecision, WaitOnDecision) {
   EXPECT_EQ(mockFibHandler->getDelMplsRoutesCount(), 0);
 }
 
+TEST_F(FibTestFixture, subscribeFibTest) {
+  // initial syncFib debounce
+  mockFibHandler->waitForSyncFib();
+  mockFibHandler->waitForSyncMplsFib();
+
+  thrift::RouteDatabaseDelta routeDbDelta;
+  routeDbDelta.thisNodeName = "node-1";
+  routeDbDelta.unicastRoutesToUpdate.emplace_back(
+      createUnicastRoute(prefix2, {path1_2_1, path1_2_2}));
+  routeDbDelta.unicastRoutesToUpdate.emplace_back(
+      createUnicastRoute(prefix3, {path1_3_1, path1_3_2}));
+  routeUpdatesQueue.push(routeDbDelta);
+  mockFibHandler->waitForUpdateUnicastRoutes();
+
+  // Snapshot of two routes in a chunk each, followed by route update
+  std::atomic<int> received{0};
+  std::atomic<int> snapshotRoutes{0};
+  auto handler = openrThriftServerWrapper_->getOpenrCtrlHandler();
+  auto subscription =
+      handler->subscribeFib(1).toClientStream().subscribeExTry(
+          folly::getEventBase(), [&](auto&& t) {
+            if (!t.hasValue()) {
+              return;
+            }
+            auto& delta = *t;
+            EXPECT_EQ("node-1", delta.thisNodeName);
+            if (received < 2) {
+              EXPECT_EQ(
+                  received == 0, delta.hasMoreChunks_ref().value_or(false));
+              EXPECT_EQ(1, delta.unicastRoutesToUpdate.size());
+              snapshotRoutes += delta.unicastRoutesToUpdate.size();
+            } else {
+              EXPECT_FALSE(delta.hasMoreChunks_ref().has_value());
+              ASSERT_EQ(1, delta.unicastRoutesToDelete.size());
+              EXPECT_EQ(prefix2, delta.unicastRoutesToDelete.at(0));
+            }
+            received++;
+          });
+  EXPECT_EQ(1, handler->getNumFibPublishers());
+  while (received < 2) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(2, snapshotRoutes);
+
+  routeDbDelta.unicastRoutesToUpdate.clear();
+  routeDbDelta.unicastRoutesToDelete.emplace_back(prefix2);
+  routeUpdatesQueue.push(routeDbDelta);
+  while (received < 3) {
+    std::this_thread::yield();
+  }
+
+  // Cancel subscription
+  subscription.cancel();
+  std::move(subscription).detach();
+
+  // Wait until publisher is destroyed
+  while (handler->getNumFibPublishers() != 0) {
+    std::this_thread::yield();
+  }
+}
+
 TEST_F(FibTestFixture, getMslpRoutesFilteredTest) {
   // Make sure fib starts with clean route database
   std::vector<thrift::UnicastRoute> routes;
@@ -911,6 +1096,23 @@ TEST_F(FibTestFixture, getUnicastRoutesFilteredTest) {
   EXPECT_EQ(notFoundResp.size(), 0);
 }
 
+TEST(Fib, isPriorityRouteTest) {
+  EXPECT_TRUE(
+      Fib::isPriorityRoute(createUnicastRoute(toIpPrefix("fd00::1/128"), {})));
+  EXPECT_TRUE(
+      Fib::isPriorityRoute(createUnicastRoute(toIpPrefix("10.0.0.1/32"), {})));
+  EXPECT_FALSE(
+      Fib::isPriorityRoute(createUnicastRoute(toIpPrefix("fd00::/64"), {})));
+  EXPECT_FALSE(
+      Fib::isPriorityRoute(createUnicastRoute(toIpPrefix("10.0.0.0/24"), {})));
+
+  auto route = createUnicastRoute(toIpPrefix("fd00::/64"), {});
+  route.prefixType_ref() = thrift::PrefixType::LOOPBACK;
+  EXPECT_TRUE(Fib::isPriorityRoute(route));
+  route.prefixType_ref() = thrift::PrefixType::BGP;
+  EXPECT_FALSE(Fib::isPriorityRoute(route));
+}
+
 TEST_F(FibTestFixture, longestPrefixMatchTest) {
   std::unordered_map<thrift::IpPrefix, thrift::UnicastRoute> unicastRoutes;
   const auto& dbPrefix1 = toIpPrefix("192.168.0.0/16");
@@ -70,6 +70,13 @@ MockNetlinkFibHandler::deleteUnicastRoute(
 void
 MockNetlinkFibHandler::addUnicastRoutes(
     int16_t, std::unique_ptr<std::vector<openr::thrift::UnicastRoute>> routes) {
+  simulateCallLatency();
+  if (numAddUnicastRoutesFailures_ > 0) {
+    --numAddUnicastRoutesFailures_;
+    thrift::PlatformError error;
+    error.message = "injected failure";
+    throw error;
+  }
   SYNCHRONIZED(unicastRouteDb_) {
     for (auto const& route : *routes) {
       auto prefix = std::make_pair(
@@ -85,13 +92,18 @@ MockNetlinkFibHandler::addUnicastRoutes(
       unicastRouteDb_.emplace(prefix, newNextHops);
     }
   }
-  addRoutesCount_ += routes->size();
+  {
+    std::lock_guard<std::mutex> lock(addRoutesMutex_);
+    addRoutesCount_ += routes->size();
+  }
+  addRoutesCv_.notify_all();
   updateUnicastRoutesBaton_.post();
 }
 
 void
 MockNetlinkFibHandler::deleteUnicastRoutes(
     int16_t, std::unique_ptr<std::vector<openr::thrift::IpPrefix>> prefixes) {
+  simulateCallLatency();
   SYNCHRONIZED(unicastRouteDb_) {
     for (auto const& prefix : *prefixes) {
       auto myPrefix = std::make_pair(
@@ -104,6 +116,29 @@ MockNetlinkFibHandler::deleteUnicastRoutes(
   deleteUnicastRoutesBaton_.post();
 }
 
+namespace {
+
+void
+addToRouteDb(
+    UnicastRoutes& routeDb,
+    std::vector<openr::thrift::UnicastRoute> const& routes) {
+  for (auto const& route : routes) {
+    auto prefix = std::make_pair(
+        toIPAddress(route.dest.prefixAddress), route.dest.prefixLength);
+
+    auto newNextHops =
+        from(route.nextHops) | mapped([](const thrift::NextHopThrift& nh) {
+          return std::make_pair(
+              nh.address.ifName_ref().value(), toIPAddress(nh.address));
+        }) |
+        as<std::unordered_set<std::pair<std::string, folly::IPAddress>>>();
+
+    routeDb[prefix] = std::move(newNextHops);
+  }
+}
+
+} // namespace
+
 void
 MockNetlinkFibHandler::syncFib(
     int16_t, std::unique_ptr<std::vector<openr::thrift::UnicastRoute>> routes) {
@@ -111,20 +146,35 @@ MockNetlinkFibHandler::syncFib(
     VLOG(3) << "MockNetlinkFibHandler: Sync Fib.... " << (*routes).size()
             << " entries";
     unicastRouteDb_.clear();
-    for (auto const& route : *routes) {
-      auto prefix = std::make_pair(
-          toIPAddress(route.dest.prefixAddress), route.dest.prefixLength);
-
-      auto newNextHops =
-          from(route.nextHops) | mapped([](const thrift::NextHopThrift& nh) {
-            return std::make_pair(
-                nh.address.ifName_ref().value(), toIPAddress(nh.address));
-          }) |
-          as<std::unordered_set<std::pair<std::string, folly::IPAddress>>>();
+    addToRouteDb(unicastRouteDb_, *routes);
+  }
+  fibSyncCount_++;
+  syncFibBaton_.post();
+}
 
-      unicastRouteDb_.emplace(prefix, newNextHops);
+void
+MockNetlinkFibHandler::syncFibChunk(
+    int16_t, std::unique_ptr<openr::thrift::UnicastRouteSyncChunk> chunk) {
+  simulateCallLatency();
+  fibSyncChunkCount_++;
+  UnicastRoutes newRouteDb;
+  {
+    auto sync = chunkedSync_.wlock();
+    if (sync->syncId != chunk->syncId) {
+      *sync = ChunkedSync();
+      sync->syncId = chunk->syncId;
+    }
+    addToRouteDb(sync->unicastRoutes, chunk->routes);
+    if (++sync->numChunksReceived < chunk->numChunks) {
+      return;
     }
+    newRouteDb = std::move(sync->unicastRoutes);
+    *sync = ChunkedSync();
   }
+
+  VLOG(3) << "MockNetlinkFibHandler: Chunked Sync Fib.... " << newRouteDb.size()
+          << " entries";
+  unicastRouteDb_.wlock()->swap(newRouteDb);
   fibSyncCount_++;
   syncFibBaton_.post();
 }
@@ -132,6 +182,7 @@ MockNetlinkFibHandler::syncFib(
 void
 MockNetlinkFibHandler::addMplsRoutes(
     int16_t, std::unique_ptr<std::vector<openr::thrift::MplsRoute>> routes) {
+  simulateCallLatency();
   SYNCHRONIZED(mplsRouteDb_) {
     for (auto& route : *routes) {
       mplsRouteDb_[route.topLabel] = std::move(route.nextHops);
@@ -144,6 +195,7 @@ MockNetlinkFibHandler::addMplsRoutes(
 void
 MockNetlinkFibHandler::deleteMplsRoutes(
     int16_t, std::unique_ptr<std::vector<int32_t>> labels) {
+  simulateCallLatency();
   SYNCHRONIZED(mplsRouteDb_) {
     for (auto& label : *labels) {
       mplsRouteDb_.erase(label);
@@ -255,12 +307,27 @@ MockNetlinkFibHandler::waitForSyncMplsFib() {
   syncMplsFibBaton_.reset();
 }
 
+void
+MockNetlinkFibHandler::waitForAddRoutesCount(size_t count) {
+  std::unique_lock<std::mutex> lock(addRoutesMutex_);
+  addRoutesCv_.wait(lock, [this, count]() { return addRoutesCount_ >= count; });
+}
+
+void
+MockNetlinkFibHandler::simulateCallLatency() {
+  const auto latencyUs = callLatencyUs_.load();
+  if (latencyUs > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(latencyUs));
+  }
+}
+
 void
 MockNetlinkFibHandler::stop() {
   SYNCHRONIZED(unicastRouteDb_) {
     unicastRouteDb_.clear();
   }
   fibSyncCount_ = 0;
+  fibSyncChunkCount_ = 0;
   addRoutesCount_ = 0;
   delRoutesCount_ = 0;
   fibMplsSyncCount_ = 0;
@@ -274,6 +341,7 @@ MockNetlinkFibHandler::restart() {
   LOG(INFO) << "Restarting fib agent";
   unicastRouteDb_->clear();
   mplsRouteDb_->clear();
+  *chunkedSync_.wlock() = ChunkedSync();
 
   SYNCHRONIZED(startTime_) {
     startTime_ = std::chrono::duration_cast<std::chrono::seconds>(
@@ -281,6 +349,7 @@ MockNetlinkFibHandler::restart() {
                      .count();
   }
   fibSyncCount_ = 0;
+  fibSyncChunkCount_ = 0;
   addRoutesCount_ = 0;
   delRoutesCount_ = 0;
   fibMplsSyncCount_ = 0;
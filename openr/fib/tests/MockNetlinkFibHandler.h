@@ -9,8 +9,10 @@
 
 #include <syslog.h>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -65,6 +67,11 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
       std::unique_ptr<std::vector<openr::thrift::UnicastRoute>> routes)
       override;
 
+  // Counts as a single fib sync once all chunks of sync are received
+  void syncFibChunk(
+      int16_t clientId,
+      std::unique_ptr<openr::thrift::UnicastRouteSyncChunk> chunk) override;
+
   void addMplsRoutes(
       int16_t clientId,
       std::unique_ptr<std::vector<openr::thrift::MplsRoute>> routes) override;
@@ -84,6 +91,11 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
   void waitForDeleteMplsRoutes();
   void waitForSyncMplsFib();
 
+  // Wait till total number of added unicast routes reaches `count`. Unlike
+  // waitForUpdateUnicastRoutes it may be used when routes are programmed
+  // over multiple calls.
+  void waitForAddRoutesCount(size_t count);
+
   int64_t aliveSince() override;
 
   void getRouteTableByClient(
@@ -99,6 +111,10 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
     return fibSyncCount_;
   }
   size_t
+  getFibSyncChunkCount() {
+    return fibSyncChunkCount_;
+  }
+  size_t
   getAddRoutesCount() {
     return addRoutesCount_;
   }
@@ -120,17 +136,42 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
     return delMplsRoutesCount_;
   }
 
+  // Make next `count` addUnicastRoutes calls fail
+  void
+  failAddUnicastRoutes(size_t count) {
+    numAddUnicastRoutesFailures_ = count;
+  }
+
+  // Delay every add/delete call by `latency`, to mimic agent programming
+  // hardware
+  void
+  setCallLatency(std::chrono::microseconds latency) {
+    callLatencyUs_ = latency.count();
+  }
+
   void stop();
 
   void restart();
 
  private:
+  // Sleep for configured call latency, if any
+  void simulateCallLatency();
+
   // Time when service started, in number of seconds, since epoch
   folly::Synchronized<int64_t> startTime_{0};
 
   // Abstract route Db to hide kernel level routing details from Fib
   folly::Synchronized<UnicastRoutes> unicastRouteDb_{};
 
+  // Routes and number of chunks received of chunked sync in progress, by
+  // sync id
+  struct ChunkedSync {
+    int64_t syncId{0};
+    int32_t numChunksReceived{0};
+    UnicastRoutes unicastRoutes;
+  };
+  folly::Synchronized<ChunkedSync> chunkedSync_;
+
   // Mpls Route db
   folly::Synchronized<
       std::unordered_map<int32_t, std::vector<thrift::NextHopThrift>>>
@@ -138,12 +179,23 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
 
   // Stats
   std::atomic<size_t> fibSyncCount_{0};
+  std::atomic<size_t> fibSyncChunkCount_{0};
   std::atomic<size_t> addRoutesCount_{0};
   std::atomic<size_t> delRoutesCount_{0};
   std::atomic<size_t> fibMplsSyncCount_{0};
   std::atomic<size_t> addMplsRoutesCount_{0};
   std::atomic<size_t> delMplsRoutesCount_{0};
 
+  // Remaining addUnicastRoutes calls to fail
+  std::atomic<size_t> numAddUnicastRoutesFailures_{0};
+
+  // Latency of every add/delete call
+  std::atomic<int64_t> callLatencyUs_{0};
+
+  // Notified on every update of addRoutesCount_
+  std::mutex addRoutesMutex_;
+  std::condition_variable addRoutesCv_;
+
   // A baton for synchronization
   folly::Baton<> updateUnicastRoutesBaton_;
   folly::Baton<> deleteUnicastRoutesBaton_;
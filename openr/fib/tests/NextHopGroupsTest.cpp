@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/IPAddress.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/NetworkUtil.h>
+#include <openr/common/Util.h>
+#include <openr/fib/NextHopGroups.h>
+
+namespace openr {
+
+namespace {
+
+const auto nh1 = createNextHop(
+    toBinaryAddress(folly::IPAddress("fe80::1")), std::string("iface1"), 1);
+const auto nh2 = createNextHop(
+    toBinaryAddress(folly::IPAddress("fe80::2")), std::string("iface2"), 1);
+
+} // namespace
+
+TEST(NextHopGroupsTest, ShareAndRelease) {
+  NextHopGroups groups;
+  auto group1 = groups.get({nh1, nh2});
+  auto group2 = groups.get({nh1, nh2});
+  auto group3 = groups.get({nh1});
+  EXPECT_EQ(group1.get(), group2.get());
+  EXPECT_NE(group1.get(), group3.get());
+  EXPECT_EQ((NextHopGroup{nh1, nh2}), *group1);
+  EXPECT_EQ(2, groups.size());
+
+  // Group is released along with its last user
+  group1.reset();
+  EXPECT_EQ(2, groups.size());
+  group2.reset();
+  EXPECT_EQ(1, groups.size());
+
+  // and is created again on demand
+  auto group4 = groups.get({nh1, nh2});
+  EXPECT_EQ((NextHopGroup{nh1, nh2}), *group4);
+  EXPECT_EQ(2, groups.size());
+  group3.reset();
+  group4.reset();
+  EXPECT_EQ(0, groups.size());
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::init(&argc, &argv);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  auto rc = RUN_ALL_TESTS();
+
+  return rc;
+}
@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <random>
+#include <set>
+
+#include <folly/IPAddress.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/fib/PrefixTrie.h>
+
+namespace openr {
+
+namespace {
+
+folly::CIDRNetwork
+toNetwork(std::string const& prefix) {
+  return folly::IPAddress::createNetwork(prefix);
+}
+
+} // namespace
+
+TEST(PrefixTrieTest, LongestMatch) {
+  PrefixTrie trie;
+  trie.insert(toNetwork("192.168.0.0/16"));
+  trie.insert(toNetwork("192.168.0.0/20"));
+  trie.insert(toNetwork("192.168.0.0/24"));
+  trie.insert(toNetwork("192.168.20.16/28"));
+  trie.insert(toNetwork("fc00::/64"));
+  EXPECT_EQ(5, trie.size());
+
+  EXPECT_EQ(
+      toNetwork("192.168.20.16/28"),
+      trie.longestMatch(toNetwork("192.168.20.19/32")));
+  EXPECT_EQ(
+      toNetwork("192.168.20.16/28"),
+      trie.longestMatch(toNetwork("192.168.20.16/28")));
+  EXPECT_EQ(
+      toNetwork("192.168.0.0/24"),
+      trie.longestMatch(toNetwork("192.168.0.0/32")));
+  EXPECT_EQ(
+      toNetwork("192.168.0.0/16"),
+      trie.longestMatch(toNetwork("192.168.0.0/18")));
+  EXPECT_EQ(
+      toNetwork("192.168.0.0/20"),
+      trie.longestMatch(toNetwork("192.168.0.0/22")));
+  EXPECT_EQ(std::nullopt, trie.longestMatch(toNetwork("192.168.0.0/14")));
+  EXPECT_EQ(
+      toNetwork("fc00::/64"), trie.longestMatch(toNetwork("fc00::1/128")));
+
+  // Address families don't mix
+  EXPECT_EQ(std::nullopt, trie.longestMatch(toNetwork("::/0")));
+  trie.insert(toNetwork("0.0.0.0/0"));
+  EXPECT_EQ(toNetwork("0.0.0.0/0"), trie.longestMatch(toNetwork("10.0.0.1")));
+  EXPECT_EQ(std::nullopt, trie.longestMatch(toNetwork("fd00::1")));
+}
+
+TEST(PrefixTrieTest, InsertErase) {
+  PrefixTrie trie;
+  trie.insert(toNetwork("10.0.0.0/8"));
+  trie.insert(toNetwork("10.1.0.0/16"));
+  trie.insert(toNetwork("10.1.0.0/16"));
+  EXPECT_EQ(2, trie.size());
+
+  EXPECT_FALSE(trie.erase(toNetwork("10.2.0.0/16")));
+  EXPECT_FALSE(trie.erase(toNetwork("10.1.0.0/24")));
+  EXPECT_TRUE(trie.erase(toNetwork("10.1.0.0/16")));
+  EXPECT_FALSE(trie.erase(toNetwork("10.1.0.0/16")));
+  EXPECT_EQ(1, trie.size());
+  EXPECT_EQ(toNetwork("10.0.0.0/8"), trie.longestMatch(toNetwork("10.1.0.1")));
+
+  // Erasing covering prefix retains longer one
+  trie.insert(toNetwork("10.1.0.0/16"));
+  EXPECT_TRUE(trie.erase(toNetwork("10.0.0.0/8")));
+  EXPECT_EQ(std::nullopt, trie.longestMatch(toNetwork("10.2.0.1")));
+  EXPECT_EQ(toNetwork("10.1.0.0/16"), trie.longestMatch(toNetwork("10.1.0.1")));
+
+  trie.clear();
+  EXPECT_EQ(0, trie.size());
+  EXPECT_EQ(std::nullopt, trie.longestMatch(toNetwork("10.1.0.1")));
+}
+
+/**
+ * Trie must agree with linear scan of prefixes on random inserts, erases and
+ * lookups
+ */
+TEST(PrefixTrieTest, RandomizedMatch) {
+  PrefixTrie trie;
+  std::set<folly::CIDRNetwork> prefixes;
+  std::mt19937_64 gen(1);
+
+  // Random prefix of length up to maxLength. Only leading 16 bits of address
+  // vary, so that prefixes overlap.
+  auto randomPrefix = [&gen](uint8_t maxLength) {
+    folly::ByteArray16 bytes{};
+    bytes[0] = gen() % 256;
+    bytes[1] = gen() % 256;
+    const uint8_t length = gen() % (maxLength + 1);
+    return folly::CIDRNetwork(
+        folly::IPAddress(folly::IPAddressV6(bytes)).mask(length), length);
+  };
+
+  for (int i = 0; i < 2000; ++i) {
+    const auto prefix = randomPrefix(16);
+    if (gen() % 4 == 0 and prefixes.count(prefix)) {
+      EXPECT_TRUE(trie.erase(prefix));
+      prefixes.erase(prefix);
+    } else {
+      trie.insert(prefix);
+      prefixes.insert(prefix);
+    }
+    ASSERT_EQ(prefixes.size(), trie.size());
+
+    const auto lookup = randomPrefix(128);
+    std::optional<folly::CIDRNetwork> expected;
+    for (auto const& p : prefixes) {
+      if (p.second <= lookup.second and
+          lookup.first.mask(p.second) == p.first and
+          (not expected.has_value() or p.second > expected->second)) {
+        expected = p;
+      }
+    }
+    EXPECT_EQ(expected, trie.longestMatch(lookup));
+  }
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::init(&argc, &argv);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  auto rc = RUN_ALL_TESTS();
+
+  return rc;
+}
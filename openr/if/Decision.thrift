@@ -22,3 +22,32 @@ typedef map<string, Lsdb.AdjacencyDatabase>
 typedef map<string, Lsdb.PrefixDatabase>
   (cpp.type = "std::unordered_map<std::string, openr::thrift::PrefixDatabase>")
   PrefixDbs
+
+/**
+ * Change of a link for what-if route computation, applied to adjacencies of
+ * both of its ends. Link is identified by a node and its local interface.
+ */
+struct WhatIfLinkChange {
+  1: string nodeName
+  2: string ifName
+  3: optional bool isOverloaded
+  4: optional i32 metric
+}
+
+/**
+ * Topology changes to compute routes of a node against, e.g. drain of a node
+ * or link, without applying them to the network.
+ */
+struct RouteDbWhatIfRequest {
+  // node whose routes are computed, this node if empty
+  1: string nodeName
+
+  // new overload (drain) state of nodes
+  2: map<string, bool> nodeOverloads
+
+  3: list<WhatIfLinkChange> linkChanges
+
+  // time budget of computation, default one of Decision if 0. Capped by
+  // Decision
+  4: i32 timeBudgetMs = 0
+}
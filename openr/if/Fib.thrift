@@ -15,11 +15,20 @@ namespace lua openr.Fib
 include "Network.thrift"
 include "Lsdb.thrift"
 
+// time spent and number of routes created by one type of route computation
+struct RouteComputationStats {
+  1: i64 durationUs = 0
+  2: i64 numRoutes = 0
+}
+
 struct RouteDatabase {
   1: string thisNodeName
   3: optional Lsdb.PerfEvents perfEvents;
   4: list<Network.UnicastRoute> unicastRoutes
   5: list<Network.MplsRoute> mplsRoutes
+  // set on route databases computed by Decision, keyed by computation type
+  // ("sp_ecmp", "ksp2_ed_ecmp", "bgp", "mpls_node_label", "mpls_adj_label")
+  6: optional map<string, RouteComputationStats> computationStats
 }
 
 struct RouteDatabaseDelta {
@@ -29,6 +38,9 @@ struct RouteDatabaseDelta {
   4: list<Network.MplsRoute> mplsRoutesToUpdate
   5: list<i32> mplsRoutesToDelete
   6: optional Lsdb.PerfEvents perfEvents;
+  // set on every chunk of route snapshot, or of large route update, streamed
+  // by Fib subscription except the last, see OpenrCtrlCpp.subscribeFib
+  7: optional bool hasMoreChunks;
 }
 
 // Perf log buffer maintained by Fib
@@ -16,6 +16,18 @@ include "Dual.thrift"
 
 const string kDefaultArea = "0"
 
+// Binary diff of a value against earlier version of the same key from the same
+// originator. Value is reconstructed from base value as
+//   base[0, prefixLength) + middle + base[size - suffixLength, size)
+struct ValueDelta {
+  1: i64 baseVersion;
+  // hash of base value, to verify receiver holds exactly the same base
+  2: i64 baseHash;
+  3: i32 prefixLength;
+  4: i32 suffixLength;
+  5: binary middle;
+}
+
 // a value as reported in get replies/publications
 struct Value {
   // current version of this value
@@ -37,11 +49,24 @@ struct Value {
   // should leave it empty and as will be computed by KvStore on `KEY_SET`
   // operation.
   6: optional i64 hash;
+  // Optional attribute, only exchanged between KvStores in flooding. Value
+  // given as delta against an earlier version, in place of `value`. Receiver
+  // which doesn't hold the base version falls back to full-sync with sender.
+  7: optional ValueDelta delta;
 }
 
 typedef map<string, Value>
   (cpp.type = "std::unordered_map<std::string, openr::thrift::Value>") KeyVals
 
+// TTL refresh of a key, sent in place of a Value without value. Originator
+// of key is carried by the enclosing message
+struct KeyTtl {
+  1: string key;
+  2: i64 version;
+  3: i64 ttlVersion;
+  4: i64 ttl;
+}
+
 
 enum Command {
   // NOTE: key-10 has been used in past
@@ -58,6 +83,13 @@ enum Command {
   AREAS_CONFIG_GET = 13; // get AreasConfig from kvstore
 }
 
+// compression of KEY_DUMP response, negotiated with requester
+enum CompressionType {
+  NONE = 0,
+  ZSTD = 1,
+  LZ4 = 2,
+}
+
 //
 // Cmd params
 //
@@ -85,6 +117,14 @@ struct KeySetParams {
   // optional attribute to indicate timestamp when request is sent. This is
   // system timestamp in milliseconds since epoch
   7: optional i64 timestamp_ms
+
+  // Optional attribute. TTL refreshes of keys batched per originatorId. They
+  // are merged same as entries of keyVals without value
+  8: optional map<string, list<KeyTtl>> ttlUpdates
+
+  // Optional attribute. Unix timestamps in milliseconds at which each of
+  // nodeIds flooded this publication, 0 if unknown. Set with flood tracing
+  9: optional list<i64> floodTimestampsMs
 }
 
 // parameters for the KEY_GET command
@@ -97,10 +137,20 @@ struct KeyGetParams {
 // keyVals on which hash differs
 // if keyValHashes is not specified, respond with flooding element to signal of
 // DB change
+// if request includes keyBucketDigests instead, only respond with keyVals of
+// key buckets on which digest differs (see Publication.keyBuckets)
 struct KeyDumpParams {
   1: string prefix
   3: set<string> originatorIds
   2: optional KeyVals keyValHashes
+  // digest of every non-empty key bucket of requester, keyed by bucket index
+  4: optional map<i32, i64> keyBucketDigests
+  // compressions requester accepts for response, in order of preference.
+  // Response is sent uncompressed if none is set or supported by responder
+  5: optional list<CompressionType> compressions
+  // max number of keyVals per response message requester accepts. Larger
+  // response is streamed in chunks (see Publication.hasMoreChunks)
+  6: optional i32 maxChunkKeyVals
 }
 
 // Peer's publication and command socket URLs
@@ -230,4 +280,55 @@ struct Publication {
 
   // area to which this publication belogs
   7: optional string area;
+
+  // a list of key buckets on which digests differ
+  // this is only used for full-sync response to keyBucketDigests. keyVals
+  // carry all keys of these buckets, so that full-sync initiator can find out
+  // which of its keys need to be sent back
+  8: optional list<i32> keyBuckets;
+
+  // serialized publication compressed with `compression`, in place of all
+  // other attributes. This is only used for full-sync response to
+  // KeyDumpParams.compressions
+  9: optional binary compressedPublication;
+  10: optional CompressionType compression;
+
+  // set on every chunk of full-sync response to KeyDumpParams.maxChunkKeyVals
+  // except the last. Only last chunk carries tobeUpdatedKeys and keyBuckets,
+  // and completes the full-sync
+  11: optional bool hasMoreChunks;
+
+  // position of publication in KvStore snoop stream with snapshot, starting
+  // from 0 for first snapshot chunk
+  12: optional i64 seqNum;
+
+  // originators of expiredKeys which don't own any key anymore, so that their
+  // state can be dropped at once. Only set on local expiry publications
+  13: optional list<string> expiredOriginators;
+
+  // unix timestamps in milliseconds at which each of nodeIds flooded this
+  // publication, 0 if unknown. Only set with flood tracing
+  14: optional list<i64> floodTimestampsMs;
+
+  // set once per area on local updates queue, when first full-syncs with
+  // peers are over and KvStore holds complete state of area. Carries no keys
+  15: optional bool initialSyncDone;
+}
+
+// Snapshot of kvstore persisted to disk, reloaded on restart
+struct KvStoreSnapshot {
+  // key-values with TTL remaining at the time of snapshot
+  1: KeyVals keyVals;
+  // unix timestamp in milliseconds at which snapshot was taken
+  2: i64 timestampMs;
+}
+
+// record of publication stream captured by KvStoreSnooper. Capture file is a
+// sequence of serialized records, first one being the initial dump
+struct KvStoreSnoopRecord {
+  // milliseconds since start of capture
+  1: i64 timestampMs;
+  2: Publication publication;
+  // name of snooped node, set on first record only
+  3: optional string nodeName;
 }
@@ -27,6 +27,9 @@ struct PerfEvent {
 
 struct PerfEvents {
   1: list<PerfEvent> events;
+  // random id of the change which started this chain of events, same on all
+  // nodes it propagates to
+  2: optional i64 traceId;
 }
 
 //
@@ -63,6 +66,10 @@ struct InterfaceDatabase {
 
   // Optional attribute to measure convergence performance
   3: optional PerfEvents perfEvents;
+
+  // If set, `interfaces` only holds entries changed since the previous
+  // update. Entries not present retain their previously advertised state.
+  4: bool isDelta = false;
 }
 
 //
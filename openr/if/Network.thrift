@@ -95,6 +95,7 @@ enum PrefixType {
   BGP = 3,
   PREFIX_ALLOCATOR = 4,
   BREEZE = 5,   // Prefixes injected via breeze
+  AREA_SUMMARY = 6, // Summaries of an area advertised into others by Decision
 
   // Placeholder Types
   TYPE_1 = 21,
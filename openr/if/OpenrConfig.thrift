@@ -14,6 +14,10 @@ include "BgpConfig.thrift"
 struct KvstoreFloodRate {
   1: i32 flood_msg_per_sec
   2: i32 flood_msg_burst_size
+  # lower rate on failures to flood to peers and recover it while updates are
+  # pending. flood_msg_per_sec is the maximum rate then. Every priority class
+  # of pending keys (see key_priority_prefixes) costs a token of its own
+  3: optional bool adaptive
 }
 
 struct KvstoreConfig {
@@ -30,6 +34,54 @@ struct KvstoreConfig {
   # flood optimization
   8: optional bool enable_flood_optimization
   9: optional bool is_flood_root
+
+  # number of threads used to merge large publications in parallel. Merged on
+  # kvstore thread if not set. Kvstore thread waits for parallel merge to
+  # complete, hence time it blocks for is reduced rather than removed
+  10: optional i32 merge_threads
+
+  # flood TTL refreshes batched per originator instead of as values. Must be
+  # enabled only once all nodes of the network understand batched TTL updates
+  11: optional bool enable_ttl_update_batching
+
+  # flood updates of large values as delta against their previous version.
+  # Must be enabled only once all nodes of the network understand value deltas
+  12: optional bool enable_value_delta_encoding
+
+  # key prefixes of priority classes, highest priority first. Keys of higher
+  # priority are flooded and merged from full-sync ahead of others. Keys
+  # matching no prefix are of lowest priority. Defaults to adjacency keys
+  # followed by prefix keys
+  13: optional list<string> key_priority_prefixes
+
+  # with flood optimization, spread keys originated by this node over spanning
+  # trees of all flood roots by key hash, instead of flooding all of them down
+  # the tree of the smallest root
+  14: optional bool enable_flood_root_load_balancing
+
+  # file to periodically snapshot kvstore contents to, and to reload them from
+  # on restart. One file per area, suffixed with area name. Disabled if not set
+  15: optional string snapshot_filepath
+  16: optional i32 snapshot_interval_s
+
+  # flood updates to peers advertising their OpenrCtrl port over thrift,
+  # with bounded requests in flight per peer. Full-sync and peers of older
+  # versions keep using ZMQ
+  17: optional bool enable_thrift_flooding
+
+  # flood only the last few hops of the flood path (nodeIds) of publications
+  # instead of the whole path, keeping their size constant in large areas.
+  # Longer loops are cut by version comparison on merge instead
+  18: optional bool enable_compact_flood_path
+
+  # stamp time of flooding on every hop of the flood path, so that Decision
+  # can add per hop flood events to perf events of adjacency databases
+  19: optional bool enable_flood_tracing
+
+  # with flood tracing, start a trace on one in flood_tracing_sample_rate
+  # publications only (1 if not set). Traced publications are stamped on
+  # every hop, and flood delays of them are exported per originator and peer
+  20: optional i32 flood_tracing_sample_rate
 }
 
 struct LinkMonitorConfig {
@@ -50,6 +102,33 @@ struct SparkConfig {
   4: i32 keepalive_time_s = 2
   5: i32 hold_time_s = 10
   6: i32 graceful_restart_time_s = 30
+
+  // Send heartbeats in compact fixed layout, which receivers parse without
+  // thrift decoding. Enable only after whole network supports it.
+  7: bool compact_heartbeat = false
+
+  // Adaptive heartbeat. On interfaces where RTT of a neighbor changes or
+  // heartbeats arrive late, send heartbeats every adaptive_heartbeat_time_ms
+  // and ask neighbors to expire adjacency after
+  // adaptive_heartbeat_hold_time_ms, for a while. Stable interfaces keep
+  // regular (slower) heartbeats.
+  8: bool enable_adaptive_heartbeat = false
+  9: i32 adaptive_heartbeat_time_ms = 100
+  10: i32 adaptive_heartbeat_hold_time_ms = 500
+
+  // Receive packets on dedicated I/O thread, which timestamps and queues them
+  // for neighbor state machine. Keeps socket drained and heartbeat arrival
+  // times accurate while state machine is busy.
+  11: bool enable_io_thread = false
+
+  // Use hardware receive timestamps of NIC for RTT measurement, falling back
+  // to kernel timestamps where unsupported. Requires hardware timestamping
+  // enabled on interfaces and NIC clock synced to system clock.
+  12: bool enable_hw_timestamping = false
+
+  // Send Spark2 hellos in compact varint layout, which carries neighbor list
+  // in a fraction of thrift size. Enable only after whole network supports it.
+  13: bool compact_hello = false
 }
 
 struct WatchdogConfig {
@@ -57,6 +136,13 @@ struct WatchdogConfig {
   2: i32 threshold_s = 300
 }
 
+struct ThreadSchedulingConfig {
+  # CPUs thread is pinned to. Thread can run on any CPU if empty
+  1: list<i32> cpus
+  # nice value of thread, lower value gets higher priority
+  2: optional i32 nice
+}
+
 enum PrefixForwardingType {
   IP = 0
   SR_MPLS = 1
@@ -67,6 +153,15 @@ enum PrefixForwardingAlgorithm {
   KSP2_ED_ECMP = 1
 }
 
+# handling of prefix databases of a node advertising more prefixes than
+# decision_max_prefixes_per_node
+enum PrefixLimitAction {
+  # take prefixes of node up to limit, in order advertised
+  IGNORE_EXCESS = 0
+  # take no prefix of node until it is back under limit
+  IGNORE_ALL = 1
+}
+
 struct PrefixAllocationConfig {
   1: string loopback_interface = "lo"
   2: string seed_prefix
@@ -104,6 +199,12 @@ struct AreaConfig {
   1: string area_id
   2: list<string> interface_regexes
   3: list<string> neighbor_regexes
+
+  # summaries of prefixes of this area, advertised by area border nodes (nodes
+  # in more than one area) like prefixes of their own, while a node reachable
+  # in this area advertises a prefix covered by them. Prefixes of nodes of this
+  # area are not advertised into other areas, summaries are
+  4: list<string> summary_prefixes = []
 }
 
 struct OpenrConfig {
@@ -141,6 +242,53 @@ struct OpenrConfig {
 
   22: optional bool enable_ordered_fib_programming
 
+  # number of threads used by Decision to compute SPF from neighbors for LFA.
+  # Computation is done on decision thread if not set
+  23: optional i32 decision_lfa_spf_threads
+
+  # number of threads used by Decision to compute routes of areas in parallel.
+  # Areas are computed one after another on decision thread if not set
+  24: optional i32 decision_area_threads
+
+  # number of route programming calls, of up to 1000 routes each, which Fib
+  # keeps in flight to platform agent. Defaults to 4
+  25: optional i32 fib_route_programming_window
+
+  # program host (e.g. loopback) routes of a route delta ahead of the rest,
+  # and deletes after adds (make before break)
+  26: optional bool enable_fib_route_priority
+
+  # log, report and keep in perf DB one in every N perf event chains of
+  # programmed routes. Latency histograms account for all. Defaults to 1
+  27: optional i32 fib_perf_event_sample_rate
+
+  # full sync of unicast routes with platform agent is sent in pipelined
+  # chunks (FibService.syncFibChunk) instead of a single syncFib call
+  28: optional bool enable_fib_chunked_sync
+
+  # compute routes of pending updates off decision thread, publications and
+  # queries received meanwhile are applied once computation has finished
+  29: optional bool enable_decision_background_computation
+
+  # CPU affinity and priority of module threads, by thread name (e.g. Spark,
+  # Fib, KvStore, Decision)
+  30: optional map<string, ThreadSchedulingConfig> thread_scheduling_config
+
+  # full sync of routes reads current routes of agent and only programs the
+  # difference, instead of replacing whole route table (e.g. on restart)
+  31: optional bool enable_fib_warm_sync
+
+  # debounce of route computation on link state changes, starting at min and
+  # backing off up to max while changes keep coming. Can be changed by config
+  # reload without restart
+  32: optional i32 decision_debounce_min_ms
+  33: optional i32 decision_debounce_max_ms
+
+  # max number of prefixes Decision takes from a single node of an area,
+  # protecting Decision and Fib from runaway advertisers. Unlimited if not set
+  34: optional i32 decision_max_prefixes_per_node
+  35: PrefixLimitAction decision_prefix_limit_action = PrefixLimitAction.IGNORE_EXCESS
+
   # bgp
   100: optional bool enable_spr
   102: optional BgpConfig.BgpConfig bgp_config
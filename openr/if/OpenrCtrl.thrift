@@ -31,6 +31,20 @@ struct StaticRoutes {
   1: map<i32,list<Network.NextHopThrift>> mplsRoutes;
 }
 
+/**
+ * Sampling CPU profile of Open/R process
+ */
+struct CpuProfile {
+  // folded stacks as "<thread>;<outermost frame>;...;<innermost frame>", to
+  // number of samples taken in them. Ready for flame graph tooling
+  1: map<string, i64> foldedStacks;
+  2: i64 numSamples;
+  // samples lost as sample buffer of profile got full
+  3: i64 numDroppedSamples;
+  4: i32 durationMs;
+  5: i32 samplingHz;
+}
+
 
 /**
  * Thrift service - exposes RPC APIs for interaction with all of Open/R's
@@ -51,6 +65,14 @@ service OpenrCtrl extends fb303_core.BaseService {
    */
   OpenrConfig.OpenrConfig getRunningConfigThrift()
 
+  /**
+   * Reload running config with JSON serialized OpenrConfig, without restart.
+   * Only neighbor and interface regexes of areas, kvstore key filters and
+   * flood rate, and decision debounce timers can change. Configs changing
+   * anything else are rejected and require restart.
+   */
+  void reloadConfig(1: string config) throws (1: OpenrError error)
+
   //
   // PrefixManager APIs
   //
@@ -154,6 +176,16 @@ service OpenrCtrl extends fb303_core.BaseService {
   Fib.PerfDatabase getPerfDb()
     throws (1: OpenrError error)
 
+  /**
+   * Sample CPU usage of Open/R for durationMs and return folded stacks,
+   * tagged by thread names of modules (e.g. `Decision`, `KvStore`, `Spark`).
+   * Only threads whose name starts with threadNamePrefix are kept, all of
+   * them if empty. Duration is capped, and one profile runs at a time.
+   * NOTE: This API should only be accessible from local node
+   */
+  CpuProfile getCpuProfile(1: i32 durationMs, 2: string threadNamePrefix)
+    throws (1: OpenrError error)
+
   //
   // Decision APIs
   //
@@ -172,6 +204,17 @@ service OpenrCtrl extends fb303_core.BaseService {
    */
   Decision.PrefixDbs getDecisionPrefixDbs() throws (1: OpenrError error)
 
+  /**
+   * Compute routes of a node as if the given node overloads and link changes
+   * were applied to current topology, and return their delta to the current
+   * routes of the node. Only copies of link-state are changed, neither the
+   * network nor routes of this node are affected. Fails on unknown nodes or
+   * links, and once time budget of request is exceeded.
+   */
+  Fib.RouteDatabaseDelta getRouteDbWhatIf(
+    1: Decision.RouteDbWhatIfRequest request
+  ) throws (1: OpenrError error)
+
   //
   // Get area feature configuration
   //
@@ -241,6 +284,18 @@ service OpenrCtrl extends fb303_core.BaseService {
   bool longPollKvStoreAdj(1: KvStore.KeyVals snapshot)
     throws (1: OpenrError error)
 
+  /**
+   * Long poll API to get notified of change of "adj:" keys in an area.
+   * Returns generation of adj keys of area as soon as it differs from the one
+   * provided by client, which resumes polling with returned generation.
+   * Returns provided generation back if there is no change for a while.
+   * Any generation (e.g. -1) can be used to learn current one.
+   */
+  i64 longPollKvStoreAdjArea(
+    1: string area,
+    2: i64 generation
+  ) throws (1: OpenrError error)
+
   /**
    * Send Dual message
    */
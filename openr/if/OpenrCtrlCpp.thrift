@@ -8,6 +8,7 @@
 namespace cpp2 openr.thrift
 namespace py3 openr.thrift
 
+include "openr/if/Fib.thrift"
 include "openr/if/KvStore.thrift"
 include "openr/if/OpenrCtrl.thrift"
 
@@ -29,4 +30,58 @@ service OpenrCtrlCpp extends OpenrCtrl.OpenrCtrl {
    * There may be some replicated entries in stream that are also in snapshot.
    */
   KvStore.Publication, stream<KvStore.Publication> subscribeAndGetKvStore()
+
+  /**
+   * Subscribe KvStore updates of an area, filtered on server with same
+   * semantics as `getKvStoreKeyValsFilteredArea`. Publications without any
+   * matching key are not streamed. Expired keys are matched on key prefix
+   * alone, as they carry no originator.
+   */
+  stream<KvStore.Publication> subscribeKvStoreFilter(
+    1: KvStore.KeyDumpParams filter,
+    2: string area = KvStore.kDefaultArea
+  )
+
+  /**
+   * Filtered variant of `subscribeAndGetKvStore`, both snapshot and stream
+   * being filtered as with `subscribeKvStoreFilter`
+   */
+  KvStore.Publication, stream<KvStore.Publication>
+  subscribeAndGetKvStoreFiltered(
+    1: KvStore.KeyDumpParams filter,
+    2: string area = KvStore.kDefaultArea
+  )
+
+  /**
+   * Filtered snapshot and subsequent updates like
+   * `subscribeAndGetKvStoreFiltered`, with snapshot streamed in chunks of at
+   * most `filter.maxChunkKeyVals` keys ahead of updates. Every chunk except
+   * the last has `hasMoreChunks` set, and every publication carries its
+   * `seqNum` in stream. Updates received while snapshot is being taken are
+   * sent after it and may repeat its entries, they are to be merged on
+   * version as KvStore does.
+   */
+  stream<KvStore.Publication> subscribeAndGetKvStoreChunked(
+    1: KvStore.KeyDumpParams filter,
+    2: string area = KvStore.kDefaultArea
+  )
+
+  /**
+   * Subscribe routes of Fib. Stream starts with snapshot of route table as
+   * deltas of routes to update, in chunks of at most `maxChunkRoutes` routes
+   * (default if not positive). Every chunk except the last has
+   * `hasMoreChunks` set. Route updates of Fib follow in order, split into
+   * chunks the same way when larger than `maxChunkRoutes`. Updates
+   * received while snapshot is being taken may repeat its routes, applying
+   * stream in order converges to route table of Fib.
+   */
+  stream<Fib.RouteDatabaseDelta> subscribeFib(1: i32 maxChunkRoutes)
+
+  /**
+   * Routes computed by Decision for each of `nodeNames`, as returned by
+   * `getRouteDbComputed`, streamed as they are computed. Routes of all nodes
+   * are computed in parallel against the same copy of topology, and arrive in
+   * no particular order. Stream completes after the last one.
+   */
+  stream<Fib.RouteDatabase> getRouteDbComputedStream(1: list<string> nodeNames)
 }
@@ -88,6 +88,11 @@ enum SwitchRunState {
    LINK_EVENT = 1,
    ADDRESS_EVENT = 2,
    NEIGHBOR_EVENT = 3,
+
+   /*
+    * PlatformEventBatch of events of any of above types
+    */
+   EVENT_BATCH = 4,
  }
 
 struct PlatformEvent {
@@ -95,6 +100,18 @@ struct PlatformEvent {
   2: binary eventData;
 }
 
+/**
+ * Events published together, in order they happened, under EVENT_BATCH
+ * header. Batches of a publisher are numbered consecutively from 1, so that
+ * subscriber seeing a gap in seqNum, or a new publisherId, knows it lost
+ * events and has to resync its state.
+ */
+struct PlatformEventBatch {
+  1: i64 publisherId;
+  2: i64 seqNum;
+  3: list<PlatformEvent> events;
+}
+
 exception PlatformError {
   1: string message
 } ( message = "message" )
@@ -161,6 +178,20 @@ const map<i16, i16> protocolIdtoPriority = {
 }
 const i16 kUnknowProtAdminDistance = 255
 
+/**
+ * Chunk of routes of a full sync, see FibService.syncFibChunk
+ */
+struct UnicastRouteSyncChunk {
+  // Identifies sync. Chunk of a new sync abandons previous sync of client
+  1: i64 syncId
+
+  // Position of chunk within sync, in [0, numChunks)
+  2: i32 chunkIndex
+  3: i32 numChunks
+
+  4: list<Network.UnicastRoute> routes
+}
+
 /**
  * Interface to on-box Fib.
  */
@@ -199,6 +230,17 @@ service FibService extends fb303_core.BaseService {
     2: list<Network.UnicastRoute> routes,
   ) throws (1: PlatformError error)
 
+  // Chunked version of syncFib, which lets client pipeline a full sync
+  // without building a single message of all routes. Routes of a chunk are
+  // added/updated as it arrives and its response acknowledges them. Chunks
+  // may be processed in any order. Once all chunks of a sync are programmed,
+  // routes of client missing from all of them are deleted before response of
+  // the last one.
+  void syncFibChunk(
+    1: i16 clientId,
+    2: UnicastRouteSyncChunk chunk,
+  ) throws (1: PlatformError error)
+
   // Retrieve list of unicast routes per client
   list<Network.UnicastRoute> getRouteTableByClient(
     1: i16 clientId
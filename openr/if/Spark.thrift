@@ -47,6 +47,9 @@ struct SparkNeighbor {
 
   // the interface name of the node sending hello packets over
   9: string ifName = ""
+
+  // neighbor's OpenrCtrl thrift port, 0 if not advertised
+  10: i32 openrCtrlThriftPort = 0
 }
 
 //
@@ -135,6 +138,10 @@ struct SparkHelloMsg {
 struct SparkHeartbeatMsg {
   1: string nodeName
   2: i64 seqNum
+
+  // heartbeat expiration time to use instead of the negotiated one, while
+  // sender is sending heartbeats at adaptive (faster) rate
+  3: optional i64 holdTime
 }
 
 struct SparkHandshakeMsg {
@@ -10,12 +10,17 @@
 #include <fb303/ServiceData.h>
 #include <fbzmq/service/logging/LogSample.h>
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/FileUtil.h>
 #include <folly/Format.h>
 #include <folly/GLog.h>
 #include <folly/Random.h>
 #include <folly/String.h>
+#include <folly/compression/Compression.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/hash/Hash.h>
 
 #include <openr/common/Constants.h>
+#include <openr/common/OpenrClient.h>
 #include <openr/common/Util.h>
 #include <openr/if/gen-cpp2/OpenrCtrl_types.h>
 
@@ -50,6 +55,58 @@ getKvStoreFilters(std::shared_ptr<const openr::Config> config) {
   }
   return kvFilters;
 }
+
+// Digest of (key, value) covering all attributes compared in full-sync
+int64_t
+getKeyDigest(std::string const& key, openr::thrift::Value const& value) {
+  using folly::hash::hash_128_to_64;
+  auto digest = hash_128_to_64(
+      folly::hash::fnv64(key), folly::hash::fnv64(value.originatorId));
+  digest = hash_128_to_64(digest, value.version);
+  digest = hash_128_to_64(digest, value.ttlVersion);
+  digest = hash_128_to_64(digest, value.hash.value_or(0));
+  return static_cast<int64_t>(digest);
+}
+
+// Codec of full-sync compression, if supported by folly build
+std::optional<folly::io::CodecType>
+getCodecType(openr::thrift::CompressionType compression) {
+  folly::io::CodecType codecType;
+  switch (compression) {
+  case openr::thrift::CompressionType::ZSTD:
+    codecType = folly::io::CodecType::ZSTD;
+    break;
+  case openr::thrift::CompressionType::LZ4:
+    // frame format carries uncompressed length
+    codecType = folly::io::CodecType::LZ4_FRAME;
+    break;
+  default:
+    return std::nullopt;
+  }
+  if (not folly::io::hasCodec(codecType)) {
+    return std::nullopt;
+  }
+  return codecType;
+}
+
+// Address and port of peer's thrift port url, "tcp://[<addr>]:<port>"
+std::optional<std::pair<folly::IPAddress, int32_t>>
+parseThriftPortUrl(std::string const& url) {
+  folly::StringPiece sp(url);
+  if (not sp.removePrefix("tcp://[")) {
+    return std::nullopt;
+  }
+  const auto pos = sp.rfind("]:");
+  if (pos == folly::StringPiece::npos) {
+    return std::nullopt;
+  }
+  auto addr = folly::IPAddress::tryFromString(sp.subpiece(0, pos));
+  auto port = folly::tryTo<int32_t>(sp.subpiece(pos + 2));
+  if (addr.hasError() or port.hasError()) {
+    return std::nullopt;
+  }
+  return std::make_pair(addr.value(), port.value());
+}
 } // namespace
 
 namespace openr {
@@ -76,6 +133,11 @@ KvStoreFilters::keyMatch(
   return false;
 }
 
+bool
+KvStoreFilters::keyPrefixMatch(std::string const& key) const {
+  return keyPrefixList_.empty() or keyPrefixObjList_.keyMatch(key);
+}
+
 std::vector<std::string>
 KvStoreFilters::getKeyPrefixes() const {
   return keyPrefixList_;
@@ -86,6 +148,19 @@ KvStoreFilters::getOrigniatorIdList() const {
   return originatorIds_;
 }
 
+std::optional<std::vector<std::string>>
+KvStoreFilters::getLiteralKeyPrefixes() const {
+  if (keyPrefixList_.empty() or not originatorIds_.empty()) {
+    return std::nullopt;
+  }
+  for (auto const& keyPrefix : keyPrefixList_) {
+    if (not KeyPrefix::isLiteral(keyPrefix)) {
+      return std::nullopt;
+    }
+  }
+  return keyPrefixList_;
+}
+
 std::string
 KvStoreFilters::str() const {
   std::string result{};
@@ -103,7 +178,8 @@ KvStoreFilters::str() const {
 KvStore::KvStore(
     // initializers for immutable state
     fbzmq::Context& zmqContext,
-    messaging::ReplicateQueue<thrift::Publication>& kvStoreUpdatesQueue,
+    messaging::ReplicateQueue<messaging::SharedValue<thrift::Publication>>&
+        kvStoreUpdatesQueue,
     messaging::RQueue<thrift::PeerUpdateRequest> peerUpdateQueue,
     KvStoreGlobalCmdUrl globalCmdUrl,
     MonitorSubmitUrl monitorSubmitUrl,
@@ -136,6 +212,43 @@ KvStore::KvStore(
       std::make_shared<fbzmq::ZmqMonitorClient>(zmqContext, monitorSubmitUrl);
   kvParams_.zmqMonitorClient = zmqMonitorClient_;
 
+  const auto numMergeThreads =
+      std::max(config->getKvStoreConfig().merge_threads_ref().value_or(0), 0);
+  if (numMergeThreads > 0) {
+    mergeExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        numMergeThreads,
+        std::make_shared<folly::NamedThreadFactory>("KvStoreMerge"));
+    kvParams_.mergeExecutor = mergeExecutor_.get();
+  }
+  kvParams_.enableTtlUpdateBatching =
+      config->getKvStoreConfig().enable_ttl_update_batching_ref().value_or(
+          false);
+  kvParams_.keyPriorityPrefixes =
+      config->getKvStoreConfig().key_priority_prefixes_ref().value_or(
+          std::vector<std::string>{Constants::kAdjDbMarker.toString(),
+                                   Constants::kPrefixDbMarker.toString()});
+  kvParams_.enableValueDeltaEncoding =
+      config->getKvStoreConfig().enable_value_delta_encoding_ref().value_or(
+          false);
+  kvParams_.enableFloodRootLoadBalancing =
+      config->getKvStoreConfig()
+          .enable_flood_root_load_balancing_ref()
+          .value_or(false);
+  kvParams_.snapshotFilePath =
+      config->getKvStoreConfig().snapshot_filepath_ref().value_or("");
+  kvParams_.snapshotInterval = std::chrono::seconds(
+      config->getKvStoreConfig().snapshot_interval_s_ref().value_or(
+          Constants::kKvStoreSnapshotInterval.count()));
+  kvParams_.enableThriftFlooding =
+      config->getKvStoreConfig().enable_thrift_flooding_ref().value_or(false);
+  kvParams_.enableCompactFloodPath =
+      config->getKvStoreConfig().enable_compact_flood_path_ref().value_or(
+          false);
+  kvParams_.enableFloodTracing =
+      config->getKvStoreConfig().enable_flood_tracing_ref().value_or(false);
+  kvParams_.floodTracingSampleRate =
+      config->getKvStoreConfig().flood_tracing_sample_rate_ref().value_or(1);
+
   // Schedule periodic timer for counters submission
   counterUpdateTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
     for (auto& counter : getGlobalCounters()) {
@@ -211,142 +324,216 @@ KvStore::KvStore(
   }
 }
 
-// static, public
-std::unordered_map<std::string, thrift::Value>
-KvStore::mergeKeyValues(
-    std::unordered_map<std::string, thrift::Value>& kvStore,
-    std::unordered_map<std::string, thrift::Value> const& keyVals,
-    std::optional<KvStoreFilters> const& filters) {
-  // the publication to build if we update our KV store
-  std::unordered_map<std::string, thrift::Value> kvUpdates;
-
-  // Counters for logging
-  uint32_t ttlUpdateCnt{0}, valUpdateCnt{0};
-
-  for (const auto& kv : keyVals) {
-    auto const& key = kv.first;
-    auto const& value = kv.second;
+namespace {
 
-    if (filters.has_value() && not filters->keyMatch(kv.first, kv.second)) {
-      VLOG(4) << "key: " << key << " not adding from " << value.originatorId;
-      continue;
-    }
+// Outcome of merging one received key-value into KvStore
+struct MergeDecision {
+  std::string const* key{nullptr};
+  thrift::Value const* value{nullptr};
+  bool updateAllNeeded{false};
+  bool updateTtlNeeded{false};
+  // hash of value, generated if it is to be stored without one
+  std::optional<int64_t> hash;
+};
+
+// Decide how key-value merges into kvStore. Doesn't modify kvStore and hence
+// can run concurrently for different keys.
+void
+decideMerge(
+    std::unordered_map<std::string, thrift::Value> const& kvStore,
+    std::optional<KvStoreFilters> const& filters,
+    MergeDecision& decision) {
+  auto const& key = *decision.key;
+  auto const& value = *decision.value;
+
+  if (filters.has_value() && not filters->keyMatch(key, value)) {
+    VLOG(4) << "key: " << key << " not adding from " << value.originatorId;
+    return;
+  }
 
-    // versions must start at 1; setting this to zero here means
-    // we would be beaten by any version supplied by the setter
-    int64_t myVersion{0};
-    int64_t newVersion = value.version;
+  // versions must start at 1; setting this to zero here means
+  // we would be beaten by any version supplied by the setter
+  int64_t myVersion{0};
+  int64_t newVersion = value.version;
 
-    // Check if TTL is valid. It must be infinite or positive number
-    // Skip if invalid!
-    if (value.ttl != Constants::kTtlInfinity && value.ttl <= 0) {
-      continue;
-    }
+  // Check if TTL is valid. It must be infinite or positive number
+  // Skip if invalid!
+  if (value.ttl != Constants::kTtlInfinity && value.ttl <= 0) {
+    return;
+  }
 
-    // if key exist, compare values first
-    // if they are the same, no need to propagate changes
-    auto kvStoreIt = kvStore.find(key);
-    if (kvStoreIt != kvStore.end()) {
-      myVersion = kvStoreIt->second.version;
-    } else {
-      VLOG(4) << "(mergeKeyValues) key: '" << key << "' not found, adding";
-    }
+  // if key exist, compare values first
+  // if they are the same, no need to propagate changes
+  auto kvStoreIt = kvStore.find(key);
+  if (kvStoreIt != kvStore.end()) {
+    myVersion = kvStoreIt->second.version;
+  } else {
+    VLOG(4) << "(mergeKeyValues) key: '" << key << "' not found, adding";
+  }
 
-    // If we get an old value just skip it
-    if (newVersion < myVersion) {
-      continue;
-    }
+  // If we get an old value just skip it
+  if (newVersion < myVersion) {
+    return;
+  }
 
-    bool updateAllNeeded{false};
-    bool updateTtlNeeded{false};
+  bool updateAllNeeded{false};
+  bool updateTtlNeeded{false};
 
-    //
-    // Check updateAll and updateTtl
-    //
-    if (value.value.has_value()) {
-      if (newVersion > myVersion) {
-        // Version is newer or
-        // kvStoreIt is NULL(myVersion is set to 0)
-        updateAllNeeded = true;
-      } else if (value.originatorId > kvStoreIt->second.originatorId) {
-        // versions are the same but originatorId is higher
+  //
+  // Check updateAll and updateTtl
+  //
+  if (value.value.has_value()) {
+    if (newVersion > myVersion) {
+      // Version is newer or
+      // kvStoreIt is NULL(myVersion is set to 0)
+      updateAllNeeded = true;
+    } else if (value.originatorId > kvStoreIt->second.originatorId) {
+      // versions are the same but originatorId is higher
+      updateAllNeeded = true;
+    } else if (value.originatorId == kvStoreIt->second.originatorId) {
+      // This can occur after kvstore restarts or simply reconnects after
+      // disconnection. We let one of the two values win if they
+      // differ(higher in this case but can be lower as long as it's
+      // deterministic). Otherwise, local store can have new value while
+      // other stores have old value and they never sync.
+      int rc = (*value.value).compare(*kvStoreIt->second.value);
+      if (rc > 0) {
+        // versions and orginatorIds are same but value is higher
+        VLOG(3) << "Previous incarnation reflected back for key " << key;
         updateAllNeeded = true;
-      } else if (value.originatorId == kvStoreIt->second.originatorId) {
-        // This can occur after kvstore restarts or simply reconnects after
-        // disconnection. We let one of the two values win if they
-        // differ(higher in this case but can be lower as long as it's
-        // deterministic). Otherwise, local store can have new value while
-        // other stores have old value and they never sync.
-        int rc = (*value.value).compare(*kvStoreIt->second.value);
-        if (rc > 0) {
-          // versions and orginatorIds are same but value is higher
-          VLOG(3) << "Previous incarnation reflected back for key " << key;
-          updateAllNeeded = true;
-        } else if (rc == 0) {
-          // versions, orginatorIds, value are all same
-          // retain higher ttlVersion
-          if (value.ttlVersion > kvStoreIt->second.ttlVersion) {
-            updateTtlNeeded = true;
-          }
+      } else if (rc == 0) {
+        // versions, orginatorIds, value are all same
+        // retain higher ttlVersion
+        if (value.ttlVersion > kvStoreIt->second.ttlVersion) {
+          updateTtlNeeded = true;
         }
       }
     }
+  }
+
+  //
+  // Check updateTtl
+  //
+  if (not value.value.has_value() and kvStoreIt != kvStore.end() and
+      value.version == kvStoreIt->second.version and
+      value.originatorId == kvStoreIt->second.originatorId and
+      value.ttlVersion > kvStoreIt->second.ttlVersion) {
+    updateTtlNeeded = true;
+  }
+
+  if (!updateAllNeeded and !updateTtlNeeded) {
+    VLOG(3) << "(mergeKeyValues) no need to update anything for key: '" << key
+            << "'";
+    return;
+  }
+
+  VLOG(3) << "Updating key: " << key << "\n  Version: " << myVersion << " -> "
+          << newVersion << "\n  Originator: "
+          << (kvStoreIt != kvStore.end() ? kvStoreIt->second.originatorId
+                                         : "null")
+          << " -> " << value.originatorId << "\n  TtlVersion: "
+          << (kvStoreIt != kvStore.end() ? kvStoreIt->second.ttlVersion : 0)
+          << " -> " << value.ttlVersion << "\n  Ttl: "
+          << (kvStoreIt != kvStore.end() ? kvStoreIt->second.ttl : 0)
+          << " -> " << value.ttl;
+
+  decision.updateAllNeeded = updateAllNeeded;
+  decision.updateTtlNeeded = updateTtlNeeded;
+  // generate hash if it's not there
+  if (updateAllNeeded and not value.hash.has_value()) {
+    decision.hash =
+        generateHash(value.version, value.originatorId, value.value);
+  }
+}
 
-    //
-    // Check updateTtl
-    //
-    if (not value.value.has_value() and kvStoreIt != kvStore.end() and
-        value.version == kvStoreIt->second.version and
-        value.originatorId == kvStoreIt->second.originatorId and
-        value.ttlVersion > kvStoreIt->second.ttlVersion) {
-      updateTtlNeeded = true;
+// Merge keyVals into kvStore, see KvStore::mergeKeyValues(). If moveValues
+// is set, keyVals is owned by caller for merge and values making it into
+// kvStore are moved instead of copied
+std::unordered_map<std::string, thrift::Value>
+mergeKeyValuesImpl(
+    std::unordered_map<std::string, thrift::Value>& kvStore,
+    std::unordered_map<std::string, thrift::Value> const& keyVals,
+    std::optional<KvStoreFilters> const& filters,
+    folly::Executor* executor,
+    bool moveValues) {
+  // the publication to build if we update our KV store
+  std::unordered_map<std::string, thrift::Value> kvUpdates;
+
+  // Counters for logging
+  uint32_t ttlUpdateCnt{0}, valUpdateCnt{0};
+
+  std::vector<MergeDecision> decisions(keyVals.size());
+  size_t index{0};
+  for (const auto& kv : keyVals) {
+    decisions[index].key = &kv.first;
+    decisions[index].value = &kv.second;
+    ++index;
+  }
+
+  // Comparison and hashing of received key-values is done on executor, in
+  // chunks of keys. Received keys are unique, so chunks never race on the
+  // same key. kvStore is only modified afterwards.
+  // NOTE: calling thread, kvstore event base, is blocked until every chunk is
+  // decided. It decides first chunk itself rather than idling meanwhile
+  const size_t chunkSize = Constants::kKvStoreMergeChunkSize;
+  if (executor and decisions.size() > chunkSize) {
+    std::vector<folly::SemiFuture<folly::Unit>> merges;
+    for (size_t begin = chunkSize; begin < decisions.size();
+         begin += chunkSize) {
+      const size_t end = std::min(begin + chunkSize, decisions.size());
+      merges.emplace_back(
+          folly::via(executor, [&kvStore, &filters, &decisions, begin, end]() {
+            for (size_t i = begin; i < end; ++i) {
+              decideMerge(kvStore, filters, decisions[i]);
+            }
+          }).semi());
+    }
+    for (size_t i = 0; i < chunkSize; ++i) {
+      decideMerge(kvStore, filters, decisions[i]);
+    }
+    folly::collect(std::move(merges)).get();
+  } else {
+    for (auto& decision : decisions) {
+      decideMerge(kvStore, filters, decision);
     }
+  }
 
-    if (!updateAllNeeded and !updateTtlNeeded) {
-      VLOG(3) << "(mergeKeyValues) no need to update anything for key: '" << key
-              << "'";
+  for (auto& decision : decisions) {
+    if (not decision.updateAllNeeded and not decision.updateTtlNeeded) {
       continue;
     }
+    auto const& key = *decision.key;
+    auto const& value = *decision.value;
+    auto kvStoreIt = kvStore.find(key);
 
-    VLOG(3) << "Updating key: " << key << "\n  Version: " << myVersion << " -> "
-            << newVersion << "\n  Originator: "
-            << (kvStoreIt != kvStore.end() ? kvStoreIt->second.originatorId
-                                           : "null")
-            << " -> " << value.originatorId << "\n  TtlVersion: "
-            << (kvStoreIt != kvStore.end() ? kvStoreIt->second.ttlVersion : 0)
-            << " -> " << value.ttlVersion << "\n  Ttl: "
-            << (kvStoreIt != kvStore.end() ? kvStoreIt->second.ttl : 0)
-            << " -> " << value.ttl;
-
-    // grab the new value (this will copy, intended)
-    thrift::Value newValue = value;
-
-    if (updateAllNeeded) {
+    if (decision.updateAllNeeded) {
       ++valUpdateCnt;
       FB_LOG_EVERY_MS(INFO, 500)
           << "Updating key: " << key << ", Originator: " << value.originatorId
-          << ", Version: " << newVersion << ", TtlVersion: " << value.ttlVersion
-          << ", Ttl: " << value.ttl;
+          << ", Version: " << value.version
+          << ", TtlVersion: " << value.ttlVersion << ", Ttl: " << value.ttl;
       //
       // update everything for such key
       //
       CHECK(value.value.has_value());
-      if (kvStoreIt == kvStore.end()) {
+      if (moveValues) {
+        // grab the new value by moving it. keyVals is a mutable map handed
+        // over to merge, see rvalue flavour of KvStore::mergeKeyValues()
+        std::tie(kvStoreIt, std::ignore) = kvStore.insert_or_assign(
+            key, std::move(const_cast<thrift::Value&>(value)));
+      } else if (kvStoreIt == kvStore.end()) {
+        // grab the new value (this will copy, intended)
         // create new entry
-        std::tie(kvStoreIt, std::ignore) = kvStore.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(key),
-            std::forward_as_tuple(std::move(newValue)));
+        std::tie(kvStoreIt, std::ignore) = kvStore.emplace(key, value);
       } else {
         // update the entry in place, the old value will be destructed
-        kvStoreIt->second = std::move(newValue);
+        kvStoreIt->second = value;
       }
       // update hash if it's not there
-      if (not kvStoreIt->second.hash.has_value()) {
-        kvStoreIt->second.hash =
-            generateHash(value.version, value.originatorId, value.value);
+      if (decision.hash.has_value()) {
+        kvStoreIt->second.hash = *decision.hash;
       }
-    } else if (updateTtlNeeded) {
+    } else {
       ++ttlUpdateCnt;
       //
       // update ttl,ttlVersion only
@@ -358,8 +545,14 @@ KvStore::mergeKeyValues(
       kvStoreIt->second.ttlVersion = value.ttlVersion;
     }
 
-    // announce the update
-    kvUpdates.emplace(key, value);
+    // announce the update. Hash is taken from the store as it might have been
+    // generated here. Moved values are announced as stored
+    auto const& announced =
+        moveValues and decision.updateAllNeeded ? kvStoreIt->second : value;
+    auto& update = kvUpdates.emplace(key, announced).first->second;
+    if (update.value.has_value()) {
+      update.hash.copy_from(kvStoreIt->second.hash);
+    }
   }
 
   VLOG(4) << "(mergeKeyValues) updating " << kvUpdates.size()
@@ -368,6 +561,230 @@ KvStore::mergeKeyValues(
   return kvUpdates;
 }
 
+} // namespace
+
+// static, public
+std::unordered_map<std::string, thrift::Value>
+KvStore::mergeKeyValues(
+    std::unordered_map<std::string, thrift::Value>& kvStore,
+    std::unordered_map<std::string, thrift::Value> const& keyVals,
+    std::optional<KvStoreFilters> const& filters,
+    folly::Executor* executor) {
+  return mergeKeyValuesImpl(kvStore, keyVals, filters, executor, false);
+}
+
+// static, public
+std::unordered_map<std::string, thrift::Value>
+KvStore::mergeKeyValues(
+    std::unordered_map<std::string, thrift::Value>& kvStore,
+    std::unordered_map<std::string, thrift::Value>&& keyVals,
+    std::optional<KvStoreFilters> const& filters,
+    folly::Executor* executor) {
+  return mergeKeyValuesImpl(kvStore, keyVals, filters, executor, true);
+}
+
+size_t
+KvStore::packTtlUpdates(thrift::KeySetParams& params) {
+  std::map<std::string, std::vector<thrift::KeyTtl>> ttlUpdates;
+  size_t numTtlUpdates{0};
+  for (auto it = params.keyVals.begin(); it != params.keyVals.end();) {
+    auto const& value = it->second;
+    if (value.value.has_value()) {
+      ++it;
+      continue;
+    }
+    thrift::KeyTtl keyTtl;
+    keyTtl.key = it->first;
+    keyTtl.version = value.version;
+    keyTtl.ttlVersion = value.ttlVersion;
+    keyTtl.ttl = value.ttl;
+    ttlUpdates[value.originatorId].emplace_back(std::move(keyTtl));
+    ++numTtlUpdates;
+    it = params.keyVals.erase(it);
+  }
+  if (numTtlUpdates) {
+    params.ttlUpdates_ref() = std::move(ttlUpdates);
+  }
+  return numTtlUpdates;
+}
+
+void
+KvStore::unpackTtlUpdates(thrift::KeySetParams& params) {
+  if (not params.ttlUpdates_ref().has_value()) {
+    return;
+  }
+  for (auto& kv : *params.ttlUpdates_ref()) {
+    for (auto& keyTtl : kv.second) {
+      thrift::Value value;
+      value.version = keyTtl.version;
+      value.originatorId = kv.first;
+      value.ttl = keyTtl.ttl;
+      value.ttlVersion = keyTtl.ttlVersion;
+      // Value of key, if any, takes precedence over its TTL refresh
+      params.keyVals.emplace(std::move(keyTtl.key), std::move(value));
+    }
+  }
+  params.ttlUpdates_ref().reset();
+}
+
+std::optional<thrift::ValueDelta>
+KvStore::createValueDelta(
+    thrift::Value const& base, thrift::Value const& update) {
+  if (not base.value.has_value() or not base.hash.has_value() or
+      not update.value.has_value() or
+      base.originatorId != update.originatorId or
+      base.version >= update.version) {
+    return std::nullopt;
+  }
+  auto const& baseValue = base.value.value();
+  auto const& value = update.value.value();
+  if (value.size() < Constants::kKvStoreValueDeltaMinSize) {
+    return std::nullopt;
+  }
+
+  // Changes of serialized databases are mostly local, e.g. metric of single
+  // adjacency. Common prefix and suffix cover the rest.
+  const size_t maxCommon = std::min(baseValue.size(), value.size());
+  const size_t prefixLength =
+      std::mismatch(
+          baseValue.begin(), baseValue.begin() + maxCommon, value.begin())
+          .first -
+      baseValue.begin();
+  const size_t suffixLength =
+      std::mismatch(
+          baseValue.rbegin(),
+          baseValue.rbegin() + (maxCommon - prefixLength),
+          value.rbegin())
+          .first -
+      baseValue.rbegin();
+
+  // Worth it only if delta saves at least half of value
+  const size_t middleLength = value.size() - prefixLength - suffixLength;
+  if (middleLength * 2 > value.size()) {
+    return std::nullopt;
+  }
+
+  thrift::ValueDelta delta;
+  delta.baseVersion = base.version;
+  delta.baseHash = base.hash.value();
+  delta.prefixLength = static_cast<int32_t>(prefixLength);
+  delta.suffixLength = static_cast<int32_t>(suffixLength);
+  delta.middle = value.substr(prefixLength, middleLength);
+  return delta;
+}
+
+bool
+KvStore::applyValueDelta(thrift::Value const& base, thrift::Value& update) {
+  CHECK(update.delta_ref().has_value());
+  auto const& delta = update.delta_ref().value();
+  if (not base.value.has_value() or not base.hash.has_value() or
+      base.originatorId != update.originatorId or
+      base.version != delta.baseVersion or
+      base.hash.value() != delta.baseHash) {
+    return false;
+  }
+  auto const& baseValue = base.value.value();
+  if (delta.prefixLength < 0 or delta.suffixLength < 0 or
+      static_cast<size_t>(delta.prefixLength) +
+              static_cast<size_t>(delta.suffixLength) >
+          baseValue.size()) {
+    return false;
+  }
+
+  std::string value;
+  value.reserve(delta.prefixLength + delta.middle.size() + delta.suffixLength);
+  value.append(baseValue, 0, delta.prefixLength);
+  value.append(delta.middle);
+  value.append(
+      baseValue, baseValue.size() - delta.suffixLength, delta.suffixLength);
+  update.value_ref() = std::move(value);
+  update.delta_ref().reset();
+  return true;
+}
+
+std::vector<thrift::CompressionType>
+KvStore::getSupportedCompressions() {
+  std::vector<thrift::CompressionType> compressions;
+  for (auto compression :
+       {thrift::CompressionType::ZSTD, thrift::CompressionType::LZ4}) {
+    if (getCodecType(compression).has_value()) {
+      compressions.emplace_back(compression);
+    }
+  }
+  return compressions;
+}
+
+thrift::Publication
+KvStore::compressPublication(
+    thrift::Publication&& publication,
+    std::vector<thrift::CompressionType> const& compressions) {
+  std::optional<thrift::CompressionType> compression;
+  std::optional<folly::io::CodecType> codecType;
+  for (auto c : compressions) {
+    codecType = getCodecType(c);
+    if (codecType.has_value()) {
+      compression = c;
+      break;
+    }
+  }
+  if (not compression.has_value()) {
+    return std::move(publication);
+  }
+
+  auto serialized =
+      apache::thrift::CompactSerializer::serialize<std::string>(publication);
+  if (serialized.size() < Constants::kKvStoreSyncCompressionMinSize) {
+    return std::move(publication);
+  }
+
+  thrift::Publication compressedPub;
+  auto codec = folly::io::getCodec(*codecType);
+  compressedPub.compressedPublication_ref() =
+      codec->compress(folly::StringPiece(serialized));
+  compressedPub.compression_ref() = *compression;
+
+  fb303::fbData->addStatValue(
+      "kvstore.full_sync.sent_uncompressed_bytes",
+      serialized.size(),
+      fb303::SUM);
+  fb303::fbData->addStatValue(
+      "kvstore.full_sync.sent_compressed_bytes",
+      compressedPub.compressedPublication_ref()->size(),
+      fb303::SUM);
+  return compressedPub;
+}
+
+std::optional<thrift::Publication>
+KvStore::decompressPublication(thrift::Publication const& publication) {
+  CHECK(publication.compressedPublication_ref().has_value());
+  const auto codecType = getCodecType(
+      publication.compression_ref().value_or(thrift::CompressionType::NONE));
+  if (not codecType.has_value()) {
+    LOG(ERROR) << "Unsupported compression of publication";
+    return std::nullopt;
+  }
+
+  try {
+    const auto& compressed = *publication.compressedPublication_ref();
+    const auto serialized = folly::io::getCodec(*codecType)->uncompress(
+        folly::StringPiece(compressed));
+    fb303::fbData->addStatValue(
+        "kvstore.full_sync.received_compressed_bytes",
+        compressed.size(),
+        fb303::SUM);
+    fb303::fbData->addStatValue(
+        "kvstore.full_sync.received_uncompressed_bytes",
+        serialized.size(),
+        fb303::SUM);
+    return apache::thrift::CompactSerializer::deserialize<thrift::Publication>(
+        serialized);
+  } catch (std::exception const& e) {
+    LOG(ERROR) << "Failed to decompress publication: "
+               << folly::exceptionStr(e);
+    return std::nullopt;
+  }
+}
+
 /**
  * Compare two values to find out which value is better
  */
@@ -406,6 +823,82 @@ KvStore::compareValues(const thrift::Value& v1, const thrift::Value& v2) {
   }
 }
 
+// Uses stable hash so that all nodes agree on key buckets
+int32_t
+KvStore::getKeyBucket(std::string const& key) {
+  return folly::hash::fnv64(key) % Constants::kKvStoreSyncKeyBuckets;
+}
+
+// Merge update into pending publication of same area. Returns false, leaving
+// pending as is, if areas differ
+bool
+KvStore::coalescePublication(
+    thrift::Publication& pending, thrift::Publication const& update) {
+  const std::string defaultArea{thrift::KvStore_constants::kDefaultArea()};
+  if (pending.area_ref().value_or(defaultArea) !=
+      update.area_ref().value_or(defaultArea)) {
+    return false;
+  }
+
+  for (const auto& kv : update.keyVals) {
+    auto it = pending.keyVals.find(kv.first);
+    if (not kv.second.value.has_value() and it != pending.keyVals.end()) {
+      // TTL refresh of a pending value. Retain the value
+      it->second.ttl = kv.second.ttl;
+      it->second.ttlVersion = kv.second.ttlVersion;
+    } else {
+      pending.keyVals[kv.first] = kv.second;
+    }
+  }
+
+  // Keep expired and updated keys disjoint in order of arrival
+  for (const auto& key : update.expiredKeys) {
+    pending.keyVals.erase(key);
+  }
+  pending.expiredKeys.erase(
+      std::remove_if(
+          pending.expiredKeys.begin(),
+          pending.expiredKeys.end(),
+          [&](const std::string& key) {
+            return update.keyVals.count(key) or
+                std::find(
+                    update.expiredKeys.begin(),
+                    update.expiredKeys.end(),
+                    key) != update.expiredKeys.end();
+          }),
+      pending.expiredKeys.end());
+  pending.expiredKeys.insert(
+      pending.expiredKeys.end(),
+      update.expiredKeys.begin(),
+      update.expiredKeys.end());
+
+  pending.nodeIds = update.nodeIds;
+  if (update.initialSyncDone_ref().value_or(false)) {
+    pending.initialSyncDone_ref() = true;
+  }
+  return true;
+}
+
+// Readers of KvStore updates coalesce pending publications once queue is full
+messaging::ReaderOptions<messaging::SharedValue<thrift::Publication>>
+KvStore::getKvStoreUpdatesReaderOptions() {
+  messaging::ReaderOptions<messaging::SharedValue<thrift::Publication>>
+      options;
+  options.maxSize = Constants::kKvStoreUpdatesQueueMaxSize;
+  options.overflowPolicy = messaging::OverflowPolicy::COALESCE;
+  options.coalesce = [](messaging::SharedValue<thrift::Publication>& pending,
+                        messaging::SharedValue<thrift::Publication>&& update) {
+    // Pending publication is shared with other readers. Merge into a copy
+    auto merged = std::make_shared<thrift::Publication>(*pending);
+    if (not coalescePublication(*merged, *update)) {
+      return false;
+    }
+    pending = std::move(merged);
+    return true;
+  };
+  return options;
+}
+
 void
 KvStore::prepareSocket(
     fbzmq::Socket<ZMQ_ROUTER, fbzmq::ZMQ_SERVER>& socket,
@@ -472,8 +965,7 @@ KvStore::processCmdSocketRequest(std::vector<fbzmq::Message>&& req) noexcept {
 folly::Expected<fbzmq::Message, fbzmq::Error>
 KvStore::processRequestMsg(
     const std::string& requestId, fbzmq::Message&& request) {
-  fb303::fbData->addStatValue(
-      "kvstore.peers.bytes_received", request.size(), fb303::SUM);
+  peerBytesReceived_.add(request.size());
   auto maybeThriftReq =
       request.readThriftObj<thrift::KvStoreRequest>(serializer_);
 
@@ -494,8 +986,7 @@ KvStore::processRequestMsg(
     auto& kvStoreDb = kvStoreDb_.at(area);
     auto response = kvStoreDb.processRequestMsgHelper(requestId, thriftRequest);
     if (response.hasValue()) {
-      fb303::fbData->addStatValue(
-          "kvstore.peers.bytes_sent", response->size(), fb303::SUM);
+      peerBytesSent_.add(response->size());
     }
     return response;
   } catch (std::out_of_range const& e) {
@@ -506,9 +997,21 @@ KvStore::processRequestMsg(
   return {folly::makeUnexpected(fbzmq::Error())};
 }
 
-messaging::RQueue<thrift::Publication>
+std::optional<int64_t>
+KvStore::getKvStoreGeneration(std::string const& area) const {
+  // kvStoreDb_ is never modified after construction, safe to look up from
+  // any thread
+  auto it = kvStoreDb_.find(area);
+  if (it == kvStoreDb_.end()) {
+    return std::nullopt;
+  }
+  return it->second.getGeneration();
+}
+
+messaging::RQueue<messaging::SharedValue<thrift::Publication>>
 KvStore::getKvStoreUpdatesReader() {
-  return kvParams_.kvStoreUpdatesQueue.getReader();
+  return kvParams_.kvStoreUpdatesQueue.getReader(
+      getKvStoreUpdatesReaderOptions());
 }
 
 void
@@ -571,10 +1074,16 @@ KvStore::dumpKvStoreKeys(
       folly::split(",", keyDumpParams.prefix, keyPrefixList, true);
       const auto keyPrefixMatch =
           KvStoreFilters(keyPrefixList, keyDumpParams.originatorIds);
-      auto thriftPub = kvStoreDb.dumpAllWithFilters(keyPrefixMatch);
+      thrift::Publication thriftPub;
       if (keyDumpParams.keyValHashes.has_value()) {
         thriftPub = kvStoreDb.dumpDifference(
-            thriftPub.keyVals, keyDumpParams.keyValHashes.value());
+            kvStoreDb.dumpAllWithFilters(keyPrefixMatch).keyVals,
+            keyDumpParams.keyValHashes.value());
+      } else if (keyDumpParams.keyBucketDigests.has_value()) {
+        thriftPub = kvStoreDb.dumpKeyBucketDifference(
+            keyPrefixMatch, keyDumpParams.keyBucketDigests.value());
+      } else {
+        thriftPub = kvStoreDb.dumpAllWithFilters(keyPrefixMatch);
       }
       kvStoreDb.updatePublicationTtl(thriftPub);
       // I'm the initiator, set flood-root-id
@@ -654,23 +1163,25 @@ KvStore::setKvStoreKeyVals(
         }
       }
 
-      // Update hash for key-values
+      // Don't trust hash of key-values from sender. It is generated on merge
+      // for the ones which make it into local KvStore
       auto& kvStoreDb = kvStoreDb_.at(area);
+      unpackTtlUpdates(keySetParams);
+      kvStoreDb.dropDuplicateKeyVals(keySetParams.keyVals);
       for (auto& kv : keySetParams.keyVals) {
-        auto& value = kv.second;
-        if (value.value.has_value()) {
-          value.hash =
-              generateHash(value.version, value.originatorId, value.value);
-        }
+        kv.second.hash_ref().reset();
       }
 
       // Create publication and merge it with local KvStore
       thrift::Publication rcvdPublication;
       rcvdPublication.keyVals = std::move(keySetParams.keyVals);
       rcvdPublication.nodeIds.move_from(std::move(keySetParams.nodeIds));
+      rcvdPublication.floodTimestampsMs_ref().move_from(
+          std::move(keySetParams.floodTimestampsMs_ref()));
       rcvdPublication.floodRootId.move_from(
           std::move(keySetParams.floodRootId));
-      kvStoreDb.mergePublication(rcvdPublication);
+      kvStoreDb.resolveValueDeltas(rcvdPublication);
+      kvStoreDb.mergePublication(std::move(rcvdPublication));
 
       // ready to return
       p.setValue();
@@ -679,6 +1190,16 @@ KvStore::setKvStoreKeyVals(
   return sf;
 }
 
+void
+KvStore::stop() {
+  getEvb()->runImmediatelyOrRunInEventBaseThreadAndWait([this]() {
+    for (auto& kv : kvStoreDb_) {
+      kv.second.closeThriftFloodPeers();
+    }
+  });
+  OpenrEventBase::stop();
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::AreasConfig>>
 KvStore::getAreasConfig() {
   folly::Promise<std::unique_ptr<thrift::AreasConfig>> p;
@@ -691,6 +1212,24 @@ KvStore::getAreasConfig() {
   return sf;
 }
 
+folly::SemiFuture<folly::Unit>
+KvStore::reloadConfig(std::shared_ptr<const Config> config) {
+  folly::Promise<folly::Unit> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread(
+      [this, p = std::move(p), config = std::move(config)]() mutable {
+        kvParams_.filters = getKvStoreFilters(config);
+        kvParams_.floodRate =
+            config->getKvStoreConfig().flood_rate_ref().to_optional();
+        for (auto& kv : kvStoreDb_) {
+          kv.second.updateFloodRate();
+        }
+        LOG(INFO) << "Reloaded kvstore filters and flood rate";
+        p.setValue();
+      });
+  return sf;
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::PeersMap>>
 KvStore::getKvStorePeers(std::string area) {
   folly::Promise<std::unique_ptr<thrift::PeersMap>> p;
@@ -877,12 +1416,20 @@ KvStoreDb::KvStoreDb(
       area_(area),
       peerSyncSock_(std::move(peersyncSock)),
       evb_(evb) {
+  // one buffer per priority class, and one for keys matching no class
+  publicationBuffers_.resize(kvParams_.keyPriorityPrefixes.size() + 1);
+
   if (kvParams_.floodRate) {
+    floodRate_ = kvParams_.floodRate->flood_msg_per_sec;
+    adaptiveFloodRate_ = kvParams_.floodRate->adaptive_ref().value_or(false);
     floodLimiter_ = std::make_unique<folly::BasicTokenBucket<>>(
         kvParams_.floodRate->flood_msg_per_sec,
         kvParams_.floodRate->flood_msg_burst_size);
     pendingPublicationTimer_ =
         folly::AsyncTimeout::make(*evb_->getEvb(), [this]() noexcept {
+          if (adaptiveFloodRate_) {
+            adjustFloodRate();
+          }
           if (!floodLimiter_->consume(1)) {
             pendingPublicationTimer_->scheduleTimeout(
                 Constants::kFloodPendingPublication);
@@ -921,50 +1468,150 @@ KvStoreDb::KvStoreDb(
   fb303::fbData->addStatExportType("kvstore.flood_duration_ms", fb303::AVG);
   fb303::fbData->addStatExportType("kvstore.full_sync_duration_ms", fb303::AVG);
   fb303::fbData->addStatExportType("kvstore.looped_publications", fb303::COUNT);
-  fb303::fbData->addStatExportType("kvstore.peers.bytes_received", fb303::SUM);
-  fb303::fbData->addStatExportType("kvstore.peers.bytes_received", fb303::SUM);
-  fb303::fbData->addStatExportType("kvstore.peers.bytes_sent", fb303::SUM);
-  fb303::fbData->addStatExportType("kvstore.peers.bytes_sent", fb303::SUM);
   fb303::fbData->addStatExportType("kvstore.rate_limit_keys", fb303::AVG);
   fb303::fbData->addStatExportType("kvstore.rate_limit_suppress", fb303::COUNT);
   fb303::fbData->addStatExportType(
       "kvstore.received_dual_messages", fb303::COUNT);
-  fb303::fbData->addStatExportType("kvstore.received_key_vals", fb303::SUM);
-  fb303::fbData->addStatExportType(
-      "kvstore.received_publications", fb303::COUNT);
   fb303::fbData->addStatExportType(
       "kvstore.received_redundant_publications", fb303::COUNT);
-  fb303::fbData->addStatExportType("kvstore.sent_key_vals", fb303::SUM);
-  fb303::fbData->addStatExportType("kvstore.sent_publications", fb303::COUNT);
+  fb303::fbData->addStatExportType("kvstore.sent_dual_messages", fb303::SUM);
+  fb303::fbData->addStatExportType("kvstore.sent_dual_packets", fb303::COUNT);
   fb303::fbData->addStatExportType("kvstore.updated_key_vals", fb303::SUM);
+
+  // Start from snapshot of previous run, and save snapshots periodically
+  if (not kvParams_.snapshotFilePath.empty()) {
+    loadSnapshot();
+    snapshotTimer_ =
+        folly::AsyncTimeout::make(*evb_->getEvb(), [this]() noexcept {
+          saveSnapshot();
+          snapshotTimer_->scheduleTimeout(kvParams_.snapshotInterval);
+        });
+    snapshotTimer_->scheduleTimeout(kvParams_.snapshotInterval);
+  }
+}
+
+std::string
+KvStoreDb::getSnapshotFilePath() const {
+  return folly::sformat("{}.{}", kvParams_.snapshotFilePath, area_);
+}
+
+bool
+KvStoreDb::saveSnapshot() noexcept {
+  // Take TTLs remaining as of now
+  thrift::Publication thriftPub;
+  thriftPub.keyVals = kvStore_;
+  updatePublicationTtl(thriftPub);
+
+  thrift::KvStoreSnapshot snapshot;
+  snapshot.keyVals = std::move(thriftPub.keyVals);
+  snapshot.timestampMs = getUnixTimeStampMs();
+
+  const auto filePath = getSnapshotFilePath();
+  try {
+    const auto data = fbzmq::util::writeThriftObjStr(snapshot, serializer_);
+    folly::writeFileAtomic(filePath, data, 0666);
+  } catch (std::exception const& e) {
+    LOG(ERROR) << "Failed to save kvstore snapshot to '" << filePath
+               << "'. Error: " << folly::exceptionStr(e);
+    return false;
+  }
+  VLOG(2) << "Saved " << snapshot.keyVals.size()
+          << " keys of kvstore snapshot to '" << filePath << "'";
+  return true;
+}
+
+void
+KvStoreDb::loadSnapshot() noexcept {
+  const auto filePath = getSnapshotFilePath();
+  std::string data;
+  if (not folly::readFile(filePath.c_str(), data)) {
+    LOG(INFO) << "No kvstore snapshot at '" << filePath
+              << "'. Starting with empty kvstore";
+    return;
+  }
+
+  thrift::KvStoreSnapshot snapshot;
+  try {
+    snapshot = fbzmq::util::readThriftObjStr<thrift::KvStoreSnapshot>(
+        data, serializer_);
+  } catch (std::exception const& e) {
+    LOG(ERROR) << "Failed to load kvstore snapshot from '" << filePath
+               << "'. Error: " << folly::exceptionStr(e);
+    return;
+  }
+
+  // Count down TTLs by time spent since snapshot, dropping expired keys
+  const auto elapsed =
+      std::max(getUnixTimeStampMs() - snapshot.timestampMs, int64_t(0));
+  thrift::Publication thriftPub;
+  thriftPub.area = area_;
+  for (auto& kv : snapshot.keyVals) {
+    auto& value = kv.second;
+    if (value.ttl != Constants::kTtlInfinity) {
+      value.ttl -= elapsed;
+      if (value.ttl <= kvParams_.ttlDecr.count()) {
+        continue;
+      }
+    }
+    thriftPub.keyVals.emplace(kv.first, std::move(value));
+  }
+
+  LOG(INFO) << "Loaded " << thriftPub.keyVals.size() << " of "
+            << snapshot.keyVals.size() << " keys from kvstore snapshot '"
+            << filePath << "' taken " << elapsed << "ms ago";
+  // Merge as any publication, this also publishes keys to local readers.
+  // Full-sync with peers later reconciles differences only
+  mergePublication(std::move(thriftPub));
 }
 
 void
 KvStoreDb::updateTtlCountdownQueue(const thrift::Publication& publication) {
+  if (publication.keyVals.empty()) {
+    return;
+  }
+
   for (const auto& kv : publication.keyVals) {
     const auto& key = kv.first;
     const auto& value = kv.second;
 
-    if (value.ttl != Constants::kTtlInfinity) {
-      TtlCountdownQueueEntry queueEntry;
-      queueEntry.expiryTime = std::chrono::steady_clock::now() +
-          std::chrono::milliseconds(value.ttl);
-      queueEntry.key = key;
-      queueEntry.version = value.version;
-      queueEntry.ttlVersion = value.ttlVersion;
-      queueEntry.originatorId = value.originatorId;
-
-      if ((ttlCountdownQueue_.empty() or
-           (queueEntry.expiryTime <= ttlCountdownQueue_.top().expiryTime)) and
-          ttlCountdownTimer_) {
-        // Reschedule the shorter timeout
-        ttlCountdownTimer_->scheduleTimeout(
-            std::chrono::milliseconds(value.ttl));
-      }
-
-      ttlCountdownQueue_.push(std::move(queueEntry));
+    if (value.ttl == Constants::kTtlInfinity) {
+      // key doesn't expire anymore
+      ttlCountdownWheel_.erase(key);
+      continue;
     }
+
+    // Refresh in place, previous expiry of key is replaced
+    TtlCountdownQueueEntry queueEntry;
+    queueEntry.expiryTime = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(value.ttl);
+    queueEntry.key = key;
+    queueEntry.version = value.version;
+    queueEntry.ttlVersion = value.ttlVersion;
+    queueEntry.originatorId = value.originatorId;
+    ttlCountdownWheel_.upsert(std::move(queueEntry));
   }
+  scheduleTtlCountdownTimer();
+}
+
+void
+KvStoreDb::scheduleTtlCountdownTimer() {
+  if (not ttlCountdownTimer_) {
+    return;
+  }
+  const auto nextEventTime = ttlCountdownWheel_.getNextEventTime();
+  if (not nextEventTime.has_value()) {
+    ttlCountdownTimer_->cancelTimeout();
+    return;
+  }
+  // Keys expiring shortly after last pass wait for the next one, together
+  // with all other keys expiring meanwhile
+  const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(
+      std::max(
+          *nextEventTime,
+          lastTtlExpiryTime_ + Constants::kKvStoreTtlExpiryBatchWindow) -
+      std::chrono::steady_clock::now());
+  ttlCountdownTimer_->scheduleTimeout(
+      std::max(timeout, std::chrono::milliseconds(0)));
 }
 
 // build publication out of the requested keys (per request)
@@ -985,6 +1632,39 @@ KvStoreDb::getKeyVals(std::vector<std::string> const& keys) {
   return thriftPub;
 }
 
+template <typename Fn>
+void
+KvStoreDb::forEachKeyValWithFilters(
+    KvStoreFilters const& kvFilters, Fn fn) const {
+  const auto keyPrefixes = kvFilters.getLiteralKeyPrefixes();
+  if (not keyPrefixes.has_value()) {
+    for (auto const& kv : kvStore_) {
+      if (kvFilters.keyMatch(kv.first, kv.second)) {
+        fn(kv.first, kv.second);
+      }
+    }
+    return;
+  }
+
+  // Walk the range of every prefix in ordered key index. Prefixes covered by
+  // a shorter one are skipped, so that each key is visited once.
+  std::vector<std::string> sortedPrefixes = *keyPrefixes;
+  std::sort(sortedPrefixes.begin(), sortedPrefixes.end());
+  std::string const* lastPrefix{nullptr};
+  for (auto const& keyPrefix : sortedPrefixes) {
+    if (lastPrefix and
+        keyPrefix.compare(0, lastPrefix->size(), *lastPrefix) == 0) {
+      continue;
+    }
+    lastPrefix = &keyPrefix;
+    for (auto it = keyIndex_.lower_bound(keyPrefix); it != keyIndex_.end() and
+         (*it)->first.compare(0, keyPrefix.size(), keyPrefix) == 0;
+         ++it) {
+      fn((*it)->first, (*it)->second);
+    }
+  }
+}
+
 // dump the entries of my KV store whose keys match the given prefix
 // if prefix is the empty string, the full KV store is dumped
 thrift::Publication
@@ -992,12 +1672,10 @@ KvStoreDb::dumpAllWithFilters(KvStoreFilters const& kvFilters) const {
   thrift::Publication thriftPub;
   thriftPub.area = area_;
 
-  for (auto const& kv : kvStore_) {
-    if (not kvFilters.keyMatch(kv.first, kv.second)) {
-      continue;
-    }
-    thriftPub.keyVals[kv.first] = kv.second;
-  }
+  forEachKeyValWithFilters(
+      kvFilters, [&](std::string const& key, thrift::Value const& value) {
+        thriftPub.keyVals[key] = value;
+      });
   return thriftPub;
 }
 
@@ -1007,18 +1685,16 @@ thrift::Publication
 KvStoreDb::dumpHashWithFilters(KvStoreFilters const& kvFilters) const {
   thrift::Publication thriftPub;
   thriftPub.area = area_;
-  for (auto const& kv : kvStore_) {
-    if (not kvFilters.keyMatch(kv.first, kv.second)) {
-      continue;
-    }
-    DCHECK(kv.second.hash.has_value());
-    auto& value = thriftPub.keyVals[kv.first];
-    value.version = kv.second.version;
-    value.originatorId = kv.second.originatorId;
-    value.hash.copy_from(kv.second.hash);
-    value.ttl = kv.second.ttl;
-    value.ttlVersion = kv.second.ttlVersion;
-  }
+  forEachKeyValWithFilters(
+      kvFilters, [&](std::string const& key, thrift::Value const& myValue) {
+        DCHECK(myValue.hash.has_value());
+        auto& value = thriftPub.keyVals[key];
+        value.version = myValue.version;
+        value.originatorId = myValue.originatorId;
+        value.hash.copy_from(myValue.hash);
+        value.ttl = myValue.ttl;
+        value.ttlVersion = myValue.ttlVersion;
+      });
   return thriftPub;
 }
 
@@ -1073,6 +1749,132 @@ KvStoreDb::dumpDifference(
   return thriftPub;
 }
 
+// dump the entries of key buckets on which my digest differs from given one
+// thriftPub.keyVals: all my keys of mismatched buckets
+// thriftPub.keyBuckets: mismatched buckets
+// full-sync initiator compares keyVals against its own keys of these buckets
+// to find out what keys need to send back
+thrift::Publication
+KvStoreDb::dumpKeyBucketDifference(
+    KvStoreFilters const& kvFilters,
+    std::map<int32_t, int64_t> const& reqKeyBucketDigests) const {
+  thrift::Publication thriftPub;
+  thriftPub.area = area_;
+
+  // Maintained digests cover the whole store. Compute them over matching keys
+  // only if request comes with filters.
+  const bool hasFilters = not kvFilters.getKeyPrefixes().empty() or
+      not kvFilters.getOrigniatorIdList().empty();
+  auto myKeyBucketDigests = keyBucketDigests_;
+  if (hasFilters) {
+    std::fill(myKeyBucketDigests.begin(), myKeyBucketDigests.end(), 0);
+    forEachKeyValWithFilters(
+        kvFilters, [&](std::string const& key, thrift::Value const& value) {
+          myKeyBucketDigests[KvStore::getKeyBucket(key)] ^=
+              getKeyDigest(key, value);
+        });
+  }
+
+  std::vector<bool> isMismatched(myKeyBucketDigests.size(), false);
+  thriftPub.keyBuckets = std::vector<int32_t>{};
+  for (int32_t bucket = 0; bucket < Constants::kKvStoreSyncKeyBuckets;
+       ++bucket) {
+    const auto it = reqKeyBucketDigests.find(bucket);
+    const int64_t reqDigest = it != reqKeyBucketDigests.end() ? it->second : 0;
+    if (myKeyBucketDigests[bucket] != reqDigest) {
+      isMismatched[bucket] = true;
+      thriftPub.keyBuckets->emplace_back(bucket);
+    }
+  }
+  if (thriftPub.keyBuckets->empty()) {
+    return thriftPub;
+  }
+
+  forEachKeyValWithFilters(
+      kvFilters, [&](std::string const& key, thrift::Value const& value) {
+        if (isMismatched[KvStore::getKeyBucket(key)]) {
+          thriftPub.keyVals.emplace(key, value);
+        }
+      });
+  return thriftPub;
+}
+
+std::map<int32_t, int64_t>
+KvStoreDb::getKeyBucketDigests() const {
+  std::map<int32_t, int64_t> digests;
+  for (int32_t bucket = 0; bucket < Constants::kKvStoreSyncKeyBuckets;
+       ++bucket) {
+    if (keyBucketDigests_[bucket] != 0) {
+      digests.emplace(bucket, keyBucketDigests_[bucket]);
+    }
+  }
+  return digests;
+}
+
+std::vector<std::string>
+KvStoreDb::getKeyBucketDifference(
+    thrift::Publication const& syncPub,
+    std::unordered_set<std::string> const& chunkedKeys) const {
+  std::vector<std::string> keys;
+  std::vector<bool> isMismatched(
+      Constants::kKvStoreSyncKeyBuckets, not syncPub.keyBuckets.has_value());
+  if (syncPub.keyBuckets.has_value()) {
+    if (syncPub.keyBuckets->empty()) {
+      return keys;
+    }
+    for (auto const bucket : *syncPub.keyBuckets) {
+      if (bucket >= 0 and bucket < Constants::kKvStoreSyncKeyBuckets) {
+        isMismatched[bucket] = true;
+      }
+    }
+  }
+
+  for (auto const& kv : kvStore_) {
+    if (not isMismatched[KvStore::getKeyBucket(kv.first)] or
+        chunkedKeys.count(kv.first)) {
+      continue;
+    }
+    const auto it = syncPub.keyVals.find(kv.first);
+    if (it == syncPub.keyVals.end()) {
+      // not exist in peer
+      keys.emplace_back(kv.first);
+      continue;
+    }
+    int rc = KvStore::compareValues(kv.second, it->second);
+    if (rc == 1 or rc == -2) {
+      // myVal is better or unknown
+      keys.emplace_back(kv.first);
+    }
+  }
+  return keys;
+}
+
+void
+KvStoreDb::toggleKeyBucketDigest(
+    std::string const& key, thrift::Value const& value) {
+  const auto digest = getKeyDigest(key, value);
+  keyBucketDigests_[KvStore::getKeyBucket(key)] ^= digest;
+  storeDigest_ ^= digest;
+}
+
+bool
+KvStoreDb::updateOriginatorKeyCount(
+    std::string const& originatorId, bool isAdd) {
+  if (isAdd) {
+    ++originatorKeyCounts_[originatorId];
+    return false;
+  }
+  auto it = originatorKeyCounts_.find(originatorId);
+  if (it == originatorKeyCounts_.end()) {
+    return false;
+  }
+  if (--it->second) {
+    return false;
+  }
+  originatorKeyCounts_.erase(it);
+  return true;
+}
+
 // add new peers to subscribe to
 void
 KvStoreDb::addPeers(
@@ -1096,7 +1898,11 @@ KvStoreDb::addPeers(
       // add dual peers for both new-peer or update-peer event
       if (supportFloodOptimization) {
         dualPeersToAdd.emplace_back(peerName);
+        nonDualPeers_.erase(peerName);
+      } else {
+        nonDualPeers_.emplace(peerName);
       }
+      floodPeersCache_.clear();
 
       if (it != peers_.end()) {
         LOG(INFO)
@@ -1118,6 +1924,7 @@ KvStoreDb::addPeers(
           }
           // Remove any pending expected response for old socket-id
           latestSentPeerSync_.erase(it->second.second);
+          pendingSyncChunks_.erase(it->second.second);
           it->second.second = newPeerCmdId;
         } else {
           // case2. new peer came up (previsously shut down ungracefully)
@@ -1127,6 +1934,7 @@ KvStoreDb::addPeers(
         }
         // Update entry with new data
         it->second.first = newPeerSpec;
+        updateThriftFloodPeer(peerName, newPeerSpec);
       } else {
         // case3. new peer came up
         LOG(INFO)
@@ -1136,6 +1944,7 @@ KvStoreDb::addPeers(
         cmdUrlUpdated = true;
         std::tie(it, std::ignore) =
             peers_.emplace(peerName, std::make_pair(newPeerSpec, newPeerCmdId));
+        updateThriftFloodPeer(peerName, newPeerSpec);
       }
 
       if (cmdUrlUpdated) {
@@ -1192,24 +2001,178 @@ KvStoreDb::addPeers(
 folly::Expected<size_t, fbzmq::Error>
 KvStoreDb::sendMessageToPeer(
     const std::string& peerSocketId, const thrift::KvStoreRequest& request) {
-  auto msg = fbzmq::Message::fromThriftObj(request, serializer_).value();
-  fb303::fbData->addStatValue(
-      "kvstore.peers.bytes_sent", msg.size(), fb303::SUM);
+  return sendMessageToPeer(
+      peerSocketId,
+      fbzmq::Message::fromThriftObj(request, serializer_).value());
+}
+
+folly::Expected<size_t, fbzmq::Error>
+KvStoreDb::sendMessageToPeer(
+    const std::string& peerSocketId, const fbzmq::Message& msg) {
+  peerBytesSent_.add(msg.size());
   return peerSyncSock_.sendMultiple(
       fbzmq::Message::from(peerSocketId).value(), fbzmq::Message(), msg);
 }
 
-std::map<std::string, int64_t>
-KvStoreDb::getCounters() const {
-  std::map<std::string, int64_t> counters;
+std::map<std::string, int64_t>
+KvStoreDb::getCounters() const {
+  std::map<std::string, int64_t> counters;
+
+  // Add some more flat counters
+  counters["kvstore.num_keys"] = kvStore_.size();
+  // Same on all nodes of the area once in sync
+  counters[folly::sformat("kvstore.store_digest.{}", area_)] = storeDigest_;
+  counters["kvstore.num_peers"] = peers_.size();
+  if (floodLimiter_) {
+    counters[folly::sformat("kvstore.flood_rate.{}", area_)] = floodRate_;
+  }
+  // Add up pending and in-flight full sync
+  counters["kvstore.pending_full_sync"] =
+      peersToSyncWith_.size() + latestSentPeerSync_.size();
+  size_t numThriftFloodPending{0};
+  for (auto const& kv : thriftFloodPeers_) {
+    numThriftFloodPending +=
+        kv.second->numInFlight + kv.second->pendingRequests.size();
+  }
+  counters["kvstore.thrift.num_flood_peers"] = thriftFloodPeers_.size();
+  counters["kvstore.thrift.pending_flood_requests"] = numThriftFloodPending;
+  return counters;
+}
+
+void
+KvStoreDb::closeThriftFloodPeers() {
+  // Callbacks of requests in flight find their peer gone
+  thriftFloodPeers_.clear();
+}
+
+void
+KvStoreDb::updateThriftFloodPeer(
+    const std::string& peerName, const thrift::PeerSpec& peerSpec) {
+  if (not kvParams_.enableThriftFlooding or peerSpec.thriftPortUrl.empty()) {
+    thriftFloodPeers_.erase(peerName);
+    return;
+  }
+  auto it = thriftFloodPeers_.find(peerName);
+  if (it != thriftFloodPeers_.end() and
+      it->second->thriftPortUrl == peerSpec.thriftPortUrl) {
+    return;
+  }
+  const auto addrPort = parseThriftPortUrl(peerSpec.thriftPortUrl);
+  if (not addrPort.has_value()) {
+    LOG(ERROR) << "Invalid thrift port url '" << peerSpec.thriftPortUrl
+               << "' of peer " << peerName << ", flooding over ZMQ";
+    thriftFloodPeers_.erase(peerName);
+    return;
+  }
+  LOG(INFO) << "Flooding to peer " << peerName << " over thrift at "
+            << peerSpec.thriftPortUrl;
+  auto peer = std::make_shared<ThriftFloodPeer>();
+  peer->thriftPortUrl = peerSpec.thriftPortUrl;
+  peer->addr = addrPort->first;
+  peer->port = addrPort->second;
+  thriftFloodPeers_[peerName] = std::move(peer);
+}
+
+bool
+KvStoreDb::floodToPeerViaThrift(
+    const std::string& peerName,
+    std::shared_ptr<const thrift::KeySetParams> params) {
+  auto it = thriftFloodPeers_.find(peerName);
+  if (it == thriftFloodPeers_.end()) {
+    return false;
+  }
+  auto peer = it->second;
+  if (peer->pendingRequests.size() >=
+      Constants::kKvStoreThriftFloodMaxPending) {
+    // Peer doesn't keep up. Count it as failure to slow down adaptive flood
+    // rate, if enabled
+    fb303::fbData->addStatValue(
+        "kvstore.thrift.num_flood_overflows", 1, fb303::COUNT);
+    ++floodSendFailures_;
+    return false;
+  }
+  peer->pendingRequests.emplace_back(std::move(params));
+  sendThriftFloodRequests(peerName, peer);
+  return true;
+}
+
+void
+KvStoreDb::sendThriftFloodRequests(
+    const std::string& peerName, const std::shared_ptr<ThriftFloodPeer>& peer) {
+  while (peer->numInFlight < Constants::kKvStoreThriftFloodMaxInFlight and
+         not peer->pendingRequests.empty()) {
+    auto params = std::move(peer->pendingRequests.front());
+    peer->pendingRequests.pop_front();
+
+    if (not peer->client) {
+      peer->client =
+          getOpenrCtrlPlainTextClient<apache::thrift::RocketClientChannel>(
+              *evb_->getEvb(),
+              peer->addr,
+              peer->port,
+              Constants::kServiceConnTimeout,
+              Constants::kServiceProcTimeout,
+              folly::AsyncSocket::anyAddress(),
+              kvParams_.maybeIpTos);
+    }
+
+    ++peer->numInFlight;
+    fb303::fbData->addStatValue(
+        "kvstore.thrift.num_flood_requests", 1, fb303::COUNT);
+    auto* client = peer->client.get();
+    client->semifuture_setKvStoreKeyVals(*params, area_)
+        .via(evb_->getEvb())
+        .thenTry([this,
+                  peerName,
+                  client,
+                  params = std::move(params),
+                  weakPeer = std::weak_ptr<ThriftFloodPeer>(peer)](
+                     folly::Try<folly::Unit>&& result) noexcept {
+          auto peer = weakPeer.lock();
+          if (not peer) {
+            // peer is gone, along with its pending requests
+            return;
+          }
+          --peer->numInFlight;
+          if (result.hasException()) {
+            LOG(ERROR) << "Failed to flood publication to peer " << peerName
+                       << " over thrift, falling back to ZMQ. Error: "
+                       << folly::exceptionStr(result.exception());
+            fb303::fbData->addStatValue(
+                "kvstore.thrift.num_flood_failures", 1, fb303::COUNT);
+            ++floodSendFailures_;
+            // Other requests in flight on same client fail as well. Only
+            // the first of them resets the client
+            if (peer->client.get() == client) {
+              peer->client.reset();
+            }
+            floodToPeerViaZmq(peerName, *params);
+          }
+          sendThriftFloodRequests(peerName, peer);
+        });
+  }
+}
 
-  // Add some more flat counters
-  counters["kvstore.num_keys"] = kvStore_.size();
-  counters["kvstore.num_peers"] = peers_.size();
-  // Add up pending and in-flight full sync
-  counters["kvstore.pending_full_sync"] =
-      peersToSyncWith_.size() + latestSentPeerSync_.size();
-  return counters;
+void
+KvStoreDb::floodToPeerViaZmq(
+    const std::string& peerName, const thrift::KeySetParams& params) {
+  auto it = peers_.find(peerName);
+  if (it == peers_.end()) {
+    return;
+  }
+  thrift::KvStoreRequest floodRequest;
+  floodRequest.cmd = thrift::Command::KEY_SET;
+  floodRequest.keySetParams = params;
+  floodRequest.area = area_;
+  auto const& peerCmdSocketId = it->second.second;
+  auto const ret = sendMessageToPeer(peerCmdSocketId, floodRequest);
+  if (ret.hasError()) {
+    LOG(ERROR) << "Failed to flood publication to peer " << peerName
+               << " using id " << peerCmdSocketId
+               << ", error: " << ret.error();
+    collectSendFailureStats(ret.error(), peerCmdSocketId);
+    ++floodSendFailures_;
+  }
 }
 
 // delete some peers we are subscribed to
@@ -1242,6 +2205,10 @@ KvStoreDb::delPeers(std::vector<std::string> const& peers) {
     if (latestSentPeerSync_.count(peerCmdSocketId)) {
       latestSentPeerSync_.erase(peerCmdSocketId);
     }
+    pendingSyncChunks_.erase(peerCmdSocketId);
+    thriftFloodPeers_.erase(peerName);
+    nonDualPeers_.erase(peerName);
+    floodPeersCache_.clear();
     peers_.erase(it);
   }
 
@@ -1252,6 +2219,9 @@ KvStoreDb::delPeers(std::vector<std::string> const& peers) {
       DualNode::peerDown(peer);
     }
   }
+
+  // full-syncs still pending may have been with removed peers
+  maybeSignalInitialSync();
 }
 
 // Get full KEY_DUMP from peersToSyncWith_
@@ -1260,6 +2230,10 @@ KvStoreDb::requestFullSyncFromPeers() {
   // minimal timeout for next run
   auto timeout = std::chrono::milliseconds(Constants::kMaxBackoff);
 
+  // Request is the same for all peers. It is built and serialized once, on
+  // first peer due for sync
+  std::optional<fbzmq::Message> dumpMsg;
+
   // Make requests
   for (auto it = peersToSyncWith_.begin(); it != peersToSyncWith_.end();) {
     auto& peerName = it->first;
@@ -1277,27 +2251,33 @@ KvStoreDb::requestFullSyncFromPeers() {
     auto const& peerCmdSocketId = peers_.at(peerName).second;
 
     // Build request
-    thrift::KvStoreRequest dumpRequest;
-    thrift::KeyDumpParams params;
+    if (not dumpMsg.has_value()) {
+      thrift::KvStoreRequest dumpRequest;
+      thrift::KeyDumpParams params;
+
+      if (kvParams_.filters.has_value()) {
+        std::string keyPrefix =
+            folly::join(",", kvParams_.filters.value().getKeyPrefixes());
+        params.prefix = keyPrefix;
+        params.originatorIds = kvParams_.filters.value().getOrigniatorIdList();
+      }
+      // Exchange key bucket digests instead of hashes of all keys. Peer only
+      // responds with keys of mismatched buckets.
+      params.keyBucketDigests = getKeyBucketDigests();
+      // Full-sync response may be large, accept it compressed
+      params.compressions_ref() = KvStore::getSupportedCompressions();
+      // Stream large response in chunks, merged as they arrive
+      params.maxChunkKeyVals_ref() = Constants::kKvStoreSyncChunkKeyVals;
 
-    if (kvParams_.filters.has_value()) {
-      std::string keyPrefix =
-          folly::join(",", kvParams_.filters.value().getKeyPrefixes());
-      params.prefix = keyPrefix;
-      params.originatorIds = kvParams_.filters.value().getOrigniatorIdList();
+      dumpRequest.cmd = thrift::Command::KEY_DUMP;
+      dumpRequest.keyDumpParams = std::move(params);
+      dumpRequest.area = area_;
+      dumpMsg = fbzmq::Message::fromThriftObj(dumpRequest, serializer_).value();
     }
-    std::set<std::string> originator{};
-    std::vector<std::string> keyPrefixList{};
-    KvStoreFilters kvFilters{keyPrefixList, originator};
-    params.keyValHashes = std::move(dumpHashWithFilters(kvFilters).keyVals);
-
-    dumpRequest.cmd = thrift::Command::KEY_DUMP;
-    dumpRequest.keyDumpParams = params;
-    dumpRequest.area = area_;
 
     VLOG(1) << "Sending full-sync request to peer " << peerName << " using id "
             << peerCmdSocketId;
-    auto const ret = sendMessageToPeer(peerCmdSocketId, dumpRequest);
+    auto const ret = sendMessageToPeer(peerCmdSocketId, *dumpMsg);
 
     if (ret.hasError()) {
       // this could be pretty common on initial connection setup
@@ -1310,6 +2290,8 @@ KvStoreDb::requestFullSyncFromPeers() {
       ++it;
     } else {
       latestSentPeerSync_[peerCmdSocketId] = std::chrono::steady_clock::now();
+      // Drop chunks of previous response if any, it's superseded
+      pendingSyncChunks_.erase(peerCmdSocketId);
 
       // Remove the iterator
       it = peersToSyncWith_.erase(it);
@@ -1356,25 +2338,26 @@ void
 KvStoreDb::updatePublicationTtl(
     thrift::Publication& thriftPub, bool removeAboutToExpire) {
   auto timeNow = std::chrono::steady_clock::now();
-  for (const auto& qE : ttlCountdownQueue_) {
-    // Find key and ensure we are taking time from right entry from queue
-    auto kv = thriftPub.keyVals.find(qE.key);
-    if (kv == thriftPub.keyVals.end() or kv->second.version != qE.version or
-        kv->second.originatorId != qE.originatorId or
-        kv->second.ttlVersion != qE.ttlVersion) {
+  for (auto kv = thriftPub.keyVals.begin(); kv != thriftPub.keyVals.end();) {
+    // Find key and ensure we are taking time from right entry from wheel
+    auto const* qE = ttlCountdownWheel_.find(kv->first);
+    if (not qE or kv->second.version != qE->version or
+        kv->second.originatorId != qE->originatorId or
+        kv->second.ttlVersion != qE->ttlVersion) {
+      ++kv;
       continue;
     }
 
     // Compute timeLeft and do sanity check on it
-    auto timeLeft = duration_cast<milliseconds>(qE.expiryTime - timeNow);
+    auto timeLeft = duration_cast<milliseconds>(qE->expiryTime - timeNow);
     if (timeLeft <= kvParams_.ttlDecr) {
-      thriftPub.keyVals.erase(kv);
+      kv = thriftPub.keyVals.erase(kv);
       continue;
     }
 
     // filter key from publication if time left is below ttl threshold
     if (removeAboutToExpire and timeLeft < Constants::kTtlThreshold) {
-      thriftPub.keyVals.erase(kv);
+      kv = thriftPub.keyVals.erase(kv);
       continue;
     }
 
@@ -1382,6 +2365,7 @@ KvStoreDb::updatePublicationTtl(
     // deterministically whenever it is exchanged between KvStores. This will
     // avoid looping of updates between stores.
     kv->second.ttl = timeLeft.count() - kvParams_.ttlDecr.count();
+    ++kv;
   }
 }
 
@@ -1414,27 +2398,29 @@ KvStoreDb::processRequestMsgHelper(
     }
 
     auto& ketSetParamsVal = thriftReq.keySetParams.value();
+    KvStore::unpackTtlUpdates(ketSetParamsVal);
     if (ketSetParamsVal.keyVals.empty()) {
       LOG(ERROR) << "Malformed set request, ignoring";
       return folly::makeUnexpected(fbzmq::Error());
     }
 
-    // Update hash for key-values
+    // Don't trust hash of key-values from sender. It is generated on merge
+    // for the ones which make it into local KvStore
+    dropDuplicateKeyVals(ketSetParamsVal.keyVals);
     for (auto& kv : ketSetParamsVal.keyVals) {
-      auto& value = kv.second;
-      if (value.value.has_value()) {
-        value.hash =
-            generateHash(value.version, value.originatorId, value.value);
-      }
+      kv.second.hash_ref().reset();
     }
 
     // Create publication and merge it with local KvStore
     thrift::Publication rcvdPublication;
     rcvdPublication.keyVals = std::move(ketSetParamsVal.keyVals);
     rcvdPublication.nodeIds.move_from(std::move(ketSetParamsVal.nodeIds));
+    rcvdPublication.floodTimestampsMs_ref().move_from(
+        std::move(ketSetParamsVal.floodTimestampsMs_ref()));
     rcvdPublication.floodRootId.move_from(
         std::move(ketSetParamsVal.floodRootId));
-    mergePublication(rcvdPublication);
+    resolveValueDeltas(rcvdPublication);
+    mergePublication(std::move(rcvdPublication));
 
     // respond to the client
     if (ketSetParamsVal.solicitResponse) {
@@ -1469,9 +2455,14 @@ KvStoreDb::processRequestMsgHelper(
     folly::split(",", keyDumpParamsVal.prefix, keyPrefixList, true);
     const auto keyPrefixMatch =
         KvStoreFilters(keyPrefixList, keyDumpParamsVal.originatorIds);
-    auto thriftPub = dumpAllWithFilters(keyPrefixMatch);
+    thrift::Publication thriftPub;
     if (auto keyValHashes = keyDumpParamsVal.keyValHashes_ref()) {
-      thriftPub = dumpDifference(thriftPub.keyVals, *keyValHashes);
+      thriftPub = dumpDifference(
+          dumpAllWithFilters(keyPrefixMatch).keyVals, *keyValHashes);
+    } else if (auto digests = keyDumpParamsVal.keyBucketDigests_ref()) {
+      thriftPub = dumpKeyBucketDifference(keyPrefixMatch, *digests);
+    } else {
+      thriftPub = dumpAllWithFilters(keyPrefixMatch);
     }
     updatePublicationTtl(thriftPub);
     // I'm the initiator, set flood-root-id
@@ -1489,6 +2480,21 @@ KvStoreDb::processRequestMsgHelper(
                 << " keyValHashes item(s). Sending " << thriftPub.keyVals.size()
                 << " key-vals and " << numMissingKeys << " missing keys";
     }
+    if (keyDumpParamsVal.keyBucketDigests_ref() and
+        keyDumpParamsVal.prefix.empty()) {
+      LOG(INFO) << "Processed full-sync request from peer " << requestId
+                << " with " << (*keyDumpParamsVal.keyBucketDigests_ref()).size()
+                << " key bucket digest(s). Sending "
+                << thriftPub.keyVals.size() << " key-vals of "
+                << thriftPub.keyBuckets_ref()->size() << " mismatched buckets";
+    }
+    if (keyDumpParamsVal.maxChunkKeyVals_ref().has_value()) {
+      sendSyncResponseChunks(requestId, keyDumpParamsVal, thriftPub);
+    }
+    if (auto compressions = keyDumpParamsVal.compressions_ref()) {
+      thriftPub =
+          KvStore::compressPublication(std::move(thriftPub), *compressions);
+    }
     return fbzmq::Message::fromThriftObj(thriftPub, serializer_);
   }
   case thrift::Command::HASH_DUMP: {
@@ -1713,8 +2719,7 @@ KvStoreDb::processNexthopChange(
 void
 KvStoreDb::processSyncResponse(
     const std::string& requestId, fbzmq::Message&& syncPubMsg) noexcept {
-  fb303::fbData->addStatValue(
-      "kvstore.peers.bytes_received", syncPubMsg.size(), fb303::SUM);
+  peerBytesReceived_.add(syncPubMsg.size());
 
   // syncPubMsg can be of two types
   // 1. ack to SET_KEY ("OK" or "ERR")
@@ -1740,15 +2745,65 @@ KvStoreDb::processSyncResponse(
     return;
   }
 
-  const auto& syncPub = maybeSyncPub.value();
-  const size_t kvUpdateCnt = mergePublication(syncPub, requestId);
+  auto& syncPub = maybeSyncPub.value();
+  if (syncPub.compressedPublication_ref().has_value()) {
+    auto maybePub = KvStore::decompressPublication(syncPub);
+    if (not maybePub.has_value()) {
+      LOG(ERROR) << "Received bad compressed response on peerSyncSock";
+      return;
+    }
+    syncPub = std::move(*maybePub);
+  }
+  if (syncPub.hasMoreChunks_ref().value_or(false)) {
+    // Merge chunk right away. Mismatched buckets are only known with last
+    // chunk, remember received keys and which of them are better here to find
+    // out keys to be sent back then.
+    auto& chunks = pendingSyncChunks_[requestId];
+    for (auto const& kv : syncPub.keyVals) {
+      chunks.keys.emplace(kv.first);
+      const auto it = kvStore_.find(kv.first);
+      if (it == kvStore_.end()) {
+        continue;
+      }
+      int rc = KvStore::compareValues(it->second, kv.second);
+      if (rc == 1 or rc == -2) {
+        chunks.tobeUpdatedKeys.emplace_back(kv.first);
+      }
+    }
+    fb303::fbData->addStatValue(
+        "kvstore.full_sync.received_chunks", 1, fb303::SUM);
+    VLOG(2) << "full-sync response chunk received from " << requestId
+            << " with " << syncPub.keyVals.size() << " key-vals";
+    chunks.kvUpdateCnt += mergeSyncPublication(syncPub, std::nullopt);
+    return;
+  }
+
+  // Last (or only) message of response
+  PendingSyncChunks chunks;
+  auto chunksIt = pendingSyncChunks_.find(requestId);
+  if (chunksIt != pendingSyncChunks_.end()) {
+    chunks = std::move(chunksIt->second);
+    pendingSyncChunks_.erase(chunksIt);
+  }
+  if (not syncPub.tobeUpdatedKeys.has_value()) {
+    // Response to key bucket digests. Find out which of my keys need to be
+    // sent back before merging
+    syncPub.tobeUpdatedKeys = getKeyBucketDifference(syncPub, chunks.keys);
+    for (auto& key : chunks.tobeUpdatedKeys) {
+      syncPub.tobeUpdatedKeys->emplace_back(std::move(key));
+    }
+  }
+
+  const size_t numKeyVals = chunks.keys.size() + syncPub.keyVals.size();
+  const size_t kvUpdateCnt =
+      chunks.kvUpdateCnt + mergeSyncPublication(syncPub, requestId);
   size_t numMissingKeys = 0;
   if (syncPub.tobeUpdatedKeys.has_value()) {
     numMissingKeys = syncPub.tobeUpdatedKeys->size();
   }
 
   LOG(INFO) << "full-sync response received from " << requestId << " with "
-            << syncPub.keyVals.size() << " key-vals and " << numMissingKeys
+            << numKeyVals << " key-vals and " << numMissingKeys
             << " missing keys. Incured " << kvUpdateCnt << " key-value updates";
 
   if (latestSentPeerSync_.count(requestId)) {
@@ -1776,6 +2831,99 @@ KvStoreDb::processSyncResponse(
   } else {
     fullSyncTimer_->cancelTimeout();
   }
+
+  hasFullSynced_ = true;
+  maybeSignalInitialSync();
+}
+
+void
+KvStoreDb::maybeSignalInitialSync() {
+  if (initialSyncSignalled_ or not hasFullSynced_ or
+      not peersToSyncWith_.empty() or not latestSentPeerSync_.empty()) {
+    return;
+  }
+  initialSyncSignalled_ = true;
+
+  LOG(INFO) << "Initial full-sync of area " << area_ << " is done with "
+            << kvStore_.size() << " keys";
+  thrift::Publication publication;
+  publication.area = area_;
+  publication.initialSyncDone_ref() = true;
+  kvParams_.kvStoreUpdatesQueue.push(std::move(publication));
+}
+
+size_t
+KvStoreDb::mergeSyncPublication(
+    thrift::Publication& syncPub, std::optional<std::string> senderId) {
+  // Merge keys of higher priority classes first, so that they reach local
+  // readers and peers ahead of bulk of the response. Last class is merged
+  // along with rest of the response.
+  std::vector<thrift::Publication> classPubs(
+      kvParams_.keyPriorityPrefixes.size());
+  for (auto it = syncPub.keyVals.begin(); it != syncPub.keyVals.end();) {
+    const auto priority = getKeyPriority(it->first);
+    if (priority == classPubs.size()) {
+      ++it;
+      continue;
+    }
+    classPubs.at(priority).keyVals.emplace(it->first, std::move(it->second));
+    it = syncPub.keyVals.erase(it);
+  }
+  size_t kvUpdateCnt{0};
+  for (auto& classPub : classPubs) {
+    if (classPub.keyVals.empty()) {
+      continue;
+    }
+    classPub.nodeIds.copy_from(syncPub.nodeIds);
+    classPub.floodRootId.copy_from(syncPub.floodRootId);
+    kvUpdateCnt += mergePublication(std::move(classPub));
+  }
+  if (senderId.has_value() or not syncPub.keyVals.empty()) {
+    kvUpdateCnt += mergePublication(std::move(syncPub), senderId);
+  }
+  return kvUpdateCnt;
+}
+
+void
+KvStoreDb::sendSyncResponseChunks(
+    std::string const& requestId,
+    thrift::KeyDumpParams const& params,
+    thrift::Publication& thriftPub) {
+  const auto maxChunkKeyVals = *params.maxChunkKeyVals_ref();
+  if (maxChunkKeyVals <= 0) {
+    return;
+  }
+
+  // Peel off chunks till the rest fits into one. Values are moved out of
+  // thriftPub, so that memory is released as chunks are sent out.
+  size_t numChunks{0};
+  while (thriftPub.keyVals.size() > static_cast<size_t>(maxChunkKeyVals)) {
+    thrift::Publication chunk;
+    chunk.area = thriftPub.area;
+    chunk.floodRootId.copy_from(thriftPub.floodRootId);
+    chunk.hasMoreChunks_ref() = true;
+    auto it = thriftPub.keyVals.begin();
+    for (int32_t i = 0; i < maxChunkKeyVals; ++i) {
+      chunk.keyVals.emplace(it->first, std::move(it->second));
+      it = thriftPub.keyVals.erase(it);
+    }
+    if (auto compressions = params.compressions_ref()) {
+      chunk = KvStore::compressPublication(std::move(chunk), *compressions);
+    }
+
+    const auto msg = fbzmq::Message::fromThriftObj(chunk, serializer_).value();
+    peerBytesSent_.add(msg.size());
+    const auto ret = kvParams_.globalCmdSock.sendMultiple(
+        fbzmq::Message::from(requestId).value(), fbzmq::Message(), msg);
+    if (ret.hasError()) {
+      // Requester finds out remaining difference on next full-sync
+      LOG(ERROR) << "Failed to send full-sync response chunk to " << requestId
+                 << ". " << ret.error();
+    }
+    ++numChunks;
+  }
+  fb303::fbData->addStatValue(
+      "kvstore.full_sync.sent_chunks", numChunks, fb303::SUM);
 }
 
 // send sync request from one neighbor randomly
@@ -1905,6 +3053,10 @@ KvStoreDb::attachCallbacks() {
   fullSyncTimer_ = folly::AsyncTimeout::make(
       *evb_->getEvb(), [this]() noexcept { requestFullSyncFromPeers(); });
 
+  // Send out dual messages coalesced across roots and events
+  dualMessagesTimer_ = folly::AsyncTimeout::make(
+      *evb_->getEvb(), [this]() noexcept { DualNode::flushDualMessages(); });
+
   // Define request sync timer
   requestSyncTimer_ = folly::AsyncTimeout::make(
       *evb_->getEvb(), [this]() noexcept { requestSync(); });
@@ -1915,17 +3067,14 @@ KvStoreDb::attachCallbacks() {
 
 void
 KvStoreDb::cleanupTtlCountdownQueue() {
-  // record all expired keys
+  // record all expired keys, and originators left without any key
   std::vector<std::string> expiredKeys;
+  std::vector<std::string> expiredOriginators;
   auto now = std::chrono::steady_clock::now();
+  lastTtlExpiryTime_ = now;
 
-  // Iterate through ttlCountdownQueue_ until the top expires in the future
-  while (not ttlCountdownQueue_.empty()) {
-    auto top = ttlCountdownQueue_.top();
-    if (top.expiryTime > now) {
-      // Nothing in queue worth evicting
-      break;
-    }
+  // Expire all due entries in batch
+  for (auto const& top : ttlCountdownWheel_.expire(now)) {
     auto it = kvStore_.find(top.key);
     if (it != kvStore_.end() and it->second.version == top.version and
         it->second.originatorId == top.originatorId and
@@ -1944,17 +3093,17 @@ KvStoreDb::cleanupTtlCountdownQueue() {
                  kvParams_.nodeId,
                  area_);
       logKvEvent("KEY_EXPIRE", top.key);
+      toggleKeyBucketDigest(it->first, it->second);
+      if (updateOriginatorKeyCount(it->second.originatorId, false)) {
+        expiredOriginators.emplace_back(it->second.originatorId);
+      }
+      keyIndex_.erase(&*it);
       kvStore_.erase(it);
     }
-    ttlCountdownQueue_.pop();
   }
 
-  // Reschedule based on most recent timeout
-  if (not ttlCountdownQueue_.empty()) {
-    ttlCountdownTimer_->scheduleTimeout(
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            ttlCountdownQueue_.top().expiryTime - now));
-  }
+  // Reschedule based on next event of wheel
+  scheduleTtlCountdownTimer();
 
   if (expiredKeys.empty()) {
     // no key expires
@@ -1964,6 +3113,12 @@ KvStoreDb::cleanupTtlCountdownQueue() {
       "kvstore.expired_key_vals", expiredKeys.size(), fb303::SUM);
   thrift::Publication expiredKeysPub{};
   expiredKeysPub.expiredKeys = std::move(expiredKeys);
+  expiredKeysPub.area = area_;
+  if (not expiredOriginators.empty()) {
+    fb303::fbData->addStatValue(
+        "kvstore.expired_originators", expiredOriginators.size(), fb303::SUM);
+    expiredKeysPub.expiredOriginators_ref() = std::move(expiredOriginators);
+  }
   floodPublication(std::move(expiredKeysPub));
 }
 
@@ -1976,26 +3131,70 @@ KvStoreDb::bufferPublication(thrift::Publication&& publication) {
   if (publication.floodRootId.has_value()) {
     floodRootId = publication.floodRootId.value();
   }
+  // Keys are buffered per priority class, so that high priority keys don't
+  // wait behind bulk updates
   // update or add keys
   for (auto const& kv : publication.keyVals) {
-    publicationBuffer_[floodRootId].emplace(kv.first);
+    publicationBuffers_.at(getKeyPriority(kv.first))[floodRootId].emplace(
+        kv.first);
   }
   for (auto const& key : publication.expiredKeys) {
-    publicationBuffer_[floodRootId].emplace(key);
+    publicationBuffers_.at(getKeyPriority(key))[floodRootId].emplace(key);
   }
 }
 
+bool
+KvStoreDb::hasBufferedUpdates() const {
+  return std::any_of(
+      publicationBuffers_.begin(),
+      publicationBuffers_.end(),
+      [](PublicationBuffer const& buffer) { return not buffer.empty(); });
+}
+
+size_t
+KvStoreDb::getKeyPriority(std::string const& key) const {
+  auto const& prefixes = kvParams_.keyPriorityPrefixes;
+  for (size_t priority = 0; priority < prefixes.size(); ++priority) {
+    if (key.compare(0, prefixes[priority].size(), prefixes[priority]) == 0) {
+      return priority;
+    }
+  }
+  return prefixes.size();
+}
+
 void
-KvStoreDb::floodBufferedUpdates() {
-  if (!publicationBuffer_.size()) {
+KvStoreDb::updateFloodRate() {
+  CHECK_EQ(kvParams_.floodRate.has_value(), floodLimiter_ != nullptr);
+  if (not floodLimiter_) {
     return;
   }
+  floodRate_ = kvParams_.floodRate->flood_msg_per_sec;
+  adaptiveFloodRate_ = kvParams_.floodRate->adaptive_ref().value_or(false);
+  floodLimiter_->reset(floodRate_, kvParams_.floodRate->flood_msg_burst_size);
+}
+
+void
+KvStoreDb::adjustFloodRate() {
+  // Multiplicative decrease of rate on failures to send to peers and additive
+  // increase while updates are pending otherwise
+  const double maxRate = kvParams_.floodRate->flood_msg_per_sec;
+  const double rateStep = maxRate / Constants::kFloodRateAdaptiveSteps;
+  if (floodSendFailures_) {
+    floodRate_ = std::max(floodRate_ / 2, rateStep);
+  } else {
+    floodRate_ = std::min(floodRate_ + rateStep, maxRate);
+  }
+  floodSendFailures_ = 0;
+  floodLimiter_->reset(floodRate_, kvParams_.floodRate->flood_msg_burst_size);
+}
 
+std::vector<thrift::Publication>
+KvStoreDb::buildBufferedPublications(PublicationBuffer& buffer) {
   // merged-publications to be sent
   std::vector<thrift::Publication> publications;
 
   // merge publication per root-id
-  for (const auto& kv : publicationBuffer_) {
+  for (const auto& kv : buffer) {
     thrift::Publication publication{};
     // convert from std::optional to std::optional
     std::optional<std::string> floodRootId{std::nullopt};
@@ -2014,7 +3213,37 @@ KvStoreDb::floodBufferedUpdates() {
     publications.emplace_back(std::move(publication));
   }
 
-  publicationBuffer_.clear();
+  buffer.clear();
+  return publications;
+}
+
+void
+KvStoreDb::floodBufferedUpdates() {
+  if (not hasBufferedUpdates()) {
+    return;
+  }
+
+  // Higher priority classes go out first. In adaptive mode every further
+  // class costs a token of its own, and remains buffered if there is none left
+  std::vector<thrift::Publication> publications;
+  for (auto& buffer : publicationBuffers_) {
+    if (buffer.empty()) {
+      continue;
+    }
+    if (adaptiveFloodRate_ and not publications.empty() and
+        not floodLimiter_->consume(1)) {
+      if (not pendingPublicationTimer_->isScheduled()) {
+        pendingPublicationTimer_->scheduleTimeout(
+            Constants::kFloodPendingPublication);
+      }
+      break;
+    }
+    auto classPublications = buildBufferedPublications(buffer);
+    std::move(
+        classPublications.begin(),
+        classPublications.end(),
+        std::back_inserter(publications));
+  }
 
   for (auto& pub : publications) {
     // when sending out merged publication, we maintain orginal-root-id
@@ -2055,7 +3284,7 @@ KvStoreDb::finalizeFullSync(
   params.timestamp_ms = getUnixTimeStampMs();
 
   updateRequest.cmd = thrift::Command::KEY_SET;
-  updateRequest.keySetParams = params;
+  updateRequest.keySetParams = std::move(params);
   updateRequest.area = area_;
 
   VLOG(1) << "sending finalizeFullSync back to " << senderId;
@@ -2068,27 +3297,36 @@ KvStoreDb::finalizeFullSync(
   }
 }
 
-std::unordered_set<std::string>
+const std::unordered_set<std::string>&
 KvStoreDb::getFloodPeers(const std::optional<std::string>& rootId) {
-  auto sptPeers = DualNode::getSptPeers(rootId);
-  bool floodToAll = false;
-  if (not kvParams_.enableFloodOptimization or sptPeers.empty()) {
-    // fall back to naive flooding if feature not enabled or can not find
-    // valid SPT-peers
-    floodToAll = true;
+  auto sptPeers = kvParams_.enableFloodOptimization
+      ? DualNode::getSptPeers(rootId)
+      : std::unordered_set<std::string>{};
+  auto it = floodPeersCache_.find(rootId);
+  if (it != floodPeersCache_.end() and it->second.sptPeers == sptPeers) {
+    return it->second.floodPeers;
   }
 
   // flood-peers: SPT-peers + peers-who-does-not-support-dual
   std::unordered_set<std::string> floodPeers;
-  for (const auto& kv : peers_) {
-    const auto& peer = kv.first;
-    const auto& peerSpec = kv.second.first;
-    if (floodToAll or sptPeers.count(peer) != 0 or
-        not peerSpec.supportFloodOptimization) {
-      floodPeers.emplace(peer);
+  if (sptPeers.empty()) {
+    // fall back to naive flooding if feature not enabled or can not find
+    // valid SPT-peers
+    for (const auto& kv : peers_) {
+      floodPeers.emplace(kv.first);
+    }
+  } else {
+    floodPeers = nonDualPeers_;
+    for (const auto& peer : sptPeers) {
+      if (peers_.count(peer)) {
+        floodPeers.emplace(peer);
+      }
     }
   }
-  return floodPeers;
+  auto& entry = floodPeersCache_[rootId];
+  entry.sptPeers = std::move(sptPeers);
+  entry.floodPeers = std::move(floodPeers);
+  return entry.floodPeers;
 }
 
 void
@@ -2100,9 +3338,56 @@ KvStoreDb::collectSendFailureStats(
       fb303::COUNT);
 }
 
+void
+KvStoreDb::addFloodDelays(
+    std::vector<std::string> const& nodeIds,
+    std::vector<int64_t> const& floodTimestamps) {
+  if (nodeIds.empty() or nodeIds.size() != floodTimestamps.size()) {
+    return;
+  }
+
+  // clocks of nodes are not in sync, delays below skew between them show as 0
+  const auto nowMs = getUnixTimeStampMs();
+  auto addDelay = [&](std::string const& key, int64_t timestampMs) {
+    if (timestampMs <= 0) {
+      return; // hop didn't stamp flood time
+    }
+    if (floodDelayHistograms_.emplace(key).second) {
+      fb303::fbData->addHistogram(
+          key,
+          Constants::kKvStoreFloodDelayBucketWidth.count(),
+          0,
+          Constants::kKvStoreFloodDelayMax.count());
+      fb303::fbData->exportHistogramPercentile(key, 50, 99, 100);
+    }
+    fb303::fbData->addHistogramValue(
+        key, std::max<int64_t>(0, nowMs - timestampMs));
+  };
+
+  // first node of compact flood path is not necessarily the originator
+  if (not kvParams_.enableCompactFloodPath or
+      nodeIds.size() < Constants::kKvStoreCompactFloodPathLen) {
+    addDelay(
+        folly::sformat("kvstore.flood_delay_ms.{}", nodeIds.front()),
+        floodTimestamps.front());
+  }
+  addDelay(
+      folly::sformat("kvstore.flood_hop_delay_ms.{}", nodeIds.back()),
+      floodTimestamps.back());
+}
+
 void
 KvStoreDb::floodPublication(
     thrift::Publication&& publication, bool rateLimit, bool setFloodRoot) {
+  // every change of kvStore_ is flooded
+  if (not publication.expiredKeys.empty() or
+      std::any_of(
+          publication.keyVals.begin(),
+          publication.keyVals.end(),
+          [](auto const& kv) { return kv.second.value_ref().has_value(); })) {
+    ++generation_;
+  }
+
   // rate limit if configured
   if (floodLimiter_ && rateLimit && !floodLimiter_->consume(1)) {
     bufferPublication(std::move(publication));
@@ -2111,7 +3396,7 @@ KvStoreDb::floodPublication(
     return;
   }
   // merge with buffered publication and flood
-  if (publicationBuffer_.size()) {
+  if (hasBufferedUpdates()) {
     bufferPublication(std::move(publication));
     return floodBufferedUpdates();
   }
@@ -2133,7 +3418,55 @@ KvStoreDb::floodPublication(
   if (not publication.nodeIds.has_value()) {
     publication.nodeIds = std::vector<std::string>{};
   }
+  auto floodTimestamps = publication.floodTimestampsMs_ref();
+  if (kvParams_.enableFloodTracing and senderId.has_value() and
+      floodTimestamps.has_value()) {
+    addFloodDelays(*publication.nodeIds, *floodTimestamps);
+  }
   publication.nodeIds->emplace_back(kvParams_.nodeId);
+  auto& nodeIds = *publication.nodeIds;
+  // Stamp flood time of this hop, earlier hops which didn't stamp theirs are
+  // left unknown. Unless every publication is traced, traces start on origin
+  // of sampled publications only
+  bool isTraced = floodTimestamps.has_value();
+  if (kvParams_.enableFloodTracing and not isTraced) {
+    isTraced = kvParams_.floodTracingSampleRate == 1 or
+        (not senderId.has_value() and
+         numOriginatedPublications_++ % kvParams_.floodTracingSampleRate ==
+             0);
+  }
+  if (kvParams_.enableFloodTracing and isTraced) {
+    if (not floodTimestamps.has_value()) {
+      floodTimestamps = std::vector<int64_t>{};
+    }
+    floodTimestamps->resize(nodeIds.size() - 1, 0);
+    floodTimestamps->emplace_back(getUnixTimeStampMs());
+  } else {
+    floodTimestamps.reset();
+  }
+  // Last hops suffice to cut short loops before merge. Longer loops end on
+  // merge as looped values are no better than the ones we hold
+  if (kvParams_.enableCompactFloodPath and
+      nodeIds.size() > Constants::kKvStoreCompactFloodPathLen) {
+    const auto numDropped =
+        nodeIds.size() - Constants::kKvStoreCompactFloodPathLen;
+    nodeIds.erase(nodeIds.begin(), nodeIds.begin() + numDropped);
+    if (floodTimestamps.has_value()) {
+      floodTimestamps->erase(
+          floodTimestamps->begin(), floodTimestamps->begin() + numDropped);
+    }
+  }
+
+  // Value deltas are for peers only. Local readers get full values
+  std::unordered_map<std::string, thrift::ValueDelta> valueDeltas;
+  if (kvParams_.enableValueDeltaEncoding) {
+    for (auto& kv : publication.keyVals) {
+      if (kv.second.delta_ref().has_value()) {
+        valueDeltas.emplace(kv.first, std::move(*kv.second.delta_ref()));
+        kv.second.delta_ref().reset();
+      }
+    }
+  }
 
   // Flood publication on local PUB queue
   kvParams_.kvStoreUpdatesQueue.push(publication);
@@ -2146,27 +3479,102 @@ KvStoreDb::floodPublication(
   }
 
   if (setFloodRoot and not senderId.has_value()) {
+    if (kvParams_.enableFloodOptimization and
+        kvParams_.enableFloodRootLoadBalancing) {
+      // I'm the initiator, spread keys over spanning trees of all roots
+      std::map<std::optional<std::string>, thrift::Publication> rootPubs;
+      for (auto& kv : publication.keyVals) {
+        auto& rootPub = rootPubs[getFloodRootId(kv.first)];
+        rootPub.keyVals.emplace(kv.first, std::move(kv.second));
+      }
+      for (auto& kv : rootPubs) {
+        auto& rootPub = kv.second;
+        rootPub.nodeIds.copy_from(publication.nodeIds);
+        rootPub.floodTimestampsMs_ref().copy_from(
+            publication.floodTimestampsMs_ref());
+        fromStdOptional(rootPub.floodRootId, kv.first);
+        sendFloodRequest(rootPub, senderId, valueDeltas);
+      }
+      return;
+    }
     // I'm the initiator, set flood-root-id
     fromStdOptional(publication.floodRootId, DualNode::getSptRootId());
   }
 
+  sendFloodRequest(publication, senderId, valueDeltas);
+}
+
+std::optional<std::string>
+KvStoreDb::getFloodRootId(const std::string& key) {
+  std::optional<std::string> floodRootId{std::nullopt};
+  size_t maxWeight{0};
+  for (const auto& kv : DualNode::getDuals()) {
+    if (not kv.second.hasValidRoute()) {
+      continue;
+    }
+    const size_t weight = folly::hash::hash_combine(kv.first, key);
+    if (not floodRootId.has_value() or weight > maxWeight) {
+      floodRootId = kv.first;
+      maxWeight = weight;
+    }
+  }
+  return floodRootId;
+}
+
+void
+KvStoreDb::sendFloodRequest(
+    thrift::Publication& publication,
+    const std::optional<std::string>& senderId,
+    std::unordered_map<std::string, thrift::ValueDelta>& valueDeltas) {
   thrift::KvStoreRequest floodRequest;
   thrift::KeySetParams params;
 
-  params.keyVals = publication.keyVals;
+  // Local readers hold their own copy by now. Values are moved into request
+  const size_t numKeyVals = publication.keyVals.size();
+  params.keyVals = std::move(publication.keyVals);
   params.solicitResponse = false;
   params.nodeIds.copy_from(publication.nodeIds);
+  params.floodTimestampsMs_ref().copy_from(
+      publication.floodTimestampsMs_ref());
   params.floodRootId.copy_from(publication.floodRootId);
   params.timestamp_ms = getUnixTimeStampMs();
 
-  floodRequest.cmd = thrift::Command::KEY_SET;
-  floodRequest.keySetParams = params;
-  floodRequest.area = area_;
+  // TTL refreshes make up most of flooding in steady state. Send them in
+  // batches per originator instead of as values
+  if (kvParams_.enableTtlUpdateBatching) {
+    fb303::fbData->addStatValue(
+        "kvstore.sent_batched_ttl_updates",
+        KvStore::packTtlUpdates(params),
+        fb303::SUM);
+  }
+
+  // Replace large values by their delta against previous version
+  size_t numValueDeltas{0};
+  for (auto& kv : valueDeltas) {
+    auto it = params.keyVals.find(kv.first);
+    if (it == params.keyVals.end()) {
+      continue;
+    }
+    it->second.value_ref().reset();
+    it->second.delta_ref() = std::move(kv.second);
+    ++numValueDeltas;
+  }
+  fb303::fbData->addStatValue(
+      "kvstore.sent_value_deltas", numValueDeltas, fb303::SUM);
 
   std::optional<std::string> floodRootId{std::nullopt};
   if (params.floodRootId.has_value()) {
     floodRootId = params.floodRootId.value();
   }
+
+  floodRequest.cmd = thrift::Command::KEY_SET;
+  floodRequest.keySetParams = std::move(params);
+  floodRequest.area = area_;
+
+  // Request is serialized once and the same message is sent to all peers.
+  // Peers flooded over thrift share the same params
+  std::optional<fbzmq::Message> floodMsg;
+  std::shared_ptr<const thrift::KeySetParams> thriftParams;
   const auto& floodPeers = getFloodPeers(floodRootId);
   for (const auto& peer : floodPeers) {
     if (senderId.has_value() && senderId.value() == peer) {
@@ -2177,20 +3585,127 @@ KvStoreDb::floodPublication(
             << (senderId.has_value() ? senderId.value() : "N/A")
             << ", to: " << peer << ", via: " << kvParams_.nodeId;
 
-    fb303::fbData->addStatValue("kvstore.sent_publications", 1, fb303::COUNT);
-    fb303::fbData->addStatValue(
-        "kvstore.sent_key_vals", publication.keyVals.size(), fb303::SUM);
+    sentPublications_.add();
+    sentKeyVals_.add(numKeyVals);
+
+    if (thriftFloodPeers_.count(peer)) {
+      if (not thriftParams) {
+        thriftParams = std::make_shared<const thrift::KeySetParams>(
+            floodRequest.keySetParams.value());
+      }
+      if (floodToPeerViaThrift(peer, thriftParams)) {
+        continue;
+      }
+    }
 
     // Send flood request
+    if (not floodMsg.has_value()) {
+      floodMsg =
+          fbzmq::Message::fromThriftObj(floodRequest, serializer_).value();
+    }
     auto const& peerCmdSocketId = peers_.at(peer).second;
-    auto const ret = sendMessageToPeer(peerCmdSocketId, floodRequest);
+    auto const ret = sendMessageToPeer(peerCmdSocketId, *floodMsg);
     if (ret.hasError()) {
       // this could be pretty common on initial connection setup
       LOG(ERROR) << "Failed to flood publication to peer " << peer
                  << " using id " << peerCmdSocketId
                  << ", error: " << ret.error();
       collectSendFailureStats(ret.error(), peerCmdSocketId);
+      ++floodSendFailures_;
+    }
+  }
+}
+
+size_t
+KvStoreDb::dropDuplicateKeyVals(
+    std::unordered_map<std::string, thrift::Value>& keyVals) const {
+  size_t numDropped{0};
+  for (auto it = keyVals.begin(); it != keyVals.end();) {
+    auto const& value = it->second;
+    auto kvStoreIt = kvStore_.find(it->first);
+    if (not value.value.has_value() or not value.hash.has_value() or
+        kvStoreIt == kvStore_.end() or
+        not kvStoreIt->second.hash.has_value()) {
+      ++it;
+      continue;
+    }
+    auto const& myValue = kvStoreIt->second;
+    if (value.version == myValue.version and
+        value.originatorId == myValue.originatorId and
+        *value.hash == *myValue.hash and
+        value.ttlVersion <= myValue.ttlVersion) {
+      it = keyVals.erase(it);
+      ++numDropped;
+    } else {
+      ++it;
+    }
+  }
+  fb303::fbData->addStatValue(
+      "kvstore.received_duplicate_key_vals", numDropped, fb303::SUM);
+  return numDropped;
+}
+
+void
+KvStoreDb::resolveValueDeltas(thrift::Publication& rcvdPublication) {
+  size_t numResolved{0};
+  size_t numUnresolved{0};
+  for (auto it = rcvdPublication.keyVals.begin();
+       it != rcvdPublication.keyVals.end();) {
+    auto& value = it->second;
+    if (not value.delta_ref().has_value()) {
+      ++it;
+      continue;
+    }
+    // Full value, if any, takes precedence
+    if (value.value.has_value()) {
+      value.delta_ref().reset();
+      ++it;
+      continue;
+    }
+
+    auto kvStoreIt = kvStore_.find(it->first);
+    if (kvStoreIt != kvStore_.end() and
+        KvStore::applyValueDelta(kvStoreIt->second, value)) {
+      ++numResolved;
+      ++it;
+      continue;
+    }
+
+    // Value can not be reconstructed. It is learned with full-sync unless I
+    // already hold same or better version
+    const bool isKnown = kvStoreIt != kvStore_.end() and
+        (kvStoreIt->second.version > value.version or
+         (kvStoreIt->second.version == value.version and
+          kvStoreIt->second.originatorId >= value.originatorId));
+    if (not isKnown) {
+      ++numUnresolved;
     }
+    it = rcvdPublication.keyVals.erase(it);
+  }
+
+  fb303::fbData->addStatValue(
+      "kvstore.received_value_deltas", numResolved, fb303::SUM);
+  if (numUnresolved == 0) {
+    return;
+  }
+  fb303::fbData->addStatValue(
+      "kvstore.unresolved_value_deltas", numUnresolved, fb303::SUM);
+
+  // Last entry of nodeIds is the peer we received publication from
+  const auto nodeIds = rcvdPublication.nodeIds_ref();
+  if (not nodeIds.has_value() or nodeIds->empty() or
+      not peers_.count(nodeIds->back())) {
+    return;
+  }
+  const auto& senderId = nodeIds->back();
+  LOG(INFO) << "Enqueuing full-sync request for peer " << senderId << " to "
+            << "learn " << numUnresolved << " values sent as delta";
+  peersToSyncWith_.emplace(
+      senderId,
+      ExponentialBackoff<std::chrono::milliseconds>(
+          Constants::kInitialBackoff, Constants::kMaxBackoff));
+  if (not fullSyncTimer_->isScheduled()) {
+    fullSyncTimer_->scheduleTimeout(std::chrono::milliseconds(0));
   }
 }
 
@@ -2198,10 +3713,25 @@ size_t
 KvStoreDb::mergePublication(
     const thrift::Publication& rcvdPublication,
     std::optional<std::string> senderId) {
+  return mergePublicationImpl(rcvdPublication, std::move(senderId), nullptr);
+}
+
+size_t
+KvStoreDb::mergePublication(
+    thrift::Publication&& rcvdPublication,
+    std::optional<std::string> senderId) {
+  return mergePublicationImpl(
+      rcvdPublication, std::move(senderId), &rcvdPublication.keyVals);
+}
+
+size_t
+KvStoreDb::mergePublicationImpl(
+    const thrift::Publication& rcvdPublication,
+    std::optional<std::string> senderId,
+    std::unordered_map<std::string, thrift::Value>* movableKeyVals) {
   // Add counters
-  fb303::fbData->addStatValue("kvstore.received_publications", 1, fb303::COUNT);
-  fb303::fbData->addStatValue(
-      "kvstore.received_key_vals", rcvdPublication.keyVals.size(), fb303::SUM);
+  receivedPublications_.add();
+  receivedKeyVals_.add(rcvdPublication.keyVals.size());
 
   const bool needFinalizeFullSync = senderId.has_value() and
       rcvdPublication.tobeUpdatedKeys.has_value() and
@@ -2221,10 +3751,55 @@ KvStoreDb::mergePublication(
     return 0;
   }
 
-  // Generate delta with local KvStore
+  // Take out digests of existing keys before merge. Merged values are added
+  // back afterwards. Retain large values being replaced, to flood their
+  // replacements as delta if enabled
+  std::unordered_map<std::string, thrift::Value> deltaBases;
+  for (auto const& kv : rcvdPublication.keyVals) {
+    auto it = kvStore_.find(kv.first);
+    if (it == kvStore_.end()) {
+      continue;
+    }
+    toggleKeyBucketDigest(it->first, it->second);
+    updateOriginatorKeyCount(it->second.originatorId, false);
+    if (kvParams_.enableValueDeltaEncoding and kv.second.value.has_value() and
+        it->second.value.has_value() and
+        it->second.value->size() >= Constants::kKvStoreValueDeltaMinSize and
+        kv.second.version > it->second.version) {
+      deltaBases.emplace(it->first, it->second);
+    }
+  }
+
+  // Generate delta with local KvStore. Values are moved into it if owned
   thrift::Publication deltaPublication;
-  deltaPublication.keyVals = KvStore::mergeKeyValues(
-      kvStore_, rcvdPublication.keyVals, kvParams_.filters);
+  deltaPublication.keyVals = movableKeyVals
+      ? KvStore::mergeKeyValues(
+            kvStore_,
+            std::move(*movableKeyVals),
+            kvParams_.filters,
+            kvParams_.mergeExecutor)
+      : KvStore::mergeKeyValues(
+            kvStore_,
+            rcvdPublication.keyVals,
+            kvParams_.filters,
+            kvParams_.mergeExecutor);
+  // New keys are always part of delta
+  for (auto& kv : deltaPublication.keyVals) {
+    keyIndex_.emplace(&*kvStore_.find(kv.first));
+    auto baseIt = deltaBases.find(kv.first);
+    if (baseIt != deltaBases.end()) {
+      if (auto delta = KvStore::createValueDelta(baseIt->second, kv.second)) {
+        kv.second.delta_ref() = std::move(*delta);
+      }
+    }
+  }
+  for (auto const& kv : rcvdPublication.keyVals) {
+    auto it = kvStore_.find(kv.first);
+    if (it != kvStore_.end()) {
+      toggleKeyBucketDigest(it->first, it->second);
+      updateOriginatorKeyCount(it->second.originatorId, true);
+    }
+  }
   deltaPublication.floodRootId.copy_from(rcvdPublication.floodRootId);
   deltaPublication.area = area_;
 
@@ -2235,6 +3810,8 @@ KvStoreDb::mergePublication(
   // Populate nodeIds and our nodeId_ to the end
   if (rcvdPublication.nodeIds.has_value()) {
     deltaPublication.nodeIds.copy_from(rcvdPublication.nodeIds);
+    deltaPublication.floodTimestampsMs_ref().copy_from(
+        rcvdPublication.floodTimestampsMs_ref());
   }
 
   // Update ttl values of keys
@@ -2288,6 +3865,17 @@ KvStoreDb::logKvEvent(const std::string& event, const std::string& key) {
   kvParams_.zmqMonitorClient->addEventLog(std::move(eventLog));
 }
 
+bool
+KvStoreDb::deferDualMessages() noexcept {
+  if (not dualMessagesTimer_) {
+    return false;
+  }
+  if (not dualMessagesTimer_->isScheduled()) {
+    dualMessagesTimer_->scheduleTimeout(std::chrono::milliseconds(0));
+  }
+  return true;
+}
+
 bool
 KvStoreDb::sendDualMessages(
     const std::string& neighbor, const thrift::DualMessages& msgs) noexcept {
@@ -2313,6 +3901,9 @@ KvStoreDb::sendDualMessages(
     collectSendFailureStats(ret.error(), neighborCmdSocketId);
     return false;
   }
+  fb303::fbData->addStatValue("kvstore.sent_dual_packets", 1, fb303::COUNT);
+  fb303::fbData->addStatValue(
+      "kvstore.sent_dual_messages", msgs.messages.size(), fb303::SUM);
   return true;
 }
 
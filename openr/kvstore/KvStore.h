@@ -7,17 +7,21 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <deque>
 #include <map>
 #include <memory>
 #include <string>
 
-#include <boost/heap/priority_queue.hpp>
 #include <boost/serialization/strong_typedef.hpp>
 #include <fbzmq/service/monitor/ZmqMonitorClient.h>
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/Executor.h>
+#include <folly/IPAddress.h>
 #include <folly/Optional.h>
 #include <folly/TokenBucket.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/futures/Future.h>
 #include <folly/io/IOBuf.h>
 #include <folly/io/async/AsyncTimeout.h>
@@ -26,36 +30,21 @@
 #include <openr/common/Constants.h>
 #include <openr/common/ExponentialBackoff.h>
 #include <openr/common/OpenrEventBase.h>
+#include <openr/common/StatCounter.h>
 #include <openr/common/Types.h>
 #include <openr/common/Util.h>
 #include <openr/config/Config.h>
 #include <openr/dual/Dual.h>
+#include <openr/kvstore/TtlCountdownWheel.h>
 #include <openr/if/gen-cpp2/Dual_types.h>
 #include <openr/if/gen-cpp2/KvStore_constants.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
 #include <openr/if/gen-cpp2/OpenrConfig_types.h>
+#include <openr/if/gen-cpp2/OpenrCtrlCppAsyncClient.h>
 #include <openr/messaging/ReplicateQueue.h>
 
 namespace openr {
 
-struct TtlCountdownQueueEntry {
-  std::chrono::steady_clock::time_point expiryTime;
-  std::string key;
-  int64_t version{0};
-  int64_t ttlVersion{0};
-  std::string originatorId;
-  bool
-  operator>(TtlCountdownQueueEntry other) const {
-    return expiryTime > other.expiryTime;
-  }
-};
-
-using TtlCountdownQueue = boost::heap::priority_queue<
-    TtlCountdownQueueEntry,
-    // Always returns smallest first
-    boost::heap::compare<std::greater<TtlCountdownQueueEntry>>,
-    boost::heap::stable<true>>;
-
 class KvStoreFilters {
  public:
   // takes the list of comma separated key prefixes to match,
@@ -67,12 +56,21 @@ class KvStoreFilters {
   // Check if key matches the filters
   bool keyMatch(std::string const& key, thrift::Value const& value) const;
 
+  // Check if key matches key prefixes alone. Useful for expired keys which
+  // carry no value to match originator IDs on.
+  bool keyPrefixMatch(std::string const& key) const;
+
   // return comma separeated string prefix
   std::vector<std::string> getKeyPrefixes() const;
 
   // return set of origninator IDs
   std::set<std::string> getOrigniatorIdList() const;
 
+  // If filters match on key prefixes alone and all of them are plain strings
+  // (no regex), return them. Such filters can be served from an ordered key
+  // index instead of testing every key.
+  std::optional<std::vector<std::string>> getLiteralKeyPrefixes() const;
+
   // print filters
   std::string str() const;
 
@@ -93,7 +91,8 @@ struct KvStoreParams {
   std::string nodeId;
 
   // Queue for publishing KvStore updates to other modules within a process
-  messaging::ReplicateQueue<thrift::Publication>& kvStoreUpdatesQueue;
+  messaging::ReplicateQueue<messaging::SharedValue<thrift::Publication>>&
+      kvStoreUpdatesQueue;
 
   // socket for remote & local commands
   fbzmq::Socket<ZMQ_ROUTER, fbzmq::ZMQ_SERVER> globalCmdSock;
@@ -112,11 +111,35 @@ struct KvStoreParams {
   std::chrono::milliseconds ttlDecr{Constants::kTtlDecrement};
   bool enableFloodOptimization{false};
   bool isFloodRoot{false};
+  // spread originated keys over spanning trees of all flood roots
+  bool enableFloodRootLoadBalancing{false};
   std::shared_ptr<fbzmq::ZmqMonitorClient> zmqMonitorClient{nullptr};
+  // executor for merging large publications in parallel, if any
+  folly::Executor* mergeExecutor{nullptr};
+  // flood TTL refreshes as KeySetParams.ttlUpdates instead of keyVals
+  bool enableTtlUpdateBatching{false};
+  // flood updates of large values as thrift::ValueDelta
+  bool enableValueDeltaEncoding{false};
+  // key prefixes of priority classes, highest priority first. Keys matching
+  // none are of lowest priority
+  std::vector<std::string> keyPriorityPrefixes;
+  // file to snapshot kvstore to and reload it from, per area. Empty if
+  // disabled
+  std::string snapshotFilePath;
+  std::chrono::seconds snapshotInterval{Constants::kKvStoreSnapshotInterval};
+  // flood over thrift to peers with thriftPortUrl
+  bool enableThriftFlooding{false};
+  // flood only last kKvStoreCompactFloodPathLen entries of nodeIds
+  bool enableCompactFloodPath{false};
+  // stamp floodTimestampsMs along with nodeIds, starting a trace on one in
+  // floodTracingSampleRate publications
+  bool enableFloodTracing{false};
+  size_t floodTracingSampleRate{1};
 
   KvStoreParams(
       std::string nodeid,
-      messaging::ReplicateQueue<thrift::Publication>& kvStoreUpdatesQueue,
+      messaging::ReplicateQueue<messaging::SharedValue<thrift::Publication>>&
+          kvStoreUpdatesQueue,
       fbzmq::Socket<ZMQ_ROUTER, fbzmq::ZMQ_SERVER> globalCmdSock,
       // ZMQ high water mark
       int zmqhwm,
@@ -166,6 +189,28 @@ class KvStoreDb : public DualNode {
   // Extracts the counters
   std::map<std::string, int64_t> getCounters() const;
 
+  // Close thrift flooding sessions to all peers. Must be called in event loop
+  // before it stops, as thrift clients are bound to it
+  void closeThriftFloodPeers();
+
+  // Apply flood rate of shared params, changed by config reload. Presence of
+  // flood rate doesn't change on reload
+  void updateFloodRate();
+
+  // Digest of all (key, value) of my KV store. Stores of the area are in sync
+  // when their digests match
+  int64_t
+  getStoreDigest() const {
+    return storeDigest_;
+  }
+
+  // Generation of my KV store, bumped on every value change or key expiry.
+  // TTL refreshes don't count. Can be read from any thread
+  int64_t
+  getGeneration() const {
+    return generation_.load();
+  }
+
   // get multiple keys at once
   thrift::Publication getKeyVals(std::vector<std::string> const& keys);
 
@@ -183,6 +228,50 @@ class KvStoreDb : public DualNode {
       std::unordered_map<std::string, thrift::Value> const& myKeyVal,
       std::unordered_map<std::string, thrift::Value> const& reqKeyVal) const;
 
+  // dump the entries of my KV store whose keys match the given filters and
+  // fall in key buckets on which my digest differs from given one. Mismatched
+  // buckets are reported in thriftPub.keyBuckets
+  thrift::Publication dumpKeyBucketDifference(
+      KvStoreFilters const& kvFilters,
+      std::map<int32_t, int64_t> const& reqKeyBucketDigests) const;
+
+  // digest of every non-empty key bucket of my KV store
+  std::map<int32_t, int64_t> getKeyBucketDigests() const;
+
+  // keys of my KV store which are better or missing in full-sync response to
+  // keyBucketDigests. If response carries no keyBuckets (peer doesn't support
+  // digests and sent out all of its keys), every bucket is considered.
+  // Keys in `chunkedKeys` were received in earlier chunks of response and are
+  // skipped
+  std::vector<std::string> getKeyBucketDifference(
+      thrift::Publication const& syncPub,
+      std::unordered_set<std::string> const& chunkedKeys = {}) const;
+
+  // add or remove (key, value) from the digest of its key bucket
+  void toggleKeyBucketDigest(
+      std::string const& key, thrift::Value const& value);
+
+  // count key of originator in or out of originatorKeyCounts_. Returns true
+  // if originator doesn't own any key anymore
+  bool updateOriginatorKeyCount(std::string const& originatorId, bool isAdd);
+
+  // invoke fn(key, value) for every entry of my KV store matching filters
+  template <typename Fn>
+  void forEachKeyValWithFilters(KvStoreFilters const& kvFilters, Fn fn) const;
+
+  // Drop received key-values I already hold, same version, originator and
+  // value hash, with no newer ttlVersion. Must be called before received
+  // hashes are dropped. Spares value comparison on merge of the copies
+  // received from every peer in densely meshed areas
+  // @return: Number of key-values dropped
+  size_t dropDuplicateKeyVals(
+      std::unordered_map<std::string, thrift::Value>& keyVals) const;
+
+  // Reconstruct values of received publication which are given as delta.
+  // Deltas whose base version I don't hold are dropped, and full-sync with
+  // sender of publication is scheduled to learn those values
+  void resolveValueDeltas(thrift::Publication& rcvdPublication);
+
   // Merge received publication with local store and publish out the delta.
   // If senderId is set, will build <key:value> map from kvStore_ and
   // rcvdPublication.tobeUpdatedKeys and send back to senderId to update it
@@ -190,6 +279,11 @@ class KvStoreDb : public DualNode {
   size_t mergePublication(
       thrift::Publication const& rcvdPublication,
       std::optional<std::string> senderId = std::nullopt);
+  // Same as above, moving received values into local KvStore instead of
+  // copying them
+  size_t mergePublication(
+      thrift::Publication&& rcvdPublication,
+      std::optional<std::string> senderId = std::nullopt);
 
   // update Time to expire filed in Publication
   // removeAboutToExpire: knob to remove keys which are about to expire
@@ -225,11 +319,21 @@ class KvStoreDb : public DualNode {
   // Private methods
   //
 
+  // Implementation of mergePublication(). Received values are moved from
+  // movableKeyVals, keyVals of rcvdPublication, if given
+  size_t mergePublicationImpl(
+      thrift::Publication const& rcvdPublication,
+      std::optional<std::string> senderId,
+      std::unordered_map<std::string, thrift::Value>* movableKeyVals);
+
   // send dual messages over syncSock
   bool sendDualMessages(
       const std::string& neighbor,
       const thrift::DualMessages& msgs) noexcept override;
 
+  // defer dual messages until end of event loop iteration
+  bool deferDualMessages() noexcept override;
+
   // send topology-set command to peer, peer will set/unset me as child
   // rootId: action will applied on given rootId
   // peerName: peer name
@@ -262,9 +366,23 @@ class KvStoreDb : public DualNode {
   // get flooding peers for a given spt-root-id
   // if rootId is none => flood to all physical peers
   // else only flood to formed SPT-peers for rootId
-  std::unordered_set<std::string> getFloodPeers(
+  // Result is cached per root, and valid until next call or peer change
+  const std::unordered_set<std::string>& getFloodPeers(
       const std::optional<std::string>& rootId);
 
+  // get flood root for a key originated by this node when load balancing
+  // over roots. Roots are picked by rendezvous hashing of key, so that only
+  // keys of a root going away move to other roots
+  // return none if no root has a valid route
+  std::optional<std::string> getFloodRootId(const std::string& key);
+
+  // send key-vals of publication to flooding peers of its flood root,
+  // except senderId. Values with delta in valueDeltas are sent as delta
+  void sendFloodRequest(
+      thrift::Publication& publication,
+      const std::optional<std::string>& senderId,
+      std::unordered_map<std::string, thrift::ValueDelta>& valueDeltas);
+
   // collect router-client send failure statistics in following form
   // "kvstore.send_failure.dst-peer-id.error-code"
   // error: fbzmq-Error
@@ -275,13 +393,16 @@ class KvStoreDb : public DualNode {
   // request full-sync (KEY_DUMP) with peersToSyncWith_
   void requestFullSyncFromPeers();
 
-  // add new query entries into ttlCountdownQueue from publication
+  // add or refresh entries of ttlCountdownWheel_ from publication
   // and Reschedule ttl expiry timer if needed
   void updateTtlCountdownQueue(const thrift::Publication& publication);
 
-  // periodically count down and purge expired keys from CountdownQueue
+  // periodically count down and purge expired keys from ttlCountdownWheel_
   void cleanupTtlCountdownQueue();
 
+  // schedule ttlCountdownTimer_ for next event of ttlCountdownWheel_
+  void scheduleTtlCountdownTimer();
+
   // Function to flood publication to neighbors
   // publication => data element to flood
   // rateLimit => if 'false', publication will not be rate limited
@@ -291,6 +412,13 @@ class KvStoreDb : public DualNode {
       bool rateLimit = true,
       bool setFloodRoot = true);
 
+  // export delays of traced publication received over nodeIds, not
+  // including this node yet: from first node of flood path, unless path
+  // was cut short, and from sender
+  void addFloodDelays(
+      std::vector<std::string> const& nodeIds,
+      std::vector<int64_t> const& floodTimestamps);
+
   // perform last step as a 3-way full-sync request
   // full-sync initiator sends back key-val to senderId (where we made
   // full-sync request to) who need to update those keys
@@ -301,12 +429,38 @@ class KvStoreDb : public DualNode {
   void processSyncResponse(
       const std::string& requestId, fbzmq::Message&& syncPubMsg) noexcept;
 
+  // merge full-sync response or chunk of it, keys of higher priority classes
+  // first. Return number of updated key-vals
+  size_t mergeSyncPublication(
+      thrift::Publication& syncPub, std::optional<std::string> senderId);
+
+  // signal initialSyncDone to local readers once a full-sync succeeded and
+  // none is pending anymore
+  void maybeSignalInitialSync();
+
+  // send out full-sync response in chunks of params.maxChunkKeyVals key-vals
+  // to requestId. Last chunk is left in thriftPub to be sent as reply
+  void sendSyncResponseChunks(
+      std::string const& requestId,
+      thrift::KeyDumpParams const& params,
+      thrift::Publication& thriftPub);
+
   // randomly request sync from one connected neighbor
   void requestSync();
 
   // this will poll the sockets listening to the requests
   void attachCallbacks();
 
+  // Save snapshot of kvStore_ to disk. Returns true on success
+  bool saveSnapshot() noexcept;
+
+  // Load snapshot from disk, if any, and merge it into kvStore_. TTLs are
+  // reduced by time elapsed since snapshot was taken
+  void loadSnapshot() noexcept;
+
+  // File holding snapshot of this area
+  std::string getSnapshotFilePath() const;
+
   // Submit full-sync event to monitor
   void logSyncEvent(
       const std::string& peerNodeName,
@@ -321,10 +475,67 @@ class KvStoreDb : public DualNode {
   // flood pending update blocked by rate limiter
   void floodBufferedUpdates(void);
 
+  // pending keys to flood publication
+  // map<flood-root-id: set<keys>>
+  using PublicationBuffer = std::unordered_map<
+      std::optional<std::string>,
+      std::unordered_set<std::string>>;
+
+  // build publications out of pending keys, one per flood-root-id, and clear
+  // the buffer
+  std::vector<thrift::Publication> buildBufferedPublications(
+      PublicationBuffer& buffer);
+
+  // tune rate of floodLimiter_ based on peer send failures since last call
+  void adjustFloodRate();
+
+  // whether any of publicationBuffers_ holds pending keys
+  bool hasBufferedUpdates() const;
+
+  // priority class of key, index of its buffer in publicationBuffers_
+  size_t getKeyPriority(std::string const& key) const;
+
   // Send message via socket
   folly::Expected<size_t, fbzmq::Error> sendMessageToPeer(
       const std::string& peerSocketId, const thrift::KvStoreRequest& request);
 
+  // Send already serialized request. Message buffer is shared, not copied,
+  // when the same message is sent to multiple peers
+  folly::Expected<size_t, fbzmq::Error> sendMessageToPeer(
+      const std::string& peerSocketId, const fbzmq::Message& msg);
+
+  // Thrift session to a peer for flooding over its OpenrCtrl port. Client is
+  // created on first use and again after a failure. Requests beyond in-flight
+  // window wait in pendingRequests, their params shared among peers
+  struct ThriftFloodPeer {
+    std::string thriftPortUrl;
+    folly::IPAddress addr;
+    int32_t port{0};
+    std::unique_ptr<thrift::OpenrCtrlCppAsyncClient> client;
+    size_t numInFlight{0};
+    std::deque<std::shared_ptr<const thrift::KeySetParams>> pendingRequests;
+  };
+
+  // create, replace or remove thrift flooding session of peer on its
+  // (re-)addition, as per its thriftPortUrl
+  void updateThriftFloodPeer(
+      const std::string& peerName, const thrift::PeerSpec& peerSpec);
+
+  // Queue flood request to peer over thrift. Return false if peer has no
+  // thrift session or too many pending requests, for caller to use ZMQ
+  bool floodToPeerViaThrift(
+      const std::string& peerName,
+      std::shared_ptr<const thrift::KeySetParams> params);
+
+  // send pending requests of peer while in-flight window allows
+  void sendThriftFloodRequests(
+      const std::string& peerName,
+      const std::shared_ptr<ThriftFloodPeer>& peer);
+
+  // flood request to peer over ZMQ, as fallback of thrift flooding
+  void floodToPeerViaZmq(
+      const std::string& peerName, const thrift::KeySetParams& params);
+
   //
   // Private variables
   //
@@ -346,6 +557,23 @@ class KvStoreDb : public DualNode {
       std::pair<thrift::PeerSpec, std::string /* socket-id */>>
       peers_;
 
+  // peers not supporting flood optimization, flooded to on every root
+  std::unordered_set<std::string> nonDualPeers_;
+
+  // flood peers per flood root, along with the SPT peers they were built
+  // from. Cleared on peer changes, and entry rebuilt once SPT peers of root
+  // change. Saves a pass over all peers per flooded publication
+  struct FloodPeers {
+    std::unordered_set<std::string> sptPeers;
+    std::unordered_set<std::string> floodPeers;
+  };
+  std::unordered_map<std::optional<std::string>, FloodPeers> floodPeersCache_;
+
+  // thrift flooding sessions of peers with thriftPortUrl, if thrift flooding
+  // is enabled. Callbacks of requests in flight hold weak references
+  std::unordered_map<std::string, std::shared_ptr<ThriftFloodPeer>>
+      thriftFloodPeers_;
+
   // set of peers to perform full sync from. We use exponential backoff to try
   // repetitively untill we succeeed (without overwhelming anyone with too
   // many requests).
@@ -355,18 +583,73 @@ class KvStoreDb : public DualNode {
   // Callback timer to get full KEY_DUMP from peersToSyncWith_
   std::unique_ptr<folly::AsyncTimeout> fullSyncTimer_;
 
+  // Timer to send out dual messages coalesced within event loop iteration
+  std::unique_ptr<folly::AsyncTimeout> dualMessagesTimer_;
+
   // the serializer/deserializer helper we'll be using
   apache::thrift::CompactSerializer serializer_;
 
+  // stats updated per message and publication
+  StatCounter peerBytesReceived_{
+      "kvstore.peers.bytes_received", facebook::fb303::SUM};
+  StatCounter peerBytesSent_{"kvstore.peers.bytes_sent", facebook::fb303::SUM};
+  StatCounter receivedPublications_{
+      "kvstore.received_publications", facebook::fb303::COUNT};
+  StatCounter receivedKeyVals_{
+      "kvstore.received_key_vals", facebook::fb303::SUM};
+  StatCounter sentPublications_{
+      "kvstore.sent_publications", facebook::fb303::COUNT};
+  StatCounter sentKeyVals_{"kvstore.sent_key_vals", facebook::fb303::SUM};
+
   // store keys mapped to (version, originatoId, value)
   std::unordered_map<std::string, thrift::Value> kvStore_;
 
-  // TTL count down queue
-  TtlCountdownQueue ttlCountdownQueue_;
+  // ordered index of entries of kvStore_ by key, for serving key prefix
+  // dumps in O(matches) instead of O(store). Points into kvStore_, whose
+  // entries don't move on rehash, instead of holding another copy of keys
+  using KvStoreEntry = std::pair<const std::string, thrift::Value>;
+  struct KeyIndexLess {
+    using is_transparent = void;
+    bool
+    operator()(KvStoreEntry const* lhs, KvStoreEntry const* rhs) const {
+      return lhs->first < rhs->first;
+    }
+    bool
+    operator()(KvStoreEntry const* lhs, std::string const& rhs) const {
+      return lhs->first < rhs;
+    }
+    bool
+    operator()(std::string const& lhs, KvStoreEntry const* rhs) const {
+      return lhs < rhs->first;
+    }
+  };
+  std::set<KvStoreEntry const*, KeyIndexLess> keyIndex_;
+
+  // XOR of (key, value) digests of kvStore_ per key bucket. Exchanged in
+  // full-sync so that only mismatched buckets need to be sent over
+  std::vector<int64_t> keyBucketDigests_ =
+      std::vector<int64_t>(Constants::kKvStoreSyncKeyBuckets, 0);
+
+  // XOR of all key bucket digests, maintained along with them
+  int64_t storeDigest_{0};
+
+  // see getGeneration()
+  std::atomic<int64_t> generation_{0};
+
+  // TTL count down of keys with finite TTL, one entry per key
+  TtlCountdownWheel ttlCountdownWheel_;
 
   // TTL count down timer
   std::unique_ptr<folly::AsyncTimeout> ttlCountdownTimer_;
 
+  // time of last key expiry pass, next one is held back by
+  // Constants::kKvStoreTtlExpiryBatchWindow to batch expiry of keys
+  std::chrono::steady_clock::time_point lastTtlExpiryTime_;
+
+  // number of keys of kvStore_ per originator, to tell when all keys of an
+  // originator expired
+  std::unordered_map<std::string, size_t> originatorKeyCounts_;
+
   // Map of latest peer sync up request send to each peer
   // this is used to measure full-dump sync time between this node and each of
   // its peers
@@ -375,6 +658,27 @@ class KvStoreDb : public DualNode {
       std::chrono::time_point<std::chrono::steady_clock>>
       latestSentPeerSync_;
 
+  // whether any full-sync with a peer succeeded, and whether completion of
+  // initial full-syncs was signalled to local readers
+  bool hasFullSynced_{false};
+  bool initialSyncSignalled_{false};
+
+  // publications originated so far, for sampling of flood traces
+  size_t numOriginatedPublications_{0};
+
+  // flood delay histograms registered so far
+  std::unordered_set<std::string> floodDelayHistograms_;
+
+  // Full-sync responses being received in chunks, keyed by peer socket id
+  struct PendingSyncChunks {
+    // keys received so far
+    std::unordered_set<std::string> keys;
+    // received keys for which my value is better
+    std::vector<std::string> tobeUpdatedKeys;
+    size_t kvUpdateCnt{0};
+  };
+  std::unordered_map<std::string, PendingSyncChunks> pendingSyncChunks_;
+
   // Kvstore rate limiter
   std::unique_ptr<folly::BasicTokenBucket<>> floodLimiter_{nullptr};
 
@@ -384,11 +688,18 @@ class KvStoreDb : public DualNode {
   // timer for requesting full-sync
   std::unique_ptr<folly::AsyncTimeout> requestSyncTimer_{nullptr};
 
-  // pending keys to flood publication
-  // map<flood-root-id: set<keys>>
-  std::
-      unordered_map<std::optional<std::string>, std::unordered_set<std::string>>
-          publicationBuffer_{};
+  // timer for saving snapshot of kvStore_ to disk
+  std::unique_ptr<folly::AsyncTimeout> snapshotTimer_{nullptr};
+
+  // pending keys to flood publication, per priority class of keys. Higher
+  // priority classes are flooded first
+  std::vector<PublicationBuffer> publicationBuffers_{};
+
+  // adaptive flood rate: current rate of floodLimiter_, and failures to flood
+  // to peers since rate was last adjusted
+  bool adaptiveFloodRate_{false};
+  double floodRate_{0};
+  size_t floodSendFailures_{0};
 
   // max parallel syncs allowed. It's initialized with '2' and doubles
   // up to a max value of kMaxFullSyncPendingCountThresholdfor each full sync
@@ -412,7 +723,8 @@ class KvStore final : public OpenrEventBase {
       // the zmq context to use for IO
       fbzmq::Context& zmqContext,
       // Queue for publishing kvstore updates
-      messaging::ReplicateQueue<thrift::Publication>& kvStoreUpdatesQueue,
+      messaging::ReplicateQueue<messaging::SharedValue<thrift::Publication>>&
+          kvStoreUpdatesQueue,
       // Queue for receiving peer updates
       messaging::RQueue<thrift::PeerUpdateRequest> peerUpdateQueue,
       // the url to receive command from peer instances
@@ -431,10 +743,23 @@ class KvStore final : public OpenrEventBase {
   // process the key-values publication, and attempt to
   // merge it in existing map (first argument)
   // Return a publication made out of the updated values
+  // If executor is given, large publications are compared against existing
+  // map in parallel on it, in chunks of kKvStoreMergeChunkSize keys. Updates
+  // are then applied serially. Call blocks the calling thread, i.e. kvstore
+  // event base, until merge is complete, for roughly size of update divided
+  // by number of executor threads plus one
   static std::unordered_map<std::string, thrift::Value> mergeKeyValues(
       std::unordered_map<std::string, thrift::Value>& kvStore,
       std::unordered_map<std::string, thrift::Value> const& update,
-      std::optional<KvStoreFilters> const& filters = std::nullopt);
+      std::optional<KvStoreFilters> const& filters = std::nullopt,
+      folly::Executor* executor = nullptr);
+  // Same as above, moving values of update into kvStore instead of copying
+  // them. Values of update are left unspecified, its keys are retained
+  static std::unordered_map<std::string, thrift::Value> mergeKeyValues(
+      std::unordered_map<std::string, thrift::Value>& kvStore,
+      std::unordered_map<std::string, thrift::Value>&& update,
+      std::optional<KvStoreFilters> const& filters = std::nullopt,
+      folly::Executor* executor = nullptr);
 
   // compare two thrift::Values to figure out which value is better to
   // use, it will compare following attributes in order
@@ -446,9 +771,64 @@ class KvStore final : public OpenrEventBase {
   // unknown can happen if value is missing (only hash is provided)
   static int compareValues(const thrift::Value& v1, const thrift::Value& v2);
 
+  // key bucket of key, digests of which are exchanged in full-sync
+  static int32_t getKeyBucket(std::string const& key);
+
+  // Merge publication `update` into the earlier, not yet consumed,
+  // publication `pending`, preserving the net effect for local readers.
+  // Return false if publications belong to different areas.
+  static bool coalescePublication(
+      thrift::Publication& pending, thrift::Publication const& update);
+
+  // Move TTL refreshes (values without value) out of keyVals into ttlUpdates,
+  // batched per originator. Return number of moved refreshes
+  static size_t packTtlUpdates(thrift::KeySetParams& params);
+
+  // Reverse of packTtlUpdates(). Expand ttlUpdates into keyVals without
+  // value, so that they are merged like any other TTL refresh
+  static void unpackTtlUpdates(thrift::KeySetParams& params);
+
+  // Delta of value of `update` against value of `base`, earlier version of
+  // the same key and originator. Return none if delta is not considerably
+  // smaller than value itself
+  static std::optional<thrift::ValueDelta> createValueDelta(
+      thrift::Value const& base, thrift::Value const& update);
+
+  // Reconstruct value of `update` from its delta against `base`. Return false
+  // if `base` is not the value delta was created against
+  static bool applyValueDelta(thrift::Value const& base, thrift::Value& update);
+
+  // Compressions supported here, in order of preference
+  static std::vector<thrift::CompressionType> getSupportedCompressions();
+
+  // Compress full-sync response with the first of `compressions` supported
+  // here. Publication is returned as is if it is small or none of
+  // `compressions` is supported
+  static thrift::Publication compressPublication(
+      thrift::Publication&& publication,
+      std::vector<thrift::CompressionType> const& compressions);
+
+  // Reverse of compressPublication(). Return none if publication can't be
+  // decompressed
+  static std::optional<thrift::Publication> decompressPublication(
+      thrift::Publication const& publication);
+
+  // Reader options bounding local publication readers. Overflowing
+  // publications are coalesced with coalescePublication()
+  static messaging::ReaderOptions<messaging::SharedValue<thrift::Publication>>
+  getKvStoreUpdatesReaderOptions();
+
+  // Close thrift flooding sessions in event loop before stopping it
+  void stop() override;
+
   // Public APIs
   folly::SemiFuture<std::unique_ptr<thrift::AreasConfig>> getAreasConfig();
 
+  // Apply key filters and flood rate of reloaded config. New filters apply to
+  // keys merged from now on and are advertised with next full sync
+  folly::SemiFuture<folly::Unit> reloadConfig(
+      std::shared_ptr<const Config> config);
+
   folly::SemiFuture<std::unique_ptr<thrift::Publication>> getKvStoreKeyVals(
       thrift::KeyGetParams keyGetParams,
       std::string area = openr::thrift::KvStore_constants::kDefaultArea());
@@ -489,8 +869,17 @@ class KvStore final : public OpenrEventBase {
 
   folly::SemiFuture<std::map<std::string, int64_t>> getCounters();
 
-  // API to get reader for kvStoreUpdatesQueue
-  messaging::RQueue<thrift::Publication> getKvStoreUpdatesReader();
+  // Generation of KvStore of area, see KvStoreDb::getGeneration(). Doesn't
+  // hop into event-base. Returns none for unknown area.
+  std::optional<int64_t> getKvStoreGeneration(
+      std::string const& area =
+          openr::thrift::KvStore_constants::kDefaultArea()) const;
+
+  // API to get reader for kvStoreUpdatesQueue. All readers share the same
+  // immutable publication, read keys in place instead of copying it. Values
+  // stay serialized until a reader decodes the ones it is interested in
+  messaging::RQueue<messaging::SharedValue<thrift::Publication>>
+  getKvStoreUpdatesReader();
 
  private:
   // disable copying
@@ -527,6 +916,9 @@ class KvStore final : public OpenrEventBase {
   // client to interact with monitor
   std::shared_ptr<fbzmq::ZmqMonitorClient> zmqMonitorClient_;
 
+  // thread pool for merging large publications, if configured
+  std::unique_ptr<folly::CPUThreadPoolExecutor> mergeExecutor_;
+
   // kvstore parameters common to all kvstoreDB
   KvStoreParams kvParams_;
 
@@ -536,6 +928,11 @@ class KvStore final : public OpenrEventBase {
   // the serializer/deserializer helper we'll be using
   apache::thrift::CompactSerializer serializer_;
 
+  // stats updated per request
+  StatCounter peerBytesReceived_{
+      "kvstore.peers.bytes_received", facebook::fb303::SUM};
+  StatCounter peerBytesSent_{"kvstore.peers.bytes_sent", facebook::fb303::SUM};
+
   // list of areas
   std::unordered_set<std::string> areas_{};
 };
@@ -42,7 +42,7 @@ KvStoreClientInternal::KvStoreClientInternal(
         LOG(INFO) << "Terminating KvStore updates processing fiber";
         break;
       }
-      processPublication(maybePublication.value());
+      processPublication(*maybePublication.value());
     }
   });
 
@@ -161,9 +161,69 @@ KvStoreClientInternal::persistKey(
     std::string const& area /* = thrift::KvStore_constants::kDefaultArea()*/) {
   VLOG(3) << "KvStoreClientInternal: persistKey called for key:" << key
           << " area:" << area;
+  return persistKeys({{key, value}}, ttl, area);
+}
+
+bool
+KvStoreClientInternal::persistKeys(
+    std::vector<std::pair<std::string, std::string>> const& keyVals,
+    std::chrono::milliseconds const ttl /* = Constants::kTtlInfInterval */,
+    std::string const& area /* = thrift::KvStore_constants::kDefaultArea()*/) {
+  VLOG(3) << "KvStoreClientInternal: persistKeys called for "
+          << keyVals.size() << " keys, area:" << area;
+
+  // Keys not persisted before need their latest value from KvStore. Fetch all
+  // of them at once
+  const auto& persistedKeyVals = persistedKeyVals_[area];
+  thrift::KeyGetParams params;
+  for (auto const& kv : keyVals) {
+    if (not persistedKeyVals.count(kv.first)) {
+      params.keys.emplace_back(kv.first);
+    }
+  }
+  thrift::Publication pub;
+  if (not params.keys.empty()) {
+    try {
+      pub = *(kvStore_->getKvStoreKeyVals(params, area).get());
+    } catch (const std::exception& ex) {
+      LOG(ERROR) << "Failed to get keyvals from kvstore. Exception: "
+                 << ex.what();
+    }
+  }
+
+  bool changed = false;
+  for (auto const& kv : keyVals) {
+    auto storeIt = pub.keyVals.find(kv.first);
+    changed |= persistKeyHelper(
+        kv.first,
+        kv.second,
+        ttl,
+        area,
+        storeIt != pub.keyVals.end()
+            ? std::make_optional<thrift::Value>(storeIt->second)
+            : std::nullopt);
+  }
+  if (not changed) {
+    return false;
+  }
 
+  // Best effort to advertise pending keys
+  advertisePendingKeys();
+
+  advertiseTtlUpdates();
+
+  return true;
+}
+
+bool
+KvStoreClientInternal::persistKeyHelper(
+    std::string const& key,
+    std::string const& value,
+    std::chrono::milliseconds const ttl,
+    std::string const& area,
+    std::optional<thrift::Value> const& storeValue) {
   auto& persistedKeyVals = persistedKeyVals_[area];
-  const auto& keyTtlBackoffs = keyTtlBackoffs_[area];
+  const auto& keyTtlUpdates = keyTtlUpdates_[area];
   auto& keysToAdvertise = keysToAdvertise_[area];
   // Look it up in the existing
   auto keyIt = persistedKeyVals.find(key);
@@ -179,12 +239,10 @@ KvStoreClientInternal::persistKey(
   CHECK(thriftValue.value_ref());
 
   // Retrieve the existing value for the key. If key is persisted before then
-  // it is the one we have cached locally else we need to fetch it from KvStore
+  // it is the one we have cached locally else it is the latest one in KvStore
   if (keyIt == persistedKeyVals.end()) {
-    // Get latest value from KvStore
-    auto maybeValue = getKey(key, area);
-    if (maybeValue.has_value()) {
-      thriftValue = maybeValue.value();
+    if (storeValue.has_value()) {
+      thriftValue = storeValue.value();
       // TTL update pub is never saved in kvstore
       DCHECK(thriftValue.value_ref());
     }
@@ -195,9 +253,9 @@ KvStoreClientInternal::persistKey(
       // this is a no op, return early and change no state
       return false;
     }
-    auto ttlIt = keyTtlBackoffs.find(key);
-    if (ttlIt != keyTtlBackoffs.end()) {
-      thriftValue.ttlVersion = ttlIt->second.first.ttlVersion;
+    auto ttlIt = keyTtlUpdates.find(key);
+    if (ttlIt != keyTtlUpdates.end()) {
+      thriftValue.ttlVersion = ttlIt->second.value.ttlVersion;
     }
   }
 
@@ -239,9 +297,6 @@ KvStoreClientInternal::persistKey(
     keysToAdvertise.insert(key);
   }
 
-  // Best effort to advertise pending keys
-  advertisePendingKeys();
-
   scheduleTtlUpdates(
       key,
       thriftValue.version,
@@ -302,6 +357,7 @@ KvStoreClientInternal::setKey(
       ttl.count(),
       false /* advertiseImmediately */,
       area);
+  advertiseTtlUpdates();
 
   return ret;
 }
@@ -311,20 +367,31 @@ KvStoreClientInternal::setKey(
     std::string const& key,
     thrift::Value const& thriftValue,
     std::string const& area /* thrift::KvStore_constants::kDefaultArea() */) {
-  CHECK(thriftValue.value_ref());
+  return setKeys({{key, thriftValue}}, area);
+}
 
-  std::unordered_map<std::string, thrift::Value> keyVals;
-  keyVals.emplace(key, thriftValue);
+std::optional<folly::Unit>
+KvStoreClientInternal::setKeys(
+    std::unordered_map<std::string, thrift::Value> const& keyVals,
+    std::string const& area /* thrift::KvStore_constants::kDefaultArea() */) {
+  VLOG(3) << "KvStoreClientInternal: setKeys called for " << keyVals.size()
+          << " keys, area:" << area;
+  for (auto const& kv : keyVals) {
+    CHECK(kv.second.value_ref());
+  }
 
-  const auto ret = setKeysHelper(std::move(keyVals), area);
+  const auto ret = setKeysHelper(keyVals, area);
 
-  scheduleTtlUpdates(
-      key,
-      thriftValue.version,
-      thriftValue.ttlVersion,
-      thriftValue.ttl,
-      false /* advertiseImmediately */,
-      area);
+  for (auto const& kv : keyVals) {
+    scheduleTtlUpdates(
+        kv.first,
+        kv.second.version,
+        kv.second.ttlVersion,
+        kv.second.ttl,
+        false /* advertiseImmediately */,
+        area);
+  }
+  advertiseTtlUpdates();
 
   return ret;
 }
@@ -339,10 +406,10 @@ KvStoreClientInternal::scheduleTtlUpdates(
     std::string const& area /* thrift::KvStore_constants::kDefaultArea() */) {
   // infinite TTL does not need update
 
-  auto& keyTtlBackoffs = keyTtlBackoffs_[area];
+  auto& keyTtlUpdates = keyTtlUpdates_[area];
   if (ttl == Constants::kTtlInfinity) {
     // in case ttl is finite before
-    keyTtlBackoffs.erase(key);
+    keyTtlUpdates.erase(key);
     return;
   }
 
@@ -357,21 +424,44 @@ KvStoreClientInternal::scheduleTtlUpdates(
   ttlThriftValue.value_ref().reset();
   CHECK(not ttlThriftValue.value_ref().has_value());
 
-  // renew before Ttl expires about every ttl/3, i.e., try twice
-  // use ExponentialBackoff to track remaining time
-  keyTtlBackoffs[key] = std::make_pair(
-      ttlThriftValue,
-      ExponentialBackoff<std::chrono::milliseconds>(
-          std::chrono::milliseconds(ttl / 4),
-          std::chrono::milliseconds(ttl / 4 + 1)));
+  // renew before Ttl expires about every ttl/4, i.e., try thrice
+  auto& ttlUpdate = keyTtlUpdates[key];
+  ttlUpdate.value = std::move(ttlThriftValue);
+  ttlUpdate.interval =
+      std::chrono::milliseconds(std::max(ttl / 4, int64_t(1)));
 
   // Delay first ttl advertisement by (ttl / 4). We have just advertised key or
-  // update and would like to avoid sending unncessary immediate ttl update
-  if (not advertiseImmediately) {
-    keyTtlBackoffs.at(key).second.reportError();
+  // update and would like to avoid sending unncessary immediate ttl update.
+  // Otherwise schedule it in the earliest possible bucket, due already
+  scheduleTtlRefresh(
+      area,
+      key,
+      advertiseImmediately
+          ? std::chrono::steady_clock::time_point()
+          : std::chrono::steady_clock::now() + ttlUpdate.interval);
+}
+
+void
+KvStoreClientInternal::scheduleTtlRefresh(
+    std::string const& area,
+    std::string const& key,
+    std::chrono::steady_clock::time_point refreshTime) {
+  auto& ttlUpdate = keyTtlUpdates_.at(area).at(key);
+
+  // Align refresh up to end of its bucket. Buckets are narrowed for short TTLs
+  // so that refresh is never delayed beyond a quarter of interval
+  const auto width =
+      std::min(Constants::kTtlRefreshBucketWidth, ttlUpdate.interval / 4);
+  if (width.count() > 0) {
+    const auto sinceEpoch = std::chrono::ceil<std::chrono::milliseconds>(
+        refreshTime.time_since_epoch());
+    const auto remainder = sinceEpoch % width;
+    refreshTime = std::chrono::steady_clock::time_point(
+        remainder.count() ? sinceEpoch - remainder + width : sinceEpoch);
   }
 
-  advertiseTtlUpdates();
+  ttlUpdate.refreshTime = refreshTime;
+  ttlRefreshBuckets_[refreshTime].emplace_back(area, key);
 }
 
 void
@@ -383,7 +473,7 @@ KvStoreClientInternal::unsetKey(
 
   persistedKeyVals_[area].erase(key);
   backoffs_.erase(key);
-  keyTtlBackoffs_[area].erase(key);
+  keyTtlUpdates_[area].erase(key);
   keysToAdvertise_[area].erase(key);
 }
 
@@ -510,6 +600,75 @@ KvStoreClientInternal::unsubscribeKey(std::string const& key) {
   }
 }
 
+void
+KvStoreClientInternal::subscribeKeyPrefix(
+    std::string const& keyPrefix,
+    KeyCallback callback,
+    std::string const& area) {
+  VLOG(3) << "KvStoreClientInternal: subscribeKeyPrefix called for prefix "
+          << keyPrefix << " in area " << area;
+  auto* node = &keyPrefixCallbacks_[area];
+  for (char c : keyPrefix) {
+    auto& child = node->children[c];
+    if (not child) {
+      child = std::make_unique<KeyPrefixNode>();
+    }
+    node = child.get();
+  }
+  node->callback = std::move(callback);
+}
+
+void
+KvStoreClientInternal::unsubscribeKeyPrefix(
+    std::string const& keyPrefix, std::string const& area) {
+  KeyPrefixNode* node{nullptr};
+  auto areaIt = keyPrefixCallbacks_.find(area);
+  if (areaIt != keyPrefixCallbacks_.end()) {
+    node = &areaIt->second;
+    for (char c : keyPrefix) {
+      auto childIt = node->children.find(c);
+      if (childIt == node->children.end()) {
+        node = nullptr;
+        break;
+      }
+      node = childIt->second.get();
+    }
+  }
+  if (not node or not node->callback) {
+    LOG(WARNING) << "UnsubscribeKeyPrefix called for non-existing prefix "
+                 << keyPrefix << " in area " << area;
+    return;
+  }
+  node->callback = nullptr;
+}
+
+void
+KvStoreClientInternal::processKeyPrefixCallbacks(
+    std::string const& area,
+    std::string const& key,
+    std::optional<thrift::Value> const& value) {
+  auto areaIt = keyPrefixCallbacks_.find(area);
+  if (areaIt == keyPrefixCallbacks_.end()) {
+    return;
+  }
+
+  // Walk down along the key, invoking callbacks of shorter prefixes first
+  auto* node = &areaIt->second;
+  for (size_t i = 0;; ++i) {
+    if (node->callback) {
+      node->callback(key, value);
+    }
+    if (i == key.size()) {
+      break;
+    }
+    auto childIt = node->children.find(key[i]);
+    if (childIt == node->children.end()) {
+      break;
+    }
+    node = childIt->second.get();
+  }
+}
+
 void
 KvStoreClientInternal::setKvCallback(KeyCallback callback) {
   kvCallback_ = std::move(callback);
@@ -519,12 +678,19 @@ void
 KvStoreClientInternal::processExpiredKeys(
     thrift::Publication const& publication) {
   auto const& expiredKeys = publication.expiredKeys;
+  std::string area{thrift::KvStore_constants::kDefaultArea()};
+
+  if (publication.area_ref().has_value()) {
+    area = publication.area_ref().value();
+  }
 
   for (auto const& key : expiredKeys) {
     /* callback registered by the thread */
     if (kvCallback_) {
       kvCallback_(key, std::nullopt);
     }
+    /* callbacks registered for key prefix */
+    processKeyPrefixCallbacks(area, key, std::nullopt);
     /* key specific registered callback */
     auto cb = keyCallbacks_.find(key);
     if (cb != keyCallbacks_.end()) {
@@ -544,7 +710,7 @@ KvStoreClientInternal::processPublication(
   }
 
   auto& persistedKeyVals = persistedKeyVals_[area];
-  auto& keyTtlBackoffs = keyTtlBackoffs_[area];
+  auto& keyTtlUpdates = keyTtlUpdates_[area];
   auto& keysToAdvertise = keysToAdvertise_[area];
 
   for (auto const& kv : publication.keyVals) {
@@ -559,21 +725,22 @@ KvStoreClientInternal::processPublication(
     if (kvCallback_) {
       kvCallback_(key, rcvdValue);
     }
+    processKeyPrefixCallbacks(area, key, rcvdValue);
 
     // Update local keyVals as per need
     auto it = persistedKeyVals.find(key);
     auto cb = keyCallbacks_.find(key);
     // set key w/ finite TTL
-    auto sk = keyTtlBackoffs.find(key);
+    auto sk = keyTtlUpdates.find(key);
 
     // key set but not persisted
-    if (sk != keyTtlBackoffs.end() and it == persistedKeyVals.end()) {
-      auto& setValue = sk->second.first;
+    if (sk != keyTtlUpdates.end() and it == persistedKeyVals.end()) {
+      auto& setValue = sk->second.value;
       if (rcvdValue.version > setValue.version or
           (rcvdValue.version == setValue.version and
            rcvdValue.originatorId > setValue.originatorId)) {
         // key lost, cancel TTL update
-        keyTtlBackoffs.erase(sk);
+        keyTtlUpdates.erase(sk);
       } else if (
           rcvdValue.version == setValue.version and
           rcvdValue.originatorId == setValue.originatorId and
@@ -581,8 +748,8 @@ KvStoreClientInternal::processPublication(
         // If version, value and originatorId is same then we should look up
         // ttlVersion and update local value if rcvd ttlVersion is higher
         // NOTE: We don't need to advertise the value back
-        if (sk != keyTtlBackoffs.end() and
-            sk->second.first.ttlVersion < rcvdValue.ttlVersion) {
+        if (sk != keyTtlUpdates.end() and
+            sk->second.value.ttlVersion < rcvdValue.ttlVersion) {
           VLOG(1) << "Bumping TTL version for (key, version, originatorId) "
                   << folly::sformat(
                          "({}, {}, {})",
@@ -645,9 +812,9 @@ KvStoreClientInternal::processPublication(
       valueChange = true;
     }
 
-    // copy ttlVersion from ttl backoff map
-    if (sk != keyTtlBackoffs.end()) {
-      currentValue.ttlVersion = sk->second.first.ttlVersion;
+    // copy ttlVersion from ttl update map
+    if (sk != keyTtlUpdates.end()) {
+      currentValue.ttlVersion = sk->second.value.ttlVersion;
     }
 
     // update local ttlVersion if received higher ttlVersion.
@@ -655,8 +822,8 @@ KvStoreClientInternal::processPublication(
     // update to latest ttlVersion works fine
     if (currentValue.ttlVersion < rcvdValue.ttlVersion) {
       currentValue.ttlVersion = rcvdValue.ttlVersion;
-      if (sk != keyTtlBackoffs.end()) {
-        sk->second.first.ttlVersion = rcvdValue.ttlVersion;
+      if (sk != keyTtlUpdates.end()) {
+        sk->second.value.ttlVersion = rcvdValue.ttlVersion;
       }
     }
 
@@ -745,31 +912,36 @@ KvStoreClientInternal::advertisePendingKeys() {
 
 void
 KvStoreClientInternal::advertiseTtlUpdates() {
-  // Build set of keys to advertise ttl updates
-  auto timeout = Constants::kMaxTtlUpdateInterval;
-
-  // advertise TTL updates for each area
-  for (auto& keyTtlBackoffsEntry : keyTtlBackoffs_) {
-    auto& keyTtlBackoffs = keyTtlBackoffsEntry.second;
-    auto& persistedKeyVals = persistedKeyVals_[keyTtlBackoffsEntry.first];
-    auto& area = keyTtlBackoffsEntry.first;
-
-    std::unordered_map<std::string, thrift::Value> keyVals;
-
-    for (auto& kv : keyTtlBackoffs) {
-      const auto& key = kv.first;
-      auto& backoff = kv.second.second;
-      if (not backoff.canTryNow()) {
-        VLOG(2) << "Skipping key: " << key << ", area: " << area;
-        timeout = std::min(timeout, backoff.getTimeRemainingUntilRetry());
+  // Build set of keys to advertise ttl updates, per area, out of all buckets
+  // due by now
+  const auto now = std::chrono::steady_clock::now();
+  std::unordered_map<
+      std::string /* area */,
+      std::unordered_map<std::string, thrift::Value>>
+      areaKeyVals;
+
+  while (not ttlRefreshBuckets_.empty() and
+         ttlRefreshBuckets_.begin()->first <= now) {
+    const auto bucketTime = ttlRefreshBuckets_.begin()->first;
+    const auto keys = std::move(ttlRefreshBuckets_.begin()->second);
+    ttlRefreshBuckets_.erase(ttlRefreshBuckets_.begin());
+
+    for (auto const& areaKey : keys) {
+      auto const& area = areaKey.first;
+      auto const& key = areaKey.second;
+      auto areaIt = keyTtlUpdates_.find(area);
+      if (areaIt == keyTtlUpdates_.end()) {
+        continue;
+      }
+      auto ttlIt = areaIt->second.find(key);
+      // Skip if key is unset or rescheduled to another bucket since
+      if (ttlIt == areaIt->second.end() or
+          ttlIt->second.refreshTime != bucketTime) {
         continue;
       }
 
-      // Apply backoff
-      backoff.reportError();
-      timeout = std::min(timeout, backoff.getTimeRemainingUntilRetry());
-
-      auto& thriftValue = kv.second.first;
+      auto& thriftValue = ttlIt->second.value;
+      auto& persistedKeyVals = persistedKeyVals_[area];
       const auto it = persistedKeyVals.find(key);
       if (it != persistedKeyVals.end()) {
         // we may have got a newer vesion for persisted key
@@ -792,21 +964,30 @@ KvStoreClientInternal::advertiseTtlUpdates() {
                  thriftValue.originatorId,
                  thriftValue.ttlVersion,
                  area);
-      keyVals.emplace(key, thriftValue);
+      areaKeyVals[area].emplace(key, thriftValue);
+
+      // Schedule next refresh
+      scheduleTtlRefresh(area, key, now + ttlIt->second.interval);
     }
+  }
 
-    // Advertise to KvStore
-    if (not keyVals.empty()) {
-      const auto ret = setKeysHelper(std::move(keyVals), area);
-      if (!ret.has_value()) {
-        LOG(ERROR) << "Error sending SET_KEY request to KvStore.";
-      }
+  // Advertise to KvStore, one request per area
+  for (auto& kv : areaKeyVals) {
+    const auto ret = setKeysHelper(std::move(kv.second), kv.first);
+    if (!ret.has_value()) {
+      LOG(ERROR) << "Error sending SET_KEY request to KvStore.";
     }
   }
 
-  // Schedule next-timeout for processing/clearing backoffs
+  // Schedule next-timeout for earliest bucket
+  if (ttlRefreshBuckets_.empty()) {
+    ttlTimer_->cancelTimeout();
+    return;
+  }
+  const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(
+      ttlRefreshBuckets_.begin()->first - std::chrono::steady_clock::now());
   VLOG(2) << "Scheduling ttl timer after " << timeout.count() << "ms.";
-  ttlTimer_->scheduleTimeout(timeout);
+  ttlTimer_->scheduleTimeout(std::max(timeout, std::chrono::milliseconds(0)));
 }
 
 std::optional<folly::Unit>
@@ -838,7 +1019,7 @@ KvStoreClientInternal::setKeysHelper(
   params.keyVals = std::move(keyVals);
 
   try {
-    kvStore_->setKvStoreKeyVals(params, area).get();
+    kvStore_->setKvStoreKeyVals(std::move(params), area).get();
   } catch (const std::exception& ex) {
     LOG(ERROR) << "Failed to set key-val from KvStore. Exception: "
                << ex.what();
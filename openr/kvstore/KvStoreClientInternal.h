@@ -8,8 +8,12 @@
 #pragma once
 
 #include <chrono>
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <folly/Function.h>
 #include <folly/Optional.h>
@@ -73,6 +77,18 @@ class KvStoreClientInternal {
       std::chrono::milliseconds const ttl = Constants::kTtlInfInterval,
       std::string const& area = thrift::KvStore_constants::kDefaultArea());
 
+  /**
+   * Batched flavour of `persistKey`. Latest values of keys not persisted
+   * before are fetched from KvStore with one request, and changed keys are
+   * advertised together.
+   *
+   * returns true if call results in state change for any of the keys
+   */
+  bool persistKeys(
+      std::vector<std::pair<std::string, std::string>> const& keyVals,
+      std::chrono::milliseconds const ttl = Constants::kTtlInfInterval,
+      std::string const& area = thrift::KvStore_constants::kDefaultArea());
+
   /**
    * Advertise the key-value into KvStore with specified version. If version is
    * not specified than the one greater than the latest known will be used.
@@ -93,6 +109,14 @@ class KvStoreClientInternal {
       thrift::Value const& value,
       std::string const& area = thrift::KvStore_constants::kDefaultArea());
 
+  /**
+   * Batched flavour of `setKey` forwarding values directly to KvStore with
+   * one request. TTL updates of keys are scheduled together.
+   */
+  std::optional<folly::Unit> setKeys(
+      std::unordered_map<std::string, thrift::Value> const& keyVals,
+      std::string const& area = thrift::KvStore_constants::kDefaultArea());
+
   /**
    * Unset key from KvStore. It really doesn't delete the key from KvStore,
    * instead it just leave it as it is.
@@ -150,6 +174,20 @@ class KvStoreClientInternal {
   void subscribeKeyFilter(KvStoreFilters kvFilters, KeyCallback callback);
   void unSubscribeKeyFilter();
 
+  /**
+   * APIs to subscribe/unsubscribe to value changes of all keys starting with
+   * `keyPrefix` in an area. Unlike key filter, multiple prefixes can be
+   * subscribed at the same time and expired keys are reported with
+   * `std::nullopt` value.
+   */
+  void subscribeKeyPrefix(
+      std::string const& keyPrefix,
+      KeyCallback callback,
+      std::string const& area = thrift::KvStore_constants::kDefaultArea());
+  void unsubscribeKeyPrefix(
+      std::string const& keyPrefix,
+      std::string const& area = thrift::KvStore_constants::kDefaultArea());
+
   OpenrEventBase*
   getOpenrEventBase() const noexcept {
     return eventBase_;
@@ -173,6 +211,14 @@ class KvStoreClientInternal {
    */
   void processExpiredKeys(thrift::Publication const& publication);
 
+  /**
+   * Invoke callbacks of key prefixes subscribed in an area matching the key
+   */
+  void processKeyPrefixCallbacks(
+      std::string const& area,
+      std::string const& key,
+      std::optional<thrift::Value> const& value);
+
   /*
    * Utility function to build thrift::Value in KvStoreClientInternal
    * This method will:
@@ -204,7 +250,20 @@ class KvStoreClientInternal {
   void advertisePendingKeys();
 
   /**
-   * Helper function to schedule TTL update advertisement
+   * Persist single key-value without advertising it. `storeValue` is latest
+   * value of key in KvStore, used if key is not persisted before. Returns true
+   * on state change.
+   */
+  bool persistKeyHelper(
+      std::string const& key,
+      std::string const& value,
+      std::chrono::milliseconds const ttl,
+      std::string const& area,
+      std::optional<thrift::Value> const& storeValue);
+
+  /**
+   * Helper function to schedule TTL update advertisement. Scheduled updates
+   * are sent out by `advertiseTtlUpdates`
    */
   void scheduleTtlUpdates(
       std::string const& key,
@@ -215,10 +274,18 @@ class KvStoreClientInternal {
       std::string const& area = thrift::KvStore_constants::kDefaultArea());
 
   /**
-   * Helper function to advertise TTL update
+   * Helper function to advertise TTL updates of all keys due for refresh
    */
   void advertiseTtlUpdates();
 
+  /**
+   * Add TTL refresh of key to aligned time bucket covering refreshTime
+   */
+  void scheduleTtlRefresh(
+      std::string const& area,
+      std::string const& key,
+      std::chrono::steady_clock::time_point refreshTime);
+
   void checkPersistKeyInStore();
 
   /*
@@ -265,21 +332,47 @@ class KvStoreClientInternal {
   // callback for updates from keys filtered with provided filter
   KeyCallback keyPrefixFilterCallback_{nullptr};
 
+  // Trie node of subscribed key prefixes, one character per level. Callback is
+  // set if the path from root to this node is a subscribed prefix.
+  struct KeyPrefixNode {
+    std::unordered_map<char, std::unique_ptr<KeyPrefixNode>> children;
+    KeyCallback callback{nullptr};
+  };
+
+  // Subscribed key prefixes of every area to their callback functions. All
+  // prefixes of a key are found with one walk along the key, independent of
+  // number of subscriptions. Nodes are not released on unsubscribe, so that
+  // walk can carry on if callback unsubscribes itself.
+  std::unordered_map<std::string /* area */, KeyPrefixNode>
+      keyPrefixCallbacks_;
+
   // backoff associated with each key for re-advertisements
   std::unordered_map<
       std::string /* key */,
       ExponentialBackoff<std::chrono::milliseconds>>
       backoffs_;
 
-  // backoff associated with each key for freshing TTL
+  // TTL update of a key with finite TTL, refreshed every `interval`
+  struct KeyTtlUpdate {
+    // value without data, advertised to refresh TTL
+    thrift::Value value;
+    std::chrono::milliseconds interval{0};
+    // start of time bucket the next refresh is scheduled in
+    std::chrono::steady_clock::time_point refreshTime;
+  };
+
+  // TTL updates of keys for freshing TTL
   std::unordered_map<
       std::string /* area */,
-      std::unordered_map<
-          std::string /* key */,
-          std::pair<
-              thrift::Value /* value */,
-              ExponentialBackoff<std::chrono::milliseconds>>>>
-      keyTtlBackoffs_;
+      std::unordered_map<std::string /* key */, KeyTtlUpdate>>
+      keyTtlUpdates_;
+
+  // Keys of scheduled TTL refreshes per aligned time bucket. Entries of keys
+  // rescheduled or unset since are skipped
+  std::map<
+      std::chrono::steady_clock::time_point,
+      std::vector<std::pair<std::string /* area */, std::string /* key */>>>
+      ttlRefreshBuckets_;
 
   // Set of local keys to be re-advertised.
   std::unordered_map<
@@ -180,8 +180,7 @@ KvStoreWrapper::recvPublication() {
   if (maybePublication.hasError()) {
     throw std::runtime_error(std::string("recvPublication failed"));
   }
-  auto pub = maybePublication.value();
-  return pub;
+  return *maybePublication.value();
 }
 
 thrift::SptInfos
@@ -53,7 +53,7 @@ class KvStoreWrapper {
   /**
    * Get reader for KvStore updates queue
    */
-  messaging::RQueue<thrift::Publication>
+  messaging::RQueue<messaging::SharedValue<thrift::Publication>>
   getReader() {
     return kvStoreUpdatesQueue_.getReader();
   }
@@ -191,9 +191,10 @@ class KvStoreWrapper {
   apache::thrift::CompactSerializer serializer_;
 
   // Queue for streaming KvStore updates
-  messaging::ReplicateQueue<thrift::Publication> kvStoreUpdatesQueue_;
-  messaging::RQueue<thrift::Publication> kvStoreUpdatesQueueReader_{
-      kvStoreUpdatesQueue_.getReader()};
+  messaging::ReplicateQueue<messaging::SharedValue<thrift::Publication>>
+      kvStoreUpdatesQueue_;
+  messaging::RQueue<messaging::SharedValue<thrift::Publication>>
+      kvStoreUpdatesQueueReader_{kvStoreUpdatesQueue_.getReader()};
 
   // Queue for streaming peer updates from LM
   messaging::ReplicateQueue<thrift::PeerUpdateRequest> dummyPeerUpdatesQueue_;
@@ -0,0 +1,178 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "TtlCountdownWheel.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+namespace openr {
+
+constexpr size_t TtlCountdownWheel::kSlotBits;
+constexpr size_t TtlCountdownWheel::kNumSlots;
+constexpr size_t TtlCountdownWheel::kNumLevels;
+constexpr size_t TtlCountdownWheel::kOverflowSlot;
+
+TtlCountdownWheel::TtlCountdownWheel(
+    std::chrono::steady_clock::time_point startTime)
+    : startTime_(startTime), slots_(kNumLevels * kNumSlots + 1) {}
+
+void
+TtlCountdownWheel::upsert(TtlCountdownQueueEntry entry) {
+  auto it = entries_.find(entry.key);
+  if (it == entries_.end()) {
+    it = entries_.emplace(std::move(entry.key), Node{}).first;
+  } else {
+    unplace(it->first, it->second);
+  }
+
+  // Round up, so that entry never expires early. Expiry in the past is due
+  // right away.
+  uint64_t expiryTick{0};
+  if (entry.expiryTime > startTime_) {
+    expiryTick = std::chrono::ceil<std::chrono::milliseconds>(
+                     entry.expiryTime - startTime_)
+                     .count();
+  }
+  it->second.expiryTick = std::max(expiryTick, currentTick_);
+  it->second.entry = std::move(entry);
+  // Key is held once, by entries_
+  it->second.entry.key = std::string();
+  place(it->first, it->second);
+}
+
+void
+TtlCountdownWheel::erase(std::string const& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return;
+  }
+  unplace(it->first, it->second);
+  entries_.erase(it);
+}
+
+TtlCountdownQueueEntry const*
+TtlCountdownWheel::find(std::string const& key) const {
+  auto it = entries_.find(key);
+  return it != entries_.end() ? &it->second.entry : nullptr;
+}
+
+std::vector<TtlCountdownQueueEntry>
+TtlCountdownWheel::expire(std::chrono::steady_clock::time_point now) {
+  std::vector<TtlCountdownQueueEntry> expired;
+  if (now < startTime_) {
+    return expired;
+  }
+  const uint64_t targetTick =
+      std::chrono::floor<std::chrono::milliseconds>(now - startTime_).count();
+
+  while (currentTick_ <= targetTick) {
+    // Entries of current level-0 slot expire at currentTick_
+    auto& slot = slots_.at(getSlotIndex(0, currentTick_));
+    for (auto const* key : slot) {
+      auto it = entries_.find(*key);
+      CHECK(it != entries_.end());
+      auto node = entries_.extract(it);
+      node.mapped().entry.key = std::move(node.key());
+      expired.emplace_back(std::move(node.mapped().entry));
+    }
+    slot.clear();
+
+    // Jump to next tick with something to do. Ticks in between are empty on
+    // all levels.
+    const auto nextTick = getNextEventTick();
+    if (not nextTick.has_value() or *nextTick > targetTick) {
+      currentTick_ = targetTick;
+      break;
+    }
+    currentTick_ = *nextTick;
+    cascade();
+  }
+  return expired;
+}
+
+std::optional<std::chrono::steady_clock::time_point>
+TtlCountdownWheel::getNextEventTime() const {
+  std::optional<uint64_t> tick;
+  if (not slots_.at(getSlotIndex(0, currentTick_)).empty()) {
+    tick = currentTick_;
+  } else {
+    tick = getNextEventTick();
+  }
+  if (not tick.has_value()) {
+    return std::nullopt;
+  }
+  return startTime_ + std::chrono::milliseconds(*tick);
+}
+
+void
+TtlCountdownWheel::place(std::string const& key, Node& node) {
+  DCHECK_GE(node.expiryTick, currentTick_);
+  node.slot = kOverflowSlot;
+  for (size_t level = 0; level < kNumLevels; ++level) {
+    // Lowest level whose current rotation covers expiry
+    const size_t rotationBits = (level + 1) * kSlotBits;
+    if ((node.expiryTick >> rotationBits) == (currentTick_ >> rotationBits)) {
+      node.slot = level * kNumSlots + getSlotIndex(level, node.expiryTick);
+      break;
+    }
+  }
+  slots_.at(node.slot).emplace(&key);
+}
+
+void
+TtlCountdownWheel::unplace(std::string const& key, Node const& node) {
+  slots_.at(node.slot).erase(&key);
+}
+
+std::optional<uint64_t>
+TtlCountdownWheel::getNextEventTick() const {
+  for (size_t level = 0; level < kNumLevels; ++level) {
+    const size_t rotationBits = (level + 1) * kSlotBits;
+    const uint64_t rotationStart =
+        (currentTick_ >> rotationBits) << rotationBits;
+    for (uint64_t index = getSlotIndex(level, currentTick_) + 1;
+         index < kNumSlots;
+         ++index) {
+      if (not slots_.at(level * kNumSlots + index).empty()) {
+        return rotationStart | (index << (level * kSlotBits));
+      }
+    }
+  }
+  if (not slots_.at(kOverflowSlot).empty()) {
+    const size_t rotationBits = kNumLevels * kSlotBits;
+    return ((currentTick_ >> rotationBits) + 1) << rotationBits;
+  }
+  return std::nullopt;
+}
+
+void
+TtlCountdownWheel::cascade() {
+  // Higher levels first, as their entries may land in slot of lower level
+  // which starts at currentTick_ as well
+  auto replaceAll = [this](size_t slotIndex) {
+    auto keys = std::move(slots_.at(slotIndex));
+    slots_.at(slotIndex).clear();
+    for (auto const* key : keys) {
+      place(*key, entries_.at(*key));
+    }
+  };
+
+  const size_t rotationBits = kNumLevels * kSlotBits;
+  if ((currentTick_ & ((uint64_t{1} << rotationBits) - 1)) == 0) {
+    replaceAll(kOverflowSlot);
+  }
+  for (size_t level = kNumLevels - 1; level > 0; --level) {
+    const uint64_t slotMask = (uint64_t{1} << (level * kSlotBits)) - 1;
+    if ((currentTick_ & slotMask) == 0) {
+      replaceAll(level * kNumSlots + getSlotIndex(level, currentTick_));
+    }
+  }
+}
+
+} // namespace openr
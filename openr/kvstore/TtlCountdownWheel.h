@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace openr {
+
+struct TtlCountdownQueueEntry {
+  std::chrono::steady_clock::time_point expiryTime;
+  std::string key;
+  int64_t version{0};
+  int64_t ttlVersion{0};
+  std::string originatorId;
+};
+
+/**
+ * Hierarchical timing wheel tracking expiry of keys. Every key has at most one
+ * entry, which is updated in place when TTL of key is refreshed. Entries are
+ * expired in batch by advancing the wheel.
+ *
+ * Time is kept in ticks of 1ms since construction. Wheel has kNumLevels levels
+ * of kNumSlots slots each, and a slot of level k spans kNumSlots^k ticks. An
+ * entry lives on the lowest level whose current rotation covers its expiry and
+ * is cascaded to lower levels as the wheel advances. Expiry beyond the highest
+ * level (~49 days) is kept aside till the highest level wraps around.
+ *
+ * NOTE: Not thread safe
+ */
+class TtlCountdownWheel {
+ public:
+  explicit TtlCountdownWheel(
+      std::chrono::steady_clock::time_point startTime =
+          std::chrono::steady_clock::now());
+
+  /**
+   * non-copyable, slots refer to keys of entries. Moving retains them.
+   */
+  TtlCountdownWheel(TtlCountdownWheel const&) = delete;
+  TtlCountdownWheel& operator=(TtlCountdownWheel const&) = delete;
+  TtlCountdownWheel(TtlCountdownWheel&&) = default;
+
+  /**
+   * Add entry, or replace entry of the same key
+   */
+  void upsert(TtlCountdownQueueEntry entry);
+
+  /**
+   * Remove entry of key if any
+   */
+  void erase(std::string const& key);
+
+  /**
+   * Return entry of key or nullptr if there is none. Key of returned entry
+   * is left empty, it is held only once by the wheel
+   */
+  TtlCountdownQueueEntry const* find(std::string const& key) const;
+
+  /**
+   * Remove and return all entries which expire at or before `now`
+   */
+  std::vector<TtlCountdownQueueEntry> expire(
+      std::chrono::steady_clock::time_point now);
+
+  /**
+   * Earliest time at which `expire()` has work to do. It is either expiry of
+   * an entry or cascading of entries to a lower level. Returns none if wheel
+   * is empty.
+   */
+  std::optional<std::chrono::steady_clock::time_point> getNextEventTime()
+      const;
+
+  size_t
+  size() const {
+    return entries_.size();
+  }
+
+  bool
+  empty() const {
+    return entries_.empty();
+  }
+
+  static constexpr size_t kSlotBits{8};
+  static constexpr size_t kNumSlots{1 << kSlotBits};
+  static constexpr size_t kNumLevels{4};
+
+ private:
+  struct Node {
+    TtlCountdownQueueEntry entry;
+    uint64_t expiryTick{0};
+    // slots_ index of entry, or kOverflowSlot
+    size_t slot{0};
+  };
+
+  static constexpr size_t kOverflowSlot{kNumLevels * kNumSlots};
+
+  // Place node in slot matching its expiry
+  void place(std::string const& key, Node& node);
+
+  // Remove node from its slot
+  void unplace(std::string const& key, Node const& node);
+
+  // Next tick after currentTick_ at which there is an entry to expire or to
+  // cascade
+  std::optional<uint64_t> getNextEventTick() const;
+
+  // Move entries of slots starting at currentTick_ to lower levels
+  void cascade();
+
+  uint64_t
+  getSlotIndex(size_t level, uint64_t tick) const {
+    return (tick >> (level * kSlotBits)) & (kNumSlots - 1);
+  }
+
+  const std::chrono::steady_clock::time_point startTime_;
+
+  // Every tick before currentTick_ has been expired
+  uint64_t currentTick_{0};
+
+  // Entries by key
+  std::unordered_map<std::string, Node> entries_;
+
+  // Keys of entries per slot of every level followed by overflow slot. Keys
+  // point into entries_.
+  std::vector<std::unordered_set<std::string const*>> slots_;
+};
+
+} // namespace openr
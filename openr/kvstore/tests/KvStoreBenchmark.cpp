@@ -6,15 +6,21 @@
  */
 
 #include <folly/Benchmark.h>
+#include <chrono>
 #include <cstdlib>
+#include <ctime>
+#include <thread>
 #include <unordered_set>
 
+#include <fb303/ServiceData.h>
+#include <fbzmq/service/monitor/SystemMetrics.h>
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/Format.h>
 #include <folly/Random.h>
 #include <folly/init/Init.h>
 
 #include <openr/common/Util.h>
+#include <openr/common/tests/BenchmarkUtils.h>
 #include <openr/config/Config.h>
 #include <openr/config/tests/Utils.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
@@ -30,6 +36,10 @@ const std::chrono::seconds kDbSyncInterval(10000);
 const int kSizeOfKey = 32;
 // The byte size of a value
 const int kSizeOfValue = 1024;
+// The byte size of a value in scale benchmarks with up to millions of keys
+const int kSizeOfSmallValue = 64;
+// Number of keys set into store per call when loading large stores
+const size_t kLoadBatchSize = 10000;
 
 /**
  * Produce a random string of given length - for value generation
@@ -75,9 +85,14 @@ class KvStoreTestFixture {
   KvStoreWrapper*
   createKvStore(
       const std::string& nodeId,
-      std::unordered_map<std::string, thrift::PeerSpec> peers) {
+      std::unordered_map<std::string, thrift::PeerSpec> peers,
+      bool enableFloodOptimization = false,
+      bool isFloodRoot = false) {
     auto tConfig = getBasicOpenrConfig(nodeId);
     tConfig.kvstore_config.sync_interval_s = kDbSyncInterval.count();
+    tConfig.kvstore_config.enable_flood_optimization_ref() =
+        enableFloodOptimization;
+    tConfig.kvstore_config.is_flood_root_ref() = isFloodRoot;
     config_ = std::make_shared<Config>(tConfig);
     auto ptr =
         std::make_unique<KvStoreWrapper>(context, config_, std::move(peers));
@@ -291,6 +306,550 @@ BM_KvStoreFloodingUpdate(uint32_t iters, size_t numOfUpdateKeys) {
   }
 }
 
+/**
+ * Benchmark for flooding update to peers
+ * 1. Start kvStore and `numOfPeers` peer stores
+ * 2. Advertise keys in kvStore and wait until they appear in all peers
+ */
+static void
+BM_KvStoreFloodingPeers(uint32_t iters, size_t numOfPeers) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto kvStoreTestFixture = std::make_unique<KvStoreTestFixture>();
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  const size_t numOfUpdateKeys = 100;
+
+  auto kvStore = kvStoreTestFixture->createKvStore("kvStore", emptyPeers);
+  kvStore->run();
+  std::vector<KvStoreWrapper*> peerStores;
+  for (size_t idx = 0; idx < numOfPeers; idx++) {
+    auto peerStore = kvStoreTestFixture->createKvStore(
+        folly::sformat("peerStore{}", idx), emptyPeers);
+    peerStore->run();
+    kvStore->addPeer(peerStore->nodeId, peerStore->getPeerSpec());
+    peerStores.emplace_back(peerStore);
+  }
+
+  // Generate random keys beforehand for updating
+  std::vector<std::string> keys;
+  keys.reserve(numOfUpdateKeys);
+  for (uint32_t idx = 0; idx < numOfUpdateKeys; idx++) {
+    keys.emplace_back(genRandomStr(kSizeOfKey));
+  }
+
+  // Version starts with 1
+  uint64_t version = 1;
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; i++) {
+    floodingUpdate(numOfUpdateKeys, version, keys, kvStore);
+    for (auto peerStore : peerStores) {
+      auto pub = peerStore->recvPublication();
+      CHECK_EQ(numOfUpdateKeys, pub.keyVals.size());
+    }
+  }
+}
+
+/**
+ * Fabric of spines and leaves for flooding benchmarks. Every leaf peers with
+ * every spine, and spines are flood roots when flood optimization is enabled.
+ * spine-0   spine-1
+ *   |   \   /   |
+ *   |    \ /    |
+ *   |    / \    |
+ * leaf-0 ... leaf-N
+ */
+class KvStoreFabric {
+ public:
+  KvStoreFabric(
+      KvStoreTestFixture& fixture,
+      size_t numSpines,
+      size_t numLeaves,
+      bool enableFloodOptimization)
+      : enableFloodOptimization_(enableFloodOptimization) {
+    const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+    for (size_t i = 0; i < numSpines; i++) {
+      spines.emplace_back(fixture.createKvStore(
+          folly::sformat("spine-{}", i),
+          emptyPeers,
+          enableFloodOptimization,
+          true /* is flood root */));
+      spines.back()->run();
+    }
+    for (size_t i = 0; i < numLeaves; i++) {
+      leaves.emplace_back(fixture.createKvStore(
+          folly::sformat("leaf-{}", i),
+          emptyPeers,
+          enableFloodOptimization,
+          false /* is flood root */));
+      leaves.back()->run();
+    }
+    for (auto spine : spines) {
+      for (auto leaf : leaves) {
+        CHECK(spine->addPeer(leaf->nodeId, leaf->getPeerSpec()));
+        CHECK(leaf->addPeer(spine->nodeId, spine->getPeerSpec()));
+      }
+    }
+  }
+
+  // Stop a spine and remove it from peers of all leaves
+  void
+  stopSpine(size_t idx) {
+    auto spine = spines.at(idx);
+    spine->stop();
+    for (auto leaf : leaves) {
+      CHECK(leaf->delPeer(spine->nodeId));
+    }
+    spines.erase(spines.begin() + idx);
+  }
+
+  // Wait until all stores pick given flood root. No-op if flood optimization
+  // is disabled.
+  void
+  waitForFloodRoot(const std::string& rootId) {
+    if (not enableFloodOptimization_) {
+      return;
+    }
+    for (auto store : getStores()) {
+      while (true) {
+        const auto floodRootId = store->getFloodTopo().floodRootId_ref();
+        if (floodRootId.has_value() and *floodRootId == rootId) {
+          break;
+        }
+        /* sleep override */
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    }
+  }
+
+  // Wait until all stores publish given keys with given version
+  void
+  waitForKeys(const std::vector<std::string>& keys, int64_t version) {
+    for (auto store : getStores()) {
+      std::unordered_set<std::string> pendingKeys(keys.begin(), keys.end());
+      while (not pendingKeys.empty()) {
+        const auto pub = store->recvPublication();
+        for (const auto& kv : pub.keyVals) {
+          if (kv.second.version == version) {
+            pendingKeys.erase(kv.first);
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<KvStoreWrapper*>
+  getStores() const {
+    std::vector<KvStoreWrapper*> stores(spines);
+    stores.insert(stores.end(), leaves.begin(), leaves.end());
+    return stores;
+  }
+
+  std::vector<KvStoreWrapper*> spines;
+  std::vector<KvStoreWrapper*> leaves;
+
+ private:
+  const bool enableFloodOptimization_{false};
+};
+
+/**
+ * Flooding cost counters summed over all stores of process
+ */
+struct FloodingCost {
+  FloodingCost() {
+    const auto counters = fb303::fbData->getCounters();
+    auto getCounter = [&counters](const std::string& key) {
+      const auto it = counters.find(key);
+      return it == counters.end() ? 0 : it->second;
+    };
+    publications = getCounter("kvstore.sent_publications.count");
+    keyVals = getCounter("kvstore.sent_key_vals.sum");
+    bytes = getCounter("kvstore.peers.bytes_sent.sum");
+  }
+
+  int64_t publications{0};
+  int64_t keyVals{0};
+  int64_t bytes{0};
+};
+
+/**
+ * Set keys with given version into a store
+ */
+void
+setFabricKeys(
+    KvStoreWrapper* store,
+    const std::vector<std::string>& keys,
+    int64_t version) {
+  std::vector<std::pair<std::string, thrift::Value>> keyVals;
+  keyVals.reserve(keys.size());
+  for (const auto& key : keys) {
+    keyVals.emplace_back(
+        key,
+        createThriftValue(
+            version,
+            store->nodeId,
+            genRandomStr(kSizeOfValue),
+            Constants::kTtlInfinity));
+  }
+  CHECK(store->setKeys(keyVals));
+}
+
+/**
+ * Report flooding cost and duration of an update of numOfUpdateKeys keys
+ */
+void
+reportFloodingCost(
+    folly::UserCounters& counters,
+    const FloodingCost& before,
+    size_t numOfUpdateKeys,
+    std::chrono::steady_clock::time_point startTime) {
+  const FloodingCost after;
+  counters["e2e_ms"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - startTime)
+                           .count();
+  counters["publications"] = after.publications - before.publications;
+  counters["key_vals_per_update"] =
+      (after.keyVals - before.keyVals) / numOfUpdateKeys;
+  counters["bytes"] = after.bytes - before.bytes;
+}
+
+/**
+ * Benchmark for flooding an update over a fabric with or without flood
+ * optimization
+ * 1. Start 2 spines and `numOfLeaves` leaves, wait for flood topology
+ * 2. Advertise keys in a leaf and wait until they appear in all stores
+ * 3. Report messages and bytes sent by all stores meanwhile
+ */
+static void
+BM_KvStoreFabricFlooding(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numOfLeaves,
+    size_t numOfUpdateKeys,
+    bool enableFloodOptimization) {
+  for (uint32_t i = 0; i < iters; i++) {
+    auto suspender = folly::BenchmarkSuspender();
+    KvStoreTestFixture fixture;
+    KvStoreFabric fabric(fixture, 2, numOfLeaves, enableFloodOptimization);
+    fabric.waitForFloodRoot("spine-0");
+
+    std::vector<std::string> keys;
+    for (size_t idx = 0; idx < numOfUpdateKeys; idx++) {
+      keys.emplace_back(genRandomStr(kSizeOfKey));
+    }
+    const FloodingCost before;
+
+    suspender.dismiss(); // Start measuring benchmark time
+    const auto startTime = std::chrono::steady_clock::now();
+    setFabricKeys(fabric.leaves.front(), keys, 1);
+    fabric.waitForKeys(keys, 1);
+    suspender.rehire();
+
+    reportFloodingCost(counters, before, numOfUpdateKeys, startTime);
+  }
+}
+
+/**
+ * Benchmark for flooding an update over a fabric while its flood root fails
+ * 1. Start 2 spines and `numOfLeaves` leaves, wait for flood topology
+ * 2. Stop flood root and advertise keys in a leaf right away
+ * 3. Wait until keys appear in all remaining stores and flood topology
+ *    converges on the other spine
+ * 4. Report messages and bytes sent by all stores meanwhile
+ */
+static void
+BM_KvStoreFabricRootFailover(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numOfLeaves,
+    size_t numOfUpdateKeys,
+    bool enableFloodOptimization) {
+  for (uint32_t i = 0; i < iters; i++) {
+    auto suspender = folly::BenchmarkSuspender();
+    KvStoreTestFixture fixture;
+    KvStoreFabric fabric(fixture, 2, numOfLeaves, enableFloodOptimization);
+    fabric.waitForFloodRoot("spine-0");
+
+    std::vector<std::string> keys;
+    for (size_t idx = 0; idx < numOfUpdateKeys; idx++) {
+      keys.emplace_back(genRandomStr(kSizeOfKey));
+    }
+    const FloodingCost before;
+
+    suspender.dismiss(); // Start measuring benchmark time
+    const auto startTime = std::chrono::steady_clock::now();
+    fabric.stopSpine(0);
+    setFabricKeys(fabric.leaves.front(), keys, 1);
+    fabric.waitForKeys(keys, 1);
+    fabric.waitForFloodRoot("spine-1");
+    suspender.rehire();
+
+    reportFloodingCost(counters, before, numOfUpdateKeys, startTime);
+  }
+}
+
+/**
+ * Topologies of stores for scale benchmarks
+ */
+enum class Topology {
+  LINE,
+  RING,
+  MESH,
+};
+
+/**
+ * Stores peered in given topology
+ */
+std::vector<KvStoreWrapper*>
+createTopology(
+    KvStoreTestFixture& fixture, Topology topology, size_t numOfStores) {
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  std::vector<KvStoreWrapper*> stores;
+  for (size_t i = 0; i < numOfStores; i++) {
+    stores.emplace_back(
+        fixture.createKvStore(folly::sformat("store-{}", i), emptyPeers));
+    stores.back()->run();
+  }
+  auto peer = [&stores](size_t i, size_t j) {
+    CHECK(stores[i]->addPeer(stores[j]->nodeId, stores[j]->getPeerSpec()));
+    CHECK(stores[j]->addPeer(stores[i]->nodeId, stores[i]->getPeerSpec()));
+  };
+  for (size_t i = 0; i < numOfStores; i++) {
+    switch (topology) {
+    case Topology::LINE:
+      if (i + 1 < numOfStores) {
+        peer(i, i + 1);
+      }
+      break;
+    case Topology::RING:
+      if (numOfStores > 2 or i + 1 < numOfStores) {
+        peer(i, (i + 1) % numOfStores);
+      }
+      break;
+    case Topology::MESH:
+      for (size_t j = i + 1; j < numOfStores; j++) {
+        peer(i, j);
+      }
+      break;
+    }
+  }
+  return stores;
+}
+
+/**
+ * Key-values of given version and small random values, originated by given
+ * node
+ */
+std::vector<std::pair<std::string, thrift::Value>>
+getKeyVals(
+    const std::vector<std::string>& keys,
+    int64_t version,
+    const std::string& originatorId,
+    int64_t ttl = Constants::kTtlInfinity) {
+  std::vector<std::pair<std::string, thrift::Value>> keyVals;
+  keyVals.reserve(keys.size());
+  for (const auto& key : keys) {
+    keyVals.emplace_back(
+        key,
+        createThriftValue(
+            version, originatorId, genRandomStr(kSizeOfSmallValue), ttl));
+  }
+  return keyVals;
+}
+
+/**
+ * Set key-values into store in batches
+ */
+void
+loadKeyVals(
+    KvStoreWrapper* store,
+    const std::vector<std::pair<std::string, thrift::Value>>& keyVals) {
+  for (size_t begin = 0; begin < keyVals.size(); begin += kLoadBatchSize) {
+    const size_t end = std::min(begin + kLoadBatchSize, keyVals.size());
+    CHECK(store->setKeys(std::vector<std::pair<std::string, thrift::Value>>(
+        keyVals.begin() + begin, keyVals.begin() + end)));
+  }
+}
+
+/**
+ * Counter of KvStoreDb of default area
+ */
+int64_t
+getStoreCounter(KvStoreWrapper* store, const std::string& name) {
+  const auto counters = store->getCounters();
+  const auto it = counters.find(name);
+  return it == counters.end() ? 0 : it->second;
+}
+
+/**
+ * Poll until predicate holds
+ */
+template <typename Pred>
+void
+waitFor(Pred pred) {
+  while (not pred()) {
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+// CPU time consumed by process so far, mostly by KvStore threads as benchmark
+// thread sleeps while waiting
+std::chrono::nanoseconds
+getProcessCpuTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+/**
+ * Benchmark for flooding latency over a topology of stores
+ * 1. Start `numOfStores` stores peered in `topology`
+ * 2. Advertise keys in first store and wait until they appear in all stores
+ * 3. Report messages and bytes sent by all stores meanwhile
+ */
+static void
+BM_KvStoreTopologyFlooding(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    Topology topology,
+    size_t numOfStores,
+    size_t numOfUpdateKeys) {
+  for (uint32_t i = 0; i < iters; i++) {
+    auto suspender = folly::BenchmarkSuspender();
+    KvStoreTestFixture fixture;
+    auto stores = createTopology(fixture, topology, numOfStores);
+
+    std::vector<std::string> keys;
+    for (size_t idx = 0; idx < numOfUpdateKeys; idx++) {
+      keys.emplace_back(genRandomStr(kSizeOfKey));
+    }
+    const auto keyVals = getKeyVals(keys, 1, stores.front()->nodeId);
+    const FloodingCost before;
+
+    suspender.dismiss(); // Start measuring benchmark time
+    const auto startTime = std::chrono::steady_clock::now();
+    CHECK(stores.front()->setKeys(keyVals));
+    for (auto store : stores) {
+      std::unordered_set<std::string> pendingKeys(keys.begin(), keys.end());
+      while (not pendingKeys.empty()) {
+        const auto pub = store->recvPublication();
+        for (const auto& kv : pub.keyVals) {
+          pendingKeys.erase(kv.first);
+        }
+      }
+    }
+    suspender.rehire();
+
+    reportFloodingCost(counters, before, numOfUpdateKeys, startTime);
+  }
+}
+
+/**
+ * Benchmark for full-sync of two stores of `numOfKeys` keys, of which
+ * `diffPercent` percent differ
+ * 1. Load both stores with same keys, and bump version of differing keys in
+ *    one of them
+ * 2. Peer stores and wait until their digests match
+ * 3. Report bytes sent meanwhile
+ */
+static void
+BM_KvStoreFullSync(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numOfKeys,
+    size_t diffPercent) {
+  const auto digestKey = folly::sformat(
+      "kvstore.store_digest.{}", thrift::KvStore_constants::kDefaultArea());
+  for (uint32_t i = 0; i < iters; i++) {
+    auto suspender = folly::BenchmarkSuspender();
+    KvStoreTestFixture fixture;
+    const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+    auto store0 = fixture.createKvStore("store-0", emptyPeers);
+    auto store1 = fixture.createKvStore("store-1", emptyPeers);
+    store0->run();
+    store1->run();
+
+    std::vector<std::string> keys;
+    keys.reserve(numOfKeys);
+    for (size_t idx = 0; idx < numOfKeys; idx++) {
+      keys.emplace_back(folly::sformat("key-{:08d}", idx));
+    }
+    const auto keyVals = getKeyVals(keys, 1, "originator");
+    loadKeyVals(store0, keyVals);
+    loadKeyVals(store1, keyVals);
+    const std::vector<std::string> diffKeys(
+        keys.begin(), keys.begin() + numOfKeys * diffPercent / 100);
+    loadKeyVals(store1, getKeyVals(diffKeys, 2, "originator"));
+    const FloodingCost before;
+
+    suspender.dismiss(); // Start measuring benchmark time
+    const auto startTime = std::chrono::steady_clock::now();
+    CHECK(store0->addPeer(store1->nodeId, store1->getPeerSpec()));
+    CHECK(store1->addPeer(store0->nodeId, store0->getPeerSpec()));
+    waitFor([&]() {
+      return getStoreCounter(store0, digestKey) ==
+          getStoreCounter(store1, digestKey);
+    });
+    suspender.rehire();
+
+    const FloodingCost after;
+    counters["e2e_ms"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - startTime)
+                             .count();
+    counters["bytes"] = after.bytes - before.bytes;
+  }
+}
+
+/**
+ * Benchmark for TTL expiry of `numOfKeys` keys in one store
+ * 1. Load store with keys of short TTL
+ * 2. Wait until all of them expired
+ * 3. Report CPU time of process meanwhile, and memory per key while loaded
+ */
+static void
+BM_KvStoreTtlExpiry(
+    folly::UserCounters& counters, uint32_t iters, size_t numOfKeys) {
+  // long enough for keys to be loaded before any of them expires
+  const int64_t ttlMs = 5000 + numOfKeys / 100;
+  fbzmq::SystemMetrics systemMetrics;
+  for (uint32_t i = 0; i < iters; i++) {
+    auto suspender = folly::BenchmarkSuspender();
+    KvStoreTestFixture fixture;
+    const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+    auto store = fixture.createKvStore("store-0", emptyPeers);
+    store->run();
+
+    std::vector<std::string> keys;
+    keys.reserve(numOfKeys);
+    for (size_t idx = 0; idx < numOfKeys; idx++) {
+      keys.emplace_back(folly::sformat("key-{:08d}", idx));
+    }
+    auto keyVals = getKeyVals(keys, 1, "originator", ttlMs);
+    keys.clear();
+    const auto rssBefore = systemMetrics.getRSSMemBytes();
+    loadKeyVals(store, keyVals);
+    keyVals.clear();
+    const auto rssAfter = systemMetrics.getRSSMemBytes();
+    CHECK_EQ(
+        static_cast<int64_t>(numOfKeys),
+        getStoreCounter(store, "kvstore.num_keys"));
+
+    suspender.dismiss(); // Start measuring benchmark time
+    const auto startCpuTime = getProcessCpuTime();
+    waitFor([&]() { return getStoreCounter(store, "kvstore.num_keys") == 0; });
+    const auto endCpuTime = getProcessCpuTime();
+    suspender.rehire();
+
+    counters["expiry_cpu_ms"] =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            endCpuTime - startCpuTime)
+            .count();
+    if (rssBefore.has_value() and rssAfter.has_value() and numOfKeys) {
+      counters["bytes_per_key"] = (*rssAfter - *rssBefore) / numOfKeys;
+    }
+  }
+}
+
 // The first integer parameter is number of keyVals already in store
 // The second integer parameter is the number of keyVals for update
 BENCHMARK_NAMED_PARAM(BM_KvStoreMergeKeyValues, 10_10, 10, 10);
@@ -313,6 +872,67 @@ BENCHMARK_PARAM(BM_KvStoreFloodingUpdate, 100);
 BENCHMARK_PARAM(BM_KvStoreFloodingUpdate, 1000);
 BENCHMARK_PARAM(BM_KvStoreFloodingUpdate, 10000);
 
+// The parameter is number of peers to flood to
+BENCHMARK_PARAM(BM_KvStoreFloodingPeers, 1);
+BENCHMARK_PARAM(BM_KvStoreFloodingPeers, 16);
+BENCHMARK_PARAM(BM_KvStoreFloodingPeers, 64);
+
+// The parameters are number of leaves, number of keyVals for update and
+// whether flood optimization is enabled
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFabricFlooding, counters, 16_100_flat, 16, 100, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFabricFlooding, counters, 16_100_spt, 16, 100, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFabricFlooding, counters, 64_100_flat, 64, 100, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFabricFlooding, counters, 64_100_spt, 64, 100, true);
+
+// The parameters are number of leaves, number of keyVals for update and
+// whether flood optimization is enabled
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFabricRootFailover, counters, 16_100_flat, 16, 100, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFabricRootFailover, counters, 16_100_spt, 16, 100, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFabricRootFailover, counters, 64_100_flat, 64, 100, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFabricRootFailover, counters, 64_100_spt, 64, 100, true);
+
+// The parameters are topology, number of stores and number of keyVals for
+// update
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreTopologyFlooding, counters, line_16_100, Topology::LINE, 16, 100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreTopologyFlooding, counters, ring_16_100, Topology::RING, 16, 100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreTopologyFlooding, counters, mesh_16_100, Topology::MESH, 16, 100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreTopologyFlooding, counters, ring_64_100, Topology::RING, 64, 100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreTopologyFlooding,
+    counters,
+    mesh_32_1000,
+    Topology::MESH,
+    32,
+    1000);
+
+// The parameters are number of keys in stores and percentage of them which
+// differ
+BENCHMARK_COUNTERS_NAME_PARAM(BM_KvStoreFullSync, counters, 10000_1, 10000, 1);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFullSync, counters, 100000_1, 100000, 1);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFullSync, counters, 100000_10, 100000, 10);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFullSync, counters, 100000_100, 100000, 100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFullSync, counters, 1000000_1, 1000000, 1);
+
+// The parameter is number of keys in store
+BENCHMARK_COUNTERS_NAME_PARAM(BM_KvStoreTtlExpiry, counters, 100000, 100000);
+BENCHMARK_COUNTERS_NAME_PARAM(BM_KvStoreTtlExpiry, counters, 1000000, 1000000);
+
 } // namespace openr
 
 int
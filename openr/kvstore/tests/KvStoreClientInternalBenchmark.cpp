@@ -0,0 +1,297 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+#include <folly/synchronization/Baton.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/Util.h>
+#include <openr/common/tests/BenchmarkUtils.h>
+#include <openr/config/Config.h>
+#include <openr/config/tests/Utils.h>
+#include <openr/kvstore/KvStoreClientInternal.h>
+#include <openr/kvstore/KvStoreWrapper.h>
+
+namespace openr {
+
+namespace {
+
+const std::string kNodeName("node-1");
+
+// TTL of keys refreshed by client, refresh happens every quarter of it
+const std::chrono::milliseconds kKeyTtl(1000);
+
+std::string
+getKey(size_t prefixId, size_t keyId) {
+  return folly::sformat("prefix-{}:key-{:08d}", prefixId, keyId);
+}
+
+std::vector<std::pair<std::string, std::string>>
+getKeyVals(size_t numKeys) {
+  std::vector<std::pair<std::string, std::string>> keyVals;
+  keyVals.reserve(numKeys);
+  for (size_t i = 0; i < numKeys; ++i) {
+    keyVals.emplace_back(getKey(0, i), "value");
+  }
+  return keyVals;
+}
+
+// CPU time consumed by calling thread so far
+std::chrono::nanoseconds
+getThreadCpuTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+} // namespace
+
+/**
+ * KvStore with single KvStoreClientInternal looping in its own event-base
+ * thread. Publications of KvStore are also recorded for inspection.
+ */
+class KvStoreClientBenchmarkFixture {
+ public:
+  KvStoreClientBenchmarkFixture()
+      : config_(std::make_shared<Config>(getBasicOpenrConfig(kNodeName))),
+        kvStoreWrapper_(std::make_unique<KvStoreWrapper>(
+            context_,
+            config_,
+            std::unordered_map<std::string, thrift::PeerSpec>{})) {
+    kvStoreWrapper_->run();
+
+    client_ = std::make_unique<KvStoreClientInternal>(
+        &evb_, kNodeName, kvStoreWrapper_->getKvStore());
+    evbThread_ = std::thread([this]() { evb_.run(); });
+    evb_.waitUntilRunning();
+  }
+
+  ~KvStoreClientBenchmarkFixture() {
+    kvStoreWrapper_->stop();
+    client_.reset();
+    evb_.stop();
+    evb_.waitUntilStopped();
+    evbThread_.join();
+  }
+
+  // Run function in event-base of client and wait for it to finish
+  void
+  runInEvb(folly::Function<void()> fn) {
+    evb_.getEvb()->runInEventBaseThreadAndWait(std::move(fn));
+  }
+
+  KvStoreClientInternal*
+  getClient() {
+    return client_.get();
+  }
+
+  KvStoreWrapper*
+  getKvStoreWrapper() {
+    return kvStoreWrapper_.get();
+  }
+
+  // Drop publications received so far
+  void
+  clearPublications() {
+    while (reader_.size()) {
+      reader_.get();
+    }
+  }
+
+  // Count publications received so far which only update TTLs, along with
+  // number of key updates in them, and drop all publications
+  std::pair<size_t, size_t>
+  countTtlPublications() {
+    size_t numPublications{0};
+    size_t numKeys{0};
+    while (reader_.size()) {
+      auto maybePublication = reader_.get();
+      if (maybePublication.hasError()) {
+        break;
+      }
+      size_t numTtlKeys{0};
+      for (auto const& kv : maybePublication.value()->keyVals) {
+        if (not kv.second.value_ref()) {
+          ++numTtlKeys;
+        }
+      }
+      if (numTtlKeys) {
+        ++numPublications;
+        numKeys += numTtlKeys;
+      }
+    }
+    return {numPublications, numKeys};
+  }
+
+ private:
+  fbzmq::Context context_;
+  std::shared_ptr<Config> config_;
+  std::unique_ptr<KvStoreWrapper> kvStoreWrapper_;
+
+  OpenrEventBase evb_;
+  std::thread evbThread_;
+  std::unique_ptr<KvStoreClientInternal> client_;
+
+  // Reader of KvStore publications, must be initialized after KvStore
+  messaging::RQueue<messaging::SharedValue<thrift::Publication>> reader_{
+      kvStoreWrapper_->getReader()};
+};
+
+/**
+ * Measure time to persist numKeys keys into KvStore, either one key per call
+ * or all of them in a single batch
+ */
+static void
+BM_KvStoreClientPersistKeys(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numKeys,
+    bool batched) {
+  for (uint32_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    KvStoreClientBenchmarkFixture fixture;
+    const auto keyVals = getKeyVals(numKeys);
+
+    suspender.dismiss();
+    fixture.runInEvb([&]() {
+      if (batched) {
+        fixture.getClient()->persistKeys(keyVals);
+      } else {
+        for (auto const& keyVal : keyVals) {
+          fixture.getClient()->persistKey(keyVal.first, keyVal.second);
+        }
+      }
+    });
+    suspender.rehire();
+
+    counters["kvstore_keys"] = fixture.getKvStoreWrapper()->dumpAll().size();
+  }
+}
+
+/**
+ * Keep numKeys keys with finite TTL alive for a few TTL intervals, and measure
+ * event-base CPU time of client spent on refreshing them along with TTL
+ * updates published by KvStore meanwhile
+ */
+static void
+BM_KvStoreClientTtlRefresh(
+    folly::UserCounters& counters, uint32_t iters, size_t numKeys) {
+  for (uint32_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    KvStoreClientBenchmarkFixture fixture;
+    const auto keyVals = getKeyVals(numKeys);
+    std::chrono::nanoseconds startCpuTime{0};
+    fixture.runInEvb([&]() {
+      fixture.getClient()->persistKeys(keyVals, kKeyTtl);
+      startCpuTime = getThreadCpuTime();
+    });
+    fixture.clearPublications();
+
+    suspender.dismiss();
+    std::this_thread::sleep_for(kKeyTtl * 2);
+    suspender.rehire();
+
+    std::chrono::nanoseconds endCpuTime{0};
+    fixture.runInEvb([&]() { endCpuTime = getThreadCpuTime(); });
+    const auto ttlPublications = fixture.countTtlPublications();
+
+    counters["client_cpu_ms"] =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            endCpuTime - startCpuTime)
+            .count();
+    counters["ttl_publications"] = ttlPublications.first;
+    counters["ttl_keys"] = ttlPublications.second;
+  }
+}
+
+/**
+ * Measure time from a publication of numKeys keys until client dispatched all
+ * of them to callbacks of numPrefixes subscribed key prefixes, keys being
+ * spread evenly across prefixes
+ */
+static void
+BM_KvStoreClientCallbackDispatch(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numKeys,
+    size_t numPrefixes) {
+  for (uint32_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    KvStoreClientBenchmarkFixture fixture;
+    folly::Baton<> dispatchedBaton;
+    size_t numCallbacks{0};
+    fixture.runInEvb([&]() {
+      for (size_t j = 0; j < numPrefixes; ++j) {
+        fixture.getClient()->subscribeKeyPrefix(
+            folly::sformat("prefix-{}:", j),
+            [&](std::string const&, std::optional<thrift::Value>) noexcept {
+              if (++numCallbacks == numKeys) {
+                dispatchedBaton.post();
+              }
+            });
+      }
+    });
+
+    std::vector<std::pair<std::string, thrift::Value>> keyVals;
+    keyVals.reserve(numKeys);
+    for (size_t j = 0; j < numKeys; ++j) {
+      keyVals.emplace_back(
+          getKey(j % numPrefixes, j),
+          createThriftValue(
+              1, "node-2", std::string("value"), kKeyTtl.count()));
+    }
+
+    suspender.dismiss();
+    fixture.getKvStoreWrapper()->setKeys(keyVals);
+    dispatchedBaton.wait();
+    suspender.rehire();
+
+    counters["callbacks"] = numCallbacks;
+  }
+}
+
+// The parameters are number of keys and whether to persist them in one batch
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreClientPersistKeys, counters, 1000_single, 1000, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreClientPersistKeys, counters, 1000_batch, 1000, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreClientPersistKeys, counters, 10000_single, 10000, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreClientPersistKeys, counters, 10000_batch, 10000, true);
+
+// The parameter is number of keys
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreClientTtlRefresh, counters, 10000, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreClientTtlRefresh, counters, 100000, 100000);
+
+// The parameters are number of keys and number of subscribed key prefixes
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreClientCallbackDispatch, counters, 10000_1, 10000, 1);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreClientCallbackDispatch, counters, 10000_100, 10000, 100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreClientCallbackDispatch, counters, 10000_1000, 10000, 1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreClientCallbackDispatch, counters, 100000_1000, 100000, 1000);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
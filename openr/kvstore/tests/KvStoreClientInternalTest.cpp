@@ -677,6 +677,78 @@ TEST(KvStoreClientInternal, PersistKeyTest) {
   evbThread.join();
 }
 
+/**
+ * Persist and set keys in batches
+ * - Persisted keys not in store get version 1, and keys set in store by
+ *   others are won over with higher version
+ * - Persisting same batch again is a no op
+ * - Keys set in batch are forwarded as is
+ */
+TEST(KvStoreClientInternal, BatchedKeysTest) {
+  fbzmq::Context context;
+  folly::Baton waitBaton;
+  const std::string nodeId{"test_store"};
+
+  auto config = std::make_shared<Config>(getBasicOpenrConfig(nodeId));
+  auto store = std::make_shared<KvStoreWrapper>(
+      context, config, std::unordered_map<std::string, thrift::PeerSpec>{});
+  store->run();
+
+  // key2 is already advertised by someone else
+  store->setKey(
+      "key2", createThriftValue(5, "other_node", std::string("other_value")));
+
+  OpenrEventBase evb;
+  auto client = std::make_shared<KvStoreClientInternal>(
+      &evb, nodeId, store->getKvStore());
+
+  const std::vector<std::pair<std::string, std::string>> keyVals{
+      {"key1", "value1"}, {"key2", "value2"}, {"key3", "value3"}};
+
+  evb.scheduleTimeout(std::chrono::milliseconds(0), [&]() noexcept {
+    EXPECT_TRUE(client->persistKeys(keyVals, 10000ms));
+    EXPECT_FALSE(client->persistKeys(keyVals, 10000ms));
+
+    const std::unordered_map<std::string, thrift::Value> setKeyVals{
+        {"key4", createThriftValue(3, nodeId, std::string("value4"), 10000)},
+        {"key5", createThriftValue(4, nodeId, std::string("value5"), 10000)}};
+    EXPECT_TRUE(client->setKeys(setKeyVals).has_value());
+  });
+
+  evb.scheduleTimeout(std::chrono::milliseconds(10), [&]() noexcept {
+    for (auto const& kv : keyVals) {
+      auto maybeVal = client->getKey(kv.first);
+      ASSERT_TRUE(maybeVal.has_value());
+      EXPECT_EQ(kv.first == "key2" ? 6 : 1, maybeVal->version);
+      EXPECT_EQ(nodeId, maybeVal->originatorId);
+      EXPECT_EQ(kv.second, maybeVal->value);
+      EXPECT_EQ(10000, maybeVal->ttl);
+    }
+    auto maybeVal4 = client->getKey("key4");
+    ASSERT_TRUE(maybeVal4.has_value());
+    EXPECT_EQ(3, maybeVal4->version);
+    EXPECT_EQ("value4", maybeVal4->value);
+    auto maybeVal5 = client->getKey("key5");
+    ASSERT_TRUE(maybeVal5.has_value());
+    EXPECT_EQ(4, maybeVal5->version);
+
+    waitBaton.post();
+  });
+
+  std::thread evbThread([&]() { evb.run(); });
+  evb.waitUntilRunning();
+  waitBaton.wait();
+
+  store->closeQueue();
+  client.reset();
+  store->stop();
+  store.reset();
+
+  evb.stop();
+  evb.waitUntilStopped();
+  evbThread.join();
+}
+
 /**
  * Test ttl change with persist key while keeping value and version same
  * - Set key with ttl 1s
@@ -1135,6 +1207,73 @@ TEST(KvStoreClientInternal, SubscribeApiTest) {
   evbThread.join();
 }
 
+TEST(KvStoreClientInternal, SubscribeKeyPrefixApiTest) {
+  fbzmq::Context context;
+  folly::Baton waitBaton;
+  const std::string nodeId{"test_store"};
+
+  // Initialize and start KvStore with empty peer
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto config = std::make_shared<Config>(getBasicOpenrConfig(nodeId));
+  auto store = std::make_shared<KvStoreWrapper>(context, config, emptyPeers);
+  store->run();
+
+  OpenrEventBase evb;
+  auto client1 = std::make_shared<KvStoreClientInternal>(
+      &evb, nodeId, store->getKvStore());
+  auto client2 = std::make_shared<KvStoreClientInternal>(
+      &evb, nodeId, store->getKvStore());
+
+  // Count callbacks of empty and nested prefixes
+  int allCbCnt{0};
+  int prefixCbCnt{0};
+  int subPrefixCbCnt{0};
+  evb.scheduleTimeout(std::chrono::milliseconds(0), [&]() noexcept {
+    client1->subscribeKeyPrefix(
+        "", [&](std::string const&, std::optional<thrift::Value>) noexcept {
+          allCbCnt++;
+        });
+    client1->subscribeKeyPrefix(
+        "prefix:",
+        [&](std::string const& k, std::optional<thrift::Value>) noexcept {
+          prefixCbCnt++;
+          if (k == "prefix:b1") {
+            // Unsubscribe nested prefix and publish another key of it
+            client1->unsubscribeKeyPrefix("prefix:a");
+            client2->setKey("prefix:a2", "value");
+          }
+          if (k == "prefix:a2") {
+            waitBaton.post();
+          }
+        });
+    client1->subscribeKeyPrefix(
+        "prefix:a",
+        [&](std::string const& k, std::optional<thrift::Value>) noexcept {
+          EXPECT_EQ("prefix:a1", k);
+          subPrefixCbCnt++;
+        });
+
+    client2->setKey("prefix:a1", "value");
+    client2->setKey("prefix:b1", "value");
+  });
+
+  std::thread evbThread([&]() { evb.run(); });
+  evb.waitUntilRunning();
+  waitBaton.wait();
+
+  store->stop();
+  client1.reset();
+  client2.reset();
+  evb.stop();
+  evb.waitUntilStopped();
+  evbThread.join();
+
+  // a1 and b1 match "prefix:", only a1 matches "prefix:a" while subscribed
+  EXPECT_EQ(3, allCbCnt);
+  EXPECT_EQ(3, prefixCbCnt);
+  EXPECT_EQ(1, subPrefixCbCnt);
+}
+
 TEST(KvStoreClientInternal, SubscribeKeyFilterApiTest) {
   fbzmq::Context context;
   folly::Baton waitBaton;
@@ -6,6 +6,7 @@
  */
 
 #include <algorithm>
+#include <cstdio>
 #include <cstdlib>
 #include <thread>
 #include <tuple>
@@ -15,19 +16,23 @@
 
 #include <fb303/ServiceData.h>
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/FileUtil.h>
 #include <folly/Format.h>
 #include <folly/Memory.h>
 #include <folly/Random.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/gen/Base.h>
 #include <gtest/gtest.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
+#include <openr/common/StatCounter.h>
 #include <openr/common/Util.h>
 #include <openr/config/Config.h>
 #include <openr/config/tests/Utils.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
 #include <openr/kvstore/KvStore.h>
 #include <openr/kvstore/KvStoreWrapper.h>
+#include <openr/tests/OpenrThriftServerWrapper.h>
 
 using namespace openr;
 using apache::thrift::CompactSerializer;
@@ -478,6 +483,58 @@ TEST(KvStore, mergeKeyValuesTest) {
 //
 // Test compareValues method
 //
+/**
+ * Merging large publication in parallel on executor must yield same store and
+ * updates as serial merge
+ */
+TEST(KvStore, mergeKeyValuesParallelTest) {
+  const size_t kNumKeys = 5 * Constants::kKvStoreMergeChunkSize + 1;
+  std::unordered_map<std::string, thrift::Value> myStore;
+  std::unordered_map<std::string, thrift::Value> keyVals;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    const auto key = folly::sformat("key-{}", i);
+    // 1/3 of keys are older in store, 1/3 newer and 1/3 missing
+    if (i % 3 != 2) {
+      myStore.emplace(
+          key,
+          createThriftValue(
+              i % 3 == 0 ? 1 : 3 /* version */,
+              "node1",
+              std::string("old-value"),
+              Constants::kTtlInfinity));
+    }
+    auto value = createThriftValue(
+        2 /* version */, "node1", std::string("new-value"));
+    value.hash_ref().reset();
+    keyVals.emplace(key, std::move(value));
+  }
+
+  auto serialStore = myStore;
+  auto serialUpdates = KvStore::mergeKeyValues(serialStore, keyVals);
+
+  folly::CPUThreadPoolExecutor executor(4);
+  auto parallelStore = myStore;
+  auto parallelUpdates = KvStore::mergeKeyValues(
+      parallelStore, keyVals, std::nullopt, &executor);
+
+  EXPECT_EQ(serialStore, parallelStore);
+  EXPECT_EQ(serialUpdates, parallelUpdates);
+
+  // moving values of owned update gives same result
+  auto movedStore = myStore;
+  auto movedKeyVals = keyVals;
+  auto movedUpdates = KvStore::mergeKeyValues(
+      movedStore, std::move(movedKeyVals), std::nullopt, &executor);
+  EXPECT_EQ(serialStore, movedStore);
+  EXPECT_EQ(serialUpdates, movedUpdates);
+  // older and missing keys are updated, with hash generated
+  EXPECT_EQ(kNumKeys * 2 / 3, parallelUpdates.size());
+  for (auto const& kv : parallelUpdates) {
+    EXPECT_EQ("new-value", kv.second.value_ref());
+    EXPECT_TRUE(kv.second.hash_ref().has_value());
+  }
+}
+
 TEST(KvStore, compareValuesTest) {
   thrift::Value refValue(
       apache::thrift::FRAGILE,
@@ -556,6 +613,199 @@ TEST(KvStore, compareValuesTest) {
   }
 }
 
+//
+// Test coalescePublication method
+//
+TEST(KvStore, coalescePublicationTest) {
+  thrift::Value value(
+      apache::thrift::FRAGILE,
+      5, /* version */
+      "node5", /* node id */
+      "dummyValue",
+      3600, /* ttl */
+      1 /* ttl version */,
+      112233 /* hash */);
+  thrift::Value ttlValue = value;
+  ttlValue.value.reset();
+  ttlValue.ttl = 1800;
+  ttlValue.ttlVersion = 2;
+
+  thrift::Publication pending;
+  pending.keyVals = {{"key1", value}, {"key2", value}};
+  pending.expiredKeys = {"key3", "key4"};
+
+  thrift::Publication update;
+  update.keyVals = {{"key1", ttlValue}, {"key3", value}};
+  update.expiredKeys = {"key2", "key4"};
+
+  EXPECT_TRUE(KvStore::coalescePublication(pending, update));
+  // TTL refresh retains pending value
+  ASSERT_EQ(1, pending.keyVals.count("key1"));
+  EXPECT_EQ("dummyValue", pending.keyVals.at("key1").value.value());
+  EXPECT_EQ(1800, pending.keyVals.at("key1").ttl);
+  EXPECT_EQ(2, pending.keyVals.at("key1").ttlVersion);
+  // key2 expired, key3 re-advertised
+  EXPECT_EQ(0, pending.keyVals.count("key2"));
+  EXPECT_EQ(1, pending.keyVals.count("key3"));
+  EXPECT_EQ(std::vector<std::string>({"key2", "key4"}), pending.expiredKeys);
+
+  // completion of initial sync survives coalescing
+  thrift::Publication syncDone;
+  syncDone.initialSyncDone_ref() = true;
+  EXPECT_TRUE(KvStore::coalescePublication(pending, syncDone));
+  EXPECT_TRUE(pending.initialSyncDone_ref().value_or(false));
+  EXPECT_EQ(2, pending.keyVals.size());
+
+  // publications of different areas are not coalesced
+  update.area_ref() = "other_area";
+  EXPECT_FALSE(KvStore::coalescePublication(pending, update));
+}
+
+//
+// Test packTtlUpdates and unpackTtlUpdates methods
+//
+TEST(KvStore, packTtlUpdatesTest) {
+  thrift::Value value(
+      apache::thrift::FRAGILE,
+      5, /* version */
+      "node5", /* node id */
+      "dummyValue",
+      3600, /* ttl */
+      1 /* ttl version */,
+      112233 /* hash */);
+  thrift::Value ttlValue = value;
+  ttlValue.value.reset();
+  ttlValue.hash.reset();
+  ttlValue.ttl = 1800;
+  ttlValue.ttlVersion = 2;
+  thrift::Value otherTtlValue = ttlValue;
+  otherTtlValue.originatorId = "node6";
+
+  thrift::KeySetParams params;
+  params.keyVals = {{"key1", value},
+                    {"key2", ttlValue},
+                    {"key3", ttlValue},
+                    {"key4", otherTtlValue}};
+
+  // Only TTL refreshes are batched, per originator
+  EXPECT_EQ(3, KvStore::packTtlUpdates(params));
+  EXPECT_EQ(1, params.keyVals.size());
+  EXPECT_EQ(1, params.keyVals.count("key1"));
+  ASSERT_TRUE(params.ttlUpdates_ref().has_value());
+  EXPECT_EQ(2, params.ttlUpdates_ref()->size());
+  EXPECT_EQ(2, params.ttlUpdates_ref()->at("node5").size());
+  ASSERT_EQ(1, params.ttlUpdates_ref()->at("node6").size());
+  EXPECT_EQ("key4", params.ttlUpdates_ref()->at("node6").at(0).key);
+
+  // Unpacked refreshes are same as the original ones
+  KvStore::unpackTtlUpdates(params);
+  EXPECT_FALSE(params.ttlUpdates_ref().has_value());
+  ASSERT_EQ(4, params.keyVals.size());
+  EXPECT_EQ(value, params.keyVals.at("key1"));
+  EXPECT_EQ(ttlValue, params.keyVals.at("key2"));
+  EXPECT_EQ(ttlValue, params.keyVals.at("key3"));
+  EXPECT_EQ(otherTtlValue, params.keyVals.at("key4"));
+
+  // Nothing to batch
+  params.keyVals = {{"key1", value}};
+  EXPECT_EQ(0, KvStore::packTtlUpdates(params));
+  EXPECT_FALSE(params.ttlUpdates_ref().has_value());
+}
+
+//
+// Test createValueDelta and applyValueDelta methods
+//
+TEST(KvStore, valueDeltaTest) {
+  const std::string baseStr(4096, 'a');
+  thrift::Value base = createThriftValue(1, "node1", baseStr, 3600, 1);
+  ASSERT_TRUE(base.hash.has_value());
+
+  // Change in the middle of value, and value grows
+  auto updateStr = baseStr;
+  updateStr.replace(2000, 4, "bbbbbbbb");
+  thrift::Value update = createThriftValue(2, "node1", updateStr, 3600, 1);
+
+  auto delta = KvStore::createValueDelta(base, update);
+  ASSERT_TRUE(delta.has_value());
+  EXPECT_EQ(1, delta->baseVersion);
+  EXPECT_EQ(base.hash.value(), delta->baseHash);
+  EXPECT_EQ(2000, delta->prefixLength);
+  EXPECT_EQ(2092, delta->suffixLength);
+  EXPECT_EQ("bbbbbbbb", delta->middle);
+
+  thrift::Value rcvd = update;
+  rcvd.value.reset();
+  rcvd.delta_ref() = *delta;
+  EXPECT_TRUE(KvStore::applyValueDelta(base, rcvd));
+  EXPECT_EQ(updateStr, rcvd.value.value());
+  EXPECT_FALSE(rcvd.delta_ref().has_value());
+
+  // Delta can't be applied to any other base
+  rcvd.value.reset();
+  rcvd.delta_ref() = *delta;
+  thrift::Value otherBase = createThriftValue(1, "node1", updateStr, 3600, 1);
+  EXPECT_FALSE(KvStore::applyValueDelta(otherBase, rcvd));
+  otherBase = base;
+  otherBase.originatorId = "node2";
+  EXPECT_FALSE(KvStore::applyValueDelta(otherBase, rcvd));
+
+  // No delta for small values, unrelated values or mostly different values
+  EXPECT_FALSE(KvStore::createValueDelta(
+                   createThriftValue(1, "node1", "value1", 3600, 1),
+                   createThriftValue(2, "node1", "value2", 3600, 1))
+                   .has_value());
+  update.originatorId = "node2";
+  EXPECT_FALSE(KvStore::createValueDelta(base, update).has_value());
+  EXPECT_FALSE(KvStore::createValueDelta(
+                   base,
+                   createThriftValue(
+                       2, "node1", std::string(4096, 'b'), 3600, 1))
+                   .has_value());
+}
+
+//
+// Test compressPublication and decompressPublication methods
+//
+TEST(KvStore, compressPublicationTest) {
+  thrift::Publication pub;
+  for (int i = 0; i < 100; ++i) {
+    pub.keyVals.emplace(
+        folly::sformat("key{}", i),
+        createThriftValue(1, "node1", std::string(100, 'a'), 3600, 1));
+  }
+  pub.tobeUpdatedKeys = std::vector<std::string>{"key100"};
+
+  // Not compressed if requester doesn't accept any supported compression
+  auto uncompressed = KvStore::compressPublication(
+      thrift::Publication(pub), {thrift::CompressionType::NONE});
+  EXPECT_FALSE(uncompressed.compressedPublication_ref().has_value());
+  EXPECT_EQ(pub, uncompressed);
+
+  for (auto compression : KvStore::getSupportedCompressions()) {
+    auto compressed =
+        KvStore::compressPublication(thrift::Publication(pub), {compression});
+    ASSERT_TRUE(compressed.compressedPublication_ref().has_value());
+    EXPECT_EQ(compression, compressed.compression_ref().value());
+    EXPECT_TRUE(compressed.keyVals.empty());
+    EXPECT_FALSE(compressed.tobeUpdatedKeys.has_value());
+
+    auto decompressed = KvStore::decompressPublication(compressed);
+    ASSERT_TRUE(decompressed.has_value());
+    EXPECT_EQ(pub, *decompressed);
+
+    // Small publications are not compressed
+    thrift::Publication smallPub;
+    smallPub.keyVals.emplace("key1", pub.keyVals.at("key1"));
+    auto smallCompressed =
+        KvStore::compressPublication(std::move(smallPub), {compression});
+    EXPECT_FALSE(smallCompressed.compressedPublication_ref().has_value());
+
+    // Corrupted publication
+    compressed.compressedPublication_ref()->resize(10);
+    EXPECT_FALSE(KvStore::decompressPublication(compressed).has_value());
+  }
+}
+
 //
 // Test counter reporting
 //
@@ -597,6 +847,7 @@ TEST_F(KvStoreTestFixture, CounterReport) {
 
   // Wait till counters updated
   std::this_thread::sleep_for(std::chrono::milliseconds(counterUpdateWaitTime));
+  StatCounter::flushAll();
   auto counters = fb303::fbData->getCounters();
 
   // Verify the counter keys exist
@@ -616,6 +867,8 @@ TEST_F(KvStoreTestFixture, CounterReport) {
   ASSERT_EQ(1, counters.count("kvstore.cmd_hash_dump.count"));
   ASSERT_EQ(1, counters.count("kvstore.cmd_key_dump.count"));
   ASSERT_EQ(1, counters.count("kvstore.cmd_key_get.count"));
+  ASSERT_EQ(1, counters.count("kvstore.sent_dual_messages.sum"));
+  ASSERT_EQ(1, counters.count("kvstore.sent_dual_packets.count"));
   ASSERT_EQ(1, counters.count("kvstore.sent_key_vals.sum"));
   ASSERT_EQ(1, counters.count("kvstore.sent_publications.count"));
   // Verify the value of counter keys
@@ -635,6 +888,8 @@ TEST_F(KvStoreTestFixture, CounterReport) {
   EXPECT_EQ(0, counters.at("kvstore.cmd_hash_dump.count"));
   EXPECT_EQ(0, counters.at("kvstore.cmd_key_dump.count"));
   EXPECT_EQ(0, counters.at("kvstore.cmd_key_get.count"));
+  EXPECT_EQ(0, counters.at("kvstore.sent_dual_messages.sum"));
+  EXPECT_EQ(0, counters.at("kvstore.sent_dual_packets.count"));
   EXPECT_EQ(0, counters.at("kvstore.sent_key_vals.sum"));
   EXPECT_EQ(0, counters.at("kvstore.sent_publications.count"));
 
@@ -681,6 +936,61 @@ TEST_F(KvStoreTestFixture, CounterReport) {
  * - Correct TTL reflects back in GET/KEY_DUMP/KEY_HASH
  * - Applying ttl updates reflects properly
  */
+//
+// Verify key prefix filtered dumps, served from ordered key index for plain
+// prefixes and by matching every key otherwise
+//
+TEST_F(KvStoreTestFixture, PrefixFilterDump) {
+  const thrift::Value value(
+      apache::thrift::FRAGILE,
+      1, /* version */
+      "node1", /* node id */
+      "dummyValue",
+      Constants::kTtlInfinity, /* ttl */
+      0 /* ttl version */,
+      0 /* hash */);
+
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto kvStore = createKvStore("test", emptyPeers);
+  kvStore->run();
+
+  for (auto const& key : {"adj:1", "adj:2", "adjx", "prefix:1", "other"}) {
+    EXPECT_TRUE(kvStore->setKey(key, value));
+  }
+
+  auto getKeys = [](std::unordered_map<std::string, thrift::Value> const& kvs) {
+    std::set<std::string> keys;
+    for (auto const& kv : kvs) {
+      keys.emplace(kv.first);
+    }
+    return keys;
+  };
+
+  EXPECT_EQ(
+      std::set<std::string>({"adj:1", "adj:2"}),
+      getKeys(kvStore->dumpAll(KvStoreFilters({"adj:"}, {}))));
+  // overlapping prefixes
+  EXPECT_EQ(
+      std::set<std::string>({"adj:1", "adj:2", "adjx"}),
+      getKeys(kvStore->dumpAll(KvStoreFilters({"adj:", "adj"}, {}))));
+  EXPECT_EQ(
+      std::set<std::string>({"adj:1", "prefix:1"}),
+      getKeys(kvStore->dumpAll(KvStoreFilters({"prefix:", "adj:1"}, {}))));
+  EXPECT_EQ(
+      std::set<std::string>(),
+      getKeys(kvStore->dumpAll(KvStoreFilters({"zzz"}, {}))));
+  // regex prefix
+  EXPECT_EQ(
+      std::set<std::string>({"adj:2", "adjx"}),
+      getKeys(kvStore->dumpAll(KvStoreFilters({"adj(:2|x)"}, {}))));
+  // hash dump
+  EXPECT_EQ(
+      std::set<std::string>({"prefix:1"}),
+      getKeys(kvStore->dumpHashes("prefix:")));
+
+  kvStore->stop();
+}
+
 TEST_F(KvStoreTestFixture, TtlVerification) {
   const std::string key{"dummyKey"};
   const thrift::Value value(
@@ -1192,6 +1502,46 @@ TEST_F(KvStoreTestFixture, PeerSyncTtlExpiry) {
   EXPECT_GE(kTtlMs, maybeThriftVal.value().ttl);
 }
 
+//
+// Completion of first full-sync is signalled once to local readers, after
+// synced keys
+//
+TEST_F(KvStoreTestFixture, InitialSyncDone) {
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto store0 = createKvStore("store0", emptyPeers);
+  auto store1 = createKvStore("store1", emptyPeers);
+  store0->run();
+  store1->run();
+
+  EXPECT_TRUE(
+      store0->setKey("key1", createThriftValue(1, "store0", "value1")));
+  EXPECT_TRUE(store1->addPeer(store0->nodeId, store0->getPeerSpec()));
+
+  bool keyReceived{false};
+  while (true) {
+    auto publication = store1->recvPublication();
+    keyReceived |= publication.keyVals.count("key1") > 0;
+    if (publication.initialSyncDone_ref().value_or(false)) {
+      break;
+    }
+  }
+  EXPECT_TRUE(keyReceived);
+
+  // sync with further peers is not signalled again
+  auto store2 = createKvStore("store2", emptyPeers);
+  store2->run();
+  EXPECT_TRUE(store1->addPeer(store2->nodeId, store2->getPeerSpec()));
+  EXPECT_TRUE(
+      store2->setKey("key2", createThriftValue(1, "store2", "value2")));
+  while (true) {
+    auto publication = store1->recvPublication();
+    EXPECT_FALSE(publication.initialSyncDone_ref().has_value());
+    if (publication.keyVals.count("key2")) {
+      break;
+    }
+  }
+}
+
 /**
  * Test to verify PEER_ADD/PEER_DEL and verify that keys are synchronized
  * to the neighbor.
@@ -1783,6 +2133,128 @@ TEST_F(KvStoreTestFixture, DualTest) {
   validateAllRootsUpCase();
 }
 
+/**
+ * 2 x 2 Fabric topology as above, with flood root load balancing enabled
+ * verify keys originated by n0 reach n1 down spanning trees of both roots
+ */
+TEST_F(KvStoreTestFixture, FloodRootLoadBalancing) {
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+
+  auto floodRootConf = getTestKvConf();
+  floodRootConf.enable_flood_optimization_ref() = true;
+  floodRootConf.enable_flood_root_load_balancing_ref() = true;
+  floodRootConf.is_flood_root_ref() = true;
+
+  auto nonFloodRootConf = getTestKvConf();
+  nonFloodRootConf.enable_flood_optimization_ref() = true;
+  nonFloodRootConf.enable_flood_root_load_balancing_ref() = true;
+  nonFloodRootConf.is_flood_root_ref() = false;
+
+  auto r0 = createKvStore("r0", emptyPeers, floodRootConf);
+  auto r1 = createKvStore("r1", emptyPeers, floodRootConf);
+  auto n0 = createKvStore("n0", emptyPeers, nonFloodRootConf);
+  auto n1 = createKvStore("n1", emptyPeers, nonFloodRootConf);
+
+  r0->run();
+  r1->run();
+  n0->run();
+  n1->run();
+
+  for (auto root : {r0, r1}) {
+    for (auto node : {n0, n1}) {
+      EXPECT_TRUE(root->addPeer(node->nodeId, node->getPeerSpec()));
+      EXPECT_TRUE(node->addPeer(root->nodeId, root->getPeerSpec()));
+    }
+  }
+
+  // let kvstore dual sync
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  EXPECT_EQ(*n0->getFloodTopo().floodRootId_ref(), "r0");
+
+  // originate keys on n0
+  const size_t kNumKeys = 32;
+  std::unordered_set<std::string> pendingKeys;
+  std::vector<std::pair<std::string, thrift::Value>> keyVals;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    const auto key = folly::sformat("key{}", i);
+    pendingKeys.emplace(key);
+    keyVals.emplace_back(key, createThriftValue(1, "n0", std::string("value")));
+  }
+  EXPECT_TRUE(n0->setKeys(keyVals));
+
+  // collect flood roots of keys as received by n1
+  std::unordered_set<std::string> floodRootIds;
+  while (not pendingKeys.empty()) {
+    const auto pub = n1->recvPublication();
+    for (const auto& kv : pub.keyVals) {
+      if (pendingKeys.erase(kv.first) and pub.floodRootId.has_value()) {
+        floodRootIds.emplace(pub.floodRootId.value());
+      }
+    }
+  }
+  EXPECT_EQ(floodRootIds, (std::unordered_set<std::string>{"r0", "r1"}));
+}
+
+/**
+ * Restart a kvstore with snapshot enabled and verify that it starts with keys
+ * of its previous run, with TTLs counted down
+ */
+TEST_F(KvStoreTestFixture, SnapshotWarmRestart) {
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  const auto snapshotPath =
+      folly::sformat("/tmp/kvstore_snapshot_test_{}", tid);
+  const auto snapshotFile = folly::sformat(
+      "{}.{}", snapshotPath, thrift::KvStore_constants::kDefaultArea());
+  std::remove(snapshotFile.c_str());
+
+  auto conf = getTestKvConf();
+  conf.snapshot_filepath_ref() = snapshotPath;
+  conf.snapshot_interval_s_ref() = 1;
+
+  const int64_t ttl = 60000;
+  const auto value1 = createThriftValue(1, "node1", std::string("value1"), ttl);
+  const auto value2 = createThriftValue(
+      1, "node1", std::string("value2"), Constants::kTtlInfinity);
+
+  {
+    auto store = createKvStore("store1", emptyPeers, conf);
+    store->run();
+    EXPECT_TRUE(store->setKey("key1", value1));
+    EXPECT_TRUE(store->setKey("key2", value2));
+
+    // wait for snapshot to be saved
+    std::string data;
+    while (not folly::readFile(snapshotFile.c_str(), data)) {
+      /* sleep override */
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    store->stop();
+    stores_.pop_back();
+  }
+
+  // Restarted store publishes keys of snapshot on start
+  auto store = createKvStore("store1", emptyPeers, conf);
+  store->run();
+  const auto pub = store->recvPublication();
+  EXPECT_EQ(2, pub.keyVals.size());
+
+  const auto restored1 = store->getKey("key1");
+  ASSERT_TRUE(restored1.has_value());
+  EXPECT_EQ(value1.value, restored1->value);
+  EXPECT_EQ(value1.version, restored1->version);
+  EXPECT_LT(restored1->ttl, ttl);
+  EXPECT_GT(restored1->ttl, 0);
+
+  const auto restored2 = store->getKey("key2");
+  ASSERT_TRUE(restored2.has_value());
+  EXPECT_EQ(value2.value, restored2->value);
+  EXPECT_EQ(Constants::kTtlInfinity, restored2->ttl);
+
+  std::remove(snapshotFile.c_str());
+}
+
 /**
  * Perform KvStore synchronization test on full mesh.
  */
@@ -2475,6 +2947,418 @@ TEST_F(KvStoreTestFixture, TtlDecrementValue) {
   }
 }
 
+/**
+ * Verify TTL refreshes flooded in batches are merged by peers just like TTL
+ * refreshes flooded as values
+ */
+TEST_F(KvStoreTestFixture, BatchedTtlUpdates) {
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto kvConf = getTestKvConf();
+  kvConf.enable_ttl_update_batching_ref() = true;
+  auto store0 = createKvStore("store0", emptyPeers, kvConf);
+  auto store1 = createKvStore("store1", emptyPeers, kvConf);
+  store0->run();
+  store1->run();
+
+  store0->addPeer(store1->nodeId, store1->getPeerSpec());
+  store1->addPeer(store0->nodeId, store0->getPeerSpec());
+
+  thrift::Value thriftVal(
+      apache::thrift::FRAGILE,
+      1 /* version */,
+      "store1" /* originatorId */,
+      "value" /* value */,
+      60000 /* ttl */,
+      1 /* ttl version */,
+      0 /* hash */);
+  EXPECT_TRUE(store1->setKey("key1", thriftVal));
+  {
+    auto pub = store0->recvPublication();
+    ASSERT_EQ(1, pub.keyVals.count("key1"));
+    EXPECT_EQ(1, pub.keyVals.at("key1").ttlVersion);
+  }
+
+  // Refresh TTL of key on store1
+  thrift::Value ttlVal = thriftVal;
+  ttlVal.value.reset();
+  ttlVal.ttlVersion = 2;
+  EXPECT_TRUE(store1->setKey("key1", ttlVal));
+  {
+    auto pub = store0->recvPublication();
+    ASSERT_EQ(1, pub.keyVals.count("key1"));
+    EXPECT_FALSE(pub.keyVals.at("key1").value.has_value());
+    EXPECT_EQ(2, pub.keyVals.at("key1").ttlVersion);
+  }
+
+  // Value is retained with refreshed TTL
+  auto getRes = store0->getKey("key1");
+  ASSERT_TRUE(getRes.has_value());
+  EXPECT_EQ("value", getRes->value_ref().value());
+  EXPECT_EQ(2, getRes->ttlVersion);
+}
+
+/**
+ * Verify large values flooded as delta are reconstructed by peers, and that
+ * peer lacking base version of delta learns value with full-sync
+ */
+TEST_F(KvStoreTestFixture, ValueDeltaFlooding) {
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto kvConf = getTestKvConf();
+  kvConf.enable_value_delta_encoding_ref() = true;
+  // no periodic full-sync during test
+  kvConf.sync_interval_s = 3600;
+  auto store0 = createKvStore("store0", emptyPeers, kvConf);
+  auto store1 = createKvStore("store1", emptyPeers, kvConf);
+  store0->run();
+  store1->run();
+
+  store0->addPeer(store1->nodeId, store1->getPeerSpec());
+  store1->addPeer(store0->nodeId, store0->getPeerSpec());
+
+  std::string valueStr(4096, 'a');
+  auto setValue = [&](int64_t version,
+                      std::optional<std::vector<std::string>> nodeIds =
+                          std::nullopt) {
+    valueStr.at(version) = 'b';
+    return store1->setKey(
+        "key1",
+        createThriftValue(version, "store1", valueStr, 60000, 1),
+        std::move(nodeIds));
+  };
+
+  EXPECT_TRUE(setValue(1));
+  {
+    auto pub = store0->recvPublication();
+    ASSERT_EQ(1, pub.keyVals.count("key1"));
+    EXPECT_EQ(valueStr, pub.keyVals.at("key1").value.value());
+  }
+
+  // Update is flooded as delta. Local readers get full value
+  EXPECT_TRUE(setValue(2));
+  {
+    auto pub = store0->recvPublication();
+    ASSERT_EQ(1, pub.keyVals.count("key1"));
+    EXPECT_EQ(2, pub.keyVals.at("key1").version);
+    EXPECT_EQ(valueStr, pub.keyVals.at("key1").value.value());
+    EXPECT_FALSE(pub.keyVals.at("key1").delta_ref().has_value());
+  }
+  {
+    auto getRes = store0->getKey("key1");
+    ASSERT_TRUE(getRes.has_value());
+    EXPECT_EQ(valueStr, getRes->value.value());
+    EXPECT_EQ(store1->getKey("key1")->hash, getRes->hash);
+  }
+
+  // Update version 3 on store1 only, as if received from store0
+  EXPECT_TRUE(setValue(3, std::vector<std::string>{"store0"}));
+  auto base = store1->getKey("key1");
+  ASSERT_TRUE(base.has_value());
+
+  // Delta against version 3 can't be applied by store0, which full-syncs
+  // with store1 and learns version 3 instead
+  auto update = createThriftValue(4, "store1", valueStr + "b", 60000, 1);
+  auto delta = KvStore::createValueDelta(*base, update);
+  ASSERT_TRUE(delta.has_value());
+  update.value.reset();
+  update.delta_ref() = std::move(*delta);
+  EXPECT_TRUE(store0->setKey(
+      "key1", update, std::vector<std::string>{"store2", "store1"}));
+  {
+    auto pub = store0->recvPublication();
+    ASSERT_EQ(1, pub.keyVals.count("key1"));
+    EXPECT_EQ(3, pub.keyVals.at("key1").version);
+    EXPECT_EQ(valueStr, pub.keyVals.at("key1").value.value());
+  }
+}
+
+/**
+ * Verify copies of an update received from several peers are dropped as
+ * duplicates before merge, in a triangle of stores
+ */
+TEST_F(KvStoreTestFixture, DropDuplicateKeyVals) {
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto kvConf = getTestKvConf();
+  // no periodic full-sync during test
+  kvConf.sync_interval_s = 3600;
+  std::vector<KvStoreWrapper*> stores;
+  for (int i = 0; i < 3; ++i) {
+    stores.push_back(createKvStore(getNodeId("store", i), emptyPeers, kvConf));
+    stores.back()->run();
+  }
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      if (i != j) {
+        EXPECT_TRUE(
+            stores[i]->addPeer(stores[j]->nodeId, stores[j]->getPeerSpec()));
+      }
+    }
+  }
+  // let initial full-sync complete
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  auto oldCounters = fb303::fbData->getCounters();
+  const auto thriftVal =
+      createThriftValue(1 /* version */, "store0", std::string("value1"));
+  EXPECT_TRUE(stores[0]->setKey("key1", thriftVal));
+
+  // each of store1 and store2 gets the update from both other stores
+  for (int i = 1; i < 3; ++i) {
+    auto pub = stores[i]->recvPublication();
+    EXPECT_EQ(1, pub.keyVals.count("key1"));
+  }
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  auto newCounters = fb303::fbData->getCounters();
+  EXPECT_LT(
+      oldCounters["kvstore.received_duplicate_key_vals.sum"],
+      newCounters["kvstore.received_duplicate_key_vals.sum"]);
+  for (auto& store : stores) {
+    auto maybeThriftVal = store->getKey("key1");
+    ASSERT_TRUE(maybeThriftVal.has_value());
+    EXPECT_EQ(thriftVal.value, maybeThriftVal->value);
+  }
+}
+
+/**
+ * Verify publications flooded down a chain carry only last hops of flood path
+ * with compact flood path, and that stores of a ring still converge
+ */
+TEST_F(KvStoreTestFixture, CompactFloodPath) {
+  const unsigned int kNumStores = 8;
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto kvConf = getTestKvConf();
+  kvConf.enable_compact_flood_path_ref() = true;
+  // no periodic full-sync during test
+  kvConf.sync_interval_s = 3600;
+
+  std::vector<KvStoreWrapper*> stores;
+  for (unsigned int i = 0; i < kNumStores; ++i) {
+    stores.push_back(createKvStore(getNodeId("store", i), emptyPeers, kvConf));
+    stores.back()->run();
+  }
+
+  // Ring topology, loops are longer than carried flood path
+  for (unsigned int i = 0; i < kNumStores; ++i) {
+    auto& store = stores[i];
+    auto& nextStore = stores[(i + 1) % kNumStores];
+    EXPECT_TRUE(store->addPeer(nextStore->nodeId, nextStore->getPeerSpec()));
+    EXPECT_TRUE(nextStore->addPeer(store->nodeId, store->getPeerSpec()));
+  }
+  // let initial full-sync complete, so that key is learnt by flooding only
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  const auto thriftVal = createThriftValue(
+      1 /* version */, "store0", std::string("value1"));
+  EXPECT_TRUE(stores[0]->setKey("key1", thriftVal));
+
+  // Publication reaching far end of ring carries last hops only
+  const auto& farStore = stores[kNumStores / 2];
+  while (true) {
+    auto pub = farStore->recvPublication();
+    if (not pub.keyVals.count("key1")) {
+      continue;
+    }
+    ASSERT_TRUE(pub.nodeIds.has_value());
+    EXPECT_EQ(Constants::kKvStoreCompactFloodPathLen, pub.nodeIds->size());
+    break;
+  }
+
+  for (auto& store : stores) {
+    auto maybeThriftVal = store->getKey("key1");
+    ASSERT_TRUE(maybeThriftVal.has_value());
+    EXPECT_EQ(thriftVal.value, maybeThriftVal->value);
+    EXPECT_EQ(thriftVal.version, maybeThriftVal->version);
+  }
+}
+
+/**
+ * Verify publications flooded down a chain carry flood time of every hop along
+ * with flood path when flood tracing is enabled
+ */
+TEST_F(KvStoreTestFixture, FloodTracing) {
+  const unsigned int kNumStores = 3;
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto kvConf = getTestKvConf();
+  kvConf.enable_flood_tracing_ref() = true;
+  // no periodic full-sync during test
+  kvConf.sync_interval_s = 3600;
+
+  std::vector<KvStoreWrapper*> stores;
+  for (unsigned int i = 0; i < kNumStores; ++i) {
+    stores.push_back(createKvStore(getNodeId("store", i), emptyPeers, kvConf));
+    stores.back()->run();
+  }
+  for (unsigned int i = 0; i + 1 < kNumStores; ++i) {
+    auto& store = stores[i];
+    auto& nextStore = stores[i + 1];
+    EXPECT_TRUE(store->addPeer(nextStore->nodeId, nextStore->getPeerSpec()));
+    EXPECT_TRUE(nextStore->addPeer(store->nodeId, store->getPeerSpec()));
+  }
+  // let initial full-sync complete, so that key is learnt by flooding only
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  const auto thriftVal = createThriftValue(
+      1 /* version */, "store0", std::string("value1"));
+  EXPECT_TRUE(stores[0]->setKey("key1", thriftVal));
+
+  const auto& lastStore = stores[kNumStores - 1];
+  while (true) {
+    auto pub = lastStore->recvPublication();
+    if (not pub.keyVals.count("key1")) {
+      continue;
+    }
+    ASSERT_TRUE(pub.nodeIds.has_value());
+    ASSERT_TRUE(pub.floodTimestampsMs_ref().has_value());
+    ASSERT_EQ(kNumStores, pub.nodeIds->size());
+    ASSERT_EQ(kNumStores, pub.floodTimestampsMs_ref()->size());
+    for (unsigned int i = 0; i < kNumStores; ++i) {
+      EXPECT_EQ(getNodeId("store", i), pub.nodeIds->at(i));
+      EXPECT_LT(0, pub.floodTimestampsMs_ref()->at(i));
+      if (i > 0) {
+        EXPECT_LE(
+            pub.floodTimestampsMs_ref()->at(i - 1),
+            pub.floodTimestampsMs_ref()->at(i));
+      }
+    }
+    break;
+  }
+}
+
+/**
+ * Verify only sampled publications are traced, and flood delays of traced
+ * ones are exported per originator and per peer
+ */
+TEST_F(KvStoreTestFixture, FloodTracingSampling) {
+  const unsigned int kNumStores = 3;
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto kvConf = getTestKvConf();
+  kvConf.enable_flood_tracing_ref() = true;
+  kvConf.flood_tracing_sample_rate_ref() = 2;
+  // no periodic full-sync during test
+  kvConf.sync_interval_s = 3600;
+
+  std::vector<KvStoreWrapper*> stores;
+  for (unsigned int i = 0; i < kNumStores; ++i) {
+    stores.push_back(
+        createKvStore(getNodeId("sampledStore", i), emptyPeers, kvConf));
+    stores.back()->run();
+  }
+  for (unsigned int i = 0; i + 1 < kNumStores; ++i) {
+    auto& store = stores[i];
+    auto& nextStore = stores[i + 1];
+    EXPECT_TRUE(store->addPeer(nextStore->nodeId, nextStore->getPeerSpec()));
+    EXPECT_TRUE(nextStore->addPeer(store->nodeId, store->getPeerSpec()));
+  }
+  // let initial full-sync complete, so that keys are learnt by flooding only
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  // one in two publications originated by first store is traced
+  const auto& lastStore = stores[kNumStores - 1];
+  std::vector<bool> isTraced;
+  for (int i = 0; i < 4; ++i) {
+    const auto key = folly::sformat("key{}", i);
+    EXPECT_TRUE(stores[0]->setKey(
+        key,
+        createThriftValue(
+            1 /* version */, stores[0]->nodeId, std::string("value"))));
+    while (true) {
+      auto pub = lastStore->recvPublication();
+      if (not pub.keyVals.count(key)) {
+        continue;
+      }
+      isTraced.push_back(pub.floodTimestampsMs_ref().has_value());
+      if (isTraced.back()) {
+        EXPECT_EQ(kNumStores, pub.floodTimestampsMs_ref()->size());
+      }
+      break;
+    }
+  }
+  EXPECT_EQ(2, std::count(isTraced.begin(), isTraced.end(), true));
+  for (size_t i = 1; i < isTraced.size(); ++i) {
+    EXPECT_NE(isTraced[i - 1], isTraced[i]);
+  }
+
+  auto counters = fb303::fbData->getCounters();
+  for (const auto& key :
+       {"kvstore.flood_delay_ms.sampledStore0.p50.60",
+        "kvstore.flood_hop_delay_ms.sampledStore0.p50.60",
+        "kvstore.flood_hop_delay_ms.sampledStore1.p50.60"}) {
+    EXPECT_EQ(1, counters.count(key)) << key;
+  }
+  EXPECT_EQ(0, counters.count("kvstore.flood_delay_ms.sampledStore1.p50.60"));
+}
+
+/**
+ * Verify updates are flooded over thrift to peer advertising its thrift port,
+ * and over ZMQ once its thrift port becomes unreachable
+ */
+TEST_F(KvStoreTestFixture, ThriftFlooding) {
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto kvConf = getTestKvConf();
+  kvConf.enable_thrift_flooding_ref() = true;
+  // no periodic full-sync during test
+  kvConf.sync_interval_s = 3600;
+  auto store0 = createKvStore("store0", emptyPeers, kvConf);
+  auto store1 = createKvStore("store1", emptyPeers, kvConf);
+  store0->run();
+  store1->run();
+
+  auto thriftServer1 = std::make_shared<OpenrThriftServerWrapper>(
+      store1->nodeId,
+      nullptr /* decision */,
+      nullptr /* fib */,
+      store1->getKvStore() /* kvStore */,
+      nullptr /* linkMonitor */,
+      nullptr /* configStore */,
+      nullptr /* prefixManager */,
+      nullptr /* config */,
+      MonitorSubmitUrl{"inproc://monitor_submit"},
+      context);
+  thriftServer1->run();
+
+  auto peerSpec1 = store1->getPeerSpec();
+  peerSpec1.thriftPortUrl = folly::sformat(
+      "tcp://[::1]:{}", thriftServer1->getOpenrCtrlThriftPort());
+  store0->addPeer(store1->nodeId, peerSpec1);
+  store1->addPeer(store0->nodeId, store0->getPeerSpec());
+  EXPECT_EQ(1, store0->getCounters().at("kvstore.thrift.num_flood_peers"));
+  EXPECT_EQ(0, store1->getCounters().at("kvstore.thrift.num_flood_peers"));
+
+  auto waitForKey = [&](std::string const& key) {
+    while (true) {
+      auto pub = store1->recvPublication();
+      if (pub.keyVals.count(key)) {
+        return;
+      }
+    }
+  };
+
+  auto oldCounters = fb303::fbData->getCounters();
+  EXPECT_TRUE(store0->setKey(
+      "key1", createThriftValue(1, "store0", std::string("value1"))));
+  waitForKey("key1");
+  EXPECT_EQ("value1", store1->getKey("key1")->value.value());
+  auto newCounters = fb303::fbData->getCounters();
+  EXPECT_LT(
+      oldCounters["kvstore.thrift.num_flood_requests.count"],
+      newCounters["kvstore.thrift.num_flood_requests.count"]);
+
+  // Request over thrift fails and is sent over ZMQ instead
+  thriftServer1->stop();
+  EXPECT_TRUE(store0->setKey(
+      "key2", createThriftValue(1, "store0", std::string("value2"))));
+  waitForKey("key2");
+  EXPECT_EQ("value2", store1->getKey("key2")->value.value());
+  newCounters = fb303::fbData->getCounters();
+  EXPECT_LT(
+      oldCounters["kvstore.thrift.num_flood_failures.count"],
+      newCounters["kvstore.thrift.num_flood_failures.count"]);
+}
+
 /**
  * Test kvstore-consistency with flooding rate-limiter enabled
  * linear topology, intentionlly increate db-sync interval from 1s -> 60s so
@@ -2552,6 +3436,127 @@ TEST_F(KvStoreTestFixture, RateLimiterFlood) {
   EXPECT_EQ(expectNumKeys, kv2.size());
 }
 
+/**
+ * Verify adjacency keys pending in adaptive rate limiter are flooded ahead of
+ * other pending keys, which wait for a token of their own
+ */
+TEST_F(KvStoreTestFixture, AdaptiveRateLimiterPriority) {
+  auto rateLimitConf = getTestKvConf();
+  thrift::KvstoreFloodRate floodRate;
+  floodRate.flood_msg_per_sec = 1;
+  floodRate.flood_msg_burst_size = 1;
+  floodRate.adaptive_ref() = true;
+  rateLimitConf.flood_rate_ref() = floodRate;
+
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto store0 = createKvStore("store0", emptyPeers);
+  auto store1 = createKvStore("store1", emptyPeers, rateLimitConf);
+  store0->run();
+  store1->run();
+
+  store0->addPeer(store1->nodeId, store1->getPeerSpec());
+  store1->addPeer(store0->nodeId, store0->getPeerSpec());
+
+  const auto setKey = [&](std::string const& key) {
+    EXPECT_TRUE(store1->setKey(
+        key, createThriftValue(1, "store1", "value", 300000, 1)));
+  };
+  const auto recvKeys = [&]() {
+    std::set<std::string> keys;
+    for (auto const& kv : store0->recvPublication().keyVals) {
+      keys.emplace(kv.first);
+    }
+    return keys;
+  };
+
+  // First publication consumes the only token
+  setKey("prefix:1");
+  EXPECT_EQ(std::set<std::string>{"prefix:1"}, recvKeys());
+
+  // Rest is buffered. Adjacency goes out first, on its own
+  setKey("prefix:2");
+  setKey("prefix:3");
+  setKey("adj:1");
+  EXPECT_EQ(std::set<std::string>{"adj:1"}, recvKeys());
+  EXPECT_EQ((std::set<std::string>{"prefix:2", "prefix:3"}), recvKeys());
+}
+
+/**
+ * Verify keys of full-sync response are merged in order of their configured
+ * priority classes
+ */
+TEST_F(KvStoreTestFixture, FullSyncKeyPriority) {
+  auto kvConf = getTestKvConf();
+  kvConf.key_priority_prefixes_ref() =
+      std::vector<std::string>{"high:", "medium:"};
+
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto store0 = createKvStore("store0", emptyPeers, kvConf);
+  auto store1 = createKvStore("store1", emptyPeers, kvConf);
+  store0->run();
+  store1->run();
+
+  for (auto const& key : {"low:1", "medium:1", "high:1", "high:2"}) {
+    EXPECT_TRUE(store1->setKey(
+        key, createThriftValue(1, "store1", "value", 300000, 1)));
+  }
+
+  // store0 learns keys of store1 with full-sync
+  store0->addPeer(store1->nodeId, store1->getPeerSpec());
+  const auto recvKeys = [&]() {
+    std::set<std::string> keys;
+    for (auto const& kv : store0->recvPublication().keyVals) {
+      keys.emplace(kv.first);
+    }
+    return keys;
+  };
+  EXPECT_EQ((std::set<std::string>{"high:1", "high:2"}), recvKeys());
+  EXPECT_EQ(std::set<std::string>{"medium:1"}, recvKeys());
+  EXPECT_EQ(std::set<std::string>{"low:1"}, recvKeys());
+}
+
+/**
+ * Full-sync response larger than a chunk is streamed in chunks. All of them
+ * are merged, and keys which are better or missing on responder are sent back
+ * once the last chunk arrives.
+ */
+TEST_F(KvStoreTestFixture, FullSyncChunks) {
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto store0 = createKvStore("store0", emptyPeers);
+  auto store1 = createKvStore("store1", emptyPeers);
+  store0->run();
+  store1->run();
+
+  const int numKeys = 2 * Constants::kKvStoreSyncChunkKeyVals + 1;
+  std::vector<std::pair<std::string, thrift::Value>> keyVals;
+  for (int i = 0; i < numKeys; ++i) {
+    keyVals.emplace_back(
+        folly::sformat("key{}", i),
+        createThriftValue(1, "store1", "value", 300000, 1));
+  }
+  EXPECT_TRUE(store1->setKeys(keyVals));
+  EXPECT_EQ(numKeys, store1->recvPublication().keyVals.size());
+
+  // one key better on store0, one key only on store0
+  EXPECT_TRUE(
+      store0->setKey("key0", createThriftValue(2, "store0", "value", 300000)));
+  EXPECT_TRUE(
+      store0->setKey("local", createThriftValue(1, "store0", "value", 300000)));
+
+  store0->addPeer(store1->nodeId, store1->getPeerSpec());
+
+  // store1 gets both keys back with finalization of full-sync
+  std::set<std::string> keys;
+  while (not keys.count("key0") or not keys.count("local")) {
+    for (auto const& kv : store1->recvPublication().keyVals) {
+      keys.emplace(kv.first);
+    }
+  }
+  EXPECT_EQ(2, store1->getKey("key0")->version);
+  EXPECT_EQ(numKeys + 1, store0->dumpAll().size());
+  EXPECT_EQ(numKeys + 1, store1->dumpAll().size());
+}
+
 TEST_F(KvStoreTestFixture, RateLimiter) {
   fbzmq::Context context;
   fb303::fbData->resetAllData();
@@ -2836,6 +3841,101 @@ TEST_F(KvStoreTestFixture, FullSync) {
   EXPECT_EQ(v4->value_ref().value(), "b");
 }
 
+/**
+ * Full-sync of mostly identical stores. Only keys of mismatched key buckets
+ * are expected to be exchanged.
+ */
+TEST_F(KvStoreTestFixture, KeyBucketFullSync) {
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto storeA = createKvStore("storeA", emptyPeers);
+  auto storeB = createKvStore("storeB", emptyPeers);
+  storeA->run();
+  storeB->run();
+
+  auto createValue = [](int64_t version, std::string const& value) {
+    thrift::Value val(
+        apache::thrift::FRAGILE,
+        version,
+        "storeC" /* originatorId */,
+        value,
+        Constants::kTtlInfinity /* ttl */,
+        0 /* ttl version */,
+        0 /* hash */);
+    val.hash_ref() =
+        generateHash(val.version, val.originatorId, val.value_ref());
+    return val;
+  };
+
+  // set same key vals in both stores
+  const size_t kNumCommonKeys{1000};
+  std::vector<std::pair<std::string, thrift::Value>> commonKeyVals;
+  for (size_t i = 0; i < kNumCommonKeys; ++i) {
+    commonKeyVals.emplace_back(
+        folly::sformat("common-key-{}", i), createValue(1, "common"));
+  }
+  EXPECT_TRUE(storeA->setKeys(commonKeyVals));
+  EXPECT_TRUE(storeB->setKeys(commonKeyVals));
+
+  // storeA has key-a and better version of key-ab. storeB has nothing to
+  // offer, so that nothing is flooded back to it once storeA merges response
+  EXPECT_TRUE(storeA->setKey("key-a", createValue(1, "a")));
+  EXPECT_TRUE(storeA->setKey("key-ab", createValue(2, "a")));
+  EXPECT_TRUE(storeB->setKey("key-ab", createValue(1, "b")));
+
+  // store digests differ before full-sync
+  const auto digestKey = folly::sformat(
+      "kvstore.store_digest.{}", thrift::KvStore_constants::kDefaultArea());
+  EXPECT_NE(
+      storeA->getCounters().at(digestKey), storeB->getCounters().at(digestKey));
+
+  // B sends keys of mismatched buckets, i.e. common keys sharing bucket with
+  // key-a or key-ab and key-ab itself. A sends back key-a and key-ab
+  std::unordered_set<int32_t> mismatchedBuckets{
+      KvStore::getKeyBucket("key-a"), KvStore::getKeyBucket("key-ab")};
+  size_t numExpectedKeyVals{3};
+  for (auto const& kv : commonKeyVals) {
+    numExpectedKeyVals +=
+        mismatchedBuckets.count(KvStore::getKeyBucket(kv.first));
+  }
+
+  // let A sends a full sync request to B and wait for completion, i.e. until
+  // B publishes keys sent back by A in last step of 3-way sync
+  StatCounter::flushAll();
+  auto oldCounters = fb303::fbData->getCounters();
+  storeA->addPeer("storeB", storeB->getPeerSpec());
+  while (true) {
+    auto pub = storeB->recvPublication();
+    if (pub.keyVals.count("key-a")) {
+      EXPECT_EQ(2, pub.keyVals.size());
+      EXPECT_EQ(2, pub.keyVals.at("key-ab").version);
+      break;
+    }
+  }
+  StatCounter::flushAll();
+  auto newCounters = fb303::fbData->getCounters();
+
+  // both stores converge
+  auto dumpA = storeA->dumpAll();
+  auto dumpB = storeB->dumpAll();
+  EXPECT_EQ(kNumCommonKeys + 2, dumpA.size());
+  EXPECT_EQ(kNumCommonKeys + 2, dumpB.size());
+  for (auto const& key : {"key-a", "key-ab"}) {
+    ASSERT_EQ(1, dumpA.count(key));
+    ASSERT_EQ(1, dumpB.count(key));
+    EXPECT_EQ(dumpA.at(key).version, dumpB.at(key).version);
+    EXPECT_EQ(dumpA.at(key).value_ref(), dumpB.at(key).value_ref());
+  }
+  EXPECT_EQ(2, dumpB.at("key-ab").version);
+  EXPECT_EQ(
+      storeA->getCounters().at(digestKey), storeB->getCounters().at(digestKey));
+
+  // common keys are not exchanged, apart from the ones sharing bucket with
+  // mismatched keys
+  EXPECT_EQ(
+      oldCounters["kvstore.received_key_vals.sum"] + numExpectedKeyVals,
+      newCounters["kvstore.received_key_vals.sum"]);
+}
+
 /* Kvstore tests related to area */
 
 /* Verify flooding is containted within an area. Add a key in one area and
@@ -3114,7 +4214,7 @@ TEST_P(KvStoreRateLimitTestFixture, InitialSync) {
                            .value();
         EXPECT_EQ(thrift::Command::KEY_DUMP, request.cmd);
         ASSERT_TRUE(request.keyDumpParams_ref());
-        EXPECT_TRUE(request.keyDumpParams_ref()->keyValHashes_ref());
+        EXPECT_TRUE(request.keyDumpParams_ref()->keyBucketDigests_ref());
         // We must not have received the request before
         EXPECT_EQ(0, outstandingResponses.count(i));
 
@@ -3191,7 +4291,7 @@ TEST_F(KvStoreTestFixture, PeerAddUpdateRemoveWithFullSync) {
         msgs.at(2).readThriftObj<thrift::KvStoreRequest>(serializer).value();
     EXPECT_EQ(thrift::Command::KEY_DUMP, request.cmd);
     ASSERT_TRUE(request.keyDumpParams_ref());
-    EXPECT_TRUE(request.keyDumpParams_ref()->keyValHashes_ref());
+    EXPECT_TRUE(request.keyDumpParams_ref()->keyBucketDigests_ref());
   };
 
   //
@@ -3279,6 +4379,51 @@ TEST_F(KvStoreTestFixture, PeerAddUpdateRemoveWithFullSync) {
   EXPECT_EQ(0, store0->getCounters().at("kvstore.pending_full_sync"));
 }
 
+/**
+ * Verify keys expiring closely together are published in batch, and that
+ * originator left without any key is reported along with its last keys
+ */
+TEST_F(KvStoreTestFixture, TtlExpiryBatching) {
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto store = createKvStore("store0", emptyPeers);
+  store->run();
+
+  // keys of node-a expire 10ms apart, node-b keeps one key forever
+  std::vector<std::pair<std::string, thrift::Value>> keyVals;
+  keyVals.emplace_back(
+      "key1", createThriftValue(1, "node-a", std::string("value1"), 300));
+  keyVals.emplace_back(
+      "key2", createThriftValue(1, "node-a", std::string("value2"), 310));
+  keyVals.emplace_back(
+      "key3",
+      createThriftValue(
+          1, "node-b", std::string("value3"), Constants::kTtlInfinity));
+  keyVals.emplace_back(
+      "key4", createThriftValue(1, "node-b", std::string("value4"), 320));
+  EXPECT_TRUE(store->setKeys(keyVals));
+  EXPECT_EQ(4, store->recvPublication().keyVals.size());
+
+  // Without batching every key would expire in a pass of its own
+  std::set<std::string> expiredKeys;
+  std::vector<std::string> expiredOriginators;
+  size_t numPublications{0};
+  while (expiredKeys.size() < 3) {
+    auto publication = store->recvPublication();
+    ASSERT_TRUE(publication.keyVals.empty());
+    ++numPublications;
+    expiredKeys.insert(
+        publication.expiredKeys.begin(), publication.expiredKeys.end());
+    if (auto originators = publication.expiredOriginators_ref()) {
+      expiredOriginators.insert(
+          expiredOriginators.end(), originators->begin(), originators->end());
+    }
+  }
+  EXPECT_LE(numPublications, 2);
+  EXPECT_EQ(std::set<std::string>({"key1", "key2", "key4"}), expiredKeys);
+  EXPECT_EQ(std::vector<std::string>({"node-a"}), expiredOriginators);
+  EXPECT_TRUE(store->getKey("key3").has_value());
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -0,0 +1,175 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/kvstore/TtlCountdownWheel.h>
+
+using namespace std::chrono;
+
+namespace openr {
+
+namespace {
+
+const auto kStartTime = steady_clock::now();
+
+TtlCountdownQueueEntry
+createEntry(std::string const& key, milliseconds expiry) {
+  TtlCountdownQueueEntry entry;
+  entry.key = key;
+  entry.expiryTime = kStartTime + expiry;
+  entry.version = 1;
+  entry.originatorId = "node1";
+  return entry;
+}
+
+std::set<std::string>
+getKeys(std::vector<TtlCountdownQueueEntry> const& entries) {
+  std::set<std::string> keys;
+  for (auto const& entry : entries) {
+    keys.emplace(entry.key);
+  }
+  return keys;
+}
+
+} // namespace
+
+TEST(TtlCountdownWheelTest, ExpireInOrder) {
+  TtlCountdownWheel wheel(kStartTime);
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_FALSE(wheel.getNextEventTime().has_value());
+
+  // Expiries spanning all levels and beyond
+  wheel.upsert(createEntry("key1", 10ms));
+  wheel.upsert(createEntry("key2", 300s));
+  wheel.upsert(createEntry("key3", hours(24 * 10)));
+  wheel.upsert(createEntry("key4", hours(24 * 60)));
+  EXPECT_EQ(4, wheel.size());
+  EXPECT_EQ(kStartTime + 10ms, wheel.getNextEventTime());
+
+  EXPECT_TRUE(wheel.expire(kStartTime + 9ms).empty());
+  EXPECT_EQ(
+      std::set<std::string>{"key1"}, getKeys(wheel.expire(kStartTime + 10ms)));
+  EXPECT_EQ(nullptr, wheel.find("key1"));
+
+  EXPECT_TRUE(wheel.expire(kStartTime + 300s - 1ms).empty());
+  EXPECT_EQ(
+      std::set<std::string>{"key2"}, getKeys(wheel.expire(kStartTime + 300s)));
+
+  // Jump over both remaining expiries at once
+  EXPECT_EQ(
+      (std::set<std::string>{"key3", "key4"}),
+      getKeys(wheel.expire(kStartTime + hours(24 * 61))));
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_FALSE(wheel.getNextEventTime().has_value());
+}
+
+TEST(TtlCountdownWheelTest, RefreshInPlace) {
+  TtlCountdownWheel wheel(kStartTime);
+  wheel.upsert(createEntry("key1", 100ms));
+  auto entry = createEntry("key1", 5s);
+  entry.ttlVersion = 2;
+  wheel.upsert(entry);
+  EXPECT_EQ(1, wheel.size());
+  ASSERT_NE(nullptr, wheel.find("key1"));
+  EXPECT_EQ(2, wheel.find("key1")->ttlVersion);
+
+  // Previous expiry is gone
+  EXPECT_TRUE(wheel.expire(kStartTime + 4s).empty());
+  auto expired = wheel.expire(kStartTime + 5s);
+  ASSERT_EQ(1, expired.size());
+  EXPECT_EQ(2, expired.at(0).ttlVersion);
+
+  // Refresh to the past expires right away
+  wheel.upsert(createEntry("key2", 1s));
+  EXPECT_EQ(1, wheel.expire(kStartTime + 5s).size());
+}
+
+TEST(TtlCountdownWheelTest, Erase) {
+  TtlCountdownWheel wheel(kStartTime);
+  wheel.upsert(createEntry("key1", 100ms));
+  wheel.upsert(createEntry("key2", 200ms));
+  wheel.erase("key1");
+  wheel.erase("key3");
+  EXPECT_EQ(1, wheel.size());
+  EXPECT_EQ(
+      std::set<std::string>{"key2"}, getKeys(wheel.expire(kStartTime + 1s)));
+}
+
+/**
+ * Random expiries and random advances of wheel must always expire exactly the
+ * entries which are due
+ */
+TEST(TtlCountdownWheelTest, RandomizedExpiry) {
+  TtlCountdownWheel wheel(kStartTime);
+  std::mt19937_64 gen(1);
+  std::uniform_int_distribution<int64_t> expiryDist(0, int64_t{1} << 34);
+  std::map<std::string, int64_t> expected;
+
+  int64_t now{0};
+  for (int round = 0; round < 200; ++round) {
+    // add or refresh some keys, relative to current time
+    for (int i = 0; i < 50; ++i) {
+      const auto key = folly::sformat("key{}", gen() % 1000);
+      const int64_t expiry = now + (expiryDist(gen) >> (gen() % 34));
+      wheel.upsert(createEntry(key, milliseconds(expiry)));
+      expected[key] = expiry;
+    }
+
+    // advance
+    now += expiryDist(gen) >> (gen() % 34 + 4);
+    std::set<std::string> expectedKeys;
+    for (auto it = expected.begin(); it != expected.end();) {
+      if (it->second <= now) {
+        expectedKeys.emplace(it->first);
+        it = expected.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    EXPECT_EQ(
+        expectedKeys, getKeys(wheel.expire(kStartTime + milliseconds(now))));
+    EXPECT_EQ(expected.size(), wheel.size());
+
+    // next event is never later than next expiry
+    if (not expected.empty()) {
+      int64_t nextExpiry = std::numeric_limits<int64_t>::max();
+      for (auto const& kv : expected) {
+        nextExpiry = std::min(nextExpiry, kv.second);
+      }
+      ASSERT_TRUE(wheel.getNextEventTime().has_value());
+      EXPECT_LE(
+          *wheel.getNextEventTime(), kStartTime + milliseconds(nextExpiry));
+      EXPECT_GT(*wheel.getNextEventTime(), kStartTime + milliseconds(now));
+    }
+  }
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::init(&argc, &argv);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  auto rc = RUN_ALL_TESTS();
+
+  return rc;
+}
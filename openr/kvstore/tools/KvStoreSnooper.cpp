@@ -5,23 +5,204 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fstream>
 #include <iostream>
 
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/Bits.h>
 #include <folly/init/Init.h>
 
 #include <openr/common/OpenrClient.h>
+#include <openr/config/Config.h>
+#include <openr/decision/Decision.h>
 #include <openr/kvstore/KvStore.h>
+#include <openr/kvstore/KvStoreWrapper.h>
+#include <openr/messaging/ReplicateQueue.h>
 
 DEFINE_string(host, "::1", "Host to connect to");
 DEFINE_int32(port, openr::Constants::kOpenrCtrlPort, "OpenrCtrl server port");
 DEFINE_int32(connect_timeout_ms, 1000, "Connect timeout for client");
 DEFINE_int32(processing_timeout_ms, 5000, "Processing timeout for client");
+DEFINE_string(
+    capture_file,
+    "",
+    "Capture initial dump and publications with their timestamps into file, "
+    "instead of printing them");
+DEFINE_string(
+    replay_file,
+    "",
+    "Replay capture file into in-process KvStore and Decision, instead of "
+    "snooping");
+DEFINE_double(
+    replay_speed,
+    1.0,
+    "Speed of replay relative to capture. 0 replays as fast as possible");
+
+namespace {
+
+// Debounce of Decision during replay, same as defaults of Open/R
+const std::chrono::milliseconds kDecisionDebounceMin{10};
+const std::chrono::milliseconds kDecisionDebounceMax{250};
+
+apache::thrift::CompactSerializer serializer;
+
+// Capture file is a sequence of records, each prefixed by its serialized size
+// in 4 bytes of network byte order
+void
+writeRecord(
+    std::ofstream& file, openr::thrift::KvStoreSnoopRecord const& record) {
+  const auto data = fbzmq::util::writeThriftObjStr(record, serializer);
+  const uint32_t size = folly::Endian::big(static_cast<uint32_t>(data.size()));
+  file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  file.write(data.data(), data.size());
+  // keep capture readable up to last record if snooper gets killed
+  file.flush();
+}
+
+std::optional<openr::thrift::KvStoreSnoopRecord>
+readRecord(std::ifstream& file) {
+  uint32_t size{0};
+  if (not file.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+    return std::nullopt;
+  }
+  std::string data(folly::Endian::big(size), '\0');
+  if (not file.read(&data[0], data.size())) {
+    LOG(ERROR) << "Truncated record at end of capture, ignored";
+    return std::nullopt;
+  }
+  return fbzmq::util::readThriftObjStr<openr::thrift::KvStoreSnoopRecord>(
+      data, serializer);
+}
+
+/**
+ * Feed captured publications into KvStore, paced by their timestamps scaled
+ * by replay speed, with Decision computing routes off KvStore updates just as
+ * in Open/R. Expired keys aren't replayed, KvStore expires keys by TTL on its
+ * own. Note that TTLs are not scaled with replay speed.
+ */
+int
+replay() {
+  std::ifstream file(FLAGS_replay_file, std::ios::binary);
+  if (not file) {
+    LOG(ERROR) << "Failed to open capture file '" << FLAGS_replay_file << "'";
+    return 1;
+  }
+  auto record = readRecord(file);
+  if (not record.has_value()) {
+    LOG(ERROR) << "No records in capture file '" << FLAGS_replay_file << "'";
+    return 1;
+  }
+
+  // Routes are computed from the perspective of snooped node
+  openr::thrift::OpenrConfig tConfig;
+  tConfig.node_name = record->nodeName_ref().value_or("snooper");
+  tConfig.domain = "replay";
+  auto config = std::make_shared<openr::Config>(tConfig);
+
+  fbzmq::Context context;
+  openr::KvStoreWrapper kvStore(
+      context,
+      config,
+      std::unordered_map<std::string, openr::thrift::PeerSpec>{});
+  openr::messaging::ReplicateQueue<openr::thrift::RouteDatabaseDelta>
+      staticRoutesUpdateQueue;
+  openr::messaging::ReplicateQueue<openr::thrift::RouteDatabaseDelta>
+      routeUpdatesQueue;
+  auto routeUpdatesReader = routeUpdatesQueue.getReader();
+  openr::Decision decision(
+      config,
+      false /* computeLfaPaths */,
+      false /* bgpDryRun */,
+      kDecisionDebounceMin,
+      kDecisionDebounceMax,
+      kvStore.getReader(),
+      staticRoutesUpdateQueue.getReader(),
+      routeUpdatesQueue,
+      context);
+  kvStore.run();
+  std::thread decisionThread([&decision]() { decision.run(); });
+  decision.waitUntilRunning();
+
+  // Count route updates computed by Decision
+  size_t numRouteUpdates{0};
+  std::thread routeUpdatesThread([&]() {
+    while (routeUpdatesReader.get().hasValue()) {
+      ++numRouteUpdates;
+    }
+  });
+
+  LOG(INFO) << "Replaying capture of node " << tConfig.node_name << " at "
+            << FLAGS_replay_speed << "x speed";
+  size_t numRecords{0};
+  size_t numKeyVals{0};
+  const auto startTime = std::chrono::steady_clock::now();
+  for (; record.has_value(); record = readRecord(file)) {
+    if (FLAGS_replay_speed > 0) {
+      std::this_thread::sleep_until(
+          startTime +
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double, std::milli>(
+                  record->timestampMs / FLAGS_replay_speed)));
+    }
+    ++numRecords;
+    auto& keyVals = record->publication.keyVals;
+    if (keyVals.empty()) {
+      continue;
+    }
+    numKeyVals += keyVals.size();
+    if (not kvStore.setKeys(
+            std::vector<std::pair<std::string, openr::thrift::Value>>(
+                std::make_move_iterator(keyVals.begin()),
+                std::make_move_iterator(keyVals.end())))) {
+      LOG(ERROR) << "Failed to replay record " << numRecords;
+    }
+  }
+  const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - startTime)
+                             .count();
+
+  // Let Decision catch up with last updates before asking for routes
+  std::this_thread::sleep_for(kDecisionDebounceMax);
+  auto routeDb = decision.getDecisionRouteDb("").get();
+  LOG(INFO) << "Replayed " << numRecords << " records with " << numKeyVals
+            << " key-values in " << elapsedMs << "ms ("
+            << numKeyVals * 1000 / std::max<int64_t>(elapsedMs, 1)
+            << " key-values/s)";
+  LOG(INFO) << "KvStore holds " << kvStore.dumpAll().size() << " keys, "
+            << "Decision computed " << routeDb->unicastRoutes.size()
+            << " unicast routes";
+
+  kvStore.stop();
+  staticRoutesUpdateQueue.close();
+  routeUpdatesQueue.close();
+  decision.stop();
+  decisionThread.join();
+  routeUpdatesThread.join();
+  LOG(INFO) << "Decision sent " << numRouteUpdates << " route updates";
+  return 0;
+}
+
+} // namespace
 
 int
 main(int argc, char** argv) {
   // Initialize all params
   folly::init(&argc, &argv);
 
+  if (not FLAGS_replay_file.empty()) {
+    return replay();
+  }
+
+  std::optional<std::ofstream> captureFile;
+  if (not FLAGS_capture_file.empty()) {
+    captureFile.emplace(FLAGS_capture_file, std::ios::binary);
+    if (not *captureFile) {
+      LOG(ERROR) << "Failed to open capture file '" << FLAGS_capture_file
+                 << "'";
+      return 1;
+    }
+  }
+
   // Define and start event base
   folly::EventBase evb;
   std::thread evbThread([&evb]() { evb.loopForever(); });
@@ -41,17 +222,42 @@ main(int argc, char** argv) {
             << " entries in initial dump.";
   LOG(INFO) << "";
 
+  const auto startTime = std::chrono::steady_clock::now();
+  if (captureFile.has_value()) {
+    openr::thrift::KvStoreSnoopRecord record;
+    record.timestampMs = 0;
+    record.publication = response.response;
+    record.nodeName_ref() = client->semifuture_getMyNodeName().get();
+    writeRecord(*captureFile, record);
+    LOG(INFO) << "Capturing publications of node " << *record.nodeName_ref()
+              << " into '" << FLAGS_capture_file << "'";
+  }
+
   auto subscription =
       std::move(response.stream)
           .subscribeExTry(
               folly::Executor::getKeepAliveToken(&evb),
-              [&globalKeyVals](
+              [&globalKeyVals, &captureFile, startTime](
                   folly::Try<openr::thrift::Publication>&& maybePub) mutable {
                 if (maybePub.hasException()) {
                   LOG(ERROR) << maybePub.exception().what();
                   return;
                 }
                 auto& pub = maybePub.value();
+
+                // Record publication as is, printing is too slow to keep up
+                // with churn
+                if (captureFile.has_value()) {
+                  openr::thrift::KvStoreSnoopRecord record;
+                  record.timestampMs =
+                      std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now() - startTime)
+                          .count();
+                  record.publication = std::move(pub);
+                  writeRecord(*captureFile, record);
+                  return;
+                }
+
                 // Print expired key-vals
                 for (const auto& key : pub.expiredKeys) {
                   std::cout << "Expired Key: " << key << std::endl;
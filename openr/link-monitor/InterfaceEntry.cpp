@@ -46,6 +46,7 @@ InterfaceEntry::updateAttrs(int ifIndex, bool isUp, uint64_t weight) {
   }
 
   if (isUpdated) {
+    isDirty_ = true;
     updateCallback_();
   }
 
@@ -87,6 +88,8 @@ InterfaceEntry::updateAddr(folly::CIDRNetwork const& ipNetwork, bool isValid) {
             << ", status: " << (isUp() ? "UP" : "DOWN");
   }
 
+  isDirty_ |= isUpdated;
+
   if (isUpdated and isActive()) {
     updateCallback_();
   }
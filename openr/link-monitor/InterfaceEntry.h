@@ -50,6 +50,18 @@ class InterfaceEntry final {
   // Get backoff time
   std::chrono::milliseconds getBackoffDuration() const;
 
+  // Is any attribute or address updated since last clearDirty(). Changes of
+  // active status due to backoff are not covered.
+  bool
+  isDirty() const {
+    return isDirty_;
+  }
+
+  void
+  clearDirty() {
+    isDirty_ = false;
+  }
+
   // Used to check for updates if doing a re-sync
   bool
   operator==(const InterfaceEntry& interfaceEntry) {
@@ -118,6 +130,9 @@ class InterfaceEntry final {
   uint64_t weight_{1};
   std::unordered_set<folly::CIDRNetwork> networks_;
 
+  // Set on every update, cleared once advertised
+  bool isDirty_{true};
+
   // Backoff variables
   ExponentialBackoff<std::chrono::milliseconds> backoff_;
 
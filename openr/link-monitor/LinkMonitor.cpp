@@ -15,6 +15,8 @@
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/MapUtil.h>
 #include <folly/Memory.h>
+#include <folly/Random.h>
+#include <folly/ScopeGuard.h>
 #include <folly/futures/Future.h>
 #include <folly/gen/Base.h>
 #include <folly/system/ThreadName.h>
@@ -37,11 +39,16 @@ const std::string kConfigKey{"link-monitor-config"};
 
 /**
  * Transformation function to convert measured rtt (in us) to a metric value
- * to be used. Metric can never be zero.
+ * to be used. Metric is rounded to the nearest multiple of bucketSize and can
+ * never be zero.
  */
 int32_t
-getRttMetric(int64_t rttUs) {
-  return std::max((int)(rttUs / 100), (int)1);
+getRttMetric(int64_t rttUs, int32_t bucketSize) {
+  int64_t metric = rttUs / 100;
+  if (bucketSize > 1) {
+    metric = (metric + bucketSize / 2) / bucketSize * bucketSize;
+  }
+  return std::max((int)metric, (int)1);
 }
 
 void
@@ -60,6 +67,24 @@ printLinkMonitorState(openr::thrift::LinkMonitorState const& state) {
   }
 }
 
+// Register the latency histogram of one stage of the neighbor event
+// processing. Percentile 100 is exported as the max latency of each window.
+template <typename Duration>
+void
+addLatencyHistogram(
+    folly::StringPiece key, Duration bucketWidth, Duration maxLatency) {
+  fb303::fbData->addHistogram(key, bucketWidth.count(), 0, maxLatency.count());
+  fb303::fbData->exportHistogramPercentile(key, 50, 99, 100);
+}
+
+template <typename Duration>
+int64_t
+getElapsed(std::chrono::steady_clock::time_point startTime) {
+  return std::chrono::duration_cast<Duration>(
+             std::chrono::steady_clock::now() - startTime)
+      .count();
+}
+
 } // anonymous namespace
 
 namespace openr {
@@ -98,7 +123,12 @@ LinkMonitor::LinkMonitor(
     std::chrono::milliseconds flapInitialBackoff,
     std::chrono::milliseconds flapMaxBackoff,
     std::chrono::milliseconds ttlKeyInKvStore,
-    const std::unordered_set<std::string>& areas)
+    const std::unordered_set<std::string>& areas,
+    bool perAdjacencyKeys,
+    std::chrono::milliseconds neighborDownCoalesceWindow,
+    int32_t rttMetricBucketSize,
+    std::chrono::milliseconds rttMetricHoldTime,
+    std::shared_ptr<thrift::SystemServiceSvIf> systemHandler)
     : nodeId_(nodeId),
       platformThriftPort_(platformThriftPort),
       includeRegexList_(std::move(includeRegexList)),
@@ -116,6 +146,10 @@ LinkMonitor::LinkMonitor(
       flapInitialBackoff_(flapInitialBackoff),
       flapMaxBackoff_(flapMaxBackoff),
       ttlKeyInKvStore_(ttlKeyInKvStore),
+      perAdjacencyKeys_(perAdjacencyKeys),
+      neighborDownCoalesceWindow_(neighborDownCoalesceWindow),
+      rttMetricBucketSize_(rttMetricBucketSize),
+      rttMetricHoldTime_(rttMetricHoldTime),
       adjHoldUntilTimePoint_(std::chrono::steady_clock::now() + adjHoldTime),
       // mutable states
       interfaceUpdatesQueue_(intfUpdatesQueue),
@@ -124,6 +158,7 @@ LinkMonitor::LinkMonitor(
       nlEventSub_(
           zmqContext, folly::none, folly::none, fbzmq::NonblockingFlag{true}),
       expBackoff_(Constants::kInitialBackoff, Constants::kMaxBackoff),
+      systemHandler_(std::move(systemHandler)),
       configStore_(configStore),
       areas_(areas) {
   // Check non-empty module ptr
@@ -138,6 +173,37 @@ LinkMonitor::LinkMonitor(
         advertiseAdjacencies();
       });
 
+  // Create throttled advertiser of areas with neighbors gone down
+  if (neighborDownCoalesceWindow_.count() > 0) {
+    advertiseNeighborDownThrottled_ = std::make_unique<fbzmq::ZmqThrottle>(
+        getEvb(), neighborDownCoalesceWindow_, [this]() noexcept {
+          for (const auto& area : neighborDownAreas_) {
+            advertiseAdjacencies(area);
+          }
+          neighborDownAreas_.clear();
+        });
+  }
+
+  addLatencyHistogram(
+      "link_monitor.latency.neighbor_event_processed_us",
+      Constants::kLinkProcessingLatencyBucketWidth,
+      Constants::kLinkProcessingLatencyMax);
+  addLatencyHistogram(
+      "link_monitor.latency.adj_db_persist_us",
+      Constants::kLinkProcessingLatencyBucketWidth,
+      Constants::kLinkProcessingLatencyMax);
+  addLatencyHistogram(
+      "link_monitor.latency.neighbor_event_to_adj_db_ms",
+      Constants::kLinkLatencyBucketWidth,
+      Constants::kLinkLatencyMax);
+  addLatencyHistogram(
+      "link_monitor.latency.neighbor_event_to_kvstore_ms",
+      Constants::kLinkLatencyBucketWidth,
+      Constants::kLinkLatencyMax);
+
+  rttMetricHoldTimer_ = fbzmq::ZmqTimeout::make(
+      getEvb(), [this]() noexcept { applyPendingRttMetrics(); });
+
   // Create throttled interfaces and addresses advertiser
   advertiseIfaceAddrThrottled_ = std::make_unique<fbzmq::ZmqThrottle>(
       getEvb(), Constants::kLinkThrottleTimeout, [this]() noexcept {
@@ -148,8 +214,7 @@ LinkMonitor::LinkMonitor(
       getEvb(), [this]() noexcept { advertiseIfaceAddr(); });
 
   LOG(INFO) << "Loading link-monitor state";
-  zmqMonitorClient_ =
-      std::make_unique<fbzmq::ZmqMonitorClient>(zmqContext, monitorSubmitUrl);
+  eventLogger_ = std::make_unique<EventLogger>(zmqContext, monitorSubmitUrl);
 
   // Create config-store client
   auto state =
@@ -242,6 +307,8 @@ LinkMonitor::LinkMonitor(
   fb303::fbData->addStatExportType(
       "link_monitor.advertise_adjacencies", fb303::SUM);
   fb303::fbData->addStatExportType("link_monitor.advertise_links", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "link_monitor.platform_events.gaps", fb303::SUM);
 }
 
 void
@@ -257,6 +324,8 @@ LinkMonitor::prepare() noexcept {
       static_cast<uint16_t>(thrift::PlatformEventType::LINK_EVENT);
   const auto addrEventType =
       static_cast<uint16_t>(thrift::PlatformEventType::ADDRESS_EVENT);
+  const auto batchEventType =
+      static_cast<uint16_t>(thrift::PlatformEventType::EVENT_BATCH);
   auto nlLinkSubOpt =
       nlEventSub_.setSockOpt(ZMQ_SUBSCRIBE, &linkEventType, sizeof(uint16_t));
   if (nlLinkSubOpt.hasError()) {
@@ -269,6 +338,12 @@ LinkMonitor::prepare() noexcept {
     LOG(FATAL) << "Error setting ZMQ_SUBSCRIBE to " << addrEventType << " "
                << nlAddrSubOpt.error();
   }
+  auto nlBatchSubOpt =
+      nlEventSub_.setSockOpt(ZMQ_SUBSCRIBE, &batchEventType, sizeof(uint16_t));
+  if (nlBatchSubOpt.hasError()) {
+    LOG(FATAL) << "Error setting ZMQ_SUBSCRIBE to " << batchEventType << " "
+               << nlBatchSubOpt.error();
+  }
   const auto nlSub = nlEventSub_.connect(fbzmq::SocketUrl{platformPubUrl_});
   if (nlSub.hasError()) {
     LOG(FATAL) << "Error connecting to URL '" << platformPubUrl_ << "' "
@@ -287,64 +362,39 @@ LinkMonitor::prepare() noexcept {
           return;
         }
 
-        auto eventMsg =
-            eventData.readThriftObj<thrift::PlatformEvent>(serializer_);
-        if (eventMsg.hasError()) {
-          LOG(ERROR) << "Error in reading publication eventData";
+        const auto header = eventHeader.read<uint16_t>();
+        if (header.hasError()) {
+          LOG(ERROR) << "Error in reading publication header";
           return;
         }
 
-        const auto eventType = eventMsg.value().eventType;
-        CHECK_EQ(
-            static_cast<uint16_t>(eventType),
-            eventHeader.read<uint16_t>().value());
-
-        switch (eventType) {
-        case thrift::PlatformEventType::LINK_EVENT: {
-          VLOG(3) << "Received Link Event from Platform....";
-          try {
-            const auto linkEvt =
-                fbzmq::util::readThriftObjStr<thrift::LinkEntry>(
-                    eventMsg.value().eventData, serializer_);
-            auto interfaceEntry = getOrCreateInterfaceEntry(linkEvt.ifName);
-            if (interfaceEntry) {
-              const bool wasUp = interfaceEntry->isUp();
-              interfaceEntry->updateAttrs(
-                  linkEvt.ifIndex, linkEvt.isUp, linkEvt.weight);
-              logLinkEvent(
-                  interfaceEntry->getIfName(),
-                  wasUp,
-                  interfaceEntry->isUp(),
-                  interfaceEntry->getBackoffDuration());
-            }
-          } catch (std::exception const& e) {
-            LOG(ERROR) << "Error parsing linkEvt. Reason: "
-                       << folly::exceptionStr(e);
+        // Batch of events, all deserialized at once
+        if (header.value() ==
+            static_cast<uint16_t>(thrift::PlatformEventType::EVENT_BATCH)) {
+          auto batch =
+              eventData.readThriftObj<thrift::PlatformEventBatch>(serializer_);
+          if (batch.hasError()) {
+            LOG(ERROR) << "Error in reading publication eventData";
+            return;
           }
-        } break;
-
-        case thrift::PlatformEventType::ADDRESS_EVENT: {
-          VLOG(3) << "Received Address Event from Platform....";
-          try {
-            const auto addrEvt =
-                fbzmq::util::readThriftObjStr<thrift::AddrEntry>(
-                    eventMsg.value().eventData, serializer_);
-            auto interfaceEntry = getOrCreateInterfaceEntry(addrEvt.ifName);
-            if (interfaceEntry) {
-              interfaceEntry->updateAddr(
-                  toIPNetwork(addrEvt.ipPrefix, false /* no masking */),
-                  addrEvt.isValid);
-            }
-          } catch (std::exception const& e) {
-            LOG(ERROR) << "Error parsing addrEvt. Reason: "
-                       << folly::exceptionStr(e);
+          VLOG(3) << "Received batch " << batch->seqNum << " of "
+                  << batch->events.size() << " events from Platform....";
+          for (auto const& event : batch->events) {
+            processPlatformEvent(event);
           }
-        } break;
+          processPlatformEventBatchSeqNum(batch->publisherId, batch->seqNum);
+          return;
+        }
 
-        default:
-          LOG(ERROR) << "Wrong eventType received on " << nodeId_
-                     << ", eventType: " << static_cast<uint16_t>(eventType);
+        auto eventMsg =
+            eventData.readThriftObj<thrift::PlatformEvent>(serializer_);
+        if (eventMsg.hasError()) {
+          LOG(ERROR) << "Error in reading publication eventData";
+          return;
         }
+        CHECK_EQ(
+            static_cast<uint16_t>(eventMsg.value().eventType), header.value());
+        processPlatformEvent(eventMsg.value());
       });
 
   // Schedule periodic timer for InterfaceDb re-sync from Netlink Platform
@@ -381,7 +431,8 @@ LinkMonitor::neighborUpEvent(const thrift::SparkNeighborEvent& event) {
   const std::string& area = event.area;
   const auto adjId = std::make_pair(remoteNodeName, ifName);
   const int32_t neighborKvStoreCmdPort = event.neighbor.kvStoreCmdPort;
-  auto rttMetric = getRttMetric(event.rttUs);
+  const int32_t neighborCtrlThriftPort = event.neighbor.openrCtrlThriftPort;
+  auto rttMetric = getRttMetric(event.rttUs, rttMetricBucketSize_);
   auto now = std::chrono::system_clock::now();
   // current unixtime in s
   int64_t timestamp =
@@ -414,12 +465,21 @@ LinkMonitor::neighborUpEvent(const thrift::SparkNeighborEvent& event) {
   fb303::fbData->addStatValue("link_monitor.neighbor_up", 1, fb303::SUM);
 
   std::string repUrl;
+  std::string thriftPortUrl;
   if (!mockMode_) {
     repUrl = folly::sformat(
         "tcp://[{}%{}]:{}",
         toString(neighborAddrV6),
         ifName,
         neighborKvStoreCmdPort);
+    // neighbors of older versions don't advertise their ctrl port
+    if (neighborCtrlThriftPort != 0) {
+      thriftPortUrl = folly::sformat(
+          "tcp://[{}%{}]:{}",
+          toString(neighborAddrV6),
+          ifName,
+          neighborCtrlThriftPort);
+    }
   } else {
     // use inproc address
     repUrl = folly::sformat("inproc://{}-kvstore-cmd-global", remoteNodeName);
@@ -431,6 +491,7 @@ LinkMonitor::neighborUpEvent(const thrift::SparkNeighborEvent& event) {
   // it 2) does not change: the existing connection to a neighbor is retained
   thrift::PeerSpec peerSpec;
   peerSpec.cmdUrl = repUrl;
+  peerSpec.thriftPortUrl = thriftPortUrl;
   peerSpec.supportFloodOptimization = event.supportFloodOptimization;
   adjacencies_[adjId] =
       AdjacencyValue(peerSpec, std::move(newAdj), false, area);
@@ -439,7 +500,7 @@ LinkMonitor::neighborUpEvent(const thrift::SparkNeighborEvent& event) {
   advertiseKvStorePeers(area, {{remoteNodeName, peerSpec}});
 
   // Advertise new adjancies in a throttled fashion
-  advertiseAdjacenciesThrottled_->operator()();
+  advertiseAdjacenciesThrottled();
 }
 
 void
@@ -460,7 +521,7 @@ LinkMonitor::neighborDownEvent(const thrift::SparkNeighborEvent& event) {
   }
   // advertise both peers and adjacencies
   advertiseKvStorePeers(area);
-  advertiseAdjacencies(area);
+  advertiseAdjacenciesOnNeighborDown(area);
 }
 
 void
@@ -487,17 +548,79 @@ void
 LinkMonitor::neighborRttChangeEvent(const thrift::SparkNeighborEvent& event) {
   const auto& remoteNodeName = event.neighbor.nodeName;
   const auto& ifName = event.ifName;
-  int32_t newRttMetric = getRttMetric(event.rttUs);
+  int32_t newRttMetric = getRttMetric(event.rttUs, rttMetricBucketSize_);
+
+  auto it = adjacencies_.find({remoteNodeName, ifName});
+  if (it == adjacencies_.end()) {
+    return;
+  }
+  auto& adjValue = it->second;
+  auto& adj = adjValue.adjacency;
+  adj.rtt = event.rttUs;
+
+  // RTT change within the same metric bucket. New rtt value will be
+  // advertised along with the next adjacency update.
+  if (newRttMetric == adj.metric) {
+    adjValue.pendingMetric.reset();
+    fb303::fbData->addStatValue(
+        "link_monitor.rtt_metric_dampened", 1, fb303::SUM);
+    return;
+  }
+
+  // Metric changed recently, hold it back
+  const auto now = std::chrono::steady_clock::now();
+  const auto holdUntil = adjValue.lastMetricChange + rttMetricHoldTime_;
+  if (now < holdUntil) {
+    VLOG(1) << "Holding metric value " << newRttMetric << " for neighbor "
+            << remoteNodeName;
+    adjValue.pendingMetric = newRttMetric;
+    fb303::fbData->addStatValue(
+        "link_monitor.rtt_metric_dampened", 1, fb303::SUM);
+    if (not rttMetricHoldTimer_->isScheduled()) {
+      rttMetricHoldTimer_->scheduleTimeout(
+          std::chrono::ceil<std::chrono::milliseconds>(holdUntil - now));
+    }
+    return;
+  }
 
   VLOG(1) << "Metric value changed for neighbor " << remoteNodeName << " to "
           << newRttMetric;
+  adj.metric = newRttMetric;
+  adjValue.lastMetricChange = now;
+  adjValue.pendingMetric.reset();
+  advertiseAdjacenciesThrottled();
+}
 
-  auto it = adjacencies_.find({remoteNodeName, ifName});
-  if (it != adjacencies_.end()) {
-    auto& adj = it->second.adjacency;
-    adj.metric = newRttMetric;
-    adj.rtt = event.rttUs;
-    advertiseAdjacenciesThrottled_->operator()();
+void
+LinkMonitor::applyPendingRttMetrics() {
+  const auto now = std::chrono::steady_clock::now();
+  std::optional<std::chrono::milliseconds> nextTimeout;
+  bool isUpdated = false;
+  for (auto& kv : adjacencies_) {
+    auto& adjValue = kv.second;
+    if (not adjValue.pendingMetric.has_value()) {
+      continue;
+    }
+    const auto holdUntil = adjValue.lastMetricChange + rttMetricHoldTime_;
+    if (now < holdUntil) {
+      auto timeout =
+          std::chrono::ceil<std::chrono::milliseconds>(holdUntil - now);
+      nextTimeout = std::min(nextTimeout.value_or(timeout), timeout);
+      continue;
+    }
+    VLOG(1) << "Metric value changed for neighbor " << kv.first.first
+            << " to " << *adjValue.pendingMetric;
+    adjValue.adjacency.metric = *adjValue.pendingMetric;
+    adjValue.lastMetricChange = now;
+    adjValue.pendingMetric.reset();
+    isUpdated = true;
+  }
+
+  if (isUpdated) {
+    advertiseAdjacenciesThrottled();
+  }
+  if (nextTimeout.has_value()) {
+    rttMetricHoldTimer_->scheduleTimeout(*nextTimeout);
   }
 }
 
@@ -622,6 +745,17 @@ LinkMonitor::advertiseAdjacencies(const std::string& area) {
     return;
   }
 
+  // Neighbor event which triggered this advertisement, if any
+  std::optional<NeighborEventTs> neighborEventTs;
+  auto eventIt = pendingNeighborEventTs_.find(area);
+  if (eventIt != pendingNeighborEventTs_.end()) {
+    neighborEventTs = std::move(eventIt->second);
+    pendingNeighborEventTs_.erase(eventIt);
+    fb303::fbData->addHistogramValue(
+        "link_monitor.latency.neighbor_event_to_adj_db_ms",
+        getElapsed<std::chrono::milliseconds>(neighborEventTs->ts));
+  }
+
   auto adjDb = thrift::AdjacencyDatabase();
   adjDb.thisNodeName = nodeId_;
   adjDb.isOverloaded = state_.isOverloaded;
@@ -656,6 +790,15 @@ LinkMonitor::advertiseAdjacencies(const std::string& area) {
   // Add perf information if enabled
   if (enablePerfMeasurement_) {
     thrift::PerfEvents perfEvents;
+    // Identifies the trace across nodes, which sample it consistently
+    perfEvents.traceId_ref() = folly::Random::rand64();
+    if (neighborEventTs.has_value()) {
+      perfEvents.events.emplace_back(
+          apache::thrift::FRAGILE,
+          nodeId_,
+          "NEIGHBOR_EVENT_RECEIVED",
+          neighborEventTs->unixTsMs);
+    }
     addPerfEvent(perfEvents, nodeId_, "ADJ_DB_UPDATED");
     adjDb.perfEvents_ref() = perfEvents;
   } else {
@@ -664,9 +807,21 @@ LinkMonitor::advertiseAdjacencies(const std::string& area) {
 
   LOG(INFO) << "Updating adjacency database in KvStore with "
             << adjDb.adjacencies.size() << " entries in area: " << area;
+  const auto persistStartTime = std::chrono::steady_clock::now();
+  if (perAdjacencyKeys_) {
+    advertisePerAdjacencyKeys(area, adjDb);
+  }
   const auto keyName = adjacencyDbMarker_ + nodeId_;
   std::string adjDbStr = fbzmq::util::writeThriftObjStr(adjDb, serializer_);
   kvStoreClient_->persistKey(keyName, adjDbStr, ttlKeyInKvStore_, area);
+  fb303::fbData->addHistogramValue(
+      "link_monitor.latency.adj_db_persist_us",
+      getElapsed<std::chrono::microseconds>(persistStartTime));
+  if (neighborEventTs.has_value()) {
+    fb303::fbData->addHistogramValue(
+        "link_monitor.latency.neighbor_event_to_kvstore_ms",
+        getElapsed<std::chrono::milliseconds>(neighborEventTs->ts));
+  }
   fb303::fbData->addStatValue(
       "link_monitor.advertise_adjacencies", 1, fb303::SUM);
 
@@ -686,6 +841,83 @@ LinkMonitor::advertiseAdjacencies(const std::string& area) {
         "link_monitor.metric." + adj.otherNodeName, adj.metric);
   }
 }
+void
+LinkMonitor::advertiseAdjacenciesThrottled() {
+  if (advertiseAdjacenciesThrottled_->isActive()) {
+    fb303::fbData->addStatValue(
+        "link_monitor.neighbor_events_coalesced", 1, fb303::SUM);
+  }
+  markNeighborEventPending();
+  advertiseAdjacenciesThrottled_->operator()();
+}
+
+void
+LinkMonitor::markNeighborEventPending() {
+  if (neighborEventTs_.has_value()) {
+    // Keep the oldest one
+    pendingNeighborEventTs_.emplace(neighborEventTs_->area, *neighborEventTs_);
+  }
+}
+
+void
+LinkMonitor::advertiseAdjacenciesOnNeighborDown(const std::string& area) {
+  markNeighborEventPending();
+  if (not advertiseNeighborDownThrottled_) {
+    advertiseAdjacencies(area);
+    return;
+  }
+
+  if (not neighborDownAreas_.emplace(area).second) {
+    fb303::fbData->addStatValue(
+        "link_monitor.neighbor_events_coalesced", 1, fb303::SUM);
+  }
+  advertiseNeighborDownThrottled_->operator()();
+}
+
+void
+LinkMonitor::advertisePerAdjacencyKeys(
+    const std::string& area, thrift::AdjacencyDatabase& adjDb) {
+  // node attributes are carried along, perf events are left to adjacency db
+  // key. Otherwise every key would change on every advertisement.
+  thrift::AdjacencyDatabase perAdjDb;
+  perAdjDb.thisNodeName = adjDb.thisNodeName;
+  perAdjDb.isOverloaded = adjDb.isOverloaded;
+  perAdjDb.nodeLabel = adjDb.nodeLabel;
+  perAdjDb.area_ref() = area;
+
+  auto& advertisedKeys = advertisedAdjacencyKeys_[area];
+  std::unordered_set<std::string> nowAdvertisedKeys;
+  for (auto& adj : adjDb.adjacencies) {
+    auto key = getPerAdjacencyKey(
+        adjacencyDbMarker_, nodeId_, adj.otherNodeName, adj.ifName);
+    perAdjDb.adjacencies = {std::move(adj)};
+    if (kvStoreClient_->persistKey(
+            key,
+            fbzmq::util::writeThriftObjStr(perAdjDb, serializer_),
+            ttlKeyInKvStore_,
+            area)) {
+      fb303::fbData->addStatValue(
+          "link_monitor.advertise_adjacency_keys", 1, fb303::SUM);
+    }
+    nowAdvertisedKeys.emplace(std::move(key));
+  }
+  adjDb.adjacencies.clear();
+
+  // one last key set with no adjacency signifies withdraw, then the key
+  // should ttl out
+  perAdjDb.adjacencies.clear();
+  const auto withdrawnAdjDbStr =
+      fbzmq::util::writeThriftObjStr(perAdjDb, serializer_);
+  for (auto const& key : advertisedKeys) {
+    if (nowAdvertisedKeys.count(key)) {
+      continue;
+    }
+    LOG(INFO) << "Withdrawing key: " << key << " from KvStore area: " << area;
+    kvStoreClient_->clearKey(key, withdrawnAdjDbStr, ttlKeyInKvStore_, area);
+  }
+  advertisedKeys = std::move(nowAdvertisedKeys);
+}
+
 void
 LinkMonitor::advertiseAdjacencies() {
   // advertise to all areas. Once area configuration per link is implemented
@@ -721,9 +953,11 @@ void
 LinkMonitor::advertiseInterfaces() {
   fb303::fbData->addStatValue("link_monitor.advertise_links", 1, fb303::SUM);
 
-  // Create interface database
+  // Create interface database. Only the first one is full, subsequent ones
+  // carry dirty interfaces and the ones whose active status has changed
   thrift::InterfaceDatabase ifDb;
   ifDb.thisNodeName = nodeId_;
+  ifDb.isDelta = isInterfaceDbAdvertised_;
   for (auto& kv : interfaces_) {
     auto& ifName = kv.first;
     auto& interface = kv.second;
@@ -732,12 +966,30 @@ LinkMonitor::advertiseInterfaces() {
             ifName, includeRegexList_, excludeRegexList_)) {
       continue;
     }
+    const bool isActive = interface.isActive();
+    auto it = advertisedIfStatus_.find(ifName);
+    if (ifDb.isDelta and not interface.isDirty() and
+        it != advertisedIfStatus_.end() and it->second == isActive) {
+      continue;
+    }
     // Get interface info and override active status
     auto interfaceInfo = interface.getInterfaceInfo();
-    interfaceInfo.isUp = interface.isActive();
+    interfaceInfo.isUp = isActive;
     ifDb.interfaces.emplace(ifName, std::move(interfaceInfo));
+    interface.clearDirty();
+    advertisedIfStatus_[ifName] = isActive;
   }
 
+  if (ifDb.isDelta and ifDb.interfaces.empty()) {
+    VLOG(2) << "No interface changes to advertise";
+    return;
+  }
+  isInterfaceDbAdvertised_ = true;
+  fb303::fbData->addStatValue(
+      "link_monitor.advertise_links.num_interfaces",
+      ifDb.interfaces.size(),
+      fb303::AVG);
+
   // publish new interface database to other modules (Fib & Spark)
   interfaceUpdatesQueue_.push(std::move(ifDb));
 }
@@ -853,6 +1105,13 @@ LinkMonitor::getOrCreateInterfaceEntry(const std::string& ifName) {
 
 void
 LinkMonitor::createNetlinkSystemHandlerClient() {
+  if (systemHandler_) {
+    if (not client_) {
+      client_ = std::make_unique<SystemServiceClient>(systemHandler_);
+    }
+    return;
+  }
+
   // Reset client if channel is not good
   if (socket_ && (!socket_->good() || socket_->hangup())) {
     client_.reset();
@@ -880,8 +1139,8 @@ LinkMonitor::createNetlinkSystemHandlerClient() {
   channel->setClientType(THRIFT_FRAMED_DEPRECATED);
 
   // Reset client_
-  client_ =
-      std::make_unique<thrift::SystemServiceAsyncClient>(std::move(channel));
+  client_ = std::make_unique<SystemServiceClient>(
+      std::make_unique<thrift::SystemServiceAsyncClient>(std::move(channel)));
 }
 
 bool
@@ -894,7 +1153,7 @@ LinkMonitor::syncInterfaces() {
   std::vector<thrift::Link> links;
   try {
     createNetlinkSystemHandlerClient();
-    client_->sync_getAllLinks(links);
+    links = client_->getAllLinks();
   } catch (const std::exception& e) {
     client_.reset();
     LOG(ERROR) << "Failed to sync LinkDb from NetlinkSystemHandler. Error: "
@@ -946,6 +1205,79 @@ LinkMonitor::syncInterfaces() {
   return true;
 }
 
+void
+LinkMonitor::processPlatformEvent(const thrift::PlatformEvent& event) {
+  switch (event.eventType) {
+  case thrift::PlatformEventType::LINK_EVENT: {
+    VLOG(3) << "Received Link Event from Platform....";
+    try {
+      const auto linkEvt = fbzmq::util::readThriftObjStr<thrift::LinkEntry>(
+          event.eventData, serializer_);
+      auto interfaceEntry = getOrCreateInterfaceEntry(linkEvt.ifName);
+      if (interfaceEntry) {
+        const bool wasUp = interfaceEntry->isUp();
+        interfaceEntry->updateAttrs(
+            linkEvt.ifIndex, linkEvt.isUp, linkEvt.weight);
+        logLinkEvent(
+            interfaceEntry->getIfName(),
+            wasUp,
+            interfaceEntry->isUp(),
+            interfaceEntry->getBackoffDuration());
+      }
+    } catch (std::exception const& e) {
+      LOG(ERROR) << "Error parsing linkEvt. Reason: "
+                 << folly::exceptionStr(e);
+    }
+  } break;
+
+  case thrift::PlatformEventType::ADDRESS_EVENT: {
+    VLOG(3) << "Received Address Event from Platform....";
+    try {
+      const auto addrEvt = fbzmq::util::readThriftObjStr<thrift::AddrEntry>(
+          event.eventData, serializer_);
+      auto interfaceEntry = getOrCreateInterfaceEntry(addrEvt.ifName);
+      if (interfaceEntry) {
+        interfaceEntry->updateAddr(
+            toIPNetwork(addrEvt.ipPrefix, false /* no masking */),
+            addrEvt.isValid);
+      }
+    } catch (std::exception const& e) {
+      LOG(ERROR) << "Error parsing addrEvt. Reason: "
+                 << folly::exceptionStr(e);
+    }
+  } break;
+
+  case thrift::PlatformEventType::NEIGHBOR_EVENT:
+    // Batches carry every event of publisher, neighbors are of no interest
+    break;
+
+  default:
+    LOG(ERROR) << "Wrong eventType received on " << nodeId_
+               << ", eventType: " << static_cast<uint16_t>(event.eventType);
+  }
+}
+
+void
+LinkMonitor::processPlatformEventBatchSeqNum(
+    int64_t publisherId, int64_t seqNum) {
+  const bool isFirstBatch = platformPublisherId_ == 0;
+  const bool isGap = platformPublisherId_ != publisherId or
+      seqNum != platformEventSeqNum_ + 1;
+  platformPublisherId_ = publisherId;
+  platformEventSeqNum_ = seqNum;
+  // Initial sync of interfaces covers events before the first batch
+  if (isFirstBatch or not isGap) {
+    return;
+  }
+
+  LOG(WARNING) << "Lost platform events ahead of batch " << seqNum
+               << " of publisher " << publisherId
+               << ", resyncing interfaces";
+  fb303::fbData->addStatValue(
+      "link_monitor.platform_events.gaps", 1, fb303::SUM);
+  interfaceDbSyncTimer_->scheduleTimeout(std::chrono::milliseconds(0));
+}
+
 void
 LinkMonitor::processNeighborEvent(thrift::SparkNeighborEvent&& event) {
   auto neighborAddrV4 = event.neighbor.transportAddressV4;
@@ -957,6 +1289,16 @@ LinkMonitor::processNeighborEvent(thrift::SparkNeighborEvent&& event) {
           << (enableV4_ ? toString(neighborAddrV4) : "")
           << " Area:" << event.area;
 
+  const auto startTime = std::chrono::steady_clock::now();
+  neighborEventTs_ =
+      NeighborEventTs{event.area, startTime, getUnixTimeStampMs()};
+  SCOPE_EXIT {
+    neighborEventTs_.reset();
+    fb303::fbData->addHistogramValue(
+        "link_monitor.latency.neighbor_event_processed_us",
+        getElapsed<std::chrono::microseconds>(startTime));
+  };
+
   switch (event.eventType) {
   case thrift::SparkNeighborEventType::NEIGHBOR_UP: {
     logNeighborEvent(event);
@@ -1270,10 +1612,7 @@ LinkMonitor::logNeighborEvent(thrift::SparkNeighborEvent const& event) {
   sample.addString("area", event.area);
   sample.addInt("rtt_us", event.rttUs);
 
-  zmqMonitorClient_->addEventLog(fbzmq::thrift::EventLog(
-      apache::thrift::FRAGILE,
-      Constants::kEventLogCategory.toString(),
-      {sample.toJson()}));
+  eventLogger_->log(std::move(sample));
 }
 
 void
@@ -1295,10 +1634,7 @@ LinkMonitor::logLinkEvent(
   sample.addString("interface", iface);
   sample.addInt("backoff_ms", backoffTime.count());
 
-  zmqMonitorClient_->addEventLog(fbzmq::thrift::EventLog(
-      apache::thrift::FRAGILE,
-      Constants::kEventLogCategory.toString(),
-      {sample.toJson()}));
+  eventLogger_->log(std::move(sample));
 
   SYSLOG(INFO) << "Interface " << iface << " is " << event
                << " and has backoff of " << backoffTime.count() << "ms";
@@ -1316,10 +1652,7 @@ LinkMonitor::logPeerEvent(
   sample.addString("peer_name", peerName);
   sample.addString("cmd_url", peerSpec.cmdUrl);
 
-  zmqMonitorClient_->addEventLog(fbzmq::thrift::EventLog(
-      apache::thrift::FRAGILE,
-      Constants::kEventLogCategory.toString(),
-      {sample.toJson()}));
+  eventLogger_->log(std::move(sample));
 }
 
 } // namespace openr
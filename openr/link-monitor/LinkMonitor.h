@@ -9,13 +9,13 @@
 
 #include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
 #include <boost/serialization/strong_typedef.hpp>
 #include <fbzmq/async/ZmqThrottle.h>
 #include <fbzmq/async/ZmqTimeout.h>
-#include <fbzmq/service/monitor/ZmqMonitorClient.h>
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/CppAttributes.h>
 #include <folly/IPAddress.h>
@@ -30,6 +30,7 @@
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include <openr/allocators/RangeAllocator.h>
+#include <openr/common/EventLogger.h>
 #include <openr/common/OpenrEventBase.h>
 #include <openr/config-store/PersistentStore.h>
 #include <openr/if/gen-cpp2/Fib_types.h>
@@ -42,6 +43,7 @@
 #include <openr/kvstore/KvStoreClientInternal.h>
 #include <openr/link-monitor/InterfaceEntry.h>
 #include <openr/messaging/ReplicateQueue.h>
+#include <openr/platform/PlatformClients.h>
 #include <openr/platform/PlatformPublisher.h>
 #include <openr/spark/Spark.h>
 
@@ -55,6 +57,9 @@ struct AdjacencyValue {
   thrift::Adjacency adjacency;
   bool isRestarting{false};
   std::string area{};
+  // Last time metric got changed by RTT, and the RTT metric held back since
+  std::chrono::steady_clock::time_point lastMetricChange{};
+  std::optional<int32_t> pendingMetric{std::nullopt};
   AdjacencyValue() {}
   AdjacencyValue(
       thrift::PeerSpec spec,
@@ -130,7 +135,23 @@ class LinkMonitor final : public OpenrEventBase {
       // ttl for a key in the keyvalue store
       std::chrono::milliseconds ttlKeyInKvStore,
       const std::unordered_set<std::string>& areas = {
-          openr::thrift::KvStore_constants::kDefaultArea()});
+          openr::thrift::KvStore_constants::kDefaultArea()},
+      // advertise every adjacency in its own key, so that a change of single
+      // adjacency doesn't reflood all of them
+      bool perAdjacencyKeys = false,
+      // window over which neighbor down events are coalesced into one
+      // adjacency advertisement per area. 0 advertises on every event.
+      std::chrono::milliseconds neighborDownCoalesceWindow =
+          std::chrono::milliseconds(0),
+      // RTT metrics are rounded to a multiple of bucket size, and metric of
+      // an adjacency is changed at most once per hold time. Changes within
+      // hold time are applied once it expires.
+      int32_t rttMetricBucketSize = 1,
+      std::chrono::milliseconds rttMetricHoldTime =
+          std::chrono::milliseconds(0),
+      // SystemService handler running in-process, called directly instead of
+      // over thrift on platformThriftPort if set
+      std::shared_ptr<thrift::SystemServiceSvIf> systemHandler = nullptr);
 
   ~LinkMonitor() override = default;
 
@@ -201,6 +222,9 @@ class LinkMonitor final : public OpenrEventBase {
 
   void neighborRttChangeEvent(const thrift::SparkNeighborEvent& event);
 
+  // Apply RTT metrics held back by rttMetricHoldTime_ which are due
+  void applyPendingRttMetrics();
+
   // submit events to monitor
   void logNeighborEvent(thrift::SparkNeighborEvent const& event);
 
@@ -230,6 +254,20 @@ class LinkMonitor final : public OpenrEventBase {
   // Advertise my adjacencies_ to the KvStore to all areas
   void advertiseAdjacencies();
 
+  // Advertise my adjacencies_ to the KvStore in a throttled fashion. Calls
+  // while advertisement is pending are absorbed. Neighbor down events of an
+  // area use a separate (shorter) window.
+  void advertiseAdjacenciesThrottled();
+  void advertiseAdjacenciesOnNeighborDown(const std::string& area);
+
+  // Mark neighbor event being processed as pending for advertisement
+  void markNeighborEventPending();
+
+  // Advertise adjacencies of adjDb in per adjacency keys, and withdraw keys
+  // of adjacencies which are gone. Moves adjacencies out of adjDb.
+  void advertisePerAdjacencyKeys(
+      const std::string& area, thrift::AdjacencyDatabase& adjDb);
+
   // Advertise interfaces and addresses to Spark/Fib and PrefixManager
   // respectively
   void advertiseIfaceAddr();
@@ -253,6 +291,13 @@ class LinkMonitor final : public OpenrEventBase {
 
   void processNeighborEvent(thrift::SparkNeighborEvent&& event);
 
+  // Process link/address event from PlatformPublisher
+  void processPlatformEvent(const thrift::PlatformEvent& event);
+
+  // Track sequence numbers of batches of PlatformPublisher, and resync
+  // interfaces right away when some got lost
+  void processPlatformEventBatchSeqNum(int64_t publisherId, int64_t seqNum);
+
   // link events
   void logLinkEvent(
       const std::string& iface,
@@ -303,6 +348,13 @@ class LinkMonitor final : public OpenrEventBase {
   const std::chrono::milliseconds flapMaxBackoff_;
   // ttl for kvstore
   const std::chrono::milliseconds ttlKeyInKvStore_;
+  // advertise adjacencies in per adjacency keys
+  const bool perAdjacencyKeys_{false};
+  // coalescing window of neighbor down events
+  const std::chrono::milliseconds neighborDownCoalesceWindow_{0};
+  // dampening of RTT metric changes
+  const int32_t rttMetricBucketSize_{1};
+  const std::chrono::milliseconds rttMetricHoldTime_{0};
   // Timepoint used to hold off advertisement of link adjancecy on restart.
   const std::chrono::steady_clock::time_point adjHoldUntilTimePoint_;
   // The IO primitives provider; this is used for mocking
@@ -333,6 +385,11 @@ class LinkMonitor final : public OpenrEventBase {
   // Used to subscribe to netlink events from PlatformPublisher
   fbzmq::Socket<ZMQ_SUB, fbzmq::ZMQ_CLIENT> nlEventSub_;
 
+  // Publisher and sequence number of last batch of platform events received,
+  // 0 before the first one
+  int64_t platformPublisherId_{0};
+  int64_t platformEventSeqNum_{0};
+
   // used for communicating over thrift/zmq sockets
   apache::thrift::CompactSerializer serializer_;
 
@@ -352,11 +409,35 @@ class LinkMonitor final : public OpenrEventBase {
   // Keyed by interface Name
   std::unordered_map<std::string, InterfaceEntry> interfaces_;
 
+  // Active status of interfaces as last advertised to Spark/Fib. Used to
+  // advertise only the changed interfaces after the first full update.
+  std::unordered_map<std::string, bool> advertisedIfStatus_;
+  bool isInterfaceDbAdvertised_{false};
+
   // Throttled versions of "advertise<>" functions. It batches
   // up multiple calls and send them in one go!
   std::unique_ptr<fbzmq::ZmqThrottle> advertiseAdjacenciesThrottled_;
   std::unique_ptr<fbzmq::ZmqThrottle> advertiseIfaceAddrThrottled_;
 
+  // Throttled advertisement of areas with neighbors gone down
+  std::unique_ptr<fbzmq::ZmqThrottle> advertiseNeighborDownThrottled_;
+
+  // Arrival of neighbor event, used to measure latency of adjacency db
+  // advertisement triggered by it
+  struct NeighborEventTs {
+    std::string area;
+    std::chrono::steady_clock::time_point ts;
+    int64_t unixTsMs{0};
+  };
+  // Event being processed
+  std::optional<NeighborEventTs> neighborEventTs_;
+  // Oldest event of every area not yet reflected in advertised adjacency db
+  std::unordered_map<std::string, NeighborEventTs> pendingNeighborEventTs_;
+  std::unordered_set<std::string> neighborDownAreas_;
+
+  // Timer for applying RTT metrics held back by rttMetricHoldTime_
+  std::unique_ptr<fbzmq::ZmqTimeout> rttMetricHoldTimer_;
+
   // Timer for processing interfaces which are in backoff states
   std::unique_ptr<fbzmq::ZmqTimeout> advertiseIfaceAddrTimer_;
 
@@ -364,11 +445,13 @@ class LinkMonitor final : public OpenrEventBase {
   std::unique_ptr<fbzmq::ZmqTimeout> interfaceDbSyncTimer_;
   ExponentialBackoff<std::chrono::milliseconds> expBackoff_;
 
-  // Thrift client connection to switch SystemService, which we actually use to
-  // manipulate routes.
+  // Client of switch SystemService, which we actually use to manipulate
+  // routes. Handler running in-process is called directly, through thrift
+  // connection otherwise.
   folly::EventBase evb_;
   std::shared_ptr<folly::AsyncSocket> socket_;
-  std::unique_ptr<thrift::SystemServiceAsyncClient> client_;
+  std::shared_ptr<thrift::SystemServiceSvIf> systemHandler_;
+  std::unique_ptr<SystemServiceClient> client_;
 
   // client to interact with KvStore
   std::unique_ptr<KvStoreClientInternal> kvStoreClient_;
@@ -377,8 +460,8 @@ class LinkMonitor final : public OpenrEventBase {
   std::unordered_map<std::string /* area */, RangeAllocator<int32_t>>
       rangeAllocator_;
 
-  // client to interact with ZmqMonitor
-  std::unique_ptr<fbzmq::ZmqMonitorClient> zmqMonitorClient_;
+  // batched logger of events, submitting them to ZmqMonitor
+  std::unique_ptr<EventLogger> eventLogger_;
 
   // client to interact with ConfigStore
   PersistentStore* configStore_{nullptr};
@@ -386,6 +469,10 @@ class LinkMonitor final : public OpenrEventBase {
   // areas_ configured on this node
   std::unordered_set<std::string> areas_{};
 
+  // per adjacency keys currently advertised to each area
+  std::unordered_map<std::string /* area */, std::unordered_set<std::string>>
+      advertisedAdjacencyKeys_;
+
   // Timer for starting range allocator
   std::vector<std::unique_ptr<folly::AsyncTimeout>> startAllocationTimers_;
 
@@ -11,6 +11,7 @@
 #include <chrono>
 #include <thread>
 
+#include <fb303/ServiceData.h>
 #include <fbzmq/async/StopEventLoopSignalHandler.h>
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/Format.h>
@@ -377,7 +378,14 @@ class LinkMonitorTestFixture : public ::testing::Test {
   recvAndReplyIfUpdate() {
     auto ifDb = interfaceUpdatesReader.get();
     ASSERT_TRUE(ifDb.hasValue());
-    sparkIfDb = std::move(ifDb.value().interfaces);
+    lastIfDbIsDelta = ifDb->isDelta;
+    lastIfDbSize = ifDb->interfaces.size();
+    if (not ifDb->isDelta) {
+      sparkIfDb.clear();
+    }
+    for (auto& kv : ifDb->interfaces) {
+      sparkIfDb[kv.first] = std::move(kv.second);
+    }
     LOG(INFO) << "----------- Interface Updates ----------";
     for (const auto& kv : sparkIfDb) {
       LOG(INFO) << "  Name=" << kv.first << ", Status=" << kv.second.isUp
@@ -575,6 +583,8 @@ class LinkMonitorTestFixture : public ::testing::Test {
 
   std::queue<thrift::AdjacencyDatabase> expectedAdjDbs;
   std::map<std::string, thrift::InterfaceInfo> sparkIfDb;
+  bool lastIfDbIsDelta{false};
+  size_t lastIfDbSize{0};
 };
 
 // Start LinkMonitor and ensure empty adjacency database and prefixes are
@@ -1010,6 +1020,17 @@ TEST_F(LinkMonitorTestFixture, Throttle) {
   }
 
   checkNextAdjPub("adj:node-1");
+
+  // second neighbor up is absorbed by pending advertisement
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_LE(1, counters["link_monitor.neighbor_events_coalesced.sum"]);
+
+  // latency of neighbor events up to adjacency db in KvStore is exported
+  for (const auto& key :
+       {"link_monitor.latency.neighbor_event_processed_us.p50.60",
+        "link_monitor.latency.neighbor_event_to_kvstore_ms.p50.60"}) {
+    EXPECT_EQ(1, counters.count(key));
+  }
 }
 
 // parallel adjacencies between two nodes via different interfaces
@@ -1301,6 +1322,9 @@ TEST_F(LinkMonitorTestFixture, DampenLinkFlaps) {
       kTestVethIfIndex[0] /* ifIndex */,
       false /* is up */);
   recvAndReplyIfUpdate(); // Update will be sent immediately within 1ms
+  // Only the flapped interface is advertised
+  EXPECT_TRUE(lastIfDbIsDelta);
+  EXPECT_EQ(1, lastIfDbSize);
   mockNlHandler->sendLinkEvent(
       linkY /* link name */,
       kTestVethIfIndex[1] /* ifIndex */,
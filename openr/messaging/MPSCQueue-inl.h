@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+namespace openr {
+namespace messaging {
+
+template <typename ValueType>
+MPSCQueue<ValueType>::MPSCQueue(size_t capacity) : capacity_(capacity) {}
+
+template <typename ValueType>
+MPSCQueue<ValueType>::~MPSCQueue() {
+  close();
+}
+
+template <typename ValueType>
+template <typename ValueTypeT>
+bool
+MPSCQueue<ValueType>::push(ValueTypeT&& val) {
+  // If queue is closed, don't enqueue
+  if (closed_.load()) {
+    return false;
+  }
+
+  // Reserve slot. Release it back if queue is full
+  const auto prevSize = size_.fetch_add(1);
+  if (capacity_ != 0 and prevSize >= capacity_) {
+    size_.fetch_sub(1);
+    return false;
+  }
+
+  queue_.enqueue(std::forward<ValueTypeT>(val));
+
+  // Wake up reader only if it is waiting for data
+  if (readerWaiting_.exchange(false)) {
+    baton_.post();
+  }
+  return true;
+}
+
+template <typename ValueType>
+folly::Optional<ValueType>
+MPSCQueue<ValueType>::tryGet() {
+  auto maybeVal = queue_.try_dequeue();
+  if (maybeVal.has_value()) {
+    size_.fetch_sub(1);
+  }
+  return maybeVal;
+}
+
+template <typename ValueType>
+bool
+MPSCQueue<ValueType>::prepareWait() {
+  baton_.reset();
+  readerWaiting_.store(true);
+
+  // Writer may have enqueued data before it could see `readerWaiting_`.
+  // Re-check so that we never wait with data pending.
+  if (size_.load() != 0 or closed_.load()) {
+    // Writer which already claimed the wake up will post the baton. Wait for
+    // it, so that no post is in flight when baton is reset next time.
+    return not readerWaiting_.exchange(false);
+  }
+  return true;
+}
+
+template <typename ValueType>
+folly::Expected<ValueType, QueueError>
+MPSCQueue<ValueType>::get() {
+  while (not closed_.load()) {
+    if (auto maybeVal = tryGet()) {
+      return std::move(maybeVal).value();
+    }
+    if (prepareWait()) {
+      baton_.wait();
+    }
+  }
+  return folly::makeUnexpected(QueueError::QUEUE_CLOSED);
+}
+
+template <typename ValueType>
+folly::Expected<std::vector<ValueType>, QueueError>
+MPSCQueue<ValueType>::getBatch(size_t maxItems) {
+  auto maybeVal = get();
+  if (maybeVal.hasError()) {
+    return folly::makeUnexpected(maybeVal.error());
+  }
+
+  std::vector<ValueType> vals;
+  vals.emplace_back(std::move(maybeVal).value());
+  while (vals.size() < maxItems) {
+    auto val = tryGet();
+    if (not val.has_value()) {
+      break;
+    }
+    vals.emplace_back(std::move(val).value());
+  }
+  return vals;
+}
+
+#if FOLLY_HAS_COROUTINES
+template <typename ValueType>
+folly::coro::Task<folly::Expected<ValueType, QueueError>>
+MPSCQueue<ValueType>::getCoro() {
+  while (not closed_.load()) {
+    if (auto maybeVal = tryGet()) {
+      co_return std::move(maybeVal).value();
+    }
+    if (prepareWait()) {
+      co_await baton_;
+    }
+  }
+  co_return folly::makeUnexpected(QueueError::QUEUE_CLOSED);
+}
+#endif
+
+template <typename ValueType>
+void
+MPSCQueue<ValueType>::close() {
+  if (closed_.exchange(true)) {
+    return;
+  }
+
+  // Unblock waiting reader, if any
+  if (readerWaiting_.exchange(false)) {
+    baton_.post();
+  }
+
+  // NOTE: Pending data is not drained here as only reader may dequeue. It is
+  // never handed out and is released along with the queue.
+}
+
+template <typename ValueType>
+bool
+MPSCQueue<ValueType>::isClosed() {
+  return closed_.load();
+}
+
+template <typename ValueType>
+size_t
+MPSCQueue<ValueType>::size() {
+  // Pending data of closed queue is never handed out
+  return closed_.load() ? 0 : size_.load();
+}
+
+} // namespace messaging
+} // namespace openr
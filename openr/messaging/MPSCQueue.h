@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <folly/Expected.h>
+#include <folly/Optional.h>
+#include <folly/concurrency/UnboundedQueue.h>
+#include <folly/fibers/Baton.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/Task.h>
+#endif
+
+#include <openr/messaging/Queue.h>
+
+namespace openr {
+namespace messaging {
+
+/**
+ * Multiple writers and single reader. Unlike RWQueue no lock is taken on
+ * either push or get. Writers enqueue into a lock-free queue and only touch
+ * the reader's baton when the reader is parked waiting for data.
+ *
+ * Queue can optionally be bounded. Push into a full queue fails and returns
+ * false, same as push into a closed queue.
+ *
+ * After closing queue, all subsequent push are ignored and return false. All
+ * subsequent reads return QUEUE_CLOSED error
+ *
+ * NOTE: Only one fiber/thread must read from the queue at any time.
+ */
+template <typename ValueType>
+class MPSCQueue {
+ public:
+  /**
+   * Maximum number of pending elements. 0 means unbounded.
+   */
+  explicit MPSCQueue(size_t capacity = 0);
+  ~MPSCQueue();
+
+  /**
+   * non-copyable and non-movable
+   */
+  MPSCQueue(MPSCQueue const&) = delete;
+  MPSCQueue& operator=(MPSCQueue const&) = delete;
+
+  /**
+   * Non blocking push. Safe to call concurrently from any number of writers.
+   * Return false if queue is closed or full.
+   */
+  template <typename ValueTypeT>
+  bool push(ValueTypeT&& val);
+
+  /**
+   * Blocking read for native threads/fibers. In-case of fibers, the fiber
+   * performing blocking read will be suspended.
+   */
+  folly::Expected<ValueType, QueueError> get();
+
+  /**
+   * Blocking read of up to `maxItems` (at least one) elements. Waits until
+   * an element is available and then drains whatever is pending without
+   * waiting again.
+   */
+  folly::Expected<std::vector<ValueType>, QueueError> getBatch(
+      size_t maxItems);
+
+#if FOLLY_HAS_COROUTINES
+  /**
+   * Read methods for co-routines
+   */
+  folly::coro::Task<folly::Expected<ValueType, QueueError>> getCoro();
+#endif
+
+  /**
+   * Close the queue. All new push will be ignored and pending data will be lost
+   */
+  void close();
+  bool isClosed();
+
+  /**
+   * Return size of the current queue (number of data elements)
+   */
+  size_t size();
+
+  /**
+   * Return configured capacity. 0 means unbounded.
+   */
+  size_t
+  capacity() const {
+    return capacity_;
+  }
+
+ private:
+  /**
+   * Non blocking read. Return none if there is no data.
+   */
+  folly::Optional<ValueType> tryGet();
+
+  /**
+   * Arm baton and announce that reader is about to wait. Return false if
+   * data arrived meanwhile and there is no need to wait.
+   */
+  bool prepareWait();
+
+  const size_t capacity_{0};
+
+  // Lock-free storage for pending data
+  folly::UMPSCQueue<ValueType, false /* MayBlock */> queue_;
+
+  // Number of pending data elements, used for bounding the queue
+  std::atomic<size_t> size_{0};
+
+  // State of queue
+  std::atomic<bool> closed_{false};
+
+  // Set by reader before it waits on baton. Writer which clears it posts
+  // the baton.
+  std::atomic<bool> readerWaiting_{false};
+  folly::fibers::Baton baton_;
+};
+
+} // namespace messaging
+} // namespace openr
+
+#include <openr/messaging/MPSCQueue-inl.h>
@@ -22,6 +22,12 @@ RQueue<ValueType>::get() {
   return queue_->get();
 }
 
+template <typename ValueType>
+folly::Expected<std::vector<ValueType>, QueueError>
+RQueue<ValueType>::getBatch(size_t maxItems) {
+  return queue_->getBatch(maxItems);
+}
+
 #if FOLLY_HAS_COROUTINES
 template <typename ValueType>
 folly::coro::Task<folly::Expected<ValueType, QueueError>>
@@ -29,6 +35,13 @@ RQueue<ValueType>::getCoro() {
   auto val = co_await queue_->getCoro();
   co_return val;
 }
+
+template <typename ValueType>
+folly::coro::Task<folly::Expected<std::vector<ValueType>, QueueError>>
+RQueue<ValueType>::getBatchCoro(size_t maxItems) {
+  auto vals = co_await queue_->getBatchCoro(maxItems);
+  co_return vals;
+}
 #endif
 
 template <typename ValueType>
@@ -38,7 +51,22 @@ RQueue<ValueType>::size() {
 }
 
 template <typename ValueType>
-RWQueue<ValueType>::RWQueue() {}
+size_t
+RQueue<ValueType>::numDropped() {
+  return queue_->numDropped();
+}
+
+template <typename ValueType>
+size_t
+RQueue<ValueType>::numCoalesced() {
+  return queue_->numCoalesced();
+}
+
+template <typename ValueType>
+RWQueue<ValueType>::RWQueue(
+    ReaderOptions<ValueType> options, std::string timeInQueueKey)
+    : options_(std::move(options)),
+      timeInQueueKey_(std::move(timeInQueueKey)) {}
 
 template <typename ValueType>
 RWQueue<ValueType>::~RWQueue() {
@@ -62,9 +90,25 @@ RWQueue<ValueType>::push(ValueTypeT&& val) {
     pendingRead.data = std::forward<ValueTypeT>(val);
     pendingRead.baton.post();
     pendingReads_.pop_front();
+  } else if (options_.maxSize and queue_.size() >= options_.maxSize) {
+    // Queue is at its high-water mark
+    ValueType incoming(std::forward<ValueTypeT>(val));
+    if (options_.overflowPolicy == OverflowPolicy::COALESCE and
+        options_.coalesce) {
+      if (options_.coalesce(queue_.back().data, std::move(incoming))) {
+        ++numCoalesced_;
+        return true;
+      }
+    } else {
+      queue_.pop_front();
+      ++numDropped_;
+    }
+    queue_.emplace_back(
+        PendingData{std::move(incoming), std::chrono::steady_clock::now()});
   } else {
     // Add data into the queue
-    queue_.emplace_back(std::forward<ValueTypeT>(val));
+    queue_.emplace_back(PendingData{ValueType(std::forward<ValueTypeT>(val)),
+                                    std::chrono::steady_clock::now()});
   }
 
   return true;
@@ -95,7 +139,35 @@ RWQueue<ValueType>::get() {
   return folly::makeUnexpected(QueueError::QUEUE_CLOSED);
 }
 
+template <typename ValueType>
+folly::Expected<std::vector<ValueType>, QueueError>
+RWQueue<ValueType>::getBatch(size_t maxItems) {
+  auto maybeVal = get();
+  if (maybeVal.hasError()) {
+    return folly::makeUnexpected(maybeVal.error());
+  }
+
+  std::vector<ValueType> vals;
+  vals.emplace_back(std::move(maybeVal).value());
+  drainImpl(vals, maxItems);
+  return vals;
+}
+
 #if FOLLY_HAS_COROUTINES
+template <typename ValueType>
+folly::coro::Task<folly::Expected<std::vector<ValueType>, QueueError>>
+RWQueue<ValueType>::getBatchCoro(size_t maxItems) {
+  auto maybeVal = co_await getCoro();
+  if (maybeVal.hasError()) {
+    co_return folly::makeUnexpected(maybeVal.error());
+  }
+
+  std::vector<ValueType> vals;
+  vals.emplace_back(std::move(maybeVal).value());
+  drainImpl(vals, maxItems);
+  co_return vals;
+}
+
 template <typename ValueType>
 folly::coro::Task<folly::Expected<ValueType, QueueError>>
 RWQueue<ValueType>::getCoro() {
@@ -132,8 +204,7 @@ RWQueue<ValueType>::getAnyImpl(PendingRead& pendingRead) {
 
   // Perform immediate read if data is available
   if (queue_.size()) {
-    pendingRead.data = std::move(queue_.front());
-    queue_.pop_front();
+    pendingRead.data = popFrontImpl();
     return true;
   }
 
@@ -142,6 +213,32 @@ RWQueue<ValueType>::getAnyImpl(PendingRead& pendingRead) {
   return true;
 }
 
+template <typename ValueType>
+void
+RWQueue<ValueType>::drainImpl(std::vector<ValueType>& vals, size_t maxItems) {
+  std::lock_guard<std::mutex> l(lock_);
+
+  while (vals.size() < maxItems and queue_.size()) {
+    vals.emplace_back(popFrontImpl());
+  }
+}
+
+template <typename ValueType>
+ValueType
+RWQueue<ValueType>::popFrontImpl() {
+  auto& front = queue_.front();
+  if (not timeInQueueKey_.empty()) {
+    fb303::fbData->addHistogramValue(
+        timeInQueueKey_,
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - front.enqueueTime)
+            .count());
+  }
+  auto val = std::move(front.data);
+  queue_.pop_front();
+  return val;
+}
+
 template <typename ValueType>
 void
 RWQueue<ValueType>::close() {
@@ -182,5 +279,19 @@ RWQueue<ValueType>::numPendingReads() {
   return pendingReads_.size();
 }
 
+template <typename ValueType>
+size_t
+RWQueue<ValueType>::numDropped() {
+  std::lock_guard<std::mutex> l(lock_);
+  return numDropped_;
+}
+
+template <typename ValueType>
+size_t
+RWQueue<ValueType>::numCoalesced() {
+  std::lock_guard<std::mutex> l(lock_);
+  return numCoalesced_;
+}
+
 } // namespace messaging
 } // namespace openr
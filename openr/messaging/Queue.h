@@ -8,11 +8,16 @@
 #pragma once
 
 #include <any>
+#include <chrono>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include <fb303/ServiceData.h>
 #include <folly/Expected.h>
 #include <folly/fibers/Baton.h>
 #if FOLLY_HAS_COROUTINES
@@ -26,6 +31,34 @@ enum class QueueError {
   QUEUE_CLOSED,
 };
 
+/**
+ * Action taken when data is pushed into a queue which is at its high-water
+ * mark.
+ */
+enum class OverflowPolicy {
+  // Drop the oldest pending element. Reader can detect the loss through
+  // numDropped() and resync its state with the writer.
+  DROP_OLDEST,
+  // Merge the element into the most recent pending one. Falls back to
+  // DROP_OLDEST when no coalesce function is set.
+  COALESCE,
+};
+
+/**
+ * Options for bounding a reader queue
+ */
+template <typename ValueType>
+struct ReaderOptions {
+  // High-water mark for pending elements. 0 means unbounded.
+  size_t maxSize{0};
+
+  OverflowPolicy overflowPolicy{OverflowPolicy::DROP_OLDEST};
+
+  // Merge `incoming` into `pending`. Return false if the two can't be merged,
+  // in which case `incoming` is enqueued above the high-water mark.
+  std::function<bool(ValueType& pending, ValueType&& incoming)> coalesce;
+};
+
 template <typename ValueType>
 class RWQueue;
 
@@ -44,16 +77,30 @@ class RQueue {
    */
   folly::Expected<ValueType, QueueError> get();
 
+  /**
+   * Blocking read of up to `maxItems` (at least one) elements. Waits like
+   * get() for the first element and then drains whatever is already pending,
+   * so that consumers can coalesce a burst of updates in one wakeup.
+   */
+  folly::Expected<std::vector<ValueType>, QueueError> getBatch(
+      size_t maxItems);
+
 #if FOLLY_HAS_COROUTINES
   /**
    * Read methods for co-routines
    */
   folly::coro::Task<folly::Expected<ValueType, QueueError>> getCoro();
+  folly::coro::Task<folly::Expected<std::vector<ValueType>, QueueError>>
+  getBatchCoro(size_t maxItems);
 #endif
 
   // Utility function to retrieve size of pending data in underlying queue
   size_t size();
 
+  // Number of elements dropped or coalesced because of overflow
+  size_t numDropped();
+  size_t numCoalesced();
+
  protected:
   // We only hold reference of above queue
   std::shared_ptr<RWQueue<ValueType>> queue_{nullptr};
@@ -73,7 +120,12 @@ class RQueue {
 template <typename ValueType>
 class RWQueue {
  public:
-  RWQueue();
+  /**
+   * Time spent by each element in the queue is reported to fb303 histogram
+   * `timeInQueueKey`, if set. Histogram must be registered by the owner.
+   */
+  explicit RWQueue(
+      ReaderOptions<ValueType> options = {}, std::string timeInQueueKey = "");
   ~RWQueue();
 
   /**
@@ -89,11 +141,20 @@ class RWQueue {
    */
   folly::Expected<ValueType, QueueError> get();
 
+  /**
+   * Blocking read of up to `maxItems` (at least one) elements. Only the first
+   * element is waited for, rest are taken from pending data.
+   */
+  folly::Expected<std::vector<ValueType>, QueueError> getBatch(
+      size_t maxItems);
+
 #if FOLLY_HAS_COROUTINES
   /**
    * Read methods for co-routines
    */
   folly::coro::Task<folly::Expected<ValueType, QueueError>> getCoro();
+  folly::coro::Task<folly::Expected<std::vector<ValueType>, QueueError>>
+  getBatchCoro(size_t maxItems);
 #endif
 
   /**
@@ -112,6 +173,12 @@ class RWQueue {
    */
   size_t numPendingReads();
 
+  /**
+   * Return number of elements dropped or coalesced on overflow
+   */
+  size_t numDropped();
+  size_t numCoalesced();
+
  private:
   struct PendingRead {
     folly::fibers::Baton baton;
@@ -123,6 +190,27 @@ class RWQueue {
    */
   bool getAnyImpl(PendingRead& pendingRead);
 
+  /**
+   * Move up to `maxItems` pending elements into `vals` without waiting
+   */
+  void drainImpl(std::vector<ValueType>& vals, size_t maxItems);
+
+  /**
+   * Pop oldest pending element and report its time spent in queue
+   */
+  ValueType popFrontImpl();
+
+  struct PendingData {
+    ValueType data;
+    std::chrono::steady_clock::time_point enqueueTime;
+  };
+
+  // Bound and overflow handling of pending data
+  const ReaderOptions<ValueType> options_;
+
+  // fb303 histogram key for time spent in queue
+  const std::string timeInQueueKey_;
+
   // Lock to protect below private variables
   std::mutex lock_;
 
@@ -133,7 +221,11 @@ class RWQueue {
   std::deque<std::reference_wrapper<PendingRead>> pendingReads_;
 
   // Pending data
-  std::deque<ValueType> queue_;
+  std::deque<PendingData> queue_;
+
+  // Overflow counters
+  size_t numDropped_{0};
+  size_t numCoalesced_{0};
 };
 
 } // namespace messaging
@@ -7,11 +7,31 @@
 
 #pragma once
 
+#include <algorithm>
+
+#include <folly/Format.h>
+
 namespace openr {
 namespace messaging {
 
 template <typename ValueType>
-ReplicateQueue<ValueType>::ReplicateQueue() {}
+ReplicateQueue<ValueType>::ReplicateQueue(std::string name)
+    : name_(std::move(name)) {
+  if (name_.empty()) {
+    return;
+  }
+
+  const auto prefix = folly::sformat("messaging.{}.", name_);
+  depthKey_ = prefix + "depth";
+  maxDepthKey_ = prefix + "max_depth";
+  enqueuedKey_ = prefix + "enqueued";
+  timeInQueueKey_ = prefix + "time_in_queue_ms";
+  fb303::fbData->addStatExportType(enqueuedKey_, fb303::RATE);
+  fb303::fbData->addStatExportType(enqueuedKey_, fb303::SUM);
+  // 1ms buckets up to 1s
+  fb303::fbData->addHistogram(timeInQueueKey_, 1, 0, 1000);
+  fb303::fbData->exportHistogramPercentile(timeInQueueKey_, 50, 99, 100);
+}
 
 template <typename ValueType>
 ReplicateQueue<ValueType>::~ReplicateQueue() {
@@ -22,6 +42,21 @@ template <typename ValueType>
 template <typename ValueTypeT>
 bool
 ReplicateQueue<ValueType>::push(ValueTypeT&& value) {
+  using Traits = detail::SharedValueTraits<ValueType>;
+  if constexpr (
+      Traits::kIsShared and
+      std::is_same_v<std::decay_t<ValueTypeT>, typename Traits::ElementType>) {
+    return pushToReaders(std::make_shared<const typename Traits::ElementType>(
+        std::forward<ValueTypeT>(value)));
+  } else {
+    return pushToReaders(std::forward<ValueTypeT>(value));
+  }
+}
+
+template <typename ValueType>
+template <typename ValueTypeT>
+bool
+ReplicateQueue<ValueType>::pushToReaders(ValueTypeT&& value) {
   std::vector<std::shared_ptr<RWQueue<ValueType>>> readers;
 
   // Copy reader information - and cleans up stale reader
@@ -41,6 +76,10 @@ ReplicateQueue<ValueType>::push(ValueTypeT&& value) {
     }
   }
 
+  if (not name_.empty()) {
+    fb303::fbData->addStatValue(enqueuedKey_, 1);
+  }
+
   // Replicate messages
   if (readers.size()) {
     for (int i = 0; i < readers.size() - 1; i++) {
@@ -50,21 +89,44 @@ ReplicateQueue<ValueType>::push(ValueTypeT&& value) {
     readers.back()->push(std::forward<ValueTypeT>(value));
   }
 
+  if (not name_.empty()) {
+    updateDepthCounters(readers);
+  }
   return true;
 }
 
+template <typename ValueType>
+void
+ReplicateQueue<ValueType>::updateDepthCounters(
+    std::vector<std::shared_ptr<RWQueue<ValueType>>> const& readers) {
+  size_t depth{0};
+  for (auto const& reader : readers) {
+    depth = std::max(depth, reader->size());
+  }
+
+  size_t maxDepth{0};
+  {
+    auto lockedReaders = readers_.wlock();
+    maxDepth_ = std::max(maxDepth_, depth);
+    maxDepth = maxDepth_;
+  }
+  fb303::fbData->setCounter(depthKey_, depth);
+  fb303::fbData->setCounter(maxDepthKey_, maxDepth);
+}
+
 /**
  * Get new reader stream of this queue. Stream will get closed automatically
  * when reader is destructed.
  */
 template <typename ValueType>
 RQueue<ValueType>
-ReplicateQueue<ValueType>::getReader() {
+ReplicateQueue<ValueType>::getReader(ReaderOptions<ValueType> options) {
   auto lockedReaders = readers_.wlock();
   if (closed_) {
     throw std::runtime_error("queue is closed");
   }
-  lockedReaders->emplace_back(std::make_shared<RWQueue<ValueType>>());
+  lockedReaders->emplace_back(std::make_shared<RWQueue<ValueType>>(
+      std::move(options), timeInQueueKey_));
   return RQueue<ValueType>(lockedReaders->back());
 }
 
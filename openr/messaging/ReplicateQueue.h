@@ -7,22 +7,60 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
 #include <openr/messaging/Queue.h>
 
 namespace openr {
 namespace messaging {
 
+/**
+ * Immutable value shared by all readers of a ReplicateQueue. Replicating it
+ * costs one reference count bump per reader instead of a full copy of the
+ * payload, which matters for large objects fanned out to many readers.
+ */
+template <typename ValueType>
+using SharedValue = std::shared_ptr<const ValueType>;
+
+namespace detail {
+
+template <typename ValueType>
+struct SharedValueTraits {
+  static constexpr bool kIsShared = false;
+  using ElementType = void;
+};
+
+template <typename ValueType>
+struct SharedValueTraits<SharedValue<ValueType>> {
+  static constexpr bool kIsShared = true;
+  using ElementType = ValueType;
+};
+
+} // namespace detail
+
 /**
  * Multiple writers and readers. Each reader gets every written element push by
  * every writer. Writer pays the cost of replicating data to all readers. If no
  * reader exists then all the messages are silently dropped.
  *
- * Pushed object must be copy constructible.
+ * Pushed object must be copy constructible. Use ReplicateQueue<SharedValue<T>>
+ * to hand every reader the same immutable instance instead of its own copy.
  */
 template <typename ValueType>
 class ReplicateQueue {
  public:
-  ReplicateQueue();
+  /**
+   * Named queue exports its statistics to fb303 with `messaging.<name>.`
+   * prefix
+   * - depth: pending elements of the most loaded reader, updated on push
+   * - max_depth: highest depth seen so far
+   * - enqueued: rate of pushed elements
+   * - time_in_queue_ms: histogram of time between push and read
+   */
+  explicit ReplicateQueue(std::string name = "");
 
   ~ReplicateQueue();
 
@@ -41,15 +79,19 @@ class ReplicateQueue {
   /**
    * Push any value into the queue. Will get replicated to all the readers.
    * This also cleans up any lingering queue which has no active reader
+   *
+   * For ReplicateQueue<SharedValue<T>> a plain T can be pushed as well. It is
+   * wrapped into a single shared instance before replication.
    */
   template <typename ValueTypeT>
   bool push(ValueTypeT&& value);
 
   /**
    * Get new reader stream of this queue. Stream will get closed automatically
-   * when reader is destructed.
+   * when reader is destructed. Options bound pending data of this reader so
+   * that a slow reader can't grow memory without limit.
    */
-  RQueue<ValueType> getReader();
+  RQueue<ValueType> getReader(ReaderOptions<ValueType> options = {});
 
   /**
    * Number of replicated streams/readers
@@ -70,8 +112,28 @@ class ReplicateQueue {
   void close();
 
  private:
+  /**
+   * Update depth counters from current readers
+   */
+  void updateDepthCounters(
+      std::vector<std::shared_ptr<RWQueue<ValueType>>> const& readers);
+
+  /**
+   * Replicate value to all active readers
+   */
+  template <typename ValueTypeT>
+  bool pushToReaders(ValueTypeT&& value);
+
   folly::Synchronized<std::list<std::shared_ptr<RWQueue<ValueType>>>> readers_;
   bool closed_{false}; // Protected by above Synchronized lock
+
+  // Name and fb303 keys for exporting statistics. Empty if not exported
+  std::string name_;
+  std::string depthKey_;
+  std::string maxDepthKey_;
+  std::string enqueuedKey_;
+  std::string timeInQueueKey_;
+  size_t maxDepth_{0}; // Protected by above Synchronized lock
 };
 
 } // namespace messaging
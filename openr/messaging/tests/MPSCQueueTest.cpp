@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <folly/fibers/EventBaseLoopController.h>
+#include <folly/fibers/FiberManager.h>
+#include <folly/fibers/FiberManagerMap.h>
+#include <folly/io/async/EventBase.h>
+
+#include <openr/messaging/MPSCQueue.h>
+
+using namespace openr::messaging;
+
+TEST(MPSCQueueTest, OrderedPushGet) {
+  MPSCQueue<std::string> q;
+  EXPECT_EQ(0, q.capacity());
+
+  q.push(std::string("one"));
+  q.push(std::string("two"));
+  q.push(std::string("three"));
+
+  EXPECT_EQ(3, q.size());
+  EXPECT_EQ("one", q.get().value());
+  EXPECT_EQ(2, q.size());
+  EXPECT_EQ("two", q.get().value());
+  EXPECT_EQ(1, q.size());
+  EXPECT_EQ("three", q.get().value());
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(MPSCQueueTest, BoundedPush) {
+  MPSCQueue<int> q(2);
+  EXPECT_EQ(2, q.capacity());
+
+  EXPECT_TRUE(q.push(1));
+  EXPECT_TRUE(q.push(2));
+  EXPECT_FALSE(q.push(3)); // queue is full
+  EXPECT_EQ(2, q.size());
+
+  EXPECT_EQ(1, q.get().value());
+  EXPECT_TRUE(q.push(3)); // slot is released by read
+  EXPECT_EQ(2, q.get().value());
+  EXPECT_EQ(3, q.get().value());
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(MPSCQueueTest, BatchGet) {
+  MPSCQueue<int> q;
+  for (int i = 0; i < 5; ++i) {
+    q.push(i);
+  }
+
+  auto batch = q.getBatch(3);
+  ASSERT_TRUE(batch.hasValue());
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), batch.value());
+
+  batch = q.getBatch(10);
+  ASSERT_TRUE(batch.hasValue());
+  EXPECT_EQ(std::vector<int>({3, 4}), batch.value());
+  EXPECT_EQ(0, q.size());
+
+  // Batch read must wait for data
+  folly::EventBase evb;
+  auto& manager = folly::fibers::getFiberManager(evb);
+  manager.addTask([&q]() mutable {
+    auto batch = q.getBatch(10);
+    ASSERT_TRUE(batch.hasValue());
+    EXPECT_EQ(std::vector<int>({5}), batch.value());
+  });
+
+  evb.loopOnce(); // Fiber should get stuck at the read
+  q.push(5);
+  evb.loop();
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(MPSCQueueTest, ClosedPendingRead) {
+  MPSCQueue<int> q;
+
+  folly::EventBase evb;
+  auto& manager = folly::fibers::getFiberManager(evb);
+  manager.addTask([&q]() mutable {
+    EXPECT_FALSE(q.isClosed());
+    auto x = q.get(); // Perform read
+    EXPECT_TRUE(q.isClosed());
+    EXPECT_TRUE(x.hasError());
+    EXPECT_EQ(x.error(), QueueError::QUEUE_CLOSED);
+  });
+
+  evb.loopOnce(); // Fiber should get stuck at the read
+  EXPECT_EQ(0, q.size());
+
+  q.close();
+  evb.loop();
+  EXPECT_TRUE(q.isClosed());
+  EXPECT_EQ(q.get().error(), QueueError::QUEUE_CLOSED);
+  EXPECT_EQ(q.getBatch(1).error(), QueueError::QUEUE_CLOSED);
+}
+
+TEST(MPSCQueueTest, ClosedPendingData) {
+  MPSCQueue<int> q;
+
+  q.push(1);
+  q.push(2);
+  EXPECT_EQ(2, q.size());
+
+  q.close();
+  EXPECT_EQ(0, q.size());
+  EXPECT_FALSE(q.push(3));
+  EXPECT_EQ(q.get().error(), QueueError::QUEUE_CLOSED);
+}
+
+TEST(MPSCQueueTest, MultiThreadTest) {
+  const size_t kNumWriters{16};
+  const size_t kCountPerWriter{8192};
+  MPSCQueue<size_t> q;
+
+  // Single reader in a thread of its own
+  size_t totalReads{0};
+  size_t sum{0};
+  std::thread reader([&q, &totalReads, &sum, kNumWriters, kCountPerWriter]() {
+    while (totalReads < kNumWriters * kCountPerWriter) {
+      auto maybeNums = q.getBatch(64);
+      ASSERT_TRUE(maybeNums.hasValue());
+      for (auto num : maybeNums.value()) {
+        sum += num;
+      }
+      totalReads += maybeNums->size();
+    }
+  });
+
+  std::vector<std::thread> writers;
+  for (int i = 0; i < kNumWriters; ++i) {
+    writers.emplace_back([&q, i, kCountPerWriter]() {
+      for (int j = 0; j < kCountPerWriter; ++j) {
+        EXPECT_TRUE(q.push(i * kCountPerWriter + j));
+      }
+    });
+  }
+
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  reader.join();
+
+  const size_t kTotal = kNumWriters * kCountPerWriter;
+  EXPECT_EQ(kTotal, totalReads);
+  EXPECT_EQ(kTotal * (kTotal - 1) / 2, sum);
+  EXPECT_EQ(0, q.size());
+}
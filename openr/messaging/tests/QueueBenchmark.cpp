@@ -0,0 +1,271 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <thread>
+
+#include <folly/Format.h>
+#include <folly/IPAddress.h>
+#include <folly/fibers/EventBaseLoopController.h>
+#include <folly/fibers/FiberManager.h>
+#include <folly/fibers/FiberManagerMap.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/EventBase.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/BlockingWait.h>
+#endif
+
+#include <openr/common/NetworkUtil.h>
+#include <openr/common/Util.h>
+#include <openr/if/gen-cpp2/Fib_types.h>
+#include <openr/if/gen-cpp2/KvStore_types.h>
+#include <openr/messaging/MPSCQueue.h>
+#include <openr/messaging/Queue.h>
+#include <openr/messaging/ReplicateQueue.h>
+
+namespace {
+
+// The byte size of a value in publication
+const int kSizeOfValue = 1024;
+
+} // namespace
+
+namespace openr {
+
+/**
+ * Create publication with `numKeys` adjacency keys, similar to what KvStore
+ * floods to local readers
+ */
+thrift::Publication
+createPublication(size_t numKeys) {
+  thrift::Publication publication;
+  for (size_t i = 0; i < numKeys; ++i) {
+    thrift::Value value;
+    value.version = 1;
+    value.originatorId = folly::sformat("node-{}", i);
+    value.value = std::string(kSizeOfValue, 'a');
+    value.ttl = Constants::kTtlInfinity;
+    publication.keyVals.emplace(folly::sformat("adj:node-{}", i), value);
+  }
+  return publication;
+}
+
+/**
+ * Create route delta with `numRoutes` unicast routes of two nexthops each,
+ * similar to what Decision sends to Fib
+ */
+thrift::RouteDatabaseDelta
+createRouteDelta(size_t numRoutes) {
+  thrift::RouteDatabaseDelta routeDelta;
+  routeDelta.thisNodeName = "node-0";
+  const auto nh1 = createNextHop(
+      toBinaryAddress(folly::IPAddress("fe80::1")), std::string("iface1"), 1);
+  const auto nh2 = createNextHop(
+      toBinaryAddress(folly::IPAddress("fe80::2")), std::string("iface2"), 1);
+  for (size_t i = 0; i < numRoutes; ++i) {
+    routeDelta.unicastRoutesToUpdate.emplace_back(createUnicastRoute(
+        toIpPrefix(folly::sformat("fd00:{:x}::/64", i)), {nh1, nh2}));
+  }
+  return routeDelta;
+}
+
+/**
+ * Push value into ReplicateQueue with `numReaders` readers and read it back
+ * from every reader
+ */
+template <typename ValueType, typename PushType>
+void
+replicateQueuePushGet(
+    uint32_t iters, size_t numReaders, PushType const& value) {
+  auto suspender = folly::BenchmarkSuspender();
+  messaging::ReplicateQueue<ValueType> q;
+  std::vector<messaging::RQueue<ValueType>> readers;
+  for (size_t i = 0; i < numReaders; ++i) {
+    readers.emplace_back(q.getReader());
+  }
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    q.push(value);
+    for (auto& reader : readers) {
+      folly::doNotOptimizeAway(reader.get());
+    }
+  }
+
+  suspender.rehire(); // Stop measuring time again
+  q.close();
+}
+
+/**
+ * Benchmark push/get of RWQueue when data is already available, for given
+ * number of routes in delta
+ */
+static void
+BM_RWQueuePushGet(uint32_t iters, size_t numRoutes) {
+  auto suspender = folly::BenchmarkSuspender();
+  messaging::RWQueue<thrift::RouteDatabaseDelta> q;
+  const auto routeDelta = createRouteDelta(numRoutes);
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    q.push(routeDelta);
+    folly::doNotOptimizeAway(q.get());
+  }
+}
+
+/**
+ * Benchmark blocking get of RWQueue in fiber, where every read waits for the
+ * writer and every push wakes up the reader
+ */
+static void
+BM_RWQueueFiberGet(uint32_t iters, size_t numRoutes) {
+  auto suspender = folly::BenchmarkSuspender();
+  messaging::RWQueue<thrift::RouteDatabaseDelta> q;
+  const auto routeDelta = createRouteDelta(numRoutes);
+  folly::EventBase evb;
+  auto& manager = folly::fibers::getFiberManager(evb);
+  manager.addTask([&q, iters]() {
+    for (uint32_t i = 0; i < iters; ++i) {
+      folly::doNotOptimizeAway(q.get());
+    }
+  });
+  manager.addTask([&q, &routeDelta, iters]() {
+    for (uint32_t i = 0; i < iters; ++i) {
+      q.push(routeDelta);
+      folly::fibers::yield();
+    }
+  });
+  suspender.dismiss(); // Start measuring benchmark time
+
+  evb.loop();
+}
+
+#if FOLLY_HAS_COROUTINES
+/**
+ * Benchmark getCoro of RWQueue when data is already available
+ */
+static void
+BM_RWQueueCoroGet(uint32_t iters, size_t numRoutes) {
+  auto suspender = folly::BenchmarkSuspender();
+  messaging::RWQueue<thrift::RouteDatabaseDelta> q;
+  const auto routeDelta = createRouteDelta(numRoutes);
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    q.push(routeDelta);
+    folly::doNotOptimizeAway(folly::coro::blockingWait(q.getCoro()));
+  }
+}
+#endif
+
+/**
+ * Benchmark replication of publication with `numKeys` keys to `numReaders`
+ * readers. Every reader receives its own copy.
+ */
+static void
+BM_ReplicateQueueCopy(uint32_t iters, size_t numReaders, size_t numKeys) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto publication = createPublication(numKeys);
+  suspender.dismiss();
+
+  replicateQueuePushGet<thrift::Publication>(iters, numReaders, publication);
+}
+
+/**
+ * Same as above but readers share a single immutable publication
+ */
+static void
+BM_ReplicateQueueShared(uint32_t iters, size_t numReaders, size_t numKeys) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto publication =
+      std::make_shared<const thrift::Publication>(createPublication(numKeys));
+  suspender.dismiss();
+
+  replicateQueuePushGet<messaging::SharedValue<thrift::Publication>>(
+      iters, numReaders, publication);
+}
+
+/**
+ * Benchmark throughput of `numWriters` threads pushing into a single
+ * reader. Compares RWQueue with MPSCQueue.
+ */
+template <typename QueueType>
+void
+multiWriterThroughput(uint32_t iters, size_t numWriters) {
+  auto suspender = folly::BenchmarkSuspender();
+  QueueType q;
+  const uint32_t itersPerWriter = std::max<uint32_t>(iters / numWriters, 1);
+  suspender.dismiss(); // Start measuring benchmark time
+
+  std::vector<std::thread> writers;
+  for (size_t i = 0; i < numWriters; ++i) {
+    writers.emplace_back([&q, itersPerWriter]() {
+      for (uint32_t j = 0; j < itersPerWriter; ++j) {
+        q.push(j);
+      }
+    });
+  }
+  for (uint32_t i = 0; i < itersPerWriter * numWriters; ++i) {
+    folly::doNotOptimizeAway(q.get());
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+}
+
+static void
+BM_RWQueueMultiWriter(uint32_t iters, size_t numWriters) {
+  multiWriterThroughput<messaging::RWQueue<uint32_t>>(iters, numWriters);
+}
+
+static void
+BM_MPSCQueueMultiWriter(uint32_t iters, size_t numWriters) {
+  multiWriterThroughput<messaging::MPSCQueue<uint32_t>>(iters, numWriters);
+}
+
+// The parameter is number of routes in delta
+BENCHMARK_PARAM(BM_RWQueuePushGet, 1);
+BENCHMARK_PARAM(BM_RWQueuePushGet, 100);
+BENCHMARK_PARAM(BM_RWQueuePushGet, 10000);
+
+BENCHMARK_PARAM(BM_RWQueueFiberGet, 1);
+BENCHMARK_PARAM(BM_RWQueueFiberGet, 100);
+BENCHMARK_PARAM(BM_RWQueueFiberGet, 10000);
+
+#if FOLLY_HAS_COROUTINES
+BENCHMARK_PARAM(BM_RWQueueCoroGet, 1);
+BENCHMARK_PARAM(BM_RWQueueCoroGet, 100);
+BENCHMARK_PARAM(BM_RWQueueCoroGet, 10000);
+#endif
+
+// The first parameter is number of readers
+// The second parameter is number of keys in publication
+BENCHMARK_NAMED_PARAM(BM_ReplicateQueueCopy, 1_10, 1, 10);
+BENCHMARK_NAMED_PARAM(BM_ReplicateQueueCopy, 4_10, 4, 10);
+BENCHMARK_NAMED_PARAM(BM_ReplicateQueueCopy, 4_1000, 4, 1000);
+BENCHMARK_NAMED_PARAM(BM_ReplicateQueueCopy, 16_1000, 16, 1000);
+BENCHMARK_NAMED_PARAM(BM_ReplicateQueueShared, 1_10, 1, 10);
+BENCHMARK_NAMED_PARAM(BM_ReplicateQueueShared, 4_10, 4, 10);
+BENCHMARK_NAMED_PARAM(BM_ReplicateQueueShared, 4_1000, 4, 1000);
+BENCHMARK_NAMED_PARAM(BM_ReplicateQueueShared, 16_1000, 16, 1000);
+
+// The parameter is number of writer threads
+BENCHMARK_PARAM(BM_RWQueueMultiWriter, 1);
+BENCHMARK_PARAM(BM_RWQueueMultiWriter, 4);
+BENCHMARK_PARAM(BM_RWQueueMultiWriter, 16);
+BENCHMARK_PARAM(BM_MPSCQueueMultiWriter, 1);
+BENCHMARK_PARAM(BM_MPSCQueueMultiWriter, 4);
+BENCHMARK_PARAM(BM_MPSCQueueMultiWriter, 16);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -67,6 +67,88 @@ TEST(RWQueueTest, OrderedPushGet) {
   EXPECT_EQ(0, q.size());
 }
 
+TEST(RWQueueTest, BatchGet) {
+  RWQueue<int> q;
+  for (int i = 0; i < 5; ++i) {
+    q.push(i);
+  }
+
+  auto batch = q.getBatch(3);
+  ASSERT_TRUE(batch.hasValue());
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), batch.value());
+  EXPECT_EQ(2, q.size());
+
+  batch = q.getBatch(10);
+  ASSERT_TRUE(batch.hasValue());
+  EXPECT_EQ(std::vector<int>({3, 4}), batch.value());
+  EXPECT_EQ(0, q.size());
+
+  // Batch read waits only for the first element
+  folly::EventBase evb;
+  auto& manager = folly::fibers::getFiberManager(evb);
+  manager.addTask([&q]() mutable {
+    auto batch = q.getBatch(10);
+    ASSERT_TRUE(batch.hasValue());
+    EXPECT_EQ(std::vector<int>({5}), batch.value());
+    EXPECT_EQ(q.getBatch(10).error(), QueueError::QUEUE_CLOSED);
+  });
+
+  evb.loopOnce();
+  EXPECT_EQ(1, q.numPendingReads());
+
+  q.push(5);
+  evb.loopOnce();
+  q.close();
+  evb.loop();
+  EXPECT_EQ(0, q.numPendingReads());
+}
+
+TEST(RWQueueTest, OverflowDropOldest) {
+  ReaderOptions<int> options;
+  options.maxSize = 2;
+  RWQueue<int> q(std::move(options));
+
+  EXPECT_TRUE(q.push(1));
+  EXPECT_TRUE(q.push(2));
+  EXPECT_TRUE(q.push(3));
+  EXPECT_EQ(2, q.size());
+  EXPECT_EQ(1, q.numDropped());
+  EXPECT_EQ(0, q.numCoalesced());
+
+  EXPECT_EQ(2, q.get().value());
+  EXPECT_EQ(3, q.get().value());
+}
+
+TEST(RWQueueTest, OverflowCoalesce) {
+  ReaderOptions<std::vector<int>> options;
+  options.maxSize = 2;
+  options.overflowPolicy = OverflowPolicy::COALESCE;
+  options.coalesce = [](std::vector<int>& pending, std::vector<int>&& val) {
+    if (val.empty()) {
+      return false;
+    }
+    pending.insert(pending.end(), val.begin(), val.end());
+    return true;
+  };
+  RWQueue<std::vector<int>> q(std::move(options));
+
+  q.push(std::vector<int>{1});
+  q.push(std::vector<int>{2});
+  q.push(std::vector<int>{3});
+  q.push(std::vector<int>{4});
+  EXPECT_EQ(2, q.size());
+  EXPECT_EQ(2, q.numCoalesced());
+  EXPECT_EQ(0, q.numDropped());
+
+  // Element that can't be coalesced goes above high-water mark
+  q.push(std::vector<int>{});
+  EXPECT_EQ(3, q.size());
+
+  EXPECT_EQ(std::vector<int>({1}), q.get().value());
+  EXPECT_EQ(std::vector<int>({2, 3, 4}), q.get().value());
+  EXPECT_EQ(std::vector<int>(), q.get().value());
+}
+
 TEST(RWQueueTest, ClosedPendingReads) {
   RWQueue<int> q;
 
@@ -7,6 +7,8 @@
 
 #include <gtest/gtest.h>
 
+#include <fb303/ServiceData.h>
+#include <folly/Format.h>
 #include <folly/fibers/EventBaseLoopController.h>
 #include <folly/fibers/FiberManager.h>
 #include <folly/fibers/FiberManagerMap.h>
@@ -84,3 +86,59 @@ TEST(ReplicateQueueTest, OpenQueueTest) {
 
   q.close();
 }
+
+TEST(ReplicateQueueTest, SharedValueTest) {
+  ReplicateQueue<SharedValue<std::string>> q;
+  auto r1 = q.getReader();
+  auto r2 = q.getReader();
+
+  // push plain value, it must be wrapped into one shared instance
+  EXPECT_TRUE(q.push(std::string("publication")));
+  auto v1 = r1.get();
+  auto v2 = r2.get();
+  ASSERT_TRUE(v1.hasValue());
+  ASSERT_TRUE(v2.hasValue());
+  EXPECT_EQ("publication", *v1.value());
+  EXPECT_EQ(v1.value().get(), v2.value().get());
+
+  // push shared value, readers must receive the same instance
+  auto value = std::make_shared<const std::string>("update");
+  EXPECT_TRUE(q.push(value));
+  EXPECT_EQ(value.get(), r1.get().value().get());
+  EXPECT_EQ(value.get(), r2.get().value().get());
+  EXPECT_EQ(1, value.use_count());
+
+  q.close();
+}
+
+TEST(ReplicateQueueTest, NamedQueueCounters) {
+  ReplicateQueue<int> q("test_queue");
+  auto r1 = q.getReader();
+  auto r2 = q.getReader();
+
+  q.push(1);
+  q.push(2);
+  EXPECT_EQ(1, r2.get().value());
+
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(2, counters.at("messaging.test_queue.depth"));
+  EXPECT_EQ(2, counters.at("messaging.test_queue.max_depth"));
+  EXPECT_EQ(2, counters.at("messaging.test_queue.enqueued.sum"));
+
+  // Depth is refreshed on push, max depth is retained
+  EXPECT_EQ(1, r1.get().value());
+  EXPECT_EQ(2, r1.get().value());
+  EXPECT_EQ(2, r2.get().value());
+  q.push(3);
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(1, counters.at("messaging.test_queue.depth"));
+  EXPECT_EQ(2, counters.at("messaging.test_queue.max_depth"));
+  for (auto const& stat : {"p50", "p99", "p100"}) {
+    EXPECT_EQ(
+        1,
+        counters.count(folly::sformat(
+            "messaging.test_queue.time_in_queue_ms.{}.60", stat)));
+  }
+
+  q.close();
+}
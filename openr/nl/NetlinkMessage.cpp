@@ -7,13 +7,60 @@
 
 #include <openr/nl/NetlinkMessage.h>
 
+#include <algorithm>
+
 namespace openr::fbnl {
 
+std::unique_ptr<NetlinkMessageBuffer>
+NetlinkMessageBufferPool::acquire() {
+  {
+    auto buffers = getBuffers().wlock();
+    if (not buffers->empty()) {
+      auto buffer = std::move(buffers->back());
+      buffers->pop_back();
+      return buffer;
+    }
+  }
+  return std::make_unique<NetlinkMessageBuffer>();
+}
+
+void
+NetlinkMessageBufferPool::release(
+    std::unique_ptr<NetlinkMessageBuffer> buffer, uint32_t usedBytes) {
+  if (not buffer) {
+    return;
+  }
+  // Message may be aligned past its length
+  const size_t length = std::min<size_t>(
+      NLMSG_ALIGN(std::max<uint32_t>(usedBytes, NLMSG_HDRLEN)),
+      buffer->size());
+  ::memset(buffer->data(), 0, length);
+
+  auto buffers = getBuffers().wlock();
+  if (buffers->size() < kMaxNlPooledBuffers) {
+    buffers->emplace_back(std::move(buffer));
+  }
+}
+
+size_t
+NetlinkMessageBufferPool::size() {
+  return getBuffers().rlock()->size();
+}
+
+folly::Synchronized<NetlinkMessageBufferPool::Buffers>&
+NetlinkMessageBufferPool::getBuffers() {
+  // Leaked intentionally, as messages may outlive static destruction
+  static auto* buffers = new folly::Synchronized<Buffers>();
+  return *buffers;
+}
+
 NetlinkMessage::NetlinkMessage()
-    : msghdr(reinterpret_cast<struct nlmsghdr*>(msg.data())) {}
+    : buffer_(NetlinkMessageBufferPool::acquire()),
+      msghdr(reinterpret_cast<struct nlmsghdr*>(buffer_->data())) {}
 
 NetlinkMessage::NetlinkMessage(int type)
-    : msghdr(reinterpret_cast<struct nlmsghdr*>(msg.data())) {
+    : buffer_(NetlinkMessageBufferPool::acquire()),
+      msghdr(reinterpret_cast<struct nlmsghdr*>(buffer_->data())) {
   // initialize netlink header
   msghdr->nlmsg_len = NLMSG_LENGTH(0);
   msghdr->nlmsg_type = type;
@@ -21,6 +68,7 @@ NetlinkMessage::NetlinkMessage(int type)
 
 NetlinkMessage::~NetlinkMessage() {
   CHECK(promise_.isFulfilled());
+  NetlinkMessageBufferPool::release(std::move(buffer_), msghdr->nlmsg_len);
 }
 
 struct nlmsghdr*
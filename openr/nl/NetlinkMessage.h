@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include <limits.h>
 #include <linux/lwtunnel.h>
@@ -17,6 +19,7 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
+#include <folly/Synchronized.h>
 #include <folly/futures/Future.h>
 
 #include <openr/nl/NetlinkTypes.h>
@@ -25,6 +28,36 @@ namespace openr::fbnl {
 
 constexpr uint16_t kMaxNlPayloadSize{4096};
 
+// Maximum number of free buffers retained by NetlinkMessageBufferPool
+constexpr size_t kMaxNlPooledBuffers{4096};
+
+using NetlinkMessageBuffer = std::array<char, kMaxNlPayloadSize>;
+
+/**
+ * Process wide pool of message buffers. Netlink messages are built on
+ * requester's thread and destroyed on event loop of netlink socket after ack,
+ * hence pool is shared across threads. Buffers are zeroed again on release,
+ * only as far as message was written, so that programming of many routes
+ * neither allocates nor clears full buffers for every message.
+ */
+class NetlinkMessageBufferPool {
+ public:
+  // Get zeroed buffer. Allocated if pool is empty.
+  static std::unique_ptr<NetlinkMessageBuffer> acquire();
+
+  // Return buffer to pool. First `usedBytes` of buffer may be non-zero.
+  static void release(
+      std::unique_ptr<NetlinkMessageBuffer> buffer, uint32_t usedBytes);
+
+  // Number of free buffers in pool
+  static size_t size();
+
+ private:
+  using Buffers = std::vector<std::unique_ptr<NetlinkMessageBuffer>>;
+
+  static folly::Synchronized<Buffers>& getBuffers();
+};
+
 /**
  * Data structure representing a netlink message, either to be sent or received.
  * It wraps `struct nlmsghdr` and provides buffer for appending message payload.
@@ -51,9 +84,6 @@ class NetlinkMessage {
   // get current length
   uint32_t getDataLength() const;
 
-  // Buffer to create message
-  std::array<char, kMaxNlPayloadSize> msg = {};
-
   /**
    * APIs for accumulating objects of `GET_<>` request. These APIs are invoked
    * when an object is received from kernel in-response to this netlink-message.
@@ -69,6 +99,13 @@ class NetlinkMessage {
     CHECK(false) << "Must be implemented by subclass";
   }
 
+  // Same as above but with unparsed message, so that route can be skipped
+  // without being parsed
+  virtual void
+  rcvdRouteMessage(const struct nlmsghdr* /* nlh */) {
+    CHECK(false) << "Must be implemented by subclass";
+  }
+
   virtual void
   rcvdLink(Link&& /* link */) {
     CHECK(false) << "Must be implemented by subclass";
@@ -149,6 +186,9 @@ class NetlinkMessage {
   NetlinkMessage(NetlinkMessage const&) = delete;
   NetlinkMessage& operator=(NetlinkMessage const&) = delete;
 
+  // Buffer to create message, from NetlinkMessageBufferPool
+  std::unique_ptr<NetlinkMessageBuffer> buffer_;
+
   // pointer to the netlink message header
   struct nlmsghdr* const msghdr{nullptr};
 
@@ -5,9 +5,14 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <iterator>
+#include <numeric>
 #include <thread>
 
 #include <fb303/ServiceData.h>
+#include <folly/Format.h>
+#include <folly/hash/Hash.h>
+#include <folly/system/ThreadName.h>
 
 #include <openr/common/Util.h>
 #include <openr/nl/NetlinkProtocolSocket.h>
@@ -17,9 +22,41 @@ namespace fb303 = facebook::fb303;
 namespace openr::fbnl {
 
 NetlinkProtocolSocket::NetlinkProtocolSocket(
-    fbzmq::ZmqEventLoop* evl, bool enableIPv6RouteReplaceSemantics)
+    fbzmq::ZmqEventLoop* evl,
+    bool enableIPv6RouteReplaceSemantics,
+    size_t numRouteShards)
     : evl_(evl),
       enableIPv6RouteReplaceSemantics_(enableIPv6RouteReplaceSemantics) {
+  // Create route shards other than this one, each in a new thread. They must
+  // exist before our event loop starts using them.
+  for (size_t i = 1; i < numRouteShards; ++i) {
+    // ATTN: intentionally set evl capacity to be 1e5 instead of default 1e2
+    auto shardEvl = std::make_unique<fbzmq::ZmqEventLoop>(1e5);
+    routeShards_.emplace_back(new NetlinkProtocolSocket(
+        shardEvl.get(), enableIPv6RouteReplaceSemantics, RouteShardTag{}));
+    routeShardThreads_.emplace_back([evl = shardEvl.get(), i]() {
+      folly::setThreadName(folly::sformat("NetlinkShard{}", i));
+      evl->run();
+    });
+    shardEvl->waitUntilRunning();
+    routeShardEvls_.emplace_back(std::move(shardEvl));
+  }
+
+  setupEventLoop();
+}
+
+NetlinkProtocolSocket::NetlinkProtocolSocket(
+    fbzmq::ZmqEventLoop* evl,
+    bool enableIPv6RouteReplaceSemantics,
+    RouteShardTag)
+    : evl_(evl),
+      enableIPv6RouteReplaceSemantics_(enableIPv6RouteReplaceSemantics),
+      isRouteShard_(true) {
+  setupEventLoop();
+}
+
+void
+NetlinkProtocolSocket::setupEventLoop() {
   nlMessageTimer_ = fbzmq::ZmqTimeout::make(evl_, [this]() noexcept {
     DCHECK(false) << "This shouldn't occur usually. Adding DCHECK to get "
                   << "attention in UTs";
@@ -39,6 +76,10 @@ NetlinkProtocolSocket::NetlinkProtocolSocket(
     nlSeqNumMap_.clear(); // Clear all timed out requests
     evl_->removeSocketFd(nlSock_);
     close(nlSock_);
+    if (nlRouteSock_ >= 0) {
+      evl_->removeSocketFd(nlRouteSock_);
+      close(nlRouteSock_);
+    }
     init();
 
     LOG(INFO) << "Resume sending bufferred netlink messages";
@@ -57,12 +98,25 @@ NetlinkProtocolSocket::init() {
     LOG(FATAL) << "Netlink socket create failed.";
   }
   VLOG(1) << "Created netlink socket. fd=" << nlSock_;
-  int size = kNetlinkSockRecvBuf;
+  int size = recvBufSize_;
   // increase socket recv buffer size
   if (setsockopt(nlSock_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0) {
     LOG(FATAL) << "Netlink socket set recv buffer failed.";
   };
 
+  // increase socket send buffer size. Kernel reports back doubled and capped
+  // value. Half of it is used per sendmsg, leaving room for overhead.
+  size = kNetlinkSockSendBuf;
+  if (setsockopt(nlSock_, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)) < 0) {
+    LOG(FATAL) << "Netlink socket set send buffer failed.";
+  };
+  socklen_t sizeLen = sizeof(size);
+  if (getsockopt(nlSock_, SOL_SOCKET, SO_SNDBUF, &size, &sizeLen) == 0 and
+      size > 0) {
+    maxSendBytes_ = static_cast<uint32_t>(size) / 2;
+  }
+  VLOG(1) << "Netlink socket max send bytes: " << maxSendBytes_;
+
   // Bind on the source address. We let kernel chose the available port-ID
   struct sockaddr_nl saddr;
   ::memset(&saddr, 0, sizeof(saddr));
@@ -70,10 +124,12 @@ NetlinkProtocolSocket::init() {
   saddr.nl_pid = 0; // We let kernel assign the port-ID
   /* We can subscribe to different Netlink mutlicast groups for specific types
    * of events: link, IPv4/IPv6 address and neighbor. */
-  saddr.nl_groups = RTMGRP_LINK // listen for link events
-      | RTMGRP_IPV4_IFADDR // listen for IPv4 address events
-      | RTMGRP_IPV6_IFADDR // listen for IPv6 address events
-      | RTMGRP_NEIGH; // listen for Neighbor (ARP) events
+  if (not isRouteShard_) {
+    saddr.nl_groups = RTMGRP_LINK // listen for link events
+        | RTMGRP_IPV4_IFADDR // listen for IPv4 address events
+        | RTMGRP_IPV6_IFADDR // listen for IPv6 address events
+        | RTMGRP_NEIGH; // listen for Neighbor (ARP) events
+  }
 
   if (bind(nlSock_, (struct sockaddr*)&saddr, sizeof(saddr)) != 0) {
     LOG(FATAL) << "Failed to bind netlink socket: " << folly::errnoStr(errno);
@@ -90,6 +146,52 @@ NetlinkProtocolSocket::init() {
       fb303::fbData->addStatValue("netlink.errors", 1, fb303::SUM);
     }
   });
+
+  // Route shards leave notifications to the first one
+  if (isRouteShard_) {
+    return;
+  }
+
+  // Create route event socket
+  nlRouteSock_ = ::socket(PF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+  if (nlRouteSock_ < 0) {
+    LOG(FATAL) << "Netlink route event socket create failed.";
+  }
+  size = kNetlinkSockRecvBuf;
+  if (setsockopt(
+          nlRouteSock_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0) {
+    LOG(FATAL) << "Netlink route event socket set recv buffer failed.";
+  };
+  struct sockaddr_nl routeSaddr;
+  ::memset(&routeSaddr, 0, sizeof(routeSaddr));
+  routeSaddr.nl_family = AF_NETLINK;
+  routeSaddr.nl_groups = RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE;
+  if (bind(nlRouteSock_, (struct sockaddr*)&routeSaddr, sizeof(routeSaddr)) !=
+      0) {
+    LOG(FATAL) << "Failed to bind netlink route event socket: "
+               << folly::errnoStr(errno);
+  }
+  // MPLS route group doesn't fit in legacy group mask. Kernel may lack MPLS.
+  int mplsGroup = RTNLGRP_MPLS_ROUTE;
+  if (setsockopt(
+          nlRouteSock_,
+          SOL_NETLINK,
+          NETLINK_ADD_MEMBERSHIP,
+          &mplsGroup,
+          sizeof(mplsGroup)) < 0) {
+    LOG(WARNING) << "Failed to subscribe MPLS route events: "
+                 << folly::errnoStr(errno);
+  }
+
+  evl_->addSocketFd(nlRouteSock_, ZMQ_POLLIN, [this](int) noexcept {
+    try {
+      recvRouteEvents();
+    } catch (std::exception const& err) {
+      LOG(ERROR) << "error processing NL route event"
+                 << folly::exceptionStr(err);
+      fb303::fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+    }
+  });
 }
 
 void
@@ -110,6 +212,46 @@ NetlinkProtocolSocket::setNeighborEventCB(
   neighborEventCB_ = neighborEventCB;
 }
 
+void
+NetlinkProtocolSocket::setRouteEventCB(
+    std::function<void(fbnl::Route, bool)> routeEventCB) {
+  routeEventCB_ = routeEventCB;
+}
+
+uint64_t
+NetlinkProtocolSocket::addLinkAddrListener(LinkAddrListener listener) {
+  auto listeners = linkAddrListeners_.wlock();
+  const auto listenerId = listeners->nextId++;
+  listeners->listeners.emplace(listenerId, std::move(listener));
+  return listenerId;
+}
+
+void
+NetlinkProtocolSocket::removeLinkAddrListener(uint64_t listenerId) {
+  linkAddrListeners_.wlock()->listeners.erase(listenerId);
+}
+
+void
+NetlinkProtocolSocket::notifyLinkListeners(
+    fbnl::Link const& link, bool isRemoved) {
+  auto listeners = linkAddrListeners_.rlock();
+  for (auto const& kv : listeners->listeners) {
+    if (kv.second.linkCb) {
+      kv.second.linkCb(link, isRemoved);
+    }
+  }
+}
+
+void
+NetlinkProtocolSocket::notifyAddrListeners(fbnl::IfAddress const& addr) {
+  auto listeners = linkAddrListeners_.rlock();
+  for (auto const& kv : listeners->listeners) {
+    if (kv.second.addrCb) {
+      kv.second.addrCb(addr);
+    }
+  }
+}
+
 void
 NetlinkProtocolSocket::processAck(uint32_t ack, int status) {
   auto it = nlSeqNumMap_.find(ack);
@@ -146,6 +288,7 @@ NetlinkProtocolSocket::sendNetlinkMessage() {
   CHECK_LE(nlSeqNumMap_.size(), kMaxIovMsg)
       << "We must have capacity to send at-least one message!";
   uint32_t count{0};
+  uint32_t bytes{0};
   const uint32_t iovSize =
       std::min(msgQueue_.size(), kMaxIovMsg - nlSeqNumMap_.size());
 
@@ -153,9 +296,18 @@ NetlinkProtocolSocket::sendNetlinkMessage() {
     return;
   }
 
-  auto iov = std::make_unique<struct iovec[]>(iovSize);
+  // Reuse iovec across batches
+  iov_.resize(std::max<size_t>(iov_.size(), iovSize));
+  auto& iov = iov_;
 
   while (count < iovSize && !msgQueue_.empty()) {
+    // Fit messages in socket send buffer. Remaining ones are sent on ack.
+    const auto length = msgQueue_.front()->getDataLength();
+    if (count > 0 and bytes + length > maxSendBytes_) {
+      break;
+    }
+    bytes += length;
+
     auto m = std::move(msgQueue_.front());
     msgQueue_.pop();
 
@@ -182,18 +334,20 @@ NetlinkProtocolSocket::sendNetlinkMessage() {
     count++;
   }
 
-  auto outMsg = std::make_unique<struct msghdr>();
-  outMsg->msg_name = &nladdr;
-  outMsg->msg_namelen = sizeof(nladdr);
-  outMsg->msg_iov = &iov[0];
-  outMsg->msg_iovlen = count;
+  struct msghdr outMsg = {};
+  outMsg.msg_name = &nladdr;
+  outMsg.msg_namelen = sizeof(nladdr);
+  outMsg.msg_iov = iov.data();
+  outMsg.msg_iovlen = count;
 
-  VLOG(2) << "Sending " << outMsg->msg_iovlen << " netlink messages";
-  auto status = sendmsg(nlSock_, outMsg.get(), 0);
+  VLOG(2) << "Sending " << outMsg.msg_iovlen << " netlink messages, "
+          << bytes << " bytes";
+  auto status = sendmsg(nlSock_, &outMsg, 0);
+  fb303::fbData->addStatValue("netlink.sendmsg", 1, fb303::SUM);
   if (status < 0) {
     LOG(ERROR) << "Error sending on NL socket "
                << folly::errnoStr(std::abs(status))
-               << " Number of messages:" << outMsg->msg_iovlen;
+               << " Number of messages:" << outMsg.msg_iovlen;
     fb303::fbData->addStatValue("netlink.errors", 1, fb303::SUM);
   }
 
@@ -219,12 +373,12 @@ NetlinkProtocolSocket::processMessage(
     case RTM_NEWROUTE:
     case RTM_DELROUTE: {
       // next RTM message to be processed
-      auto route = NetlinkRouteMessage::parseMessage(nlh);
       if (nlSeqIt != nlSeqNumMap_.end()) {
         // Extend message timer as we received a valid ack
         nlMessageTimer_->scheduleTimeout(kNlRequestAckTimeout);
-        // Received route in response to request
-        nlSeqIt->second->rcvdRoute(std::move(route));
+        // Received route in response to request. Parsed by request only if
+        // it matches filters.
+        nlSeqIt->second->rcvdRouteMessage(nlh);
       } else {
         // Route notification
         DCHECK(false) << "Route notifications are not subscribed";
@@ -243,6 +397,7 @@ NetlinkProtocolSocket::processMessage(
         nlSeqIt->second->rcvdLink(std::move(link));
       } else {
         // Link notification
+        notifyLinkListeners(link, nlh->nlmsg_type == RTM_DELLINK);
         if (linkEventCB_) {
           linkEventCB_(std::move(link), true);
         }
@@ -275,12 +430,14 @@ NetlinkProtocolSocket::processMessage(
           // with the same sequence as the original request.
           //
           // IfAddress notification
+          notifyAddrListeners(addr);
           if (addrEventCB_) {
             addrEventCB_(std::move(addr), true);
           }
         }
       } else {
         // IfAddress notification
+        notifyAddrListeners(addr);
         if (addrEventCB_) {
           addrEventCB_(std::move(addr), true);
         }
@@ -339,26 +496,208 @@ NetlinkProtocolSocket::processMessage(
 
 void
 NetlinkProtocolSocket::recvNetlinkMessage() {
+  std::array<struct mmsghdr, kMaxNlRecvBatch> msgs = {};
+  std::array<struct iovec, kMaxNlRecvBatch> iovs = {};
+  for (size_t i = 0; i < kMaxNlRecvBatch; ++i) {
+    iovs[i].iov_base = recvBuffers_[i].data();
+    iovs[i].iov_len = kMaxNlPayloadSize;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  // Read all available datagrams, without blocking for more
+  int numMsgs = ::recvmmsg(
+      nlSock_, msgs.data(), kMaxNlRecvBatch, MSG_DONTWAIT, nullptr);
+  VLOG(4) << "Messages received: " << numMsgs;
+
+  if (numMsgs < 0) {
+    if (errno == EINTR || errno == EAGAIN) {
+      return;
+    }
+    if (errno == ENOBUFS) {
+      handleRecvOverflow();
+      return;
+    }
+    LOG(INFO) << "Error in netlink socket receive: " << numMsgs
+              << " err: " << folly::errnoStr(std::abs(errno));
+    return;
+  }
+
+  fb303::fbData->addStatValue("netlink.recv_datagrams", numMsgs, fb303::SUM);
+  for (int i = 0; i < numMsgs; ++i) {
+    processMessage(recvBuffers_[i], msgs[i].msg_len);
+  }
+}
+
+void
+NetlinkProtocolSocket::handleRecvOverflow() {
+  // NOTE: NETLINK_NO_ENOBUFS is intentionally not set on socket. Overflow must
+  // be reported, as state learnt from notifications is stale afterwards.
+  fb303::fbData->addStatValue("netlink.recv_enobufs", 1, fb303::SUM);
+  LOG(WARNING) << "Netlink socket receive buffer of " << recvBufSize_
+               << " bytes overflowed. Notifications have been dropped.";
+
+  if (recvBufSize_ < kNetlinkSockRecvBufMax) {
+    recvBufSize_ = std::min(recvBufSize_ * 2, kNetlinkSockRecvBufMax);
+    int size = recvBufSize_;
+    // Privileged variant can exceed net.core.rmem_max
+    if (setsockopt(nlSock_, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) <
+            0 and
+        setsockopt(nlSock_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0) {
+      LOG(ERROR) << "Netlink socket grow recv buffer failed: "
+                 << folly::errnoStr(errno);
+    } else {
+      LOG(INFO) << "Grew netlink socket receive buffer to " << size
+                << " bytes";
+    }
+  }
+
+  resyncEvents();
+}
+
+void
+NetlinkProtocolSocket::resyncEvents() {
+  if (resyncPending_) {
+    return;
+  }
+  resyncPending_ = true;
+  fb303::fbData->addStatValue("netlink.event_resyncs", 1, fb303::SUM);
+
+  // Dumps are requested one after the other, as kernel serves one dump at a
+  // time per socket. Results are replayed from event loop, outside of ack
+  // processing.
+  auto doneCb = [this]() { resyncPending_ = false; };
+  auto neighborsCb = [this, doneCb]() {
+    getAllNeighbors().toUnsafeFuture().thenTry(
+        [this, doneCb](folly::Try<std::vector<Neighbor>>&& neighbors) {
+          evl_->runInEventLoop([this, doneCb, neighbors = std::move(
+                                                  neighbors)]() mutable {
+            if (neighbors.hasValue() and neighborEventCB_) {
+              for (auto& neighbor : neighbors.value()) {
+                neighborEventCB_(std::move(neighbor), true);
+              }
+            }
+            doneCb();
+          });
+        });
+  };
+  auto addrsCb = [this, neighborsCb]() {
+    getAllIfAddresses().toUnsafeFuture().thenTry(
+        [this, neighborsCb](folly::Try<std::vector<IfAddress>>&& addrs) {
+          evl_->runInEventLoop(
+              [this, neighborsCb, addrs = std::move(addrs)]() mutable {
+                if (addrs.hasValue()) {
+                  for (auto& addr : addrs.value()) {
+                    notifyAddrListeners(addr);
+                    if (addrEventCB_) {
+                      addrEventCB_(std::move(addr), true);
+                    }
+                  }
+                }
+                neighborsCb();
+              });
+        });
+  };
+  getAllLinks().toUnsafeFuture().thenTry(
+      [this, addrsCb](folly::Try<std::vector<Link>>&& links) {
+        evl_->runInEventLoop(
+            [this, addrsCb, links = std::move(links)]() mutable {
+              if (links.hasValue()) {
+                for (auto& link : links.value()) {
+                  notifyLinkListeners(link, false /* isRemoved */);
+                  if (linkEventCB_) {
+                    linkEventCB_(std::move(link), true);
+                  }
+                }
+              }
+              addrsCb();
+            });
+      });
+}
+
+void
+NetlinkProtocolSocket::recvRouteEvents() {
   // messages buffer
   std::array<char, kMaxNlPayloadSize> recvMsg = {};
 
-  int32_t bytesRead = ::recv(nlSock_, recvMsg.data(), kMaxNlPayloadSize, 0);
-  VLOG(4) << "Message received with size: " << bytesRead;
-
+  int32_t bytesRead =
+      ::recv(nlRouteSock_, recvMsg.data(), kMaxNlPayloadSize, 0);
   if (bytesRead < 0) {
     if (errno == EINTR || errno == EAGAIN) {
       return;
     }
-    LOG(INFO) << "Error in netlink socket receive: " << bytesRead
-              << " err: " << folly::errnoStr(std::abs(errno));
+    if (errno == ENOBUFS) {
+      // Kernel dropped notifications as receive buffer overflowed
+      fb303::fbData->addStatValue(
+          "netlink.route_events.dropped", 1, fb303::SUM);
+    }
+    LOG(ERROR) << "Error in netlink route event socket receive: "
+               << folly::errnoStr(std::abs(errno));
     return;
   }
-  processMessage(recvMsg, static_cast<uint32_t>(bytesRead));
+
+  uint32_t remaining = static_cast<uint32_t>(bytesRead);
+  for (struct nlmsghdr* nlh = (struct nlmsghdr*)recvMsg.data();
+       NLMSG_OK(nlh, remaining);
+       nlh = NLMSG_NEXT(nlh, remaining)) {
+    if (nlh->nlmsg_type != RTM_NEWROUTE and nlh->nlmsg_type != RTM_DELROUTE) {
+      continue;
+    }
+    // Notification of change requested by us bears our port-ID. We learn
+    // about those from acks.
+    if (isOwnPortId(nlh->nlmsg_pid) or not routeEventCB_) {
+      continue;
+    }
+    fb303::fbData->addStatValue("netlink.route_events", 1, fb303::SUM);
+    routeEventCB_(NetlinkRouteMessage::parseMessage(nlh), true);
+  }
 }
 
 NetlinkProtocolSocket::~NetlinkProtocolSocket() {
+  // Stop route shards before their event loops go away
+  for (auto& shardEvl : routeShardEvls_) {
+    shardEvl->stop();
+  }
+  for (auto& shardThread : routeShardThreads_) {
+    shardThread.join();
+  }
+  routeShards_.clear();
+  routeShardEvls_.clear();
+
   LOG(INFO) << "Closing netlink socket.";
   close(nlSock_);
+  if (nlRouteSock_ >= 0) {
+    close(nlRouteSock_);
+  }
+}
+
+NetlinkProtocolSocket&
+NetlinkProtocolSocket::getRouteShard(const openr::fbnl::Route& route) {
+  if (routeShards_.empty()) {
+    return *this;
+  }
+  size_t hash{0};
+  if (route.getFamily() == AF_MPLS) {
+    hash = std::hash<uint32_t>()(route.getMplsLabel().value_or(0));
+  } else {
+    const auto& prefix = route.getDestination();
+    hash = folly::hash::hash_combine(prefix.first, prefix.second);
+  }
+  const size_t index = hash % (routeShards_.size() + 1);
+  return index == 0 ? *this : *routeShards_.at(index - 1);
+}
+
+bool
+NetlinkProtocolSocket::isOwnPortId(uint32_t portId) const {
+  if (portId == portId_) {
+    return true;
+  }
+  for (auto const& shard : routeShards_) {
+    if (portId == shard->portId_) {
+      return true;
+    }
+  }
+  return false;
 }
 
 void
@@ -373,6 +712,24 @@ NetlinkProtocolSocket::addNetlinkMessage(
   });
 }
 
+void
+NetlinkProtocolSocket::addNetlinkMessages(
+    std::vector<std::unique_ptr<NetlinkMessage>> nlmsgs) {
+  if (nlmsgs.empty()) {
+    return;
+  }
+  evl_->runImmediatelyOrInEventLoop(
+      [this, nlmsgs = std::move(nlmsgs)]() mutable {
+        for (auto& nlmsg : nlmsgs) {
+          msgQueue_.push(std::move(nlmsg));
+        }
+        // call send messages API if no timers are scheduled
+        if (!nlMessageTimer_->isScheduled()) {
+          sendNetlinkMessage();
+        }
+      });
+}
+
 folly::SemiFuture<int>
 NetlinkProtocolSocket::collectReturnStatus(
     std::vector<folly::SemiFuture<int>>&& futures,
@@ -397,29 +754,23 @@ NetlinkProtocolSocket::collectReturnStatus(
 
 folly::SemiFuture<int>
 NetlinkProtocolSocket::addRoute(const openr::fbnl::Route& route) {
+  auto& shard = getRouteShard(route);
+  if (&shard != this) {
+    return shard.addRoute(route);
+  }
+
   auto rtmMsg = std::make_unique<NetlinkRouteMessage>();
   auto future = rtmMsg->getSemiFuture();
 
-  int status{0};
-  switch (route.getFamily()) {
-  case AF_INET6:
-    if (not enableIPv6RouteReplaceSemantics_) {
-      // Special case for IPv6 route add. We first delete the route and then
-      // add it.
-      // NOTE: We ignore the error for the deleteRoute
-      deleteRoute(route);
-    }
-    FOLLY_FALLTHROUGH;
-  case AF_INET:
-    status = rtmMsg->addRoute(route);
-    break;
-  case AF_MPLS:
-    status = rtmMsg->addLabelRoute(route);
-    break;
-  default:
-    status = -EPROTONOSUPPORT;
+  if (route.getFamily() == AF_INET6 and
+      not enableIPv6RouteReplaceSemantics_) {
+    // Special case for IPv6 route add. We first delete the route and then
+    // add it.
+    // NOTE: We ignore the error for the deleteRoute
+    deleteRoute(route);
   }
 
+  const int status = buildRouteMessage(*rtmMsg, route, true /* isAdd */);
   if (status != 0) {
     rtmMsg->setReturnStatus(status);
   } else {
@@ -431,22 +782,15 @@ NetlinkProtocolSocket::addRoute(const openr::fbnl::Route& route) {
 
 folly::SemiFuture<int>
 NetlinkProtocolSocket::deleteRoute(const openr::fbnl::Route& route) {
+  auto& shard = getRouteShard(route);
+  if (&shard != this) {
+    return shard.deleteRoute(route);
+  }
+
   auto rtmMsg = std::make_unique<openr::fbnl::NetlinkRouteMessage>();
   auto future = rtmMsg->getSemiFuture();
 
-  int status{0};
-  switch (route.getFamily()) {
-  case AF_INET:
-  case AF_INET6:
-    status = rtmMsg->deleteRoute(route);
-    break;
-  case AF_MPLS:
-    status = rtmMsg->deleteLabelRoute(route);
-    break;
-  default:
-    status = -EPROTONOSUPPORT;
-  }
-
+  const int status = buildRouteMessage(*rtmMsg, route, false /* isAdd */);
   if (status != 0) {
     rtmMsg->setReturnStatus(status);
   } else {
@@ -456,6 +800,146 @@ NetlinkProtocolSocket::deleteRoute(const openr::fbnl::Route& route) {
   return future;
 }
 
+folly::SemiFuture<int>
+NetlinkProtocolSocket::addRoutes(
+    const std::vector<openr::fbnl::Route>& routes) {
+  if (routeShards_.empty()) {
+    return collectReturnStatus(addOrDeleteRoutes(routes, true /* isAdd */));
+  }
+
+  // Split routes by shard and queue them on every shard at once
+  std::unordered_map<NetlinkProtocolSocket*, std::vector<Route>> shardRoutes;
+  for (auto const& route : routes) {
+    shardRoutes[&getRouteShard(route)].emplace_back(route);
+  }
+  std::vector<folly::SemiFuture<int>> futures;
+  for (auto const& [shard, thisRoutes] : shardRoutes) {
+    futures.emplace_back(
+        shard == this ? collectReturnStatus(
+                            addOrDeleteRoutes(thisRoutes, true /* isAdd */))
+                      : shard->addRoutes(thisRoutes));
+  }
+  return collectReturnStatus(std::move(futures));
+}
+
+folly::SemiFuture<int>
+NetlinkProtocolSocket::deleteRoutes(
+    const std::vector<openr::fbnl::Route>& routes) {
+  if (routeShards_.empty()) {
+    return collectReturnStatus(addOrDeleteRoutes(routes, false /* isAdd */));
+  }
+
+  // Split routes by shard and queue them on every shard at once
+  std::unordered_map<NetlinkProtocolSocket*, std::vector<Route>> shardRoutes;
+  for (auto const& route : routes) {
+    shardRoutes[&getRouteShard(route)].emplace_back(route);
+  }
+  std::vector<folly::SemiFuture<int>> futures;
+  for (auto const& [shard, thisRoutes] : shardRoutes) {
+    futures.emplace_back(
+        shard == this ? collectReturnStatus(
+                            addOrDeleteRoutes(thisRoutes, false /* isAdd */))
+                      : shard->deleteRoutes(thisRoutes));
+  }
+  return collectReturnStatus(std::move(futures));
+}
+
+folly::SemiFuture<std::vector<int>>
+NetlinkProtocolSocket::addRoutesWithStatus(
+    const std::vector<openr::fbnl::Route>& routes) {
+  return addOrDeleteRoutesWithStatus(routes, true /* isAdd */);
+}
+
+folly::SemiFuture<std::vector<int>>
+NetlinkProtocolSocket::deleteRoutesWithStatus(
+    const std::vector<openr::fbnl::Route>& routes) {
+  return addOrDeleteRoutesWithStatus(routes, false /* isAdd */);
+}
+
+folly::SemiFuture<std::vector<int>>
+NetlinkProtocolSocket::addOrDeleteRoutesWithStatus(
+    const std::vector<openr::fbnl::Route>& routes, bool isAdd) {
+  // Status of every route, along with its index in routes
+  std::vector<folly::SemiFuture<int>> futures;
+  std::vector<size_t> indices;
+  if (routeShards_.empty()) {
+    futures = addOrDeleteRoutes(routes, isAdd);
+    indices.resize(routes.size());
+    std::iota(indices.begin(), indices.end(), 0);
+  } else {
+    // Split routes by shard and queue them on every shard at once
+    std::unordered_map<NetlinkProtocolSocket*, std::vector<size_t>>
+        shardIndices;
+    for (size_t i = 0; i < routes.size(); ++i) {
+      shardIndices[&getRouteShard(routes[i])].emplace_back(i);
+    }
+    for (auto const& [shard, thisIndices] : shardIndices) {
+      std::vector<Route> thisRoutes;
+      thisRoutes.reserve(thisIndices.size());
+      for (auto const i : thisIndices) {
+        thisRoutes.emplace_back(routes[i]);
+      }
+      auto thisFutures = shard->addOrDeleteRoutes(thisRoutes, isAdd);
+      std::move(
+          thisFutures.begin(), thisFutures.end(), std::back_inserter(futures));
+      indices.insert(indices.end(), thisIndices.begin(), thisIndices.end());
+    }
+  }
+
+  return folly::collectAll(std::move(futures))
+      .deferValue([indices = std::move(indices)](
+                      std::vector<folly::Try<int>>&& results) {
+        std::vector<int> statuses(results.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+          statuses[indices[i]] = results[i].value(); // Throws exception if any
+        }
+        return statuses;
+      });
+}
+
+std::vector<folly::SemiFuture<int>>
+NetlinkProtocolSocket::addOrDeleteRoutes(
+    const std::vector<openr::fbnl::Route>& routes, bool isAdd) {
+  std::vector<std::unique_ptr<NetlinkMessage>> msgs;
+  std::vector<folly::SemiFuture<int>> futures;
+  for (auto const& route : routes) {
+    if (isAdd and route.getFamily() == AF_INET6 and
+        not enableIPv6RouteReplaceSemantics_) {
+      // See addRoute(...). Delete ahead of add, ignoring its error
+      auto delMsg = std::make_unique<NetlinkRouteMessage>();
+      if (buildRouteMessage(*delMsg, route, false /* isAdd */) == 0) {
+        msgs.emplace_back(std::move(delMsg));
+      }
+    }
+
+    auto rtmMsg = std::make_unique<NetlinkRouteMessage>();
+    futures.emplace_back(rtmMsg->getSemiFuture());
+    const int status = buildRouteMessage(*rtmMsg, route, isAdd);
+    if (status != 0) {
+      rtmMsg->setReturnStatus(status);
+    } else {
+      msgs.emplace_back(std::move(rtmMsg));
+    }
+  }
+
+  addNetlinkMessages(std::move(msgs));
+  return futures;
+}
+
+int
+NetlinkProtocolSocket::buildRouteMessage(
+    NetlinkRouteMessage& rtmMsg, const openr::fbnl::Route& route, bool isAdd) {
+  switch (route.getFamily()) {
+  case AF_INET:
+  case AF_INET6:
+    return isAdd ? rtmMsg.addRoute(route) : rtmMsg.deleteRoute(route);
+  case AF_MPLS:
+    return isAdd ? rtmMsg.addLabelRoute(route) : rtmMsg.deleteLabelRoute(route);
+  default:
+    return -EPROTONOSUPPORT;
+  }
+}
+
 folly::SemiFuture<int>
 NetlinkProtocolSocket::addIfAddress(const openr::fbnl::IfAddress& ifAddr) {
   auto addrMsg = std::make_unique<openr::fbnl::NetlinkAddrMessage>();
@@ -539,6 +1023,20 @@ NetlinkProtocolSocket::getRoutes(const fbnl::Route& filter) {
   return future;
 }
 
+folly::SemiFuture<int>
+NetlinkProtocolSocket::streamRoutes(
+    const fbnl::Route& filter, std::function<void(fbnl::Route&&)> routeCb) {
+  auto routeMsg = std::make_unique<openr::fbnl::NetlinkRouteMessage>();
+  auto future = routeMsg->getSemiFuture();
+
+  // Initialize message fields to get routes, streamed to callback
+  routeMsg->init(RTM_GETROUTE, 0, filter);
+  routeMsg->setRouteCallback(std::move(routeCb));
+  addNetlinkMessage(std::move(routeMsg));
+
+  return future;
+}
+
 folly::SemiFuture<std::vector<fbnl::Route>>
 NetlinkProtocolSocket::getAllRoutes() {
   fbnl::RouteBuilder builder;
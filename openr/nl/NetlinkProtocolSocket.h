@@ -7,11 +7,16 @@
 
 #pragma once
 
+#include <atomic>
+#include <map>
+#include <thread>
 #include <vector>
 
+#include <fbzmq/async/ZmqEventLoop.h>
 #include <fbzmq/async/ZmqTimeout.h>
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/IPAddress.h>
+#include <folly/Synchronized.h>
 #include <folly/futures/Future.h>
 
 #include <openr/nl/NetlinkMessage.h>
@@ -20,8 +25,16 @@
 
 namespace openr::fbnl {
 
-// Receive socket buffer for netlink socket
+// Receive and send socket buffer for netlink socket. Kernel may cap send
+// buffer to lower size (net.core.wmem_max)
 constexpr uint32_t kNetlinkSockRecvBuf{1 * 1024 * 1024};
+constexpr uint32_t kNetlinkSockSendBuf{1 * 1024 * 1024};
+
+// Receive buffer is doubled on every overflow, up to this size
+constexpr uint32_t kNetlinkSockRecvBufMax{32 * 1024 * 1024};
+
+// Maximum number of datagrams read from netlink socket per wakeup
+constexpr size_t kMaxNlRecvBatch{32};
 
 // Maximum number of in-flight messages. `kMinIovMsg` indicates the soft
 // requirement for sending bufferred messages.
@@ -61,11 +74,19 @@ constexpr std::chrono::milliseconds kNlRequestAckTimeout{1000};
  * routes in under 2 seconds. These performance benchmarks can be observed
  * by running associated UTs and it might vary on different systems.
  *
+ * NOTE Route shards:
+ * Route add/delete can be spread over `numRouteShards` netlink sockets, each
+ * served by a thread of its own. Shard of route is chosen by hash of its
+ * destination (prefix or label), hence requests for same destination are
+ * always sent in order over the same socket. First shard is this socket and
+ * event loop. All other requests and notifications are handled by it alone.
  */
 class NetlinkProtocolSocket {
  public:
   explicit NetlinkProtocolSocket(
-      fbzmq::ZmqEventLoop* evl, bool enableIPv6RouteReplaceSemantics = false);
+      fbzmq::ZmqEventLoop* evl,
+      bool enableIPv6RouteReplaceSemantics = false,
+      size_t numRouteShards = 1);
 
   virtual ~NetlinkProtocolSocket();
 
@@ -79,6 +100,33 @@ class NetlinkProtocolSocket {
   void setNeighborEventCB(
       std::function<void(fbnl::Neighbor, bool)> neighborEventCB);
 
+  // Set netlinkSocket Route event callback. It is invoked for route changes
+  // not requested over this socket, e.g. by other processes, or by kernel on
+  // interface down. Route::isValid() is false for deleted route.
+  // NOTE: Events are received on separate socket, so that route programming
+  // doesn't flood socket of requests with its own notifications. Events may
+  // still be dropped on overflow, see `netlink.route_events.dropped` stat.
+  void setRouteEventCB(std::function<void(fbnl::Route, bool)> routeEventCB);
+
+  /**
+   * Listener of link and address notifications, invoked along with event
+   * callbacks above, e.g. to mirror links and addresses of kernel. Link being
+   * removed from kernel is flagged. Address being removed has isValid() false.
+   * Notifications are replayed on resync after socket overflow, without
+   * removals of links and addresses missed meanwhile.
+   */
+  struct LinkAddrListener {
+    std::function<void(fbnl::Link const&, bool /* isRemoved */)> linkCb;
+    std::function<void(fbnl::IfAddress const&)> addrCb;
+  };
+
+  // Add listener, invoked from event loop of this socket. Returns id with
+  // which listener is removed. Thread safe, but not from within listeners
+  uint64_t addLinkAddrListener(LinkAddrListener listener);
+
+  // Remove listener, it is not invoked anymore once this returns
+  void removeLinkAddrListener(uint64_t listenerId);
+
   /**
    * Add or replace route. An existing paths of route will be replaced with
    * new paths. Supports AF_INET, AF_INET6 and AF_MPLS address families.
@@ -109,6 +157,29 @@ class NetlinkProtocolSocket {
    */
   virtual folly::SemiFuture<int> deleteRoute(const openr::fbnl::Route& route);
 
+  /**
+   * Bulk versions of addRoute and deleteRoute. All messages are queued at once
+   * and packed into as few sendmsg calls as socket buffers allow. Preferred
+   * for programming many routes, e.g. full route table on start up.
+   *
+   * @returns 0 if all routes succeeded else first error code in order of
+   *          routes, as with collectReturnStatus. With route shards, order
+   *          is kept per shard only.
+   */
+  virtual folly::SemiFuture<int> addRoutes(
+      const std::vector<openr::fbnl::Route>& routes);
+  virtual folly::SemiFuture<int> deleteRoutes(
+      const std::vector<openr::fbnl::Route>& routes);
+
+  /**
+   * Bulk add and delete as above, but with return status of every route, in
+   * order of routes. For callers tracking which routes made it to kernel.
+   */
+  virtual folly::SemiFuture<std::vector<int>> addRoutesWithStatus(
+      const std::vector<openr::fbnl::Route>& routes);
+  virtual folly::SemiFuture<std::vector<int>> deleteRoutesWithStatus(
+      const std::vector<openr::fbnl::Route>& routes);
+
   /**
    * Add an address to the interface
    *
@@ -152,6 +223,17 @@ class NetlinkProtocolSocket {
   virtual folly::SemiFuture<std::vector<fbnl::Route>> getRoutes(
       const fbnl::Route& filter);
 
+  /**
+   * Streaming version of getRoutes(..) for large route tables. `routeCb` is
+   * invoked in event loop of this socket for every route matching filter, as
+   * soon as its netlink message is parsed. Routes not matching filter are
+   * skipped without being parsed. Routes are never accumulated.
+   *
+   * @returns 0 when dump is complete else appropriate system error code
+   */
+  virtual folly::SemiFuture<int> streamRoutes(
+      const fbnl::Route& filter, std::function<void(fbnl::Route&&)> routeCb);
+
   /**
    * APIs to retrieve routes from default routing table.
    * std::vector<fbnl::Route> getAllRoutes();
@@ -177,21 +259,70 @@ class NetlinkProtocolSocket {
   // Initialize netlink socket and add to eventloop for polling
   virtual void init();
 
+  // Notify link and address listeners
+  void notifyLinkListeners(fbnl::Link const& link, bool isRemoved);
+  void notifyAddrListeners(fbnl::IfAddress const& addr);
+
  private:
   NetlinkProtocolSocket(NetlinkProtocolSocket const&) = delete;
   NetlinkProtocolSocket& operator=(NetlinkProtocolSocket const&) = delete;
 
+  // Construct route shard. It serves route add/delete requests only and
+  // doesn't subscribe to any notifications.
+  struct RouteShardTag {};
+  NetlinkProtocolSocket(
+      fbzmq::ZmqEventLoop* evl,
+      bool enableIPv6RouteReplaceSemantics,
+      RouteShardTag);
+
+  // Create ack timer and schedule init() in event loop. Common to both
+  // constructors.
+  void setupEventLoop();
+
+  // Socket handling requests for destination of route. Returns this when
+  // there are no route shards.
+  NetlinkProtocolSocket& getRouteShard(const openr::fbnl::Route& route);
+
+  // Whether port-ID belongs to this socket or any of route shards
+  bool isOwnPortId(uint32_t portId) const;
+
+  // Queue add or delete of routes on this socket, returning status of each
+  std::vector<folly::SemiFuture<int>> addOrDeleteRoutes(
+      const std::vector<openr::fbnl::Route>& routes, bool isAdd);
+
+  // Queue add or delete of routes on their shards, with status of each route
+  folly::SemiFuture<std::vector<int>> addOrDeleteRoutesWithStatus(
+      const std::vector<openr::fbnl::Route>& routes, bool isAdd);
+
   // Buffer netlink message to the queue_. Invoke sendNetlinkMessage if there
   // are no messages in flight
   void addNetlinkMessage(std::unique_ptr<NetlinkMessage> nlmsg);
+  void addNetlinkMessages(std::vector<std::unique_ptr<NetlinkMessage>> nlmsgs);
+
+  // Initialize message to add or delete route. Returns 0 on success else
+  // error code
+  static int buildRouteMessage(
+      NetlinkRouteMessage& rtmMsg, const openr::fbnl::Route& route, bool isAdd);
 
   // Send a message batch to netlink socket from queue_
   void sendNetlinkMessage();
 
-  // Receive messages from netlink socket. Invoke `processMessage` for every
-  // message received.
+  // Receive messages from netlink socket, up to kMaxNlRecvBatch datagrams at
+  // once. Invoke `processMessage` for every message received.
   void recvNetlinkMessage();
 
+  // Kernel dropped messages as receive buffer overflowed. Grow receive buffer
+  // and resync state learnt from notifications.
+  void handleRecvOverflow();
+
+  // Dump links, addresses and neighbors, one after the other, and replay them
+  // as notifications through respective callbacks
+  void resyncEvents();
+
+  // Receive route notifications from route event socket and invoke
+  // routeEventCB_ for the ones not caused by us
+  void recvRouteEvents();
+
   // Process received netlink message. Set return values for pending requests
   // or send notifications.
   void processMessage(
@@ -210,20 +341,59 @@ class NetlinkProtocolSocket {
   std::function<void(fbnl::Link, bool)> linkEventCB_;
   std::function<void(fbnl::IfAddress, bool)> addrEventCB_;
   std::function<void(fbnl::Neighbor, bool)> neighborEventCB_;
+  std::function<void(fbnl::Route, bool)> routeEventCB_;
+
+  // Listeners of link and address notifications by their id
+  struct LinkAddrListeners {
+    uint64_t nextId{0};
+    std::map<uint64_t, LinkAddrListener> listeners;
+  };
+  folly::Synchronized<LinkAddrListeners> linkAddrListeners_;
 
   // Use new IPv6 route replace semantics. See documentation for addRoute(...)
   const bool enableIPv6RouteReplaceSemantics_{false};
 
+  // Route shards send requests only and don't subscribe to notifications
+  const bool isRouteShard_{false};
+
+  // Route shards other than this one, along with their event loops and
+  // threads. See class documentation.
+  std::vector<std::unique_ptr<fbzmq::ZmqEventLoop>> routeShardEvls_;
+  std::vector<std::unique_ptr<NetlinkProtocolSocket>> routeShards_;
+  std::vector<std::thread> routeShardThreads_;
+
   // Netlink socket fd. Created when class is constructed. Re-created on timeout
   // when no response is received for any of our pending requests.
   int nlSock_{-1};
 
+  // Netlink socket subscribed to route notifications only. Created and
+  // re-created along with nlSock_.
+  int nlRouteSock_{-1};
+
   // nl_pid stands for port-ID and not process-ID. Netlink sockets are bound on
   // this specified port. This must be unique for every netlink socket that
   // is created on the system. Ironically kernel assigns the process-ID as the
   // port-ID for the first socket that is created by process. All subsequent
   // netlink sockets created by process gets assigned some unique-ID.
-  uint32_t portId_{UINT_MAX};
+  // NOTE: Atomic as port-ID of route shards is read from event loop of first
+  // shard
+  std::atomic<uint32_t> portId_{UINT_MAX};
+
+  // Current receive buffer size of netlink socket. Grown on overflow and kept
+  // when socket is re-created.
+  uint32_t recvBufSize_{kNetlinkSockRecvBuf};
+
+  // Buffers for datagrams of one recvmmsg call
+  std::vector<NetlinkMessageBuffer> recvBuffers_ =
+      std::vector<NetlinkMessageBuffer>(kMaxNlRecvBatch);
+
+  // Resync of events is in progress. Further overflows till it completes are
+  // covered by it.
+  bool resyncPending_{false};
+
+  // Max bytes of messages sent in one sendmsg call. Kernel rejects messages
+  // exceeding socket send buffer with EMSGSIZE.
+  uint32_t maxSendBytes_{kNetlinkSockSendBuf / 2};
 
   // Next available sequence number to use. It is possible to wrap this around,
   // and should be fine. We put hard check to avoid conflict between pending
@@ -245,11 +415,14 @@ class NetlinkProtocolSocket {
   // for in-flight messages is received, subsequent messages are sent.
   std::queue<std::unique_ptr<NetlinkMessage>> msgQueue_;
 
+  // Scatter list of messages for sendmsg, retained across batches
+  std::vector<struct iovec> iov_;
+
   // Sequence number to NetlinkMesage request mapping. Each in-flight message
   // sent to kernel, is assigned a unique sequence-number and stored in this
   // map. On receipt of ack from kernel (either success or error) we clear the
   // corresponding entry from this map.
-  std::unordered_map<uint32_t, std::shared_ptr<NetlinkMessage>> nlSeqNumMap_;
+  std::unordered_map<uint32_t, std::unique_ptr<NetlinkMessage>> nlSeqNumMap_;
 
   // Timer to help keep track of timeout of messages sent to kernel. It also
   // ensures the aliveness of the netlink socket-fd. Timer is
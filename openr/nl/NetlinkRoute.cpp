@@ -36,6 +36,39 @@ NetlinkRouteMessage::rcvdRoute(Route&& route) {
     return; // ignore the route
   }
 
+  deliverRoute(std::move(route));
+}
+
+void
+NetlinkRouteMessage::rcvdRouteMessage(const struct nlmsghdr* nlh) {
+  //
+  // Same filters as above, applied on message header before parsing routes
+  // and their nexthops
+  //
+  const struct rtmsg* const routeEntry =
+      reinterpret_cast<const struct rtmsg*>(NLMSG_DATA(nlh));
+
+  if (filters_.table && filters_.table != routeEntry->rtm_table) {
+    return; // ignore the route
+  }
+
+  if (filters_.protocol && filters_.protocol != routeEntry->rtm_protocol) {
+    return; // ignore the route
+  }
+
+  if (filters_.type && filters_.type != routeEntry->rtm_type) {
+    return; // ignore the route
+  }
+
+  deliverRoute(parseMessage(nlh));
+}
+
+void
+NetlinkRouteMessage::deliverRoute(Route&& route) {
+  if (routeCb_) {
+    routeCb_(std::move(route));
+    return;
+  }
   rcvdRoutes_.emplace_back(std::move(route));
 }
 
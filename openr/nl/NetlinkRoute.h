@@ -54,6 +54,14 @@ class NetlinkRouteMessage final : public NetlinkMessage {
     return routePromise_.getSemiFuture();
   }
 
+  // Hand over every route received in response to GET request to callback,
+  // as soon as it is parsed, instead of accumulating them. Routes future is
+  // then fulfilled with empty vector.
+  void
+  setRouteCallback(std::function<void(Route&&)> routeCb) {
+    routeCb_ = std::move(routeCb);
+  }
+
   // initiallize route message with default params
   void init(int type, uint32_t flags, const Route& route);
 
@@ -162,6 +170,11 @@ class NetlinkRouteMessage final : public NetlinkMessage {
  private:
   void rcvdRoute(Route&& route) override;
 
+  void rcvdRouteMessage(const struct nlmsghdr* nlh) override;
+
+  // Hand over route to callback or accumulate it
+  void deliverRoute(Route&& route);
+
   struct {
     uint8_t table{0};
     uint8_t protocol{0};
@@ -170,6 +183,7 @@ class NetlinkRouteMessage final : public NetlinkMessage {
 
   folly::Promise<std::vector<Route>> routePromise_;
   std::vector<Route> rcvdRoutes_;
+  std::function<void(Route&&)> routeCb_;
 };
 
 /**
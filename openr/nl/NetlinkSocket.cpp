@@ -6,17 +6,30 @@
  */
 
 #include <openr/nl/NetlinkSocket.h>
+
+#include <fb303/ServiceData.h>
+#include <folly/MapUtil.h>
+
 #include <openr/if/gen-cpp2/Platform_constants.h>
 
+namespace fb303 = facebook::fb303;
+
 namespace openr::fbnl {
 
 NetlinkSocket::NetlinkSocket(
     fbzmq::ZmqEventLoop* evl,
     EventsHandler* handler,
-    std::unique_ptr<openr::fbnl::NetlinkProtocolSocket> nlSock)
-    : evl_(evl), handler_(handler), nlSock_(std::move(nlSock)) {
+    std::unique_ptr<openr::fbnl::NetlinkProtocolSocket> nlSock,
+    std::chrono::milliseconds linkEventCoalesceWindow)
+    : evl_(evl),
+      handler_(handler),
+      linkEventCoalesceWindow_(linkEventCoalesceWindow),
+      nlSock_(std::move(nlSock)) {
   CHECK(evl_ != nullptr) << "Missing event loop.";
 
+  linkEventTimer_ = fbzmq::ZmqTimeout::make(
+      evl_, [this]() noexcept { processLinkEventWindows(); });
+
   // TODO: Create nlSock_ inline here and share an event-loop
   CHECK(nlSock_ != nullptr) << "Missing NetlinkProtocolSocket";
 
@@ -54,6 +67,17 @@ NetlinkSocket::NetlinkSocket(
     });
   });
 
+  // Keep route cache in sync with route changes made by others, so that sync
+  // of routes is a diff of cache
+  nlSock_->setRouteEventCB([this](
+      openr::fbnl::Route route, bool runHandler) noexcept {
+    evl_->runImmediatelyOrInEventLoop([this,
+                                       route = std::move(route),
+                                       runHandler = runHandler]() mutable {
+      doHandleRouteEvent(std::move(route), runHandler, true);
+    });
+  });
+
   // need to reload routes from kernel to avoid re-adding existing route
   // type of exception in NetlinkSocket
   updateRouteCache();
@@ -83,18 +107,111 @@ NetlinkSocket::doHandleLinkEvent(Link link, bool runHandler) noexcept {
   auto& linkAttr = links_[linkName];
   linkAttr.isUp = link.isUp();
   linkAttr.ifIndex = link.getIfIndex();
+  ifIndexToName_[linkAttr.ifIndex] = linkName;
   if (link.isLoopback()) {
     loopbackIfIndex_ = linkAttr.ifIndex;
   }
   if (!linkAttr.isUp) {
     removeNeighborCacheEntries(linkName);
   }
+  {
+    std::lock_guard<std::mutex> g(linkListenerMutex_);
+    if (linkListener_) {
+      linkListener_(link);
+    }
+  }
   if (handler_ && runHandler && eventFlags_[LINK_EVENT]) {
-    EventVariant event = std::move(link);
-    handler_->handleEvent(linkName, event);
+    if (linkEventCoalesceWindow_.count() == 0) {
+      EventVariant event = std::move(link);
+      handler_->handleEvent(linkName, event);
+    } else {
+      coalesceLinkEvent(std::move(link));
+    }
+  }
+}
+
+void
+NetlinkSocket::coalesceLinkEvent(Link link) {
+  const auto now = std::chrono::steady_clock::now();
+  const auto ifIndex = link.getIfIndex();
+  auto it = linkEventWindows_.find(ifIndex);
+  if (it == linkEventWindows_.end()) {
+    // Quiet interface. Hand over right away and open window.
+    linkEventWindows_[ifIndex] = LinkEventWindow{
+        now + linkEventCoalesceWindow_, link.isUp(), std::nullopt};
+    publishLinkEvent(std::move(link));
+    if (not linkEventTimer_->isScheduled()) {
+      linkEventTimer_->scheduleTimeout(linkEventCoalesceWindow_);
+    }
+    return;
+  }
+
+  // Keep latest event only
+  if (it->second.pending.has_value()) {
+    fb303::fbData->addStatValue(
+        "netlink.link_events.suppressed", 1, fb303::SUM);
+  }
+  it->second.pending = std::move(link);
+}
+
+void
+NetlinkSocket::flushLinkEvent(int ifIndex) {
+  auto it = linkEventWindows_.find(ifIndex);
+  if (it == linkEventWindows_.end() or not it->second.pending.has_value()) {
+    return;
+  }
+  auto link = std::move(it->second.pending).value();
+  it->second.pending.reset();
+  if (link.isUp() == it->second.isUp) {
+    // Burst ended in state already handed over
+    fb303::fbData->addStatValue(
+        "netlink.link_events.suppressed", 1, fb303::SUM);
+    return;
+  }
+  it->second.isUp = link.isUp();
+  publishLinkEvent(std::move(link));
+}
+
+void
+NetlinkSocket::processLinkEventWindows() {
+  const auto now = std::chrono::steady_clock::now();
+  std::optional<std::chrono::steady_clock::time_point> nextWindowEnd;
+  auto updateNextWindowEnd = [&nextWindowEnd](const LinkEventWindow& window) {
+    if (not nextWindowEnd.has_value() or window.windowEnd < *nextWindowEnd) {
+      nextWindowEnd = window.windowEnd;
+    }
+  };
+  for (auto it = linkEventWindows_.begin(); it != linkEventWindows_.end();) {
+    auto& window = it->second;
+    if (window.windowEnd > now) {
+      updateNextWindowEnd(window);
+      ++it;
+      continue;
+    }
+    if (not window.pending.has_value()) {
+      it = linkEventWindows_.erase(it);
+      continue;
+    }
+    // Hand over latest event and keep coalescing for another window, as
+    // interface is still flapping
+    flushLinkEvent(it->first);
+    window.windowEnd = now + linkEventCoalesceWindow_;
+    updateNextWindowEnd(window);
+    ++it;
+  }
+  if (nextWindowEnd.has_value()) {
+    linkEventTimer_->scheduleTimeout(
+        std::chrono::ceil<std::chrono::milliseconds>(*nextWindowEnd - now));
   }
 }
 
+void
+NetlinkSocket::publishLinkEvent(Link link) {
+  const auto linkName = link.getLinkName();
+  EventVariant event = std::move(link);
+  handler_->handleEvent(linkName, event);
+}
+
 void
 NetlinkSocket::removeNeighborCacheEntries(const std::string& ifName) {
   for (auto it = neighbors_.begin(); it != neighbors_.end();) {
@@ -108,6 +225,7 @@ NetlinkSocket::removeNeighborCacheEntries(const std::string& ifName) {
 
 void
 NetlinkSocket::doHandleAddrEvent(IfAddress ifAddr, bool runHandler) noexcept {
+  flushLinkEvent(ifAddr.getIfIndex());
   std::string ifName = getIfName(ifAddr.getIfIndex()).get();
   if (ifAddr.isValid()) {
     if (links_[ifName].networks.count(ifAddr.getPrefix().value()) == 0) {
@@ -129,6 +247,7 @@ NetlinkSocket::doHandleAddrEvent(IfAddress ifAddr, bool runHandler) noexcept {
 void
 NetlinkSocket::doHandleNeighborEvent(
     Neighbor neighbor, bool runHandler) noexcept {
+  flushLinkEvent(neighbor.getIfIndex());
   std::string ifName = getIfName(neighbor.getIfIndex()).get();
   auto key = std::make_pair(ifName, neighbor.getDestination());
   neighbors_.erase(key);
@@ -165,6 +284,15 @@ NetlinkSocket::doUpdateRouteCache(Route route, bool updateUnicastRoute) {
     return;
   }
 
+  // Deleted label route is re-added on next sync
+  if (route.getFamily() == AF_MPLS) {
+    const auto label = route.getMplsLabel();
+    if (updateUnicastRoute and not route.isValid() and label.has_value()) {
+      mplsRoutesCache_[route.getProtocolId()].erase(label.value());
+    }
+    return;
+  }
+
   const folly::CIDRNetwork& prefix = route.getDestination();
 
   if (prefix.first.isMulticast() or route.getScope() == RT_SCOPE_LINK) {
@@ -173,11 +301,12 @@ NetlinkSocket::doUpdateRouteCache(Route route, bool updateUnicastRoute) {
 
   if (updateUnicastRoute) {
     auto& unicastRoutes = unicastRoutesCache_[route.getProtocolId()];
+    unicastRoutes.erase(prefix);
     if (route.isValid()) {
-      unicastRoutes.erase(prefix);
       unicastRoutes.emplace(prefix, std::move(route));
     }
-    // NOTE: We are just updating cache. This called during initialization
+    // NOTE: We are just updating cache. This is called during initialization
+    // and on route notifications of changes made by others
   }
 }
 
@@ -282,6 +411,46 @@ NetlinkSocket::delMplsRoute(Route mplsRoute) {
   return future;
 }
 
+folly::Future<folly::Unit>
+NetlinkSocket::addMplsRoutes(std::vector<Route> mplsRoutes) {
+  VLOG(3) << "NetlinkSocket add " << mplsRoutes.size() << " MPLS routes";
+  folly::Promise<folly::Unit> promise;
+  auto future = promise.getFuture();
+
+  evl_->runImmediatelyOrInEventLoop(
+      [this, p = std::move(promise), rs = std::move(mplsRoutes)]() mutable {
+        try {
+          doAddUpdateMplsRoutes(std::move(rs));
+          p.setValue();
+        } catch (std::exception const& ex) {
+          LOG(ERROR) << "Error adding MPLS routes. Exception: "
+                     << folly::exceptionStr(ex);
+          p.setException(ex);
+        }
+      });
+  return future;
+}
+
+folly::Future<folly::Unit>
+NetlinkSocket::delMplsRoutes(std::vector<Route> mplsRoutes) {
+  VLOG(3) << "NetlinkSocket deleting " << mplsRoutes.size() << " MPLS routes";
+  folly::Promise<folly::Unit> promise;
+  auto future = promise.getFuture();
+
+  evl_->runImmediatelyOrInEventLoop(
+      [this, p = std::move(promise), rs = std::move(mplsRoutes)]() mutable {
+        try {
+          doDeleteMplsRoutes(std::move(rs));
+          p.setValue();
+        } catch (std::exception const& ex) {
+          LOG(ERROR) << "Error deleting MPLS routes. Exception: "
+                     << folly::exceptionStr(ex);
+          p.setException(ex);
+        }
+      });
+  return future;
+}
+
 folly::Future<folly::Unit>
 NetlinkSocket::syncMplsRoutes(uint8_t protocolId, NlMplsRoutes newMplsRouteDb) {
   folly::Promise<folly::Unit> promise;
@@ -303,14 +472,19 @@ NetlinkSocket::syncMplsRoutes(uint8_t protocolId, NlMplsRoutes newMplsRouteDb) {
       }
       // delete
       LOG(INFO) << "Sync: Deleting " << toDelete.size() << " mpls routes";
+      std::vector<Route> routesToDelete;
+      routesToDelete.reserve(toDelete.size());
       for (auto label : toDelete) {
-        auto mplsRouteEntry = mplsRoutes.at(label);
-        doDeleteMplsRoute(mplsRouteEntry);
+        routesToDelete.emplace_back(mplsRoutes.at(label));
       }
+      doDeleteMplsRoutes(std::move(routesToDelete));
       // Go over MPLS routes in new routeDb, update/add
+      std::vector<Route> routesToAdd;
+      routesToAdd.reserve(syncDb.size());
       for (auto& kv : syncDb) {
-        doAddUpdateMplsRoute(kv.second);
+        routesToAdd.emplace_back(std::move(kv.second));
       }
+      doAddUpdateMplsRoutes(std::move(routesToAdd));
       p.setValue();
       LOG(INFO) << "Sync done.";
     } catch (std::exception const& ex) {
@@ -477,6 +651,112 @@ NetlinkSocket::doAddUpdateMplsRoute(Route mplsRoute) {
       static_cast<int32_t>(label.value()), std::move(mplsRoute)));
 }
 
+void
+NetlinkSocket::doAddUpdateMplsRoutes(std::vector<Route> mplsRoutes) {
+  // Routes which are new or changed, others are in kernel already
+  std::vector<Route> routes;
+  routes.reserve(mplsRoutes.size());
+  size_t numFailed{0};
+  std::optional<std::pair<int32_t, int>> firstError;
+  for (auto& mplsRoute : mplsRoutes) {
+    auto label = mplsRoute.getMplsLabel();
+    if (!label.has_value()) {
+      LOG(ERROR) << "MPLS route add - no label provided";
+      continue;
+    }
+    if (mplsRoute.getType() != RTN_UNICAST) {
+      ++numFailed;
+      if (not firstError.has_value()) {
+        firstError = std::make_pair(label.value(), EINVAL);
+      }
+      continue;
+    }
+    auto& cachedRoutes = mplsRoutesCache_[mplsRoute.getProtocolId()];
+    auto it = cachedRoutes.find(label.value());
+    if (it != cachedRoutes.end() && it->second == mplsRoute) {
+      continue;
+    }
+    if (it != cachedRoutes.end()) {
+      cachedRoutes.erase(it);
+    }
+    routes.emplace_back(std::move(mplsRoute));
+  }
+
+  const auto statuses = nlSock_->addRoutesWithStatus(routes).get();
+  CHECK_EQ(routes.size(), statuses.size());
+  for (size_t i = 0; i < routes.size(); ++i) {
+    const int label = routes[i].getMplsLabel().value();
+    const int err = std::abs(statuses[i]);
+    if (err != 0 && err != EEXIST) {
+      ++numFailed;
+      if (not firstError.has_value()) {
+        firstError = std::make_pair(label, err);
+      }
+      continue;
+    }
+    // Add MPLS route entry in cache on successful addition
+    mplsRoutesCache_[routes[i].getProtocolId()].emplace(
+        label, std::move(routes[i]));
+  }
+
+  if (numFailed) {
+    throw fbnl::NlException(
+        folly::sformat(
+            "Failed to add {} of {} MPLS routes, first is label {}",
+            numFailed,
+            mplsRoutes.size(),
+            firstError->first),
+        firstError->second);
+  }
+}
+
+void
+NetlinkSocket::doDeleteMplsRoutes(std::vector<Route> mplsRoutes) {
+  // Routes in cache, others are gone from kernel already
+  std::vector<Route> routes;
+  routes.reserve(mplsRoutes.size());
+  for (auto& mplsRoute : mplsRoutes) {
+    auto label = mplsRoute.getMplsLabel();
+    if (!label.has_value()) {
+      continue;
+    }
+    auto& cachedRoutes = mplsRoutesCache_[mplsRoute.getProtocolId()];
+    if (cachedRoutes.count(label.value()) == 0) {
+      LOG(ERROR) << "Trying to delete non-existing label: " << label.value();
+      continue;
+    }
+    routes.emplace_back(std::move(mplsRoute));
+  }
+
+  const auto statuses = nlSock_->deleteRoutesWithStatus(routes).get();
+  CHECK_EQ(routes.size(), statuses.size());
+  size_t numFailed{0};
+  std::optional<std::pair<int32_t, int>> firstError;
+  for (size_t i = 0; i < routes.size(); ++i) {
+    const int label = routes[i].getMplsLabel().value();
+    const int err = std::abs(statuses[i]);
+    if (err != 0 && err != ESRCH) {
+      ++numFailed;
+      if (not firstError.has_value()) {
+        firstError = std::make_pair(label, err);
+      }
+      continue;
+    }
+    // Update local cache with removed label
+    mplsRoutesCache_[routes[i].getProtocolId()].erase(label);
+  }
+
+  if (numFailed) {
+    throw fbnl::NlException(
+        folly::sformat(
+            "Failed to delete {} of {} MPLS routes, first is label {}",
+            numFailed,
+            mplsRoutes.size(),
+            firstError->first),
+        firstError->second);
+  }
+}
+
 void
 NetlinkSocket::doDeleteUnicastRoute(Route route) {
   checkUnicastRoute(route);
@@ -625,15 +905,7 @@ NetlinkSocket::getIfName(int ifIndex) const {
   auto future = promise.getFuture();
   evl_->runImmediatelyOrInEventLoop(
       [this, p = std::move(promise), ifIndex]() mutable {
-        std::string ifName{""};
-
-        for (const auto& linkEntry : links_) {
-          if (linkEntry.second.ifIndex == ifIndex) {
-            ifName = linkEntry.first;
-          }
-        }
-
-        p.setValue(ifName);
+        p.setValue(folly::get_default(ifIndexToName_, ifIndex, ""));
       });
   return future;
 }
@@ -836,10 +1108,19 @@ NetlinkSocket::getAllReachableNeighbors() {
 
 void
 NetlinkSocket::updateRouteCache() {
-  auto routes = nlSock_->getAllRoutes().get();
-  for (auto& route : routes) {
-    doHandleRouteEvent(route, false, true);
-  }
+  // Stream routes into cache instead of holding full dump in memory. Invoked
+  // from constructor only, which blocks till dump completes, hence cache is
+  // not accessed concurrently.
+  fbnl::RouteBuilder builder;
+  builder.setProtocolId(RTPROT_UNSPEC); // Explicitly set protocol to 0
+  builder.setType(RTN_UNSPEC); // Explicitly set type to 0
+  nlSock_
+      ->streamRoutes(
+          builder.build(),
+          [this](fbnl::Route&& route) {
+            doHandleRouteEvent(std::move(route), false, true);
+          })
+      .get();
 }
 
 std::vector<fbnl::Route>
@@ -889,4 +1170,11 @@ NetlinkSocket::registerNeighborListener(
   neighborListener_ = std::move(callback);
 }
 
+void
+NetlinkSocket::registerLinkListener(
+    std::function<void(const Link& link)> callback) {
+  std::lock_guard<std::mutex> g(linkListenerMutex_);
+  linkListener_ = std::move(callback);
+}
+
 } // namespace openr::fbnl
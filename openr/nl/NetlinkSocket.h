@@ -7,7 +7,12 @@
 
 #pragma once
 
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+
 #include <fbzmq/async/ZmqEventLoop.h>
+#include <fbzmq/async/ZmqTimeout.h>
 #include <folly/ConcurrentBitSet.h>
 #include <folly/IPAddress.h>
 #include <folly/String.h>
@@ -149,10 +154,19 @@ class NetlinkSocket {
     }
   };
 
+  /**
+   * Link events of an interface arriving within `linkEventCoalesceWindow` of
+   * the one handed to handler are coalesced. First event is handed to handler
+   * right away and only the latest of subsequent ones, at the end of window
+   * and if it changes state. Address and neighbor events of the interface
+   * flush pending link event first to preserve order. Zero disables it.
+   */
   explicit NetlinkSocket(
       fbzmq::ZmqEventLoop* evl,
       EventsHandler* handler = nullptr,
-      std::unique_ptr<openr::fbnl::NetlinkProtocolSocket> nlSock = nullptr);
+      std::unique_ptr<openr::fbnl::NetlinkProtocolSocket> nlSock = nullptr,
+      std::chrono::milliseconds linkEventCoalesceWindow =
+          std::chrono::milliseconds(0));
 
   virtual ~NetlinkSocket();
 
@@ -190,6 +204,16 @@ class NetlinkSocket {
    */
   virtual folly::Future<folly::Unit> delMplsRoute(Route route);
 
+  /**
+   * Bulk versions of addMplsRoute and delMplsRoute. Routes are programmed
+   * through a single batch of netlink messages, and all of them are attempted
+   * even if some fail. Failures are reported together.
+   * @throws fbnl::NlException with number of failed routes, first failed
+   *         label and its error
+   */
+  virtual folly::Future<folly::Unit> addMplsRoutes(std::vector<Route> routes);
+  virtual folly::Future<folly::Unit> delMplsRoutes(std::vector<Route> routes);
+
   /**
    * Sync route table in kernel with given route table
    * Delete routes that not in the 'newRouteDb' but in kernel
@@ -335,6 +359,10 @@ class NetlinkSocket {
   void registerNeighborListener(
       std::function<void(const NeighborUpdate& neighborUpdate)> callback);
 
+  // Callback invoked for every link event, independent of subscription of
+  // event handler. Used to keep tables of interfaces up to date.
+  void registerLinkListener(std::function<void(const Link& link)> callback);
+
   // Expose pointer to underlying protocol socket
   NetlinkProtocolSocket*
   getProtocolSocket() {
@@ -361,6 +389,12 @@ class NetlinkSocket {
 
   void doDeleteMplsRoute(Route route);
 
+  // Program routes in bulk, keeping cache in sync with every route that made
+  // it. Throws after all are attempted if any failed.
+  void doAddUpdateMplsRoutes(std::vector<Route> routes);
+
+  void doDeleteMplsRoutes(std::vector<Route> routes);
+
   void doSyncUnicastRoutes(uint8_t protocolId, NlUnicastRoutes syncDb);
 
   void checkUnicastRoute(const Route& route);
@@ -373,6 +407,18 @@ class NetlinkSocket {
 
   void removeNeighborCacheEntries(const std::string& ifName);
 
+  // Hand link event to handler, through coalescing window of interface
+  void coalesceLinkEvent(Link link);
+
+  // Hand pending link event of interface, if any, to handler
+  void flushLinkEvent(int ifIndex);
+
+  // Close expired coalescing windows and re-arm timer for next one
+  void processLinkEventWindows();
+
+  // Hand link event to handler
+  void publishLinkEvent(Link link);
+
   void updateLinkCache();
 
   void updateAddrCache();
@@ -397,6 +443,18 @@ class NetlinkSocket {
 
   EventsHandler* handler_{nullptr};
 
+  // Coalescing of link events. See constructor.
+  struct LinkEventWindow {
+    std::chrono::steady_clock::time_point windowEnd;
+    // Last state handed to handler
+    bool isUp{false};
+    // Latest event within window, not yet handed to handler
+    std::optional<Link> pending;
+  };
+  const std::chrono::milliseconds linkEventCoalesceWindow_{0};
+  std::unordered_map<int /* ifIndex */, LinkEventWindow> linkEventWindows_;
+  std::unique_ptr<fbzmq::ZmqTimeout> linkEventTimer_;
+
   std::optional<int> loopbackIfIndex_;
 
   /**
@@ -406,6 +464,10 @@ class NetlinkSocket {
   NlNeighbors neighbors_{};
   NlLinks links_{};
 
+  // Index of links_ by ifIndex. Looked up for every address and neighbor
+  // event.
+  std::unordered_map<int, std::string> ifIndexToName_;
+
   // Indicating to run which event type's handler
   folly::ConcurrentBitSet<MAX_EVENT_TYPE> eventFlags_;
 
@@ -414,6 +476,9 @@ class NetlinkSocket {
   std::mutex neighborListenerMutex_;
   std::function<void(const NeighborUpdate& neighborUpdate)> neighborListener_{
       nullptr};
+
+  std::mutex linkListenerMutex_;
+  std::function<void(const Link& link)> linkListener_{nullptr};
 };
 
 } // namespace openr::fbnl
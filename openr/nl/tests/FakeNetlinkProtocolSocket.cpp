@@ -9,6 +9,23 @@
 
 namespace openr::fbnl {
 
+namespace {
+
+// Address notification as kernel would send it for added or removed address
+fbnl::IfAddress
+buildAddrNotification(const fbnl::IfAddress& addr, bool isValid) {
+  fbnl::IfAddressBuilder builder;
+  builder.setPrefix(addr.getPrefix().value());
+  builder.setIfIndex(addr.getIfIndex());
+  if (addr.getScope().has_value()) {
+    builder.setScope(addr.getScope().value());
+  }
+  builder.setValid(isValid);
+  return builder.build();
+}
+
+} // namespace
+
 folly::SemiFuture<int>
 FakeNetlinkProtocolSocket::addRoute(const fbnl::Route& /* route */) {
   CHECK(false) << "Not implemented";
@@ -19,11 +36,42 @@ FakeNetlinkProtocolSocket::deleteRoute(const fbnl::Route& /* route */) {
   CHECK(false) << "Not implemented";
 }
 
+folly::SemiFuture<int>
+FakeNetlinkProtocolSocket::addRoutes(
+    const std::vector<fbnl::Route>& /* routes */) {
+  CHECK(false) << "Not implemented";
+}
+
+folly::SemiFuture<int>
+FakeNetlinkProtocolSocket::deleteRoutes(
+    const std::vector<fbnl::Route>& /* routes */) {
+  CHECK(false) << "Not implemented";
+}
+
+folly::SemiFuture<std::vector<int>>
+FakeNetlinkProtocolSocket::addRoutesWithStatus(
+    const std::vector<fbnl::Route>& /* routes */) {
+  CHECK(false) << "Not implemented";
+}
+
+folly::SemiFuture<std::vector<int>>
+FakeNetlinkProtocolSocket::deleteRoutesWithStatus(
+    const std::vector<fbnl::Route>& /* routes */) {
+  CHECK(false) << "Not implemented";
+}
+
 folly::SemiFuture<std::vector<fbnl::Route>>
 FakeNetlinkProtocolSocket::getRoutes(const fbnl::Route& /* filter */) {
   CHECK(false) << "Not implemented";
 }
 
+folly::SemiFuture<int>
+FakeNetlinkProtocolSocket::streamRoutes(
+    const fbnl::Route& /* filter */,
+    std::function<void(fbnl::Route&&)> /* routeCb */) {
+  CHECK(false) << "Not implemented";
+}
+
 folly::SemiFuture<int>
 FakeNetlinkProtocolSocket::addIfAddress(const fbnl::IfAddress& addr) {
   // Search for addr list of interface index (it must exists)
@@ -41,6 +89,7 @@ FakeNetlinkProtocolSocket::addIfAddress(const fbnl::IfAddress& addr) {
 
   // Non existing address. Add
   it->second.emplace_back(addr); // Add
+  notifyAddrListeners(buildAddrNotification(addr, true));
   return folly::SemiFuture<int>(0);
 }
 
@@ -56,6 +105,7 @@ FakeNetlinkProtocolSocket::deleteIfAddress(const fbnl::IfAddress& addr) {
   for (auto addrIt = it->second.begin(); addrIt != it->second.end(); ++addrIt) {
     if (addrIt->getPrefix() == addr.getPrefix()) {
       it->second.erase(addrIt);
+      notifyAddrListeners(buildAddrNotification(addr, false));
       return folly::SemiFuture<int>(0);
     }
   }
@@ -82,6 +132,7 @@ FakeNetlinkProtocolSocket::addLink(const fbnl::Link& link) {
 
   links_.emplace(link.getIfIndex(), link);
   ifAddrs_.emplace(link.getIfIndex(), std::list<fbnl::IfAddress>());
+  notifyLinkListeners(link, false /* isRemoved */);
   return folly::SemiFuture<int>(0);
 }
 
@@ -39,8 +39,19 @@ class FakeNetlinkProtocolSocket : public NetlinkProtocolSocket {
 
   folly::SemiFuture<int> addRoute(const fbnl::Route& route) override;
   folly::SemiFuture<int> deleteRoute(const fbnl::Route& route) override;
+  folly::SemiFuture<int> addRoutes(
+      const std::vector<fbnl::Route>& routes) override;
+  folly::SemiFuture<int> deleteRoutes(
+      const std::vector<fbnl::Route>& routes) override;
+  folly::SemiFuture<std::vector<int>> addRoutesWithStatus(
+      const std::vector<fbnl::Route>& routes) override;
+  folly::SemiFuture<std::vector<int>> deleteRoutesWithStatus(
+      const std::vector<fbnl::Route>& routes) override;
   folly::SemiFuture<std::vector<fbnl::Route>> getRoutes(
       const fbnl::Route& filter) override;
+  folly::SemiFuture<int> streamRoutes(
+      const fbnl::Route& filter,
+      std::function<void(fbnl::Route&&)> routeCb) override;
 
   folly::SemiFuture<int> addIfAddress(const fbnl::IfAddress&) override;
   folly::SemiFuture<int> deleteIfAddress(const fbnl::IfAddress&) override;
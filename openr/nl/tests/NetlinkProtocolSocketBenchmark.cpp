@@ -0,0 +1,430 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fb303/ServiceData.h>
+#include <fbzmq/async/ZmqEventLoop.h>
+#include <folly/Benchmark.h>
+#include <folly/Exception.h>
+#include <folly/Format.h>
+#include <folly/IPAddress.h>
+#include <folly/Subprocess.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <openr/common/tests/BenchmarkUtils.h>
+#include <openr/nl/NetlinkProtocolSocket.h>
+#include <openr/nl/NetlinkSocket.h>
+
+extern "C" {
+#include <net/if.h>
+#include <sched.h>
+}
+
+DEFINE_bool(
+    netns,
+    true,
+    "Run benchmark in a network namespace of its own, so that routes and "
+    "interfaces of host are not touched");
+
+using namespace openr::fbnl;
+
+namespace {
+// Virtual interfaces
+const std::string kVethNameX("vethBenchX");
+const std::string kVethNameY("vethBenchY");
+// Protocol ID and priority of programmed routes
+const uint8_t kRouteProtoId = 99;
+const uint32_t kRouteProtoIdPriority = 10;
+// First label pushed on nexthops of routes with MPLS action
+const int32_t kPushLabelBase = 1000;
+
+void
+runCommand(std::string const& cmd) {
+  // Run through shell
+  folly::Subprocess proc(cmd + " 2>/dev/null");
+  // Ignore result, commands are expected to succeed on a sane system
+  proc.wait();
+}
+
+/**
+ * Read all time sum of netlink stat
+ */
+int64_t
+getStat(std::string const& name) {
+  return facebook::fb303::fbData->getCounters()[name + ".sum"];
+}
+
+int64_t
+getElapsedUs(std::chrono::steady_clock::time_point const& startTime) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - startTime)
+      .count();
+}
+
+} // namespace
+
+namespace openr {
+
+/**
+ * Creates veth pair to program routes on, and runs NetlinkProtocolSocket and
+ * NetlinkSocket in event loops of their own
+ */
+class NetlinkBenchmarkWrapper {
+ public:
+  explicit NetlinkBenchmarkWrapper(size_t numRouteShards) {
+    runCommand(folly::sformat("ip link del {}", kVethNameX));
+    runCommand(folly::sformat(
+        "ip link add {} type veth peer name {}", kVethNameX, kVethNameY));
+    runCommand(folly::sformat("ip link set dev {} up", kVethNameX));
+    runCommand(folly::sformat("ip link set dev {} up", kVethNameY));
+    ifIndex = if_nametoindex(kVethNameX.c_str());
+    CHECK_NE(0, ifIndex) << "Failed to create " << kVethNameX;
+
+    auto nlProtocolSocket = std::make_unique<NetlinkProtocolSocket>(
+        &nlEvl, false /* enableIPv6RouteReplaceSemantics */, numRouteShards);
+    nlProtocolSocketPtr = nlProtocolSocket.get();
+    nlThread = std::thread([this]() { nlEvl.run(); });
+    nlEvl.waitUntilRunning();
+
+    nlSocket = std::make_unique<NetlinkSocket>(
+        &evl, nullptr, std::move(nlProtocolSocket));
+    evlThread = std::thread([this]() { evl.run(); });
+    evl.waitUntilRunning();
+  }
+
+  ~NetlinkBenchmarkWrapper() {
+    evl.stop();
+    evlThread.join();
+    nlEvl.stop();
+    nlThread.join();
+    nlSocket.reset();
+
+    // Routes over veth are gone along with it
+    runCommand(folly::sformat("ip link del {}", kVethNameX));
+  }
+
+  /**
+   * Build `numRoutes` IPv6 routes of `numNexthops` nexthops each. Nexthops
+   * push a label if `withMpls` is set. `seed` varies nexthops, so that routes
+   * built with different seeds replace each other.
+   */
+  std::vector<Route>
+  buildRoutes(
+      size_t numRoutes, size_t numNexthops, bool withMpls, size_t seed = 0) {
+    std::vector<NextHop> nexthops;
+    for (size_t i = 0; i < numNexthops; ++i) {
+      NextHopBuilder nhBuilder;
+      nhBuilder.setIfIndex(ifIndex).setGateway(folly::IPAddress(
+          folly::sformat("fe80::{:x}", 1 + (i + seed) % 0xfffe)));
+      if (withMpls) {
+        nhBuilder.setLabelAction(thrift::MplsActionCode::PUSH)
+            .setPushLabels({kPushLabelBase + static_cast<int32_t>(i)});
+      }
+      nexthops.emplace_back(nhBuilder.build());
+    }
+
+    std::vector<Route> routes;
+    routes.reserve(numRoutes);
+    for (size_t i = 0; i < numRoutes; ++i) {
+      RouteBuilder rtBuilder;
+      rtBuilder.setDestination(folly::IPAddress::createNetwork(folly::sformat(
+                                   "fd00:{:x}:{:x}::/64", i >> 16, i & 0xffff)))
+          .setProtocolId(kRouteProtoId)
+          .setPriority(kRouteProtoIdPriority)
+          .setFlags(0)
+          .setValid(true);
+      for (auto const& nexthop : nexthops) {
+        rtBuilder.addNextHop(nexthop);
+      }
+      routes.emplace_back(rtBuilder.build());
+    }
+    return routes;
+  }
+
+  fbzmq::ZmqEventLoop nlEvl;
+  fbzmq::ZmqEventLoop evl;
+  std::thread nlThread;
+  std::thread evlThread;
+  NetlinkProtocolSocket* nlProtocolSocketPtr{nullptr};
+  std::unique_ptr<NetlinkSocket> nlSocket;
+  int ifIndex{0};
+};
+
+/**
+ * Benchmark programming of routes through NetlinkProtocolSocket
+ * 1. Build `numRoutes` routes with `numNexthops` nexthops each
+ * 2. Add all of them, at once with bulk API (`bulk`) or with one request per
+ *    route issued back to back, and wait for all acks
+ * 3. Delete all of them the same way
+ *
+ * Reports programming rate of add and delete, sendmsg/recvmmsg calls per 1000
+ * routes and ack latency per sendmsg batch
+ */
+static void
+BM_NetlinkProtocolSocketRoutes(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    unsigned numRoutes,
+    unsigned numNexthops,
+    bool withMpls,
+    unsigned numRouteShards,
+    bool bulk) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto wrapper = std::make_unique<NetlinkBenchmarkWrapper>(numRouteShards);
+  auto nlSock = wrapper->nlProtocolSocketPtr;
+  const auto routes = wrapper->buildRoutes(numRoutes, numNexthops, withMpls);
+
+  auto program = [&](bool isAdd) {
+    if (bulk) {
+      return isAdd ? nlSock->addRoutes(routes).get()
+                   : nlSock->deleteRoutes(routes).get();
+    }
+    std::vector<folly::SemiFuture<int>> futures;
+    futures.reserve(routes.size());
+    for (auto const& route : routes) {
+      futures.emplace_back(
+          isAdd ? nlSock->addRoute(route) : nlSock->deleteRoute(route));
+    }
+    int status{0};
+    for (auto& future : futures) {
+      const auto ret = std::move(future).get();
+      status = status ? status : ret;
+    }
+    return status;
+  };
+
+  int64_t addUs{0};
+  int64_t delUs{0};
+  const auto sendmsgStart = getStat("netlink.sendmsg");
+  const auto recvStart = getStat("netlink.recv_datagrams");
+  for (uint32_t i = 0; i < iters; ++i) {
+    suspender.dismiss(); // Start measuring benchmark time
+
+    auto startTime = std::chrono::steady_clock::now();
+    CHECK_EQ(0, program(true /* isAdd */));
+    addUs += getElapsedUs(startTime);
+
+    startTime = std::chrono::steady_clock::now();
+    CHECK_EQ(0, program(false /* isAdd */));
+    delUs += getElapsedUs(startTime);
+
+    suspender.rehire(); // Stop measuring time again
+  }
+
+  const int64_t totalRoutes = int64_t{numRoutes} * iters;
+  const auto numSendmsg = getStat("netlink.sendmsg") - sendmsgStart;
+  const auto numRecv = getStat("netlink.recv_datagrams") - recvStart;
+  counters["add_routes_per_sec"] = addUs ? totalRoutes * 1000000 / addUs : 0;
+  counters["del_routes_per_sec"] = delUs ? totalRoutes * 1000000 / delUs : 0;
+  // Add and delete each issue one request per route
+  counters["sendmsg_per_1k_routes"] = numSendmsg * 500 / totalRoutes;
+  counters["recv_per_1k_routes"] = numRecv * 500 / totalRoutes;
+  counters["batch_ack_latency_us"] =
+      numSendmsg ? (addUs + delUs) / numSendmsg : 0;
+}
+
+/**
+ * Benchmark round trip of a single route request, by adding and deleting
+ * routes one at a time and waiting for ack of each before sending the next
+ *
+ * Reports percentiles of ack latency
+ */
+static void
+BM_NetlinkProtocolSocketAckLatency(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    unsigned numNexthops,
+    bool withMpls) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto wrapper = std::make_unique<NetlinkBenchmarkWrapper>(1);
+  auto nlSock = wrapper->nlProtocolSocketPtr;
+  const auto routes = wrapper->buildRoutes(iters, numNexthops, withMpls);
+  suspender.dismiss(); // Start measuring benchmark time
+
+  std::vector<int64_t> latencies;
+  latencies.reserve(iters * 2);
+  for (auto const& route : routes) {
+    auto startTime = std::chrono::steady_clock::now();
+    CHECK_EQ(0, nlSock->addRoute(route).get());
+    latencies.emplace_back(getElapsedUs(startTime));
+  }
+  for (auto const& route : routes) {
+    auto startTime = std::chrono::steady_clock::now();
+    CHECK_EQ(0, nlSock->deleteRoute(route).get());
+    latencies.emplace_back(getElapsedUs(startTime));
+  }
+
+  suspender.rehire(); // Stop measuring time again
+  if (latencies.empty()) {
+    return;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  counters["ack_latency_p50_us"] = latencies.at(latencies.size() / 2);
+  counters["ack_latency_p99_us"] = latencies.at(latencies.size() * 99 / 100);
+}
+
+/**
+ * Benchmark NetlinkSocket::syncUnicastRoutes(..), which diffs against its
+ * route cache and programs the difference
+ * 1. Sync `numRoutes` routes with `numNexthops` nexthops each. Nexthops change
+ *    every iteration, so that every route is replaced.
+ * 2. Sync empty route table, deleting all of them
+ *
+ * Reports programming rate and sendmsg calls per 1000 routes
+ */
+static void
+BM_NetlinkSocketSyncRoutes(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    unsigned numRoutes,
+    unsigned numNexthops,
+    bool withMpls) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto wrapper = std::make_unique<NetlinkBenchmarkWrapper>(1);
+
+  int64_t syncUs{0};
+  const auto sendmsgStart = getStat("netlink.sendmsg");
+  for (uint32_t i = 0; i < iters; ++i) {
+    NlUnicastRoutes routeDb;
+    for (auto& route :
+         wrapper->buildRoutes(numRoutes, numNexthops, withMpls, i)) {
+      auto prefix = route.getDestination();
+      routeDb.emplace(std::move(prefix), std::move(route));
+    }
+    suspender.dismiss(); // Start measuring benchmark time
+
+    auto startTime = std::chrono::steady_clock::now();
+    wrapper->nlSocket->syncUnicastRoutes(kRouteProtoId, std::move(routeDb))
+        .get();
+    wrapper->nlSocket->syncUnicastRoutes(kRouteProtoId, {}).get();
+    syncUs += getElapsedUs(startTime);
+
+    suspender.rehire(); // Stop measuring time again
+  }
+
+  const int64_t totalRoutes = int64_t{numRoutes} * iters;
+  const auto numSendmsg = getStat("netlink.sendmsg") - sendmsgStart;
+  counters["routes_per_sec"] =
+      syncUs ? totalRoutes * 2 * 1000000 / syncUs : 0;
+  counters["sendmsg_per_1k_routes"] = numSendmsg * 500 / totalRoutes;
+}
+
+// The parameters are number of routes, nexthops per route, whether nexthops
+// push a label, number of route sockets and whether bulk API is used
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkProtocolSocketRoutes,
+    counters,
+    1000_1_ip_1_single,
+    1000,
+    1,
+    false,
+    1,
+    false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkProtocolSocketRoutes,
+    counters,
+    1000_1_ip_1_bulk,
+    1000,
+    1,
+    false,
+    1,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkProtocolSocketRoutes,
+    counters,
+    10000_1_ip_1_bulk,
+    10000,
+    1,
+    false,
+    1,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkProtocolSocketRoutes,
+    counters,
+    10000_16_ip_1_bulk,
+    10000,
+    16,
+    false,
+    1,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkProtocolSocketRoutes,
+    counters,
+    10000_64_ip_1_bulk,
+    10000,
+    64,
+    false,
+    1,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkProtocolSocketRoutes,
+    counters,
+    10000_16_mpls_1_bulk,
+    10000,
+    16,
+    true,
+    1,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkProtocolSocketRoutes,
+    counters,
+    10000_16_ip_4_bulk,
+    10000,
+    16,
+    false,
+    4,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkProtocolSocketRoutes,
+    counters,
+    10000_16_mpls_4_bulk,
+    10000,
+    16,
+    true,
+    4,
+    true);
+
+// The parameters are nexthops per route and whether nexthops push a label
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkProtocolSocketAckLatency, counters, 1_ip, 1, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkProtocolSocketAckLatency, counters, 16_ip, 16, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkProtocolSocketAckLatency, counters, 16_mpls, 16, true);
+
+// The parameters are number of routes, nexthops per route and whether
+// nexthops push a label
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkSocketSyncRoutes, counters, 1000_16_ip, 1000, 16, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkSocketSyncRoutes, counters, 10000_16_ip, 10000, 16, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_NetlinkSocketSyncRoutes, counters, 10000_16_mpls, 10000, 16, true);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+
+  // Threads created from here on, including of netlink sockets, inherit the
+  // namespace. Loopback must be up for the kernel to accept routes.
+  if (FLAGS_netns) {
+    folly::checkUnixError(unshare(CLONE_NEWNET), "unshare(CLONE_NEWNET)");
+    runCommand("ip link set dev lo up");
+  }
+
+  folly::runBenchmarks();
+  return 0;
+}
@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -514,6 +515,30 @@ TEST_F(NlMessageFixture, EncodeLabel) {
   }
 }
 
+TEST_F(NlMessageFixture, MessageBufferReuse) {
+  // Message built in reused buffer must be same as in fresh one
+  std::vector<openr::fbnl::NextHop> paths;
+  paths.push_back(buildNextHop(
+      folly::none, folly::none, folly::none, ipAddrY1V6, ifIndexY));
+  auto route = buildRoute(kRouteProtoId, ipPrefix1, folly::none, paths);
+
+  auto buildMessage = [&route]() {
+    auto rtmMsg = std::make_unique<NetlinkRouteMessage>();
+    EXPECT_EQ(0, rtmMsg->addRoute(route));
+    auto const* data =
+        reinterpret_cast<const char*>(rtmMsg->getMessagePtr());
+    std::string bytes(data, rtmMsg->getDataLength());
+    rtmMsg->setReturnStatus(0);
+    return bytes;
+  };
+
+  const auto bytes = buildMessage();
+  const auto poolSize = openr::fbnl::NetlinkMessageBufferPool::size();
+  EXPECT_LE(1, poolSize);
+  EXPECT_EQ(bytes, buildMessage());
+  EXPECT_EQ(poolSize, openr::fbnl::NetlinkMessageBufferPool::size());
+}
+
 TEST_F(NlMessageFixture, IpRouteSingleNextHop) {
   // Add IPv6 route with one next hop and no labels
   // outoing IF is vethTestY
@@ -1018,6 +1043,112 @@ TEST_F(NlMessageFixture, MultipleIpRoutesLabelNexthop) {
   EXPECT_EQ(0, kernelRoutes.size());
 }
 
+TEST_F(NlMessageFixture, MultipleIpRoutesBulk) {
+  // Add and delete IPv6 routes with bulk APIs
+
+  uint32_t ackCount{0};
+  uint32_t count{100000};
+  const auto routes = buildV6RouteDb(count);
+
+  ackCount = getAckCount();
+  LOG(INFO) << "Adding " << count << " routes in bulk";
+  EXPECT_EQ(0, nlSock->addRoutes(routes).get());
+  LOG(INFO) << "Done adding " << count << " routes";
+  EXPECT_EQ(0, getErrorCount());
+  EXPECT_GE(getAckCount(), ackCount + count);
+
+  auto kernelRoutes = nlSock->getIPv6Routes(kRouteProtoId).get();
+  EXPECT_EQ(kernelRoutes.size(), routes.size());
+  EXPECT_EQ(findRoutesInKernelRoutes(kernelRoutes, routes), count);
+
+  // Replace all routes in bulk again
+  EXPECT_EQ(0, nlSock->addRoutes(routes).get());
+  kernelRoutes = nlSock->getIPv6Routes(kRouteProtoId).get();
+  EXPECT_EQ(kernelRoutes.size(), routes.size());
+
+  // delete routes
+  ackCount = getAckCount();
+  EXPECT_EQ(0, nlSock->deleteRoutes(routes).get());
+  EXPECT_EQ(0, getErrorCount());
+  EXPECT_GE(getAckCount(), ackCount + count);
+
+  // Deleting again reports missing routes
+  EXPECT_EQ(ESRCH, nlSock->deleteRoutes(routes).get());
+
+  // verify route deletions
+  kernelRoutes = nlSock->getIPv6Routes(kRouteProtoId).get();
+  EXPECT_EQ(0, kernelRoutes.size());
+}
+
+TEST_F(NlMessageFixture, StreamRoutes) {
+  // Stream IPv6 routes filtered by protocol
+
+  uint32_t count{10000};
+  const auto routes = buildV6RouteDb(count);
+  EXPECT_EQ(0, nlSock->addRoutes(routes).get());
+
+  auto streamRoutes = [this](uint8_t protocolId) {
+    fbnl::RouteBuilder builder;
+    builder.setDestination({folly::IPAddressV6("::"), 0});
+    builder.setProtocolId(protocolId);
+    std::vector<fbnl::Route> streamedRoutes;
+    EXPECT_EQ(
+        0,
+        nlSock
+            ->streamRoutes(
+                builder.build(),
+                [&streamedRoutes](fbnl::Route&& route) {
+                  streamedRoutes.emplace_back(std::move(route));
+                })
+            .get());
+    return streamedRoutes;
+  };
+
+  auto streamedRoutes = streamRoutes(kRouteProtoId);
+  EXPECT_EQ(streamedRoutes.size(), routes.size());
+  EXPECT_EQ(findRoutesInKernelRoutes(streamedRoutes, routes), count);
+
+  // Routes of other protocol are skipped
+  EXPECT_EQ(0, streamRoutes(kRouteProtoId + 1).size());
+
+  EXPECT_EQ(0, nlSock->deleteRoutes(routes).get());
+  EXPECT_EQ(0, streamRoutes(kRouteProtoId).size());
+}
+
+TEST_F(NlMessageFixture, MultipleIpRoutesSharded) {
+  // Add and delete IPv6 routes over multiple route shards
+
+  uint32_t count{10000};
+  const auto routes = buildV6RouteDb(count);
+  auto shardedSock = std::make_unique<NetlinkProtocolSocket>(
+      &evl, FLAGS_enable_ipv6_rr_semantics, 4 /* numRouteShards */);
+
+  // Single and bulk adds of same routes are ordered per destination
+  std::vector<folly::SemiFuture<int>> futures;
+  for (auto const& route : routes) {
+    futures.emplace_back(shardedSock->addRoute(route));
+  }
+  futures.emplace_back(shardedSock->addRoutes(routes));
+  EXPECT_EQ(
+      0,
+      NetlinkProtocolSocket::collectReturnStatus(std::move(futures)).get());
+  EXPECT_EQ(0, getErrorCount());
+
+  auto kernelRoutes = shardedSock->getIPv6Routes(kRouteProtoId).get();
+  EXPECT_EQ(kernelRoutes.size(), routes.size());
+  EXPECT_EQ(findRoutesInKernelRoutes(kernelRoutes, routes), count);
+
+  // delete routes
+  EXPECT_EQ(0, shardedSock->deleteRoutes(routes).get());
+  kernelRoutes = shardedSock->getIPv6Routes(kRouteProtoId).get();
+  EXPECT_EQ(0, kernelRoutes.size());
+
+  // Stop event loop ahead of destroying socket using it
+  evl.stop();
+  eventThread.join();
+  shardedSock.reset();
+}
+
 TEST_F(NlMessageFixture, LabelRouteV4Nexthop) {
   // Add label route with single path label with PHP nexthop
 
@@ -1328,6 +1459,45 @@ TEST_F(NlMessageFixture, MultipleLabelRoutes) {
   EXPECT_EQ(0, kernelRoutes.size());
 }
 
+TEST_F(NlMessageFixture, MultipleLabelRoutesWithStatus) {
+  // Add and delete label routes in bulk, with status of every route
+
+  uint32_t count{20000};
+  std::vector<openr::fbnl::NextHop> paths;
+  paths.push_back(buildNextHop(
+      folly::none,
+      swapLabel,
+      thrift::MplsActionCode::SWAP,
+      ipAddrY1V6,
+      ifIndexZ));
+  std::vector<openr::fbnl::Route> labelRoutes;
+  for (uint32_t i = 0; i < count; i++) {
+    labelRoutes.push_back(
+        buildRoute(kRouteProtoId, folly::none, 600 + i, paths));
+  }
+
+  auto statuses = nlSock->addRoutesWithStatus(labelRoutes).get();
+  ASSERT_EQ(count, statuses.size());
+  EXPECT_EQ(count, std::count(statuses.begin(), statuses.end(), 0));
+  EXPECT_EQ(0, getErrorCount());
+  auto kernelRoutes = nlSock->getMplsRoutes(kRouteProtoId).get();
+  EXPECT_EQ(findRoutesInKernelRoutes(kernelRoutes, labelRoutes), count);
+
+  // Delete half of routes, then all of them. Status tells which were gone.
+  std::vector<openr::fbnl::Route> halfRoutes(
+      labelRoutes.begin(), labelRoutes.begin() + count / 2);
+  statuses = nlSock->deleteRoutesWithStatus(halfRoutes).get();
+  EXPECT_EQ(count / 2, std::count(statuses.begin(), statuses.end(), 0));
+  statuses = nlSock->deleteRoutesWithStatus(labelRoutes).get();
+  ASSERT_EQ(count, statuses.size());
+  for (uint32_t i = 0; i < count; i++) {
+    EXPECT_EQ(i < count / 2 ? ESRCH : 0, std::abs(statuses[i]));
+  }
+
+  kernelRoutes = nlSock->getMplsRoutes(kRouteProtoId).get();
+  EXPECT_EQ(0, kernelRoutes.size());
+}
+
 // Add and remove 250 IPv4 and IPv6 addresses (total 500)
 TEST_F(NlMessageFixture, AddrScaleTest) {
   const int addrCount{250};
@@ -325,6 +325,94 @@ TEST_F(NetlinkSocketSubscribeFixture, DefaultStateTest) {
   EXPECT_EQ(0, myHandler->addrDelEventCount);
 }
 
+// Flap a link rapidly and test that events are coalesced into latest state
+TEST_F(NetlinkSocketSubscribeFixture, LinkFlapCoalesceTest) {
+  ZmqEventLoop zmqLoop;
+  const std::chrono::milliseconds kCoalesceWindow{500};
+  const int flapCount{10};
+
+  auto myHandler = std::make_shared<MyNetlinkHandler>(
+      []() noexcept {}, "vethTest" /* Filter on test links only */);
+
+  NetlinkSocket netlinkSocket(
+      &zmqLoop, myHandler.get(), std::move(nlProtocolSocket), kCoalesceWindow);
+  myHandler->setNetlinkSocket(&netlinkSocket);
+  netlinkSocket.subscribeEvent(fbnl::LINK_EVENT);
+
+  std::thread eventThread([&]() {
+    zmqLoop.run();
+    zmqLoop.waitUntilStopped();
+  });
+  zmqLoop.waitUntilRunning();
+
+  // Peer must be up for link to be running
+  auto peerCmd = "ip link set dev {} up"_shellify(kVethNameY.c_str());
+  folly::Subprocess peerProc(std::move(peerCmd));
+  EXPECT_EQ(0, peerProc.wait().exitStatus());
+
+  // Flap link and leave it up
+  for (int flap = 0; flap < flapCount; flap++) {
+    auto cmd = "ip link set dev {} up"_shellify(kVethNameX.c_str());
+    folly::Subprocess proc(std::move(cmd));
+    EXPECT_EQ(0, proc.wait().exitStatus());
+
+    cmd = "ip link set dev {} down"_shellify(kVethNameX.c_str());
+    folly::Subprocess proc1(std::move(cmd));
+    EXPECT_EQ(0, proc1.wait().exitStatus());
+  }
+  auto cmd = "ip link set dev {} up"_shellify(kVethNameX.c_str());
+  folly::Subprocess proc(std::move(cmd));
+  EXPECT_EQ(0, proc.wait().exitStatus());
+
+  // Wait for windows to expire
+  std::this_thread::sleep_for(3 * kCoalesceWindow);
+  zmqLoop.stop();
+  eventThread.join();
+
+  // Latest state is handed over, with fewer events than flaps
+  ASSERT_EQ(1, myHandler->links.count(kVethNameX));
+  EXPECT_TRUE(myHandler->links.at(kVethNameX).isUp);
+  EXPECT_GT(
+      2 * flapCount,
+      myHandler->linkAddEventCount + myHandler->linkDelEventCount);
+}
+
+// Link listener receives link events without any event handler
+TEST_F(NetlinkSocketSubscribeFixture, LinkListenerTest) {
+  ZmqEventLoop zmqLoop;
+  NetlinkSocket netlinkSocket(&zmqLoop, nullptr, std::move(nlProtocolSocket));
+
+  folly::Baton linkBaton;
+  int ifIndex{0};
+  netlinkSocket.registerLinkListener([&](const Link& link) {
+    if (link.getLinkName() == kVethNameX and link.isUp()) {
+      ifIndex = link.getIfIndex();
+      linkBaton.post();
+    }
+  });
+
+  std::thread eventThread([&]() {
+    zmqLoop.run();
+    zmqLoop.waitUntilStopped();
+  });
+  zmqLoop.waitUntilRunning();
+
+  // Peer must be up for link to be running
+  auto cmd = "ip link set dev {} up"_shellify(kVethNameY.c_str());
+  folly::Subprocess peerProc(std::move(cmd));
+  EXPECT_EQ(0, peerProc.wait().exitStatus());
+  cmd = "ip link set dev {} up"_shellify(kVethNameX.c_str());
+  folly::Subprocess proc(std::move(cmd));
+  EXPECT_EQ(0, proc.wait().exitStatus());
+
+  EXPECT_TRUE(linkBaton.try_wait_for(kEventLoopTimeout));
+  netlinkSocket.registerLinkListener(nullptr);
+  EXPECT_EQ(netlinkSocket.getIfIndex(kVethNameX).get(), ifIndex);
+
+  zmqLoop.stop();
+  eventThread.join();
+}
+
 // Flap a link and test for events
 // Also get and verify links states in main thread
 TEST_F(NetlinkSocketSubscribeFixture, LinkFlapTest) {
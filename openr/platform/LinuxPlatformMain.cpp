@@ -34,6 +34,11 @@ DEFINE_bool(
     enable_netlink_system_handler,
     true,
     "If set, netlink system handler will be started");
+DEFINE_int32(
+    netlink_link_event_coalesce_ms,
+    50,
+    "Link events of an interface within this window are coalesced to the "
+    "latest state before published. 0 disables coalescing.");
 
 using openr::NetlinkFibHandler;
 using openr::NetlinkSystemHandler;
@@ -66,13 +71,20 @@ main(int argc, char** argv) {
       }));
   nlProtocolSocketEventLoop->waitUntilRunning();
 
-  // Create event publisher to handle event subscription
-  auto eventPublisher = std::make_unique<openr::PlatformPublisher>(
-      context, openr::PlatformPublisherUrl{FLAGS_platform_pub_url});
-
   auto nlEventLoop = std::make_unique<fbzmq::ZmqEventLoop>();
+
+  // Create event publisher to handle event subscription, batching events
+  // handled in one iteration of netlink event loop
+  auto eventPublisher = std::make_unique<openr::PlatformPublisher>(
+      context,
+      openr::PlatformPublisherUrl{FLAGS_platform_pub_url},
+      nlEventLoop.get());
   auto nlSocket = std::make_shared<openr::fbnl::NetlinkSocket>(
-      nlEventLoop.get(), eventPublisher.get(), std::move(nlProtocolSocket));
+      nlEventLoop.get(),
+      eventPublisher.get(),
+      std::move(nlProtocolSocket),
+      std::chrono::milliseconds(
+          std::max(0, FLAGS_netlink_link_event_coalesce_ms)));
 
   // Subscribe selected network events
   nlSocket->subscribeEvent(openr::fbnl::LINK_EVENT);
@@ -41,10 +41,14 @@ NetlinkFibHandler::NetlinkFibHandler(
     std::shared_ptr<fbnl::NetlinkSocket> netlinkSocket)
     : netlinkSocket_(netlinkSocket),
       evl_{zmqEventLoop},
+      interfaceCache_(std::make_shared<InterfaceTable>()),
       startTime_(std::chrono::duration_cast<std::chrono::seconds>(
                      std::chrono::system_clock::now().time_since_epoch())
                      .count()) {
   CHECK_NOTNULL(zmqEventLoop);
+  netlinkSocket_->registerLinkListener([this](const fbnl::Link& link) {
+    updateInterfaceCache({link});
+  });
   // TODO: Implement this neighbor in this class
   netlinkSocket_->registerNeighborListener(
       [this](const fbnl::NetlinkSocket::NeighborUpdate& neighborUpdate) {
@@ -60,7 +64,9 @@ NetlinkFibHandler::NetlinkFibHandler(
       });
 }
 
-NetlinkFibHandler::~NetlinkFibHandler() {}
+NetlinkFibHandler::~NetlinkFibHandler() {
+  netlinkSocket_->registerLinkListener(nullptr);
+}
 
 template <class A>
 folly::Expected<int16_t, bool>
@@ -104,11 +110,16 @@ std::vector<thrift::NextHopThrift>
 NetlinkFibHandler::buildNextHops(const fbnl::NextHopSet& nextHops) {
   std::vector<thrift::NextHopThrift> thriftNextHops;
 
+  auto interfaces = interfaceCache_.load();
   for (auto const& nh : nextHops) {
     CHECK(nh.getGateway().has_value());
-    const auto& ifName = nh.getIfIndex().has_value()
-        ? getIfName(nh.getIfIndex().value()).value()
-        : "";
+    std::string ifName;
+    if (nh.getIfIndex().has_value()) {
+      auto maybeName = interfaces->getIfName(nh.getIfIndex().value());
+      ifName = maybeName.has_value()
+          ? std::move(maybeName).value()
+          : getIfName(nh.getIfIndex().value()).value();
+    }
     thrift::NextHopThrift nextHop;
     nextHop.address = toBinaryAddress(nh.getGateway().value());
     nextHop.address.ifName_ref() = ifName;
@@ -284,19 +295,20 @@ NetlinkFibHandler::future_addMplsRoutes(
     int16_t clientId, std::unique_ptr<std::vector<thrift::MplsRoute>> routes) {
   LOG(INFO) << "Adding/Updates routes of client: " << getClientName(clientId);
 
-  std::vector<folly::Future<folly::Unit>> futures;
-  for (auto& route : *routes) {
-    auto ptr = std::make_unique<thrift::MplsRoute>(std::move(route));
-    futures.emplace_back(future_addMplsRoute(clientId, std::move(ptr)));
+  folly::Promise<folly::Unit> promise;
+  auto future = promise.getFuture();
+  auto protocol = getProtocol(promise, clientId);
+  if (protocol.hasError()) {
+    return future;
   }
 
-  return collectAllUnsafe(std::move(futures))
-      .then([](folly::Try<std::vector<folly::Try<folly::Unit>>>&& retvals) {
-        for (auto& retval : retvals.value()) {
-          retval.value(); // Throw exception if any
-        }
-        return folly::Unit(); // Return unit on success
-      });
+  // Program all labels in one batch of netlink messages
+  std::vector<fbnl::Route> mplsRoutes;
+  mplsRoutes.reserve(routes->size());
+  for (auto const& route : *routes) {
+    mplsRoutes.emplace_back(buildMplsRoute(route, protocol.value()));
+  }
+  return netlinkSocket_->addMplsRoutes(std::move(mplsRoutes));
 }
 
 folly::Future<folly::Unit>
@@ -304,18 +316,22 @@ NetlinkFibHandler::future_deleteMplsRoutes(
     int16_t clientId, std::unique_ptr<std::vector<int32_t>> topLabels) {
   LOG(INFO) << "Deleting mpls routes of client: " << getClientName(clientId);
 
-  std::vector<folly::Future<folly::Unit>> futures;
-  for (auto& label : *topLabels) {
-    futures.emplace_back(future_deleteMplsRoute(clientId, label));
+  folly::Promise<folly::Unit> promise;
+  auto future = promise.getFuture();
+  auto protocol = getProtocol(promise, clientId);
+  if (protocol.hasError()) {
+    return future;
   }
 
-  return collectAllUnsafe(std::move(futures))
-      .then([](folly::Try<std::vector<folly::Try<folly::Unit>>>&& retvals) {
-        for (auto& retval : retvals.value()) {
-          retval.value(); // Throw exception if any
-        }
-        return folly::Unit(); // Return unit on success
-      });
+  // Delete all labels in one batch of netlink messages
+  std::vector<fbnl::Route> mplsRoutes;
+  mplsRoutes.reserve(topLabels->size());
+  for (auto const label : *topLabels) {
+    fbnl::RouteBuilder rtBuilder;
+    mplsRoutes.emplace_back(
+        rtBuilder.setMplsLabel(label).setProtocolId(protocol.value()).build());
+  }
+  return netlinkSocket_->delMplsRoutes(std::move(mplsRoutes));
 }
 
 folly::Future<folly::Unit>
@@ -344,6 +360,79 @@ NetlinkFibHandler::future_syncFib(
       protocol.value(), std::move(newRoutes));
 }
 
+folly::Future<folly::Unit>
+NetlinkFibHandler::future_syncFibChunk(
+    int16_t clientId, std::unique_ptr<thrift::UnicastRouteSyncChunk> chunk) {
+  VLOG(1) << "Syncing FIB with chunk " << chunk->chunkIndex << "/"
+          << chunk->numChunks << " of sync " << chunk->syncId
+          << ". Client: " << getClientName(clientId);
+
+  folly::Promise<folly::Unit> promise;
+  auto future = promise.getFuture();
+  auto protocol = getProtocol(promise, clientId);
+  if (protocol.hasError()) {
+    return future;
+  }
+  if (chunk->chunkIndex < 0 or chunk->chunkIndex >= chunk->numChunks) {
+    promise.setException(fbnl::NlException(folly::sformat(
+        "Invalid chunk {} of {} chunks", chunk->chunkIndex, chunk->numChunks)));
+    return future;
+  }
+
+  // Chunks are serialized in event loop along with other route updates
+  evl_->runImmediatelyOrInEventLoop([this,
+                                     clientId,
+                                     protocol = protocol.value(),
+                                     promise = std::move(promise),
+                                     chunk = std::move(chunk)]() mutable {
+    auto& sync = chunkedSyncs_[clientId];
+    if (sync.syncId != chunk->syncId) {
+      // First chunk of new sync, abandon previous one if any
+      if (sync.syncId != 0) {
+        LOG(INFO) << "Abandoning chunked sync " << sync.syncId
+                  << " of client: " << getClientName(clientId);
+      }
+      sync = ChunkedSync();
+      sync.syncId = chunk->syncId;
+      sync.numChunks = chunk->numChunks;
+    }
+
+    try {
+      for (auto& route : chunk->routes) {
+        sync.prefixes.emplace(toIPNetwork(route.dest));
+        // This is going to be synchronous call as we are invoking from
+        // within event loop
+        future_addUnicastRoute(
+            clientId, std::make_unique<thrift::UnicastRoute>(std::move(route)))
+            .get();
+      }
+      sync.programmedChunks.emplace(chunk->chunkIndex);
+
+      if (sync.programmedChunks.size() == sync.numChunks) {
+        // All chunks are programmed. Delete routes missing from all of them.
+        auto stalePrefixes = std::make_unique<std::vector<thrift::IpPrefix>>();
+        for (auto const& kv :
+             netlinkSocket_->getCachedUnicastRoutes(protocol).get()) {
+          if (not sync.prefixes.count(kv.first)) {
+            stalePrefixes->emplace_back(toIpPrefix(kv.first));
+          }
+        }
+        LOG(INFO) << "Done chunked sync " << sync.syncId << " of client: "
+                  << getClientName(clientId) << ", deleting "
+                  << stalePrefixes->size() << " stale routes";
+        chunkedSyncs_.erase(clientId);
+        future_deleteUnicastRoutes(clientId, std::move(stalePrefixes)).get();
+      }
+    } catch (std::exception const& e) {
+      promise.setException(e);
+      return;
+    }
+    promise.setValue();
+  });
+
+  return future;
+}
+
 folly::Future<folly::Unit>
 NetlinkFibHandler::future_syncMplsFib(
     int16_t clientId,
@@ -471,11 +560,16 @@ void
 NetlinkFibHandler::buildNextHop(
     fbnl::RouteBuilder& rtBuilder,
     const std::vector<thrift::NextHopThrift>& nhop) {
-  // add nexthops
+  // add nexthops. All of them are resolved from the same snapshot of
+  // interfaces, unless one is missing.
   fbnl::NextHopBuilder nhBuilder;
+  auto interfaces = interfaceCache_.load();
   for (const auto& nh : nhop) {
     if (nh.address.ifName_ref()) {
-      nhBuilder.setIfIndex(getIfIndex(*nh.address.ifName_ref()).value());
+      auto ifIndex = interfaces->getIfIndex(*nh.address.ifName_ref());
+      nhBuilder.setIfIndex(
+          ifIndex.has_value() ? ifIndex.value()
+                              : getIfIndex(*nh.address.ifName_ref()).value());
     }
     nhBuilder.setGateway(toIPAddress(nh.address));
     buildMplsAction(nhBuilder, nh);
@@ -528,49 +622,47 @@ NetlinkFibHandler::buildMplsRoute(
 }
 
 std::optional<int>
-NetlinkFibHandler::getIfIndex(const std::string& ifName) {
-  // Lambda function to lookup ifName in cache
-  auto getCachedIndex = [this, &ifName]() -> std::optional<int> {
-    auto cache = ifNameToIndex_.rlock();
-    auto it = cache->find(ifName);
-    if (it != cache->end()) {
-      return it->second;
-    }
-    return std::nullopt;
-  };
+NetlinkFibHandler::InterfaceTable::getIfIndex(const std::string& ifName) const {
+  auto it = ifNameToIndex.find(ifName);
+  if (it != ifNameToIndex.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string>
+NetlinkFibHandler::InterfaceTable::getIfName(int ifIndex) const {
+  auto it = ifIndexToName.find(ifIndex);
+  if (it != ifIndexToName.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
 
+std::optional<int>
+NetlinkFibHandler::getIfIndex(const std::string& ifName) {
   // Lookup in cache. Return if exists
-  auto maybeIndex = getCachedIndex();
+  auto maybeIndex = interfaceCache_.load()->getIfIndex(ifName);
   if (maybeIndex.has_value()) {
     return maybeIndex;
   }
 
   // Update cache and return cached index
   initializeInterfaceCache();
-  return getCachedIndex();
+  return interfaceCache_.load()->getIfIndex(ifName);
 }
 
 std::optional<std::string>
 NetlinkFibHandler::getIfName(const int ifIndex) {
-  // Lambda function to lookup ifIndex in cache
-  auto getCachedName = [this, ifIndex]() -> std::optional<std::string> {
-    auto cache = ifIndexToName_.rlock();
-    auto it = cache->find(ifIndex);
-    if (it != cache->end()) {
-      return it->second;
-    }
-    return std::nullopt;
-  };
-
   // Lookup in cache. Return if exists
-  auto maybeName = getCachedName();
+  auto maybeName = interfaceCache_.load()->getIfName(ifIndex);
   if (maybeName.has_value()) {
     return maybeName;
   }
 
-  // Update cache and return cached index
+  // Update cache and return cached name
   initializeInterfaceCache();
-  return getCachedName();
+  return interfaceCache_.load()->getIfName(ifIndex);
 }
 
 std::optional<int>
@@ -589,23 +681,44 @@ NetlinkFibHandler::getLoopbackIfIndex() {
 
 void
 NetlinkFibHandler::initializeInterfaceCache() noexcept {
-  auto links = netlinkSocket_->getProtocolSocket()->getAllLinks().get();
+  updateInterfaceCache(
+      netlinkSocket_->getProtocolSocket()->getAllLinks().get());
+}
 
-  // Acquire locks on the cache
-  auto lockedIfNameToIndex = ifNameToIndex_.wlock();
-  auto lockedIfIndexToName = ifIndexToName_.wlock();
+void
+NetlinkFibHandler::updateInterfaceCache(
+    const std::vector<fbnl::Link>& links) noexcept {
+  std::lock_guard<std::mutex> g(interfaceCacheMutex_);
+  auto interfaces = std::make_shared<InterfaceTable>(*interfaceCache_.load());
 
   // NOTE: We don't clear cache instead override entries
   for (auto const& link : links) {
+    const auto& ifName = link.getLinkName();
+    const auto ifIndex = link.getIfIndex();
+
+    // Drop mappings of previous name of index and previous index of name
+    auto nameIt = interfaces->ifIndexToName.find(ifIndex);
+    if (nameIt != interfaces->ifIndexToName.end() and
+        nameIt->second != ifName) {
+      interfaces->ifNameToIndex.erase(nameIt->second);
+    }
+    auto indexIt = interfaces->ifNameToIndex.find(ifName);
+    if (indexIt != interfaces->ifNameToIndex.end() and
+        indexIt->second != ifIndex) {
+      interfaces->ifIndexToName.erase(indexIt->second);
+    }
+
     // Update name <-> index mappings
-    (*lockedIfNameToIndex)[link.getLinkName()] = link.getIfIndex();
-    (*lockedIfIndexToName)[link.getIfIndex()] = link.getLinkName();
+    interfaces->ifNameToIndex[ifName] = ifIndex;
+    interfaces->ifIndexToName[ifIndex] = ifName;
 
     // Update loopbackIfIndex_
     if (link.isLoopback()) {
-      loopbackIfIndex_.store(link.getIfIndex());
+      loopbackIfIndex_.store(ifIndex);
     }
   }
+
+  interfaceCache_.store(std::move(interfaces));
 }
 
 void
@@ -11,10 +11,13 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <fbzmq/async/ZmqTimeout.h>
 #include <folly/Expected.h>
+#include <folly/concurrency/AtomicSharedPtr.h>
 #include <folly/futures/Future.h>
 #include <folly/io/async/AsyncSocket.h>
 
@@ -81,6 +84,10 @@ class NetlinkFibHandler : public thrift::FibServiceSvIf {
       int16_t clientId,
       std::unique_ptr<std::vector<thrift::MplsRoute>> routes) override;
 
+  folly::Future<folly::Unit> future_syncFibChunk(
+      int16_t clientId,
+      std::unique_ptr<thrift::UnicastRouteSyncChunk> chunk) override;
+
   void sendNeighborDownInfo(
       std::unique_ptr<std::vector<std::string>> neighborIp) override;
 
@@ -180,7 +187,7 @@ class NetlinkFibHandler : public thrift::FibServiceSvIf {
    *
    * Cache is used for optimized response to subsequent query for same interface
    * name or index. Entries in cache are lazily initialized on first instance by
-   * querying `getAllLinks`.
+   * querying `getAllLinks` and then kept up to date from link events.
    *
    * Returns `std::nullopt` if mapping is not found
    */
@@ -207,15 +214,47 @@ class NetlinkFibHandler : public thrift::FibServiceSvIf {
   NetlinkFibHandler(const NetlinkFibHandler&) = delete;
   NetlinkFibHandler& operator=(const NetlinkFibHandler&) = delete;
 
+  /**
+   * Immutable snapshot of interface index <-> name mapping
+   */
+  struct InterfaceTable {
+    std::optional<int> getIfIndex(const std::string& ifName) const;
+    std::optional<std::string> getIfName(int ifIndex) const;
+
+    std::unordered_map<std::string, int> ifNameToIndex;
+    std::unordered_map<int, std::string> ifIndexToName;
+  };
+
   /**
    * Initialize cache related to interfaces. Especially loopbackIfIndex_
    * and interface name <-> index mappings
    */
   void initializeInterfaceCache() noexcept;
 
-  // Cache for interface index <-> name mapping
-  folly::Synchronized<std::unordered_map<std::string, int>> ifNameToIndex_;
-  folly::Synchronized<std::unordered_map<int, std::string>> ifIndexToName_;
+  /**
+   * Publish new snapshot of interface table with mappings of given links
+   * merged in. Stale mappings of renamed interfaces are dropped.
+   */
+  void updateInterfaceCache(const std::vector<fbnl::Link>& links) noexcept;
+
+  // Cache for interface index <-> name mapping. Readers take a snapshot
+  // without locking, e.g. once for all nexthops of a route. Writers copy,
+  // update and swap snapshot under interfaceCacheMutex_.
+  folly::atomic_shared_ptr<InterfaceTable> interfaceCache_;
+  std::mutex interfaceCacheMutex_;
+
+  /**
+   * State of chunked sync of a client, see syncFibChunk
+   */
+  struct ChunkedSync {
+    int64_t syncId{0};
+    size_t numChunks{0};
+    std::unordered_set<int32_t> programmedChunks;
+    std::unordered_set<folly::CIDRNetwork> prefixes;
+  };
+
+  // Chunked sync in progress per client id. Accessed in evl_ only
+  std::unordered_map<int16_t, ChunkedSync> chunkedSyncs_;
 
   // Loopback interface index cache. Initialized to negative number
   std::atomic<int> loopbackIfIndex_{-1};
@@ -31,44 +31,134 @@ const std::chrono::seconds kNetlinkDbResyncInterval{20};
 
 namespace openr {
 
+namespace {
+
+// Fail on errors of address add/remove requests, other than address already
+// being there or already being gone
+void
+checkIfAddressRetvals(std::vector<folly::Try<int>> const& retvals) {
+  for (auto& retval : retvals) {
+    const int ret = std::abs(retval.value());
+    if (ret != 0 && ret != EEXIST && ret != EADDRNOTAVAIL) {
+      throw fbnl::NlException("Address add/remove failed.", ret);
+    }
+  }
+}
+
+} // namespace
+
 NetlinkSystemHandler::NetlinkSystemHandler(fbnl::NetlinkProtocolSocket* nlSock)
     : nlSock_(nlSock) {
   CHECK(nlSock);
+
+  // Listen before first dump, so that no change is missed after it
+  nlListenerId_ = nlSock_->addLinkAddrListener(
+      {[this](const fbnl::Link& link, bool isRemoved) {
+         updateCachedLink(link, isRemoved);
+       },
+       [this](const fbnl::IfAddress& addr) {
+         updateCachedAddr(addr, addr.isValid());
+       }});
 }
 
-folly::SemiFuture<std::unique_ptr<std::vector<thrift::Link>>>
-NetlinkSystemHandler::semifuture_getAllLinks() {
-  VLOG(3) << "Query links from Netlink according to link name";
+NetlinkSystemHandler::~NetlinkSystemHandler() {
+  nlSock_->removeLinkAddrListener(nlListenerId_);
+}
+
+folly::SemiFuture<folly::Unit>
+NetlinkSystemHandler::maybeResyncCache() {
+  {
+    auto cache = cache_.rlock();
+    if (cache->resyncTime.has_value() and
+        std::chrono::steady_clock::now() - *cache->resyncTime <
+            kNetlinkDbResyncInterval) {
+      return folly::makeSemiFuture();
+    }
+  }
 
+  VLOG(2) << "Resync links and addresses from Netlink";
   return collectAll(nlSock_->getAllLinks(), nlSock_->getAllIfAddresses())
-      .deferValue([](std::tuple<
-                      folly::Try<std::vector<fbnl::Link>>,
-                      folly::Try<std::vector<fbnl::IfAddress>>>&& res) {
-        std::unordered_map<int, thrift::Link> links;
-        // Create links
+      .deferValue([this](std::tuple<
+                          folly::Try<std::vector<fbnl::Link>>,
+                          folly::Try<std::vector<fbnl::IfAddress>>>&& res) {
+        std::unordered_map<int, CachedLink> links;
         for (auto& nlLink : std::get<0>(res).value()) {
-          thrift::Link link;
+          auto& link = links[nlLink.getIfIndex()];
           link.ifName = nlLink.getLinkName();
-          link.ifIndex = nlLink.getIfIndex();
           link.isUp = nlLink.isUp();
-          links.emplace(nlLink.getIfIndex(), std::move(link));
         }
-
-        // Add addresses
         for (auto& nlAddr : std::get<1>(res).value()) {
-          auto& link = links.at(nlAddr.getIfIndex());
-          link.networks.emplace_back(toIpPrefix(nlAddr.getPrefix().value()));
+          auto it = links.find(nlAddr.getIfIndex());
+          if (it == links.end()) {
+            // link came up after dump of links
+            continue;
+          }
+          auto prefix = nlAddr.getPrefix().value();
+          it->second.addrs.emplace(std::move(prefix), std::move(nlAddr));
         }
 
-        // Convert to list and return
-        auto result = std::make_unique<std::vector<thrift::Link>>();
-        for (auto& kv : links) {
-          result->emplace_back(std::move(kv.second));
-        }
-        return result;
+        auto cache = cache_.wlock();
+        cache->links = std::move(links);
+        cache->resyncTime = std::chrono::steady_clock::now();
+        return folly::Unit();
       });
 }
 
+void
+NetlinkSystemHandler::updateCachedLink(const fbnl::Link& link, bool isRemoved) {
+  auto cache = cache_.wlock();
+  if (isRemoved) {
+    cache->links.erase(link.getIfIndex());
+    return;
+  }
+  auto& cachedLink = cache->links[link.getIfIndex()];
+  cachedLink.ifName = link.getLinkName();
+  cachedLink.isUp = link.isUp();
+}
+
+void
+NetlinkSystemHandler::updateCachedAddr(
+    const fbnl::IfAddress& addr, bool isValid) {
+  if (not addr.getPrefix().has_value()) {
+    return;
+  }
+  auto cache = cache_.wlock();
+  if (isValid) {
+    cache->links[addr.getIfIndex()].addrs.insert_or_assign(
+        addr.getPrefix().value(), addr);
+    return;
+  }
+  auto it = cache->links.find(addr.getIfIndex());
+  if (it != cache->links.end()) {
+    it->second.addrs.erase(addr.getPrefix().value());
+  }
+}
+
+folly::SemiFuture<std::unique_ptr<std::vector<thrift::Link>>>
+NetlinkSystemHandler::semifuture_getAllLinks() {
+  VLOG(3) << "Query links from Netlink according to link name";
+
+  return maybeResyncCache().deferValue([this](folly::Unit) {
+    auto result = std::make_unique<std::vector<thrift::Link>>();
+    auto cache = cache_.rlock();
+    for (auto const& kv : cache->links) {
+      // skip addresses notified ahead of their link
+      if (kv.second.ifName.empty()) {
+        continue;
+      }
+      thrift::Link link;
+      link.ifName = kv.second.ifName;
+      link.ifIndex = kv.first;
+      link.isUp = kv.second.isUp;
+      for (auto const& addr : kv.second.addrs) {
+        link.networks.emplace_back(toIpPrefix(addr.first));
+      }
+      result->emplace_back(std::move(link));
+    }
+    return result;
+  });
+}
+
 folly::SemiFuture<folly::Unit>
 NetlinkSystemHandler::semifuture_addIfaceAddresses(
     std::unique_ptr<std::string> ifName,
@@ -95,6 +185,7 @@ NetlinkSystemHandler::addRemoveIfAddresses(
 
   // Add netlink requests
   std::vector<folly::SemiFuture<int>> futures;
+  std::vector<std::pair<fbnl::IfAddress, bool /* isValid */>> nlAddrs;
   for (const auto& addr : addrs) {
     fbnl::IfAddressBuilder builder;
     auto const network = toIPNetwork(addr, false /* applyMask */);
@@ -107,21 +198,22 @@ NetlinkSystemHandler::addRemoveIfAddresses(
     } else {
       builder.setScope(RT_SCOPE_UNIVERSE);
     }
+    nlAddrs.emplace_back(builder.build(), isAdd);
     if (isAdd) {
-      futures.emplace_back(nlSock_->addIfAddress(builder.build()));
+      futures.emplace_back(nlSock_->addIfAddress(nlAddrs.back().first));
     } else {
-      futures.emplace_back(nlSock_->deleteIfAddress(builder.build()));
+      futures.emplace_back(nlSock_->deleteIfAddress(nlAddrs.back().first));
     }
   }
 
   // Accumulate futures into a single one
   return collectAll(std::move(futures))
-      .deferValue([](std::vector<folly::Try<int>>&& retvals) {
-        for (auto& retval : retvals) {
-          const int ret = std::abs(retval.value());
-          if (ret != 0 && ret != EEXIST && ret != EADDRNOTAVAIL) {
-            throw fbnl::NlException("Address add/remove failed.", ret);
-          }
+      .deferValue([this, nlAddrs = std::move(nlAddrs)](
+                      std::vector<folly::Try<int>>&& retvals) {
+        checkIfAddressRetvals(retvals);
+        // Reflect changes right away, ahead of their notifications
+        for (auto const& nlAddr : nlAddrs) {
+          updateCachedAddr(nlAddr.first, nlAddr.second);
         }
         return folly::Unit();
       });
@@ -135,13 +227,16 @@ NetlinkSystemHandler::semifuture_getIfaceAddresses(
   // Get iface index
   const int ifIndex = getIfIndex(*ifName).value();
 
-  return nlSock_->getAllIfAddresses().deferValue(
-      [ifIndex, family, scope](std::vector<fbnl::IfAddress>&& nlAddrs) {
+  return maybeResyncCache().deferValue(
+      [this, ifIndex, family, scope](folly::Unit) {
         auto addrs = std::make_unique<std::vector<thrift::IpPrefix>>();
-        for (auto& nlAddr : nlAddrs) {
-          if (nlAddr.getIfIndex() != ifIndex) {
-            continue;
-          }
+        auto cache = cache_.rlock();
+        auto it = cache->links.find(ifIndex);
+        if (it == cache->links.end()) {
+          return addrs;
+        }
+        for (auto const& kv : it->second.addrs) {
+          auto const& nlAddr = kv.second;
           // Apply filter on family if specified
           if (family && nlAddr.getFamily() != family) {
             continue;
@@ -150,7 +245,7 @@ NetlinkSystemHandler::semifuture_getIfaceAddresses(
           if (nlAddr.getScope() != scope) {
             continue;
           }
-          addrs->emplace_back(toIpPrefix(nlAddr.getPrefix().value()));
+          addrs->emplace_back(toIpPrefix(kv.first));
         }
         return addrs;
       });
@@ -170,6 +265,7 @@ NetlinkSystemHandler::semifuture_syncIfaceAddresses(
   auto oldAddrs =
       semifuture_getIfaceAddresses(std::move(iface), family, scope).get();
   std::vector<folly::SemiFuture<int>> futures;
+  std::vector<std::pair<fbnl::IfAddress, bool /* isValid */>> nlAddrs;
 
   // Add new addresses
   for (auto& newAddr : *newAddrs) {
@@ -183,7 +279,8 @@ NetlinkSystemHandler::semifuture_syncIfaceAddresses(
     builder.setPrefix(toIPNetwork(newAddr, false /* applyMask */));
     builder.setIfIndex(ifIndex);
     builder.setScope(scope);
-    futures.emplace_back(nlSock_->addIfAddress(builder.build()));
+    nlAddrs.emplace_back(builder.build(), true);
+    futures.emplace_back(nlSock_->addIfAddress(nlAddrs.back().first));
   }
 
   // Delete old addresses
@@ -198,17 +295,18 @@ NetlinkSystemHandler::semifuture_syncIfaceAddresses(
     builder.setPrefix(toIPNetwork(oldAddr, false /* applyMask */));
     builder.setIfIndex(ifIndex);
     builder.setScope(scope);
-    futures.emplace_back(nlSock_->deleteIfAddress(builder.build()));
+    nlAddrs.emplace_back(builder.build(), false);
+    futures.emplace_back(nlSock_->deleteIfAddress(nlAddrs.back().first));
   }
 
   // Collect all futures
   return collectAll(std::move(futures))
-      .deferValue([](std::vector<folly::Try<int>>&& retvals) {
-        for (auto& retval : retvals) {
-          const int ret = std::abs(retval.value());
-          if (ret != 0 && ret != EEXIST && ret != EADDRNOTAVAIL) {
-            throw fbnl::NlException("Address add/remove failed.", ret);
-          }
+      .deferValue([this, nlAddrs = std::move(nlAddrs)](
+                      std::vector<folly::Try<int>>&& retvals) {
+        checkIfAddressRetvals(retvals);
+        // Reflect changes right away, ahead of their notifications
+        for (auto const& nlAddr : nlAddrs) {
+          updateCachedAddr(nlAddr.first, nlAddr.second);
         }
         return folly::Unit();
       });
@@ -216,10 +314,11 @@ NetlinkSystemHandler::semifuture_syncIfaceAddresses(
 
 std::optional<int>
 NetlinkSystemHandler::getIfIndex(const std::string& ifName) {
-  auto links = nlSock_->getAllLinks().get();
-  for (auto& link : links) {
-    if (link.getLinkName() == ifName) {
-      return link.getIfIndex();
+  maybeResyncCache().get();
+  auto cache = cache_.rlock();
+  for (auto const& kv : cache->links) {
+    if (kv.second.ifName == ifName) {
+      return kv.first;
     }
   }
   return std::nullopt;
@@ -12,11 +12,13 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 
 #include <fbzmq/async/ZmqEventLoop.h>
 #include <fbzmq/async/ZmqTimeout.h>
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/Synchronized.h>
 #include <folly/futures/Future.h>
 #include <folly/io/async/AsyncSocket.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
@@ -32,12 +34,19 @@ namespace openr {
  * NetlinkEvent Publisher as well as System Service on linux platform.
  * We implement the futures API to allow for easy async activity within
  * the handlers
+ *
+ * Links and addresses are served from a mirror of kernel state kept up to
+ * date by netlink notifications, instead of dumping them from kernel on every
+ * query. Mirror is resynced by dumps lazily, at most every resync interval, to
+ * recover notifications lost on socket overflow.
  */
 
 class NetlinkSystemHandler final : public thrift::SystemServiceSvIf {
  public:
   explicit NetlinkSystemHandler(fbnl::NetlinkProtocolSocket* nlSock);
 
+  ~NetlinkSystemHandler() override;
+
   NetlinkSystemHandler(const NetlinkSystemHandler&) = delete;
   NetlinkSystemHandler& operator=(const NetlinkSystemHandler&) = delete;
 
@@ -74,13 +83,35 @@ class NetlinkSystemHandler final : public thrift::SystemServiceSvIf {
       const std::vector<thrift::IpPrefix>& addrs);
 
   /**
-   * Synchronous API to query interface index from kernel.
-   * NOTE: We intentionally don't use cache to optimize this call as APIs of
-   * this handlers for add/remove/sync addresses are rarely invoked.
+   * Synchronous API to query interface index from mirror of links.
    */
   std::optional<int> getIfIndex(const std::string& ifName);
 
+  /**
+   * Resync mirror with dump of links and addresses from kernel if it is older
+   * than resync interval. Ready right away otherwise.
+   */
+  folly::SemiFuture<folly::Unit> maybeResyncCache();
+
+  // Apply link or address notification on mirror
+  void updateCachedLink(const fbnl::Link& link, bool isRemoved);
+  void updateCachedAddr(const fbnl::IfAddress& addr, bool isValid);
+
   fbnl::NetlinkProtocolSocket* nlSock_{nullptr};
+  uint64_t nlListenerId_{0};
+
+  struct CachedLink {
+    std::string ifName;
+    bool isUp{false};
+    std::unordered_map<folly::CIDRNetwork, fbnl::IfAddress> addrs;
+  };
+
+  // Mirror of kernel links by their ifIndex
+  struct Cache {
+    std::unordered_map<int, CachedLink> links;
+    std::optional<std::chrono::steady_clock::time_point> resyncTime;
+  };
+  folly::Synchronized<Cache> cache_;
 };
 
 } // namespace openr
@@ -0,0 +1,234 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "PlatformClients.h"
+
+#include <glog/logging.h>
+
+namespace openr {
+
+//
+// FibServiceClient. Handler is called through future_ flavor of its methods,
+// as implemented by NetlinkFibHandler, since default ones hop through thrift
+// thread manager which is only there for calls over thrift.
+//
+
+FibServiceClient::FibServiceClient(
+    std::shared_ptr<thrift::FibServiceSvIf> handler)
+    : handler_(std::move(handler)) {
+  CHECK(handler_);
+}
+
+FibServiceClient::FibServiceClient(
+    std::unique_ptr<thrift::FibServiceAsyncClient> client)
+    : client_(std::move(client)) {
+  CHECK(client_);
+}
+
+folly::SemiFuture<folly::Unit>
+FibServiceClient::addUnicastRoutes(
+    int16_t clientId, std::vector<thrift::UnicastRoute> routes) {
+  if (handler_) {
+    return handler_->future_addUnicastRoutes(
+        clientId,
+        std::make_unique<std::vector<thrift::UnicastRoute>>(std::move(routes)));
+  }
+  return client_->semifuture_addUnicastRoutes(clientId, routes);
+}
+
+folly::SemiFuture<folly::Unit>
+FibServiceClient::deleteUnicastRoutes(
+    int16_t clientId, std::vector<thrift::IpPrefix> prefixes) {
+  if (handler_) {
+    return handler_->future_deleteUnicastRoutes(
+        clientId,
+        std::make_unique<std::vector<thrift::IpPrefix>>(std::move(prefixes)));
+  }
+  return client_->semifuture_deleteUnicastRoutes(clientId, prefixes);
+}
+
+folly::SemiFuture<folly::Unit>
+FibServiceClient::addMplsRoutes(
+    int16_t clientId, std::vector<thrift::MplsRoute> routes) {
+  if (handler_) {
+    return handler_->future_addMplsRoutes(
+        clientId,
+        std::make_unique<std::vector<thrift::MplsRoute>>(std::move(routes)));
+  }
+  return client_->semifuture_addMplsRoutes(clientId, routes);
+}
+
+folly::SemiFuture<folly::Unit>
+FibServiceClient::deleteMplsRoutes(
+    int16_t clientId, std::vector<int32_t> topLabels) {
+  if (handler_) {
+    return handler_->future_deleteMplsRoutes(
+        clientId, std::make_unique<std::vector<int32_t>>(std::move(topLabels)));
+  }
+  return client_->semifuture_deleteMplsRoutes(clientId, topLabels);
+}
+
+folly::SemiFuture<folly::Unit>
+FibServiceClient::syncFibChunk(
+    int16_t clientId, thrift::UnicastRouteSyncChunk chunk) {
+  if (handler_) {
+    return handler_->future_syncFibChunk(
+        clientId,
+        std::make_unique<thrift::UnicastRouteSyncChunk>(std::move(chunk)));
+  }
+  return client_->semifuture_syncFibChunk(clientId, chunk);
+}
+
+void
+FibServiceClient::syncFib(
+    int16_t clientId, std::vector<thrift::UnicastRoute> routes) {
+  if (handler_) {
+    handler_
+        ->future_syncFib(
+            clientId,
+            std::make_unique<std::vector<thrift::UnicastRoute>>(
+                std::move(routes)))
+        .get();
+    return;
+  }
+  client_->sync_syncFib(clientId, routes);
+}
+
+void
+FibServiceClient::syncMplsFib(
+    int16_t clientId, std::vector<thrift::MplsRoute> routes) {
+  if (handler_) {
+    handler_
+        ->future_syncMplsFib(
+            clientId,
+            std::make_unique<std::vector<thrift::MplsRoute>>(std::move(routes)))
+        .get();
+    return;
+  }
+  client_->sync_syncMplsFib(clientId, routes);
+}
+
+std::vector<thrift::UnicastRoute>
+FibServiceClient::getRouteTableByClient(int16_t clientId) {
+  if (handler_) {
+    return std::move(*handler_->future_getRouteTableByClient(clientId).get());
+  }
+  std::vector<thrift::UnicastRoute> routes;
+  client_->sync_getRouteTableByClient(routes, clientId);
+  return routes;
+}
+
+std::vector<thrift::MplsRoute>
+FibServiceClient::getMplsRouteTableByClient(int16_t clientId) {
+  if (handler_) {
+    return std::move(
+        *handler_->future_getMplsRouteTableByClient(clientId).get());
+  }
+  std::vector<thrift::MplsRoute> routes;
+  client_->sync_getMplsRouteTableByClient(routes, clientId);
+  return routes;
+}
+
+int64_t
+FibServiceClient::aliveSince() {
+  if (handler_) {
+    return handler_->aliveSince();
+  }
+  return client_->sync_aliveSince();
+}
+
+//
+// SystemServiceClient. Handler is called through semifuture_ flavor of its
+// methods, as implemented by NetlinkSystemHandler.
+//
+
+SystemServiceClient::SystemServiceClient(
+    std::shared_ptr<thrift::SystemServiceSvIf> handler)
+    : handler_(std::move(handler)) {
+  CHECK(handler_);
+}
+
+SystemServiceClient::SystemServiceClient(
+    std::unique_ptr<thrift::SystemServiceAsyncClient> client)
+    : client_(std::move(client)) {
+  CHECK(client_);
+}
+
+std::vector<thrift::Link>
+SystemServiceClient::getAllLinks() {
+  if (handler_) {
+    return std::move(*handler_->semifuture_getAllLinks().get());
+  }
+  std::vector<thrift::Link> links;
+  client_->sync_getAllLinks(links);
+  return links;
+}
+
+std::vector<thrift::IpPrefix>
+SystemServiceClient::getIfaceAddresses(
+    const std::string& ifName, int16_t family, int16_t scope) {
+  if (handler_) {
+    return std::move(*handler_
+                          ->semifuture_getIfaceAddresses(
+                              std::make_unique<std::string>(ifName),
+                              family,
+                              scope)
+                          .get());
+  }
+  std::vector<thrift::IpPrefix> addrs;
+  client_->sync_getIfaceAddresses(addrs, ifName, family, scope);
+  return addrs;
+}
+
+void
+SystemServiceClient::addIfaceAddresses(
+    const std::string& ifName, std::vector<thrift::IpPrefix> addrs) {
+  if (handler_) {
+    handler_
+        ->semifuture_addIfaceAddresses(
+            std::make_unique<std::string>(ifName),
+            std::make_unique<std::vector<thrift::IpPrefix>>(std::move(addrs)))
+        .get();
+    return;
+  }
+  client_->sync_addIfaceAddresses(ifName, addrs);
+}
+
+void
+SystemServiceClient::removeIfaceAddresses(
+    const std::string& ifName, std::vector<thrift::IpPrefix> addrs) {
+  if (handler_) {
+    handler_
+        ->semifuture_removeIfaceAddresses(
+            std::make_unique<std::string>(ifName),
+            std::make_unique<std::vector<thrift::IpPrefix>>(std::move(addrs)))
+        .get();
+    return;
+  }
+  client_->sync_removeIfaceAddresses(ifName, addrs);
+}
+
+void
+SystemServiceClient::syncIfaceAddresses(
+    const std::string& ifName,
+    int16_t family,
+    int16_t scope,
+    std::vector<thrift::IpPrefix> addrs) {
+  if (handler_) {
+    handler_
+        ->semifuture_syncIfaceAddresses(
+            std::make_unique<std::string>(ifName),
+            family,
+            scope,
+            std::make_unique<std::vector<thrift::IpPrefix>>(std::move(addrs)))
+        .get();
+    return;
+  }
+  client_->sync_syncIfaceAddresses(ifName, family, scope, addrs);
+}
+
+} // namespace openr
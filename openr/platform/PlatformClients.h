@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <folly/futures/Future.h>
+
+#include <openr/if/gen-cpp2/FibService.h>
+#include <openr/if/gen-cpp2/SystemService.h>
+
+namespace openr {
+
+/**
+ * Clients of platform services used by Open/R modules. When handler of service
+ * runs in the same process it is called directly, with arguments moved to it,
+ * skipping serialization and loopback socket of thrift. Thrift client is used
+ * otherwise.
+ *
+ * Synchronous calls of thrift client loop its event base till they complete.
+ * Asynchronous calls must be waited for via event base of thrift client, e.g.
+ * with getTryVia(), as nothing else loops it.
+ */
+class FibServiceClient {
+ public:
+  explicit FibServiceClient(std::shared_ptr<thrift::FibServiceSvIf> handler);
+  explicit FibServiceClient(
+      std::unique_ptr<thrift::FibServiceAsyncClient> client);
+
+  bool
+  isInProcess() const {
+    return handler_ != nullptr;
+  }
+
+  folly::SemiFuture<folly::Unit> addUnicastRoutes(
+      int16_t clientId, std::vector<thrift::UnicastRoute> routes);
+  folly::SemiFuture<folly::Unit> deleteUnicastRoutes(
+      int16_t clientId, std::vector<thrift::IpPrefix> prefixes);
+  folly::SemiFuture<folly::Unit> addMplsRoutes(
+      int16_t clientId, std::vector<thrift::MplsRoute> routes);
+  folly::SemiFuture<folly::Unit> deleteMplsRoutes(
+      int16_t clientId, std::vector<int32_t> topLabels);
+  folly::SemiFuture<folly::Unit> syncFibChunk(
+      int16_t clientId, thrift::UnicastRouteSyncChunk chunk);
+
+  void syncFib(int16_t clientId, std::vector<thrift::UnicastRoute> routes);
+  void syncMplsFib(int16_t clientId, std::vector<thrift::MplsRoute> routes);
+  std::vector<thrift::UnicastRoute> getRouteTableByClient(int16_t clientId);
+  std::vector<thrift::MplsRoute> getMplsRouteTableByClient(int16_t clientId);
+  int64_t aliveSince();
+
+ private:
+  std::shared_ptr<thrift::FibServiceSvIf> handler_;
+  std::unique_ptr<thrift::FibServiceAsyncClient> client_;
+};
+
+class SystemServiceClient {
+ public:
+  explicit SystemServiceClient(
+      std::shared_ptr<thrift::SystemServiceSvIf> handler);
+  explicit SystemServiceClient(
+      std::unique_ptr<thrift::SystemServiceAsyncClient> client);
+
+  bool
+  isInProcess() const {
+    return handler_ != nullptr;
+  }
+
+  std::vector<thrift::Link> getAllLinks();
+  std::vector<thrift::IpPrefix> getIfaceAddresses(
+      const std::string& ifName, int16_t family, int16_t scope);
+  void addIfaceAddresses(
+      const std::string& ifName, std::vector<thrift::IpPrefix> addrs);
+  void removeIfaceAddresses(
+      const std::string& ifName, std::vector<thrift::IpPrefix> addrs);
+  void syncIfaceAddresses(
+      const std::string& ifName,
+      int16_t family,
+      int16_t scope,
+      std::vector<thrift::IpPrefix> addrs);
+
+ private:
+  std::shared_ptr<thrift::SystemServiceSvIf> handler_;
+  std::unique_ptr<thrift::SystemServiceAsyncClient> client_;
+};
+
+} // namespace openr
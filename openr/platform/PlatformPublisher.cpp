@@ -18,6 +18,7 @@
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include <openr/common/NetworkUtil.h>
+#include <openr/common/Util.h>
 #include <openr/if/gen-cpp2/Network_types.h>
 
 using apache::thrift::FRAGILE;
@@ -25,8 +26,12 @@ using apache::thrift::FRAGILE;
 namespace openr {
 
 PlatformPublisher::PlatformPublisher(
-    fbzmq::Context& context, const PlatformPublisherUrl& platformPubUrl)
-    : platformPubUrl_(platformPubUrl) {
+    fbzmq::Context& context,
+    const PlatformPublisherUrl& platformPubUrl,
+    fbzmq::ZmqEventLoop* evl)
+    : platformPubUrl_(platformPubUrl),
+      evl_(evl),
+      publisherId_(getUnixTimeStampMs()) {
   // Initialize ZMQ sockets
   platformPubSock_ = fbzmq::Socket<ZMQ_PUB, fbzmq::ZMQ_SERVER>(
       context, folly::none, folly::none, fbzmq::NonblockingFlag{true});
@@ -72,17 +77,44 @@ PlatformPublisher::publishNeighborEvent(const thrift::NeighborEntry& neighbor) {
 void
 PlatformPublisher::publishPlatformEvent(const thrift::PlatformEvent& msg) {
   VLOG(3) << "Publishing PlatformEvent...";
-  thrift::PlatformEventType eventType = msg.eventType;
+  pendingEvents_.emplace_back(msg);
+  if (not evl_ or
+      pendingEvents_.size() >= Constants::kPlatformEventBatchMaxSize) {
+    flushPlatformEvents();
+    return;
+  }
+  if (not isFlushScheduled_) {
+    isFlushScheduled_ = true;
+    evl_->runInEventLoop([this]() noexcept {
+      isFlushScheduled_ = false;
+      flushPlatformEvents();
+    });
+  }
+}
+
+void
+PlatformPublisher::flushPlatformEvents() {
+  if (pendingEvents_.empty()) {
+    return;
+  }
+  thrift::PlatformEventBatch batch;
+  batch.publisherId = publisherId_;
+  batch.seqNum = ++seqNum_;
+  batch.events = std::move(pendingEvents_);
+  pendingEvents_.clear();
+  VLOG(3) << "Publishing batch " << batch.seqNum << " of "
+          << batch.events.size() << " PlatformEvents";
+
   // send header of event in the first 2 byte
   platformPubSock_.sendMore(
-      fbzmq::Message::from(static_cast<uint16_t>(eventType)).value());
-  const auto sendNeighEntry = platformPubSock_.sendThriftObj(msg, serializer_);
-  if (sendNeighEntry.hasError()) {
-    LOG(ERROR) << "Error in sending PlatformEventType Entry, event Type: "
-               << folly::get_default(
-                      thrift::_PlatformEventType_VALUES_TO_NAMES,
-                      msg.eventType,
-                      "UNKNOWN");
+      fbzmq::Message::from(
+          static_cast<uint16_t>(thrift::PlatformEventType::EVENT_BATCH))
+          .value());
+  const auto ret = platformPubSock_.sendThriftObj(batch, serializer_);
+  if (ret.hasError()) {
+    // Subscribers find out about lost batch from its sequence number
+    LOG(ERROR) << "Error in sending batch " << batch.seqNum << " of "
+               << batch.events.size() << " PlatformEvents: " << ret.error();
   }
 }
 
@@ -13,7 +13,9 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include <fbzmq/async/ZmqEventLoop.h>
 #include <fbzmq/zmq/Zmq.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
@@ -29,6 +31,12 @@ namespace openr {
  * message passing mechanism. Event will be sent over Zmq PUB socket which
  * OpenR modules can subscribe through SUB socket. The subscriber modules is
  * LinkMonitor from Open/R side.
+ *
+ * Events are published in sequence numbered PlatformEventBatch messages under
+ * EVENT_BATCH header, serialized once for all subscribers. If event loop is
+ * given, events published within one of its iterations, e.g. burst read off
+ * netlink socket, go out in one batch, and publish methods must be called
+ * from its thread. Each event is a batch of its own otherwise.
  */
 class PlatformPublisher final : public fbnl::NetlinkSocket::EventsHandler {
  public:
@@ -37,7 +45,8 @@ class PlatformPublisher final : public fbnl::NetlinkSocket::EventsHandler {
       // Immutable state initializers
       //
       fbzmq::Context& context,
-      const PlatformPublisherUrl& platformPubUrl);
+      const PlatformPublisherUrl& platformPubUrl,
+      fbzmq::ZmqEventLoop* evl = nullptr);
 
   ~PlatformPublisher() = default;
 
@@ -69,6 +78,9 @@ class PlatformPublisher final : public fbnl::NetlinkSocket::EventsHandler {
       const std::string& ifName,
       const openr::fbnl::Neighbor& neighborEntry) noexcept override;
 
+  // Publish pending events in one batch
+  void flushPlatformEvents();
+
   // Publish link events to, e.g., LinkMonitor and Squire
   const std::string platformPubUrl_;
 
@@ -77,6 +89,18 @@ class PlatformPublisher final : public fbnl::NetlinkSocket::EventsHandler {
 
   // used for communicating over thrift/zmq sockets
   apache::thrift::CompactSerializer serializer_;
+
+  // Event loop deferring publication of events to batch them, if any
+  fbzmq::ZmqEventLoop* evl_{nullptr};
+
+  // Identifies batches of this publisher across restarts, along with last
+  // sequence number used
+  const int64_t publisherId_{0};
+  int64_t seqNum_{0};
+
+  // Events waiting for next batch, and whether it is scheduled
+  std::vector<thrift::PlatformEvent> pendingEvents_;
+  bool isFlushScheduled_{false};
 };
 
 } // namespace openr
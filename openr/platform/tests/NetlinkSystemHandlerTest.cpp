@@ -11,6 +11,7 @@
 
 #include <openr/nl/tests/FakeNetlinkProtocolSocket.h>
 #include <openr/platform/NetlinkSystemHandler.h>
+#include <openr/platform/PlatformClients.h>
 
 using namespace ::testing;
 using namespace openr;
@@ -51,6 +52,20 @@ createLink(
   return builder.build();
 }
 
+// Fake netlink socket counting dumps of links
+class CountingNetlinkProtocolSocket : public fbnl::FakeNetlinkProtocolSocket {
+ public:
+  using fbnl::FakeNetlinkProtocolSocket::FakeNetlinkProtocolSocket;
+
+  folly::SemiFuture<std::vector<fbnl::Link>>
+  getAllLinks() override {
+    ++numLinkDumps;
+    return fbnl::FakeNetlinkProtocolSocket::getAllLinks();
+  }
+
+  size_t numLinkDumps{0};
+};
+
 } // namespace
 
 TEST(SystemHandler, getAllLinks) {
@@ -165,3 +180,75 @@ TEST(SystemHandler, syncIfaceAddresses) {
     EXPECT_EQ(ifAddr1, addrs.at(3));
   }
 }
+
+TEST(SystemHandler, cachedLinksAndAddresses) {
+  fbzmq::ZmqEventLoop evl;
+  CountingNetlinkProtocolSocket nlSock(&evl);
+  NetlinkSystemHandler handler(&nlSock);
+  const auto ifAddr = createIfAddress(1, "192.168.0.3/31");
+
+  EXPECT_EQ(0, nlSock.addLink(createLink(1, "eth0")).get());
+  auto links = handler.semifuture_getAllLinks().get();
+  ASSERT_EQ(1, links->size());
+  EXPECT_EQ(0, links->at(0).networks.size());
+
+  // Address notifications are reflected without dumps from kernel
+  EXPECT_EQ(0, nlSock.addIfAddress(ifAddr).get());
+  links = handler.semifuture_getAllLinks().get();
+  ASSERT_EQ(1, links->size());
+  ASSERT_EQ(1, links->at(0).networks.size());
+  EXPECT_EQ("192.168.0.3/31", toString(links->at(0).networks.at(0)));
+  {
+    auto addrs = handler
+                     .semifuture_getIfaceAddresses(
+                         std::make_unique<std::string>("eth0"),
+                         AF_INET,
+                         RT_SCOPE_UNIVERSE)
+                     .get();
+    ASSERT_EQ(1, addrs->size());
+    EXPECT_EQ(toIpPrefix(ifAddr.getPrefix().value()), addrs->at(0));
+  }
+
+  EXPECT_EQ(0, nlSock.deleteIfAddress(ifAddr).get());
+  {
+    auto addrs = handler
+                     .semifuture_getIfaceAddresses(
+                         std::make_unique<std::string>("eth0"),
+                         AF_INET,
+                         RT_SCOPE_UNIVERSE)
+                     .get();
+    EXPECT_EQ(0, addrs->size());
+  }
+
+  // Only initial sync dumped links
+  EXPECT_EQ(1, nlSock.numLinkDumps);
+}
+
+TEST(SystemHandler, inProcessClient) {
+  fbzmq::ZmqEventLoop evl;
+  fbnl::FakeNetlinkProtocolSocket nlSock(&evl);
+  auto handler = std::make_shared<NetlinkSystemHandler>(&nlSock);
+  SystemServiceClient client(handler);
+  EXPECT_TRUE(client.isInProcess());
+  const auto ifAddr = createIfAddress(1, "192.168.0.3/31");
+  const auto ifPrefix = toIpPrefix(ifAddr.getPrefix().value());
+
+  EXPECT_EQ(0, nlSock.addLink(createLink(1, "eth0")).get());
+  EXPECT_NO_THROW(client.addIfaceAddresses("eth0", {ifPrefix}));
+  auto links = client.getAllLinks();
+  ASSERT_EQ(1, links.size());
+  EXPECT_EQ("eth0", links.at(0).ifName);
+  ASSERT_EQ(1, links.at(0).networks.size());
+  EXPECT_EQ(ifPrefix, links.at(0).networks.at(0));
+
+  auto addrs = client.getIfaceAddresses("eth0", AF_INET, RT_SCOPE_UNIVERSE);
+  ASSERT_EQ(1, addrs.size());
+  EXPECT_EQ(ifPrefix, addrs.at(0));
+
+  EXPECT_NO_THROW(client.syncIfaceAddresses(
+      "eth0", AF_INET, RT_SCOPE_UNIVERSE, std::vector<thrift::IpPrefix>{}));
+  EXPECT_EQ(0, nlSock.getAllIfAddresses().get().size());
+
+  // Errors of handler surface to caller
+  EXPECT_THROW(client.addIfaceAddresses("eth1", {ifPrefix}), std::exception);
+}
@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <thread>
+
+#include <fbzmq/async/ZmqEventLoop.h>
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <openr/common/NetworkUtil.h>
+#include <openr/platform/PlatformPublisher.h>
+
+namespace openr {
+
+namespace {
+
+const PlatformPublisherUrl kPlatformPubUrl{"inproc://platform-pub-test"};
+
+thrift::LinkEntry
+createLinkEntry(const std::string& ifName, bool isUp) {
+  return thrift::LinkEntry(
+      apache::thrift::FRAGILE, ifName, 1, isUp, Constants::kDefaultAdjWeight);
+}
+
+thrift::AddrEntry
+createAddrEntry(const std::string& ifName, const std::string& prefix) {
+  return thrift::AddrEntry(
+      apache::thrift::FRAGILE, ifName, toIpPrefix(prefix), true /* isValid */);
+}
+
+class PlatformPublisherFixture : public ::testing::Test {
+ public:
+  void
+  SetUp() override {
+    const uint16_t batchEventType =
+        static_cast<uint16_t>(thrift::PlatformEventType::EVENT_BATCH);
+    sub_.setSockOpt(ZMQ_SUBSCRIBE, &batchEventType, sizeof(uint16_t)).value();
+  }
+
+  // Subscribe once publisher is bound, and give subscription time to reach it
+  void
+  connect() {
+    sub_.connect(fbzmq::SocketUrl{kPlatformPubUrl}).value();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  thrift::PlatformEventBatch
+  recvBatch() {
+    fbzmq::Message header, data;
+    sub_.recvMultiple(header, data).value();
+    EXPECT_EQ(
+        static_cast<uint16_t>(thrift::PlatformEventType::EVENT_BATCH),
+        header.read<uint16_t>().value());
+    return data.readThriftObj<thrift::PlatformEventBatch>(serializer_)
+        .value();
+  }
+
+  fbzmq::Context context_;
+  fbzmq::Socket<ZMQ_SUB, fbzmq::ZMQ_CLIENT> sub_{context_};
+  apache::thrift::CompactSerializer serializer_;
+};
+
+} // namespace
+
+TEST_F(PlatformPublisherFixture, EventPerBatchWithoutEventLoop) {
+  PlatformPublisher publisher(context_, kPlatformPubUrl);
+  connect();
+
+  publisher.publishLinkEvent(createLinkEntry("eth0", true));
+  publisher.publishAddrEvent(createAddrEntry("eth0", "10.0.0.1/31"));
+
+  const auto batch1 = recvBatch();
+  EXPECT_EQ(1, batch1.seqNum);
+  ASSERT_EQ(1, batch1.events.size());
+  EXPECT_EQ(thrift::PlatformEventType::LINK_EVENT, batch1.events[0].eventType);
+
+  const auto batch2 = recvBatch();
+  EXPECT_EQ(batch1.publisherId, batch2.publisherId);
+  EXPECT_EQ(2, batch2.seqNum);
+  ASSERT_EQ(1, batch2.events.size());
+  EXPECT_EQ(
+      thrift::PlatformEventType::ADDRESS_EVENT, batch2.events[0].eventType);
+}
+
+TEST_F(PlatformPublisherFixture, BatchPerEventLoopIteration) {
+  fbzmq::ZmqEventLoop evl;
+  PlatformPublisher publisher(context_, kPlatformPubUrl, &evl);
+  connect();
+  std::thread evlThread([&evl]() { evl.run(); });
+  evl.waitUntilRunning();
+
+  // Burst of events goes out in one batch, in order
+  evl.runInEventLoop([&]() noexcept {
+    publisher.publishLinkEvent(createLinkEntry("eth0", false));
+    publisher.publishLinkEvent(createLinkEntry("eth0", true));
+    publisher.publishAddrEvent(createAddrEntry("eth0", "10.0.0.1/31"));
+  });
+  const auto batch1 = recvBatch();
+  EXPECT_EQ(1, batch1.seqNum);
+  ASSERT_EQ(3, batch1.events.size());
+  EXPECT_EQ(thrift::PlatformEventType::LINK_EVENT, batch1.events[0].eventType);
+  EXPECT_EQ(thrift::PlatformEventType::LINK_EVENT, batch1.events[1].eventType);
+  EXPECT_EQ(
+      thrift::PlatformEventType::ADDRESS_EVENT, batch1.events[2].eventType);
+  const auto link = fbzmq::util::readThriftObjStr<thrift::LinkEntry>(
+      batch1.events[1].eventData, serializer_);
+  EXPECT_EQ("eth0", link.ifName);
+  EXPECT_TRUE(link.isUp);
+
+  // Next burst is next batch
+  evl.runInEventLoop([&]() noexcept {
+    publisher.publishAddrEvent(createAddrEntry("eth0", "10.0.0.3/31"));
+  });
+  const auto batch2 = recvBatch();
+  EXPECT_EQ(batch1.publisherId, batch2.publisherId);
+  EXPECT_EQ(2, batch2.seqNum);
+  EXPECT_EQ(1, batch2.events.size());
+
+  // Bursts larger than max batch size are split
+  evl.runInEventLoop([&]() noexcept {
+    for (size_t i = 0; i < Constants::kPlatformEventBatchMaxSize + 1; ++i) {
+      publisher.publishLinkEvent(createLinkEntry("eth0", i % 2));
+    }
+  });
+  const auto batch3 = recvBatch();
+  EXPECT_EQ(3, batch3.seqNum);
+  EXPECT_EQ(Constants::kPlatformEventBatchMaxSize, batch3.events.size());
+  const auto batch4 = recvBatch();
+  EXPECT_EQ(4, batch4.seqNum);
+  EXPECT_EQ(1, batch4.events.size());
+
+  evl.stop();
+  evl.waitUntilStopped();
+  evlThread.join();
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::init(&argc, &argv);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  auto rc = RUN_ALL_TESTS();
+
+  return rc;
+}
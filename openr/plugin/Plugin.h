@@ -14,6 +14,7 @@
 
 #include <openr/common/Types.h>
 #include <openr/config/Config.h>
+#include <openr/decision/Decision.h>
 #include <openr/if/gen-cpp2/Fib_types.h>
 #include <openr/if/gen-cpp2/PrefixManager_types.h>
 #include <openr/messaging/Queue.h>
@@ -27,6 +28,8 @@ struct PluginArgs {
   messaging::RQueue<thrift::RouteDatabaseDelta> routeUpdatesQueue;
   std::shared_ptr<const Config> config;
   std::shared_ptr<wangle::SSLContextConfig> sslContext;
+  // to offload route computation with Decision::setRouteComputationEngine
+  Decision* decision{nullptr};
 };
 
 void pluginStart(const PluginArgs& /* pluginArgs */);
@@ -7,6 +7,10 @@
 
 #include "PrefixManager.h"
 
+#include <algorithm>
+#include <map>
+#include <tuple>
+
 #include <fb303/ServiceData.h>
 #include <folly/futures/Future.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
@@ -33,6 +37,27 @@ getPrefixTypeName(thrift::PrefixType const& type) {
   return apache::thrift::TEnumTraits<thrift::PrefixType>::findName(type);
 }
 
+// Prefixes are summarized only with others of same type and forwarding
+using SummaryKey = std::tuple<
+    thrift::PrefixType,
+    thrift::PrefixForwardingType,
+    thrift::PrefixForwardingAlgorithm>;
+
+SummaryKey
+getSummaryKey(thrift::PrefixEntry const& entry) {
+  return std::make_tuple(
+      entry.type, entry.forwardingType, entry.forwardingAlgorithm);
+}
+
+std::vector<std::pair<thrift::IpPrefix, folly::CIDRNetwork>>
+toAggregates(std::vector<thrift::IpPrefix> const& aggregatePrefixes) {
+  std::vector<std::pair<thrift::IpPrefix, folly::CIDRNetwork>> aggregates;
+  for (auto const& prefix : aggregatePrefixes) {
+    aggregates.emplace_back(prefix, toIPNetwork(prefix));
+  }
+  return aggregates;
+}
+
 } // namespace
 
 PrefixManager::PrefixManager(
@@ -45,14 +70,20 @@ PrefixManager::PrefixManager(
     bool enablePerfMeasurement,
     const std::chrono::seconds prefixHoldTime,
     const std::chrono::milliseconds ttlKeyInKvStore,
-    const std::unordered_set<std::string>& areas)
+    const std::unordered_set<std::string>& areas,
+    const std::chrono::milliseconds persistDebounce,
+    const std::chrono::milliseconds persistMaxDelay,
+    const std::vector<thrift::IpPrefix>& aggregatePrefixes)
     : nodeId_(nodeId),
       configStore_{configStore},
       kvStore_(kvStore),
+      persistDebounce_(persistDebounce),
+      persistMaxDelay_(std::max(persistMaxDelay, persistDebounce)),
       prefixDbMarker_{prefixDbMarker},
       perPrefixKeys_{perPrefixKeys},
       enablePerfMeasurement_{enablePerfMeasurement},
       ttlKeyInKvStore_(ttlKeyInKvStore),
+      aggregates_(toAggregates(aggregatePrefixes)),
       areas_{areas} {
   CHECK(configStore_);
   CHECK(kvStore_);
@@ -72,10 +103,16 @@ PrefixManager::PrefixManager(
       LOG(INFO) << "  > " << toString(entry.prefix) << ", type "
                 << getPrefixTypeName(entry.type);
       prefixMap_[entry.type][entry.prefix] = entry;
+      addPrefixType(entry.prefix, entry.type);
+      dirtyPrefixes_.emplace(entry.prefix);
       addPerfEvent(
           addingEvents_[entry.type][entry.prefix], nodeId_, "LOADED_FROM_DISK");
     }
   }
+  // Create timer for debounced persistence
+  persistPrefixDbTimer_ = fbzmq::ZmqTimeout::make(
+      getEvb(), [this]() noexcept { persistPrefixDb(); });
+
   // Create throttled update state
   outputStateThrottled_ = std::make_unique<fbzmq::ZmqThrottle>(
       getEvb(), Constants::kPrefixMgrKvThrottleTimeout, [this]() noexcept {
@@ -126,6 +163,10 @@ PrefixManager::PrefixManager(
       std::move(kvFilters),
       [this](
           const std::string& key, std::optional<thrift::Value> value) noexcept {
+        // key is advertised by us, nothing to clear
+        if (advertisedKeys_.count(key)) {
+          return;
+        }
         // we're not currently persisting this key, it may be that we no longer
         // want it advertised
         if (value.has_value() and value.value().value_ref().has_value()) {
@@ -170,10 +211,24 @@ PrefixManager::~PrefixManager() {
     LOG(INFO) << "Destroyed timers inside PrefixManager";
     initialOutputStateTimer_.reset();
     outputStateThrottled_.reset();
+    persistPrefixDbTimer_.reset();
   });
   kvStoreClient_.reset();
 }
 
+void
+PrefixManager::stop() {
+  // flush pending persistence while config store is still running
+  getEvb()->runImmediatelyOrRunInEventBaseThreadAndWait([this]() {
+    if (persistPrefixDbTimer_->isScheduled()) {
+      persistPrefixDbTimer_->cancelTimeout();
+      persistPrefixDb();
+    }
+  });
+
+  OpenrEventBase::stop();
+}
+
 void
 PrefixManager::outputState() {
   if (initialOutputStateTimer_->isScheduled()) {
@@ -182,8 +237,29 @@ PrefixManager::outputState() {
   updateKvStore();
 }
 
+void
+PrefixManager::persistPrefixDbDebounced() {
+  if (persistDebounce_.count() == 0) {
+    persistPrefixDb();
+    return;
+  }
+
+  // Postpone by debounce time on every change, but no later than max delay
+  // after the first pending change
+  const auto now = std::chrono::steady_clock::now();
+  if (not persistPendingSince_.has_value()) {
+    persistPendingSince_ = now;
+  }
+  const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+      *persistPendingSince_ + persistMaxDelay_ - now);
+  persistPrefixDbTimer_->scheduleTimeout(std::max(
+      std::chrono::milliseconds(0), std::min(persistDebounce_, remaining)));
+}
+
 void
 PrefixManager::persistPrefixDb() {
+  persistPendingSince_.reset();
+
   // prefixDb persistent entries have changed,
   // save the newest persistent entries to disk.
   thrift::PrefixDatabase persistentPrefixDb;
@@ -202,93 +278,139 @@ PrefixManager::persistPrefixDb() {
 }
 
 std::string
-PrefixManager::advertisePrefix(thrift::PrefixEntry& prefixEntry) {
+PrefixManager::getPrefixKey(const thrift::IpPrefix& prefix) const {
+  return PrefixKey(
+             nodeId_,
+             folly::IPAddress::createNetwork(toString(prefix)),
+             thrift::KvStore_constants::kDefaultArea())
+      .getPrefixKey();
+}
+
+std::pair<std::string, std::string>
+PrefixManager::getPrefixKeyValue(const thrift::PrefixEntry& prefixEntry) {
   thrift::PrefixDatabase prefixDb;
   prefixDb.thisNodeName = nodeId_;
   prefixDb.prefixEntries.emplace_back(prefixEntry);
   if (enablePerfMeasurement_) {
-    prefixDb.perfEvents_ref() =
-        addingEvents_[prefixEntry.type][prefixEntry.prefix];
+    // summaries have no events of their own
+    auto typeIt = addingEvents_.find(prefixEntry.type);
+    if (typeIt != addingEvents_.end()) {
+      auto it = typeIt->second.find(prefixEntry.prefix);
+      if (it != typeIt->second.end()) {
+        prefixDb.perfEvents_ref() = it->second;
+      }
+    }
+  }
+  return std::make_pair(
+      getPrefixKey(prefixEntry.prefix),
+      fbzmq::util::writeThriftObjStr(std::move(prefixDb), serializer_));
+}
+
+void
+PrefixManager::updateKvStorePrefixKeys() {
+  // Advertise the best entry of every changed prefix, lowest type preferred,
+  // or withdraw its key if there is no more entry or it is summarized. Keys
+  // are advertised in one batch
+  std::vector<std::pair<std::string, std::string>> keyVals;
+  for (const auto& prefix : dirtyPrefixes_) {
+    auto typesIt = prefixTypes_.find(prefix);
+    if (typesIt != prefixTypes_.end()) {
+      const auto& types = typesIt->second;
+      for (auto it = std::next(types.begin()); it != types.end(); ++it) {
+        maybeAddEvent(addingEvents_[*it][prefix], "COVERED_BY_HIGHER_TYPE");
+      }
+      maybeAddEvent(
+          addingEvents_[*types.begin()][prefix], "UPDATE_KVSTORE_THROTTLED");
+    }
+    const auto* entry = getAdvertisedEntry(prefix);
+    if (nullptr == entry) {
+      auto const key = getPrefixKey(prefix);
+      if (advertisedKeys_.erase(key)) {
+        keysToClear_.emplace(key);
+      }
+      continue;
+    }
+    keyVals.emplace_back(getPrefixKeyValue(*entry));
+    advertisedKeys_.emplace(keyVals.back().first);
+    keysToClear_.erase(keyVals.back().first);
+  }
+  if (keyVals.empty()) {
+    return;
+  }
+
+  for (const auto& area : areas_) {
+    bool const changed =
+        kvStoreClient_->persistKeys(keyVals, ttlKeyInKvStore_, area);
+    LOG_IF(INFO, changed) << "Advertising " << keyVals.size()
+                          << " prefix keys to KvStore area: " << area;
+  }
+}
+
+void
+PrefixManager::updateKvStorePrefixDb() {
+  const auto prefixDbKey = folly::sformat(
+      "{}{}", static_cast<std::string>(prefixDbMarker_), nodeId_);
+  if (dirtyPrefixes_.empty() and advertisedKeys_.count(prefixDbKey)) {
+    return;
+  }
+
+  thrift::PrefixDatabase prefixDb;
+  prefixDb.thisNodeName = nodeId_;
+  prefixDb.prefixEntries.reserve(prefixTypes_.size());
+  thrift::PerfEvents* mostRecentEvents = nullptr;
+  for (const auto& kv : prefixTypes_) {
+    const auto& prefix = kv.first;
+    const auto& types = kv.second;
+    for (auto it = std::next(types.begin()); it != types.end(); ++it) {
+      maybeAddEvent(addingEvents_[*it][prefix], "COVERED_BY_HIGHER_TYPE");
+    }
+    const auto bestType = *types.begin();
+    auto& events = addingEvents_[bestType][prefix];
+    maybeAddEvent(events, "UPDATE_KVSTORE_THROTTLED");
+    if (nullptr == mostRecentEvents or
+        events.events.back().unixTs > mostRecentEvents->events.back().unixTs) {
+      mostRecentEvents = &events;
+    }
+    if (not isSummarized(prefix)) {
+      prefixDb.prefixEntries.emplace_back(prefixMap_.at(bestType).at(prefix));
+    }
+  }
+  // Summaries of aggregates not advertised explicitly
+  for (const auto& kv : summaries_) {
+    if (not prefixTypes_.count(kv.first)) {
+      prefixDb.prefixEntries.emplace_back(kv.second);
+    }
+  }
+  if (enablePerfMeasurement_ and nullptr != mostRecentEvents) {
+    prefixDb.perfEvents_ref() = *mostRecentEvents;
   }
-  const auto prefixKey =
-      PrefixKey(
-          nodeId_,
-          folly::IPAddress::createNetwork(toString(prefixEntry.prefix)),
-          thrift::KvStore_constants::kDefaultArea())
-          .getPrefixKey();
   for (const auto& area : areas_) {
     bool const changed = kvStoreClient_->persistKey(
-        prefixKey,
+        prefixDbKey,
         fbzmq::util::writeThriftObjStr(std::move(prefixDb), serializer_),
         ttlKeyInKvStore_,
         area);
-    LOG_IF(INFO, changed) << "Advertising key: " << prefixKey
-                          << " to KvStore area: " << area;
+    LOG_IF(INFO, changed) << "Updating all " << prefixDb.prefixEntries.size()
+                          << " prefixes in KvStore " << prefixDbKey
+                          << " area: " << area;
   }
-  return prefixKey;
+  advertisedKeys_.emplace(prefixDbKey);
+  keysToClear_.erase(prefixDbKey);
 }
 
 void
 PrefixManager::updateKvStore() {
-  std::vector<std::pair<std::string, std::string>> keyVals;
-  std::unordered_set<std::string> nowAdvertisingKeys;
-  std::unordered_set<thrift::IpPrefix> nowAdvertisingPrefixes;
+  updateSummaries();
+  fb303::fbData->addStatValue(
+      "prefix_manager.dirty_prefixes", dirtyPrefixes_.size(), fb303::AVG);
   if (perPrefixKeys_) {
-    for (auto& kv : prefixMap_) {
-      for (auto& kv2 : kv.second) {
-        if (not nowAdvertisingPrefixes.count(kv2.first)) {
-          maybeAddEvent(
-              addingEvents_[kv.first][kv2.first], "UPDATE_KVSTORE_THROTTLED");
-          auto const key = advertisePrefix(kv2.second);
-          nowAdvertisingKeys.emplace(key);
-          nowAdvertisingPrefixes.emplace(kv2.first);
-          keysToClear_.erase(key);
-        } else {
-          maybeAddEvent(
-              addingEvents_[kv.first][kv2.first], "COVERED_BY_HIGHER_TYPE");
-        }
-      }
-    }
+    updateKvStorePrefixKeys();
   } else {
-    thrift::PrefixDatabase prefixDb;
-    prefixDb.thisNodeName = nodeId_;
-    thrift::PerfEvents* mostRecentEvents = nullptr;
-    for (auto& kv : prefixMap_) {
-      for (auto& kv2 : kv.second) {
-        if (not nowAdvertisingPrefixes.count(kv2.first)) {
-          maybeAddEvent(
-              addingEvents_[kv.first][kv2.first], "UPDATE_KVSTORE_THROTTLED");
-          if (nullptr == mostRecentEvents or
-              addingEvents_[kv.first][kv2.first].events.back().unixTs >
-                  mostRecentEvents->events.back().unixTs) {
-            mostRecentEvents = &addingEvents_[kv.first][kv2.first];
-          }
-          prefixDb.prefixEntries.emplace_back(kv2.second);
-          nowAdvertisingPrefixes.emplace(kv2.first);
-        } else {
-          maybeAddEvent(
-              addingEvents_[kv.first][kv2.first], "COVERED_BY_HIGHER_TYPE");
-        }
-      }
-    }
-    if (enablePerfMeasurement_ and nullptr != mostRecentEvents) {
-      prefixDb.perfEvents_ref() = *mostRecentEvents;
-    }
-    const auto prefixDbKey = folly::sformat(
-        "{}{}", static_cast<std::string>(prefixDbMarker_), nodeId_);
-    for (const auto& area : areas_) {
-      bool const changed = kvStoreClient_->persistKey(
-          prefixDbKey,
-          fbzmq::util::writeThriftObjStr(std::move(prefixDb), serializer_),
-          ttlKeyInKvStore_,
-          area);
-      LOG_IF(INFO, changed)
-          << "Updating all " << prefixDb.prefixEntries.size()
-          << " prefixes in KvStore " << prefixDbKey << " area: " << area;
-    }
-    nowAdvertisingKeys.emplace(prefixDbKey);
-    keysToClear_.erase(prefixDbKey);
+    updateKvStorePrefixDb();
   }
+  dirtyPrefixes_.clear();
+
+  // Withdraw any key of ours we don't advertise
   thrift::PrefixDatabase deletedPrefixDb;
   deletedPrefixDb.thisNodeName = nodeId_;
   deletedPrefixDb.deletePrefix = true;
@@ -317,9 +439,7 @@ PrefixManager::updateKvStore() {
           area);
     }
   }
-
-  // anything we don't advertise next time, we need to clear
-  keysToClear_ = std::move(nowAdvertisingKeys);
+  keysToClear_.clear();
 
   // Update flat counters
   size_t num_prefixes = 0;
@@ -330,6 +450,106 @@ PrefixManager::updateKvStore() {
     num_prefixes += kv.second.size();
   }
   fb303::fbData->setCounter("prefix_manager.num_prefixes", num_prefixes);
+  fb303::fbData->setCounter("prefix_manager.num_summaries", summaries_.size());
+}
+
+std::optional<thrift::IpPrefix>
+PrefixManager::getAggregate(const thrift::IpPrefix& prefix) const {
+  if (aggregates_.empty()) {
+    return std::nullopt;
+  }
+  const auto network = toIPNetwork(prefix);
+  std::optional<thrift::IpPrefix> aggregate;
+  uint8_t aggregateLen{0};
+  for (const auto& kv : aggregates_) {
+    const auto& aggregateNetwork = kv.second;
+    if (network.second > aggregateNetwork.second and
+        network.second > aggregateLen and
+        network.first.inSubnet(
+            aggregateNetwork.first, aggregateNetwork.second)) {
+      aggregate = kv.first;
+      aggregateLen = aggregateNetwork.second;
+    }
+  }
+  return aggregate;
+}
+
+void
+PrefixManager::updateSummaries() {
+  std::unordered_set<thrift::IpPrefix> dirtyAggregates;
+  for (const auto& prefix : dirtyPrefixes_) {
+    auto aggregate = getAggregate(prefix);
+    if (aggregate.has_value()) {
+      dirtyAggregates.emplace(std::move(*aggregate));
+    }
+  }
+
+  for (const auto& aggregate : dirtyAggregates) {
+    // Count members of every summary key, the lowest one is chosen
+    std::map<SummaryKey, size_t> groups;
+    auto membersIt = aggregateMembers_.find(aggregate);
+    if (membersIt != aggregateMembers_.end()) {
+      for (const auto& prefix : membersIt->second) {
+        const auto bestType = *prefixTypes_.at(prefix).begin();
+        ++groups[getSummaryKey(prefixMap_.at(bestType).at(prefix))];
+      }
+    }
+
+    std::optional<thrift::PrefixEntry> summary;
+    if (not groups.empty()) {
+      const auto& key = groups.begin()->first;
+      summary = createPrefixEntry(aggregate, std::get<0>(key));
+      summary->forwardingType = std::get<1>(key);
+      summary->forwardingAlgorithm = std::get<2>(key);
+      summary->ephemeral_ref() = true;
+    }
+
+    auto it = summaries_.find(aggregate);
+    const bool existed = it != summaries_.end();
+    if (existed and summary.has_value() and it->second == *summary) {
+      continue;
+    }
+    if (summary.has_value()) {
+      summaries_[aggregate] = std::move(*summary);
+    } else if (existed) {
+      summaries_.erase(it);
+    } else {
+      continue;
+    }
+    // summary changed, hence the members being summarized
+    dirtyPrefixes_.emplace(aggregate);
+    if (membersIt != aggregateMembers_.end()) {
+      dirtyPrefixes_.insert(membersIt->second.begin(), membersIt->second.end());
+    }
+  }
+}
+
+bool
+PrefixManager::isSummarized(const thrift::IpPrefix& prefix) const {
+  const auto aggregate = getAggregate(prefix);
+  if (not aggregate.has_value()) {
+    return false;
+  }
+  auto it = summaries_.find(*aggregate);
+  if (it == summaries_.end()) {
+    return false;
+  }
+  const auto bestType = *prefixTypes_.at(prefix).begin();
+  return getSummaryKey(prefixMap_.at(bestType).at(prefix)) ==
+      getSummaryKey(it->second);
+}
+
+const thrift::PrefixEntry*
+PrefixManager::getAdvertisedEntry(const thrift::IpPrefix& prefix) const {
+  auto typesIt = prefixTypes_.find(prefix);
+  if (typesIt != prefixTypes_.end()) {
+    if (isSummarized(prefix)) {
+      return nullptr;
+    }
+    return &prefixMap_.at(*typesIt->second.begin()).at(prefix);
+  }
+  auto it = summaries_.find(prefix);
+  return it != summaries_.end() ? &it->second : nullptr;
 }
 
 folly::SemiFuture<bool>
@@ -431,6 +651,8 @@ PrefixManager::addOrUpdatePrefixes(
     auto it = prefixes.find(prefixEntry.prefix);
     if (it == prefixes.end() or it->second != prefixEntry) {
       prefixes[prefixEntry.prefix] = prefixEntry;
+      addPrefixType(prefixEntry.prefix, prefixEntry.type);
+      dirtyPrefixes_.emplace(prefixEntry.prefix);
       addPerfEvent(
           addingEvents_[prefixEntry.type][prefixEntry.prefix],
           nodeId_,
@@ -441,7 +663,7 @@ PrefixManager::addOrUpdatePrefixes(
     }
   }
   if (updated) {
-    persistPrefixDb();
+    persistPrefixDbDebounced();
     outputStateThrottled_->operator()();
   }
   return updated;
@@ -462,6 +684,8 @@ PrefixManager::removePrefixes(
   for (const auto& prefix : prefixes) {
     prefixMap_.at(prefix.type).erase(prefix.prefix);
     addingEvents_.at(prefix.type).erase(prefix.prefix);
+    removePrefixType(prefix.prefix, prefix.type);
+    dirtyPrefixes_.emplace(prefix.prefix);
     SYSLOG(INFO) << "Withdrawing prefix: " << toString(prefix.prefix)
                  << ", client: " << getPrefixTypeName(prefix.type);
     if (prefixMap_[prefix.type].empty()) {
@@ -472,7 +696,7 @@ PrefixManager::removePrefixes(
     }
   }
   if (!prefixes.empty()) {
-    persistPrefixDb();
+    persistPrefixDbDebounced();
     outputStateThrottled_->operator()();
   }
   return !prefixes.empty();
@@ -485,17 +709,29 @@ PrefixManager::syncPrefixes(
   LOG(INFO) << "Syncing prefixes of type: " << getPrefixTypeName(type);
   // building these lists so we can call add and remove and get detailed logging
   std::vector<thrift::PrefixEntry> toAddOrUpdate, toRemove;
-  std::unordered_set<thrift::IpPrefix> toRemoveSet;
-  for (auto const& kv : prefixMap_[type]) {
-    toRemoveSet.emplace(kv.first);
-  }
+  std::vector<thrift::IpPrefix> newPrefixes, oldPrefixes;
+  newPrefixes.reserve(prefixEntries.size());
   for (auto const& entry : prefixEntries) {
     CHECK(type == entry.type);
-    toRemoveSet.erase(entry.prefix);
+    newPrefixes.emplace_back(entry.prefix);
     toAddOrUpdate.emplace_back(entry);
   }
-  for (auto const& prefix : toRemoveSet) {
-    toRemove.emplace_back(prefixMap_[type][prefix]);
+  auto& prefixes = prefixMap_[type];
+  oldPrefixes.reserve(prefixes.size());
+  for (auto const& kv : prefixes) {
+    oldPrefixes.emplace_back(kv.first);
+  }
+  // Existing prefixes which are not synced are removed, sorted merge
+  std::sort(newPrefixes.begin(), newPrefixes.end());
+  std::sort(oldPrefixes.begin(), oldPrefixes.end());
+  auto newIt = newPrefixes.begin();
+  for (auto const& prefix : oldPrefixes) {
+    while (newIt != newPrefixes.end() and *newIt < prefix) {
+      ++newIt;
+    }
+    if (newIt == newPrefixes.end() or prefix < *newIt) {
+      toRemove.emplace_back(prefixes.at(prefix));
+    }
   }
   bool updated = false;
   updated |= addOrUpdatePrefixes(toAddOrUpdate);
@@ -509,15 +745,53 @@ PrefixManager::removePrefixesByType(thrift::PrefixType type) {
   auto const search = prefixMap_.find(type);
   if (search != prefixMap_.end()) {
     changed = true;
+    for (const auto& kv : search->second) {
+      removePrefixType(kv.first, type);
+      dirtyPrefixes_.emplace(kv.first);
+    }
     prefixMap_.erase(search);
   }
   if (changed) {
-    persistPrefixDb();
+    persistPrefixDbDebounced();
     outputStateThrottled_->operator()();
   }
   return changed;
 }
 
+void
+PrefixManager::addPrefixType(
+    const thrift::IpPrefix& prefix, thrift::PrefixType type) {
+  auto& types = prefixTypes_[prefix];
+  types.emplace(type);
+  if (types.size() == 1) {
+    auto aggregate = getAggregate(prefix);
+    if (aggregate.has_value()) {
+      aggregateMembers_[*aggregate].emplace(prefix);
+    }
+  }
+}
+
+void
+PrefixManager::removePrefixType(
+    const thrift::IpPrefix& prefix, thrift::PrefixType type) {
+  auto it = prefixTypes_.find(prefix);
+  if (it == prefixTypes_.end()) {
+    return;
+  }
+  it->second.erase(type);
+  if (it->second.empty()) {
+    prefixTypes_.erase(it);
+    auto aggregate = getAggregate(prefix);
+    if (aggregate.has_value()) {
+      auto membersIt = aggregateMembers_.find(*aggregate);
+      membersIt->second.erase(prefix);
+      if (membersIt->second.empty()) {
+        aggregateMembers_.erase(membersIt);
+      }
+    }
+  }
+}
+
 void
 PrefixManager::maybeAddEvent(
     thrift::PerfEvents& perfEvents, std::string const& updateEvent) {
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <chrono>
+#include <optional>
+#include <set>
 #include <string>
 #include <unordered_map>
 
@@ -42,10 +45,22 @@ class PrefixManager final : public OpenrEventBase {
       const std::chrono::seconds prefixHoldTime,
       const std::chrono::milliseconds ttlKeyInKvStore,
       const std::unordered_set<std::string>& area = {
-          openr::thrift::KvStore_constants::kDefaultArea()});
+          openr::thrift::KvStore_constants::kDefaultArea()},
+      // persistence of prefixes is delayed until no change happens for
+      // debounce time, but at most by max delay. 0 persists on every change
+      const std::chrono::milliseconds persistDebounce =
+          std::chrono::milliseconds(0),
+      const std::chrono::milliseconds persistMaxDelay =
+          std::chrono::milliseconds(0),
+      // prefixes covered by any of these are advertised as a summary of the
+      // aggregate, if they are of same type and forwarding attributes
+      const std::vector<thrift::IpPrefix>& aggregatePrefixes = {});
 
   ~PrefixManager();
 
+  // persist pending prefix changes before stopping
+  void stop() override;
+
   // disable copying
   PrefixManager(PrefixManager const&) = delete;
   PrefixManager& operator=(PrefixManager const&) = delete;
@@ -82,12 +97,21 @@ class PrefixManager final : public OpenrEventBase {
   // Update persistent store with non-ephemeral prefix entries
   void persistPrefixDb();
 
+  // Debounced version of persistPrefixDb
+  void persistPrefixDbDebounced();
+
   // Update kvstore with both ephemeral and non-ephemeral prefixes
   void updateKvStore();
 
-  // update all IP keys in KvStore
+  // update IP keys of changed prefixes in KvStore
   void updateKvStorePrefixKeys();
 
+  // update prefix database key in KvStore, if any prefix has changed
+  void updateKvStorePrefixDb();
+
+  // get per prefix key name of prefix
+  std::string getPrefixKey(const thrift::IpPrefix& prefix) const;
+
   // helpers to modify prefix db, returns true if the db is modified
   bool addOrUpdatePrefixes(const std::vector<thrift::PrefixEntry>& prefixes);
   bool removePrefixes(const std::vector<thrift::PrefixEntry>& prefixes);
@@ -97,8 +121,29 @@ class PrefixManager final : public OpenrEventBase {
       thrift::PrefixType type,
       const std::vector<thrift::PrefixEntry>& prefixes);
 
-  // add prefix entry in kvstore, return per prefix key name
-  std::string advertisePrefix(thrift::PrefixEntry& prefixEntry);
+  // build per prefix key name and value advertising prefix entry in kvstore
+  std::pair<std::string, std::string> getPrefixKeyValue(
+      const thrift::PrefixEntry& prefixEntry);
+
+  // get the most specific aggregate strictly covering prefix, if any
+  std::optional<thrift::IpPrefix> getAggregate(
+      const thrift::IpPrefix& prefix) const;
+
+  // recompute summaries of aggregates covering dirty prefixes. Aggregates
+  // and their members are marked dirty if the summary has changed.
+  void updateSummaries();
+
+  // is best entry of prefix advertised as part of a summary
+  bool isSummarized(const thrift::IpPrefix& prefix) const;
+
+  // entry to advertise for prefix, nullptr if there is none
+  const thrift::PrefixEntry* getAdvertisedEntry(
+      const thrift::IpPrefix& prefix) const;
+
+  // add/remove type to/from reverse index of prefix
+  void addPrefixType(const thrift::IpPrefix& prefix, thrift::PrefixType type);
+  void removePrefixType(
+      const thrift::IpPrefix& prefix, thrift::PrefixType type);
 
   // add event named updateEvent to perfEvents if it has value and the last
   // element is not already updateEvent
@@ -117,6 +162,13 @@ class PrefixManager final : public OpenrEventBase {
   // keep track of prefixDB on disk
   thrift::PrefixDatabase diskState_;
 
+  // debounce of prefixDB persistence
+  const std::chrono::milliseconds persistDebounce_{0};
+  const std::chrono::milliseconds persistMaxDelay_{0};
+  std::unique_ptr<fbzmq::ZmqTimeout> persistPrefixDbTimer_;
+  // first change not yet persisted
+  std::optional<std::chrono::steady_clock::time_point> persistPendingSince_;
+
   const PrefixDbMarker prefixDbMarker_;
 
   // create IP keys
@@ -146,6 +198,22 @@ class PrefixManager final : public OpenrEventBase {
       std::unordered_map<thrift::IpPrefix, thrift::PrefixEntry>>
       prefixMap_;
 
+  // Reverse index of prefixMap_, types of entries of every prefix. Lowest
+  // type, i.e. first one, is the preferred entry.
+  std::unordered_map<thrift::IpPrefix, std::set<thrift::PrefixType>>
+      prefixTypes_;
+
+  // configured aggregates
+  const std::vector<std::pair<thrift::IpPrefix, folly::CIDRNetwork>>
+      aggregates_;
+
+  // prefixes covered by every aggregate
+  std::unordered_map<thrift::IpPrefix, std::unordered_set<thrift::IpPrefix>>
+      aggregateMembers_;
+
+  // summary entries advertised for aggregates
+  std::unordered_map<thrift::IpPrefix, thrift::PrefixEntry> summaries_;
+
   // the serializer/deserializer helper we'll be using
   apache::thrift::CompactSerializer serializer_;
 
@@ -153,6 +221,13 @@ class PrefixManager final : public OpenrEventBase {
   // anything we no longer wish to advertise
   std::unordered_set<std::string> keysToClear_;
 
+  // keys currently advertised by us
+  std::unordered_set<std::string> advertisedKeys_;
+
+  // prefixes with entries added, updated or removed since last KvStore
+  // update. Only these are serialized and advertised again.
+  std::unordered_set<thrift::IpPrefix> dirtyPrefixes_;
+
   // perfEvents related to a given prefisEntry
   std::unordered_map<
       thrift::PrefixType,
@@ -0,0 +1,352 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <optional>
+#include <thread>
+#include <unordered_set>
+
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/NetworkUtil.h>
+#include <openr/common/Util.h>
+#include <openr/common/tests/BenchmarkUtils.h>
+#include <openr/config-store/PersistentStore.h>
+#include <openr/config/Config.h>
+#include <openr/config/tests/Utils.h>
+#include <openr/kvstore/KvStoreWrapper.h>
+#include <openr/prefix-manager/PrefixManager.h>
+
+namespace openr {
+
+namespace {
+
+const std::string kNodeName("node-1");
+
+// Generate numPrefixes distinct prefixes of type, starting at index offset
+std::vector<thrift::PrefixEntry>
+generatePrefixEntries(
+    size_t numPrefixes, thrift::PrefixType type, size_t offset = 0) {
+  std::vector<thrift::PrefixEntry> prefixEntries;
+  prefixEntries.reserve(numPrefixes);
+  for (size_t i = offset; i < offset + numPrefixes; ++i) {
+    prefixEntries.emplace_back(createPrefixEntry(
+        toIpPrefix(folly::sformat("fc00:{:x}:{:x}::/64", i / 65536, i % 65536)),
+        type));
+  }
+  return prefixEntries;
+}
+
+} // namespace
+
+/**
+ * PrefixManager attached to KvStore. Tracks prefixes advertised in KvStore
+ * from publications, so that time and bytes until KvStore reflects a workload
+ * can be measured.
+ */
+class PrefixManagerBenchmarkFixture {
+ public:
+  explicit PrefixManagerBenchmarkFixture(bool perPrefixKeys)
+      : perPrefixKeys_(perPrefixKeys) {
+    configStore_ = std::make_unique<PersistentStore>(
+        kNodeName,
+        folly::sformat(
+            "/tmp/pm_benchmark_config_store.bin.{}",
+            std::hash<std::thread::id>{}(std::this_thread::get_id())),
+        context_,
+        true /* dryrun */);
+    configStoreThread_ = std::thread([this]() { configStore_->run(); });
+    configStore_->waitUntilRunning();
+
+    auto tConfig = getBasicOpenrConfig(kNodeName);
+    config_ = std::make_shared<Config>(tConfig);
+    kvStoreWrapper_ = std::make_unique<KvStoreWrapper>(
+        context_, config_, std::unordered_map<std::string, thrift::PeerSpec>{});
+    kvStoreWrapper_->run();
+
+    prefixManager_ = std::make_unique<PrefixManager>(
+        kNodeName,
+        prefixUpdatesQueue_.getReader(),
+        configStore_.get(),
+        kvStoreWrapper_->getKvStore(),
+        PrefixDbMarker{Constants::kPrefixDbMarker.toString()},
+        perPrefixKeys_,
+        false /* enablePerfMeasurement */,
+        std::chrono::seconds(0) /* prefixHoldTime */,
+        Constants::kKvStoreDbTtl);
+    prefixManagerThread_ = std::thread([this]() { prefixManager_->run(); });
+    prefixManager_->waitUntilRunning();
+  }
+
+  ~PrefixManagerBenchmarkFixture() {
+    prefixUpdatesQueue_.close();
+    kvStoreWrapper_->closeQueue();
+    prefixManager_->stop();
+    prefixManagerThread_.join();
+    prefixManager_.reset();
+    kvStoreWrapper_->stop();
+    kvStoreWrapper_.reset();
+    configStore_->stop();
+    configStoreThread_.join();
+  }
+
+  void
+  sendRequest(
+      thrift::PrefixUpdateCommand cmd,
+      std::vector<thrift::PrefixEntry> prefixes,
+      std::optional<thrift::PrefixType> type = std::nullopt) {
+    thrift::PrefixUpdateRequest request;
+    request.cmd = cmd;
+    request.prefixes = std::move(prefixes);
+    if (type.has_value()) {
+      request.type_ref() = *type;
+    }
+    prefixUpdatesQueue_.push(std::move(request));
+  }
+
+  // Receive publications until KvStore reflects exactly the expected
+  // prefixes. Returns number of bytes of values written to KvStore meanwhile.
+  size_t
+  waitForPrefixes(const std::vector<thrift::PrefixEntry>& expected) {
+    expectedPrefixes_.clear();
+    numExpectedAdvertised_ = 0;
+    numUnexpectedAdvertised_ = 0;
+    for (auto const& entry : expected) {
+      expectedPrefixes_.emplace(entry.prefix);
+    }
+    for (auto const& kv : prefixesByKey_) {
+      for (auto const& prefix : kv.second) {
+        updateAdvertisedPrefix(prefix, 1);
+      }
+    }
+
+    size_t bytesWritten{0};
+    while (numExpectedAdvertised_ !=
+               static_cast<int64_t>(expectedPrefixes_.size()) or
+           numUnexpectedAdvertised_ != 0) {
+      auto publication = kvStoreWrapper_->recvPublication();
+      for (auto const& kv : publication.keyVals) {
+        if (not kv.second.value_ref().has_value()) {
+          continue;
+        }
+        auto const& value = kv.second.value_ref().value();
+        bytesWritten += value.size();
+        auto prefixDb = fbzmq::util::readThriftObjStr<thrift::PrefixDatabase>(
+            value, serializer_);
+
+        // Replace prefixes advertised in key
+        auto& prefixes = prefixesByKey_[kv.first];
+        for (auto const& prefix : prefixes) {
+          updateAdvertisedPrefix(prefix, -1);
+        }
+        prefixes.clear();
+        if (not prefixDb.deletePrefix) {
+          for (auto const& entry : prefixDb.prefixEntries) {
+            prefixes.emplace_back(entry.prefix);
+            updateAdvertisedPrefix(entry.prefix, 1);
+          }
+        }
+      }
+    }
+    return bytesWritten;
+  }
+
+ private:
+  void
+  updateAdvertisedPrefix(const thrift::IpPrefix& prefix, int delta) {
+    if (expectedPrefixes_.count(prefix)) {
+      numExpectedAdvertised_ += delta;
+    } else {
+      numUnexpectedAdvertised_ += delta;
+    }
+  }
+
+  const bool perPrefixKeys_{false};
+
+  fbzmq::Context context_;
+  apache::thrift::CompactSerializer serializer_;
+  messaging::ReplicateQueue<thrift::PrefixUpdateRequest> prefixUpdatesQueue_;
+
+  std::unique_ptr<PersistentStore> configStore_;
+  std::thread configStoreThread_;
+
+  std::shared_ptr<Config> config_;
+  std::unique_ptr<KvStoreWrapper> kvStoreWrapper_;
+
+  std::unique_ptr<PrefixManager> prefixManager_;
+  std::thread prefixManagerThread_;
+
+  // Prefixes advertised in every key in KvStore
+  std::unordered_map<std::string, std::vector<thrift::IpPrefix>>
+      prefixesByKey_;
+
+  // Prefixes expected in KvStore, and number of advertised ones which are
+  // expected or not
+  std::unordered_set<thrift::IpPrefix> expectedPrefixes_;
+  int64_t numExpectedAdvertised_{0};
+  int64_t numUnexpectedAdvertised_{0};
+};
+
+/**
+ * Workloads run against PrefixManager, starting with numPrefixes prefixes
+ * - ADVERTISE: advertise numChanges new prefixes
+ * - WITHDRAW: withdraw numChanges prefixes
+ * - SYNC: sync prefixes replacing numChanges of them
+ */
+enum class Workload { ADVERTISE, WITHDRAW, SYNC };
+
+/**
+ * Measure end to end time until KvStore reflects the workload and bytes of
+ * values written to KvStore for it
+ */
+static void
+BM_PrefixManager(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    Workload workload,
+    bool perPrefixKeys,
+    size_t numPrefixes,
+    size_t numChanges) {
+  const auto type = thrift::PrefixType::BGP;
+  for (uint32_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    PrefixManagerBenchmarkFixture fixture(perPrefixKeys);
+
+    const auto prefixes = generatePrefixEntries(numPrefixes, type);
+    if (numPrefixes) {
+      fixture.sendRequest(thrift::PrefixUpdateCommand::ADD_PREFIXES, prefixes);
+    }
+    fixture.waitForPrefixes(prefixes);
+
+    // State expected in KvStore after workload
+    const auto newPrefixes =
+        generatePrefixEntries(numChanges, type, numPrefixes);
+    std::vector<thrift::PrefixEntry> expected;
+    switch (workload) {
+    case Workload::ADVERTISE:
+      expected = prefixes;
+      expected.insert(expected.end(), newPrefixes.begin(), newPrefixes.end());
+      break;
+    case Workload::WITHDRAW:
+      expected.assign(prefixes.begin() + numChanges, prefixes.end());
+      break;
+    case Workload::SYNC:
+      expected = newPrefixes;
+      expected.insert(
+          expected.end(), prefixes.begin() + numChanges, prefixes.end());
+      break;
+    }
+
+    suspender.dismiss();
+    const auto startTime = std::chrono::steady_clock::now();
+    switch (workload) {
+    case Workload::ADVERTISE:
+      fixture.sendRequest(
+          thrift::PrefixUpdateCommand::ADD_PREFIXES, newPrefixes);
+      break;
+    case Workload::WITHDRAW:
+      fixture.sendRequest(
+          thrift::PrefixUpdateCommand::WITHDRAW_PREFIXES,
+          std::vector<thrift::PrefixEntry>(
+              prefixes.begin(), prefixes.begin() + numChanges));
+      break;
+    case Workload::SYNC:
+      fixture.sendRequest(
+          thrift::PrefixUpdateCommand::SYNC_PREFIXES_BY_TYPE, expected, type);
+      break;
+    }
+    const auto bytesWritten = fixture.waitForPrefixes(expected);
+    const auto elapsedMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime)
+            .count();
+    suspender.rehire();
+
+    counters["e2e_ms"] = elapsedMs;
+    counters["bytes_written"] = bytesWritten;
+  }
+}
+
+// The parameters are mode of keys, number of prefixes and number of changed
+// prefixes
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManager,
+    counters,
+    ADVERTISE_AGGREGATED_0_10000,
+    Workload::ADVERTISE,
+    false,
+    0,
+    10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManager,
+    counters,
+    ADVERTISE_PER_PREFIX_0_10000,
+    Workload::ADVERTISE,
+    true,
+    0,
+    10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManager,
+    counters,
+    ADVERTISE_AGGREGATED_100000_100,
+    Workload::ADVERTISE,
+    false,
+    100000,
+    100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManager,
+    counters,
+    ADVERTISE_PER_PREFIX_100000_100,
+    Workload::ADVERTISE,
+    true,
+    100000,
+    100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManager,
+    counters,
+    WITHDRAW_AGGREGATED_100000_100,
+    Workload::WITHDRAW,
+    false,
+    100000,
+    100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManager,
+    counters,
+    WITHDRAW_PER_PREFIX_100000_100,
+    Workload::WITHDRAW,
+    true,
+    100000,
+    100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManager,
+    counters,
+    SYNC_AGGREGATED_100000_100,
+    Workload::SYNC,
+    false,
+    100000,
+    100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManager,
+    counters,
+    SYNC_PER_PREFIX_100000_100,
+    Workload::SYNC,
+    true,
+    100000,
+    100);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
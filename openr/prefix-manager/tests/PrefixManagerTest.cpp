@@ -1109,6 +1109,168 @@ TEST_P(PrefixManagerTestFixture, CheckPersistStoreUpdate) {
   ASSERT_EQ(4, configStore->getNumOfDbWritesToDisk());
 }
 
+// Verify that persistence of changes is debounced and bounded by max delay
+TEST(PrefixManagerTest, PersistDebounce) {
+  fbzmq::Context context;
+  messaging::ReplicateQueue<thrift::PrefixUpdateRequest> prefixUpdatesQueue;
+
+  auto configStore = std::make_unique<PersistentStore>(
+      "1",
+      folly::sformat(
+          "/tmp/pm_ut_config_store.bin.{}",
+          std::hash<std::thread::id>{}(std::this_thread::get_id())),
+      context,
+      true);
+  std::thread configStoreThread([&]() noexcept { configStore->run(); });
+  configStore->waitUntilRunning();
+
+  auto tConfig = getBasicOpenrConfig("node-1");
+  auto config = std::make_shared<Config>(tConfig);
+  auto kvStoreWrapper = std::make_unique<KvStoreWrapper>(
+      context, config, std::unordered_map<std::string, thrift::PeerSpec>{});
+  kvStoreWrapper->run();
+
+  const std::chrono::milliseconds debounce{200};
+  const std::chrono::milliseconds maxDelay{1000};
+  auto prefixManager = std::make_unique<PrefixManager>(
+      "node-1",
+      prefixUpdatesQueue.getReader(),
+      configStore.get(),
+      kvStoreWrapper->getKvStore(),
+      PrefixDbMarker{Constants::kPrefixDbMarker.toString()},
+      false /* create IP prefix keys */,
+      false /* prefix-mananger perf measurement */,
+      std::chrono::seconds(0),
+      Constants::kKvStoreDbTtl,
+      std::unordered_set<std::string>{
+          openr::thrift::KvStore_constants::kDefaultArea()},
+      debounce,
+      maxDelay);
+  std::thread prefixManagerThread([&]() { prefixManager->run(); });
+  prefixManager->waitUntilRunning();
+
+  // Changes within debounce time are coalesced into one write
+  prefixManager->advertisePrefixes({prefixEntry1}).get();
+  prefixManager->advertisePrefixes({prefixEntry2}).get();
+  prefixManager->withdrawPrefixes({prefixEntry1}).get();
+  EXPECT_EQ(0, configStore->getNumOfDbWritesToDisk());
+  std::this_thread::sleep_for(2 * debounce);
+  EXPECT_EQ(1, configStore->getNumOfDbWritesToDisk());
+
+  // Continuous changes are persisted no later than max delay
+  const auto startTime = std::chrono::steady_clock::now();
+  for (int i = 0; std::chrono::steady_clock::now() - startTime < 2 * maxDelay;
+       ++i) {
+    auto prefixEntry = prefixEntry3;
+    prefixEntry.data = std::to_string(i);
+    prefixManager->advertisePrefixes({prefixEntry}).get();
+    std::this_thread::sleep_for(debounce / 4);
+  }
+  EXPECT_LE(2, configStore->getNumOfDbWritesToDisk());
+
+  // Pending change is persisted on stop
+  const auto numWrites = configStore->getNumOfDbWritesToDisk();
+  prefixManager->advertisePrefixes({prefixEntry4}).get();
+  prefixUpdatesQueue.close();
+  kvStoreWrapper->closeQueue();
+  prefixManager->stop();
+  prefixManagerThread.join();
+  EXPECT_EQ(numWrites + 1, configStore->getNumOfDbWritesToDisk());
+
+  kvStoreWrapper->stop();
+  configStore->stop();
+  configStoreThread.join();
+}
+
+// Verify that prefixes covered by an aggregate are advertised as its summary
+TEST(PrefixManagerTest, Summarization) {
+  fbzmq::Context context;
+  messaging::ReplicateQueue<thrift::PrefixUpdateRequest> prefixUpdatesQueue;
+  CompactSerializer serializer;
+
+  auto configStore = std::make_unique<PersistentStore>(
+      "1",
+      folly::sformat(
+          "/tmp/pm_ut_summary_store.bin.{}",
+          std::hash<std::thread::id>{}(std::this_thread::get_id())),
+      context,
+      true);
+  std::thread configStoreThread([&]() noexcept { configStore->run(); });
+  configStore->waitUntilRunning();
+
+  auto tConfig = getBasicOpenrConfig("node-1");
+  auto config = std::make_shared<Config>(tConfig);
+  auto kvStoreWrapper = std::make_unique<KvStoreWrapper>(
+      context, config, std::unordered_map<std::string, thrift::PeerSpec>{});
+  kvStoreWrapper->run();
+
+  const auto aggregate = toIpPrefix("fc00:1::/48");
+  auto prefixManager = std::make_unique<PrefixManager>(
+      "node-1",
+      prefixUpdatesQueue.getReader(),
+      configStore.get(),
+      kvStoreWrapper->getKvStore(),
+      PrefixDbMarker{Constants::kPrefixDbMarker.toString()},
+      false /* create IP prefix keys */,
+      false /* prefix-mananger perf measurement */,
+      std::chrono::seconds(0),
+      Constants::kKvStoreDbTtl,
+      std::unordered_set<std::string>{
+          openr::thrift::KvStore_constants::kDefaultArea()},
+      std::chrono::milliseconds(0),
+      std::chrono::milliseconds(0),
+      std::vector<thrift::IpPrefix>{aggregate});
+  std::thread prefixManagerThread([&]() { prefixManager->run(); });
+  prefixManager->waitUntilRunning();
+
+  // Wait for publication advertising exactly the expected prefixes
+  auto waitForPrefixes =
+      [&](std::unordered_set<thrift::IpPrefix> const& expected) {
+        std::unordered_set<thrift::IpPrefix> prefixes;
+        do {
+          auto pub = kvStoreWrapper->recvPublication();
+          auto it = pub.keyVals.find("prefix:node-1");
+          if (it == pub.keyVals.end() or not it->second.value_ref()) {
+            continue;
+          }
+          auto db = fbzmq::util::readThriftObjStr<thrift::PrefixDatabase>(
+              it->second.value_ref().value(), serializer);
+          prefixes.clear();
+          for (auto const& entry : db.prefixEntries) {
+            prefixes.emplace(entry.prefix);
+          }
+        } while (prefixes != expected);
+      };
+
+  const auto member1 =
+      createPrefixEntry(toIpPrefix("fc00:1:0:1::/64"), thrift::PrefixType::BGP);
+  const auto member2 =
+      createPrefixEntry(toIpPrefix("fc00:1:0:2::/64"), thrift::PrefixType::BGP);
+  const auto other =
+      createPrefixEntry(toIpPrefix("fc00:2::/64"), thrift::PrefixType::BGP);
+  prefixManager->advertisePrefixes({member1, member2, other}).get();
+  waitForPrefixes({aggregate, other.prefix});
+
+  // Members are still known to PrefixManager
+  EXPECT_EQ(3, prefixManager->getPrefixes().get()->size());
+
+  // Summary is withdrawn along with its last member
+  prefixManager->withdrawPrefixes({member1, member2}).get();
+  waitForPrefixes({other.prefix});
+  EXPECT_EQ(1, prefixManager->getPrefixes().get()->size());
+
+  prefixManager->withdrawPrefixes({other}).get();
+  waitForPrefixes({});
+
+  prefixUpdatesQueue.close();
+  kvStoreWrapper->closeQueue();
+  prefixManager->stop();
+  prefixManagerThread.join();
+  kvStoreWrapper->stop();
+  configStore->stop();
+  configStoreThread.join();
+}
+
 // Verify that persist store is update properly when both persistent
 // and ephemeral entries are mixed for same prefix type
 TEST_P(PrefixManagerTestFixture, CheckEphemeralAndPersistentUpdate) {
@@ -1158,6 +1320,36 @@ TEST_P(PrefixManagerTestFixture, CheckEphemeralAndPersistentUpdate) {
   ASSERT_EQ(7, configStore->getNumOfDbWritesToDisk());
 }
 
+// Only changed prefixes are advertised again with per prefix keys
+TEST_P(PrefixManagerTestFixture, IncrementalKvStoreUpdates) {
+  // Receive initial empty prefix database from KvStore when per-prefix key is
+  // not used
+  if (not perPrefixKeys_) {
+    kvStoreWrapper->recvPublication();
+  }
+
+  prefixManager->advertisePrefixes({prefixEntry1, prefixEntry2}).get();
+  for (int i = 0; i < (perPrefixKeys_ ? 2 : 1); ++i) {
+    kvStoreWrapper->recvPublication();
+  }
+
+  prefixManager->advertisePrefixes({prefixEntry3}).get();
+  auto pub = kvStoreWrapper->recvPublication();
+  ASSERT_EQ(1, pub.keyVals.size());
+  auto db = fbzmq::util::readThriftObjStr<thrift::PrefixDatabase>(
+      pub.keyVals.begin()->second.value_ref().value(), serializer);
+  if (perPrefixKeys_) {
+    const auto prefixKey = PrefixKey(
+        "node-1",
+        folly::IPAddress::createNetwork(toString(prefixEntry3.prefix)),
+        thrift::KvStore_constants::kDefaultArea());
+    EXPECT_EQ(prefixKey.getPrefixKey(), pub.keyVals.begin()->first);
+    EXPECT_EQ(1, db.prefixEntries.size());
+  } else {
+    EXPECT_EQ(3, db.prefixEntries.size());
+  }
+}
+
 TEST_P(PrefixManagerTestFixture, PrefixUpdatesQueue) {
   // Helper function to receive expected number of updates from KvStore
   auto recvPublication = [this](int num) {
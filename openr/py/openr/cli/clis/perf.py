@@ -18,6 +18,7 @@ from openr.cli.utils.options import breeze_option
 class PerfCli(object):
     def __init__(self):
         self.perf.add_command(ViewFibCli().fib)
+        self.perf.add_command(ProfileCli().profile)
 
     @click.group()
     @click.pass_context
@@ -33,3 +34,28 @@ class ViewFibCli(object):
         """ View latest perf log of fib module from this node """
 
         perf.ViewFibCmd(cli_opts).run()
+
+
+class ProfileCli(object):
+    @click.command()
+    @click.option(
+        "--duration-ms", default=5000, type=click.INT, help="Profile duration"
+    )
+    @click.option(
+        "--thread",
+        default="",
+        type=click.STRING,
+        help="Only profile threads whose name starts with it e.g. Decision",
+    )
+    @click.option(
+        "--output",
+        "-o",
+        default="",
+        type=click.STRING,
+        help="Write folded stacks into file instead of stdout",
+    )
+    @click.pass_obj
+    def profile(cli_opts, duration_ms, thread, output):  # noqa: B902
+        """ Sample CPU usage of Open/R and dump folded stacks """
+
+        perf.ProfileCmd(cli_opts).run(duration_ms, thread, output)
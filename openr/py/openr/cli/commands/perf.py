@@ -8,6 +8,7 @@
 #
 
 
+import sys
 from builtins import range
 
 import tabulate
@@ -33,3 +34,33 @@ class ViewFibCmd(OpenrCtrlCmd):
             print("Perf Event Item: {}, total duration: {}ms".format(i, total_duration))
             print(tabulate.tabulate(rows, headers=headers))
             print()
+
+
+class ProfileCmd(OpenrCtrlCmd):
+    def run(self, duration_ms: int, thread: str, output: str) -> None:
+        # profile blocks for its whole duration, leave room for it in timeout
+        self.cli_opts.timeout = max(self.cli_opts.timeout, duration_ms + 5000)
+        super().run(duration_ms, thread, output)
+
+    def _run(
+        self, client: OpenrCtrl.Client, duration_ms: int, thread: str, output: str
+    ) -> None:
+        resp = client.getCpuProfile(duration_ms, thread)
+        lines = [
+            "{} {}".format(stack, count)
+            for stack, count in sorted(resp.foldedStacks.items())
+        ]
+        if output:
+            with open(output, "w") as f:
+                f.write("\n".join(lines) + "\n")
+        else:
+            print("\n".join(lines))
+        print(
+            "Took {} samples in {}ms at {}Hz, dropped {}".format(
+                resp.numSamples,
+                resp.durationMs,
+                resp.samplingHz,
+                resp.numDroppedSamples,
+            ),
+            file=sys.stderr,
+        )
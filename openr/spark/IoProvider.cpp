@@ -7,6 +7,7 @@
 
 #include "IoProvider.h"
 
+#include <linux/errqueue.h>
 #include <net/if.h>
 
 #include <glog/logging.h>
@@ -16,6 +17,178 @@
 
 namespace openr {
 
+namespace {
+
+// Control buffer for source address and interface of a message, aligned by
+// control message hdr
+union PktInfoControl {
+  char cbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+  struct cmsghdr align;
+};
+
+// Fill message header to send packet via interface `ifIndex` from `srcAddr`.
+// Message refers to all of the provided buffers.
+void
+fillMessage(
+    struct msghdr& msg,
+    struct iovec& entry,
+    PktInfoControl& control,
+    sockaddr_storage& dstAddrStorage,
+    socklen_t dstAddrLen,
+    int ifIndex,
+    folly::IPAddressV6 const& srcAddr,
+    std::string const& packet) {
+  ::memset(&msg, 0, sizeof(msg));
+  msg.msg_name = reinterpret_cast<void*>(&dstAddrStorage);
+  msg.msg_namelen = dstAddrLen;
+
+  // set the source address and source if index for this message
+  // this goes into ancilliary data fields
+  msg.msg_control = control.cbuf;
+  msg.msg_controllen = sizeof(control.cbuf);
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+
+  cmsg->cmsg_level = IPPROTO_IPV6;
+  cmsg->cmsg_type = IPV6_PKTINFO;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
+
+  auto pktinfo = (struct in6_pktinfo*)CMSG_DATA(cmsg);
+  pktinfo->ipi6_ifindex = ifIndex;
+  ::memcpy(&pktinfo->ipi6_addr, srcAddr.bytes(), srcAddr.byteCount());
+
+  // the IO vector for data to be sent
+  msg.msg_iov = &entry;
+  msg.msg_iovlen = 1;
+
+  // write the data here (we need to remove the const qualifier)
+  entry.iov_base = const_cast<char*>(packet.data());
+  entry.iov_len = packet.size();
+}
+
+// Control buffer for received messages
+// XXX: hardcoded, but this hardly should be a problem
+union RecvControl {
+  char ctrlBuf[CMSG_SPACE(1024)];
+  struct cmsghdr align;
+};
+
+// Prepare message header to receive a single block of data of up to `len`
+// bytes into `buf`. Message refers to all of the provided buffers.
+void
+prepareRecvMessage(
+    struct msghdr& msg,
+    struct iovec& entry,
+    RecvControl& control,
+    sockaddr_storage& addrStorage,
+    unsigned char* buf,
+    size_t len) {
+  ::memset(&msg, 0, sizeof(msg));
+
+  // we only expect to receive one block of data, single entry
+  // in the vector
+  msg.msg_iov = &entry;
+  msg.msg_iovlen = 1;
+
+  // this part is important - if we don't zero the buffer,
+  // the CMSG_NXTHDR may burp, because it tries extracting
+  // fields from "next header" in the buffer
+  ::memset(&control.ctrlBuf[0], 0, sizeof(control.ctrlBuf));
+
+  // control message buffer used to receive dest IP from the kernel
+  msg.msg_control = control.ctrlBuf;
+  msg.msg_controllen = sizeof(control.ctrlBuf);
+
+  // prepare to receive either v4 or v6 addresses
+  ::memset(&addrStorage, 0, sizeof(addrStorage));
+  msg.msg_name = &addrStorage;
+  msg.msg_namelen = sizeof(sockaddr_storage);
+
+  // write the data here
+  entry.iov_base = buf;
+  entry.iov_len = len;
+}
+
+// cast to int64_t since ts.tv_sec is 32 bits on some platforms like arm
+std::chrono::microseconds
+toMicroseconds(struct timespec const& ts) {
+  return std::chrono::microseconds(
+      static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000);
+}
+
+// Grab the ifIndex we received message on, the hopLimit and receive
+// timestamp. Those are available since we requested them via socket options.
+void
+parseRecvControl(
+    struct msghdr& msg,
+    int& ifIndex,
+    int& hopLimit,
+    std::chrono::microseconds& recvTs) {
+  ifIndex = -1;
+  hopLimit = 0;
+
+  // use user space timestamp if kernel timestamp is not found
+  recvTs = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+       cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == IPPROTO_IPV6) {
+      if (cmsg->cmsg_type == IPV6_PKTINFO) {
+        struct in6_pktinfo pktinfo;
+        memcpy(
+            reinterpret_cast<void*>(&pktinfo),
+            CMSG_DATA(cmsg),
+            sizeof(pktinfo));
+        ifIndex = pktinfo.ipi6_ifindex;
+      } else if (cmsg->cmsg_type == IPV6_HOPLIMIT) {
+        memcpy(
+            reinterpret_cast<void*>(&hopLimit),
+            CMSG_DATA(cmsg),
+            sizeof(hopLimit));
+      }
+    }
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPNS) {
+      struct timespec ts {
+        0, 0
+      };
+      memcpy(reinterpret_cast<void*>(&ts), CMSG_DATA(cmsg), sizeof(ts));
+      const auto kernelRecvTs = toMicroseconds(ts);
+
+      // sanity check
+      DCHECK(recvTs >= kernelRecvTs) << "Time anomaly";
+      VLOG(4) << "Got kernel-timestamp. It took "
+              << (recvTs - kernelRecvTs).count()
+              << " us for the packet to get from kernel to user space";
+      recvTs = kernelRecvTs;
+    }
+    if (cmsg->cmsg_level == SOL_SOCKET &&
+        cmsg->cmsg_type == SCM_TIMESTAMPING) {
+      // ts[0] is software timestamp, ts[2] is raw hardware timestamp. Prefer
+      // the latter, it is free of interrupt coalescing and softirq delays.
+      struct scm_timestamping tss;
+      memcpy(reinterpret_cast<void*>(&tss), CMSG_DATA(cmsg), sizeof(tss));
+      const auto hwRecvTs = toMicroseconds(tss.ts[2]);
+      const auto swRecvTs = toMicroseconds(tss.ts[0]);
+      if (hwRecvTs.count()) {
+        VLOG(4) << "Got hardware-timestamp. It took "
+                << (recvTs - hwRecvTs).count()
+                << " us for the packet to get from NIC to user space";
+        recvTs = hwRecvTs;
+      } else if (swRecvTs.count()) {
+        VLOG(4) << "Got kernel-timestamp. It took "
+                << (recvTs - swRecvTs).count()
+                << " us for the packet to get from kernel to user space";
+        recvTs = swRecvTs;
+      }
+    }
+  } // for
+
+  DCHECK(ifIndex != -1) << "ifIndex is not found";
+  DCHECK(hopLimit) << "hopLimit is not found";
+}
+
+} // namespace
+
 int
 IoProvider::socket(int domain, int type, int protocol) {
   return ::socket(domain, type, protocol);
@@ -70,6 +243,22 @@ IoProvider::sendmsg(int sockfd, const struct msghdr* msg, int flags) {
   return ::sendmsg(sockfd, msg, flags);
 }
 
+int
+IoProvider::recvmmsg(
+    int sockfd,
+    struct mmsghdr* msgvec,
+    unsigned int vlen,
+    int flags,
+    struct timespec* timeout) {
+  return ::recvmmsg(sockfd, msgvec, vlen, flags, timeout);
+}
+
+int
+IoProvider::sendmmsg(
+    int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+  return ::sendmmsg(sockfd, msgvec, vlen, flags);
+}
+
 std::tuple<
     ssize_t /* size */,
     int /* ifIndex */,
@@ -78,46 +267,19 @@ std::tuple<
     std::chrono::microseconds /* kernel timestamp */>
 IoProvider::recvMessage(
     int fd, unsigned char* buf, int len, openr::IoProvider* ioProvider) {
-  // the control message buffer
-  // XXX: hardcoded, but this hardly should be a problem
-  union {
-    char ctrlBuf[CMSG_SPACE(1024)];
-    struct cmsghdr align;
-  } u;
-
   // the message header to receive into
   struct msghdr msg;
 
   // the IO vector for data to be received with recvmsg
   struct iovec entry;
 
+  // the control message buffer
+  RecvControl control;
+
   // for address of the sender
   sockaddr_storage addrStorage;
 
-  ::memset(&msg, 0, sizeof(msg));
-
-  // we only expect to receive one block of data, single entry
-  // in the vector
-  msg.msg_iov = &entry;
-  msg.msg_iovlen = 1;
-
-  // this part is important - if we don't zero the buffer,
-  // the CMSG_NXTHDR may burp, because it tries extracting
-  // fields from "next header" in the buffer
-  ::memset(&u.ctrlBuf[0], 0, sizeof(u.ctrlBuf));
-
-  // control message buffer used to receive dest IP from the kernel
-  msg.msg_control = u.ctrlBuf;
-  msg.msg_controllen = sizeof(u.ctrlBuf);
-
-  // prepare to receive either v4 or v6 addresses
-  ::memset(&addrStorage, 0, sizeof(addrStorage));
-  msg.msg_name = &addrStorage;
-  msg.msg_namelen = sizeof(sockaddr_storage);
-
-  // write the data here
-  entry.iov_base = buf;
-  entry.iov_len = len;
+  prepareRecvMessage(msg, entry, control, addrStorage, buf, len);
 
   ssize_t bytesRead = ioProvider->recvmsg(fd, &msg, MSG_DONTWAIT);
 
@@ -130,64 +292,73 @@ IoProvider::recvMessage(
     throw std::runtime_error("Message truncated");
   }
 
-  // grab the inIndex we received this packet on and the hopLimit
-  // those are available since we requested them via socket options
-  struct cmsghdr* cmsg{nullptr};
   int ifIndex{-1};
   int hopLimit{0};
-
-  // use user space timestamp if kernel timestamp is not found
-  std::chrono::microseconds recvTs{
-      std::chrono::duration_cast<std::chrono::microseconds>(
-          std::chrono::system_clock::now().time_since_epoch())};
-
-  for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-    if (cmsg->cmsg_level == IPPROTO_IPV6) {
-      if (cmsg->cmsg_type == IPV6_PKTINFO) {
-        struct in6_pktinfo pktinfo;
-        memcpy(
-            reinterpret_cast<void*>(&pktinfo),
-            CMSG_DATA(cmsg),
-            sizeof(pktinfo));
-        ifIndex = pktinfo.ipi6_ifindex;
-      } else if (cmsg->cmsg_type == IPV6_HOPLIMIT) {
-        memcpy(
-            reinterpret_cast<void*>(&hopLimit),
-            CMSG_DATA(cmsg),
-            sizeof(hopLimit));
-      }
-    }
-    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPNS) {
-      struct timespec ts {
-        0, 0
-      };
-      memcpy(reinterpret_cast<void*>(&ts), CMSG_DATA(cmsg), sizeof(ts));
-
-      // cast to int64_t since ts.tv_sec is 32 bits on some platforms like arm
-      const int64_t usecs =
-          static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
-      const std::chrono::microseconds kernelRecvTs(usecs);
-
-      // sanity check
-      DCHECK(recvTs >= kernelRecvTs) << "Time anomaly";
-      VLOG(4) << "Got kernel-timestamp. It took "
-              << (recvTs - kernelRecvTs).count()
-              << " us for the packet to get from kernel to user space";
-      recvTs = kernelRecvTs;
-    }
-  } // for
+  std::chrono::microseconds recvTs{0};
+  parseRecvControl(msg, ifIndex, hopLimit, recvTs);
 
   // build the source socket address from recvmsg data
   folly::SocketAddress srcAddr{};
   // this will throw if sender address was not filled in
   srcAddr.setFromSockaddr(reinterpret_cast<struct sockaddr*>(&addrStorage));
 
-  DCHECK(ifIndex != -1) << "ifIndex is not found";
-  DCHECK(hopLimit) << "hopLimit is not found";
-
   return std::make_tuple(bytesRead, ifIndex, srcAddr, hopLimit, recvTs);
 }
 
+std::vector<IoProvider::IncomingMessage>
+IoProvider::recvMessages(
+    int fd, size_t maxMessages, size_t len, IoProvider* ioProvider) {
+  std::vector<IncomingMessage> messages;
+  if (maxMessages == 0) {
+    return messages;
+  }
+
+  std::vector<unsigned char> bufs(maxMessages * len);
+  std::vector<struct mmsghdr> msgs(maxMessages);
+  std::vector<struct iovec> entries(maxMessages);
+  std::vector<RecvControl> controls(maxMessages);
+  std::vector<sockaddr_storage> addrStorages(maxMessages);
+  for (size_t i = 0; i < maxMessages; ++i) {
+    prepareRecvMessage(
+        msgs[i].msg_hdr,
+        entries[i],
+        controls[i],
+        addrStorages[i],
+        bufs.data() + i * len,
+        len);
+    msgs[i].msg_len = 0;
+  }
+
+  int numRecvd =
+      ioProvider->recvmmsg(fd, msgs.data(), maxMessages, MSG_DONTWAIT, nullptr);
+  if (numRecvd < 0) {
+    if (errno == EAGAIN or errno == EWOULDBLOCK) {
+      return messages;
+    }
+    throw std::runtime_error(folly::sformat(
+        "Failed reading messages on fd {}: {}", fd, folly::errnoStr(errno)));
+  }
+
+  messages.reserve(numRecvd);
+  for (int i = 0; i < numRecvd; ++i) {
+    auto& msg = msgs[i].msg_hdr;
+    if (msg.msg_flags & MSG_TRUNC) {
+      LOG(ERROR) << "Dropping truncated message received on fd " << fd;
+      continue;
+    }
+
+    IncomingMessage message;
+    parseRecvControl(msg, message.ifIndex, message.hopLimit, message.recvTs);
+    // this will throw if sender address was not filled in
+    message.srcAddr.setFromSockaddr(
+        reinterpret_cast<struct sockaddr*>(&addrStorages[i]));
+    message.packet.assign(
+        reinterpret_cast<const char*>(bufs.data() + i * len), msgs[i].msg_len);
+    messages.emplace_back(std::move(message));
+  }
+  return messages;
+}
+
 ssize_t
 IoProvider::sendMessage(
     int fd,
@@ -197,46 +368,69 @@ IoProvider::sendMessage(
     std::string const& packet,
     IoProvider* ioProvider) {
   struct msghdr msg;
-  struct cmsghdr* cmsg{nullptr};
-
-  // pack control buffer, aligned by control message hdr
-  union {
-    char cbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
-    struct cmsghdr align;
-  } u;
+  struct iovec entry;
+  PktInfoControl control;
 
   // Set the destination address for the message
   sockaddr_storage addrStorage;
   dstAddr.getAddress(&addrStorage);
 
-  ::memset(&msg, 0, sizeof(msg));
-  msg.msg_name = reinterpret_cast<void*>(&addrStorage);
-  msg.msg_namelen = dstAddr.getActualSize();
-
-  // set the source address and source if index for this message
-  // this goes into ancilliary data fields
-  msg.msg_control = u.cbuf;
-  msg.msg_controllen = sizeof(u.cbuf);
-  cmsg = CMSG_FIRSTHDR(&msg);
+  fillMessage(
+      msg,
+      entry,
+      control,
+      addrStorage,
+      dstAddr.getActualSize(),
+      ifIndex,
+      srcAddr,
+      packet);
 
-  cmsg->cmsg_level = IPPROTO_IPV6;
-  cmsg->cmsg_type = IPV6_PKTINFO;
-  cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
+  return ioProvider->sendmsg(fd, &msg, MSG_DONTWAIT);
+}
 
-  auto pktinfo = (struct in6_pktinfo*)CMSG_DATA(cmsg);
-  pktinfo->ipi6_ifindex = ifIndex;
-  ::memcpy(&pktinfo->ipi6_addr, srcAddr.bytes(), srcAddr.byteCount());
+int
+IoProvider::sendMessages(
+    int fd,
+    folly::SocketAddress dstAddr,
+    std::vector<OutgoingMessage> const& messages,
+    IoProvider* ioProvider) {
+  if (messages.empty()) {
+    return 0;
+  }
 
-  // the IO vector for data to be sent
-  struct iovec entry;
-  msg.msg_iov = &entry;
-  msg.msg_iovlen = 1;
+  // Destination address is shared by all messages
+  sockaddr_storage addrStorage;
+  dstAddr.getAddress(&addrStorage);
 
-  // write the data here (we need to remove the const qualifier)
-  entry.iov_base = const_cast<char*>(packet.data());
-  entry.iov_len = packet.size();
+  std::vector<struct mmsghdr> msgs(messages.size());
+  std::vector<struct iovec> entries(messages.size());
+  std::vector<PktInfoControl> controls(messages.size());
+  for (size_t i = 0; i < messages.size(); ++i) {
+    auto const& message = messages.at(i);
+    fillMessage(
+        msgs[i].msg_hdr,
+        entries[i],
+        controls[i],
+        addrStorage,
+        dstAddr.getActualSize(),
+        message.ifIndex,
+        message.srcAddr,
+        message.packet);
+    msgs[i].msg_len = 0;
+  }
 
-  return ioProvider->sendmsg(fd, &msg, MSG_DONTWAIT);
+  // sendmmsg may send fewer messages than asked for. Continue with remaining
+  // ones till an error.
+  int numSent{0};
+  while (static_cast<size_t>(numSent) < msgs.size()) {
+    auto ret = ioProvider->sendmmsg(
+        fd, msgs.data() + numSent, msgs.size() - numSent, MSG_DONTWAIT);
+    if (ret <= 0) {
+      return numSent ? numSent : -1;
+    }
+    numSent += ret;
+  }
+  return numSent;
 }
 
 } // namespace openr
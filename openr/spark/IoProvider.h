@@ -13,6 +13,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <chrono>
+#include <string>
+#include <vector>
 
 #include <folly/IPAddress.h>
 #include <folly/SocketAddress.h>
@@ -57,8 +59,18 @@ class IoProvider {
 
   virtual ssize_t recvmsg(int sockfd, struct msghdr* msg, int flags);
 
+  virtual int recvmmsg(
+      int sockfd,
+      struct mmsghdr* msgvec,
+      unsigned int vlen,
+      int flags,
+      struct timespec* timeout);
+
   virtual ssize_t sendmsg(int sockfd, const struct msghdr* msg, int flags);
 
+  virtual int sendmmsg(
+      int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags);
+
   virtual int setsockopt(
       int sockfd, int level, int optname, const void* optval, socklen_t optlen);
 
@@ -76,6 +88,23 @@ class IoProvider {
       std::chrono::microseconds /* kernel timestamp */>
   recvMessage(int fd, unsigned char* buf, int len, IoProvider* ioProvider);
 
+  struct IncomingMessage {
+    int ifIndex{-1};
+    folly::SocketAddress srcAddr;
+    int hopLimit{0};
+    std::chrono::microseconds recvTs{0};
+    std::string packet;
+  };
+
+  /*
+   * Batched version of recvMessage. Receives up to maxMessages pending
+   * messages of at most len bytes each in a single syscall, without blocking.
+   * Truncated messages are dropped. Returns empty vector if there is no
+   * pending message.
+   */
+  static std::vector<IncomingMessage> recvMessages(
+      int fd, size_t maxMessages, size_t len, IoProvider* ioProvider);
+
   /*
    * Send message on fd via given interface to the address provided
    * We supply socket address, which has dst IPv6 and port
@@ -88,6 +117,23 @@ class IoProvider {
       std::string const& packet,
       IoProvider* ioProvider);
 
+  struct OutgoingMessage {
+    int ifIndex{0};
+    folly::IPAddressV6 srcAddr;
+    std::string packet;
+  };
+
+  /*
+   * Batched version of sendMessage. Sends all messages to the same address,
+   * each via its own interface, in as few syscalls as possible. Returns number
+   * of messages sent, which are the leading ones, or -1 if none could be sent.
+   */
+  static int sendMessages(
+      int fd,
+      folly::SocketAddress dstAddr,
+      std::vector<OutgoingMessage> const& messages,
+      IoProvider* ioProvider);
+
  private:
   IoProvider(IoProvider const&) = delete;
   IoProvider& operator=(IoProvider const&) = delete;
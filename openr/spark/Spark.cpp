@@ -8,6 +8,7 @@
 #include "Spark.h"
 
 #include <ifaddrs.h>
+#include <linux/net_tstamp.h>
 #include <net/if.h>
 #include <netinet/in.h>
 #include <sodium.h>
@@ -15,6 +16,7 @@
 #include <fcntl.h>
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <vector>
 
 #include <fb303/ServiceData.h>
@@ -27,10 +29,12 @@
 #include <folly/ScopeGuard.h>
 #include <folly/SocketAddress.h>
 #include <folly/String.h>
+#include <folly/Varint.h>
 #include <folly/fibers/FiberManagerMap.h>
 #include <folly/futures/Future.h>
 #include <folly/futures/Promise.h>
 #include <folly/gen/Base.h>
+#include <folly/lang/Bits.h>
 #include <openr/if/gen-cpp2/KvStore_constants.h>
 
 #include <openr/common/Constants.h>
@@ -68,9 +72,287 @@ const uint8_t kHiThreshold = 5;
 // absolute step threshold, in microseconds
 const int64_t kAbsThreshold = 500;
 
+// Compact heartbeat packet. Heartbeats are sent all the time on every
+// adjacency and carry only node name and seq#, so they have a fixed layout
+// which is parsed with a few loads instead of thrift decoding:
+//
+//   offset 0: magic (1 byte)
+//   offset 1: version (1 byte)
+//   offset 2: length of node name (2 bytes, network order)
+//   offset 4: seq# (8 bytes, network order)
+//   offset 12: node name (version 1)
+//
+// Version 2 carries hold time as well:
+//
+//   offset 12: hold time in milliseconds (4 bytes, network order)
+//   offset 16: node name
+//
+// Magic has an invalid field type of thrift compact protocol, hence it is
+// never the first byte of a serialized SparkHelloPacket.
+const uint8_t kCompactHeartbeatMagic = 0xFE;
+const uint8_t kCompactHeartbeatVersion = 1;
+const uint8_t kCompactHeartbeatHoldTimeVersion = 2;
+const size_t kCompactHeartbeatHdrLen = 12;
+const size_t kCompactHeartbeatHoldTimeHdrLen = 16;
+
+std::string
+writeCompactHeartbeat(thrift::SparkHeartbeatMsg const& heartbeatMsg) {
+  auto const& nodeName = heartbeatMsg.nodeName;
+  CHECK_LE(nodeName.size(), std::numeric_limits<uint16_t>::max());
+  const auto holdTime = heartbeatMsg.holdTime_ref();
+  const size_t hdrLen =
+      holdTime ? kCompactHeartbeatHoldTimeHdrLen : kCompactHeartbeatHdrLen;
+
+  std::string packet(hdrLen + nodeName.size(), '\0');
+  const uint16_t nodeNameLen = folly::Endian::big<uint16_t>(nodeName.size());
+  const uint64_t seqNum = folly::Endian::big<uint64_t>(heartbeatMsg.seqNum);
+  packet[0] = static_cast<char>(kCompactHeartbeatMagic);
+  packet[1] = static_cast<char>(
+      holdTime ? kCompactHeartbeatHoldTimeVersion : kCompactHeartbeatVersion);
+  ::memcpy(&packet[2], &nodeNameLen, sizeof(nodeNameLen));
+  ::memcpy(&packet[4], &seqNum, sizeof(seqNum));
+  if (holdTime) {
+    CHECK(*holdTime >= 0 and *holdTime <= std::numeric_limits<uint32_t>::max());
+    const uint32_t holdTimeMs = folly::Endian::big<uint32_t>(*holdTime);
+    ::memcpy(&packet[12], &holdTimeMs, sizeof(holdTimeMs));
+  }
+  ::memcpy(&packet[hdrLen], nodeName.data(), nodeName.size());
+  return packet;
+}
+
+bool
+isCompactHeartbeat(std::string const& packet) {
+  return not packet.empty() and
+      static_cast<uint8_t>(packet[0]) == kCompactHeartbeatMagic;
+}
+
+// Returns none if packet is malformed or of unknown version
+std::optional<thrift::SparkHeartbeatMsg>
+readCompactHeartbeat(std::string const& packet) {
+  if (packet.size() < kCompactHeartbeatHdrLen) {
+    return std::nullopt;
+  }
+  const auto version = static_cast<uint8_t>(packet[1]);
+  size_t hdrLen{0};
+  if (version == kCompactHeartbeatVersion) {
+    hdrLen = kCompactHeartbeatHdrLen;
+  } else if (version == kCompactHeartbeatHoldTimeVersion) {
+    hdrLen = kCompactHeartbeatHoldTimeHdrLen;
+  } else {
+    return std::nullopt;
+  }
+
+  uint16_t nodeNameLen{0};
+  uint64_t seqNum{0};
+  ::memcpy(&nodeNameLen, &packet[2], sizeof(nodeNameLen));
+  ::memcpy(&seqNum, &packet[4], sizeof(seqNum));
+  nodeNameLen = folly::Endian::big(nodeNameLen);
+  if (nodeNameLen == 0 or packet.size() != hdrLen + nodeNameLen) {
+    return std::nullopt;
+  }
+
+  thrift::SparkHeartbeatMsg heartbeatMsg;
+  heartbeatMsg.nodeName = packet.substr(hdrLen);
+  heartbeatMsg.seqNum = folly::Endian::big(seqNum);
+  if (version == kCompactHeartbeatHoldTimeVersion) {
+    uint32_t holdTimeMs{0};
+    ::memcpy(&holdTimeMs, &packet[12], sizeof(holdTimeMs));
+    heartbeatMsg.holdTime_ref() = folly::Endian::big(holdTimeMs);
+  }
+  return heartbeatMsg;
+}
+
+// Compact hello packet. Hellos carry an entry for every neighbor heard on the
+// interface, and thrift repeats field headers and full width integers in each
+// entry. Compact hello is a versioned, length-prefixed layout of varints:
+//
+//   magic (1 byte), version (1 byte), flags (1 byte)
+//   seq#, openr version, sent timestamp (varints)
+//   domain name, node name, interface name (varint length, bytes)
+//   number of neighbors (varint), followed for each neighbor by
+//     neighbor name (varint length, bytes)
+//     seq# and sent timestamp last heard from neighbor (varints)
+//     sent timestamp minus last receive timestamp (zigzag varint)
+//
+// Receive timestamps are taken on clock of sender, like sent timestamp, so
+// they are sent as offsets of a few bytes. Magic is an invalid field type of
+// thrift compact protocol, like kCompactHeartbeatMagic.
+const uint8_t kCompactHelloMagic = 0xFD;
+const uint8_t kCompactHelloVersion = 1;
+const size_t kCompactHelloHdrLen = 3;
+const uint8_t kCompactHelloSolicitResponse = 0x1;
+const uint8_t kCompactHelloRestarting = 0x2;
+
+void
+appendVarint(std::string& packet, uint64_t value) {
+  uint8_t buf[folly::kMaxVarintLength64];
+  const auto len = folly::encodeVarint(value, buf);
+  packet.append(reinterpret_cast<const char*>(buf), len);
+}
+
+void
+appendString(std::string& packet, std::string const& str) {
+  appendVarint(packet, str.size());
+  packet.append(str);
+}
+
+bool
+readVarint(folly::ByteRange& data, uint64_t& value) {
+  auto maybeValue = folly::tryDecodeVarint(data);
+  if (maybeValue.hasError()) {
+    return false;
+  }
+  value = maybeValue.value();
+  return true;
+}
+
+bool
+readString(folly::ByteRange& data, std::string& str) {
+  uint64_t len{0};
+  if (not readVarint(data, len) or len > data.size()) {
+    return false;
+  }
+  str.assign(reinterpret_cast<const char*>(data.data()), len);
+  data.advance(len);
+  return true;
+}
+
+std::string
+writeCompactHello(thrift::SparkHelloMsg const& helloMsg) {
+  uint8_t flags{0};
+  if (helloMsg.solicitResponse) {
+    flags |= kCompactHelloSolicitResponse;
+  }
+  if (helloMsg.restarting) {
+    flags |= kCompactHelloRestarting;
+  }
+
+  std::string packet;
+  packet.push_back(static_cast<char>(kCompactHelloMagic));
+  packet.push_back(static_cast<char>(kCompactHelloVersion));
+  packet.push_back(static_cast<char>(flags));
+  appendVarint(packet, helloMsg.seqNum);
+  appendVarint(packet, static_cast<uint32_t>(helloMsg.version));
+  appendVarint(packet, helloMsg.sentTsInUs);
+  appendString(packet, helloMsg.domainName);
+  appendString(packet, helloMsg.nodeName);
+  appendString(packet, helloMsg.ifName);
+  appendVarint(packet, helloMsg.neighborInfos.size());
+  for (auto const& kv : helloMsg.neighborInfos) {
+    auto const& neighborInfo = kv.second;
+    appendString(packet, kv.first);
+    appendVarint(packet, neighborInfo.seqNum);
+    appendVarint(packet, neighborInfo.lastNbrMsgSentTsInUs);
+    appendVarint(
+        packet,
+        folly::encodeZigZag(
+            helloMsg.sentTsInUs - neighborInfo.lastMyMsgRcvdTsInUs));
+  }
+  return packet;
+}
+
+bool
+isCompactHello(std::string const& packet) {
+  return not packet.empty() and
+      static_cast<uint8_t>(packet[0]) == kCompactHelloMagic;
+}
+
+// Returns none if packet is malformed or of unknown version
+std::optional<thrift::SparkHelloMsg>
+readCompactHello(std::string const& packet) {
+  if (packet.size() < kCompactHelloHdrLen or
+      static_cast<uint8_t>(packet[1]) != kCompactHelloVersion) {
+    return std::nullopt;
+  }
+  const auto flags = static_cast<uint8_t>(packet[2]);
+  folly::ByteRange data{folly::StringPiece(packet)};
+  data.advance(kCompactHelloHdrLen);
+
+  thrift::SparkHelloMsg helloMsg;
+  helloMsg.solicitResponse = flags & kCompactHelloSolicitResponse;
+  helloMsg.restarting = flags & kCompactHelloRestarting;
+  uint64_t seqNum{0};
+  uint64_t version{0};
+  uint64_t sentTsInUs{0};
+  uint64_t numNeighbors{0};
+  if (not readVarint(data, seqNum) or not readVarint(data, version) or
+      not readVarint(data, sentTsInUs) or
+      not readString(data, helloMsg.domainName) or
+      not readString(data, helloMsg.nodeName) or
+      not readString(data, helloMsg.ifName) or
+      not readVarint(data, numNeighbors) or helloMsg.nodeName.empty() or
+      numNeighbors > data.size()) {
+    return std::nullopt;
+  }
+  helloMsg.seqNum = seqNum;
+  helloMsg.version = static_cast<thrift::OpenrVersion>(version);
+  helloMsg.sentTsInUs = sentTsInUs;
+
+  for (uint64_t i = 0; i < numNeighbors; ++i) {
+    std::string neighborName;
+    uint64_t nbrSeqNum{0};
+    uint64_t lastNbrMsgSentTsInUs{0};
+    uint64_t lastMyMsgRcvdOffset{0};
+    if (not readString(data, neighborName) or
+        not readVarint(data, nbrSeqNum) or
+        not readVarint(data, lastNbrMsgSentTsInUs) or
+        not readVarint(data, lastMyMsgRcvdOffset)) {
+      return std::nullopt;
+    }
+    auto& neighborInfo = helloMsg.neighborInfos[neighborName];
+    neighborInfo.seqNum = nbrSeqNum;
+    neighborInfo.lastNbrMsgSentTsInUs = lastNbrMsgSentTsInUs;
+    neighborInfo.lastMyMsgRcvdTsInUs =
+        helloMsg.sentTsInUs - folly::decodeZigZag(lastMyMsgRcvdOffset);
+  }
+  if (not data.empty()) {
+    return std::nullopt;
+  }
+  return helloMsg;
+}
+
+// how long to keep sending adaptive heartbeats after the last sign of link
+// degradation
+const std::chrono::seconds kAdaptiveHeartbeatDuration{60};
+
+// max number of packets to receive per wakeup of the socket
+const size_t kMaxPacketsPerRecv = 64;
+
+// max number of packets queued by I/O thread for Spark thread. Oldest are
+// dropped beyond it, alike socket buffer overflow.
+const size_t kMaxPendingPackets = 4096;
+
+// tick and number of slots of timing wheel of neighbor timers, for rotation
+// of ~10s. Timers are fired at most a tick late.
+const std::chrono::milliseconds kNeighborTimerTick{10};
+const size_t kNumNeighborTimerSlots = 1024;
+
 // number of restarting packets to send out per interface before I'm going down
 const int kNumRestartingPktSent = 3;
 
+// max delay of periodic hello packets, so that packets of interfaces due at
+// about the same time are sent in a single batch
+const std::chrono::milliseconds kHelloBatchWindow{10};
+
+// Counter key suffix of packet validation result
+std::string
+packetValidationResultToStr(PacketValidationResult result) {
+  switch (result) {
+  case PacketValidationResult::SUCCESS:
+    return "success";
+  case PacketValidationResult::FAILURE:
+    return "failure";
+  case PacketValidationResult::NEIGHBOR_RESTART:
+    return "neighbor_restart";
+  case PacketValidationResult::SKIP_LOOPED_SELF:
+    return "looped_self";
+  case PacketValidationResult::INVALID_AREA_CONFIGURATION:
+    return "invalid_area";
+  default:
+    return "unknown";
+  }
+}
+
 //
 // Function to get current timestamp in microseconds using steady clock
 // NOTE: we use non-monotonic clock since kernel time-stamps do not support
@@ -322,6 +604,9 @@ Spark::Spark(
       enableFloodOptimization_(enableFloodOptimization),
       enableSpark2_(enableSpark2),
       increaseHelloInterval_(increaseHelloInterval),
+      receivedPacketsQueue_(
+          messaging::ReaderOptions<IoProvider::IncomingMessage>{
+              kMaxPendingPackets}),
       ioProvider_(std::move(ioProvider)),
       config_(std::move(config)) {
   CHECK(myHoldTime_ >= 3 * myKeepAliveTime)
@@ -360,9 +645,31 @@ Spark::Spark(
     }
   });
 
+  // Initialize timing wheel of neighbor timers
+  neighborTimerWheel_ = std::make_unique<TimerWheel>(
+      getEvb(), kNeighborTimerTick, kNumNeighborTimerSlots);
+
   // Initialize UDP socket for neighbor discovery
   prepareSocket(maybeIpTos);
 
+  // Fiber to process packets received by I/O thread
+  if (enableIoThread_) {
+    addFiberTask([this]() mutable noexcept {
+      while (true) {
+        auto messages = receivedPacketsQueue_.getBatch(kMaxPacketsPerRecv);
+        if (messages.hasError()) {
+          LOG(INFO) << "Terminating received packets processing fiber";
+          break;
+        }
+        processPackets(messages.value());
+      }
+    });
+  }
+
+  // Timer to send hello packets queued on all interfaces in one batch
+  helloBatchTimer_ = fbzmq::ZmqTimeout::make(
+      getEvb(), [this]() noexcept { flushHelloPackets(); });
+
   // Initialize some stat keys
   fb303::fbData->addStatExportType(
       "spark.invalid_keepalive.different_domain", fb303::SUM);
@@ -374,6 +681,29 @@ Spark::Spark(
       "spark.invalid_keepalive.different_subnet", fb303::SUM);
   fb303::fbData->addStatExportType(
       "spark.invalid_keepalive.looped_packet", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "spark.hello_packet_recv_batch", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "spark.heartbeat.compact_packets_recv", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "spark.heartbeat.adaptive_tightened", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "spark.heartbeat.adaptive_relaxed", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "spark.hello_packet_recv_batch_size", fb303::AVG);
+
+  // Latency of packets since arrival, to tell Spark falling behind from
+  // network issues. Percentile 100 is exported as max latency in window.
+  for (auto const& key :
+       {"spark.latency.packet_processed_us",
+        "spark.latency.packet_to_transition_us"}) {
+    fb303::fbData->addHistogram(
+        key,
+        Constants::kSparkLatencyBucketWidth.count(),
+        0,
+        Constants::kSparkLatencyMax.count());
+    fb303::fbData->exportHistogramPercentile(key, 50, 99, 100);
+  }
 }
 
 // static util function to transform state into str
@@ -407,16 +737,27 @@ Spark::stop() {
   // send out restarting packets for all interfaces before I'm going down
   // here we are sending duplicate restarting packets (3 times per interface)
   // in case some packets get lost
+  std::vector<std::string> ifNames;
+  for (const auto& kv : interfaceDb_) {
+    ifNames.emplace_back(kv.first);
+  }
   for (int i = 0; i < kNumRestartingPktSent; ++i) {
-    for (const auto& kv : interfaceDb_) {
-      const auto& ifName = kv.first;
-      sendHelloPacket(
-          ifName, false /* inFastInitState */, true /* restarting */);
-    }
+    sendHelloPackets(
+        ifNames, false /* inFastInitState */, true /* restarting */);
   }
 
   LOG(INFO)
       << "I have sent all restarting packets to my neighbors, ready to go down";
+
+  // stop receiving before processing fiber terminates
+  if (ioEvb_) {
+    ioEvb_->stop();
+    ioEvb_->waitUntilStopped();
+    ioThread_.join();
+    ioEvb_.reset();
+  }
+  receivedPacketsQueue_.close();
+
   OpenrEventBase::stop();
 }
 
@@ -523,9 +864,26 @@ Spark::prepareSocket(std::optional<int> maybeIpTos) noexcept {
                << folly::errnoStr(errno);
   }
 
+  // enable hardware receive timestamps, with software ones as fallback on
+  // NICs without support. Hardware clock must be synced to system clock.
+  bool hwTimestamping{false};
+  if (enableHwTimestamping_) {
+    const int flags = SOF_TIMESTAMPING_RX_HARDWARE |
+        SOF_TIMESTAMPING_RAW_HARDWARE | SOF_TIMESTAMPING_RX_SOFTWARE |
+        SOF_TIMESTAMPING_SOFTWARE;
+    if (ioProvider_->setsockopt(
+            fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0) {
+      hwTimestamping = true;
+    } else {
+      LOG(ERROR) << "Failed to enable hardware timestamping, falling back to "
+                 << "kernel timestamping. Error: " << folly::errnoStr(errno);
+    }
+  }
+
   // enable timestamping for this socket
   const int enabled = 1;
-  if (ioProvider_->setsockopt(
+  if (not hwTimestamping and
+      ioProvider_->setsockopt(
           fd, SOL_SOCKET, SO_TIMESTAMPNS, &enabled, sizeof(enabled)) != 0) {
     LOG(ERROR) << "Failed to enable kernel timestamping. Measured RTTs are "
                << "likely to have more noise in them. Error: "
@@ -535,14 +893,32 @@ Spark::prepareSocket(std::optional<int> maybeIpTos) noexcept {
   LOG(INFO) << "Spark thread attaching socket/events callbacks...";
 
   // Listen for incoming messages on multicast FD
-  addSocketFd(mcastFd_, ZMQ_POLLIN, [this](int) noexcept {
-    try {
-      processPacket();
-    } catch (std::exception const& err) {
-      LOG(ERROR) << "Spark: error processing hello packet "
-                 << folly::exceptionStr(err);
-    }
-  });
+  if (enableIoThread_) {
+    ioEvb_ = std::make_unique<OpenrEventBase>();
+    ioEvb_->addSocketFd(mcastFd_, ZMQ_POLLIN, [this](int) noexcept {
+      try {
+        receivePackets();
+      } catch (std::exception const& err) {
+        LOG(ERROR) << "Spark: error receiving hello packet "
+                   << folly::exceptionStr(err);
+      }
+    });
+    ioThread_ = std::thread([this]() {
+      LOG(INFO) << "Spark I/O thread running.";
+      ioEvb_->run();
+      LOG(INFO) << "Spark I/O thread stopped.";
+    });
+    ioEvb_->waitUntilRunning();
+  } else {
+    addSocketFd(mcastFd_, ZMQ_POLLIN, [this](int) noexcept {
+      try {
+        processPacket();
+      } catch (std::exception const& err) {
+        LOG(ERROR) << "Spark: error processing hello packet "
+                   << folly::exceptionStr(err);
+      }
+    });
+  }
 
   // update counters every few seconds
   counterUpdateTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
@@ -603,6 +979,9 @@ Spark::addAreaRegex(
   }
   areaIdRegexList_.emplace_back(std::make_tuple(
       areaId, std::move(neighborRegexList), std::move(interfaceRegexList)));
+
+  // previously deduced areas may not hold anymore
+  neighborAreaCache_.clear();
 }
 
 // parse openrConfig to initialize:
@@ -624,6 +1003,43 @@ Spark::loadConfig() {
         areaConfig.neighbor_regexes,
         areaConfig.interface_regexes);
   }
+
+  auto const& sparkConfig = config_->spark_config;
+  enableCompactHeartbeat_ = sparkConfig.compact_heartbeat;
+  enableCompactHello_ = sparkConfig.compact_hello;
+  enableIoThread_ = sparkConfig.enable_io_thread;
+  enableHwTimestamping_ = sparkConfig.enable_hw_timestamping;
+  enableAdaptiveHeartbeat_ = sparkConfig.enable_adaptive_heartbeat;
+  adaptiveHeartbeatTime_ =
+      std::chrono::milliseconds(sparkConfig.adaptive_heartbeat_time_ms);
+  adaptiveHeartbeatHoldTime_ =
+      std::chrono::milliseconds(sparkConfig.adaptive_heartbeat_hold_time_ms);
+  if (enableAdaptiveHeartbeat_) {
+    CHECK_GT(adaptiveHeartbeatTime_.count(), 0)
+        << "adaptive-heartbeat-time can't be 0";
+    CHECK(adaptiveHeartbeatHoldTime_ >= 3 * adaptiveHeartbeatTime_)
+        << "adaptive-heartbeat-time must be less than "
+        << "adaptive-heartbeat-hold-time.";
+  }
+}
+
+folly::SemiFuture<folly::Unit>
+Spark::reloadAreaConfig(std::vector<thrift::AreaConfig> areas) {
+  folly::Promise<folly::Unit> promise;
+  auto sf = promise.getSemiFuture();
+  runInEventBaseThread(
+      [this, promise = std::move(promise), areas = std::move(areas)]() mutable {
+        areaIdRegexList_.clear();
+        for (const auto& areaConfig : areas) {
+          addAreaRegex(
+              areaConfig.area_id,
+              areaConfig.neighbor_regexes,
+              areaConfig.interface_regexes);
+        }
+        LOG(INFO) << "Reloaded regexes of " << areas.size() << " areas";
+        promise.setValue();
+      });
+  return sf;
 }
 
 PacketValidationResult
@@ -846,19 +1262,13 @@ Spark::shouldProcessHelloPacket(
 
 bool
 Spark::parsePacket(
+    IoProvider::IncomingMessage const& message,
     thrift::SparkHelloPacket& pkt,
-    std::string& ifName,
-    std::chrono::microseconds& recvTime) {
-  // the read buffer
-  uint8_t buf[kMinIpv6Mtu];
-
-  ssize_t bytesRead;
-  int ifIndex;
-  folly::SocketAddress clientAddr;
-  int hopLimit;
-
-  std::tie(bytesRead, ifIndex, clientAddr, hopLimit, recvTime) =
-      IoProvider::recvMessage(mcastFd_, buf, kMinIpv6Mtu, ioProvider_.get());
+    std::string& ifName) {
+  const auto bytesRead = message.packet.size();
+  const auto ifIndex = message.ifIndex;
+  const auto hopLimit = message.hopLimit;
+  auto const& clientAddr = message.srcAddr;
 
   if (hopLimit < kSparkHopLimit) {
     LOG(ERROR) << "Rejecting packet from " << clientAddr.getAddressStr()
@@ -880,11 +1290,10 @@ Spark::parsePacket(
           << " from " << clientAddr.getAddressStr();
 
   // update counters for packets received, dropped and processed
-  fb303::fbData->addStatValue("spark.hello_packet_recv", 1, fb303::SUM);
+  helloPacketsRecv_.add();
 
   // update counters for total size of packets received
-  fb303::fbData->addStatValue(
-      "spark.hello_packet_recv_size", bytesRead, fb303::SUM);
+  helloPacketsRecvSize_.add(bytesRead);
 
   if (!shouldProcessHelloPacket(ifName, clientAddr.getIPAddress())) {
     LOG(ERROR) << "Spark: dropping hello packet due to rate limiting on iface: "
@@ -893,27 +1302,40 @@ Spark::parsePacket(
     return false;
   }
 
-  fb303::fbData->addStatValue("spark.hello_packet_processed", 1, fb303::SUM);
+  helloPacketsProcessed_.add();
 
-  if (bytesRead >= 0) {
-    VLOG(4) << "Read a total of " << bytesRead << " bytes from fd " << mcastFd_;
+  VLOG(4) << "Read a total of " << bytesRead << " bytes from fd " << mcastFd_;
 
-    if (static_cast<size_t>(bytesRead) > kMinIpv6Mtu) {
-      LOG(ERROR) << "Message from " << clientAddr.getAddressStr()
-                 << " has been truncated";
+  // fast path for heartbeats, skipping thrift decoding
+  if (isCompactHeartbeat(message.packet)) {
+    auto heartbeatMsg = readCompactHeartbeat(message.packet);
+    if (not heartbeatMsg.has_value()) {
+      LOG(ERROR) << "Failed parsing compact heartbeat packet from "
+                 << clientAddr.getAddressStr();
       return false;
     }
-  } else {
-    LOG(ERROR) << "Failed reading from fd " << mcastFd_ << " error "
-               << folly::errnoStr(errno);
-    return false;
+    fb303::fbData->addStatValue(
+        "spark.heartbeat.compact_packets_recv", 1, fb303::SUM);
+    pkt.heartbeatMsg_ref() = std::move(heartbeatMsg).value();
+    return true;
+  }
+
+  if (isCompactHello(message.packet)) {
+    auto helloMsg = readCompactHello(message.packet);
+    if (not helloMsg.has_value()) {
+      LOG(ERROR) << "Failed parsing compact hello packet from "
+                 << clientAddr.getAddressStr();
+      return false;
+    }
+    fb303::fbData->addStatValue(
+        "spark.hello.compact_packets_recv", 1, fb303::SUM);
+    pkt.helloMsg_ref() = std::move(helloMsg).value();
+    return true;
   }
 
-  // Copy buffer into string object and parse it into helloPacket.
-  std::string readBuf(reinterpret_cast<const char*>(&buf[0]), bytesRead);
   try {
-    pkt =
-        util::readThriftObjStr<thrift::SparkHelloPacket>(readBuf, serializer_);
+    pkt = util::readThriftObjStr<thrift::SparkHelloPacket>(
+        message.packet, serializer_);
   } catch (std::exception const& err) {
     LOG(ERROR) << "Failed parsing hello packet " << folly::exceptionStr(err);
     return false;
@@ -974,6 +1396,9 @@ Spark::processRttChange(
             << "from " << spark2Neighbor.rtt.count() / 1000.0 << "ms to "
             << newRtt / 1000.0 << "ms over interface " << ifName;
 
+  // link may be degrading, detect failure faster for a while
+  tightenHeartbeat(ifName);
+
   spark2Neighbor.rtt = std::chrono::microseconds(newRtt);
   notifySparkNeighborEvent(
       thrift::SparkNeighborEventType::NEIGHBOR_RTT_CHANGE,
@@ -1157,6 +1582,24 @@ Spark::sendHeartbeatMsg(std::string const& ifName) {
     LOG(ERROR) << "Failed sending Heartbeat packet on " << ifName;
   };
 
+  // Go back to regular heartbeats once interface has been stable for a while.
+  // This heartbeat doesn't carry adaptive hold time, hence neighbors switch
+  // back to negotiated hold time before heartbeats slow down.
+  bool isAdaptive{false};
+  auto adaptiveIt = ifNameToAdaptiveHeartbeatDeadline_.find(ifName);
+  if (adaptiveIt != ifNameToAdaptiveHeartbeatDeadline_.end()) {
+    if (std::chrono::steady_clock::now() < adaptiveIt->second) {
+      isAdaptive = true;
+    } else {
+      LOG(INFO) << "Stop sending adaptive heartbeats on interface " << ifName;
+      ifNameToAdaptiveHeartbeatDeadline_.erase(adaptiveIt);
+      ifNameToHeartbeatTimers_.at(ifName)->scheduleTimeout(
+          myHeartbeatTime_, true /* isPeriodic */);
+      fb303::fbData->addStatValue(
+          "spark.heartbeat.adaptive_relaxed", 1, fb303::SUM);
+    }
+  }
+
   if (ifNameToActiveNeighbors_.find(ifName) == ifNameToActiveNeighbors_.end()) {
     VLOG(3) << "Interface: " << ifName
             << " hasn't have any active neighbor yet."
@@ -1175,11 +1618,19 @@ Spark::sendHeartbeatMsg(std::string const& ifName) {
   thrift::SparkHeartbeatMsg heartbeatMsg;
   heartbeatMsg.nodeName = myNodeName_;
   heartbeatMsg.seqNum = mySeqNum_;
+  if (isAdaptive) {
+    heartbeatMsg.holdTime_ref() = adaptiveHeartbeatHoldTime_.count();
+  }
 
-  thrift::SparkHelloPacket pkt;
-  pkt.heartbeatMsg_ref() = std::move(heartbeatMsg);
+  std::string packet;
+  if (enableCompactHeartbeat_) {
+    packet = writeCompactHeartbeat(heartbeatMsg);
+  } else {
+    thrift::SparkHelloPacket pkt;
+    pkt.heartbeatMsg_ref() = std::move(heartbeatMsg);
 
-  auto packet = util::writeThriftObjStr(pkt, serializer_);
+    packet = util::writeThriftObjStr(pkt, serializer_);
+  }
 
   // send the pkt
   folly::SocketAddress dstAddr(
@@ -1200,9 +1651,8 @@ Spark::sendHeartbeatMsg(std::string const& ifName) {
   }
 
   // update counters for number of pkts and total size of pkts sent
-  fb303::fbData->addStatValue(
-      "spark.heartbeat.bytes_sent", packet.size(), fb303::SUM);
-  fb303::fbData->addStatValue("spark.heartbeat.packets_sent", 1, fb303::SUM);
+  heartbeatBytesSent_.add(packet.size());
+  heartbeatPacketsSent_.add();
 }
 
 void
@@ -1215,6 +1665,40 @@ Spark::logStateTransition(
                << "] -> [" << sparkNeighborStateToStr(newState) << "] "
                << "for neighbor: (" << neighborName << ") on interface: ("
                << ifName << ").";
+
+  // transition triggered by packet rather than by timer
+  if (packetRecvTs_.has_value()) {
+    fb303::fbData->addHistogramValue(
+        "spark.latency.packet_to_transition_us",
+        (getCurrentTimeInUs() - *packetRecvTs_).count());
+  }
+}
+
+void
+Spark::updatePacketRecvCounters(
+    std::string const& packetType,
+    std::string const& neighborName,
+    std::string const& ifName) {
+  fb303::fbData->addStatValue(
+      folly::sformat(
+          "spark.{}_packet_recv.{}.{}", packetType, neighborName, ifName),
+      1,
+      fb303::SUM);
+}
+
+void
+Spark::updatePacketDropCounters(
+    PacketValidationResult result,
+    std::string const& neighborName,
+    std::string const& ifName) {
+  const auto reason = packetValidationResultToStr(result);
+  fb303::fbData->addStatValue(
+      "spark.hello_packet_dropped." + reason, 1, fb303::SUM);
+  fb303::fbData->addStatValue(
+      folly::sformat(
+          "spark.hello_packet_dropped.{}.{}.{}", reason, neighborName, ifName),
+      1,
+      fb303::SUM);
 }
 
 void
@@ -1266,8 +1750,8 @@ Spark::neighborUpWrapper(
   neighbor.negotiateHoldTimer.reset();
 
   // create heartbeat hold timer when promote to "ESTABLISHED"
-  neighbor.heartbeatHoldTimer = fbzmq::ZmqTimeout::make(
-      getEvb(), [this, ifName, neighborName]() noexcept {
+  neighbor.heartbeatHoldTimer = neighborTimerWheel_->makeTimeout(
+      [this, ifName, neighborName]() noexcept {
         processHeartbeatTimeout(ifName, neighborName);
       });
   neighbor.heartbeatHoldTimer->scheduleTimeout(neighbor.heartbeatHoldTime);
@@ -1454,8 +1938,8 @@ Spark::processGRMsg(
       neighbor.area);
 
   // start graceful-restart timer
-  neighbor.gracefulRestartHoldTimer = fbzmq::ZmqTimeout::make(
-      getEvb(), [this, ifName, neighborName]() noexcept {
+  neighbor.gracefulRestartHoldTimer = neighborTimerWheel_->makeTimeout(
+      [this, ifName, neighborName]() noexcept {
         // change the state back to IDLE
         processGRTimeout(ifName, neighborName);
       });
@@ -1499,14 +1983,19 @@ Spark::processHelloMsg(
   }
 
   if (PacketValidationResult::FAILURE == sanityCheckResult) {
+    updatePacketDropCounters(sanityCheckResult, neighborName, ifName);
     return;
   }
 
   // deduce area for peer
   // TODO: in case area is different from previously calculated one,
   //       trigger area change event
-  auto area = getNeighborArea(neighborName, ifName, areaIdRegexList_);
+  auto area = getNeighborAreaCached(neighborName, ifName);
   if (not area.has_value()) {
+    updatePacketDropCounters(
+        PacketValidationResult::INVALID_AREA_CONFIGURATION,
+        neighborName,
+        ifName);
     return;
   }
 
@@ -1626,8 +2115,8 @@ Spark::processHelloMsg(
 
     // Starts timer to periodically send hankshake msg
     const std::string neighborAreaId = neighbor.area;
-    neighbor.negotiateTimer = fbzmq::ZmqTimeout::make(
-        getEvb(), [this, ifName, neighborName, neighborAreaId]() noexcept {
+    neighbor.negotiateTimer = neighborTimerWheel_->makeTimeout(
+        [this, ifName, neighborName, neighborAreaId]() noexcept {
           // periodically send out handshake msg
           sendHandshakeMsg(ifName, neighborName, neighborAreaId, false);
         });
@@ -1635,8 +2124,8 @@ Spark::processHelloMsg(
     neighbor.negotiateTimer->scheduleTimeout(myHandshakeTime_, isPeriodic);
 
     // Starts negotiate hold-timer
-    neighbor.negotiateHoldTimer = fbzmq::ZmqTimeout::make(
-        getEvb(), [this, ifName, neighborName]() noexcept {
+    neighbor.negotiateHoldTimer = neighborTimerWheel_->makeTimeout(
+        [this, ifName, neighborName]() noexcept {
           // prevent to stucking in NEGOTIATE forever
           processNegotiateTimeout(ifName, neighborName);
         });
@@ -1711,8 +2200,8 @@ Spark::processHelloMsg(
         neighbor.area);
 
     // start heartbeat timer again to make sure neighbor is alive
-    neighbor.heartbeatHoldTimer = fbzmq::ZmqTimeout::make(
-        getEvb(), [this, ifName, neighborName]() noexcept {
+    neighbor.heartbeatHoldTimer = neighborTimerWheel_->makeTimeout(
+        [this, ifName, neighborName]() noexcept {
           processHeartbeatTimeout(ifName, neighborName);
         });
     neighbor.heartbeatHoldTimer->scheduleTimeout(neighbor.heartbeatHoldTime);
@@ -1812,6 +2301,9 @@ Spark::processHandshakeMsg(
   if (enableV4_) {
     if (PacketValidationResult::FAILURE ==
         validateV4AddressSubnet(ifName, handshakeMsg.transportAddressV4)) {
+      updatePacketDropCounters(
+          PacketValidationResult::FAILURE, neighborName, ifName);
+
       // state transition
       SparkNeighState oldState = neighbor.state;
       neighbor.state =
@@ -1872,6 +2364,33 @@ Spark::processHandshakeMsg(
   neighborUpWrapper(neighbor, ifName, neighborName);
 }
 
+void
+Spark::tightenHeartbeat(std::string const& ifName) {
+  if (not enableAdaptiveHeartbeat_ or
+      ifNameToHeartbeatTimers_.count(ifName) == 0) {
+    return;
+  }
+
+  const auto deadline =
+      std::chrono::steady_clock::now() + kAdaptiveHeartbeatDuration;
+  auto res = ifNameToAdaptiveHeartbeatDeadline_.emplace(ifName, deadline);
+  if (not res.second) {
+    // already adaptive, just extend it
+    res.first->second = deadline;
+    return;
+  }
+
+  LOG(INFO) << "Start sending adaptive heartbeats on interface " << ifName
+            << " every " << adaptiveHeartbeatTime_.count() << "ms";
+  fb303::fbData->addStatValue(
+      "spark.heartbeat.adaptive_tightened", 1, fb303::SUM);
+
+  // Announce adaptive hold time right away, and keep up with it
+  sendHeartbeatMsg(ifName);
+  ifNameToHeartbeatTimers_.at(ifName)->scheduleTimeout(
+      adaptiveHeartbeatTime_, true /* isPeriodic */);
+}
+
 void
 Spark::processHeartbeatMsg(
     thrift::SparkHeartbeatMsg const& heartbeatMsg, std::string const& ifName) {
@@ -1899,31 +2418,113 @@ Spark::processHeartbeatMsg(
     return;
   }
 
+  // Neighbor asks for shorter hold time while sending heartbeats faster.
+  // Otherwise fall back to negotiated hold time.
+  const auto holdTime = heartbeatMsg.holdTime_ref().has_value()
+      ? std::chrono::milliseconds(*heartbeatMsg.holdTime_ref())
+      : neighbor.heartbeatHoldTime;
+
+  // Heartbeats arriving late hint at lossy link. Detect failure faster.
+  const auto now = std::chrono::steady_clock::now();
+  if (neighbor.lastHeartbeatTime.time_since_epoch().count() and
+      now - neighbor.lastHeartbeatTime > neighbor.lastHeartbeatHoldTime / 2) {
+    VLOG(2) << "Late heartbeat from neighbor: " << neighborName
+            << " over iface: " << ifName;
+    tightenHeartbeat(ifName);
+  }
+  neighbor.lastHeartbeatTime = now;
+  neighbor.lastHeartbeatHoldTime = holdTime;
+
   // Reset the hold-timer for neighbor as we have received a keep-alive msg
-  neighbor.heartbeatHoldTimer->scheduleTimeout(neighbor.heartbeatHoldTime);
+  neighbor.heartbeatHoldTimer->scheduleTimeout(holdTime);
 }
 
 void
 Spark::processPacket() {
-  // Step 1: receive and parse pkt
+  // drain pending packets in batch, so that bursts of packets (e.g. many
+  // neighbors restarting at once) don't wait for one wakeup each
+  auto messages = IoProvider::recvMessages(
+      mcastFd_, kMaxPacketsPerRecv, kMinIpv6Mtu, ioProvider_.get());
+  if (messages.empty()) {
+    return;
+  }
+
+  fb303::fbData->addStatValue("spark.hello_packet_recv_batch", 1, fb303::SUM);
+  fb303::fbData->addStatValue(
+      "spark.hello_packet_recv_batch_size", messages.size(), fb303::AVG);
+
+  processPackets(messages);
+}
+
+void
+Spark::receivePackets() {
+  // packets are timestamped on receive here, hence queueing delay counts
+  // towards processing latency and not towards RTT
+  auto messages = IoProvider::recvMessages(
+      mcastFd_, kMaxPacketsPerRecv, kMinIpv6Mtu, ioProvider_.get());
+  if (messages.empty()) {
+    return;
+  }
+
+  fb303::fbData->addStatValue("spark.hello_packet_recv_batch", 1, fb303::SUM);
+  fb303::fbData->addStatValue(
+      "spark.hello_packet_recv_batch_size", messages.size(), fb303::AVG);
+
+  for (auto& message : messages) {
+    receivedPacketsQueue_.push(std::move(message));
+  }
+}
+
+void
+Spark::processPackets(
+    std::vector<IoProvider::IncomingMessage> const& messages) {
+  for (auto const& message : messages) {
+    try {
+      processPacket(message);
+    } catch (std::exception const& err) {
+      LOG(ERROR) << "Spark: error processing hello packet from "
+                 << message.srcAddr.getAddressStr() << " "
+                 << folly::exceptionStr(err);
+    }
+  }
+}
+
+void
+Spark::processPacket(IoProvider::IncomingMessage const& message) {
+  // Step 1: parse pkt
   thrift::SparkHelloPacket helloPacket;
   std::string ifName;
-  std::chrono::microseconds myRecvTime;
+  const auto myRecvTime = message.recvTs;
 
-  if (!parsePacket(helloPacket, ifName, myRecvTime)) {
+  if (!parsePacket(message, helloPacket, ifName)) {
     return;
   }
 
+  // account latency of packet since arrival once processed
+  packetRecvTs_ = myRecvTime;
+  SCOPE_EXIT {
+    packetRecvTs_.reset();
+    fb303::fbData->addHistogramValue(
+        "spark.latency.packet_processed_us",
+        (getCurrentTimeInUs() - myRecvTime).count());
+  };
+
   // Step 2: Spark2 specific msg processing
   if (enableSpark2_) {
     if (helloPacket.helloMsg_ref().has_value()) {
-      processHelloMsg(helloPacket.helloMsg_ref().value(), ifName, myRecvTime);
+      auto const& helloMsg = helloPacket.helloMsg_ref().value();
+      updatePacketRecvCounters("hello", helloMsg.nodeName, ifName);
+      processHelloMsg(helloMsg, ifName, myRecvTime);
       return;
     } else if (helloPacket.heartbeatMsg_ref().has_value()) {
-      processHeartbeatMsg(helloPacket.heartbeatMsg_ref().value(), ifName);
+      auto const& heartbeatMsg = helloPacket.heartbeatMsg_ref().value();
+      updatePacketRecvCounters("heartbeat", heartbeatMsg.nodeName, ifName);
+      processHeartbeatMsg(heartbeatMsg, ifName);
       return;
     } else if (helloPacket.handshakeMsg_ref().has_value()) {
-      processHandshakeMsg(helloPacket.handshakeMsg_ref().value(), ifName);
+      auto const& handshakeMsg = helloPacket.handshakeMsg_ref().value();
+      updatePacketRecvCounters("handshake", handshakeMsg.nodeName, ifName);
+      processHandshakeMsg(handshakeMsg, ifName);
       return;
     } else {
       VLOG(3) << "No valid Spark2 msg. Fallback to old Spark processing";
@@ -1937,6 +2538,8 @@ Spark::processPacket() {
   }
   if (validationResult == PacketValidationResult::FAILURE ||
       validationResult == PacketValidationResult::INVALID_AREA_CONFIGURATION) {
+    updatePacketDropCounters(
+        validationResult, helloPacket.payload.originator.nodeName, ifName);
     LOG(ERROR) << "Ignoring invalid packet received from "
                << helloPacket.payload.originator.nodeName << " on " << ifName;
     return;
@@ -2129,11 +2732,90 @@ Spark::processPacket() {
 void
 Spark::sendHelloPacket(
     std::string const& ifName, bool inFastInitState, bool restarting) {
+  sendHelloPackets({ifName}, inFastInitState, restarting);
+}
+
+void
+Spark::queueHelloPacket(std::string const& ifName, bool inFastInitState) {
+  auto& pendingInFastInitState = pendingHelloPackets_[ifName];
+  pendingInFastInitState = pendingInFastInitState or inFastInitState;
+  if (not helloBatchTimer_->isScheduled()) {
+    helloBatchTimer_->scheduleTimeout(kHelloBatchWindow);
+  }
+}
+
+void
+Spark::flushHelloPackets() {
+  std::vector<std::string> fastInitIfNames;
+  std::vector<std::string> ifNames;
+  for (auto const& kv : pendingHelloPackets_) {
+    (kv.second ? fastInitIfNames : ifNames).emplace_back(kv.first);
+  }
+  pendingHelloPackets_.clear();
+
+  if (not fastInitIfNames.empty()) {
+    sendHelloPackets(fastInitIfNames, true /* inFastInitState */);
+  }
+  if (not ifNames.empty()) {
+    sendHelloPackets(ifNames, false /* inFastInitState */);
+  }
+}
+
+void
+Spark::sendHelloPackets(
+    std::vector<std::string> const& ifNames,
+    bool inFastInitState,
+    bool restarting) {
+  std::vector<IoProvider::OutgoingMessage> messages;
+  messages.reserve(ifNames.size());
+  for (auto const& ifName : ifNames) {
+    try {
+      auto message = buildHelloPacket(ifName, inFastInitState, restarting);
+      if (message.has_value()) {
+        messages.emplace_back(std::move(message).value());
+      }
+    } catch (std::exception const& e) {
+      LOG(ERROR) << "Failed sending Hello packet on " << ifName << ": "
+                 << folly::exceptionStr(e);
+    }
+  }
+  if (messages.empty()) {
+    return;
+  }
+
+  // send the payloads
+  folly::SocketAddress dstAddr(
+      folly::IPAddress(Constants::kSparkMcastAddr.toString()), udpMcastPort_);
+
+  const auto numSent = std::max(
+      IoProvider::sendMessages(mcastFd_, dstAddr, messages, ioProvider_.get()),
+      0);
+  if (static_cast<size_t>(numSent) < messages.size()) {
+    VLOG(1) << "Sending multicast to " << dstAddr.getAddressStr() << " on "
+            << messages.size() - numSent << " of " << messages.size()
+            << " interfaces failed due to error " << folly::errnoStr(errno);
+  }
+
+  // update counters for number of pkts and total size of pkts sent
+  size_t bytesSent{0};
+  for (int i = 0; i < numSent; ++i) {
+    bytesSent += messages.at(i).packet.size();
+  }
+  fb303::fbData->addStatValue("spark.hello.bytes_sent", bytesSent, fb303::SUM);
+  fb303::fbData->addStatValue("spark.hello.packets_sent", numSent, fb303::SUM);
+
+  VLOG(4) << "Sent " << bytesSent << " bytes in " << numSent
+          << " hello packets";
+}
+
+std::optional<IoProvider::OutgoingMessage>
+Spark::buildHelloPacket(
+    std::string const& ifName, bool inFastInitState, bool restarting) {
   VLOG(3) << "Send hello packet called for " << ifName;
 
   if (interfaceDb_.count(ifName) == 0) {
     LOG(ERROR) << "Interface " << ifName << " is no longer being tracked";
-    return;
+    return std::nullopt;
   }
 
   SCOPE_EXIT {
@@ -2141,10 +2823,6 @@ Spark::sendHelloPacket(
     ++mySeqNum_;
   };
 
-  SCOPE_FAIL {
-    LOG(ERROR) << "Failed sending Hello packet on " << ifName;
-  };
-
   // in some cases, getting link-local address may fail and throw
   // e.g. when iface has not yet auto-configured it, or iface is removed but
   // down event has not arrived yet
@@ -2182,6 +2860,17 @@ Spark::sendHelloPacket(
       neighborInfo.lastMyMsgRcvdTsInUs = neighbor.localTimestamp.count();
     }
 
+    // compact hello carries helloMsg only, without deprecated payload
+    if (enableCompactHello_) {
+      auto packet = writeCompactHello(helloMsg);
+      if (kMinIpv6Mtu < packet.size()) {
+        LOG(ERROR) << "Hello packet is too big, cannot sent!";
+        return std::nullopt;
+      }
+      return IoProvider::OutgoingMessage{
+          ifIndex, v6Addr.asV6(), std::move(packet)};
+    }
+
     // fill in helloMsg field
     helloPacket.helloMsg_ref() = std::move(helloMsg);
   }
@@ -2227,31 +2916,12 @@ Spark::sendHelloPacket(
   helloPacket.signature = "";
 
   auto packet = util::writeThriftObjStr(helloPacket, serializer_);
-
-  // send the payload
-  folly::SocketAddress dstAddr(
-      folly::IPAddress(Constants::kSparkMcastAddr.toString()), udpMcastPort_);
-
   if (kMinIpv6Mtu < packet.size()) {
     LOG(ERROR) << "Hello packet is too big, cannot sent!";
-    return;
-  }
-
-  auto bytesSent = IoProvider::sendMessage(
-      mcastFd_, ifIndex, v6Addr.asV6(), dstAddr, packet, ioProvider_.get());
-
-  if ((bytesSent < 0) || (static_cast<size_t>(bytesSent) != packet.size())) {
-    VLOG(1) << "Sending multicast to " << dstAddr.getAddressStr() << " on "
-            << ifName << " failed due to error " << folly::errnoStr(errno);
-    return;
+    return std::nullopt;
   }
 
-  // update counters for number of pkts and total size of pkts sent
-  fb303::fbData->addStatValue(
-      "spark.hello.bytes_sent", packet.size(), fb303::SUM);
-  fb303::fbData->addStatValue("spark.hello.packets_sent", 1, fb303::SUM);
-
-  VLOG(4) << "Sent " << bytesSent << " bytes in hello packet";
+  return IoProvider::OutgoingMessage{ifIndex, v6Addr.asV6(), std::move(packet)};
 }
 
 void
@@ -2262,6 +2932,15 @@ Spark::processInterfaceUpdates(thrift::InterfaceDatabase&& ifDb) {
       << "Node name in ifDb " << ifDb.thisNodeName
       << " does not match my node name " << myNodeName_;
 
+  // Delta carries changed interfaces only. Start from the tracked ones and
+  // re-evaluate the changed ones below.
+  if (ifDb.isDelta) {
+    newInterfaceDb = interfaceDb_;
+    for (const auto& kv : ifDb.interfaces) {
+      newInterfaceDb.erase(kv.first);
+    }
+  }
+
   //
   // To be conisdered a valid interface for Spark to track, it must:
   // - be up
@@ -2383,6 +3062,7 @@ Spark::deleteInterfaceFromDb(const std::set<std::string>& toDel) {
       }
       spark2Neighbors_.erase(ifName);
       ifNameToHeartbeatTimers_.erase(ifName);
+      ifNameToAdaptiveHeartbeatDeadline_.erase(ifName);
     }
 
     for (const auto& kv : neighbors_.at(ifName)) {
@@ -2421,6 +3101,8 @@ Spark::deleteInterfaceFromDb(const std::set<std::string>& toDel) {
     // cleanup for this interface
     neighbors_.erase(ifName);
     ifNameToHelloTimers_.erase(ifName);
+    pendingHelloPackets_.erase(ifName);
+    neighborAreaCache_.erase(ifName);
     interfaceDb_.erase(ifName);
   }
 }
@@ -2519,7 +3201,7 @@ Spark::addInterfaceToDb(
             inFastInitState = (std::chrono::steady_clock::now() - timePoint) <=
                 3 * fastInitKeepAliveTime_;
           }
-          sendHelloPacket(ifName, inFastInitState);
+          queueHelloPacket(ifName, inFastInitState);
 
           // Schedule next run (add 20% variance)
           // overriding timeoutPeriod if I am in fast initial state
@@ -2715,4 +3397,21 @@ Spark::getNeighborArea(
   return candidateAreas.back();
 }
 
+std::optional<std::string>
+Spark::getNeighborAreaCached(
+    const std::string& peerNodeName, const std::string& ifName) {
+  auto& ifAreas = neighborAreaCache_[ifName];
+  auto it = ifAreas.find(peerNodeName);
+  if (it != ifAreas.end()) {
+    return it->second;
+  }
+
+  // only cache successful match. Failures are reported on every attempt.
+  auto area = getNeighborArea(peerNodeName, ifName, areaIdRegexList_);
+  if (area.has_value()) {
+    ifAreas.emplace(peerNodeName, *area);
+  }
+  return area;
+}
+
 } // namespace openr
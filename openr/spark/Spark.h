@@ -9,6 +9,7 @@
 
 #include <chrono>
 #include <functional>
+#include <thread>
 
 #include <boost/serialization/strong_typedef.hpp>
 #include <fbzmq/async/ZmqTimeout.h>
@@ -17,12 +18,15 @@
 #include <folly/SocketAddress.h>
 #include <folly/container/EvictingCacheMap.h>
 #include <folly/fibers/FiberManager.h>
+#include <folly/futures/Future.h>
 #include <folly/io/async/AsyncTimeout.h>
 #include <folly/stats/BucketedTimeSeries.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include <openr/common/OpenrEventBase.h>
+#include <openr/common/StatCounter.h>
 #include <openr/common/StepDetector.h>
+#include <openr/common/TimerWheel.h>
 #include <openr/common/Types.h>
 #include <openr/common/Util.h>
 #include <openr/if/gen-cpp2/KvStore_constants.h>
@@ -113,6 +117,11 @@ class Spark final : public OpenrEventBase {
   std::optional<SparkNeighState> getSparkNeighState(
       std::string const& ifName, std::string const& neighborName);
 
+  // replace area regexes with ones of reloaded config. Established neighbors
+  // keep their area, new regexes apply to neighbors discovered from now on
+  folly::SemiFuture<folly::Unit> reloadAreaConfig(
+      std::vector<thrift::AreaConfig> areas);
+
   // override eventloop stop()
   void stop() override;
 
@@ -179,9 +188,19 @@ class Spark final : public OpenrEventBase {
   bool shouldProcessHelloPacket(
       std::string const& ifName, folly::IPAddress const& addr);
 
+  // receive pending packets in batch and process them one by one
+  void processPacket();
+
+  // receive pending packets in batch on I/O thread and queue them for
+  // processing on Spark thread
+  void receivePackets();
+
+  // process received packets one by one
+  void processPackets(std::vector<IoProvider::IncomingMessage> const& messages);
+
   // process hello packet from a neighbor. we want to see if
   // the neighbor could be added as adjacent peer.
-  void processPacket();
+  void processPacket(IoProvider::IncomingMessage const& message);
 
   // originate my hello packet on given interface
   void sendHelloPacket(
@@ -189,6 +208,25 @@ class Spark final : public OpenrEventBase {
       bool inFastInitState = false,
       bool restarting = false);
 
+  // originate my hello packets on given interfaces, batched into as few
+  // syscalls as possible
+  void sendHelloPackets(
+      std::vector<std::string> const& ifNames,
+      bool inFastInitState = false,
+      bool restarting = false);
+
+  // build my hello packet for given interface. Returns none if interface is
+  // not tracked or packet is too big.
+  std::optional<IoProvider::OutgoingMessage> buildHelloPacket(
+      std::string const& ifName, bool inFastInitState, bool restarting);
+
+  // queue my periodic hello packet on given interface. Queued packets are
+  // sent together at most kHelloBatchWindow later.
+  void queueHelloPacket(std::string const& ifName, bool inFastInitState);
+
+  // send all queued hello packets
+  void flushHelloPackets();
+
   // Function processes interface updates from LinkMonitor and appropriately
   // enable/disable neighbor discovery
   void processInterfaceUpdates(thrift::InterfaceDatabase&& interfaceUpdates);
@@ -249,11 +287,15 @@ class Spark final : public OpenrEventBase {
           std::unique_ptr<re2::RE2::Set>,
           std::unique_ptr<re2::RE2::Set>>>& areaIdRegexList);
 
-  // function to receive and parse received pkt
+  // memoized version of `getNeighborArea()` against areaIdRegexList_
+  std::optional<std::string> getNeighborAreaCached(
+      const std::string& peerNodeName, const std::string& ifName);
+
+  // function to parse received pkt
   bool parsePacket(
+      IoProvider::IncomingMessage const& message /* received message */,
       thrift::SparkHelloPacket& pkt /* packet( type will be renamed later) */,
-      std::string& ifName /* interface */,
-      std::chrono::microseconds& recvTime /* kernel timestamp when recved */);
+      std::string& ifName /* interface */);
 
   // function to validate v4Address with its subnet
   PacketValidationResult validateV4AddressSubnet(
@@ -294,6 +336,7 @@ class Spark final : public OpenrEventBase {
       res.transportAddressV6 = transportAddressV6;
       res.kvStoreCmdPort = kvStoreCmdPort;
       res.ifName = remoteIfName;
+      res.openrCtrlThriftPort = openrCtrlThriftPort;
       return res;
     }
 
@@ -317,16 +360,20 @@ class Spark final : public OpenrEventBase {
     SparkNeighState state;
 
     // timer to periodically send out handshake pkt
-    std::unique_ptr<fbzmq::ZmqTimeout> negotiateTimer{nullptr};
+    std::unique_ptr<TimerWheel::Timeout> negotiateTimer{nullptr};
 
     // negotiate stage hold-timer
-    std::unique_ptr<fbzmq::ZmqTimeout> negotiateHoldTimer{nullptr};
+    std::unique_ptr<TimerWheel::Timeout> negotiateHoldTimer{nullptr};
 
     // heartbeat hold-timer
-    std::unique_ptr<fbzmq::ZmqTimeout> heartbeatHoldTimer{nullptr};
+    std::unique_ptr<TimerWheel::Timeout> heartbeatHoldTimer{nullptr};
+
+    // receive time and hold time of last heartbeat, to detect late ones
+    std::chrono::steady_clock::time_point lastHeartbeatTime{};
+    std::chrono::milliseconds lastHeartbeatHoldTime{0};
 
     // graceful restart hold-timer
-    std::unique_ptr<fbzmq::ZmqTimeout> gracefulRestartHoldTimer{nullptr};
+    std::unique_ptr<TimerWheel::Timeout> gracefulRestartHoldTimer{nullptr};
 
     // KvStore related port. Info passed to LinkMonitor for neighborEvent
     int32_t kvStoreCmdPort{0};
@@ -358,6 +405,11 @@ class Spark final : public OpenrEventBase {
     std::string area{};
   };
 
+  // Shared timing wheel of Spark2Neighbor timers. Heartbeats re-arm hold
+  // timers of every neighbor all the time, which is O(1) with the wheel. It
+  // must outlive spark2Neighbors_.
+  std::unique_ptr<TimerWheel> neighborTimerWheel_{nullptr};
+
   std::unordered_map<
       std::string /* ifName */,
       std::unordered_map<std::string /* neighborName */, Spark2Neighbor>>
@@ -370,6 +422,20 @@ class Spark final : public OpenrEventBase {
       SparkNeighState const& oldState,
       SparkNeighState const& newState);
 
+  // util function to bump per neighbor counter of received packets of given
+  // type, e.g. hello, heartbeat, handshake
+  void updatePacketRecvCounters(
+      std::string const& packetType,
+      std::string const& neighborName,
+      std::string const& ifName);
+
+  // util function to bump global and per neighbor counters of packets dropped
+  // due to failing validation
+  void updatePacketDropCounters(
+      PacketValidationResult result,
+      std::string const& neighborName,
+      std::string const& ifName);
+
   // util function to check SparkNeighState
   void checkNeighborState(
       Spark2Neighbor const& neighbor, SparkNeighState const& state);
@@ -413,6 +479,9 @@ class Spark final : public OpenrEventBase {
   // utility call to send heartbeat msg
   void sendHeartbeatMsg(std::string const& ifName);
 
+  // switch interface to adaptive heartbeats for a while, if enabled
+  void tightenHeartbeat(std::string const& ifName);
+
   // wrapper function to process GR msg
   void processGRMsg(
       std::string const& neighborName,
@@ -529,6 +598,37 @@ class Spark final : public OpenrEventBase {
   // increase Hello interval in Spark2
   const bool increaseHelloInterval_{false};
 
+  // Send heartbeats in compact fixed layout instead of thrift. Every node
+  // accepts both, but must be enabled only once all nodes in the network
+  // understand compact heartbeats.
+  bool enableCompactHeartbeat_{false};
+
+  // Send Spark2 hellos in compact varint layout instead of thrift, without
+  // deprecated payload. Every node accepts both, but must be enabled only
+  // once all nodes in the network run Spark2 and understand compact hellos.
+  bool enableCompactHello_{false};
+
+  // Send faster heartbeats with shorter hold time on interfaces showing
+  // signs of degradation
+  bool enableAdaptiveHeartbeat_{false};
+  std::chrono::milliseconds adaptiveHeartbeatTime_{0};
+  std::chrono::milliseconds adaptiveHeartbeatHoldTime_{0};
+
+  // Timestamp received packets in NIC instead of kernel, for RTT free of
+  // host scheduling delays
+  bool enableHwTimestamping_{false};
+
+  // Receive packets on dedicated I/O thread instead of Spark thread
+  bool enableIoThread_{false};
+
+  // I/O thread, which only reads packets off socket. Neighbor state is
+  // touched by Spark thread only.
+  std::unique_ptr<OpenrEventBase> ioEvb_{nullptr};
+  std::thread ioThread_;
+
+  // Packets received by I/O thread, pending processing on Spark thread
+  messaging::RWQueue<IoProvider::IncomingMessage> receivedPacketsQueue_;
+
   // Map of interface entries keyed by ifName
   std::unordered_map<std::string, Interface> interfaceDb_{};
 
@@ -538,12 +638,26 @@ class Spark final : public OpenrEventBase {
       std::unique_ptr<fbzmq::ZmqTimeout>>
       ifNameToHelloTimers_{};
 
+  // Interfaces with hello packet queued to be sent in next batch, along with
+  // whether interface is in fast init state
+  std::unordered_map<std::string /* ifName */, bool /* inFastInitState */>
+      pendingHelloPackets_{};
+
+  // Timer to send queued hello packets
+  std::unique_ptr<fbzmq::ZmqTimeout> helloBatchTimer_{nullptr};
+
   // heartbeat packet send timers for each interface
   std::unordered_map<
       std::string /* ifName */,
       std::unique_ptr<fbzmq::ZmqTimeout>>
       ifNameToHeartbeatTimers_{};
 
+  // interfaces sending adaptive heartbeats, till given deadline
+  std::unordered_map<
+      std::string /* ifName */,
+      std::chrono::steady_clock::time_point /* deadline */>
+      ifNameToAdaptiveHeartbeatDeadline_{};
+
   // number of active neighbors for each interface
   std::unordered_map<
       std::string /* ifName */,
@@ -614,6 +728,18 @@ class Spark final : public OpenrEventBase {
   // to serdeser messages over ZMQ sockets
   apache::thrift::CompactSerializer serializer_;
 
+  // stats updated per packet
+  StatCounter helloPacketsRecv_{
+      "spark.hello_packet_recv", facebook::fb303::SUM};
+  StatCounter helloPacketsRecvSize_{
+      "spark.hello_packet_recv_size", facebook::fb303::SUM};
+  StatCounter helloPacketsProcessed_{
+      "spark.hello_packet_processed", facebook::fb303::SUM};
+  StatCounter heartbeatBytesSent_{
+      "spark.heartbeat.bytes_sent", facebook::fb303::SUM};
+  StatCounter heartbeatPacketsSent_{
+      "spark.heartbeat.packets_sent", facebook::fb303::SUM};
+
   // The IO primitives provider; this is used for mocking
   // the IO during unit-tests. This could be shared with other
   // instances, hence the shared_ptr
@@ -634,6 +760,19 @@ class Spark final : public OpenrEventBase {
       std::unique_ptr<re2::RE2::Set> /* interface regex */>>
       areaIdRegexList_{};
 
+  // Area deduced from areaIdRegexList_ per neighbor. Invalidated when area
+  // regexes change, and per interface when interface goes away.
+  std::unordered_map<
+      std::string /* ifName */,
+      std::unordered_map<
+          std::string /* neighborName */,
+          std::string /* areaId */>>
+      neighborAreaCache_{};
+
+  // Arrival time of the packet being processed, if any. State transitions
+  // triggered by it report their latency since arrival.
+  std::optional<std::chrono::microseconds> packetRecvTs_;
+
   // Timer for updating and submitting counters periodically
   std::unique_ptr<folly::AsyncTimeout> counterUpdateTimer_{nullptr};
 };
@@ -254,6 +254,66 @@ MockIoProvider::sendmsg(int sockFd, const struct msghdr* msg, int /* flags */) {
   return -1;
 }
 
+//
+// Receive messages the same way as recvmsg, till there is no more message
+// whose delivery time has come
+//
+int
+MockIoProvider::recvmmsg(
+    int sockFd,
+    struct mmsghdr* msgvec,
+    unsigned int vlen,
+    int flags,
+    struct timespec* /* timeout */) {
+  VLOG(4) << "MockIoProvider::recvmmsg called for " << vlen << " messages";
+  ++numRecvmmsgCalls_;
+
+  int numRecvd{0};
+  for (unsigned int i = 0; i < vlen; ++i) {
+    // Respect latency of messages which are yet to be signalled
+    if (i > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = mailboxes_.find(sockFd);
+      if (it == mailboxes_.end() or it->second.empty() or
+          not it->second.front().isActive()) {
+        break;
+      }
+    }
+    auto ret = recvmsg(sockFd, &msgvec[i].msg_hdr, flags);
+    if (ret < 0) {
+      break;
+    }
+    msgvec[i].msg_len = ret;
+    ++numRecvd;
+  }
+  if (numRecvd == 0) {
+    errno = EAGAIN;
+    return -1;
+  }
+  return numRecvd;
+}
+
+//
+// Deliver every message the same way as sendmsg, up to first failure
+//
+int
+MockIoProvider::sendmmsg(
+    int sockFd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+  VLOG(4) << "MockIoProvider::sendmmsg called with " << vlen << " messages";
+  ++numSendmmsgCalls_;
+
+  int numSent{0};
+  for (unsigned int i = 0; i < vlen; ++i) {
+    auto ret = sendmsg(sockFd, &msgvec[i].msg_hdr, flags);
+    if (ret < 0) {
+      break;
+    }
+    msgvec[i].msg_len = ret;
+    ++numSent;
+  }
+  return numSent ? numSent : -1;
+}
+
 //
 // Simply accept all setsockopts, and build fd to ifName mapping
 //
@@ -98,6 +98,31 @@ class MockIoProvider final : public IoProvider {
 
   ssize_t sendmsg(int sockfd, const struct msghdr* msg, int flags) override;
 
+  int recvmmsg(
+      int sockfd,
+      struct mmsghdr* msgvec,
+      unsigned int vlen,
+      int flags,
+      struct timespec* timeout) override;
+
+  int sendmmsg(
+      int sockfd,
+      struct mmsghdr* msgvec,
+      unsigned int vlen,
+      int flags) override;
+
+  // Number of sendmmsg calls, for tests to verify batching
+  size_t
+  getNumSendmmsgCalls() const {
+    return numSendmmsgCalls_;
+  }
+
+  // Number of recvmmsg calls, for tests to verify batching
+  size_t
+  getNumRecvmmsgCalls() const {
+    return numRecvmmsgCalls_;
+  }
+
   int setsockopt(
       int sockfd,
       int level,
@@ -114,6 +139,10 @@ class MockIoProvider final : public IoProvider {
   // Boolean to keep track of running-state of MockIoProvider
   std::atomic<bool> isRunning_{false};
 
+  std::atomic<size_t> numSendmmsgCalls_{0};
+
+  std::atomic<size_t> numRecvmmsgCalls_{0};
+
   // used to make this class a monitor
   std::mutex mutex_{};
 
@@ -265,6 +265,104 @@ TEST(MockIoProviderTestSetup, TwoNodesAndOneNodeTest) {
   mockIoProviderThread.join();
 }
 
+//
+// This test sends a batch of packets on different interfaces of a single
+// socket in one call, and receives a batch of packets in one call.
+//
+// 4-node topology: 1 <-> 2, 3 <-> 4 (two 2-node bidirectional)
+//
+TEST(MockIoProviderTestSetup, SendRecvMessagesTest) {
+  folly::IPAddressV6 ipAddr1V6("fe80::1");
+  folly::IPAddressV6 ipAddr3V6("fe80::3");
+
+  auto mockIoProvider = std::make_shared<MockIoProvider>();
+
+  // Start mock IoProvider thread
+  std::thread mockIoProviderThread([&]() {
+    LOG(INFO) << "Starting mockIoProvider thread.";
+    mockIoProvider->start();
+    LOG(INFO) << "mockIoProvider thread got stopped.";
+  });
+  mockIoProvider->waitUntilRunning();
+
+  mockIoProvider->addIfNameIfIndex(
+      {{"iface1", 1}, {"iface2", 2}, {"iface3", 3}, {"iface4", 4}});
+  ConnectedIfPairs connectedPairs = {
+      {"iface1", {{"iface2", 100}}},
+      {"iface2", {{"iface1", 100}}},
+      {"iface3", {{"iface4", 100}}},
+      {"iface4", {{"iface3", 100}}},
+  };
+  mockIoProvider->setConnectedPairs(connectedPairs);
+
+  int fd1 = createSocketAndJoinGroup(
+      mockIoProvider, 1, folly::IPAddress(kDiscardMulticastAddr));
+  int fd2 = createSocketAndJoinGroup(
+      mockIoProvider, 2, folly::IPAddress(kDiscardMulticastAddr));
+  int fd4 = createSocketAndJoinGroup(
+      mockIoProvider, 4, folly::IPAddress(kDiscardMulticastAddr));
+
+  std::vector<IoProvider::OutgoingMessage> messages{
+      {1, ipAddr1V6, "Batched message #1 from node1 to node2."},
+      {3, ipAddr3V6, "Batched message #2 from node3 to node4."},
+  };
+  folly::SocketAddress dstAddr(
+      folly::IPAddress(kDiscardMulticastAddr), kMockedUdpPort);
+  EXPECT_EQ(
+      2,
+      IoProvider::sendMessages(fd1, dstAddr, messages, mockIoProvider.get()));
+  EXPECT_EQ(1, mockIoProvider->getNumSendmmsgCalls());
+
+  struct msghdr recvMsg;
+  unsigned char recvBuf[kMinIpv6PktSize];
+  struct iovec recvEntry;
+  AlignedCtrlBuf<char[kRecvBufferSize]> recvUnion;
+  sockaddr_storage srcAddrStorage;
+  prepareRecvMessage(
+      recvMsg, recvBuf, kMinIpv6PktSize, recvEntry, recvUnion, srcAddrStorage);
+  EXPECT_EQ(
+      messages.at(0).packet.size(),
+      mockIoProvider->recvmsg(fd2, &recvMsg, MSG_DONTWAIT));
+  checkPacketContent(messages.at(0).packet, recvMsg);
+  EXPECT_EQ(2, getMsgIfIndex(&recvMsg));
+
+  prepareRecvMessage(
+      recvMsg, recvBuf, kMinIpv6PktSize, recvEntry, recvUnion, srcAddrStorage);
+  EXPECT_EQ(
+      messages.at(1).packet.size(),
+      mockIoProvider->recvmsg(fd4, &recvMsg, MSG_DONTWAIT));
+  checkPacketContent(messages.at(1).packet, recvMsg);
+  EXPECT_EQ(4, getMsgIfIndex(&recvMsg));
+
+  // Batch of packets on one interface is received in one call
+  std::vector<IoProvider::OutgoingMessage> burst{
+      {3, ipAddr3V6, "Burst message #1 from node3 to node4."},
+      {3, ipAddr3V6, "Burst message #2 from node3 to node4."},
+      {3, ipAddr3V6, "Burst message #3 from node3 to node4."},
+  };
+  EXPECT_EQ(
+      3, IoProvider::sendMessages(fd1, dstAddr, burst, mockIoProvider.get()));
+  waitForDataToRead(fd4);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  auto recvd =
+      IoProvider::recvMessages(fd4, 8, kMinIpv6PktSize, mockIoProvider.get());
+  EXPECT_EQ(1, mockIoProvider->getNumRecvmmsgCalls());
+  ASSERT_EQ(3, recvd.size());
+  for (size_t i = 0; i < recvd.size(); ++i) {
+    EXPECT_EQ(burst.at(i).packet, recvd.at(i).packet);
+    EXPECT_EQ(4, recvd.at(i).ifIndex);
+    EXPECT_EQ(ipAddr3V6, recvd.at(i).srcAddr.getIPAddress());
+  }
+  EXPECT_TRUE(
+      IoProvider::recvMessages(fd4, 8, kMinIpv6PktSize, mockIoProvider.get())
+          .empty());
+
+  // Cleanup
+  mockIoProvider->stop();
+  mockIoProviderThread.join();
+}
+
 //
 // This test sends packets along the follow topology
 // with the two nodes running in separate thread for
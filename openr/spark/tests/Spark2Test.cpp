@@ -10,6 +10,7 @@
 #include <mutex>
 #include <thread>
 
+#include <fb303/ServiceData.h>
 #include <folly/MapUtil.h>
 #include <folly/Memory.h>
 #include <folly/Optional.h>
@@ -421,6 +422,214 @@ TEST_F(SimpleSpark2Fixture, HeartbeatTimerExpireTest) {
   }
 }
 
+//
+// Start 2 Spark instances and wait them forming adj. Make sure per neighbor
+// packet counters and latency histograms are exported.
+//
+TEST_F(SimpleSpark2Fixture, PacketCountersTest) {
+  SCOPE_EXIT {
+    LOG(INFO) << "SimpleSpark2Fixture PacketCountersTest finished";
+  };
+
+  // let a few heartbeats through
+  std::this_thread::sleep_for(3 * kHeartbeatTime);
+
+  auto counters = fb303::fbData->getCounters();
+  for (auto const& type : {"hello", "handshake", "heartbeat"}) {
+    for (auto const& [neighbor, ifName] :
+         {std::make_pair("node-2", iface1), std::make_pair("node-1", iface2)}) {
+      const auto key = folly::sformat(
+          "spark.{}_packet_recv.{}.{}.sum", type, neighbor, ifName);
+      EXPECT_LT(0, counters[key]) << key;
+    }
+  }
+  for (auto const& latency :
+       {"packet_processed_us", "packet_to_transition_us"}) {
+    for (auto const& percentile : {"p50", "p99", "p100"}) {
+      const auto key =
+          folly::sformat("spark.latency.{}.{}.60", latency, percentile);
+      EXPECT_EQ(1, counters.count(key)) << key;
+    }
+  }
+}
+
+//
+// Start 2 Spark instances, with one of them sending compact heartbeats. Make
+// sure adj is kept alive by compact heartbeats beyond heartbeat hold time.
+//
+TEST_F(Spark2Fixture, CompactHeartbeatTest) {
+  SCOPE_EXIT {
+    LOG(INFO) << "Spark2Fixture CompactHeartbeatTest finished";
+  };
+
+  auto config1 = std::make_shared<thrift::OpenrConfig>();
+  config1->areas.emplace_back(
+      SparkWrapper::createAreaConfig(defaultArea, {".*"}, {".*"}));
+  config1->spark_config.compact_heartbeat = true;
+
+  mockIoProvider->addIfNameIfIndex({{iface1, ifIndex1}, {iface2, ifIndex2}});
+  ConnectedIfPairs connectedPairs = {
+      {iface1, {{iface2, 10}}},
+      {iface2, {{iface1, 10}}},
+  };
+  mockIoProvider->setConnectedPairs(connectedPairs);
+
+  auto node1 = createSpark(kDomainName, "node-1", 1, true, true, config1);
+  auto node2 = createSpark(kDomainName, "node-2", 2);
+  EXPECT_TRUE(node1->updateInterfaceDb({{iface1, ifIndex1, ip1V4, ip1V6}}));
+  EXPECT_TRUE(node2->updateInterfaceDb({{iface2, ifIndex2, ip2V4, ip2V6}}));
+
+  ASSERT_TRUE(node1->waitForEvent(NB_UP).has_value());
+  ASSERT_TRUE(node2->waitForEvent(NB_UP).has_value());
+
+  // adj must stay up on both sides
+  EXPECT_TRUE(node1->recvNeighborEvent(3 * kHeartbeatHoldTime).hasError());
+  EXPECT_TRUE(node2->recvNeighborEvent(kHeartbeatHoldTime).hasError());
+
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_LT(0, counters["spark.heartbeat.compact_packets_recv.sum"]);
+}
+
+//
+// Start 2 Spark instances, one sending compact hellos and heartbeats, other
+// thrift ones. Make sure adj forms on both sides, and goes down on restart of
+// node sending compact hellos, as its restarting hello is received.
+//
+TEST_F(Spark2Fixture, CompactHelloTest) {
+  SCOPE_EXIT {
+    LOG(INFO) << "Spark2Fixture CompactHelloTest finished";
+  };
+
+  auto config1 = std::make_shared<thrift::OpenrConfig>();
+  config1->areas.emplace_back(
+      SparkWrapper::createAreaConfig(defaultArea, {".*"}, {".*"}));
+  config1->spark_config.compact_hello = true;
+  config1->spark_config.compact_heartbeat = true;
+
+  mockIoProvider->addIfNameIfIndex({{iface1, ifIndex1}, {iface2, ifIndex2}});
+  ConnectedIfPairs connectedPairs = {
+      {iface1, {{iface2, 10}}},
+      {iface2, {{iface1, 10}}},
+  };
+  mockIoProvider->setConnectedPairs(connectedPairs);
+
+  auto node1 = createSpark(kDomainName, "node-1", 1, true, true, config1);
+  auto node2 = createSpark(kDomainName, "node-2", 2);
+  EXPECT_TRUE(node1->updateInterfaceDb({{iface1, ifIndex1, ip1V4, ip1V6}}));
+  EXPECT_TRUE(node2->updateInterfaceDb({{iface2, ifIndex2, ip2V4, ip2V6}}));
+
+  {
+    auto event = node1->waitForEvent(NB_UP);
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ("node-2", event->neighbor.nodeName);
+  }
+  {
+    auto event = node2->waitForEvent(NB_UP);
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ("node-1", event->neighbor.nodeName);
+  }
+
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_LT(0, counters["spark.hello.compact_packets_recv.sum"]);
+
+  // restarting flag of compact hello is understood by neighbor
+  node1.reset();
+  ASSERT_TRUE(node2->waitForEvent(NB_RESTARTING).has_value());
+}
+
+//
+// Start 2 Spark instances receiving packets on dedicated I/O thread. Make sure
+// adj forms and is kept alive, and goes down once link is cut.
+//
+TEST_F(Spark2Fixture, IoThreadTest) {
+  SCOPE_EXIT {
+    LOG(INFO) << "Spark2Fixture IoThreadTest finished";
+  };
+
+  auto config = std::make_shared<thrift::OpenrConfig>();
+  config->areas.emplace_back(
+      SparkWrapper::createAreaConfig(defaultArea, {".*"}, {".*"}));
+  config->spark_config.enable_io_thread = true;
+
+  mockIoProvider->addIfNameIfIndex({{iface1, ifIndex1}, {iface2, ifIndex2}});
+  ConnectedIfPairs connectedPairs = {
+      {iface1, {{iface2, 10}}},
+      {iface2, {{iface1, 10}}},
+  };
+  mockIoProvider->setConnectedPairs(connectedPairs);
+
+  auto node1 = createSpark(kDomainName, "node-1", 1, true, true, config);
+  auto node2 = createSpark(kDomainName, "node-2", 2, true, true, config);
+  EXPECT_TRUE(node1->updateInterfaceDb({{iface1, ifIndex1, ip1V4, ip1V6}}));
+  EXPECT_TRUE(node2->updateInterfaceDb({{iface2, ifIndex2, ip2V4, ip2V6}}));
+
+  ASSERT_TRUE(node1->waitForEvent(NB_UP).has_value());
+  ASSERT_TRUE(node2->waitForEvent(NB_UP).has_value());
+
+  // adj must stay up on both sides
+  EXPECT_TRUE(node1->recvNeighborEvent(3 * kHeartbeatHoldTime).hasError());
+  EXPECT_TRUE(node2->recvNeighborEvent(kHeartbeatHoldTime).hasError());
+
+  // cut link
+  mockIoProvider->setConnectedPairs({});
+  EXPECT_TRUE(node1->waitForEvent(NB_DOWN).has_value());
+  EXPECT_TRUE(node2->waitForEvent(NB_DOWN).has_value());
+}
+
+//
+// Start 2 Spark instances with adaptive heartbeat. Change RTT so that both
+// switch to adaptive heartbeats, then make sure loss of link is detected
+// within adaptive hold time instead of negotiated one.
+//
+TEST_F(Spark2Fixture, AdaptiveHeartbeatTest) {
+  SCOPE_EXIT {
+    LOG(INFO) << "Spark2Fixture AdaptiveHeartbeatTest finished";
+  };
+
+  const std::chrono::milliseconds adaptiveHeartbeatHoldTime{100};
+  auto config = std::make_shared<thrift::OpenrConfig>();
+  config->areas.emplace_back(
+      SparkWrapper::createAreaConfig(defaultArea, {".*"}, {".*"}));
+  config->spark_config.enable_adaptive_heartbeat = true;
+  config->spark_config.adaptive_heartbeat_time_ms = 20;
+  config->spark_config.adaptive_heartbeat_hold_time_ms =
+      adaptiveHeartbeatHoldTime.count();
+
+  mockIoProvider->addIfNameIfIndex({{iface1, ifIndex1}, {iface2, ifIndex2}});
+  mockIoProvider->setConnectedPairs({
+      {iface1, {{iface2, 10}}},
+      {iface2, {{iface1, 10}}},
+  });
+
+  auto node1 = createSpark(kDomainName, "node-1", 1, true, true, config);
+  auto node2 = createSpark(kDomainName, "node-2", 2, true, true, config);
+  EXPECT_TRUE(node1->updateInterfaceDb({{iface1, ifIndex1, ip1V4, ip1V6}}));
+  EXPECT_TRUE(node2->updateInterfaceDb({{iface2, ifIndex2, ip2V4, ip2V6}}));
+  ASSERT_TRUE(node1->waitForEvent(NB_UP).has_value());
+  ASSERT_TRUE(node2->waitForEvent(NB_UP).has_value());
+
+  // RTT change makes both sides send adaptive heartbeats
+  mockIoProvider->setConnectedPairs({
+      {iface1, {{iface2, 15}}},
+      {iface2, {{iface1, 25}}},
+  });
+  ASSERT_TRUE(node1->waitForEvent(NB_RTT_CHANGE).has_value());
+  ASSERT_TRUE(node2->waitForEvent(NB_RTT_CHANGE).has_value());
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_LE(2, counters["spark.heartbeat.adaptive_tightened.sum"]);
+
+  // adj is kept alive by adaptive heartbeats
+  EXPECT_TRUE(node1->recvNeighborEvent(kHeartbeatHoldTime).hasError());
+
+  // link loss is detected faster than negotiated hold time
+  auto startTime = std::chrono::steady_clock::now();
+  mockIoProvider->setConnectedPairs({});
+  ASSERT_TRUE(node1->waitForEvent(NB_DOWN).has_value());
+  ASSERT_TRUE(node2->waitForEvent(NB_DOWN).has_value());
+  auto endTime = std::chrono::steady_clock::now();
+  EXPECT_LT(endTime - startTime, kHeartbeatHoldTime);
+}
+
 //
 // Start 2 Spark instances and wait them forming adj. Then
 // remove/add interface from one instance's perspective
@@ -1104,6 +1313,15 @@ TEST_F(Spark2Fixture, NoAreaMatch) {
     EXPECT_FALSE(node1->getSparkNeighState(iface1, nodeName2).has_value());
     EXPECT_FALSE(node2->getSparkNeighState(iface2, nodeName1).has_value());
   }
+
+  // hello packets are accounted as dropped by neighbor
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_LT(
+      0,
+      counters["spark.hello_packet_dropped.invalid_area.fsw002.iface1.sum"]);
+  EXPECT_LT(
+      0,
+      counters["spark.hello_packet_dropped.invalid_area.rsw001.iface2.sum"]);
 }
 
 //
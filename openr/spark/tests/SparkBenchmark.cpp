@@ -0,0 +1,271 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <pthread.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include <chrono>
+#include <thread>
+
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/tests/BenchmarkUtils.h>
+#include <openr/spark/SparkWrapper.h>
+#include <openr/spark/tests/MockIoProvider.h>
+
+DEFINE_int32(
+    spark_benchmark_steady_state_s,
+    5,
+    "Duration (in seconds) of steady state over which CPU usage is measured");
+
+namespace openr {
+
+namespace {
+
+const auto kNeighborUp = thrift::SparkNeighborEventType::NEIGHBOR_UP;
+
+const std::string kDomainName("terragraph");
+
+// Link latency emulated by MockIoProvider, in milliseconds
+const int kLinkLatency{1};
+
+// Timers scaled down alike Spark2Test, so that a run completes in seconds
+const std::chrono::milliseconds kGRHoldTime(5000);
+const std::chrono::milliseconds kKeepAliveTime(100);
+const SparkTimeConfig kTimeConfig(
+    std::chrono::milliseconds(1000) /* hello */,
+    std::chrono::milliseconds(100) /* hello fast init */,
+    std::chrono::milliseconds(100) /* handshake */,
+    std::chrono::milliseconds(200) /* heartbeat */,
+    std::chrono::milliseconds(2000) /* negotiate hold */,
+    std::chrono::milliseconds(1000) /* heartbeat hold */);
+
+// Time limit of forming all adjacencies
+const std::chrono::seconds kAdjacencyTimeout(60);
+
+int64_t
+getProcessCpuUs() {
+  struct rusage usage;
+  CHECK_EQ(0, getrusage(RUSAGE_SELF, &usage));
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+      usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+int64_t
+getThreadCpuUs(std::thread& thread) {
+  clockid_t clockId;
+  CHECK_EQ(0, pthread_getcpuclockid(thread.native_handle(), &clockId));
+  struct timespec ts;
+  CHECK_EQ(0, clock_gettime(clockId, &ts));
+  return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+} // namespace
+
+/**
+ * Ring of Spark instances over MockIoProvider. Every node has `numLinks`
+ * parallel links to each of its two ring neighbors, hence 2 * numLinks
+ * interfaces and adjacencies.
+ */
+class SparkBenchmarkFixture {
+ public:
+  SparkBenchmarkFixture(size_t numNodes, size_t numLinks)
+      : numLinks_(numLinks), nodeInterfaces_(numNodes), sparks_(numNodes) {
+    CHECK_GE(numNodes, 3) << "Ring needs at least 3 nodes";
+
+    mockIoProvider_ = std::make_shared<MockIoProvider>();
+    mockIoProviderThread_ =
+        std::thread([this]() { mockIoProvider_->start(); });
+    mockIoProvider_->waitUntilRunning();
+
+    std::vector<std::pair<std::string, int>> ifNameIfIndex;
+    ConnectedIfPairs connectedPairs;
+    int ifIndex{0};
+    for (size_t node = 0; node < numNodes; ++node) {
+      const auto peer = (node + 1) % numNodes;
+      for (size_t link = 0; link < numLinks; ++link) {
+        const auto ifName = folly::sformat("n{}-n{}-{}", node, peer, link);
+        const auto peerIfName =
+            folly::sformat("n{}-n{}-{}", peer, node, link);
+        connectedPairs[ifName] = {{peerIfName, kLinkLatency}};
+        connectedPairs[peerIfName] = {{ifName, kLinkLatency}};
+
+        const std::vector<std::pair<size_t, std::string>> ends{
+            {node, ifName}, {peer, peerIfName}};
+        for (auto const& [owner, name] : ends) {
+          ++ifIndex;
+          ifNameIfIndex.emplace_back(name, ifIndex);
+          nodeInterfaces_.at(owner).push_back(SparkInterfaceEntry{
+              name,
+              ifIndex,
+              folly::IPAddress::createNetwork(
+                  folly::sformat(
+                      "10.{}.{}.{}/8",
+                      ifIndex / 65536,
+                      ifIndex / 256 % 256,
+                      ifIndex % 256),
+                  -1,
+                  false),
+              folly::IPAddress::createNetwork(
+                  folly::sformat("fe80::{:x}/64", ifIndex), -1, false)});
+        }
+      }
+    }
+    mockIoProvider_->addIfNameIfIndex(ifNameIfIndex);
+    mockIoProvider_->setConnectedPairs(connectedPairs);
+  }
+
+  ~SparkBenchmarkFixture() {
+    for (auto& spark : sparks_) {
+      spark.reset();
+    }
+    mockIoProvider_->stop();
+    mockIoProviderThread_.join();
+  }
+
+  // Number of adjacencies, counted once per side
+  size_t
+  getNumAdjacencies() const {
+    return sparks_.size() * 2 * numLinks_;
+  }
+
+  void
+  startNode(size_t node) {
+    sparks_.at(node) = std::make_unique<SparkWrapper>(
+        kDomainName,
+        folly::sformat("node-{}", node),
+        kGRHoldTime,
+        kKeepAliveTime,
+        kKeepAliveTime /* fastInitKeepAliveTime */,
+        false /* enableV4 */,
+        std::make_pair(
+            Constants::kOpenrVersion, Constants::kOpenrSupportedVersion),
+        context_,
+        mockIoProvider_,
+        nullptr /* config */,
+        true /* enableSpark2 */,
+        true /* increaseHelloInterval */,
+        kTimeConfig);
+    sparks_.at(node)->updateInterfaceDb(nodeInterfaces_.at(node));
+  }
+
+  void
+  stopNode(size_t node) {
+    sparks_.at(node).reset();
+  }
+
+  // Wait for node to report all of its adjacencies up
+  void
+  waitForAdjacencies(size_t node) {
+    for (size_t i = 0; i < 2 * numLinks_; ++i) {
+      CHECK(sparks_.at(node)
+                ->waitForEvent(kNeighborUp, std::nullopt, kAdjacencyTimeout)
+                .has_value())
+          << "node-" << node << " failed to form adjacencies";
+    }
+  }
+
+  // CPU time of process excluding MockIoProvider thread, which busy-polls
+  // mailboxes. Benchmark thread must be sleeping while this is measured.
+  int64_t
+  getSparkCpuUs() {
+    return getProcessCpuUs() - getThreadCpuUs(mockIoProviderThread_);
+  }
+
+ private:
+  const size_t numLinks_{0};
+
+  fbzmq::Context context_;
+
+  std::shared_ptr<MockIoProvider> mockIoProvider_{nullptr};
+  std::thread mockIoProviderThread_;
+
+  std::vector<std::vector<SparkInterfaceEntry>> nodeInterfaces_;
+
+  std::vector<std::unique_ptr<SparkWrapper>> sparks_;
+};
+
+/**
+ * Bring up ring of Spark instances and measure
+ * - time to form all adjacencies
+ * - CPU usage per adjacency in steady state
+ * - time to form adjacencies again after every other node restarts
+ */
+static void
+BM_SparkScale(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numNodes,
+    size_t numLinks) {
+  for (uint32_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    SparkBenchmarkFixture fixture(numNodes, numLinks);
+
+    // Time to full adjacency
+    suspender.dismiss();
+    auto startTime = std::chrono::steady_clock::now();
+    for (size_t node = 0; node < numNodes; ++node) {
+      fixture.startNode(node);
+    }
+    for (size_t node = 0; node < numNodes; ++node) {
+      fixture.waitForAdjacencies(node);
+    }
+    const auto adjMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - startTime)
+                           .count();
+    suspender.rehire();
+
+    // CPU in steady state
+    const std::chrono::seconds steadyState(
+        FLAGS_spark_benchmark_steady_state_s);
+    const auto startCpuUs = fixture.getSparkCpuUs();
+    std::this_thread::sleep_for(steadyState);
+    const auto cpuUs = fixture.getSparkCpuUs() - startCpuUs;
+
+    // Mass restart of every other node
+    suspender.dismiss();
+    startTime = std::chrono::steady_clock::now();
+    for (size_t node = 0; node < numNodes; node += 2) {
+      fixture.stopNode(node);
+      fixture.startNode(node);
+    }
+    for (size_t node = 0; node < numNodes; node += 2) {
+      fixture.waitForAdjacencies(node);
+    }
+    const auto recoveryMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime)
+            .count();
+    suspender.rehire();
+
+    counters["time_to_adj_ms"] = adjMs;
+    counters["cpu_us_per_adj_per_sec"] =
+        cpuUs / steadyState.count() / fixture.getNumAdjacencies();
+    counters["restart_recovery_ms"] = recoveryMs;
+  }
+}
+
+// The parameters are number of nodes and number of links between every pair
+// of adjacent nodes
+BENCHMARK_COUNTERS_NAME_PARAM(BM_SparkScale, counters, 4_1, 4, 1);
+BENCHMARK_COUNTERS_NAME_PARAM(BM_SparkScale, counters, 16_1, 16, 1);
+BENCHMARK_COUNTERS_NAME_PARAM(BM_SparkScale, counters, 16_8, 16, 8);
+BENCHMARK_COUNTERS_NAME_PARAM(BM_SparkScale, counters, 64_4, 64, 4);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,409 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "MockSystemHandler.h"
+
+#include <chrono>
+#include <cmath>
+#include <set>
+#include <thread>
+#include <unordered_set>
+
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+#include <sodium.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+#include <thrift/lib/cpp2/server/ThriftServer.h>
+#include <thrift/lib/cpp2/util/ScopedServerThread.h>
+
+#include <openr/common/NetworkUtil.h>
+#include <openr/common/Util.h>
+#include <openr/common/tests/BenchmarkUtils.h>
+#include <openr/spark/tests/MockIoProvider.h>
+#include <openr/tests/OpenrWrapper.h>
+
+namespace openr {
+
+namespace {
+
+using OpenrInstance = OpenrWrapper<apache::thrift::CompactSerializer>;
+
+// Link latency emulated by MockIoProvider, in milliseconds
+const int kLinkLatency{1};
+
+// Timers scaled down alike OpenrSystemTest, with keep alives relaxed so that
+// hundreds of instances fit on a host. Failures are detected within hold time
+const std::chrono::seconds kKvStoreDbSyncInterval(60);
+const std::chrono::milliseconds kSparkHoldTime(1000);
+const std::chrono::milliseconds kSparkKeepAliveTime(100);
+const std::chrono::milliseconds kSparkFastInitKeepAliveTime(20);
+const std::chrono::seconds kLinkMonitorAdjHoldTime(1);
+const std::chrono::milliseconds kLinkFlapInitialBackoff(1);
+const std::chrono::milliseconds kLinkFlapMaxBackoff(8);
+const std::chrono::seconds kFibColdStartDuration(1);
+
+// Time limit of converging, and interval of checking for it
+const std::chrono::seconds kConvergenceTimeout(300);
+const std::chrono::milliseconds kConvergencePollInterval(10);
+
+enum class Topology {
+  // node i connects to node i + 1, and last node to first one
+  RING,
+  // square grid, node connects to nodes right and below of it
+  GRID,
+};
+
+} // namespace
+
+/**
+ * Emulation of a network of full Open/R instances in one process. Instances
+ * talk over MockIoProvider and program routes into a mock system handler.
+ * Convergence is reached once FIB of every running node holds routes to
+ * allocated prefixes of all other running nodes and none of its routes go
+ * over failed links.
+ */
+class OpenrEmulation {
+ public:
+  OpenrEmulation(Topology topology, size_t numNodes)
+      : nodeInterfaces_(numNodes) {
+    mockIoProvider_ = std::make_shared<MockIoProvider>();
+    mockIoProviderThread_ =
+        std::thread([this]() { mockIoProvider_->start(); });
+    mockIoProvider_->waitUntilRunning();
+
+    mockSystemHandler_ = std::make_shared<MockSystemHandler>();
+    server_ = std::make_shared<apache::thrift::ThriftServer>();
+    server_->setNumIOWorkerThreads(1);
+    server_->setNumAcceptThreads(1);
+    server_->setPort(0);
+    server_->setInterface(mockSystemHandler_);
+    systemThriftThread_.start(server_);
+    const auto systemPort = systemThriftThread_.getAddress()->getPort();
+
+    createTopology(topology, numNodes);
+    for (size_t node = 0; node < numNodes; ++node) {
+      openrs_.emplace_back(std::make_unique<OpenrInstance>(
+          context_,
+          std::to_string(node),
+          false /* v4Enabled */,
+          kKvStoreDbSyncInterval,
+          kSparkHoldTime,
+          kSparkKeepAliveTime,
+          kSparkFastInitKeepAliveTime,
+          kLinkMonitorAdjHoldTime,
+          kLinkFlapInitialBackoff,
+          kLinkFlapMaxBackoff,
+          kFibColdStartDuration,
+          mockIoProvider_,
+          systemPort));
+    }
+  }
+
+  ~OpenrEmulation() {
+    openrs_.clear();
+    mockIoProvider_->stop();
+    mockIoProviderThread_.join();
+    systemThriftThread_.stop();
+  }
+
+  // Start all nodes and wait until network converges
+  void
+  bootstrap() {
+    for (size_t node = 0; node < openrs_.size(); ++node) {
+      auto& openr = openrs_.at(node);
+      openr->run();
+      CHECK(openr->sparkUpdateInterfaceDb(nodeInterfaces_.at(node)));
+    }
+    waitForConvergence();
+  }
+
+  // Take down link between nodes and wait until network converges
+  void
+  failLink(size_t node, size_t peer) {
+    const auto ifName = getIfName(node, peer);
+    const auto peerIfName = getIfName(peer, node);
+    connectedPairs_.erase(ifName);
+    connectedPairs_.erase(peerIfName);
+    failedIfNames_[node].emplace(ifName);
+    failedIfNames_[peer].emplace(peerIfName);
+    mockIoProvider_->setConnectedPairs(connectedPairs_);
+    waitForConvergence();
+  }
+
+  // Crash node and wait until network converges
+  void
+  failNode(size_t node) {
+    openrs_.at(node).reset();
+    waitForConvergence();
+  }
+
+  size_t
+  getNumLinks() const {
+    return connectedPairs_.size() / 2;
+  }
+
+ private:
+  static std::string
+  getIfName(size_t node, size_t peer) {
+    return folly::sformat("{}/{}", node, peer);
+  }
+
+  void
+  createTopology(Topology topology, size_t numNodes) {
+    std::vector<std::pair<size_t, size_t>> links;
+    switch (topology) {
+    case Topology::RING: {
+      CHECK_GE(numNodes, 3) << "Ring needs at least 3 nodes";
+      for (size_t node = 0; node < numNodes; ++node) {
+        links.emplace_back(node, (node + 1) % numNodes);
+      }
+      break;
+    }
+    case Topology::GRID: {
+      const size_t side = std::lround(std::sqrt(numNodes));
+      CHECK_EQ(side * side, numNodes) << "Grid needs square number of nodes";
+      for (size_t node = 0; node < numNodes; ++node) {
+        if (node % side + 1 < side) {
+          links.emplace_back(node, node + 1);
+        }
+        if (node + side < numNodes) {
+          links.emplace_back(node, node + side);
+        }
+      }
+      break;
+    }
+    }
+
+    IfNameAndifIndex ifNameIfIndex;
+    int ifIndex{0};
+    for (auto const& [node, peer] : links) {
+      const auto ifName = getIfName(node, peer);
+      const auto peerIfName = getIfName(peer, node);
+      connectedPairs_[ifName] = {{peerIfName, kLinkLatency}};
+      connectedPairs_[peerIfName] = {{ifName, kLinkLatency}};
+
+      const std::vector<std::pair<size_t, std::string>> ends{
+          {node, ifName}, {peer, peerIfName}};
+      for (auto const& [owner, name] : ends) {
+        ++ifIndex;
+        ifNameIfIndex.emplace_back(name, ifIndex);
+        nodeInterfaces_.at(owner).push_back(SparkInterfaceEntry{
+            name,
+            ifIndex,
+            folly::IPAddress::createNetwork(
+                folly::sformat(
+                    "10.{}.{}.{}/8",
+                    ifIndex / 65536,
+                    ifIndex / 256 % 256,
+                    ifIndex % 256),
+                -1,
+                false),
+            folly::IPAddress::createNetwork(
+                folly::sformat("fe80::{:x}/64", ifIndex), -1, false)});
+      }
+    }
+    mockIoProvider_->addIfNameIfIndex(ifNameIfIndex);
+    mockIoProvider_->setConnectedPairs(connectedPairs_);
+  }
+
+  bool
+  isConverged() {
+    // every running node must have its prefix allocated
+    std::vector<thrift::IpPrefix> prefixes;
+    for (auto& openr : openrs_) {
+      if (not openr) {
+        continue;
+      }
+      auto prefix = openr->getIpPrefix();
+      if (not prefix.has_value()) {
+        return false;
+      }
+      prefixes.emplace_back(std::move(*prefix));
+    }
+
+    for (size_t node = 0; node < openrs_.size(); ++node) {
+      if (not openrs_.at(node)) {
+        continue;
+      }
+      const auto routeDb = openrs_.at(node)->fibDumpRouteDatabase();
+      auto const& failedIfNames = failedIfNames_[node];
+      std::unordered_set<thrift::IpPrefix> dests;
+      for (auto const& route : routeDb.unicastRoutes) {
+        for (auto const& nextHop : route.nextHops) {
+          if (failedIfNames.count(nextHop.address.ifName_ref().value_or(""))) {
+            return false;
+          }
+        }
+        dests.emplace(route.dest);
+      }
+      // route to every prefix but own one, and to no prefix of crashed node
+      size_t numRoutes{0};
+      for (auto const& prefix : prefixes) {
+        numRoutes += dests.count(prefix);
+      }
+      if (numRoutes + 1 != prefixes.size() or
+          routeDb.unicastRoutes.size() != numRoutes) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void
+  waitForConvergence() {
+    const auto startTime = std::chrono::steady_clock::now();
+    while (not isConverged()) {
+      CHECK(std::chrono::steady_clock::now() - startTime < kConvergenceTimeout)
+          << "Network failed to converge";
+      /* sleep override */
+      std::this_thread::sleep_for(kConvergencePollInterval);
+    }
+  }
+
+  fbzmq::Context context_;
+
+  std::shared_ptr<MockIoProvider> mockIoProvider_;
+  std::thread mockIoProviderThread_;
+  ConnectedIfPairs connectedPairs_;
+
+  std::shared_ptr<MockSystemHandler> mockSystemHandler_;
+  std::shared_ptr<apache::thrift::ThriftServer> server_;
+  apache::thrift::util::ScopedServerThread systemThriftThread_;
+
+  // interfaces of every node, and its interfaces over failed links
+  std::vector<std::vector<SparkInterfaceEntry>> nodeInterfaces_;
+  std::unordered_map<size_t, std::set<std::string>> failedIfNames_;
+
+  // crashed nodes are reset
+  std::vector<std::unique_ptr<OpenrInstance>> openrs_;
+};
+
+/**
+ * Measure time until numNodes Open/R instances in given topology, started
+ * together, converge
+ */
+static void
+BM_OpenrBootstrap(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    Topology topology,
+    size_t numNodes) {
+  for (uint32_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    OpenrEmulation emulation(topology, numNodes);
+
+    suspender.dismiss();
+    const auto startTime = std::chrono::steady_clock::now();
+    emulation.bootstrap();
+    const auto elapsedMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime)
+            .count();
+    suspender.rehire();
+
+    counters["converge_ms"] = elapsedMs;
+    counters["links"] = emulation.getNumLinks();
+  }
+}
+
+/**
+ * Measure time until network of numNodes Open/R instances in given topology
+ * re-converges after failure of link between first two nodes. Includes
+ * failure detection, bounded by Spark hold time.
+ */
+static void
+BM_OpenrLinkFailure(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    Topology topology,
+    size_t numNodes) {
+  for (uint32_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    OpenrEmulation emulation(topology, numNodes);
+    emulation.bootstrap();
+
+    suspender.dismiss();
+    const auto startTime = std::chrono::steady_clock::now();
+    emulation.failLink(0, 1);
+    const auto elapsedMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime)
+            .count();
+    suspender.rehire();
+
+    counters["converge_ms"] = elapsedMs;
+  }
+}
+
+/**
+ * Measure time until network of numNodes Open/R instances in given topology
+ * re-converges after crash of a node. Includes failure detection, bounded by
+ * Spark hold time.
+ */
+static void
+BM_OpenrNodeFailure(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    Topology topology,
+    size_t numNodes) {
+  for (uint32_t i = 0; i < iters; ++i) {
+    folly::BenchmarkSuspender suspender;
+    OpenrEmulation emulation(topology, numNodes);
+    emulation.bootstrap();
+
+    suspender.dismiss();
+    const auto startTime = std::chrono::steady_clock::now();
+    // node in the middle of grid, so that it loses a node of degree 4
+    const size_t side = std::lround(std::sqrt(numNodes));
+    emulation.failNode(side / 2 * side + side / 2);
+    const auto elapsedMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime)
+            .count();
+    suspender.rehire();
+
+    counters["converge_ms"] = elapsedMs;
+  }
+}
+
+// The parameters are topology and number of nodes
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrBootstrap, counters, RING_16, Topology::RING, 16);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrBootstrap, counters, GRID_100, Topology::GRID, 100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrBootstrap, counters, GRID_256, Topology::GRID, 256);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrLinkFailure, counters, RING_16, Topology::RING, 16);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrLinkFailure, counters, GRID_100, Topology::GRID, 100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrLinkFailure, counters, GRID_256, Topology::GRID, 256);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrNodeFailure, counters, RING_16, Topology::RING, 16);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrNodeFailure, counters, GRID_100, Topology::GRID, 100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_OpenrNodeFailure, counters, GRID_256, Topology::GRID, 256);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+
+  // init sodium security library
+  if (::sodium_init() == -1) {
+    LOG(ERROR) << "Failed initializing sodium";
+    return 1;
+  }
+
+  folly::runBenchmarks();
+  return 0;
+}
@@ -219,7 +219,8 @@ OpenrWrapper<Serializer>::OpenrWrapper(
       false, // bgpDryRun
       std::chrono::milliseconds(10),
       std::chrono::milliseconds(250),
-      kvStoreUpdatesQueue_.getReader(),
+      kvStoreUpdatesQueue_.getReader(
+          KvStore::getKvStoreUpdatesReaderOptions()),
       staticRoutesQueue_.getReader(),
       routeUpdatesQueue_,
       context_);
@@ -231,8 +232,9 @@ OpenrWrapper<Serializer>::OpenrWrapper(
       config_,
       Constants::kFibAgentPort,
       fibColdStartDuration,
-      routeUpdatesQueue_.getReader(),
+      routeUpdatesQueue_.getReader(Fib::getRouteUpdatesReaderOptions()),
       interfaceUpdatesQueue_.getReader(),
+      fibUpdatesQueue_,
       MonitorSubmitUrl{monitorSubmitUrl_},
       kvStore_.get(),
       context_);
@@ -240,8 +242,9 @@ OpenrWrapper<Serializer>::OpenrWrapper(
   //
   // create PrefixAllocator
   //
+  // room for thousands of nodes, see OpenrEmulationBenchmark
   const auto seedPrefix =
-      folly::IPAddress::createNetwork("fc00:cafe:babe::/62");
+      folly::IPAddress::createNetwork("fc00:cafe:babe::/52");
   const uint8_t allocPrefixLen = 64;
   prefixAllocator_ = std::make_unique<PrefixAllocator>(
       nodeId_,
@@ -393,6 +396,7 @@ OpenrWrapper<Serializer>::stop() {
   routeUpdatesQueue_.close();
   peerUpdatesQueue_.close();
   interfaceUpdatesQueue_.close();
+  fibUpdatesQueue_.close();
   neighborUpdatesQueue_.close();
   prefixUpdatesQueue_.close();
   kvStoreUpdatesQueue_.close();
@@ -157,10 +157,12 @@ class OpenrWrapper {
   const std::string platformPubUrl_;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> routeUpdatesQueue_;
   messaging::ReplicateQueue<thrift::InterfaceDatabase> interfaceUpdatesQueue_;
+  messaging::ReplicateQueue<thrift::RouteDatabaseDelta> fibUpdatesQueue_;
   messaging::ReplicateQueue<thrift::PeerUpdateRequest> peerUpdatesQueue_;
   messaging::ReplicateQueue<thrift::SparkNeighborEvent> neighborUpdatesQueue_;
   messaging::ReplicateQueue<thrift::PrefixUpdateRequest> prefixUpdatesQueue_;
-  messaging::ReplicateQueue<thrift::Publication> kvStoreUpdatesQueue_;
+  messaging::ReplicateQueue<messaging::SharedValue<thrift::Publication>>
+      kvStoreUpdatesQueue_;
   messaging::ReplicateQueue<thrift::RouteDatabaseDelta> staticRoutesQueue_;
 
   // socket to publish platform events
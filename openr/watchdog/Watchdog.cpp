@@ -7,9 +7,13 @@
 
 #include "Watchdog.h"
 
+#include <fb303/ServiceData.h>
+
 #include <openr/common/Constants.h>
 #include <openr/common/Util.h>
 
+namespace fb303 = facebook::fb303;
+
 namespace openr {
 
 Watchdog::Watchdog(
@@ -41,6 +45,15 @@ Watchdog::addEvb(OpenrEventBase* evb, const std::string& name) {
   });
 }
 
+void
+Watchdog::addMemoryReliefCallback(
+    const std::string& name, std::function<void()> callback) {
+  CHECK(callback);
+  getEvb()->runInEventBaseThreadAndWait([this, name, &callback]() {
+    memoryReliefCallbacks_.emplace_back(name, std::move(callback));
+  });
+}
+
 bool
 Watchdog::memoryLimitExceeded() {
   bool result;
@@ -60,6 +73,13 @@ Watchdog::monitorMemory() {
                  << " Memory limit:" << criticalMemoryMB_ << " MB";
     if (not memExceedTime_.has_value()) {
       memExceedTime_ = std::chrono::steady_clock::now();
+      // Try to bring usage back within limit before it's sustained
+      for (auto const& kv : memoryReliefCallbacks_) {
+        LOG(WARNING) << "Releasing memory held by " << kv.first;
+        kv.second();
+      }
+      fb303::fbData->addStatValue(
+          "watchdog.memory_relief_attempts", 1, fb303::COUNT);
       return;
     }
     // check for sustained critical memory usage
@@ -93,6 +113,14 @@ Watchdog::updateCounters() {
     VLOG(4) << "Thread " << name << ", " << (now - lastTs).count()
             << " seconds ever since last thread activity";
 
+    // Report how busy event loop was kept since last check
+    fb303::fbData->setCounter(
+        folly::sformat("watchdog.evb_max_loop_lag_ms.{}", name),
+        kv.first->getAndResetMaxLoopLag().count());
+    fb303::fbData->setCounter(
+        folly::sformat("watchdog.evb_max_callback_ms.{}", name),
+        kv.first->getAndResetMaxCallbackDuration().count());
+
     if (now - lastTs > healthCheckThreshold_) {
       // fire a crash right now
       LOG(WARNING) << "Watchdog: " << name << " thread detected to be dead";
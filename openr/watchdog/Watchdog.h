@@ -7,9 +7,11 @@
 
 #pragma once
 
+#include <functional>
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <fbzmq/service/monitor/SystemMetrics.h>
 #include <folly/io/async/AsyncTimeout.h>
@@ -34,6 +36,14 @@ class Watchdog final : public OpenrEventBase {
 
   void addEvb(OpenrEventBase* evb, const std::string& name);
 
+  /**
+   * Add callback to release memory held by a module. Callbacks are invoked
+   * on Watchdog thread, once memory usage exceeds the limit, in order to
+   * avoid crash if usage falls back within the threshold time.
+   */
+  void addMemoryReliefCallback(
+      const std::string& name, std::function<void()> callback);
+
   bool memoryLimitExceeded();
 
  private:
@@ -67,6 +77,10 @@ class Watchdog final : public OpenrEventBase {
   // amount of time memory usage sustained above memory limit
   std::optional<std::chrono::steady_clock::time_point> memExceedTime_;
 
+  // callbacks to release memory, by module name
+  std::vector<std::pair<std::string, std::function<void()>>>
+      memoryReliefCallbacks_;
+
   // Get the system metrics for resource usage counters
   fbzmq::SystemMetrics systemMetrics_{};
 };